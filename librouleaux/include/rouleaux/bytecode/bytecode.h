@@ -0,0 +1,219 @@
+#pragma once
+
+#include "defines.h"
+#include "lexer/token.h"
+#include "typing/type_info.h"
+
+// The most registers a single function can use, register operands are 16 bits wide
+#define BYTECODE_MAX_REGISTERS 0xFFFF
+
+// The operands an instruction reads and writes, and where it can continue, as given by bytecode_opcode_operands()
+#define BYTECODE_OPERAND_WRITES_A        0x01
+#define BYTECODE_OPERAND_READS_A         0x02
+#define BYTECODE_OPERAND_READS_B         0x04
+#define BYTECODE_OPERAND_READS_C         0x08
+// The instruction can continue at the instruction offset (or short_offset) instructions after it
+#define BYTECODE_OPERAND_JUMPS           0x10
+#define BYTECODE_OPERAND_JUMPS_SHORT     0x20
+// The instruction never continues at the instruction after it
+#define BYTECODE_OPERAND_NO_FALL_THROUGH 0x40
+// The registers of the instruction hold floats
+#define BYTECODE_OPERAND_FLOATS          0x80
+
+/**
+ * @brief The operations of the bytecode. Every operation reads and writes the registers of the function it is in,
+ *        a, b and c refer to the operands of its bytecode_instruction. The registers hold no type, so an operation
+ *        on them is picked by the compiler from their static type: _I64 operations treat them as integers and _F64
+ *        operations as floats
+ */
+typedef enum bytecode_opcode {
+    OPCODE_INVALID = 0,
+
+    OPCODE_LOAD_CONSTANT,           // a = constants[index]
+    OPCODE_MOVE,                    // a = b
+    OPCODE_GET_GLOBAL,              // a = globals[index]
+    OPCODE_SET_GLOBAL,              // globals[index] = a
+
+    OPCODE_ADD_I64,                 // a = b + c
+    OPCODE_ADD_F64,
+    OPCODE_SUBTRACT_I64,            // a = b - c
+    OPCODE_SUBTRACT_F64,
+    OPCODE_MULTIPLY_I64,            // a = b * c
+    OPCODE_MULTIPLY_F64,
+    OPCODE_DIVIDE_I64,              // a = b / c
+    OPCODE_DIVIDE_F64,
+    OPCODE_MODULUS_I64,             // a = b % c
+    OPCODE_MODULUS_F64,
+    OPCODE_GREATER_THAN_I64,        // a = b > c, 1 or 0 (1.0 or 0.0 for _F64)
+    OPCODE_GREATER_THAN_F64,
+    OPCODE_LESS_THAN_I64,           // a = b < c, 1 or 0 (1.0 or 0.0 for _F64)
+    OPCODE_LESS_THAN_F64,
+
+    OPCODE_JUMP,                    // continues at the instruction offset instructions after this one
+    OPCODE_JUMP_IF_FALSE_I64,       // jumps like OPCODE_JUMP when a is 0, also used for functions (which are never false)
+    OPCODE_JUMP_IF_FALSE_F64,       // jumps like OPCODE_JUMP when a is 0.0
+    OPCODE_JUMP_IF_FALSE_STRING,    // jumps like OPCODE_JUMP when a is an empty string
+    OPCODE_JUMP_IF_TRUE_I64,        // jumps like OPCODE_JUMP when a is not 0, also used for functions
+    OPCODE_JUMP_IF_TRUE_F64,        // jumps like OPCODE_JUMP when a is not 0.0
+    OPCODE_JUMP_IF_TRUE_STRING,     // jumps like OPCODE_JUMP when a is not an empty string
+
+    OPCODE_CALL,                    // a = the function b, called with its arguments in the registers starting at c
+    OPCODE_RETURN,                  // returns a to the caller
+
+    // Superinstructions, only made by bytecode_optimize() out of the instructions above
+    OPCODE_ADD_I64_IMMEDIATE,       // a = b + immediate
+    OPCODE_MULTIPLY_I64_IMMEDIATE,  // a = b * immediate
+    OPCODE_JUMP_IF_LESS_I64,        // jumps like OPCODE_JUMP by short_offset when a < b
+    OPCODE_JUMP_IF_LESS_F64,
+    OPCODE_JUMP_IF_NOT_LESS_I64,    // jumps like OPCODE_JUMP by short_offset unless a < b
+    OPCODE_JUMP_IF_NOT_LESS_F64,
+    OPCODE_JUMP_IF_GREATER_I64,     // jumps like OPCODE_JUMP by short_offset when a > b
+    OPCODE_JUMP_IF_GREATER_F64,
+    OPCODE_JUMP_IF_NOT_GREATER_I64, // jumps like OPCODE_JUMP by short_offset unless a > b
+    OPCODE_JUMP_IF_NOT_GREATER_F64,
+
+    OPCODE_MAX_OPCODES
+} bytecode_opcode;
+
+/**
+ * @brief A single three-address instruction
+ */
+typedef struct bytecode_instruction {
+    /* The bytecode_opcode of the instruction */
+    u16 opcode;
+    /* The register written to (or read from, by OPCODE_SET_GLOBAL, the conditional jumps and OPCODE_RETURN) */
+    u16 a;
+
+    union {
+        /* The registers read from */
+        struct {
+            u16 b;
+
+            union {
+                u16 c;
+                /* The value an _IMMEDIATE superinstruction uses in place of the register c */
+                i16 immediate;
+                /* The distance of a compare and jump superinstruction, counted from the instruction after it */
+                i16 short_offset;
+            };
+        };
+        /* The index into the constant pool or the globals */
+        u32 index;
+        /* The distance of a jump, counted from the instruction after the jump */
+        i32 offset;
+    };
+} bytecode_instruction;
+
+/**
+ * @brief A value held in a register. Which member holds it is never stored with the value, the opcode of every
+ *        instruction using the register was picked from its static type
+ */
+typedef union bytecode_value {
+    /* The raw bits of the value */
+    u64 bits;
+    /* The value of a TYPE_INFO_INTEGER */
+    i64 integer;
+    /* The value of a TYPE_INFO_FLOAT */
+    f64 float64;
+    /* The value of a TYPE_INFO_STRING, a null terminated string interned by the context */
+    const char* string;
+    /* The value of a TYPE_INFO_FUNCTION, its index in the program's functions */
+    u64 function;
+} bytecode_value;
+
+/**
+ * @brief The bytecode of a single function
+ */
+typedef struct bytecode_function {
+    /* The instructions of the function, run from the first one until an OPCODE_RETURN */
+    bytecode_instruction* code;
+    /* The token each instruction was compiled from, only read to report the runtime errors of an instruction */
+    token* instruction_tokens;
+    /* The amount of instructions in code */
+    u64 code_length;
+    /* The amount of instructions code can hold */
+    u64 code_capacity;
+
+    /* The amount of registers the function uses, its parameters are the first ones */
+    u16 register_count;
+    /* The amount of parameters the function takes */
+    u16 parameter_count;
+    /* The type of the value the function returns */
+    type_info return_type;
+
+    /* The name the function was declared with (empty for the top level code of a file) */
+    token name;
+} bytecode_function;
+
+/**
+ * @brief A variable declared at the top level of a file
+ */
+typedef struct bytecode_global {
+    /* The name the variable was declared with */
+    token name;
+    /* The type of the variable */
+    type_info type;
+} bytecode_global;
+
+/**
+ * @brief The bytecode of a whole file
+ */
+typedef struct bytecode_program {
+    /* The functions of the file, the first one is the top level code of the file */
+    bytecode_function* functions;
+    /* The amount of functions */
+    u64 function_count;
+    /* The amount of functions the functions array can hold */
+    u64 function_capacity;
+
+    /* The constant pool, the values of the literals of every function */
+    bytecode_value* constants;
+    /* The type of each constant, so code outside of the vm (i.e. the native backend of roulxc) can tell which constants
+       point at strings. The zero value a function returns has TYPE_INFO_UNKNOWN */
+    type_info* constant_types;
+    /* The amount of constants */
+    u64 constant_count;
+    /* The amount of constants the constants array can hold */
+    u64 constant_capacity;
+
+    /* The variables declared at the top level of the file. They are the first registers of the top level code, the other
+       functions reach them through OPCODE_GET_GLOBAL and OPCODE_SET_GLOBAL */
+    bytecode_global* globals;
+    /* The amount of globals */
+    u64 global_count;
+    /* The amount of globals the globals array can hold */
+    u64 global_capacity;
+} bytecode_program;
+
+/**
+ * @brief frees the functions, constants and globals of a program and zeros the struct
+ *
+ * @param program the program to destroy
+ */
+API void bytecode_program_destroy(bytecode_program* program);
+
+
+/**
+ * @brief gives the name of an opcode, for printing bytecode and what a vm counted
+ *
+ * @param opcode the opcode to get the name of
+ * @return const char* the name of the opcode ("OPCODE_ADD_I64" for OPCODE_ADD_I64), "OPCODE_INVALID" if it is not one
+ */
+API const char* bytecode_opcode_name(bytecode_opcode opcode);
+
+/**
+ * @brief gives the operands an opcode reads and writes, and where an instruction with it can continue
+ * @note OPCODE_CALL also reads its arguments and overwrites every register from c on, which the flags leave out
+ *
+ * @param opcode the opcode to get the operands of
+ * @return u8 the BYTECODE_OPERAND_ flags of the opcode, 0 if it is not one
+ */
+API u8 bytecode_opcode_operands(bytecode_opcode opcode);
+
+/**
+ * @brief tells whether the registers an opcode reads and writes hold floats, so an instruction with it works on floats
+ *
+ * @param opcode the opcode to check
+ * @return b8 true for the _F64 opcodes, false otherwise
+ */
+API b8 bytecode_opcode_is_float(bytecode_opcode opcode);
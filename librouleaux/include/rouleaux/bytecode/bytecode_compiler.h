@@ -0,0 +1,19 @@
+#pragma once
+
+#include "defines.h"
+#include "bytecode/bytecode.h"
+#include "compiler/context.h"
+#include "ssa/ssa.h"
+
+/**
+ * @brief lowers the SSA form of a file into bytecode, every ssa_function becomes the bytecode_function with the same index
+ * @note each value is given a register no other value live at the same time holds, and a phi is given its value by moves
+ *       at the end of its predecessors (most of which need none, a value prefers its phi's register). The top level code
+ *       holds the globals in its first registers and reads them from there while nothing can write them
+ *
+ * @param context the context errors are reported to, it must outlive the program
+ * @param program a program made by ssa_build(), optimized by ssa_optimize() or not
+ * @param out_program where the program is written, it is released with bytecode_program_destroy() even if compiling fails
+ * @return b8 true if the program was compiled, false if an error was reported to the context
+ */
+API b8 bytecode_compile(rouleaux_context* context, const ssa_program* program, bytecode_program* out_program);
@@ -0,0 +1,17 @@
+#pragma once
+
+#include "defines.h"
+#include "bytecode/bytecode.h"
+
+/**
+ * @brief a peephole pass over the bytecode of every function of a program. Pairs of instructions which often run one
+ *        after the other are fused into a single superinstruction, and moves which are not needed are removed
+ * @note the fused pairs were picked from the opcode pairs a vm built with ROULX_VM_STATISTICS counted on the scripts of
+ *       benchmarks/ and examples/: a comparison and the conditional jump testing it, a constant loaded right before the
+ *       integer addition or multiplication using it, and a move out of the register an instruction just wrote
+ *
+ * @param program a program made by bytecode_compile(), it runs the same once optimized
+ * @return b8 true if the program was optimized, false if the memory the pass needs could not be allocated (the program
+ *         is left unchanged, and can still be run)
+ */
+API b8 bytecode_optimize(bytecode_program* program);
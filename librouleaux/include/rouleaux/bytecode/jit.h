@@ -0,0 +1,91 @@
+#pragma once
+
+#include "defines.h"
+#include "bytecode/bytecode.h"
+
+// The jit only writes x86-64 code. Everywhere else, and in any build with ROULX_VM_NO_JIT defined
+// (premake5 --vm-no-jit), jit_create() fails and the vm interprets everything
+#if (defined(__x86_64__) || defined(_M_X64)) && !defined(ROULX_VM_NO_JIT)
+#define ROULX_JIT_X86_64
+#endif
+
+// The amount of times a function is called by the interpreter before it is compiled to native code
+#define DEFAULT_JIT_CALL_THRESHOLD 100
+// The amount of times the interpreter jumps back to the start of a loop in a function before it is compiled to native code
+#define DEFAULT_JIT_BACK_EDGE_THRESHOLD 1000
+
+/**
+ * @brief The native code of a single bytecode_function, and how hot the function is while it is still interpreted
+ */
+typedef struct jit_function {
+    /* The native code of the function, NULL until the function is compiled */
+    u8* code;
+    /* The amount of bytes allocated for code */
+    u64 code_size;
+    /* The offset into code of the native code of each instruction, the native code can be entered at any of them */
+    u32* instruction_offsets;
+
+    /* The amount of times the interpreter called the function */
+    u32 call_count;
+    /* The amount of times the interpreter jumped back to the start of a loop in the function */
+    u32 back_edge_count;
+    /* Set when the function could not be compiled, it is never tried again */
+    b8 failed;
+} jit_function;
+
+/**
+ * @brief Compiles the hot functions of a program to native code. The native code works on the registers of the vm in
+ *        memory, so the vm can switch between it and the interpreter at any instruction
+ */
+typedef struct rouleaux_jit {
+    /* The program being compiled */
+    const bytecode_program* program;
+    /* The native code of each of the program's functions, indexed like program->functions */
+    jit_function* functions;
+
+    /* The amount of calls which makes a function hot */
+    u32 call_threshold;
+    /* The amount of loop iterations which makes a function hot */
+    u32 back_edge_threshold;
+} rouleaux_jit;
+
+/**
+ * @brief creates a jit for a program, none of its functions are compiled until they are hot
+ *
+ * @param out_jit where the jit is written, it is zeroed if creating it fails
+ * @param program the program to compile, it must outlive the jit
+ * @return b8 true if the jit was created, false if this platform has no jit or its memory could not be allocated
+ */
+API b8 jit_create(rouleaux_jit* out_jit, const bytecode_program* program);
+
+/**
+ * @brief frees the native code of every compiled function and zeros the struct
+ *
+ * @param jit the jit to destroy
+ */
+API void jit_destroy(rouleaux_jit* jit);
+
+/**
+ * @brief counts a call of a function, or a loop iteration in it, compiling the function once it gets hot
+ * @note only the interpreter counts, the native code does not
+ *
+ * @param jit the jit of the program
+ * @param function_index the index of the function in the program's functions
+ * @param is_call true to count a call, false to count a loop iteration
+ * @return b8 true if the function has native code to run
+ */
+API b8 jit_count(rouleaux_jit* jit, u64 function_index, b8 is_call);
+
+/**
+ * @brief runs the native code of a compiled function from an instruction, until it reaches an instruction it leaves to
+ *        the interpreter: a call, a return, a string condition, a float modulus, or an integer division which would fail
+ *        or overflow
+ *
+ * @param jit the jit of the program
+ * @param function_index the index of the compiled function in the program's functions
+ * @param instruction_index the index of the instruction to start at
+ * @param registers the registers of the call of the function being run
+ * @param globals the registers of the program's globals
+ * @return u64 the index of the instruction the interpreter continues at
+ */
+API u64 jit_run(rouleaux_jit* jit, u64 function_index, u64 instruction_index, bytecode_value* registers, bytecode_value* globals);
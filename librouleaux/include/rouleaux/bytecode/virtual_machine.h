@@ -0,0 +1,94 @@
+#pragma once
+
+#include "defines.h"
+#include "bytecode/bytecode.h"
+#include "compiler/context.h"
+
+// The default amount of registers shared by every call being run, the frames of the calls are windows into them
+#define DEFAULT_VM_REGISTER_COUNT (256 * 1024)
+// The default most calls which can be run at once
+#define DEFAULT_VM_CALL_DEPTH 4096
+
+/**
+ * @brief A call being run by the virtual machine
+ */
+typedef struct vm_frame {
+    /* The function being run */
+    const bytecode_function* function;
+    /* The next instruction to run once the function this frame called returns */
+    const bytecode_instruction* pc;
+    /* The first register of the function */
+    bytecode_value* registers;
+    /* The caller's register the function returns into (NULL for the top level code) */
+    bytecode_value* return_register;
+} vm_frame;
+
+/**
+ * @brief What a vm counts while it runs, only kept when librouleaux is built with ROULX_VM_STATISTICS defined
+ *        (premake5 --vm-statistics), counting slows every instruction down
+ */
+typedef struct vm_statistics {
+    /* The amount of times each bytecode_opcode was run, summed over every vm_run() */
+    u64 opcode_counts[OPCODE_MAX_OPCODES];
+    /* The amount of times each opcode (the second index) was run right after another (the first index), calls and returns
+       included. The most frequent pairs are the ones worth fusing into a single instruction */
+    u64 opcode_pair_counts[OPCODE_MAX_OPCODES][OPCODE_MAX_OPCODES];
+} vm_statistics;
+
+/**
+ * @brief Runs bytecode programs
+ */
+typedef struct rouleaux_vm {
+    /* The context runtime errors are reported to */
+    rouleaux_context* context;
+
+    /* The registers of every call being run. The registers of a call start at the first register of its arguments in the
+       caller, so arguments are never copied. After vm_run() the first registers hold the values of the globals */
+    bytecode_value* registers;
+    /* The amount of registers */
+    u64 register_count;
+
+    /* The calls being run, the first one is the top level code */
+    vm_frame* frames;
+    /* The most calls that can be run at once */
+    u64 frame_capacity;
+
+    /* What the vm counted while running, NULL unless librouleaux is built with ROULX_VM_STATISTICS. Instructions run as
+       native code are not counted, the jit is best turned off while counting */
+    vm_statistics* statistics;
+
+    /* True to compile the hot functions of a program to native code while running it, vm_create() sets it. Where there is
+       no jit (see bytecode/jit.h) everything is interpreted either way */
+    b8 use_jit;
+
+    /* Set when a runtime error was reported, or the registers could not be allocated */
+    b8 has_error;
+} rouleaux_vm;
+
+/**
+ * @brief Creates a virtual machine with DEFAULT_VM_REGISTER_COUNT registers and a DEFAULT_VM_CALL_DEPTH deep call stack
+ * @note the vm's has_error is set if its registers could not be allocated
+ *
+ * @param context the context runtime errors are reported to, it must outlive the vm
+ * @return rouleaux_vm the created vm
+ */
+API rouleaux_vm vm_create(rouleaux_context* context);
+
+/**
+ * @brief frees the registers and call stack of a vm and zeros the struct
+ *
+ * @param vm the vm to destroy
+ */
+API void vm_destroy(rouleaux_vm* vm);
+
+/**
+ * @brief runs the top level code of a program until it returns
+ * @note functions are interpreted until they are called or loop often enough to be compiled to native code, when use_jit
+ *       is set
+ * @note the values of the program's globals are left in the first program->global_count registers of the vm
+ *
+ * @param vm the vm to run the program on
+ * @param program a program made by bytecode_compile()
+ * @return b8 true if the program ran to the end, false if a runtime error was reported to the context
+ */
+API b8 vm_run(rouleaux_vm* vm, const bytecode_program* program);
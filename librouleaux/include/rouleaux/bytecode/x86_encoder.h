@@ -0,0 +1,158 @@
+#pragma once
+
+#include "defines.h"
+
+// The general purpose registers of x86-64
+#define X86_RAX 0
+#define X86_RCX 1
+#define X86_RDX 2
+#define X86_RBX 3
+#define X86_RSP 4
+#define X86_RBP 5
+#define X86_RSI 6
+#define X86_RDI 7
+#define X86_R8 8
+#define X86_R9 9
+#define X86_R10 10
+#define X86_R11 11
+#define X86_R12 12
+#define X86_R13 13
+#define X86_R14 14
+#define X86_R15 15
+#define X86_XMM0 0
+#define X86_XMM1 1
+
+// The REX prefix of a 64 bit operand, none is written for 0. The bits extending the reg and the r/m fields of ModRM to
+// the registers from r8 (and xmm8) on are added to it by the encoders as needed
+#define X86_REX_W 0x48
+#define X86_REX_R 0x44
+#define X86_REX_B 0x41
+
+// The opcodes of the instructions with an operand in memory, the 0x0F escape of the two byte ones is the high byte
+#define X86_MOV_LOAD 0x8B
+#define X86_MOV_STORE 0x89
+#define X86_LEA 0x8D
+#define X86_ADD_LOAD 0x03
+#define X86_SUB_LOAD 0x2B
+#define X86_CMP_LOAD 0x3B
+#define X86_IMUL_LOAD 0x0FAF
+#define X86_MOVSD_LOAD 0x0F10
+#define X86_MOVSD_STORE 0x0F11
+#define X86_ADDSD_LOAD 0x0F58
+#define X86_MULSD_LOAD 0x0F59
+#define X86_SUBSD_LOAD 0x0F5C
+#define X86_DIVSD_LOAD 0x0F5E
+#define X86_UCOMISD_LOAD 0x0F2E
+// The opcodes only used with two registers as operands, the first one is the reg field of ModRM
+#define X86_TEST 0x85
+#define X86_XOR 0x31
+#define X86_MOVAPD 0x0F28
+#define X86_XORPD 0x0F57
+#define X86_MOVQ_TO_XMM 0x0F6E
+#define X86_MOVQ_FROM_XMM 0x0F7E
+
+// The condition codes of jcc and setcc
+#define X86_CONDITION_BELOW 0x2
+#define X86_CONDITION_ABOVE_OR_EQUAL 0x3
+#define X86_CONDITION_PARITY 0xA
+#define X86_CONDITION_EQUAL 0x4
+#define X86_CONDITION_NOT_EQUAL 0x5
+#define X86_CONDITION_BELOW_OR_EQUAL 0x6
+#define X86_CONDITION_ABOVE 0x7
+#define X86_CONDITION_LESS 0xC
+#define X86_CONDITION_GREATER_OR_EQUAL 0xD
+#define X86_CONDITION_LESS_OR_EQUAL 0xE
+#define X86_CONDITION_GREATER 0xF
+// Not a condition code, x86_encode_jump() encodes a jmp for it
+#define X86_ALWAYS 0xFF
+
+// The most bytes a single instruction takes, the buffers given to the encoders hold at least this many
+#define X86_MAX_INSTRUCTION_BYTES 15
+
+/**
+ * @brief A rel32 whose value is written once the offset it points to is known
+ */
+typedef struct x86_patch {
+    /* The offset into the code of the 32 bit value */
+    u64 position;
+    /* What the value points to, the index of the instruction jumped to or of the function called */
+    u64 target;
+} x86_patch;
+
+/**
+ * @brief encodes an instruction with a register and a memory operand: [prefix] [REX] opcode ModRM disp8 or disp32
+ * @note base can be any register but rsp and r12, which would need a SIB byte
+ *
+ * @param out the buffer the instruction is written to
+ * @param prefix the legacy prefix (like 0xF2 of the scalar double instructions), 0 for none
+ * @param rex the REX prefix, 0 for none. REX.R and REX.B are added for the registers from r8 on
+ * @param opcode the opcode, a two byte one has the 0x0F escape as its high byte
+ * @param x86_register the register of the reg field of ModRM, or the opcode extension of a group opcode
+ * @param base the register the memory operand is addressed from
+ * @param displacement the offset of the memory operand from base, a disp8 is used when it fits
+ * @return u64 the amount of bytes written
+ */
+API u64 x86_encode_memory_operand(u8* out, u8 prefix, u8 rex, u16 opcode, u8 x86_register, u8 base, i32 displacement);
+
+/**
+ * @brief encodes an instruction with two registers as its operands: [prefix] [REX] opcode ModRM
+ *
+ * @param out the buffer the instruction is written to
+ * @param prefix the legacy prefix, 0 for none
+ * @param rex the REX prefix, 0 for none. REX.R and REX.B are added for the registers from r8 on
+ * @param opcode the opcode, a two byte one has the 0x0F escape as its high byte
+ * @param x86_register the register of the reg field of ModRM
+ * @param rm_register the register of the r/m field of ModRM
+ * @return u64 the amount of bytes written
+ */
+API u64 x86_encode_register_operand(u8* out, u8 prefix, u8 rex, u16 opcode, u8 x86_register, u8 rm_register);
+
+/**
+ * @brief encodes an instruction with a RIP relative memory operand: [prefix] [REX] opcode ModRM disp32
+ * @note the disp32 is written as 0, it is the last 4 bytes of the instruction and counted from the end of it
+ *
+ * @param out the buffer the instruction is written to
+ * @param prefix the legacy prefix, 0 for none
+ * @param rex the REX prefix, 0 for none. REX.R is added for the registers from r8 on
+ * @param opcode the opcode, a two byte one has the 0x0F escape as its high byte
+ * @param x86_register the register of the reg field of ModRM
+ * @return u64 the amount of bytes written
+ */
+API u64 x86_encode_rip_operand(u8* out, u8 prefix, u8 rex, u16 opcode, u8 x86_register);
+
+/**
+ * @brief encodes a jmp rel32, or a jcc rel32 for a condition code
+ * @note the rel32 is written as 0, it is the last 4 bytes of the jump. x86_relative_offset() gives its value
+ *
+ * @param out the buffer the jump is written to
+ * @param condition the condition code jumped on, X86_ALWAYS for a jmp
+ * @return u64 the amount of bytes written
+ */
+API u64 x86_encode_jump(u8* out, u8 condition);
+
+/**
+ * @brief encodes the 0 or 1 of a condition into eax: setcc al; movzx eax, al
+ *
+ * @param out the buffer the instructions are written to
+ * @param condition the condition code of the flags tested
+ * @return u64 the amount of bytes written
+ */
+API u64 x86_encode_set_condition(u8* out, u8 condition);
+
+/**
+ * @brief gives the rel32 of a jump or a call, which is counted from the end of the 32 bit value
+ *
+ * @param position the offset into the code of the 32 bit value
+ * @param target the offset into the same code of where it points to
+ * @return i32 the value of the rel32
+ */
+API i32 x86_relative_offset(u64 position, u64 target);
+
+/**
+ * @brief writes a little endian 32 bit value
+ *
+ * @param out the buffer the value is written to
+ * @param value the value
+ * @return u64 the amount of bytes written, always 4
+ */
+API u64 x86_write_u32(u8* out, u32 value);
@@ -0,0 +1,224 @@
+#pragma once
+
+#include "defines.h"
+#include "lexer/lexer.h"
+#include "parser/parser.h"
+#include "parser/node_arena.h"
+#include "typing/symbol_table.h"
+#include "utilities/error_report.h"
+#include "utilities/jobs.h"
+#include "utilities/line_index.h"
+#include "utilities/string_interner.h"
+
+// Forward declare
+struct ast_node;
+
+/**
+ * @brief How a rouleaux_context compiles the files given to it
+ */
+typedef struct rouleaux_context_options {
+    /* What the parsers created by the context do with comments */
+    comment_mode comment_mode;
+    /* The scheduler the parallel phases run on, it is borrowed and can be shared by many contexts. NULL runs everything on the calling thread */
+    rouleaux_jobs* jobs;
+    /* The size of each block of the context's node_arena, 0 uses DEFAULT_NODE_ARENA_BLOCK_SIZE */
+    u64 node_arena_block_size;
+    /* The least amount of bytes read at a time when compiling a stream, 0 uses DEFAULT_LEXER_STREAM_CHUNK_SIZE */
+    u64 stream_chunk_size;
+} rouleaux_context_options;
+
+/**
+ * @brief The content of a file read by a rouleaux_context, kept so diagnostics never have to read the file again
+ */
+typedef struct context_source {
+    /* The interned name of the file */
+    const char* filename;
+    /* The content of the file, owned by the context unless borrows_content is set */
+    char* content;
+    /* The length of the content in bytes */
+    u64 length;
+    /* True when the content belongs to the caller (see context_create_parser_from_buffer()), the context does not free it */
+    b8 borrows_content;
+    /* Where each line of the content starts, built the first time one of the source's diagnostics is rendered */
+    line_index lines;
+} context_source;
+
+/**
+ * @brief Everything a compilation needs that would otherwise be process-wide: the node memory, the interned strings,
+ *        the file contents, the diagnostics and the options
+ *
+ * A context is only ever used by one thread at a time, and contexts share nothing with each other (other than a jobs
+ * scheduler, which is thread-safe). So any amount of contexts can compile on different threads at once, without locks.
+ */
+typedef struct rouleaux_context {
+    /* How the context compiles */
+    rouleaux_context_options options;
+
+    /* The arena the ast_nodes of every parser created by the context are allocated from */
+    node_arena node_arena;
+    /* The strings interned by the context, the filenames of its sources are interned here */
+    string_interner interner;
+
+    /* The files read by the context */
+    context_source* sources;
+    /* The amount of sources held by the context */
+    u64 source_count;
+    /* The amount of sources the buffer can currently hold */
+    u64 source_capacity;
+
+    /* The errors reported during the compilation, in the order they were reported */
+    error_report* diagnostics;
+    /* The amount of diagnostics held by the context */
+    u64 diagnostic_count;
+    /* The amount of diagnostics the buffer can currently hold */
+    u64 diagnostic_capacity;
+} rouleaux_context;
+
+/**
+ * @brief Creates a rouleaux_context in place
+ * @note the parsers created by a context point into it, so it has to stay where it was created until it is destroyed
+ *
+ * @param context the context to initialize
+ * @param options how the context compiles
+ * @return b8 true if the context was created
+ */
+API b8 context_create(rouleaux_context* context, rouleaux_context_options options);
+
+/**
+ * @brief releases everything held by the context, the ast_nodes, interned strings and sources of the context become invalid
+ * @note every parser created by the context must be destroyed first
+ *
+ * @param context the context to release the resources of
+ */
+API void context_destroy(rouleaux_context* context);
+
+/**
+ * @brief gives the context's interned copy of a string
+ *
+ * @param context the context to operate on
+ * @param text the string to intern, it does not need to be null terminated
+ * @param length the length of the string in bytes
+ * @return const char* the null terminated interned copy, valid until the context is destroyed
+ */
+API const char* context_intern(rouleaux_context* context, const char* text, u64 length);
+
+/**
+ * @brief creates a parser for a file, the file is read into the context and the parser's ast_nodes are allocated from the context
+ * @note if the file cannot be read, an error is reported to the context and the parser's has_error is set
+ *
+ * @param context the context to operate on
+ * @param filename the name of the file to parse
+ * @return rouleaux_parser the parser for the file, it is still destroyed with parser_destroy()
+ */
+API rouleaux_parser context_create_parser(rouleaux_context* context, const char* filename);
+
+/**
+ * @brief creates a parser for a buffer already in memory, so compiling it never touches the filesystem
+ * @note the buffer is borrowed, not copied, it must outlive the context. The context's diagnostics render from it
+ *
+ * @param context the context to operate on
+ * @param name the name the buffer's diagnostics are given, like a filename (it does not need to exist on disk)
+ * @param buffer the content to parse, it does not need to be null terminated
+ * @param length the length of the buffer in bytes
+ * @return rouleaux_parser the parser for the buffer, it is still destroyed with parser_destroy()
+ */
+API rouleaux_parser context_create_parser_from_buffer(rouleaux_context* context, const char* name, const char* buffer, u64 length);
+
+/**
+ * @brief parses a whole file with the context's options, on the context's scheduler if it has one
+ *
+ * @param context the context to operate on
+ * @param parser a parser created with context_create_parser()
+ * @return struct ast_node* the AST_SCOPE of the file, NULL if the parse failed (the error is reported to the context)
+ */
+API struct ast_node* context_parse_file(rouleaux_context* context, rouleaux_parser* parser);
+
+/**
+ * @brief types a whole file with the context's options, on the context's scheduler if it has one
+ *
+ * @param context the context to operate on
+ * @param ast the AST_SCOPE of the file to type
+ * @param sym_table the table the top level symbols are added to
+ * @return b8 true if the file is well typed, false otherwise (the error is reported to the context)
+ */
+API b8 context_resolve_types(rouleaux_context* context, struct ast_node* ast, symbol_table* sym_table);
+
+/**
+ * @brief types only the parts of a file reachable from an entry point, see resolve_types_reachable()
+ *
+ * @param context the context to operate on
+ * @param ast the AST_SCOPE of the file to type
+ * @param sym_table the table the reached top level symbols are added to
+ * @param entry_point the name of the function to start from, NULL starts from the statements with side effects
+ * @return b8 true if the reached statements are well typed, false otherwise (the error is reported to the context)
+ */
+API b8 context_resolve_reachable_types(rouleaux_context* context, struct ast_node* ast, symbol_table* sym_table, const char* entry_point);
+
+/**
+ * @brief parses and types a stream one top level statement at a time, without ever holding all of it or its AST
+ *
+ * Each statement is typed as soon as it is parsed, then its nodes and the part of the stream it was lexed from are
+ * released. The symbols it declared are kept in the table in a compact form: their names are interned by the context,
+ * and functions only keep their signature (see symbol_table_detach()). So the memory used stays flat no matter how long
+ * the stream is, other than the symbol table itself.
+ *
+ * @note compiling stops at the first error. The context does not keep the content of a stream, so its diagnostics
+ *       are printed without the faulted line, unless the name is a file the line can be read back from (which is the
+ *       case for context_compile_file_streamed())
+ *
+ * @param context the context to operate on
+ * @param name the name the stream's diagnostics are given
+ * @param read the function which reads the stream
+ * @param user_data the pointer which will be passed to every call of read
+ * @param sym_table the table the symbols are added to
+ * @return b8 true if the whole stream parsed and typed, false otherwise (the error is reported to the context)
+ */
+API b8 context_compile_stream(rouleaux_context* context, const char* name, lexer_read_fptr read, void* user_data, symbol_table* sym_table);
+
+/**
+ * @brief the same as context_compile_stream(), for a file which is read a chunk at a time
+ *
+ * @param context the context to operate on
+ * @param filename the name of the file to compile
+ * @param sym_table the table the symbols are added to
+ * @return b8 true if the whole file parsed and typed, false otherwise (the error is reported to the context)
+ */
+API b8 context_compile_file_streamed(rouleaux_context* context, const char* filename, symbol_table* sym_table);
+
+/**
+ * @brief adds an error to the context's diagnostics
+ * @note the report's string arguments are interned by the context, so they do not need to outlive the report
+ *
+ * @param context the context to operate on
+ * @param report the error to add
+ */
+API void context_report_error(rouleaux_context* context, error_report report);
+
+/**
+ * @brief finds the content of a file read by the context
+ *
+ * @param context the context to search
+ * @param filename the name of the file
+ * @return const context_source* the source, NULL if the context never read the file
+ */
+API const context_source* context_find_source(rouleaux_context* context, const char* filename);
+
+/**
+ * @brief produces the printable text of one of the context's diagnostics, the faulted line comes from the context's sources
+ *
+ * @param context the context to operate on
+ * @param index the index of the diagnostic in context->diagnostics
+ * @param allocator the function pointer to a allocator which will provide a zero'ed out buffer (calloc is allowed)
+ * @return char* the null terminated string
+ */
+API char* context_diagnostic_text(rouleaux_context* context, u64 index, void*(allocator)(u64 count, u64 stride));
+
+/**
+ * @brief produces the printable text of every one of the context's diagnostics, in the order they were reported
+ * @note everything is rendered into a single buffer, and each source is only scanned for its lines once
+ *
+ * @param context the context to operate on
+ * @param allocator the function pointer to a allocator which will provide a zero'ed out buffer (calloc is allowed)
+ * @return char* the null terminated string, empty if there are no diagnostics
+ */
+API char* context_diagnostics_text(rouleaux_context* context, void*(allocator)(u64 count, u64 stride));
@@ -1,67 +1,74 @@
-#pragma once
-
-// Unsigned int types.
-typedef unsigned char u8;
-typedef unsigned short u16;
-typedef unsigned int u32;
-typedef unsigned long long u64;
-
-// Signed int types.
-typedef signed char i8;
-typedef signed short i16;
-typedef signed int i32;
-typedef signed long long i64;
-
-// Floating point types
-typedef float f32;
-typedef double f64;
-
-// Boolean types
-typedef int b32;
-typedef _Bool b8;
-
-#define NULL (void*)0
-
-
-#if defined(__clang__) || defined(__gcc__)
-#define STATIC_ASSERT _Static_assert
-#else
-#define STATIC_ASSERT static_assert
-#endif
-
-STATIC_ASSERT(sizeof(u8) == 1, "Expected u8 to be 1 byte.");
-STATIC_ASSERT(sizeof(u16) == 2, "Expected u16 to be 2 bytes.");
-STATIC_ASSERT(sizeof(u32) == 4, "Expected u32 to be 4 bytes.");
-STATIC_ASSERT(sizeof(u64) == 8, "Expected u64 to be 8 bytes.");
-STATIC_ASSERT(sizeof(i8) == 1, "Expected i8 to be 1 byte.");
-STATIC_ASSERT(sizeof(i16) == 2, "Expected i16 to be 2 bytes.");
-STATIC_ASSERT(sizeof(i32) == 4, "Expected i32 to be 4 bytes.");
-STATIC_ASSERT(sizeof(i64) == 8, "Expected i64 to be 8 bytes.");
-STATIC_ASSERT(sizeof(f32) == 4, "Expected f32 to be 4 bytes.");
-STATIC_ASSERT(sizeof(f64) == 8, "Expected f64 to be 8 bytes.");
-
-
-#define true 1
-#define false 0
-
-
-// Shared Library API definitions
-#ifdef ROULX_BUILD_DLL
-
-    // Exports
-    #ifdef _MSC_VER
-        #define API __declspec(dllexport)
-    #else
-        #define API __attribute__((visibility("default")))
-    #endif
-
-#else
-
-    // Imports
-    #ifdef _MSC_VER
-        #define API __declspec(dllimport)
-    #else
-        #define API
-    #endif
-
-#endif
+#pragma once
+
+// Unsigned int types.
+typedef unsigned char u8;
+typedef unsigned short u16;
+typedef unsigned int u32;
+typedef unsigned long long u64;
+
+// Signed int types.
+typedef signed char i8;
+typedef signed short i16;
+typedef signed int i32;
+typedef signed long long i64;
+
+// Floating point types
+typedef float f32;
+typedef double f64;
+
+// Boolean types
+typedef int b32;
+typedef _Bool b8;
+
+#define NULL (void*)0
+
+
+#if defined(__clang__) || defined(__gcc__)
+#define STATIC_ASSERT _Static_assert
+#else
+#define STATIC_ASSERT static_assert
+#endif
+
+// Marks a switch case that falls through into the next one on purpose
+#if defined(__clang__) || defined(__GNUC__)
+#define FALLTHROUGH __attribute__((fallthrough))
+#else
+#define FALLTHROUGH
+#endif
+
+STATIC_ASSERT(sizeof(u8) == 1, "Expected u8 to be 1 byte.");
+STATIC_ASSERT(sizeof(u16) == 2, "Expected u16 to be 2 bytes.");
+STATIC_ASSERT(sizeof(u32) == 4, "Expected u32 to be 4 bytes.");
+STATIC_ASSERT(sizeof(u64) == 8, "Expected u64 to be 8 bytes.");
+STATIC_ASSERT(sizeof(i8) == 1, "Expected i8 to be 1 byte.");
+STATIC_ASSERT(sizeof(i16) == 2, "Expected i16 to be 2 bytes.");
+STATIC_ASSERT(sizeof(i32) == 4, "Expected i32 to be 4 bytes.");
+STATIC_ASSERT(sizeof(i64) == 8, "Expected i64 to be 8 bytes.");
+STATIC_ASSERT(sizeof(f32) == 4, "Expected f32 to be 4 bytes.");
+STATIC_ASSERT(sizeof(f64) == 8, "Expected f64 to be 8 bytes.");
+
+
+#define true 1
+#define false 0
+
+
+// Shared Library API definitions
+#ifdef ROULX_BUILD_DLL
+
+    // Exports
+    #ifdef _MSC_VER
+        #define API __declspec(dllexport)
+    #else
+        #define API __attribute__((visibility("default")))
+    #endif
+
+#else
+
+    // Imports
+    #ifdef _MSC_VER
+        #define API __declspec(dllimport)
+    #else
+        #define API
+    #endif
+
+#endif
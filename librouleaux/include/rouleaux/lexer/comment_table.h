@@ -0,0 +1,85 @@
+#pragma once
+
+#include "defines.h"
+
+/**
+ * @brief A compact record of a comment the lexer skipped over
+ * @note The comment text can be found at file_content + offset in the lexer that recorded it
+ */
+typedef struct comment_entry {
+    /* The byte offset of the start of the comment from the start of the lexed buffer */
+    u64 offset;
+    /* The length of the comment text in bytes (including the comment delimiters) */
+    u32 length;
+    /* The row the comment starts on */
+    u32 row;
+} comment_entry;
+
+/**
+ * @brief A dynamic array of comment entries, sorted by offset
+ * Used by rouleaux_lexer to hold comments when it is in COMMENT_MODE_SIDE_TABLE
+ */
+typedef struct comment_table {
+    /* The buffer holding the entries */
+    comment_entry* entries;
+    /* The amount of entries currently held by the table */
+    u64 size;
+    /* The amount of entries the buffer can currently hold */
+    u64 capacity;
+} comment_table;
+
+/**
+ * @brief Creates a comment_table with a given initial capacity
+ *
+ * @param capacity the amount of entries the table should be able to initially hold
+ * @return comment_table the created table
+ */
+API comment_table comment_table_create(u64 capacity);
+
+/**
+ * @brief releases the internal memory of the given table
+ *
+ * @param table the table to be released
+ */
+API void comment_table_destroy(comment_table* table);
+
+/**
+ * @brief Empties the table of all entries
+ *
+ * @param table the table to empty
+ */
+API void comment_table_empty(comment_table* table);
+
+/**
+ * @brief appends a comment to the back of the table
+ * @note entries must be pushed in increasing offset order, which is the order the lexer finds them in
+ *
+ * @param table the table to be pushed to
+ * @param offset the byte offset of the comment in the lexed buffer
+ * @param length the length of the comment in bytes
+ * @param row the row the comment starts on
+ * @return b8 true if the entry was successfully added to the table
+ */
+API b8 comment_table_push(comment_table* table, u64 offset, u64 length, u64 row);
+
+/**
+ * @brief finds the first comment which starts at or after the given offset
+ *
+ * @param table the table to search
+ * @param offset the byte offset to search from
+ * @return u64 the index of the found entry, or table->size if there is no such comment
+ */
+API u64 comment_table_lower_bound(comment_table* table, u64 offset);
+
+/**
+ * @brief replaces a range of the table's entries with other entries, moving the entries after the range as needed
+ * @note the table must stay sorted by offset, so the new entries must fit between the ones around the range
+ *
+ * @param table the table to operate on
+ * @param first the index of the first entry to replace
+ * @param count the amount of entries to replace
+ * @param entries the entries to put in their place
+ * @param entry_count the amount of entries to put in their place
+ * @return b8 true if the entries were replaced, false if the range is out of bounds or the table failed to grow
+ */
+API b8 comment_table_replace(comment_table* table, u64 first, u64 count, const comment_entry* entries, u64 entry_count);
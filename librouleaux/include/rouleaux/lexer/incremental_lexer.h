@@ -0,0 +1,81 @@
+#pragma once
+
+#include "defines.h"
+#include "lexer/lexer.h"
+#include "lexer/token_array.h"
+
+/**
+ * @brief A change to the text of a buffer: length bytes at offset are replaced by the inserted text
+ */
+typedef struct text_edit {
+    /* The byte offset in the buffer where the edit starts */
+    u64 offset;
+    /* The amount of bytes removed from the buffer at offset */
+    u64 removed_length;
+    /* The text inserted at offset, it is copied into the buffer */
+    const char* inserted_text;
+    /* The length of the inserted text in bytes */
+    u64 inserted_length;
+} text_edit;
+
+/**
+ * @brief Describes how a token stream changed after lexer_apply_edit()
+ *
+ * The tokens before first_token are untouched, removed_token_count tokens starting at first_token were replaced by
+ * inserted_token_count re-lexed tokens, and every token after those is the same token as before, moved by the edit.
+ */
+typedef struct token_edit {
+    /* The index of the first token which was re-lexed */
+    u64 first_token;
+    /* The amount of tokens of the old stream which were replaced */
+    u64 removed_token_count;
+    /* The amount of re-lexed tokens which replaced them */
+    u64 inserted_token_count;
+    /* The amount of bytes the tokens after the edit moved by */
+    i64 byte_delta;
+    /* The amount of rows the tokens after the edit moved by */
+    i64 row_delta;
+
+    /* The buffer the old tokens point into, it may have been freed so it is only ever compared against */
+    const char* old_content;
+    /* The length of the old buffer in bytes */
+    u64 old_length;
+    /* The buffer the tokens point into after the edit */
+    const char* new_content;
+    /* The byte offset in the old buffer where re-lexing started, the tokens before it did not change */
+    u64 relexed_offset;
+    /* The byte offset in the old buffer of the first token that was kept after the re-lexed run */
+    u64 kept_offset;
+    /* The row (in the old buffer) of the first token that was kept, the tokens on that row also moved sideways */
+    u64 kept_row;
+    /* The amount of columns the tokens on kept_row moved by */
+    i64 column_delta;
+} token_edit;
+
+/**
+ * @brief applies an edit to the lexer's buffer, and re-lexes only the tokens around it
+ *
+ * Lexing restarts at the token before the edit, and stops as soon as a re-lexed token starts where a token of the old
+ * stream (past the edit) has moved to. From there on the old tokens are kept, with their text, rows and columns moved
+ * by the edit. Comments in the lexer's comment_table are updated the same way.
+ *
+ * @note the tokens must be the complete stream of the lexer's buffer (as produced by lexer_tokenize()), and the lexer
+ *       must be done lexing it. A borrowed buffer is copied the first time it is edited, the lexer owns the copy
+ *
+ * @param lexer the lexer whose buffer is edited
+ * @param tokens the token stream of the buffer, it is updated in place
+ * @param edit the edit to apply
+ * @param out_change where the description of the change is written, can be NULL
+ * @return b8 true if the edit was applied, false if it is out of the buffer's bounds or an allocation failed
+ *         (a lexing error is reported through the lexer's has_error, and the stream ends at the TOKEN_INVALID)
+ */
+API b8 lexer_apply_edit(rouleaux_lexer* lexer, token_array* tokens, text_edit edit, token_edit* out_change);
+
+/**
+ * @brief moves a token lexed from the buffer before an edit (such as a copy held by an ast_node) to where it is after the edit
+ *
+ * @param change the change lexer_apply_edit() described
+ * @param t the token to move
+ * @return b8 true if the token was moved (or did not need to), false if the token was re-lexed and no longer exists as it was
+ */
+API b8 token_edit_move_token(const token_edit* change, token* t);
@@ -1,81 +1,263 @@
-#pragma once
-
-#include "defines.h"
-#include "lexer/token.h"
-#include "lexer/peek_queue.h"
-
-
-typedef struct rouleaux_lexer {
-    /* The name of the file being lexed by this lexer */
-    const char* filename;
-    /* The buffer holding the content of the file being lexed by this lexer */
-    char* file_content;
-    /* The length of the file_content buffer in bytes */
-    u64 file_content_length;
-    /* The pointer to the end of the file_content buffer */
-    char* file_end;
-
-    /* The current point in the file_content the lexer is reading from */
-    char* head;
-
-    /* A FIFO queue of already lexed tokens */
-    peek_queue peek_buffer;
-
-    /* The current row the lexer is lexing from */
-    u64 current_row;
-    /* The current column the lexer is lexing from */
-    u64 current_column;
-
-    /* a boolean which is set to true when the lexer is in an invalid state */
-    b8 has_error;
-} rouleaux_lexer;
-
-/**
- * @brief Creates a lexer from a given filename
- * 
- * @note the lexer's has_error feild will be set to true if creation fails
- * 
- * @param filename the name of the file to lex
- * @return rouleaux_lexer a lexer of the given file
- */
-API rouleaux_lexer lexer_create(const char* filename);
-
-/**
- * @brief frees any allocated memory a lexer is holding and zeros the struct
- * 
- * @param lexer the lexer to release the resources of
- */
-API void lexer_destroy(rouleaux_lexer* lexer);
-
-/**
- * @brief resets a lexer to the state it was in just after its initial creation
- * 
- * @param lexer the lexer to reset
- * @return b8 true if the lexer is in a valid state, false otherwise
- */
-API b8 lexer_reset(rouleaux_lexer* lexer);
-
-/**
- * @brief returns the next token in the file (will pull from the peek_queue first if a token is present there)
- * 
- * @param lexer the lexer to get the next token from
- * @return token the next token in the stream
- */
-API token lexer_next_token(rouleaux_lexer* lexer);
-
-/**
- * @brief parses the next token and returns it, but adds it to a buffer for the next time lexer_next_token() is called
- * 
- * @param lexer the lexer to get the token from
- * @return token the next token the lexer will return from lexer_next_token()
- */
-API token lexer_peek_token(rouleaux_lexer* lexer);
-
-/**
- * @brief puts the given token at the front of the peek_queue
- * 
- * @param lexer the lexer to put the token into
- * @param t the token to put back
- * @return b8 true if the operation was successful, false otherwise
- */
-API b8 lexer_put_back_token(rouleaux_lexer* lexer, token t);
+#pragma once
+
+#include "defines.h"
+#include "lexer/token.h"
+#include "lexer/peek_queue.h"
+#include "lexer/comment_table.h"
+#include "lexer/token_array.h"
+#include "lexer/token_ring.h"
+
+// The most characters the lexer reads past the end of a token to decide where it ends ('.' and a digit after an integer)
+#define LEXER_MAX_LOOKAHEAD 2
+
+// The default amount of bytes a lexer reads from its stream at a time
+#define DEFAULT_LEXER_STREAM_CHUNK_SIZE (64 * 1024)
+
+/**
+ * @brief Reads the next bytes of a stream, like fread()
+ *
+ * @param user_data the pointer given to lexer_create_from_stream()
+ * @param buffer where the bytes are written
+ * @param capacity the most bytes that can be written to buffer
+ * @return u64 the amount of bytes written, 0 at the end of the stream
+ */
+typedef u64 (*lexer_read_fptr)(void* user_data, char* buffer, u64 capacity);
+
+/**
+ * @brief A window of a stream the lexer moved on from
+ */
+typedef struct lexer_stream_window {
+    /* The bytes of the window */
+    char* content;
+    /* The position in the stream of the first byte of the window */
+    u64 offset;
+    /* The amount of bytes in the window */
+    u64 length;
+} lexer_stream_window;
+
+/**
+ * @brief The state of a lexer which reads its input from a stream, one window of it at a time
+ */
+typedef struct lexer_stream {
+    /* The function which reads the next bytes of the stream */
+    lexer_read_fptr read;
+    /* The pointer passed along to read */
+    void* user_data;
+    /* The least amount of bytes read into a new window */
+    u64 chunk_size;
+    /* True once read reported the end of the stream */
+    b8 done;
+
+    /* The position in the stream of the first byte of the lexer's file_content */
+    u64 window_offset;
+    /* Nothing before this point of the window is referenced anymore, so it is not carried over into the next window */
+    char* keep;
+
+    /* The windows the lexer moved on from, the tokens lexed from them stay valid until lexer_release_stream() */
+    lexer_stream_window* retired_windows;
+    /* The amount of windows in retired_windows */
+    u64 retired_window_count;
+    /* The amount of windows retired_windows can hold */
+    u64 retired_window_capacity;
+} lexer_stream;
+
+/**
+ * @brief Controls what the lexer does with the comments it finds
+ */
+typedef enum comment_mode {
+    COMMENT_MODE_TOKENS = 0,    // Comments are returned as TOKEN_LINE_COMMENT and TOKEN_BLOCK_COMMENT tokens (the default)
+    COMMENT_MODE_DISCARD,       // Comments are skipped over and never returned
+    COMMENT_MODE_SIDE_TABLE,    // Comments are skipped over, but recorded in the lexer's comment_table
+} comment_mode;
+
+typedef struct rouleaux_lexer {
+    /* The name of the file being lexed by this lexer */
+    const char* filename;
+    /* The buffer holding the content of the file being lexed by this lexer */
+    char* file_content;
+    /* The length of the file_content buffer in bytes */
+    u64 file_content_length;
+    /* The amount of bytes allocated for the file_content buffer, edits can grow the content up to this size in place */
+    u64 file_content_capacity;
+    /* The pointer to the end of the file_content buffer */
+    char* file_end;
+    /* True when the file_content buffer is owned by someone else, lexer_destroy() leaves it alone */
+    b8 borrows_file_content;
+
+    /* The current point in the file_content the lexer is reading from */
+    char* head;
+
+    /* A FIFO queue of already lexed tokens */
+    peek_queue peek_buffer;
+
+    /* The current row the lexer is lexing from */
+    u64 current_row;
+    /* The current column the lexer is lexing from */
+    u64 current_column;
+
+    /* What the lexer does with the comments it finds */
+    comment_mode comment_mode;
+    /* The comments the lexer skipped over, only populated in COMMENT_MODE_SIDE_TABLE */
+    comment_table comments;
+
+    /* When set, the lexer returns these already lexed tokens instead of lexing file_content */
+    const token* replay_tokens;
+    /* The amount of tokens in replay_tokens */
+    u64 replay_token_count;
+    /* The index of the next token in replay_tokens to be returned */
+    u64 replay_position;
+
+    /* When set, the lexer pops its tokens off this ring, which another thread is lexing into */
+    token_ring* token_ring;
+
+    /* When set, file_content only holds a window of the input, which is read from this stream as the lexer needs it */
+    lexer_stream* stream;
+
+    /* a boolean which is set to true when the lexer is in an invalid state */
+    b8 has_error;
+} rouleaux_lexer;
+
+/**
+ * @brief Creates a lexer from a given filename
+ * 
+ * @note the lexer's has_error feild will be set to true if creation fails
+ * 
+ * @param filename the name of the file to lex
+ * @return rouleaux_lexer a lexer of the given file
+ */
+API rouleaux_lexer lexer_create(const char* filename);
+
+/**
+ * @brief Creates a lexer which replays an already lexed token stream instead of lexing a file
+ * @note the tokens are borrowed, they must outlive the lexer. Once they run out the lexer returns TOKEN_EOF
+ *
+ * @param tokens the tokens to replay
+ * @param token_count the amount of tokens to replay
+ * @param filename the name of the file the tokens were lexed from
+ * @return rouleaux_lexer a lexer of the given tokens
+ */
+API rouleaux_lexer lexer_create_from_tokens(const token* tokens, u64 token_count, const char* filename);
+
+/**
+ * @brief Creates a lexer of a buffer already in memory, without reading any file
+ * @note the buffer is borrowed, not copied, so it must outlive the lexer and everything made from its tokens.
+ *       The lexer never writes to it and never reads past length, so it does not need to be null terminated
+ *
+ * @param buffer the content to lex
+ * @param length the length of the buffer in bytes
+ * @param name the name the tokens' locations are given, like a filename (it does not need to exist on disk)
+ * @return rouleaux_lexer a lexer of the buffer
+ */
+API rouleaux_lexer lexer_create_from_buffer(const char* buffer, u64 length, const char* name);
+
+/**
+ * @brief Creates a lexer which reads its input from a stream, so only a window of the input is held in memory at once
+ *
+ * Whenever a token could run past the end of the window, the lexer reads more of the stream into a new window,
+ * carrying over everything from the point given by the last lexer_release_stream(). Tokens keep pointing into the
+ * window they were lexed from, the old windows are only freed by lexer_release_stream().
+ *
+ * @note comments can be returned as tokens or discarded, COMMENT_MODE_SIDE_TABLE does not record the comments of a stream
+ *
+ * @param filename the name the tokens' locations are given
+ * @param read the function which reads the stream
+ * @param user_data the pointer which will be passed to every call of read
+ * @param chunk_size the least amount of bytes to read at a time, 0 uses DEFAULT_LEXER_STREAM_CHUNK_SIZE
+ * @return rouleaux_lexer a lexer of the stream, its has_error is set if creation fails
+ */
+API rouleaux_lexer lexer_create_from_stream(const char* filename, lexer_read_fptr read, void* user_data, u64 chunk_size);
+
+/**
+ * @brief tells a streaming lexer that the tokens it returned so far are not used anymore (the peeked ones still are)
+ * @note the windows those tokens were lexed from are freed, and nothing before the first peeked token is carried over into
+ *       the next window. Lexers without a stream are left alone
+ *
+ * @param lexer the lexer to operate on
+ */
+API void lexer_release_stream(rouleaux_lexer* lexer);
+
+/**
+ * @brief frees any allocated memory a lexer is holding and zeros the struct
+ * 
+ * @param lexer the lexer to release the resources of
+ */
+API void lexer_destroy(rouleaux_lexer* lexer);
+
+/**
+ * @brief resets a lexer to the state it was in just after its initial creation
+ * 
+ * @param lexer the lexer to reset
+ * @return b8 true if the lexer is in a valid state, false otherwise
+ */
+API b8 lexer_reset(rouleaux_lexer* lexer);
+
+/**
+ * @brief returns the next token in the file (will pull from the peek_queue first if a token is present there)
+ * 
+ * @param lexer the lexer to get the next token from
+ * @return token the next token in the stream
+ */
+API token lexer_next_token(rouleaux_lexer* lexer);
+
+/**
+ * @brief parses the next token and returns it, but adds it to a buffer for the next time lexer_next_token() is called
+ * 
+ * @param lexer the lexer to get the token from
+ * @return token the next token the lexer will return from lexer_next_token()
+ */
+API token lexer_peek_token(rouleaux_lexer* lexer);
+
+/**
+ * @brief puts the given token at the front of the peek_queue
+ * 
+ * @param lexer the lexer to put the token into
+ * @param t the token to put back
+ * @return b8 true if the operation was successful, false otherwise
+ */
+API b8 lexer_put_back_token(rouleaux_lexer* lexer, token t);
+
+/**
+ * @brief gives a position in the token stream which the lexer can later be rewound to with lexer_rewind()
+ * @note only lexers reading from a token_ring support checkpoints, and only while no tokens are put back
+ *
+ * @param lexer the lexer to operate on
+ * @param out_checkpoint where the checkpoint is written
+ * @return b8 true if a checkpoint was made, false if the lexer cannot make one right now
+ */
+API b8 lexer_checkpoint(rouleaux_lexer* lexer, u64* out_checkpoint);
+
+/**
+ * @brief rewinds the lexer to a checkpoint, the tokens after it will be returned again
+ *
+ * @param lexer the lexer to operate on
+ * @param checkpoint a checkpoint from lexer_checkpoint()
+ * @return b8 true if the lexer was rewound, false if the checkpoint is further back than the token_ring's look back
+ */
+API b8 lexer_rewind(rouleaux_lexer* lexer, u64 checkpoint);
+
+/**
+ * @brief lexes every remaining token (including any peeked ones) into a token_array
+ * @note lexing stops after the TOKEN_EOF token, or after a TOKEN_INVALID token if the lexer encounters an error
+ *
+ * @param lexer the lexer to drain
+ * @param out_tokens the array the tokens are appended to
+ * @return b8 true if all the tokens were added, false if the array failed to grow
+ */
+API b8 lexer_tokenize(rouleaux_lexer* lexer, token_array* out_tokens);
+
+/**
+ * @brief sets what the lexer should do with the comments it finds from this point on
+ *
+ * @param lexer the lexer to operate on
+ * @param mode the comment_mode to use
+ */
+API void lexer_set_comment_mode(rouleaux_lexer* lexer, comment_mode mode);
+
+/**
+ * @brief rebuilds the comment token of an entry in the lexer's comment_table
+ *
+ * @param lexer the lexer which recorded the comment
+ * @param index the index of the entry in lexer->comments
+ * @return token the comment token, as it would have been returned in COMMENT_MODE_TOKENS
+ */
+API token lexer_comment_token(rouleaux_lexer* lexer, u64 index);
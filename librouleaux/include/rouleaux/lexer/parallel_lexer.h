@@ -0,0 +1,24 @@
+#pragma once
+
+#include "defines.h"
+#include "lexer/lexer.h"
+#include "lexer/token_array.h"
+#include "utilities/jobs.h"
+
+/**
+ * @brief lexes the whole file like lexer_tokenize(), but splits the buffer into chunks which are lexed as jobs on a scheduler
+ *
+ * Every chunk starts on a line boundary and is lexed speculatively, as if it did not begin inside a block comment
+ * or string literal. The chunks are then stitched together in order, a chunk whose speculative start turns out
+ * to be wrong is re-lexed from the true start of its first token, but only until its tokens line back up with
+ * the speculative ones.
+ *
+ * @note the lexer must not have lexed anything yet. Small files are lexed on the calling thread.
+ * @note comments are handled according to the lexer's comment_mode, exactly as lexer_tokenize() would
+ *
+ * @param lexer the lexer of the file to lex, it is drained by this call
+ * @param jobs the scheduler to lex on (the calling thread helps), NULL lexes on the calling thread
+ * @param out_tokens the array the tokens are appended to
+ * @return b8 true if all the tokens were added, false if an allocation failed
+ */
+API b8 lexer_tokenize_parallel(rouleaux_lexer* lexer, rouleaux_jobs* jobs, token_array* out_tokens);
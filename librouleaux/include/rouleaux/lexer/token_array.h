@@ -0,0 +1,61 @@
+#pragma once
+
+#include "defines.h"
+#include "lexer/token.h"
+
+/**
+ * @brief A dynamic array of tokens, used to hold an already lexed token stream
+ */
+typedef struct token_array {
+    /* The buffer holding the tokens */
+    token* tokens;
+    /* The amount of tokens currently held by the array */
+    u64 size;
+    /* The amount of tokens the buffer can currently hold */
+    u64 capacity;
+} token_array;
+
+/**
+ * @brief Creates a token_array with a given initial capacity
+ *
+ * @param capacity the amount of tokens the array should be able to initially hold
+ * @return token_array the created array
+ */
+API token_array token_array_create(u64 capacity);
+
+/**
+ * @brief releases the internal memory of the given array
+ *
+ * @param array the array to be released
+ */
+API void token_array_destroy(token_array* array);
+
+/**
+ * @brief pushes a token onto the back of the array
+ *
+ * @param array the array to be pushed to
+ * @param t the token to be copied into the array
+ * @return b8 true if the token was successfully added to the array
+ */
+API b8 token_array_push(token_array* array, token t);
+
+/**
+ * @brief makes sure the array can hold at least the given amount of tokens without reallocating
+ *
+ * @param array the array to operate on
+ * @param capacity the amount of tokens the array needs to be able to hold
+ * @return b8 true if the array can hold that many tokens, false if the allocation failed
+ */
+API b8 token_array_reserve(token_array* array, u64 capacity);
+
+/**
+ * @brief replaces a range of the array's tokens with other tokens, moving the tokens after the range as needed
+ *
+ * @param array the array to operate on
+ * @param first the index of the first token to replace
+ * @param count the amount of tokens to replace
+ * @param tokens the tokens to put in their place
+ * @param token_count the amount of tokens to put in their place
+ * @return b8 true if the tokens were replaced, false if the range is out of bounds or the array failed to grow
+ */
+API b8 token_array_replace(token_array* array, u64 first, u64 count, const token* tokens, u64 token_count);
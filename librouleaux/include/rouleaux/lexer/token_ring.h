@@ -0,0 +1,131 @@
+#pragma once
+
+#include "defines.h"
+#include "lexer/token.h"
+
+#include <stdatomic.h>
+
+// The default amount of tokens a token_ring can hold before the producer has to wait on the consumer
+#define DEFAULT_TOKEN_RING_CAPACITY 4096
+// The default amount of already read tokens a token_ring keeps around for put-back and checkpoints
+#define DEFAULT_TOKEN_RING_LOOK_BACK 64
+
+// Keeps the producer's and the consumer's indices on separate cache lines
+#define TOKEN_RING_CACHE_LINE_SIZE 64
+
+/**
+ * @brief A bounded, lock-free, single-producer/single-consumer queue of tokens
+ *
+ * One thread (the producer) pushes tokens while another thread (the consumer) pops them. The consumer
+ * can step back over the last look_back tokens it popped, the producer never overwrites those.
+ */
+typedef struct token_ring {
+    /* The slots of the ring */
+    token* tokens;
+    /* The amount of slots in the ring, always a power of two */
+    u64 capacity;
+    /* The amount of already read tokens the producer must leave alone */
+    u64 look_back;
+
+    /* The amount of tokens the producer has published, written by the producer only */
+    _Alignas(TOKEN_RING_CACHE_LINE_SIZE) _Atomic u64 write_index;
+    /* The producer's last look at released_index, so it only touches the consumer's cache line when the ring looks full */
+    u64 cached_released_index;
+
+    /* Every slot below this index can be overwritten by the producer, written by the consumer only */
+    _Alignas(TOKEN_RING_CACHE_LINE_SIZE) _Atomic u64 released_index;
+    /* The index of the next token the consumer will read */
+    u64 read_index;
+    /* The consumer's last look at write_index, so it only touches the producer's cache line when the ring looks empty */
+    u64 cached_write_index;
+
+    /* Set by the producer once it has pushed its last token */
+    _Alignas(TOKEN_RING_CACHE_LINE_SIZE) _Atomic b8 closed;
+    /* Set by the consumer when it stops reading early, it stops the producer from waiting on a full ring */
+    _Atomic b8 cancelled;
+} token_ring;
+
+/**
+ * @brief Creates a token_ring in place
+ * @note a token_ring cannot be copied, it has to stay where it was created until it is destroyed
+ *
+ * @param ring the ring to initialize
+ * @param capacity the amount of tokens the ring can hold (rounded up to a power of two), 0 uses DEFAULT_TOKEN_RING_CAPACITY
+ * @param look_back the amount of read tokens the consumer can step back over, 0 uses DEFAULT_TOKEN_RING_LOOK_BACK
+ * @return b8 true if the ring was created, false if the allocation failed
+ */
+API b8 token_ring_create(token_ring* ring, u64 capacity, u64 look_back);
+
+/**
+ * @brief releases the slots of a token_ring, neither thread may be using it anymore
+ *
+ * @param ring the ring to release the resources of
+ */
+API void token_ring_destroy(token_ring* ring);
+
+/**
+ * @brief (producer) pushes a token onto the ring, waiting while the ring is full
+ *
+ * @param ring the ring to push to
+ * @param t the token to push
+ * @return b8 true if the token was pushed, false if the consumer cancelled the ring
+ */
+API b8 token_ring_push(token_ring* ring, token t);
+
+/**
+ * @brief (producer) marks that no more tokens will be pushed
+ *
+ * @param ring the ring to close
+ */
+API void token_ring_close(token_ring* ring);
+
+/**
+ * @brief (consumer) pops the next token off the ring, waiting while the ring is empty
+ *
+ * @param ring the ring to pop from
+ * @param out_token where the token is written. Once the ring is closed and drained, this is the last token that was pushed
+ * @return b8 true if a token was popped, false if the ring is closed and drained
+ */
+API b8 token_ring_pop(token_ring* ring, token* out_token);
+
+/**
+ * @brief (consumer) gets the next token without popping it, waiting while the ring is empty
+ *
+ * @param ring the ring to peek into
+ * @param out_token where the token is written. Once the ring is closed and drained, this is the last token that was pushed
+ * @return b8 true if there is a next token, false if the ring is closed and drained
+ */
+API b8 token_ring_peek(token_ring* ring, token* out_token);
+
+/**
+ * @brief (consumer) un-pops the last popped token, if it is the given token
+ *
+ * @param ring the ring to operate on
+ * @param t the token being put back
+ * @return b8 true if the ring stepped back over t, false if t is not the last popped token or it is out of the look back
+ */
+API b8 token_ring_put_back(token_ring* ring, token t);
+
+/**
+ * @brief (consumer) gives the current read position of the ring, to return to with token_ring_rewind()
+ *
+ * @param ring the ring to operate on
+ * @return u64 the checkpoint
+ */
+API u64 token_ring_checkpoint(token_ring* ring);
+
+/**
+ * @brief (consumer) steps the ring back to a checkpoint, so the tokens after it are popped again
+ *
+ * @param ring the ring to operate on
+ * @param checkpoint a checkpoint from token_ring_checkpoint()
+ * @return b8 true if the ring was rewound, false if the checkpoint is further back than the ring's look_back
+ */
+API b8 token_ring_rewind(token_ring* ring, u64 checkpoint);
+
+/**
+ * @brief (consumer) stops the ring early, a producer waiting on a full ring gives up instead
+ *
+ * @param ring the ring to cancel
+ */
+API void token_ring_cancel(token_ring* ring);
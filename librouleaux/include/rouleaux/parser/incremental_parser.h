@@ -0,0 +1,60 @@
+#pragma once
+
+#include "defines.h"
+#include "lexer/incremental_lexer.h"
+#include "lexer/token_array.h"
+#include "parser/parser.h"
+#include "parser/node_arena.h"
+#include "parser/statement_table.h"
+
+/**
+ * @brief Keeps the AST of a buffer up to date while the buffer is edited, by re-parsing only the statements around each edit
+ *
+ * Every statement (top level or nested in a scope) is recorded by the index of its first token. After an edit, a statement
+ * whose tokens (and the tokens the parser peeked at past it) all survived the edit is reused as is, so only the statements
+ * enclosing the edit are parsed again, and the file's AST_SCOPE is rebuilt from the rest.
+ */
+typedef struct incremental_parse {
+    /* The token stream of the parser's buffer, the statements are parsed by replaying it */
+    token_array tokens;
+    /* The statements of the earlier parses, by the index of their first token */
+    statement_table statements;
+    /* Holds every node of the AST, reused statements keep their nodes where they are */
+    node_arena arena;
+    /* The amount of bytes the arena held after the last full parse */
+    u64 full_parse_bytes;
+    /* Identifies the arena, every full parse takes a new id (never 0). While the id stays the same, a node of the AST at an
+       address is the node which was there before, with the same tokens, so a reused statement can be told apart by its address */
+    u64 arena_id;
+    /* The AST of the last successful parse, NULL if no parse succeeded yet. It is owned by the incremental_parse */
+    ast_node* ast;
+} incremental_parse;
+
+/**
+ * @brief lexes the parser's whole file and parses it, keeping what is needed to re-parse it after edits
+ * @note the parser must not have lexed or parsed anything yet, only its lexer is used from now on
+ *
+ * @param parse the incremental_parse to create
+ * @param parser the parser of the file
+ * @return parse_result the result of the parse, on success the tree is parse->ast and must not be destroyed by the caller
+ */
+API parse_result incremental_parse_create(incremental_parse* parse, rouleaux_parser* parser);
+
+/**
+ * @brief releases the AST, the statements and the tokens of an incremental_parse
+ *
+ * @param parse the incremental_parse to release
+ */
+API void incremental_parse_destroy(incremental_parse* parse);
+
+/**
+ * @brief applies an edit to the parser's buffer (see lexer_apply_edit()) and re-parses the statements it touched
+ * @note if the parse fails, parse->ast is left as the AST of the last successful parse, with its nodes moved along
+ *       with the edited buffer. The statements around a failed edit are re-parsed again by the next edit
+ *
+ * @param parse the incremental_parse to update
+ * @param parser the parser the incremental_parse was created with
+ * @param edit the edit to apply
+ * @return parse_result the result of the parse, on success the tree is parse->ast and must not be destroyed by the caller
+ */
+API parse_result incremental_parse_apply_edit(incremental_parse* parse, rouleaux_parser* parser, text_edit edit);
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "defines.h"
+
+#define DEFAULT_NODE_ARENA_BLOCK_SIZE (64 * 1024)
+
+// Forward declare
+struct node_arena_block;
+
+/**
+ * @brief A bump allocator for ast_nodes.
+ * Memory is handed out from large blocks and is only ever given back all at once,
+ * so individual nodes allocated from an arena are never deallocated.
+ */
+typedef struct node_arena {
+    /* The block currently being allocated from, it links to the previously filled blocks */
+    struct node_arena_block* current_block;
+
+    /* The size in bytes of each block the arena allocates */
+    u64 block_size;
+
+    /* The total amount of bytes handed out by the arena */
+    u64 bytes_allocated;
+} node_arena;
+
+/**
+ * @brief Creates an empty node_arena, no memory is allocated until the first allocation
+ *
+ * @param block_size the size of each block the arena will allocate (0 will use DEFAULT_NODE_ARENA_BLOCK_SIZE)
+ * @return node_arena the created arena
+ */
+API node_arena node_arena_create(u64 block_size);
+
+/**
+ * @brief releases every block held by the arena, invalidating all memory allocated from it
+ *
+ * @param arena the arena to release
+ */
+API void node_arena_destroy(node_arena* arena);
+
+/**
+ * @brief gives back every allocation made from the arena at once, invalidating all memory allocated from it
+ * @note the newest block is kept for the allocations to come, so an arena that is reset over and over stops allocating
+ *
+ * @param arena the arena to reset
+ */
+API void node_arena_reset(node_arena* arena);
+
+/**
+ * @brief allocates a block of memory from the arena
+ *
+ * @param arena the arena to allocate from
+ * @param size_in_bytes the size of the block of memory
+ * @return void* a pointer to the block, or NULL if the arena failed to allocate more memory
+ */
+API void* node_arena_allocate(node_arena* arena, u64 size_in_bytes);
+
+/**
+ * @brief calls a function on every allocation made from an arena
+ * @note every allocation made from the arena must have been of the given size, as nothing records where allocations start
+ *
+ * @param arena the arena to walk
+ * @param size_in_bytes the size every allocation of the arena was made with
+ * @param function the function to call with each allocation
+ * @param user_data the pointer which will be passed to every call of the function
+ */
+API void node_arena_for_each(node_arena* arena, u64 size_in_bytes, void (*function)(void* allocation, void* user_data), void* user_data);
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "defines.h"
+#include "parser/parser.h"
+#include "utilities/jobs.h"
+
+/**
+ * @brief parses the whole file like parser_parse_file(), but parses the top level statements as jobs on a scheduler
+ *
+ * The file is lexed up front (see lexer_tokenize_parallel()), then split into chunks at top level ';' and '}' boundaries. Each chunk is
+ * parsed by a worker into that worker's own node_arena, and the results are merged in file order
+ * into the file's AST_SCOPE. The arenas are owned by the parser and released by parser_destroy().
+ *
+ * @note if any chunk fails to parse, the file is re-parsed on the calling thread so the error reported is
+ *       exactly the one parser_parse_file() would have reported
+ *
+ * @param parser the parser to operate on, it must not have parsed anything yet
+ * @param jobs the scheduler to parse on (the calling thread helps), NULL parses on the calling thread
+ * @return parse_result the result of the parse
+ */
+API parse_result parser_parse_file_parallel(rouleaux_parser* parser, rouleaux_jobs* jobs);
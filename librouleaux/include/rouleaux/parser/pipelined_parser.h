@@ -0,0 +1,19 @@
+#pragma once
+
+#include "defines.h"
+#include "parser/parser.h"
+
+/**
+ * @brief parses the whole file like parser_parse_file(), but lexes it on a second thread at the same time
+ *
+ * A lexer thread pushes its tokens into a bounded, lock-free token_ring while the calling thread parses them,
+ * so lexing overlaps with parsing. The tokens (and so their locations) are exactly the ones the parser's own
+ * lexer would have produced. Once the parse is done, the parser's lexer is left as if it had lexed the file itself.
+ *
+ * @note put-back tokens step the ring back instead of going through the peek_queue, see token_ring_put_back()
+ *
+ * @param parser the parser to operate on, it must not have parsed anything yet
+ * @param ring_capacity the amount of tokens the lexer thread can get ahead of the parser, 0 uses DEFAULT_TOKEN_RING_CAPACITY
+ * @return parse_result the result of the parse
+ */
+API parse_result parser_parse_file_pipelined(rouleaux_parser* parser, u64 ring_capacity);
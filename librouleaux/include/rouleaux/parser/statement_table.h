@@ -0,0 +1,111 @@
+#pragma once
+
+#include "defines.h"
+
+// Forward declare
+struct ast_node;
+
+/**
+ * @brief The statement which was parsed starting at a token
+ */
+typedef struct statement_entry {
+    /* The statement's node, NULL if no statement starts at this token */
+    struct ast_node* node;
+    /* The amount of tokens the statement was parsed from */
+    u64 token_count;
+    /* The amount of tokens past the end of the statement the parser peeked at while parsing it */
+    u32 lookahead_count;
+    /* The parse the entry was last recorded or reused in */
+    u32 generation;
+} statement_entry;
+
+/**
+ * @brief Records the statements parsed from a token stream by the index of their first token, at every nesting level,
+ *        so a later parse of the (edited) stream can reuse the statements whose tokens did not change
+ */
+typedef struct statement_table {
+    /* One entry per token of the stream */
+    statement_entry* entries;
+    /* The amount of entries */
+    u64 size;
+    /* The amount of entries the buffer can hold */
+    u64 capacity;
+
+    /* True when tokens changed since the last successful parse */
+    b8 is_damaged;
+    /* The index of the first token which changed since the last successful parse */
+    u64 damaged_first;
+    /* One past the index of the last token which changed since the last successful parse */
+    u64 damaged_end;
+
+    /* The current parse, entries from earlier parses inside of a re-parsed statement are stale */
+    u32 generation;
+
+    /* The amount of statements reused in the current parse */
+    u64 reused_count;
+    /* The amount of statements parsed in the current parse */
+    u64 parsed_count;
+} statement_table;
+
+/**
+ * @brief Creates an empty statement_table for a token stream
+ *
+ * @param token_count the amount of tokens in the stream
+ * @return statement_table the created table, its entries are NULL if the allocation failed
+ */
+API statement_table statement_table_create(u64 token_count);
+
+/**
+ * @brief releases the entries of the table, the nodes are left alone
+ *
+ * @param table the table to release
+ */
+API void statement_table_destroy(statement_table* table);
+
+/**
+ * @brief matches the table to a token stream in which count tokens at first were replaced by new_count tokens
+ * @note the statements touching the replaced tokens (or peeking at them) are not reused until a parse succeeds
+ *
+ * @param table the table to operate on
+ * @param first the index of the first replaced token
+ * @param count the amount of tokens which were replaced
+ * @param new_count the amount of tokens which replaced them
+ * @return b8 true if the table was updated, false if the range is out of bounds or the table failed to grow
+ */
+API b8 statement_table_replace(statement_table* table, u64 first, u64 count, u64 new_count);
+
+/**
+ * @brief starts a new parse of the token stream
+ *
+ * @param table the table to operate on
+ */
+API void statement_table_begin_parse(statement_table* table);
+
+/**
+ * @brief ends the current parse, a successful parse recorded every statement around the damaged tokens again
+ *
+ * @param table the table to operate on
+ * @param success true if the parse succeeded
+ */
+API void statement_table_end_parse(statement_table* table, b8 success);
+
+/**
+ * @brief gives the statement starting at a token, if it was parsed from tokens that did not change since
+ *
+ * @param table the table to search
+ * @param first_token the index of the token the statement would start at
+ * @param out_token_count where the amount of tokens the statement spans is written
+ * @return struct ast_node* the statement's node, NULL if there is no statement which can be reused
+ */
+API struct ast_node* statement_table_reuse(statement_table* table, u64 first_token, u64* out_token_count);
+
+/**
+ * @brief records a statement which was just parsed, and forgets the stale statements inside of it
+ *
+ * @param table the table to operate on
+ * @param first_token the index of the statement's first token
+ * @param token_count the amount of tokens the statement was parsed from
+ * @param lookahead_count the amount of tokens after the statement the parser peeked at
+ * @param node the statement's node
+ */
+API void statement_table_record(statement_table* table, u64 first_token, u64 token_count, u64 lookahead_count, struct ast_node* node);
@@ -1,12 +1,40 @@
-#include "defines.h"
-
-// Parser Includes
-#include "lexer/lexer.h"
-#include "parser/parser.h"
-#include "parser/parser_allocators.h"
-#include "utilities/error_report.h"
-
-// Typing Includes
-#include "typing/type_info.h"
-#include "typing/symbol_table.h"
-
+#include "defines.h"
+
+// Compiler Includes
+#include "compiler/context.h"
+
+// Parser Includes
+#include "lexer/lexer.h"
+#include "lexer/parallel_lexer.h"
+#include "lexer/incremental_lexer.h"
+#include "parser/parser.h"
+#include "parser/parallel_parser.h"
+#include "parser/pipelined_parser.h"
+#include "parser/incremental_parser.h"
+#include "parser/parser_allocators.h"
+#include "utilities/error_report.h"
+#include "utilities/executable_memory.h"
+#include "utilities/jobs.h"
+#include "utilities/line_index.h"
+#include "utilities/string_interner.h"
+
+// Typing Includes
+#include "typing/type_info.h"
+#include "typing/symbol_table.h"
+#include "typing/parallel_typing.h"
+#include "typing/incremental_typing.h"
+#include "typing/reachable_typing.h"
+
+// SSA Includes
+#include "ssa/ssa.h"
+#include "ssa/ssa_builder.h"
+#include "ssa/ssa_optimizer.h"
+
+// Bytecode Includes
+#include "bytecode/bytecode.h"
+#include "bytecode/bytecode_compiler.h"
+#include "bytecode/bytecode_optimizer.h"
+#include "bytecode/jit.h"
+#include "bytecode/x86_encoder.h"
+#include "bytecode/virtual_machine.h"
+
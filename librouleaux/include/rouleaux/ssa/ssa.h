@@ -0,0 +1,231 @@
+#pragma once
+
+#include "defines.h"
+#include "lexer/token.h"
+#include "typing/type_info.h"
+
+// Refers to no instruction (or no block), i.e. the condition of a block which does not branch
+#define SSA_NONE 0xFFFFFFFF
+
+/**
+ * @brief The operations of the SSA form. Every instruction defines at most one value, which is referred to by the index of
+ *        the instruction in its function. The operands of an instruction are the values it reads
+ */
+typedef enum ssa_opcode {
+    SSA_OPCODE_INVALID = 0,
+
+    SSA_OPCODE_CONSTANT,        // the constant of the instruction
+    SSA_OPCODE_PARAMETER,       // the parameter at index, only found in the first block of a function
+    SSA_OPCODE_PHI,             // operand i when the block was entered from its predecessor i, only found in a block's phis
+
+    SSA_OPCODE_ADD,             // operand 0 + operand 1, both of the type of the instruction
+    SSA_OPCODE_SUBTRACT,        // operand 0 - operand 1
+    SSA_OPCODE_MULTIPLY,        // operand 0 * operand 1
+    SSA_OPCODE_DIVIDE,          // operand 0 / operand 1, an integer division by zero is a runtime error
+    SSA_OPCODE_MODULUS,         // operand 0 % operand 1, an integer division by zero is a runtime error
+    SSA_OPCODE_GREATER_THAN,    // operand 0 > operand 1, 1 or 0 (1.0 or 0.0 for floats)
+    SSA_OPCODE_LESS_THAN,       // operand 0 < operand 1, 1 or 0 (1.0 or 0.0 for floats)
+
+    SSA_OPCODE_LOAD_GLOBAL,     // the global at index
+    SSA_OPCODE_STORE_GLOBAL,    // the global at index = operand 0, defines no value
+    SSA_OPCODE_CALL,            // calls the function operand 0 with the other operands as its arguments
+
+    SSA_MAX_OPCODES
+} ssa_opcode;
+
+/**
+ * @brief How a block ends, which decides the blocks that can run after it
+ */
+typedef enum ssa_terminator {
+    SSA_TERMINATOR_JUMP = 0,    // continues at successor 0
+    SSA_TERMINATOR_BRANCH,      // continues at successor 0 when the condition is true, at successor 1 otherwise
+    SSA_TERMINATOR_RETURN,      // returns the zero value from the function, the language has no return statement yet
+
+    MAX_SSA_TERMINATORS
+} ssa_terminator;
+
+/**
+ * @brief The value of a constant, which member holds it is given by the type of its instruction
+ */
+typedef union ssa_constant {
+    /* The raw bits of the value */
+    u64 bits;
+    /* The value of a TYPE_INFO_INTEGER */
+    i64 integer;
+    /* The value of a TYPE_INFO_FLOAT */
+    f64 float64;
+    /* The value of a TYPE_INFO_STRING, a null terminated string interned by the context */
+    const char* string;
+    /* The value of a TYPE_INFO_FUNCTION, its index in the program's functions */
+    u64 function;
+} ssa_constant;
+
+/**
+ * @brief A single operation, and the value it defines
+ */
+typedef struct ssa_instruction {
+    /* The ssa_opcode of the instruction */
+    u8 opcode;
+    /* The type of the value it defines, and of the operands of an arithmetic operation or comparison */
+    type_info type;
+
+    /* The block the instruction is in */
+    u32 block;
+    /* The index of the first operand in the function's operands, the others follow it */
+    u32 first_operand;
+    /* The amount of operands */
+    u32 operand_count;
+
+    union {
+        /* The value of an SSA_OPCODE_CONSTANT */
+        ssa_constant constant;
+        /* The global of an SSA_OPCODE_LOAD_GLOBAL or SSA_OPCODE_STORE_GLOBAL, the parameter of an SSA_OPCODE_PARAMETER */
+        u64 index;
+    };
+
+    /* The token the instruction was built from, the one its runtime errors point at */
+    token t;
+} ssa_instruction;
+
+/**
+ * @brief A sequence of instructions which is only entered at its start and only left at its end
+ */
+typedef struct ssa_block {
+    /* The phis of the block, they all take their value when the block is entered */
+    u32* phis;
+    /* The amount of phis */
+    u32 phi_count;
+    /* The amount of phis the phis array can hold */
+    u32 phi_capacity;
+
+    /* The instructions of the block, run in order after its phis */
+    u32* instructions;
+    /* The amount of instructions */
+    u32 instruction_count;
+    /* The amount of instructions the instructions array can hold */
+    u32 instruction_capacity;
+
+    /* The blocks which continue at this one, in the order of the operands of the phis */
+    u32* predecessors;
+    /* The amount of predecessors */
+    u32 predecessor_count;
+    /* The amount of predecessors the predecessors array can hold */
+    u32 predecessor_capacity;
+
+    /* How the block ends */
+    ssa_terminator terminator;
+    /* The value tested by an SSA_TERMINATOR_BRANCH, SSA_NONE for the other terminators */
+    u32 condition;
+    /* The blocks the terminator continues at, SSA_NONE when it does not use them */
+    u32 successors[2];
+    /* The token of the statement the terminator was built from */
+    token t;
+
+    /* The amount of while statements the block is in */
+    u32 loop_depth;
+} ssa_block;
+
+/**
+ * @brief The SSA form of a single function
+ * @note a block only ever branches to blocks with a single predecessor, so the moves of the phis of a block can always be
+ *       put at the end of its predecessors
+ */
+typedef struct ssa_function {
+    /* The instructions of the function, in no particular order. The blocks give their order */
+    ssa_instruction* instructions;
+    /* The amount of instructions */
+    u32 instruction_count;
+    /* The amount of instructions the instructions array can hold */
+    u32 instruction_capacity;
+
+    /* The operands of every instruction */
+    u32* operands;
+    /* The amount of operands */
+    u32 operand_count;
+    /* The amount of operands the operands array can hold */
+    u32 operand_capacity;
+
+    /* The blocks of the function, in the order their code is laid out in. The first one is where the function starts,
+       it is never continued at by another block */
+    ssa_block* blocks;
+    /* The amount of blocks */
+    u32 block_count;
+    /* The amount of blocks the blocks array can hold */
+    u32 block_capacity;
+
+    /* The amount of parameters the function takes */
+    u16 parameter_count;
+    /* The type of the value the function returns */
+    type_info return_type;
+
+    /* The name the function was declared with (empty for the top level code of a file) */
+    token name;
+} ssa_function;
+
+/**
+ * @brief A variable declared at the top level of a file
+ */
+typedef struct ssa_global {
+    /* The name the variable was declared with */
+    token name;
+    /* The type of the variable */
+    type_info type;
+    /* For a constant declared with a function declaration the index of that function in the program's functions, which
+       is then the only function the constant can be (once it was declared). 0 for every other global */
+    u64 constant_function;
+} ssa_global;
+
+/**
+ * @brief The SSA form of a whole file
+ */
+typedef struct ssa_program {
+    /* The functions of the file, the first one is the top level code of the file */
+    ssa_function* functions;
+    /* The amount of functions */
+    u64 function_count;
+    /* The amount of functions the functions array can hold */
+    u64 function_capacity;
+
+    /* The variables declared at the top level of the file, every function reads and writes them through
+       SSA_OPCODE_LOAD_GLOBAL and SSA_OPCODE_STORE_GLOBAL. They are zero until they are stored to */
+    ssa_global* globals;
+    /* The amount of globals */
+    u64 global_count;
+    /* The amount of globals the globals array can hold */
+    u64 global_capacity;
+} ssa_program;
+
+/**
+ * @brief frees the functions and globals of a program and zeros the struct
+ *
+ * @param program the program to destroy
+ */
+API void ssa_program_destroy(ssa_program* program);
+
+/**
+ * @brief gives the operands of an instruction
+ *
+ * @param function the function the instruction is in
+ * @param instruction the index of the instruction
+ * @return u32* the instruction's operand_count operands
+ */
+API u32* ssa_operands(const ssa_function* function, u32 instruction);
+
+/**
+ * @brief gives the amount of successors a block continues at
+ *
+ * @param block the block
+ * @return u32 2 for a branch, 1 for a jump and 0 for a return
+ */
+API u32 ssa_successor_count(const ssa_block* block);
+
+/**
+ * @brief orders the blocks reachable from the first block of a function in reverse postorder, where every block comes
+ *        after the blocks dominating it
+ *
+ * @param function the function
+ * @param out_order where the order is written, it must hold block_count blocks
+ * @return u32 the amount of blocks in the order, SSA_NONE if the memory the search needs could not be allocated
+ */
+API u32 ssa_reverse_postorder(const ssa_function* function, u32* out_order);
+
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "defines.h"
+#include "ssa/ssa.h"
+#include "compiler/context.h"
+
+// Forward declare
+struct ast_node;
+
+/**
+ * @brief builds the SSA form of a typed file, every function declaration in it becomes an ssa_function. The variables of a
+ *        function become values, joined by phis where an if or while statement joins paths setting them differently
+ * @note the file must have been typed without errors, by resolve_types() (or any of its variants) when entry_point is NULL,
+ *       or by resolve_types_reachable() with the same entry point otherwise. String literals are interned in the context.
+ *       A global read or written in a while statement which calls no function that could see it is a value of the loop as
+ *       well, loaded before the loop and stored after it
+ *
+ * @param context the context errors are reported to and string literals are interned in, it must outlive the program
+ * @param file the AST_SCOPE of the file
+ * @param entry_point NULL to run every top level statement in order, otherwise the name of a function without parameters.
+ *                    Only the top level declarations resolve_types_reachable() typed are run, then the function is called
+ * @param out_program where the program is written, it is released with ssa_program_destroy() even if building it fails
+ * @return b8 true if the program was built, false if an error was reported to the context
+ */
+API b8 ssa_build(rouleaux_context* context, struct ast_node* file, const char* entry_point, ssa_program* out_program);
@@ -0,0 +1,17 @@
+#pragma once
+
+#include "defines.h"
+#include "ssa/ssa.h"
+
+/**
+ * @brief optimizes every function of a program, the code every backend is made from is optimized once here
+ * @note runs global value numbering, which also gives a load the value last stored to (or loaded from) its global, then
+ *       sparse conditional constant propagation, global value numbering again for what the constants made equal, and
+ *       dead code elimination. The folded operations behave exactly like the vm's: the integer arithmetic wraps around,
+ *       dividing by -1 never traps and a division by zero is never folded, so it still reports its error when it runs
+ *
+ * @param program a program made by ssa_build(), it runs the same once optimized
+ * @return b8 true if the program was optimized, false if the memory the passes need could not be allocated (the program
+ *         is left correct but not fully optimized, and can still be lowered)
+ */
+API b8 ssa_optimize(ssa_program* program);
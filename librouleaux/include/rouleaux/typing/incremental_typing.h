@@ -0,0 +1,101 @@
+#pragma once
+
+#include "defines.h"
+#include "typing/type_info.h"
+#include "typing/symbol_table.h"
+#include "utilities/string_interner.h"
+
+// Forward declare
+struct ast_node;
+struct typing_memo;
+struct incremental_parse;
+
+/**
+ * @brief Remembers how every top level statement of a file was typed, so the next typing of the file can skip the
+ *        statements that did not change
+ *
+ * Every memo is keyed on a hash of its statement's tokens (their types and text, not their locations), and records
+ * the symbols the statement looked up (with a signature of what they were), the symbols it declared and the
+ * typing_information of all of its nodes. A statement is only re-typed when no memo of it exists, or when one of
+ * the symbols it depends on changed. Its dependents then miss their memos in turn.
+ *
+ * The memos also remember the statement they were last applied to. When the AST comes from an incremental_parse, a
+ * statement the parse reused is that same node, so its memo is found by the node's address without walking it again.
+ */
+typedef struct typing_cache {
+    /* The memos of the last typing, in source order */
+    struct typing_memo* memos;
+    /* The amount of memos held by the cache */
+    u64 memo_count;
+
+    /* An open addressed hash table of indices into memos (offset by 1, so 0 is an empty slot), keyed on the statement hashes */
+    u64* buckets;
+    /* The amount of slots in buckets, always a power of two */
+    u64 bucket_capacity;
+
+    /* An open addressed hash table of indices into memos (offset by 1, so 0 is an empty slot), keyed on the address of
+       the statement each memo was last applied to */
+    u64* statement_buckets;
+    /* The amount of slots in statement_buckets, always a power of two */
+    u64 statement_bucket_capacity;
+    /* The arena_id of the incremental_parse the statements of the memos are in, 0 when they are not known to be alive */
+    u64 arena_id;
+
+    /* True when the memos cover every statement of the last typing in source order, which lets the next typing only
+       re-validate the dependencies on symbols that changed. Otherwise every dependency of every memo is re-validated */
+    b8 memos_in_order;
+
+    /* The names of the symbols the memos depend on, they outlive the files they were read from */
+    string_interner names;
+
+    /* The amount of statements that were typed by the last call to resolve_types_incremental() */
+    u64 checked_count;
+    /* The amount of statements that were taken from their memos by the last call to resolve_types_incremental() */
+    u64 reused_count;
+} typing_cache;
+
+/**
+ * @brief creates an empty typing_cache
+ *
+ * @return typing_cache the created cache
+ */
+API typing_cache typing_cache_create();
+
+/**
+ * @brief releases every memo held by the cache
+ *
+ * @param cache the cache to release the resources of
+ */
+API void typing_cache_destroy(typing_cache* cache);
+
+/**
+ * @brief types a whole file exactly like resolve_types_parallel(), but takes the unchanged top level statements from the cache
+ *
+ * The statements taken from the cache get the typing_information they had when they were typed, and their symbols are
+ * added to sym_table as if they had been typed again. The cache is then updated with the memos of this file. Like in
+ * resolve_types_parallel(), each function body is typed in its own scope, so its parameters and locals stay out of sym_table.
+ *
+ * @note the memos are matched by content, so the AST can be a freshly parsed one (from an edited buffer) each time
+ *
+ * @param cache the cache of the previous typings of the file
+ * @param ast the AST_SCOPE of the file to type
+ * @param sym_table the table the symbols are added to, it must hold the same symbols each time (a fresh table)
+ * @return typing_result the result of typing the file
+ */
+API typing_result resolve_types_incremental(typing_cache* cache, struct ast_node* ast, symbol_table* sym_table);
+
+/**
+ * @brief types the AST of an incremental_parse like resolve_types_incremental(), but skips the statements the parse reused
+ *
+ * A statement the parse reused since the last typing is the node the cache already has a memo of, so only the symbols
+ * it depends on are checked and its symbols added to sym_table. Its nodes are neither walked nor typed again, which
+ * keeps re-typing after an edit proportional to the statements the edit touched.
+ *
+ * @note the same cache can be used with other ASTs in between, the statements are then matched by content again
+ *
+ * @param cache the cache of the previous typings of the file
+ * @param parse the incremental_parse whose AST to type, nothing is typed if it never parsed successfully
+ * @param sym_table the table the symbols are added to, it must hold the same symbols each time (a fresh table)
+ * @return typing_result the result of typing the file
+ */
+API typing_result resolve_types_incremental_parse(typing_cache* cache, struct incremental_parse* parse, symbol_table* sym_table);
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "defines.h"
+#include "typing/type_info.h"
+#include "typing/symbol_table.h"
+#include "utilities/jobs.h"
+
+/**
+ * @brief types a whole file like resolve_types(), but types the bodies of the functions as jobs on a scheduler
+ *
+ * Typing happens in two phases. The first walks the file on the calling thread, typing everything but the
+ * function bodies into sym_table, which is frozen once the phase is done. The second types every function
+ * body on the scheduler's workers, each body in its own scoped table that only sees the symbols declared before
+ * the function. The error reported is the first one in source order, no matter which thread found it.
+ *
+ * @note unlike resolve_types(), the parameters and locals of a function are not added to sym_table
+ *
+ * @param ast the AST_SCOPE of the file to type
+ * @param sym_table the table the top level symbols are added to
+ * @param jobs the scheduler to type on (the calling thread helps), NULL types on the calling thread
+ * @return typing_result the result of typing the file
+ */
+API typing_result resolve_types_parallel(struct ast_node* ast, symbol_table* sym_table, rouleaux_jobs* jobs);
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "defines.h"
+#include "typing/type_info.h"
+#include "typing/symbol_table.h"
+
+// Forward declare
+struct ast_node;
+
+/**
+ * @brief types only the top level statements of a file that can be reached from an entry point
+ *
+ * The entry point is either a named function, or (when entry_point is NULL) every top level statement with a side
+ * effect: anything that is not a plain declaration, and declarations whose value calls a function. From there, every
+ * identifier and call site is followed to the top level statement declaring it, the first time it is referenced.
+ * The reached statements are then typed in source order, exactly like resolve_types_parallel() would type them: the
+ * top level symbols go into sym_table, and each function body is typed in its own scope. The rest of the file is never
+ * typed, and is left without typing_information.
+ *
+ * @param ast the AST_SCOPE of the file to type
+ * @param sym_table the table the symbols of the reached statements are added to
+ * @param entry_point the name of the function to start from, NULL starts from the statements with side effects
+ * @return typing_result the result of typing the reached statements
+ */
+API typing_result resolve_types_reachable(struct ast_node* ast, symbol_table* sym_table, const char* entry_point);
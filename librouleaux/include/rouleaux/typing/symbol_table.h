@@ -1,74 +1,118 @@
-#pragma once
-
-#include "defines.h"
-#include "lexer/token.h"
-#include "typing/type_info.h"
-
-// Forward declare
-struct ast_node;
-
-/**
- * @brief A struct of non-owning pointers to
- * 
- */
-typedef struct symbol {
-    /* The token of symbol (used for getting the name) */
-    token t;
-
-    /* The type of the symbol */
-    type_info type;
-
-    /* True if the symbol was declared as a constant, false otherwise */
-    b8 is_constant;
-
-    /* If the type of this symbol is a function. This pointer will be set to the function declaration node that the declaration of this symbol had */
-    struct ast_node* function_decl_node;
-} symbol;
-
-
-//
-// TODO(Steven): This should be a hash table... but for simplicity we made it a list that is iterated over
-//
-/**
- * @brief a dynamic array of symbols to be searched through
- * 
- */
-typedef struct symbol_table {
-    symbol* buffer;
-    u64 size;
-    u64 capacity;
-} symbol_table;
-
-/**
- * @brief creates a symbol_table
- * 
- * @return symbol_table the created table
- */
-API symbol_table symbol_table_create();
-
-/**
- * @brief destroys a symbol_table
- * 
- * @param table the table to destroy
- */
-API void symbol_table_destroy(symbol_table* table);
-
-/**
- * @brief Adds a symbol to the table with the given token and type_info
- * 
- * @param table the table to add to
- * @param t the token to set the new symbol with
- * @param type the type info to set the new symbol with
- * @param is_constant the flag which denotes if the symbol is constant
- * @return b8 true of the symbol was added, false otherwise
- */
-API b8 symbol_table_add(symbol_table* table, token t, type_info type, b8 is_constant);
-
-/**
- * @brief finds a symbol in the table
- * 
- * @param table the table to search in
- * @param t the token to search for
- * @return symbol* the non_owning pointer to the symbol in the table, NULL if it could not be found
- */
-API symbol* symbol_table_find(symbol_table* table, token t);
+#pragma once
+
+#include "defines.h"
+#include "lexer/token.h"
+#include "typing/type_info.h"
+#include "utilities/string_interner.h"
+
+// Forward declare
+struct ast_node;
+
+/**
+ * @brief What a call to a function needs to know about it, without its declaration's nodes
+ */
+typedef struct function_signature {
+    /* The type of each parameter, in order */
+    type_info* parameter_types;
+    /* The amount of parameters */
+    u64 parameter_count;
+    /* The type the function returns */
+    type_info return_type;
+} function_signature;
+
+/**
+ * @brief A struct of non-owning pointers to
+ * 
+ */
+typedef struct symbol {
+    /* The token of symbol (used for getting the name) */
+    token t;
+
+    /* The type of the symbol */
+    type_info type;
+
+    /* True if the symbol was declared as a constant, false otherwise */
+    b8 is_constant;
+
+    /* If the type of this symbol is a function. This pointer will be set to the function declaration node that the declaration of this symbol had */
+    struct ast_node* function_decl_node;
+
+    /* The signature of the function, it replaces function_decl_node once the declaration's nodes are gone (see symbol_table_detach()) */
+    function_signature* signature;
+} symbol;
+
+
+/**
+ * @brief a dynamic array of symbols, searched through a hash index keyed on the symbol names
+ * 
+ */
+typedef struct symbol_table {
+    symbol* buffer;
+    u64 size;
+    u64 capacity;
+
+    /* An open addressed hash table of indices into buffer (offset by 1, so 0 is an empty slot) */
+    u64* index;
+    /* The amount of slots in the index, always a power of two */
+    u64 index_capacity;
+
+    /* The table of the enclosing scope, searched when a symbol is not in this table (NULL for the outermost table) */
+    struct symbol_table* parent;
+    /* Only the first parent_visible_count symbols of the parent are visible from this table */
+    u64 parent_visible_count;
+} symbol_table;
+
+/**
+ * @brief creates a symbol_table
+ * 
+ * @return symbol_table the created table
+ */
+API symbol_table symbol_table_create();
+
+/**
+ * @brief creates a symbol_table for a scope nested inside of another table
+ * @note the parent is only ever read through the scope, so many scopes can share a parent that is no longer being added to
+ *
+ * @param parent the table of the enclosing scope, it must outlive the created table
+ * @param parent_visible_count the amount of the parent's symbols (from the start of its buffer) that are visible in the scope
+ * @return symbol_table the created table, without any builtin types of its own
+ */
+API symbol_table symbol_table_create_scope(symbol_table* parent, u64 parent_visible_count);
+
+/**
+ * @brief destroys a symbol_table
+ * 
+ * @param table the table to destroy
+ */
+API void symbol_table_destroy(symbol_table* table);
+
+/**
+ * @brief Adds a symbol to the table with the given token and type_info
+ * 
+ * @param table the table to add to
+ * @param t the token to set the new symbol with
+ * @param type the type info to set the new symbol with
+ * @param is_constant the flag which denotes if the symbol is constant
+ * @return b8 true of the symbol was added, false otherwise
+ */
+API b8 symbol_table_add(symbol_table* table, token t, type_info type, b8 is_constant);
+
+/**
+ * @brief finds a symbol in the table, or in the visible part of one of its parents
+ * 
+ * @param table the table to search in
+ * @param t the token to search for
+ * @return symbol* the non_owning pointer to the symbol in the table, NULL if it could not be found
+ */
+API symbol* symbol_table_find(symbol_table* table, token t);
+
+/**
+ * @brief makes symbols independent of the AST and the buffer they were declared in, so both can be released
+ * @note the names are copied into the interner, and the function declarations are replaced by their signature
+ *
+ * @param table the table holding the symbols
+ * @param first the index of the first symbol to detach, every symbol after it is detached too
+ * @param interner the interner the names are copied into, it must outlive the table
+ * @return b8 true if every symbol was detached, false if an allocation failed
+ */
+API b8 symbol_table_detach(symbol_table* table, u64 first, string_interner* interner);
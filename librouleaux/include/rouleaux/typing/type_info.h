@@ -1,62 +1,105 @@
-#pragma once
-
-#include "defines.h"
-#include "lexer/token.h"
-#include "utilities/error_report.h"
-
-// Forward declare
-struct symbol_table;
-
-typedef enum type_info {
-    TYPE_INFO_UNKNOWN = 0,
-
-    TYPE_INFO_INTEGER,
-    TYPE_INFO_FLOAT,
-    TYPE_INFO_STRING,
-
-    TYPE_INFO_FUNCTION,
-
-    MAX_TYPE_INFOS
-} type_info;
-
-typedef struct typing_result {
-    /* A flag to denote if the typing was successful */
-    b8 success;
-
-    /* The error_report if the typing failed */
-    error_report error;
-
-    /* The type_info of the node that was successfully typed */
-    type_info type;
-} typing_result;
-
-
-// Forward declare
-struct ast_node;
-
-/**
- * @brief recursively descends a given AST and sets the token typing_information of each node, or returns an error message if it fails
- * 
- * @param ast the node of an abstract syntax tree to recursively perform typing on
- * @param sym_table a pointer to a symbol table which the function can add to and lookup existing variables types
- * @return typing_result the result of typing on the ast_node
- */
-API typing_result resolve_types(struct ast_node* ast, struct symbol_table* sym_table);
-
-/**
- * @brief returns a successful typing_result with the given type_info
- * 
- * @param tinfo the type info to add to the result
- * @return typing_result a successful typing_result
- */
-API typing_result typing_result_success(type_info tinfo);
-
-/**
- * @brief 
- * 
- * @param t the token that caused the error
- * @param message the message of the error
- * @param ... any format specifier values found in the message
- * @return typing_result a failed typing_result with an error_report containing the given message
- */
-API typing_result typing_result_error(token t, char* message, ...);
+#pragma once
+
+#include "defines.h"
+#include "lexer/token.h"
+#include "utilities/error_report.h"
+
+// Forward declare
+struct symbol_table;
+
+typedef enum type_info {
+    TYPE_INFO_UNKNOWN = 0,
+
+    TYPE_INFO_INTEGER,
+    TYPE_INFO_FLOAT,
+    TYPE_INFO_STRING,
+
+    TYPE_INFO_FUNCTION,
+
+    MAX_TYPE_INFOS
+} type_info;
+
+typedef struct typing_result {
+    /* A flag to denote if the typing was successful */
+    b8 success;
+
+    /* The error_report if the typing failed */
+    error_report error;
+
+    /* The type_info of the node that was successfully typed */
+    type_info type;
+} typing_result;
+
+
+// Forward declare
+struct ast_node;
+
+typedef b8 (*defer_function_body_fptr)(struct ast_node* function_declaration, struct symbol_table* sym_table, void* user_data);
+
+/**
+ * @brief Changes how resolve_types_with_context() walks an AST
+ */
+typedef struct typing_context {
+    /* When set, only the signature of a function declaration is typed, its body is handed to this function to be typed later.
+       If it returns false the body is typed right away instead */
+    defer_function_body_fptr defer_function_body;
+    /* The pointer passed along to defer_function_body */
+    void* user_data;
+} typing_context;
+
+/**
+ * @brief recursively descends a given AST and sets the token typing_information of each node, or returns an error message if it fails
+ * 
+ * @param ast the node of an abstract syntax tree to recursively perform typing on
+ * @param sym_table a pointer to a symbol table which the function can add to and lookup existing variables types
+ * @return typing_result the result of typing on the ast_node
+ */
+API typing_result resolve_types(struct ast_node* ast, struct symbol_table* sym_table);
+
+/**
+ * @brief the same as resolve_types(), but lets the caller change how the AST is walked
+ * 
+ * @param ast the node of an abstract syntax tree to recursively perform typing on
+ * @param sym_table a pointer to a symbol table which the function can add to and lookup existing variables types
+ * @param context how to walk the AST, NULL walks it exactly like resolve_types()
+ * @return typing_result the result of typing on the ast_node
+ */
+API typing_result resolve_types_with_context(struct ast_node* ast, struct symbol_table* sym_table, typing_context* context);
+
+/**
+ * @brief types the parameters and the return type of a function declaration, without adding the parameters to any table
+ * @note this is all the typing a function call to the function needs
+ * 
+ * @param function_declaration the AST_FUNCTION_DECLARATION node to type
+ * @param sym_table the table to look the parameter and return types up in
+ * @return typing_result the result of typing the signature
+ */
+API typing_result resolve_function_signature_types(struct ast_node* function_declaration, struct symbol_table* sym_table);
+
+/**
+ * @brief types the body of a function declaration whose signature was typed by resolve_function_signature_types()
+ * 
+ * @param function_declaration the AST_FUNCTION_DECLARATION node whose body to type
+ * @param local_table the function's own table, the parameters are added to it before typing the body
+ * @param context how to walk the body, NULL walks it exactly like resolve_types()
+ * @return typing_result the result of typing the body
+ */
+API typing_result resolve_function_body_types(struct ast_node* function_declaration, struct symbol_table* local_table, typing_context* context);
+
+/**
+ * @brief returns a successful typing_result with the given type_info
+ * 
+ * @param tinfo the type info to add to the result
+ * @return typing_result a successful typing_result
+ */
+API typing_result typing_result_success(type_info tinfo);
+
+/**
+ * @brief 
+ * 
+ * @param t the token that caused the error
+ * @param id the message of the error
+ * @param ... the diagnostic_argument values the message takes, see diagnostic_id
+ * @return typing_result a failed typing_result with an error_report containing the given message
+ */
+API typing_result typing_result_error(token t, diagnostic_id id, ...);
@@ -1,35 +1,230 @@
-#pragma once
-
-#include "defines.h"
-#include "lexer/token.h"
-#include <stdarg.h>
-
-// Forward declare
-struct token;
-
-typedef struct error_report {
-    /* A heap allocated buffer containing a formatted error message */
-    char* message;
-
-    /* A pointer to the token that the parser faulted on */
-    token faulted_token;
-} error_report;
-
-
-/**
- * @brief returns an allocated buffer of text containing the formatted message
- * 
- * @param message the message format to expand
- * @param params the format specifiers values
- * @return char* the formatted message
- */
-API char* format_error_message(char* message, va_list params);
-
-/**
- * @brief This function allocates a text buffer and fills it with a formatted message for the error
- * 
- * @param report the error_report to be converted to a string
- * @param allocator the function pointer to a allocator which will provide a zero'ed out buffer (calloc is allowed)
- * @return const char* the null terminated string
- */
-API char* error_report_printable_text(error_report report, void*(allocator)(u64 count, u64 stride));
+#pragma once
+
+#include "defines.h"
+#include "lexer/token.h"
+#include <stdarg.h>
+
+// Forward declare
+struct token;
+
+// The most arguments the message of a single diagnostic takes
+#define DIAGNOSTIC_MAX_ARGUMENTS 3
+
+/**
+ * @brief Identifies the message of an error, the text of each is in the diagnostic table of error_report.c
+ * @note the comment after each id lists the arguments its message takes, in order
+ */
+typedef enum diagnostic_id {
+    DIAGNOSTIC_NONE = 0,
+
+    // Parsing
+    DIAGNOSTIC_EXPECTED_STATEMENT_END,              // -
+    DIAGNOSTIC_EXPECTED_STATEMENT_END_GOT,          // token text
+    DIAGNOSTIC_EXPECTED_STATEMENT_START,            // token text
+    DIAGNOSTIC_INVALID_TOKEN,                       // -
+    DIAGNOSTIC_IMPOSSIBLE_SCOPE_START,              // -
+    DIAGNOSTIC_EXPECTED_SCOPE_END,                  // -
+    DIAGNOSTIC_EXPECTED_CLOSING_CURLY,              // -
+    DIAGNOSTIC_INVALID_IDENTIFIER_STATEMENT,        // -
+    DIAGNOSTIC_INVALID_VARIABLE_DECLARATION,        // -
+    DIAGNOSTIC_EXPECTED_PARAMETER_LIST_START,       // -
+    DIAGNOSTIC_EXPECTED_PARAMETER_SEPARATOR,        // -
+    DIAGNOSTIC_UNTERMINATED_PARAMETER_LIST,         // location of the '('
+    DIAGNOSTIC_EXPECTED_PARAMETER_LIST_END,         // -
+    DIAGNOSTIC_EXPECTED_CALL_LIST_START,            // -
+    DIAGNOSTIC_UNTERMINATED_CALL_LIST,              // -
+    DIAGNOSTIC_UNEXPECTED_CALL_LIST_TOKEN,          // -
+    DIAGNOSTIC_EXPECTED_RETURN_ARROW,               // token text
+    DIAGNOSTIC_EXPECTED_RETURN_TYPE,                // token text
+    DIAGNOSTIC_EXPECTED_CLOSING_PARENTHESIS,        // token text, location of the '('
+    DIAGNOSTIC_EXPECTED_EXPRESSION_START,           // token text
+    DIAGNOSTIC_UNEXPECTED_EXPRESSION_TOKEN,         // token text
+    DIAGNOSTIC_EXPECTED_TOKEN,                      // name of the expected token, token text
+
+    // Typing
+    DIAGNOSTIC_OPERAND_TYPE_MISMATCH,               // -
+    DIAGNOSTIC_UNKNOWN_TYPE,                        // type name
+    DIAGNOSTIC_VARIABLE_REDECLARED,                 // name, location of the original declaration
+    DIAGNOSTIC_SYMBOL_REDECLARED,                   // name, location of the original declaration
+    DIAGNOSTIC_UNDECLARED_VARIABLE,                 // name
+    DIAGNOSTIC_UNDECLARED_SYMBOL,                   // name
+    DIAGNOSTIC_ASSIGNMENT_TO_CONSTANT,              // name, location of the original declaration
+    DIAGNOSTIC_ASSIGNMENT_TYPE_MISMATCH,            // name
+    DIAGNOSTIC_ASSIGNMENT_SIGNATURE_MISMATCH,       // name
+    DIAGNOSTIC_INCORRECT_ASSIGNMENT_TYPE,           // name
+    DIAGNOSTIC_UNIMPLEMENTED_ASSIGNMENT,            // -
+    DIAGNOSTIC_UNEXPECTED_CONST_ASSIGNMENT_TARGET,  // -
+    DIAGNOSTIC_CALL_OF_NON_FUNCTION,                // -
+    DIAGNOSTIC_MISSING_PARAMETER_LIST,              // -
+    DIAGNOSTIC_CALL_PARAMETER_COUNT,                // "Too few" or "Too many", parameters given, parameters declared
+    DIAGNOSTIC_CALL_PARAMETER_TYPE,                 // -
+    DIAGNOSTIC_UNKNOWN_ENTRY_POINT,                 // name
+    DIAGNOSTIC_SYMBOL_NOT_ADDED,                    // -
+
+    // Running
+    DIAGNOSTIC_DIVISION_BY_ZERO,                    // -
+    DIAGNOSTIC_UNSUPPORTED_OPERATOR,                // operator text, name of the operand type
+    DIAGNOSTIC_ENTRY_POINT_PARAMETERS,              // name
+    DIAGNOSTIC_STACK_OVERFLOW,                      // name of the called function
+
+    // Running out of memory, or the input
+    DIAGNOSTIC_SYMBOL_TABLE_ALLOCATION,             // -
+    DIAGNOSTIC_REACHABILITY_ALLOCATION,             // -
+    DIAGNOSTIC_TOKEN_STREAM_ALLOCATION,             // -
+    DIAGNOSTIC_TOKEN_ARRAY_ALLOCATION,              // -
+    DIAGNOSTIC_STATEMENT_TABLE_ALLOCATION,          // -
+    DIAGNOSTIC_EDIT_FAILED,                         // offset of the edit
+    DIAGNOSTIC_FILE_UNREADABLE,                     // filename
+    DIAGNOSTIC_BUFFER_UNPARSABLE,                   // name of the buffer
+    DIAGNOSTIC_STREAM_UNREADABLE,                   // name of the stream
+    DIAGNOSTIC_TOO_MANY_REGISTERS,                  // most registers a function can have
+    DIAGNOSTIC_SSA_ALLOCATION,                      // -
+    DIAGNOSTIC_BYTECODE_ALLOCATION,                 // -
+    DIAGNOSTIC_VM_ALLOCATION,                       // -
+    DIAGNOSTIC_CODE_GENERATION_ALLOCATION,          // -
+
+    DIAGNOSTIC_MAX_IDS
+} diagnostic_id;
+
+typedef enum diagnostic_argument_type {
+    DIAGNOSTIC_ARGUMENT_INTEGER = 0,    // Printed as an unsigned decimal number
+    DIAGNOSTIC_ARGUMENT_STRING,         // A borrowed string, printed as is
+    DIAGNOSTIC_ARGUMENT_LOCATION,       // Printed as 'filename:row:column'
+} diagnostic_argument_type;
+
+/**
+ * @brief A value filling in one of the placeholders of a diagnostic's message
+ */
+typedef struct diagnostic_argument {
+    /* How the value is stored, and printed */
+    diagnostic_argument_type type;
+
+    union {
+        u64 integer;
+        struct {
+            /* The text, it does not need to be null terminated. It is borrowed, like the text of a token */
+            const char* text;
+            /* The length of the text in bytes */
+            u64 length;
+        } string;
+        location location;
+    } value;
+} diagnostic_argument;
+
+/**
+ * @brief An error, kept as the id of its message and the values for it so the message is only formatted when it is printed
+ */
+typedef struct error_report {
+    /* Which message the error has */
+    diagnostic_id id;
+    /* The values filling in the message, as many as the message takes */
+    diagnostic_argument arguments[DIAGNOSTIC_MAX_ARGUMENTS];
+
+    /* A pointer to the token that the parser faulted on */
+    token faulted_token;
+} error_report;
+
+
+/**
+ * @brief makes an argument for a diagnostic holding a number
+ *
+ * @param value the number
+ * @return diagnostic_argument the argument
+ */
+API diagnostic_argument diagnostic_integer(u64 value);
+
+/**
+ * @brief makes an argument for a diagnostic holding a string, the string is borrowed
+ *
+ * @param text the string, it does not need to be null terminated
+ * @param length the length of the string in bytes
+ * @return diagnostic_argument the argument
+ */
+API diagnostic_argument diagnostic_string(const char* text, u64 length);
+
+/**
+ * @brief makes an argument for a diagnostic holding the text of a token, the text is borrowed
+ *
+ * @param t the token
+ * @return diagnostic_argument the argument
+ */
+API diagnostic_argument diagnostic_token_text(token t);
+
+/**
+ * @brief makes an argument for a diagnostic holding a location
+ *
+ * @param loc the location
+ * @return diagnostic_argument the argument
+ */
+API diagnostic_argument diagnostic_location(location loc);
+
+/**
+ * @brief makes an error_report, the arguments its message takes follow the id
+ *
+ * @param t the token that caused the error
+ * @param id the message of the error
+ * @param params the diagnostic_argument values, as many as the message takes
+ * @return error_report the report
+ */
+API error_report error_report_create(token t, diagnostic_id id, va_list params);
+
+/**
+ * @brief gives the amount of arguments the message of a diagnostic takes
+ *
+ * @param id the message
+ * @return u64 the amount of arguments
+ */
+API u64 diagnostic_argument_count(diagnostic_id id);
+
+/**
+ * @brief writes the message of an error into a caller provided buffer, following the same rules as error_report_write_printable_text()
+ *
+ * @param report the error_report whose message to write
+ * @param buffer where the message is written, can be NULL if capacity is 0
+ * @param capacity the amount of bytes the buffer can hold, including the null terminator
+ * @return u64 the length of the whole message (not counting the null terminator), even if it did not fit
+ */
+API u64 error_report_write_message(error_report report, char* buffer, u64 capacity);
+
+/**
+ * @brief returns an allocated buffer of text containing the formatted message
+ * 
+ * @param message the message format to expand
+ * @param params the format specifiers values
+ * @return char* the formatted message
+ */
+API char* format_error_message(char* message, va_list params);
+
+/**
+ * @brief This function allocates a text buffer and fills it with a formatted message for the error
+ * 
+ * @param report the error_report to be converted to a string
+ * @param allocator the function pointer to a allocator which will provide a zero'ed out buffer (calloc is allowed)
+ * @return const char* the null terminated string
+ */
+API char* error_report_printable_text(error_report report, void*(allocator)(u64 count, u64 stride));
+
+/**
+ * @brief Same as error_report_printable_text(), but the faulted line is taken from the given source buffer instead of being read from the file
+ *
+ * @param report the error_report to be converted to a string
+ * @param source the content of the file the error is in, NULL if it is not available
+ * @param source_length the length of the source buffer in bytes
+ * @param allocator the function pointer to a allocator which will provide a zero'ed out buffer (calloc is allowed)
+ * @return char* the null terminated string
+ */
+API char* error_report_printable_text_from_source(error_report report, const char* source, u64 source_length, void*(allocator)(u64 count, u64 stride));
+
+/**
+ * @brief writes the printable text of an error into a caller provided buffer, the faulted line is given directly
+ * @note like snprintf(), the text is cut short (but still null terminated) when it does not fit, and a NULL buffer
+ *       with a capacity of 0 only measures the text. This lets many reports be rendered into one allocation
+ *
+ * @param report the error_report to be converted to a string
+ * @param line the faulted line, it does not need to be null terminated
+ * @param line_length the length of the faulted line in bytes
+ * @param buffer where the text is written, can be NULL if capacity is 0
+ * @param capacity the amount of bytes the buffer can hold, including the null terminator
+ * @return u64 the length of the whole text (not counting the null terminator), even if it did not fit
+ */
+API u64 error_report_write_printable_text(error_report report, const char* line, u64 line_length, char* buffer, u64 capacity);
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "defines.h"
+
+/**
+ * @brief allocates memory which can be written, and made executable once written with executable_memory_seal()
+ * @note the memory is never writable and executable at the same time
+ *
+ * @param size_bytes the amount of bytes to allocate, rounded up to whole pages by the platform
+ * @return void* the allocated memory, NULL if it could not be allocated
+ */
+API void* executable_memory_allocate(u64 size_bytes);
+
+/**
+ * @brief makes memory from executable_memory_allocate() executable and read only, so the code written to it can be run
+ *
+ * @param memory the memory to seal
+ * @param size_bytes the amount of bytes it was allocated with
+ * @return b8 true if the memory can now be run, false otherwise
+ */
+API b8 executable_memory_seal(void* memory, u64 size_bytes);
+
+/**
+ * @brief frees memory from executable_memory_allocate(), sealed or not
+ *
+ * @param memory the memory to free, nothing is done when it is NULL
+ * @param size_bytes the amount of bytes it was allocated with
+ */
+API void executable_memory_free(void* memory, u64 size_bytes);
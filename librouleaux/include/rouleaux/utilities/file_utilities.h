@@ -1,27 +1,63 @@
-#pragma once
-
-#include "defines.h"
-
-/**
- * @brief reads a text file, populates out_file_size_bytes even if out_file_content is NULL.
- * This is so you can call this function once to get the size of the file,
- * and then a second time to read its content.
- * 
- * @param filepath the path and name of the file to be read
- * @param out_file_size_bytes a pointer to a place to put the size of the file
- * @param out_file_content a pointer to a buffer which can hold the data from the file
- * @return u64 the amount of characters read from the file (this could be less then the bytes if CRLF translation happens on your platform)
- */
-API u64 file_read(const char* filepath, u64* out_file_size_bytes, void* out_file_content);
-
-/**
- * @brief reads a binary file, populates out_file_size_bytes even if out_file_content is NULL.
- * This is so you can call this function once to get the size of the file,
- * and then a second time to read its content.
- * 
- * @param filepath the path and name of the file to be read
- * @param out_file_size_bytes a pointer to a place to put the size of the file
- * @param out_file_content a pointer to a buffer which can hold the data from the file
- * @return u64 the amount of characters read from the file
- */
-API u64 file_read_binary(const char* filepath, u64* out_file_size_bytes, void* out_file_content);
+#pragma once
+
+#include "defines.h"
+
+/**
+ * @brief reads a text file, populates out_file_size_bytes even if out_file_content is NULL.
+ * This is so you can call this function once to get the size of the file,
+ * and then a second time to read its content.
+ * 
+ * @param filepath the path and name of the file to be read
+ * @param out_file_size_bytes a pointer to a place to put the size of the file
+ * @param out_file_content a pointer to a buffer which can hold the data from the file
+ * @return u64 the amount of characters read from the file (this could be less then the bytes if CRLF translation happens on your platform)
+ */
+API u64 file_read(const char* filepath, u64* out_file_size_bytes, void* out_file_content);
+
+/**
+ * @brief reads a binary file, populates out_file_size_bytes even if out_file_content is NULL.
+ * This is so you can call this function once to get the size of the file,
+ * and then a second time to read its content.
+ * 
+ * @param filepath the path and name of the file to be read
+ * @param out_file_size_bytes a pointer to a place to put the size of the file
+ * @param out_file_content a pointer to a buffer which can hold the data from the file
+ * @return u64 the amount of characters read from the file
+ */
+API u64 file_read_binary(const char* filepath, u64* out_file_size_bytes, void* out_file_content);
+
+/**
+ * @brief reads a single line of a text file, without the newline. Only that line is kept in memory, the lines before it
+ * are skipped as they are read
+ * 
+ * @param filepath the path and name of the file to be read
+ * @param line_number the line to read, the first line is 1
+ * @param out_line_length a pointer to a place to put the length of the line
+ * @return char* a null terminated copy of the line, which the caller frees. NULL if the file could not be read
+ */
+API char* file_read_line(const char* filepath, u64 line_number, u64* out_line_length);
+
+/**
+ * @brief opens a text file to be read a piece at a time with file_stream_read()
+ * 
+ * @param filepath the path and name of the file to be opened
+ * @return void* the opened file, NULL if it could not be opened
+ */
+API void* file_stream_open(const char* filepath);
+
+/**
+ * @brief reads the next bytes of a file opened with file_stream_open(), it can be used as a lexer_read_fptr
+ * 
+ * @param file the opened file
+ * @param buffer where the bytes are written
+ * @param capacity the most bytes that can be written to buffer
+ * @return u64 the amount of characters read, 0 once the end of the file is reached
+ */
+API u64 file_stream_read(void* file, char* buffer, u64 capacity);
+
+/**
+ * @brief closes a file opened with file_stream_open()
+ * 
+ * @param file the file to close
+ */
+API void file_stream_close(void* file);
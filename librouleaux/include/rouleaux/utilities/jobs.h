@@ -0,0 +1,91 @@
+#pragma once
+
+#include "defines.h"
+
+#include <stdatomic.h>
+
+typedef void (*job_function_fptr)(void* user_data);
+
+/**
+ * @brief Counts the jobs of a group that have not finished yet, used to wait on the whole group
+ * @note a job_counter must start zeroed, and must outlive every job submitted with it
+ */
+typedef struct job_counter {
+    /* The amount of jobs submitted with this counter that have not finished running */
+    _Atomic u64 pending;
+} job_counter;
+
+/**
+ * @brief How a rouleaux_jobs scheduler is set up
+ */
+typedef struct jobs_options {
+    /* The amount of worker threads to start, 0 starts one for every logical processor */
+    u32 thread_count;
+    /* When true, each worker thread is pinned to its own logical processor */
+    b8 pin_threads;
+    /* The amount of times an idle worker looks for a job before it goes to sleep, 0 uses DEFAULT_JOBS_SPIN_COUNT */
+    u32 spin_count;
+} jobs_options;
+
+// The default amount of times an idle worker looks for a job before it goes to sleep
+#define DEFAULT_JOBS_SPIN_COUNT 128
+
+/**
+ * @brief A work-stealing job scheduler. Every worker owns a deque of jobs, idle workers steal from the others,
+ *        and workers that find nothing to do for a while go to sleep until more jobs are submitted
+ */
+typedef struct rouleaux_jobs rouleaux_jobs;
+
+/**
+ * @brief starts a job scheduler and its worker threads
+ *
+ * @param options how to set up the scheduler
+ * @return rouleaux_jobs* the scheduler, NULL if it could not be created
+ */
+API rouleaux_jobs* jobs_create(jobs_options options);
+
+/**
+ * @brief stops the worker threads of a scheduler and releases it
+ * @note every submitted job must have been waited on
+ *
+ * @param jobs the scheduler to destroy
+ */
+API void jobs_destroy(rouleaux_jobs* jobs);
+
+/**
+ * @brief gives the amount of worker threads a scheduler runs
+ *
+ * @param jobs the scheduler, NULL is a scheduler without any threads
+ * @return u32 the amount of worker threads
+ */
+API u32 jobs_thread_count(rouleaux_jobs* jobs);
+
+/**
+ * @brief submits a job to be run by one of the workers
+ * @note jobs submitted from a worker go onto that worker's own deque, jobs from any other thread are shared by all the workers
+ *
+ * @param jobs the scheduler to submit to
+ * @param function the function to run
+ * @param user_data the pointer which will be passed to the function
+ * @param counter the counter which is decremented once the job is done, can be NULL
+ */
+API void jobs_submit(rouleaux_jobs* jobs, job_function_fptr function, void* user_data, job_counter* counter);
+
+/**
+ * @brief waits until every job submitted with the counter is done, running jobs on the calling thread while it waits
+ *
+ * @param jobs the scheduler the jobs were submitted to
+ * @param counter the counter the jobs were submitted with
+ */
+API void jobs_wait(rouleaux_jobs* jobs, job_counter* counter);
+
+/**
+ * @brief runs a function count times (each with the same user_data) across the scheduler and waits for all of them
+ * @note the calling thread runs the function too, without a scheduler everything runs on the calling thread
+ *
+ * @param jobs the scheduler to run on, can be NULL
+ * @param count the amount of times to run the function
+ * @param function the function to run
+ * @param user_data the pointer which will be passed to every call of the function
+ */
+API void jobs_run_and_wait(rouleaux_jobs* jobs, u32 count, job_function_fptr function, void* user_data);
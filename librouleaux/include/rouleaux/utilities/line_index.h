@@ -0,0 +1,47 @@
+#pragma once
+
+#include "defines.h"
+
+/**
+ * @brief The offsets of the start of every line of a buffer, so any line can be found without scanning the buffer
+ * @note the buffer is borrowed, it must outlive the index
+ */
+typedef struct line_index {
+    /* The buffer the lines are in */
+    const char* source;
+    /* The length of the buffer in bytes */
+    u64 source_length;
+
+    /* The offset of the first byte of every line, in order */
+    u64* line_starts;
+    /* The amount of lines in the buffer (an empty buffer still has one) */
+    u64 line_count;
+} line_index;
+
+/**
+ * @brief Scans a buffer once to find where each of its lines starts
+ *
+ * @param source the buffer to index
+ * @param length the length of the buffer in bytes
+ * @return line_index the index of the buffer, its line_count is 0 if the allocation failed
+ */
+API line_index line_index_create(const char* source, u64 length);
+
+/**
+ * @brief releases the memory held by a line_index and zeros the struct
+ *
+ * @param index the index to release
+ */
+API void line_index_destroy(line_index* index);
+
+/**
+ * @brief finds a line of the indexed buffer
+ * @note the line does not include its line ending ('\n' or "\r\n")
+ *
+ * @param index the index to search
+ * @param row the 1 based number of the line
+ * @param out_line where the pointer to the start of the line is written
+ * @param out_line_length where the length of the line is written
+ * @return b8 true if the line exists, false if the row is out of range
+ */
+API b8 line_index_get_line(const line_index* index, u64 row, const char** out_line, u64* out_line_length);
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "defines.h"
+#include "parser/node_arena.h"
+
+// The value a string_hash_bytes() hash starts from, the 64 bit FNV-1a offset basis
+#define STRING_HASH_SEED 14695981039346656037ull
+
+/**
+ * @brief A single interned string in a string_interner's table
+ */
+typedef struct interned_string {
+    /* The null terminated copy of the string owned by the interner, NULL for an empty slot */
+    const char* text;
+    /* The length of the string in bytes (not counting the null terminator) */
+    u64 length;
+    /* The hash of the string */
+    u64 hash;
+} interned_string;
+
+/**
+ * @brief Keeps one copy of every distinct string given to it, so equal strings end up at the same address
+ * @note the copies live as long as the interner, comparing two interned strings is a pointer comparison
+ */
+typedef struct string_interner {
+    /* An open addressed hash table of the interned strings */
+    interned_string* slots;
+    /* The amount of slots in the table, always a power of two (or 0 before the first string is interned) */
+    u64 capacity;
+    /* The amount of strings held by the interner */
+    u64 size;
+
+    /* The memory the copies of the strings are stored in */
+    node_arena storage;
+} string_interner;
+
+/**
+ * @brief Creates an empty string_interner, no memory is allocated until the first string is interned
+ *
+ * @return string_interner the created interner
+ */
+API string_interner string_interner_create();
+
+/**
+ * @brief releases every string held by the interner, invalidating all the pointers it handed out
+ *
+ * @param interner the interner to release
+ */
+API void string_interner_destroy(string_interner* interner);
+
+/**
+ * @brief gives the interned copy of a string, copying it into the interner the first time it is seen
+ *
+ * @param interner the interner to operate on
+ * @param text the string to intern, it does not need to be null terminated
+ * @param length the length of the string in bytes
+ * @return const char* the null terminated interned copy, NULL if the interner failed to allocate memory
+ */
+API const char* string_interner_intern(string_interner* interner, const char* text, u64 length);
+
+/**
+ * @brief hashes a string with 64 bit FNV-1a, the hash the interner keys its table on
+ *
+ * @param text the string to hash, it does not need to be null terminated
+ * @param length the length of the string in bytes
+ * @return u64 the hash of the string
+ */
+API u64 string_hash(const char* text, u64 length);
+
+/**
+ * @brief adds bytes to a 64 bit FNV-1a hash, so a hash can be built up from several pieces
+ *
+ * @param hash the hash so far, STRING_HASH_SEED for a new hash
+ * @param bytes the bytes to add to the hash
+ * @param length the amount of bytes
+ * @return u64 the hash of everything added so far
+ */
+API u64 string_hash_bytes(u64 hash, const void* bytes, u64 length);
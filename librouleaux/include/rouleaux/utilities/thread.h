@@ -0,0 +1,134 @@
+#pragma once
+
+#include "defines.h"
+
+typedef void (*thread_function_fptr)(void* user_data);
+
+/**
+ * @brief A handle to an operating system thread
+ */
+typedef struct rouleaux_thread {
+    /* The platform specific handle of the thread */
+    void* handle;
+} rouleaux_thread;
+
+/**
+ * @brief A lock which only one thread can hold at a time
+ */
+typedef struct rouleaux_mutex {
+    /* The platform specific handle of the mutex */
+    void* handle;
+} rouleaux_mutex;
+
+/**
+ * @brief A condition variable, lets threads sleep until another thread wakes them
+ */
+typedef struct rouleaux_condition {
+    /* The platform specific handle of the condition variable */
+    void* handle;
+} rouleaux_condition;
+
+/**
+ * @brief starts a new thread which will run the given function
+ *
+ * @param out_thread a pointer to the thread handle to populate
+ * @param function the function the thread should run
+ * @param user_data the pointer which will be passed to the function
+ * @return b8 true if the thread was started, false otherwise
+ */
+API b8 thread_create(rouleaux_thread* out_thread, thread_function_fptr function, void* user_data);
+
+/**
+ * @brief waits for a thread to finish running its function and releases the handle
+ *
+ * @param thread the thread to wait on
+ */
+API void thread_join(rouleaux_thread* thread);
+
+/**
+ * @brief returns the number of threads the machine can run concurrently
+ *
+ * @return u32 the number of logical processors, at least 1
+ */
+API u32 thread_hardware_concurrency();
+
+/**
+ * @brief gives up the rest of the calling thread's time slice, used while spinning on another thread
+ */
+API void thread_yield();
+
+/**
+ * @brief restricts a thread to only run on a single logical processor
+ *
+ * @param thread the thread to pin
+ * @param processor_index the index of the logical processor, wrapped around to the amount of processors
+ * @return b8 true if the thread was pinned, false otherwise
+ */
+API b8 thread_set_affinity(rouleaux_thread* thread, u32 processor_index);
+
+/**
+ * @brief creates a mutex
+ *
+ * @param out_mutex a pointer to the mutex to populate
+ * @return b8 true if the mutex was created, false otherwise
+ */
+API b8 mutex_create(rouleaux_mutex* out_mutex);
+
+/**
+ * @brief destroys a mutex, it must not be locked
+ *
+ * @param mutex the mutex to destroy
+ */
+API void mutex_destroy(rouleaux_mutex* mutex);
+
+/**
+ * @brief locks a mutex, waiting for any other thread holding it to unlock it first
+ *
+ * @param mutex the mutex to lock
+ */
+API void mutex_lock(rouleaux_mutex* mutex);
+
+/**
+ * @brief unlocks a mutex locked by the calling thread
+ *
+ * @param mutex the mutex to unlock
+ */
+API void mutex_unlock(rouleaux_mutex* mutex);
+
+/**
+ * @brief creates a condition variable
+ *
+ * @param out_condition a pointer to the condition variable to populate
+ * @return b8 true if the condition variable was created, false otherwise
+ */
+API b8 condition_create(rouleaux_condition* out_condition);
+
+/**
+ * @brief destroys a condition variable, no thread may be waiting on it
+ *
+ * @param condition the condition variable to destroy
+ */
+API void condition_destroy(rouleaux_condition* condition);
+
+/**
+ * @brief unlocks the mutex and sleeps until the condition variable is woken, then locks the mutex again
+ * @note the thread can wake up without being woken, so the condition being waited on must be checked again
+ *
+ * @param condition the condition variable to wait on
+ * @param mutex the mutex the calling thread holds
+ */
+API void condition_wait(rouleaux_condition* condition, rouleaux_mutex* mutex);
+
+/**
+ * @brief wakes one thread waiting on the condition variable
+ *
+ * @param condition the condition variable to wake
+ */
+API void condition_wake_one(rouleaux_condition* condition);
+
+/**
+ * @brief wakes every thread waiting on the condition variable
+ *
+ * @param condition the condition variable to wake
+ */
+API void condition_wake_all(rouleaux_condition* condition);
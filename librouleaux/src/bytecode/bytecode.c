@@ -0,0 +1,125 @@
+#include "bytecode/bytecode.h"
+
+#include <malloc.h>
+#include <string.h>
+
+// The name of every bytecode_opcode, indexed by the opcode
+static const char* opcode_names[OPCODE_MAX_OPCODES] = {
+    [OPCODE_INVALID]                 = "OPCODE_INVALID",
+    [OPCODE_LOAD_CONSTANT]           = "OPCODE_LOAD_CONSTANT",
+    [OPCODE_MOVE]                    = "OPCODE_MOVE",
+    [OPCODE_GET_GLOBAL]              = "OPCODE_GET_GLOBAL",
+    [OPCODE_SET_GLOBAL]              = "OPCODE_SET_GLOBAL",
+    [OPCODE_ADD_I64]                 = "OPCODE_ADD_I64",
+    [OPCODE_ADD_F64]                 = "OPCODE_ADD_F64",
+    [OPCODE_SUBTRACT_I64]            = "OPCODE_SUBTRACT_I64",
+    [OPCODE_SUBTRACT_F64]            = "OPCODE_SUBTRACT_F64",
+    [OPCODE_MULTIPLY_I64]            = "OPCODE_MULTIPLY_I64",
+    [OPCODE_MULTIPLY_F64]            = "OPCODE_MULTIPLY_F64",
+    [OPCODE_DIVIDE_I64]              = "OPCODE_DIVIDE_I64",
+    [OPCODE_DIVIDE_F64]              = "OPCODE_DIVIDE_F64",
+    [OPCODE_MODULUS_I64]             = "OPCODE_MODULUS_I64",
+    [OPCODE_MODULUS_F64]             = "OPCODE_MODULUS_F64",
+    [OPCODE_GREATER_THAN_I64]        = "OPCODE_GREATER_THAN_I64",
+    [OPCODE_GREATER_THAN_F64]        = "OPCODE_GREATER_THAN_F64",
+    [OPCODE_LESS_THAN_I64]           = "OPCODE_LESS_THAN_I64",
+    [OPCODE_LESS_THAN_F64]           = "OPCODE_LESS_THAN_F64",
+    [OPCODE_JUMP]                    = "OPCODE_JUMP",
+    [OPCODE_JUMP_IF_FALSE_I64]       = "OPCODE_JUMP_IF_FALSE_I64",
+    [OPCODE_JUMP_IF_FALSE_F64]       = "OPCODE_JUMP_IF_FALSE_F64",
+    [OPCODE_JUMP_IF_FALSE_STRING]    = "OPCODE_JUMP_IF_FALSE_STRING",
+    [OPCODE_JUMP_IF_TRUE_I64]        = "OPCODE_JUMP_IF_TRUE_I64",
+    [OPCODE_JUMP_IF_TRUE_F64]        = "OPCODE_JUMP_IF_TRUE_F64",
+    [OPCODE_JUMP_IF_TRUE_STRING]     = "OPCODE_JUMP_IF_TRUE_STRING",
+    [OPCODE_CALL]                    = "OPCODE_CALL",
+    [OPCODE_RETURN]                  = "OPCODE_RETURN",
+    [OPCODE_ADD_I64_IMMEDIATE]       = "OPCODE_ADD_I64_IMMEDIATE",
+    [OPCODE_MULTIPLY_I64_IMMEDIATE]  = "OPCODE_MULTIPLY_I64_IMMEDIATE",
+    [OPCODE_JUMP_IF_LESS_I64]        = "OPCODE_JUMP_IF_LESS_I64",
+    [OPCODE_JUMP_IF_LESS_F64]        = "OPCODE_JUMP_IF_LESS_F64",
+    [OPCODE_JUMP_IF_NOT_LESS_I64]    = "OPCODE_JUMP_IF_NOT_LESS_I64",
+    [OPCODE_JUMP_IF_NOT_LESS_F64]    = "OPCODE_JUMP_IF_NOT_LESS_F64",
+    [OPCODE_JUMP_IF_GREATER_I64]     = "OPCODE_JUMP_IF_GREATER_I64",
+    [OPCODE_JUMP_IF_GREATER_F64]     = "OPCODE_JUMP_IF_GREATER_F64",
+    [OPCODE_JUMP_IF_NOT_GREATER_I64] = "OPCODE_JUMP_IF_NOT_GREATER_I64",
+    [OPCODE_JUMP_IF_NOT_GREATER_F64] = "OPCODE_JUMP_IF_NOT_GREATER_F64",
+};
+
+// The operands of every bytecode_opcode, indexed by the opcode. OPCODE_CALL also reads its arguments and overwrites
+// every register from c on, which is left to the users of the table
+static const u8 opcode_operands[OPCODE_MAX_OPCODES] = {
+    [OPCODE_LOAD_CONSTANT]              = BYTECODE_OPERAND_WRITES_A,
+    [OPCODE_MOVE]                       = BYTECODE_OPERAND_WRITES_A | BYTECODE_OPERAND_READS_B,
+    [OPCODE_GET_GLOBAL]                 = BYTECODE_OPERAND_WRITES_A,
+    [OPCODE_SET_GLOBAL]                 = BYTECODE_OPERAND_READS_A,
+    [OPCODE_ADD_I64]                    = BYTECODE_OPERAND_WRITES_A | BYTECODE_OPERAND_READS_B | BYTECODE_OPERAND_READS_C,
+    [OPCODE_ADD_F64]                    = BYTECODE_OPERAND_WRITES_A | BYTECODE_OPERAND_READS_B | BYTECODE_OPERAND_READS_C | BYTECODE_OPERAND_FLOATS,
+    [OPCODE_SUBTRACT_I64]               = BYTECODE_OPERAND_WRITES_A | BYTECODE_OPERAND_READS_B | BYTECODE_OPERAND_READS_C,
+    [OPCODE_SUBTRACT_F64]               = BYTECODE_OPERAND_WRITES_A | BYTECODE_OPERAND_READS_B | BYTECODE_OPERAND_READS_C | BYTECODE_OPERAND_FLOATS,
+    [OPCODE_MULTIPLY_I64]               = BYTECODE_OPERAND_WRITES_A | BYTECODE_OPERAND_READS_B | BYTECODE_OPERAND_READS_C,
+    [OPCODE_MULTIPLY_F64]               = BYTECODE_OPERAND_WRITES_A | BYTECODE_OPERAND_READS_B | BYTECODE_OPERAND_READS_C | BYTECODE_OPERAND_FLOATS,
+    [OPCODE_DIVIDE_I64]                 = BYTECODE_OPERAND_WRITES_A | BYTECODE_OPERAND_READS_B | BYTECODE_OPERAND_READS_C,
+    [OPCODE_DIVIDE_F64]                 = BYTECODE_OPERAND_WRITES_A | BYTECODE_OPERAND_READS_B | BYTECODE_OPERAND_READS_C | BYTECODE_OPERAND_FLOATS,
+    [OPCODE_MODULUS_I64]                = BYTECODE_OPERAND_WRITES_A | BYTECODE_OPERAND_READS_B | BYTECODE_OPERAND_READS_C,
+    [OPCODE_MODULUS_F64]                = BYTECODE_OPERAND_WRITES_A | BYTECODE_OPERAND_READS_B | BYTECODE_OPERAND_READS_C | BYTECODE_OPERAND_FLOATS,
+    [OPCODE_GREATER_THAN_I64]           = BYTECODE_OPERAND_WRITES_A | BYTECODE_OPERAND_READS_B | BYTECODE_OPERAND_READS_C,
+    [OPCODE_GREATER_THAN_F64]           = BYTECODE_OPERAND_WRITES_A | BYTECODE_OPERAND_READS_B | BYTECODE_OPERAND_READS_C | BYTECODE_OPERAND_FLOATS,
+    [OPCODE_LESS_THAN_I64]              = BYTECODE_OPERAND_WRITES_A | BYTECODE_OPERAND_READS_B | BYTECODE_OPERAND_READS_C,
+    [OPCODE_LESS_THAN_F64]              = BYTECODE_OPERAND_WRITES_A | BYTECODE_OPERAND_READS_B | BYTECODE_OPERAND_READS_C | BYTECODE_OPERAND_FLOATS,
+    [OPCODE_JUMP]                       = BYTECODE_OPERAND_JUMPS | BYTECODE_OPERAND_NO_FALL_THROUGH,
+    [OPCODE_JUMP_IF_FALSE_I64]          = BYTECODE_OPERAND_READS_A | BYTECODE_OPERAND_JUMPS,
+    [OPCODE_JUMP_IF_FALSE_F64]          = BYTECODE_OPERAND_READS_A | BYTECODE_OPERAND_JUMPS | BYTECODE_OPERAND_FLOATS,
+    [OPCODE_JUMP_IF_FALSE_STRING]       = BYTECODE_OPERAND_READS_A | BYTECODE_OPERAND_JUMPS,
+    [OPCODE_JUMP_IF_TRUE_I64]           = BYTECODE_OPERAND_READS_A | BYTECODE_OPERAND_JUMPS,
+    [OPCODE_JUMP_IF_TRUE_F64]           = BYTECODE_OPERAND_READS_A | BYTECODE_OPERAND_JUMPS | BYTECODE_OPERAND_FLOATS,
+    [OPCODE_JUMP_IF_TRUE_STRING]        = BYTECODE_OPERAND_READS_A | BYTECODE_OPERAND_JUMPS,
+    [OPCODE_CALL]                       = BYTECODE_OPERAND_WRITES_A | BYTECODE_OPERAND_READS_B,
+    [OPCODE_RETURN]                     = BYTECODE_OPERAND_READS_A | BYTECODE_OPERAND_NO_FALL_THROUGH,
+    [OPCODE_ADD_I64_IMMEDIATE]          = BYTECODE_OPERAND_WRITES_A | BYTECODE_OPERAND_READS_B,
+    [OPCODE_MULTIPLY_I64_IMMEDIATE]     = BYTECODE_OPERAND_WRITES_A | BYTECODE_OPERAND_READS_B,
+    [OPCODE_JUMP_IF_LESS_I64]           = BYTECODE_OPERAND_READS_A | BYTECODE_OPERAND_READS_B | BYTECODE_OPERAND_JUMPS_SHORT,
+    [OPCODE_JUMP_IF_LESS_F64]           = BYTECODE_OPERAND_READS_A | BYTECODE_OPERAND_READS_B | BYTECODE_OPERAND_JUMPS_SHORT | BYTECODE_OPERAND_FLOATS,
+    [OPCODE_JUMP_IF_NOT_LESS_I64]       = BYTECODE_OPERAND_READS_A | BYTECODE_OPERAND_READS_B | BYTECODE_OPERAND_JUMPS_SHORT,
+    [OPCODE_JUMP_IF_NOT_LESS_F64]       = BYTECODE_OPERAND_READS_A | BYTECODE_OPERAND_READS_B | BYTECODE_OPERAND_JUMPS_SHORT | BYTECODE_OPERAND_FLOATS,
+    [OPCODE_JUMP_IF_GREATER_I64]        = BYTECODE_OPERAND_READS_A | BYTECODE_OPERAND_READS_B | BYTECODE_OPERAND_JUMPS_SHORT,
+    [OPCODE_JUMP_IF_GREATER_F64]        = BYTECODE_OPERAND_READS_A | BYTECODE_OPERAND_READS_B | BYTECODE_OPERAND_JUMPS_SHORT | BYTECODE_OPERAND_FLOATS,
+    [OPCODE_JUMP_IF_NOT_GREATER_I64]    = BYTECODE_OPERAND_READS_A | BYTECODE_OPERAND_READS_B | BYTECODE_OPERAND_JUMPS_SHORT,
+    [OPCODE_JUMP_IF_NOT_GREATER_F64]    = BYTECODE_OPERAND_READS_A | BYTECODE_OPERAND_READS_B | BYTECODE_OPERAND_JUMPS_SHORT | BYTECODE_OPERAND_FLOATS,
+};
+
+void bytecode_program_destroy(bytecode_program* program)
+{
+    for (u64 i = 0; i < program->function_count; ++i)
+    {
+        free(program->functions[i].code);
+        free(program->functions[i].instruction_tokens);
+    }
+
+    free(program->functions);
+    free(program->constants);
+    free(program->constant_types);
+    free(program->globals);
+
+    memset(program, 0, sizeof(bytecode_program));
+}
+
+const char* bytecode_opcode_name(bytecode_opcode opcode)
+{
+    if (opcode >= OPCODE_MAX_OPCODES || opcode_names[opcode] == NULL)
+        return opcode_names[OPCODE_INVALID];
+
+    return opcode_names[opcode];
+}
+
+u8 bytecode_opcode_operands(bytecode_opcode opcode)
+{
+    if (opcode >= OPCODE_MAX_OPCODES)
+        return 0;
+
+    return opcode_operands[opcode];
+}
+
+b8 bytecode_opcode_is_float(bytecode_opcode opcode)
+{
+    return (bytecode_opcode_operands(opcode) & BYTECODE_OPERAND_FLOATS) != 0;
+}
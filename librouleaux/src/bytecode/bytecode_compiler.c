@@ -0,0 +1,1399 @@
+#include "bytecode/bytecode_compiler.h"
+
+#include <malloc.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <string.h>
+
+#define DEFAULT_BYTECODE_CODE_CAPACITY 64
+#define DEFAULT_BYTECODE_POOL_CAPACITY 16
+#define DEFAULT_BYTECODE_LIST_CAPACITY 64
+#define DEFAULT_BYTECODE_RESIZE_FACTOR 2
+
+// The register of a value which was not given one, it is never read
+#define NO_REGISTER 0xFFFFFFFF
+
+// The operand of an instruction which is not an immediate
+#define NO_IMMEDIATE 0xFF
+
+// Set on a use of a value by a phi, the rest of the use is the predecessor the value has to be live at the end of
+#define USE_IS_LIVE_OUT 0x80000000
+
+// The last use of a value which is still live at the end of its block
+#define LIVE_OUT_USE 0xFFFFFFFF
+
+/**
+ * @brief A copy of one register into another, part of a set of copies which all happen at once
+ */
+typedef struct register_move {
+    /* The register written to */
+    u32 destination;
+    /* The register read from */
+    u32 source;
+} register_move;
+
+/**
+ * @brief A jump whose distance is only known once the block it jumps to was emitted
+ */
+typedef struct pending_jump {
+    /* The index of the jump in the function's code */
+    u64 instruction;
+    /* The block it jumps to */
+    u32 block;
+} pending_jump;
+
+/**
+ * @brief A value which is live at the start (or the end) of a block
+ */
+typedef struct live_value {
+    /* The block */
+    u32 block;
+    /* The value */
+    u32 value;
+} live_value;
+
+/**
+ * @brief A growable list of live_values, turned into the values of each block once it is complete
+ */
+typedef struct live_list {
+    /* The live values, in no particular order */
+    live_value* values;
+    /* The amount of values */
+    u64 count;
+    /* The amount of values the values array can hold */
+    u64 capacity;
+} live_list;
+
+/**
+ * @brief The state of compiling the SSA form of a program, and of the function being compiled
+ */
+typedef struct function_compiler {
+    /* The program the functions are compiled into */
+    bytecode_program* program;
+    /* The context errors are reported to */
+    rouleaux_context* context;
+    /* The SSA form being compiled */
+    const ssa_program* ssa;
+
+    /* The function being compiled */
+    const ssa_function* function;
+    /* The index of the function in both programs */
+    u64 function_index;
+
+    /* The amount of registers holding the globals, only the top level code holds them (in its first registers) */
+    u32 home_count;
+    /* The register right after the homes (or the parameters), never given to a value. It breaks the cycles of a set of
+       moves, holds an immediate while it is loaded and takes a result which is never used */
+    u32 scratch;
+    /* The amount of registers the function uses */
+    u32 register_count;
+
+    /* The blocks which can run, in reverse postorder */
+    u32* order;
+    /* The amount of blocks in order */
+    u32 order_count;
+    /* The position of each block in order, SSA_NONE for a block which never runs */
+    u32* order_index;
+
+    /* The operand of each instruction which is loaded as an immediate where it is used, NO_IMMEDIATE for none. The
+       value of such an operand is never held in a register for the instruction */
+    u8* immediate_operands;
+    /* Where the uses of each value start in uses, the uses of the value i end where the ones of i + 1 start */
+    u32* use_offsets;
+    /* The blocks each value is used in, or the predecessor it has to be live at the end of (with USE_IS_LIVE_OUT) */
+    u32* uses;
+    /* The phi each value is an operand of (the first one), SSA_NONE for none. The value is given the phi's register
+       when it is free, so the phi needs no move */
+    u32* phi_users;
+
+    /* Where the values live at the start of each block start in live_in */
+    u32* live_in_offsets;
+    /* The values live at the start of each block */
+    u32* live_in;
+    /* Where the values live at the end of each block start in live_out */
+    u32* live_out_offsets;
+    /* The values live at the end of each block */
+    u32* live_out;
+
+    /* The position of the last use of each value in its block, LIVE_OUT_USE when it is used after its block */
+    u32* last_uses;
+    /* Marks the values already seen while looking for the last uses of a block */
+    u32* stamps;
+    /* Set on an operand which is the last use of its value, the register of the value is free again once it was read */
+    b8* dies;
+
+    /* The register of each value, NO_REGISTER for a value which is not emitted */
+    u32* registers;
+    /* The first register of the arguments of each call */
+    u32* call_bases;
+
+    /* The generation each register was last taken in, it is free when that is not the current generation */
+    u32* busy;
+    /* The generation of the block being given its registers, each block starts a new one */
+    u32 generation;
+
+    /* The position of each block in the function's code */
+    u64* block_starts;
+    /* The jumps of the function */
+    pending_jump* jumps;
+    /* The amount of jumps */
+    u64 jump_count;
+    /* The amount of jumps the jumps array can hold */
+    u64 jump_capacity;
+
+    /* The moves being emitted at once */
+    register_move* moves;
+    /* The amount of moves */
+    u32 move_count;
+    /* The amount of moves the moves array can hold */
+    u32 move_capacity;
+
+    /* Set once an error was reported, nothing else is compiled after it */
+    b8 has_error;
+} function_compiler;
+
+// Compiles a single function of the SSA form into the bytecode_function with the same index
+static void compile_function(function_compiler* compiler, u64 function_index);
+
+// Allocates the arrays of the function being compiled, reporting an error if one could not be allocated
+static b8 allocate_function_state(function_compiler* compiler);
+
+// Frees the arrays of the function being compiled
+static void release_function_state(function_compiler* compiler);
+
+// Picks the operands which are better loaded as an immediate where they are used, the peephole pass fuses those loads
+static void find_immediates(function_compiler* compiler);
+
+// Collects the blocks every value is used in
+static b8 collect_uses(function_compiler* compiler);
+
+// Finds the values live at the start and the end of every block
+static b8 compute_liveness(function_compiler* compiler);
+
+// Adds a value to a list of live values
+static b8 push_live_value(live_list* list, u32 block, u32 value);
+
+// Turns a list of live values into the values of each block
+static b8 group_live_values(function_compiler* compiler, live_list* list, u32** out_offsets, u32** out_values);
+
+// Finds the operands which are the last use of their value, and the loads of the top level code left in their global's
+// register
+static void find_last_uses(function_compiler* compiler);
+
+// Gives every value which is emitted a register, going through the blocks in an order where definitions come first
+static void allocate_registers(function_compiler* compiler);
+
+// Gives the values of a single block their registers
+static void allocate_block(function_compiler* compiler, u32 block_index);
+
+// Frees the registers of the operands of an instruction whose value is never read again
+static void free_dying_operands(function_compiler* compiler, u32 instruction);
+
+// Takes a free register for a value, preferring one that saves a move into (or out of) a phi
+static u32 take_register(function_compiler* compiler, u32 value);
+
+// True if a register can be given to a value right now
+static b8 is_register_free(function_compiler* compiler, u32 index);
+
+// Marks a register as taken and counts it as used by the function
+static void mark_register(function_compiler* compiler, u32 index);
+
+// Gives the register the arguments of a call start at, after every register still holding a value
+static u32 call_base(function_compiler* compiler, u32 instruction);
+
+// Emits the blocks of the function in the order of its layout
+static void emit_function(function_compiler* compiler);
+
+// Emits a single instruction
+static void emit_instruction(function_compiler* compiler, u32 instruction);
+
+// Emits the end of a block, the moves of the phis of the block it jumps to and its jumps
+static void emit_terminator(function_compiler* compiler, u32 block_index, u32 next_block);
+
+// Emits the moves giving the phis of a block their value when it is entered from a predecessor
+static void emit_phi_moves(function_compiler* compiler, u32 predecessor, u32 block_index);
+
+// Adds a move to the moves being emitted at once
+static void add_move(function_compiler* compiler, u32 destination, u32 source, token t);
+
+// Emits the moves added since the last call at once, no move reads a register after another one wrote it
+static void emit_moves(function_compiler* compiler, token t);
+
+// Emits a jump (or conditional jump) to a block
+static void emit_jump(function_compiler* compiler, bytecode_opcode opcode, u32 condition, u32 block_index, token t);
+
+// Loads a value from the constant pool into a register
+static void emit_constant(function_compiler* compiler, bytecode_value value, type_info type, u32 destination, token t);
+
+// True if the instruction is emitted, its value is used or running it can change something (or fail)
+static b8 is_emitted(function_compiler* compiler, u32 instruction);
+
+// Gives the amount of uses of a value
+static u32 use_count(function_compiler* compiler, u32 value);
+
+// Gives the bytecode_opcode of an arithmetic operation or comparison on operands of an integer or float type
+static bytecode_opcode arithmetic_opcode(ssa_opcode opcode, type_info operand_type);
+
+// Gives the conditional jump testing a condition of a type, jumping when it is true if jump_if_true is set
+static bytecode_opcode conditional_jump_opcode(type_info condition_type, b8 jump_if_true);
+
+// Adds an instruction to the end of the function being compiled, giving its index
+static u64 emit(function_compiler* compiler, bytecode_instruction instruction, token t);
+
+// Adds a value of a type to the program's constant pool, giving its index
+static u32 add_constant(function_compiler* compiler, bytecode_value value, type_info type, token t);
+
+// Reports an error to the context, only the first one is reported
+static void compile_error(function_compiler* compiler, token t, diagnostic_id id, ...);
+
+
+b8 bytecode_compile(rouleaux_context* context, const ssa_program* program, bytecode_program* out_program)
+{
+    memset(out_program, 0, sizeof(bytecode_program));
+
+    function_compiler compiler = {};
+    compiler.program = out_program;
+    compiler.context = context;
+    compiler.ssa = program;
+
+    token file_token = {};
+    if (program->global_count > 0)
+        file_token = program->globals[program->global_count - 1].name;
+
+    // The globals are the first registers of the top level code, and the scratch register comes right after them
+    if (program->global_count >= BYTECODE_MAX_REGISTERS)
+    {
+        compile_error(&compiler, file_token, DIAGNOSTIC_TOO_MANY_REGISTERS, diagnostic_integer(BYTECODE_MAX_REGISTERS));
+        return false;
+    }
+
+    // Every register shares this array, a register is taken when it holds the generation of the block
+    compiler.busy = calloc(BYTECODE_MAX_REGISTERS, sizeof(u32));
+    out_program->functions = malloc((program->function_count + 1) * sizeof(bytecode_function));
+    out_program->globals = malloc((program->global_count + 1) * sizeof(bytecode_global));
+    if (compiler.busy == NULL || out_program->functions == NULL || out_program->globals == NULL)
+    {
+        free(compiler.busy);
+        compile_error(&compiler, file_token, DIAGNOSTIC_BYTECODE_ALLOCATION);
+        return false;
+    }
+
+    out_program->function_capacity = program->function_count + 1;
+    out_program->global_capacity = program->global_count + 1;
+    for (u64 i = 0; i < program->global_count; ++i)
+    {
+        out_program->globals[i].name = program->globals[i].name;
+        out_program->globals[i].type = program->globals[i].type;
+    }
+
+    out_program->global_count = program->global_count;
+
+    // A function is called by its index, which is the same in both programs
+    for (u64 i = 0; i < program->function_count; ++i)
+    {
+        bytecode_function* function = &out_program->functions[i];
+        memset(function, 0, sizeof(bytecode_function));
+        function->name = program->functions[i].name;
+        function->parameter_count = program->functions[i].parameter_count;
+        function->return_type = program->functions[i].return_type;
+    }
+
+    out_program->function_count = program->function_count;
+
+    for (u64 i = 0; i < program->function_count && !compiler.has_error; ++i)
+        compile_function(&compiler, i);
+
+    free(compiler.busy);
+
+    return !compiler.has_error;
+}
+
+
+
+void compile_function(function_compiler* compiler, u64 function_index)
+{
+    const ssa_function* function = &compiler->ssa->functions[function_index];
+    compiler->function = function;
+    compiler->function_index = function_index;
+
+    // The top level code holds the globals in its own registers
+    compiler->home_count = (function_index == 0) ? (u32)compiler->ssa->global_count : 0;
+    compiler->scratch = (function_index == 0) ? compiler->home_count : function->parameter_count;
+    compiler->register_count = compiler->scratch + 1;
+
+    if (!allocate_function_state(compiler))
+    {
+        release_function_state(compiler);
+        return;
+    }
+
+    compiler->order_count = ssa_reverse_postorder(function, compiler->order);
+    if (compiler->order_count == SSA_NONE)
+    {
+        compile_error(compiler, function->name, DIAGNOSTIC_BYTECODE_ALLOCATION);
+        release_function_state(compiler);
+        return;
+    }
+
+    for (u32 i = 0; i < compiler->order_count; ++i)
+        compiler->order_index[compiler->order[i]] = i;
+
+    find_immediates(compiler);
+    if (collect_uses(compiler) && compute_liveness(compiler))
+    {
+        find_last_uses(compiler);
+        allocate_registers(compiler);
+        emit_function(compiler);
+    }
+
+    compiler->program->functions[function_index].register_count = (u16)compiler->register_count;
+
+    release_function_state(compiler);
+}
+
+b8 allocate_function_state(function_compiler* compiler)
+{
+    // Everything is sized one larger, so nothing is an allocation of zero bytes
+    const ssa_function* function = compiler->function;
+    u32 instruction_count = function->instruction_count + 1;
+    u32 block_count = function->block_count + 1;
+
+    compiler->order = malloc(block_count * sizeof(u32));
+    compiler->order_index = malloc(block_count * sizeof(u32));
+    compiler->immediate_operands = malloc(instruction_count * sizeof(u8));
+    compiler->use_offsets = calloc(instruction_count + 1, sizeof(u32));
+    compiler->phi_users = malloc(instruction_count * sizeof(u32));
+    compiler->last_uses = calloc(instruction_count, sizeof(u32));
+    compiler->stamps = calloc(instruction_count, sizeof(u32));
+    compiler->dies = calloc(function->operand_count + 1, sizeof(b8));
+    compiler->registers = malloc(instruction_count * sizeof(u32));
+    compiler->call_bases = calloc(instruction_count, sizeof(u32));
+    compiler->block_starts = calloc(block_count, sizeof(u64));
+    if (compiler->order == NULL || compiler->order_index == NULL || compiler->immediate_operands == NULL || compiler->use_offsets == NULL ||
+        compiler->phi_users == NULL || compiler->last_uses == NULL || compiler->stamps == NULL || compiler->dies == NULL ||
+        compiler->registers == NULL || compiler->call_bases == NULL || compiler->block_starts == NULL)
+    {
+        compile_error(compiler, function->name, DIAGNOSTIC_BYTECODE_ALLOCATION);
+        return false;
+    }
+
+    memset(compiler->order_index, 0xFF, block_count * sizeof(u32));
+    memset(compiler->immediate_operands, NO_IMMEDIATE, instruction_count * sizeof(u8));
+    memset(compiler->phi_users, 0xFF, instruction_count * sizeof(u32));
+    memset(compiler->registers, 0xFF, instruction_count * sizeof(u32));
+
+    return true;
+}
+
+void release_function_state(function_compiler* compiler)
+{
+    free(compiler->order);
+    free(compiler->order_index);
+    free(compiler->immediate_operands);
+    free(compiler->use_offsets);
+    free(compiler->uses);
+    free(compiler->phi_users);
+    free(compiler->live_in_offsets);
+    free(compiler->live_in);
+    free(compiler->live_out_offsets);
+    free(compiler->live_out);
+    free(compiler->last_uses);
+    free(compiler->stamps);
+    free(compiler->dies);
+    free(compiler->registers);
+    free(compiler->call_bases);
+    free(compiler->block_starts);
+    free(compiler->jumps);
+    free(compiler->moves);
+
+    // Only the shared state is kept for the next function
+    u32* busy = compiler->busy;
+    u32 generation = compiler->generation;
+    b8 has_error = compiler->has_error;
+    bytecode_program* program = compiler->program;
+    rouleaux_context* context = compiler->context;
+    const ssa_program* ssa = compiler->ssa;
+
+    memset(compiler, 0, sizeof(function_compiler));
+    compiler->busy = busy;
+    compiler->generation = generation;
+    compiler->has_error = has_error;
+    compiler->program = program;
+    compiler->context = context;
+    compiler->ssa = ssa;
+}
+
+void find_immediates(function_compiler* compiler)
+{
+    const ssa_function* function = compiler->function;
+    for (u32 i = 0; i < compiler->order_count; ++i)
+    {
+        const ssa_block* block = &function->blocks[compiler->order[i]];
+        for (u32 j = 0; j < block->instruction_count; ++j)
+        {
+            u32 index = block->instructions[j];
+            const ssa_instruction* instruction = &function->instructions[index];
+            b8 is_subtract = instruction->opcode == SSA_OPCODE_SUBTRACT;
+            if (instruction->type != TYPE_INFO_INTEGER || (instruction->opcode != SSA_OPCODE_ADD && instruction->opcode != SSA_OPCODE_MULTIPLY && !is_subtract))
+                continue;
+
+            // The right operand is preferred, a subtraction can only take its right operand as an immediate
+            const u32* operands = ssa_operands(function, index);
+            for (u32 k = 2; k > (is_subtract ? 1u : 0u); --k)
+            {
+                const ssa_instruction* operand = &function->instructions[operands[k - 1]];
+                if (operand->opcode != SSA_OPCODE_CONSTANT || operand->type != TYPE_INFO_INTEGER)
+                    continue;
+
+                // The peephole pass negates the immediate of a subtraction, which has to fit as well
+                i64 value = operand->constant.integer;
+                b8 fits = is_subtract ? (value >= -INT16_MAX && value <= -(i64)INT16_MIN) : (value >= INT16_MIN && value <= INT16_MAX);
+                if (fits)
+                {
+                    compiler->immediate_operands[index] = (u8)(k - 1);
+                    break;
+                }
+            }
+        }
+    }
+}
+
+b8 collect_uses(function_compiler* compiler)
+{
+    const ssa_function* function = compiler->function;
+
+    // The uses are counted first, then written into the space each value was given
+    for (u32 pass = 0; pass < 2; ++pass)
+    {
+        if (pass == 1)
+        {
+            for (u32 i = 0; i < function->instruction_count; ++i)
+                compiler->use_offsets[i + 1] += compiler->use_offsets[i];
+
+            compiler->uses = malloc((compiler->use_offsets[function->instruction_count] + 1) * sizeof(u32));
+            if (compiler->uses == NULL)
+            {
+                compile_error(compiler, function->name, DIAGNOSTIC_BYTECODE_ALLOCATION);
+                return false;
+            }
+        }
+
+        for (u32 i = 0; i < compiler->order_count; ++i)
+        {
+            u32 block_index = compiler->order[i];
+            const ssa_block* block = &function->blocks[block_index];
+
+            // The operand of a phi is used at the end of the predecessor it comes from
+            for (u32 j = 0; j < block->phi_count; ++j)
+            {
+                const u32* operands = ssa_operands(function, block->phis[j]);
+                for (u32 k = 0; k < block->predecessor_count; ++k)
+                {
+                    if (compiler->order_index[block->predecessors[k]] == SSA_NONE)
+                        continue;
+
+                    if (pass == 0)
+                    {
+                        compiler->use_offsets[operands[k] + 1]++;
+                        continue;
+                    }
+
+                    compiler->uses[compiler->use_offsets[operands[k]]++] = block->predecessors[k] | USE_IS_LIVE_OUT;
+                    if (compiler->phi_users[operands[k]] == SSA_NONE)
+                        compiler->phi_users[operands[k]] = block->phis[j];
+                }
+            }
+
+            for (u32 j = 0; j < block->instruction_count; ++j)
+            {
+                u32 index = block->instructions[j];
+                const ssa_instruction* instruction = &function->instructions[index];
+                const u32* operands = ssa_operands(function, index);
+                for (u32 k = 0; k < instruction->operand_count; ++k)
+                {
+                    if (compiler->immediate_operands[index] == k)
+                        continue;
+
+                    if (pass == 0)
+                        compiler->use_offsets[operands[k] + 1]++;
+                    else
+                        compiler->uses[compiler->use_offsets[operands[k]]++] = block_index;
+                }
+            }
+
+            if (block->terminator != SSA_TERMINATOR_BRANCH)
+                continue;
+
+            if (pass == 0)
+                compiler->use_offsets[block->condition + 1]++;
+            else
+                compiler->uses[compiler->use_offsets[block->condition]++] = block_index;
+        }
+    }
+
+    // Writing the uses moved every offset to where the next value's uses start
+    memmove(compiler->use_offsets + 1, compiler->use_offsets, function->instruction_count * sizeof(u32));
+    compiler->use_offsets[0] = 0;
+
+    return true;
+}
+
+b8 compute_liveness(function_compiler* compiler)
+{
+    const ssa_function* function = compiler->function;
+    live_list live_in = {};
+    live_list live_out = {};
+
+    // Each value is followed up from its uses to its definition, the stamps of a block tell whether the
+    // value was already found live there. A value is only ever live in the blocks its definition dominates
+    u32* in_stamps = calloc(function->block_count + 1, sizeof(u32));
+    u32* out_stamps = calloc(function->block_count + 1, sizeof(u32));
+    u32* stack = malloc((function->block_count + 1) * sizeof(u32));
+    b8 is_allocated = in_stamps != NULL && out_stamps != NULL && stack != NULL;
+
+    for (u32 value = 0; value < function->instruction_count && is_allocated; ++value)
+    {
+        const ssa_instruction* instruction = &function->instructions[value];
+        if (instruction->opcode == SSA_OPCODE_INVALID || compiler->order_index[instruction->block] == SSA_NONE)
+            continue;
+
+        u32 definition = instruction->block;
+        u32 stamp = value + 1;
+        u32 stack_count = 0;
+        for (u32 i = compiler->use_offsets[value]; i < compiler->use_offsets[value + 1] && is_allocated; ++i)
+        {
+            u32 block_index = compiler->uses[i] & ~USE_IS_LIVE_OUT;
+            if (compiler->uses[i] & USE_IS_LIVE_OUT)
+            {
+                if (out_stamps[block_index] != stamp)
+                {
+                    out_stamps[block_index] = stamp;
+                    is_allocated = push_live_value(&live_out, block_index, value);
+                }
+            }
+
+            if (block_index == definition || in_stamps[block_index] == stamp)
+                continue;
+
+            in_stamps[block_index] = stamp;
+            is_allocated = is_allocated && push_live_value(&live_in, block_index, value);
+            stack[stack_count++] = block_index;
+        }
+
+        // A value live at the start of a block is live at the end of each of its predecessors
+        while (stack_count > 0 && is_allocated)
+        {
+            const ssa_block* block = &function->blocks[stack[--stack_count]];
+            for (u32 i = 0; i < block->predecessor_count && is_allocated; ++i)
+            {
+                u32 predecessor = block->predecessors[i];
+                if (compiler->order_index[predecessor] == SSA_NONE)
+                    continue;
+
+                if (out_stamps[predecessor] != stamp)
+                {
+                    out_stamps[predecessor] = stamp;
+                    is_allocated = push_live_value(&live_out, predecessor, value);
+                }
+
+                if (predecessor == definition || in_stamps[predecessor] == stamp)
+                    continue;
+
+                in_stamps[predecessor] = stamp;
+                is_allocated = is_allocated && push_live_value(&live_in, predecessor, value);
+                stack[stack_count++] = predecessor;
+            }
+        }
+    }
+
+    free(in_stamps);
+    free(out_stamps);
+    free(stack);
+
+    if (is_allocated)
+        is_allocated = group_live_values(compiler, &live_in, &compiler->live_in_offsets, &compiler->live_in) && group_live_values(compiler, &live_out, &compiler->live_out_offsets, &compiler->live_out);
+
+    free(live_in.values);
+    free(live_out.values);
+
+    if (!is_allocated)
+        compile_error(compiler, function->name, DIAGNOSTIC_BYTECODE_ALLOCATION);
+
+    return is_allocated;
+}
+
+b8 push_live_value(live_list* list, u32 block, u32 value)
+{
+    if (list->count >= list->capacity)
+    {
+        u64 new_capacity = list->capacity ? list->capacity * DEFAULT_BYTECODE_RESIZE_FACTOR : DEFAULT_BYTECODE_LIST_CAPACITY;
+        live_value* new_values = realloc(list->values, new_capacity * sizeof(live_value));
+        if (new_values == NULL)
+            return false;
+
+        list->values = new_values;
+        list->capacity = new_capacity;
+    }
+
+    list->values[list->count++] = (live_value){ block, value };
+    return true;
+}
+
+b8 group_live_values(function_compiler* compiler, live_list* list, u32** out_offsets, u32** out_values)
+{
+    u32 block_count = compiler->function->block_count;
+    u32* offsets = calloc(block_count + 1, sizeof(u32));
+    u32* values = malloc((list->count + 1) * sizeof(u32));
+    if (offsets == NULL || values == NULL)
+    {
+        free(offsets);
+        free(values);
+        return false;
+    }
+
+    // The same counting and writing as the uses, the offsets end up where each block's values start
+    for (u64 i = 0; i < list->count; ++i)
+        offsets[list->values[i].block + 1]++;
+
+    for (u32 i = 0; i < block_count; ++i)
+        offsets[i + 1] += offsets[i];
+
+    for (u64 i = 0; i < list->count; ++i)
+        values[offsets[list->values[i].block]++] = list->values[i].value;
+
+    memmove(offsets + 1, offsets, block_count * sizeof(u32));
+    offsets[0] = 0;
+
+    *out_offsets = offsets;
+    *out_values = values;
+    return true;
+}
+
+void find_last_uses(function_compiler* compiler)
+{
+    const ssa_function* function = compiler->function;
+
+    // The top level code can read a global straight from its register, as long as nothing can write the
+    // global before the value was last read. Only a store to it or a call can
+    u32* store_stamps = NULL;
+    u32* next_stores = NULL;
+    if (compiler->home_count > 0)
+    {
+        store_stamps = calloc(compiler->home_count, sizeof(u32));
+        next_stores = malloc(compiler->home_count * sizeof(u32));
+    }
+
+    for (u32 i = 0; i < compiler->order_count; ++i)
+    {
+        u32 block_index = compiler->order[i];
+        const ssa_block* block = &function->blocks[block_index];
+        u32 stamp = block_index + 1;
+
+        for (u32 j = compiler->live_out_offsets[block_index]; j < compiler->live_out_offsets[block_index + 1]; ++j)
+        {
+            compiler->stamps[compiler->live_out[j]] = stamp;
+            compiler->last_uses[compiler->live_out[j]] = LIVE_OUT_USE;
+        }
+
+        if (block->terminator == SSA_TERMINATOR_BRANCH && compiler->stamps[block->condition] != stamp)
+        {
+            compiler->stamps[block->condition] = stamp;
+            compiler->last_uses[block->condition] = block->instruction_count;
+        }
+
+        // The block is walked backwards, so the first use of a value found is its last one
+        u32 next_call = block->instruction_count;
+        for (u32 j = block->instruction_count; j > 0; --j)
+        {
+            u32 index = block->instructions[j - 1];
+            const ssa_instruction* instruction = &function->instructions[index];
+            if (store_stamps != NULL && next_stores != NULL)
+            {
+                u32 global = (u32)instruction->index;
+                if (instruction->opcode == SSA_OPCODE_LOAD_GLOBAL && use_count(compiler, index) > 0)
+                {
+                    u32 limit = next_call;
+                    if (store_stamps[global] == stamp && next_stores[global] < limit)
+                        limit = next_stores[global];
+
+                    if (compiler->last_uses[index] <= limit)
+                        compiler->registers[index] = global;
+                }
+                else if (instruction->opcode == SSA_OPCODE_STORE_GLOBAL)
+                {
+                    store_stamps[global] = stamp;
+                    next_stores[global] = j - 1;
+                }
+            }
+
+            if (instruction->opcode == SSA_OPCODE_CALL)
+                next_call = j - 1;
+
+            const u32* operands = ssa_operands(function, index);
+            for (u32 k = instruction->operand_count; k > 0; --k)
+            {
+                u32 value = operands[k - 1];
+                if (compiler->immediate_operands[index] == k - 1 || compiler->stamps[value] == stamp)
+                    continue;
+
+                compiler->stamps[value] = stamp;
+                compiler->last_uses[value] = j - 1;
+                compiler->dies[instruction->first_operand + k - 1] = true;
+            }
+        }
+    }
+
+    free(store_stamps);
+    free(next_stores);
+}
+
+void allocate_registers(function_compiler* compiler)
+{
+    // A block comes after the blocks dominating it, so every value live at its start already has a register.
+    // Giving each value a register no value live at its definition holds never needs more registers than
+    // the most values live at once
+    for (u32 i = 0; i < compiler->order_count && !compiler->has_error; ++i)
+        allocate_block(compiler, compiler->order[i]);
+}
+
+void allocate_block(function_compiler* compiler, u32 block_index)
+{
+    const ssa_function* function = compiler->function;
+    const ssa_block* block = &function->blocks[block_index];
+    compiler->generation++;
+
+    for (u32 i = compiler->live_in_offsets[block_index]; i < compiler->live_in_offsets[block_index + 1]; ++i)
+    {
+        u32 index = compiler->registers[compiler->live_in[i]];
+        if (index != NO_REGISTER && index >= compiler->home_count)
+            compiler->busy[index] = compiler->generation;
+    }
+
+    // The parameters arrive in the first registers
+    for (u32 i = 0; i < block->instruction_count && block_index == 0; ++i)
+    {
+        u32 index = block->instructions[i];
+        const ssa_instruction* instruction = &function->instructions[index];
+        if (instruction->opcode == SSA_OPCODE_PARAMETER && use_count(compiler, index) > 0)
+        {
+            compiler->registers[index] = (u32)instruction->index;
+            compiler->busy[instruction->index] = compiler->generation;
+        }
+    }
+
+    for (u32 i = 0; i < block->phi_count && !compiler->has_error; ++i)
+    {
+        if (use_count(compiler, block->phis[i]) > 0)
+            compiler->registers[block->phis[i]] = take_register(compiler, block->phis[i]);
+    }
+
+    for (u32 i = 0; i < block->instruction_count && !compiler->has_error; ++i)
+    {
+        u32 index = block->instructions[i];
+        const ssa_instruction* instruction = &function->instructions[index];
+        switch (instruction->opcode)
+        {
+            case SSA_OPCODE_PARAMETER:
+            {
+                // Already in its register
+                break;
+            }
+            case SSA_OPCODE_STORE_GLOBAL:
+            {
+                free_dying_operands(compiler, index);
+                break;
+            }
+            case SSA_OPCODE_CALL:
+            {
+                // The arguments which are never read again are already moved into place, the other values stay below them
+                free_dying_operands(compiler, index);
+                compiler->call_bases[index] = call_base(compiler, index);
+                compiler->registers[index] = (use_count(compiler, index) > 0) ? take_register(compiler, index) : compiler->scratch;
+                break;
+            }
+            default:
+            {
+                // A load of the top level code left in its global's register already has it
+                if (compiler->registers[index] != NO_REGISTER)
+                    break;
+
+                // The operands are read before the result is written, so the result can take an operand's register
+                free_dying_operands(compiler, index);
+                if (is_emitted(compiler, index))
+                    compiler->registers[index] = (use_count(compiler, index) > 0) ? take_register(compiler, index) : compiler->scratch;
+                break;
+            }
+        };
+    }
+}
+
+void free_dying_operands(function_compiler* compiler, u32 instruction)
+{
+    const ssa_function* function = compiler->function;
+    const ssa_instruction* operation = &function->instructions[instruction];
+    const u32* operands = ssa_operands(function, instruction);
+    for (u32 i = 0; i < operation->operand_count; ++i)
+    {
+        if (!compiler->dies[operation->first_operand + i])
+            continue;
+
+        u32 index = compiler->registers[operands[i]];
+        if (index != NO_REGISTER && index >= compiler->home_count && index != compiler->scratch)
+            compiler->busy[index] = 0;
+    }
+}
+
+u32 take_register(function_compiler* compiler, u32 value)
+{
+    const ssa_function* function = compiler->function;
+    const ssa_instruction* instruction = &function->instructions[value];
+
+    // A phi prefers the register of one of its operands, and a value the register of the phi it is an operand of (or of
+    // the phi's other operands), each of those saves a move when the phi is entered
+    u32 phi = (instruction->opcode == SSA_OPCODE_PHI) ? value : compiler->phi_users[value];
+    if (phi != SSA_NONE)
+    {
+        if (phi != value && compiler->registers[phi] != NO_REGISTER && is_register_free(compiler, compiler->registers[phi]))
+        {
+            mark_register(compiler, compiler->registers[phi]);
+            return compiler->registers[phi];
+        }
+
+        const ssa_instruction* phi_instruction = &function->instructions[phi];
+        const u32* operands = ssa_operands(function, phi);
+        for (u32 i = 0; i < phi_instruction->operand_count; ++i)
+        {
+            u32 hint = compiler->registers[operands[i]];
+            if (operands[i] != value && hint != NO_REGISTER && is_register_free(compiler, hint))
+            {
+                mark_register(compiler, hint);
+                return hint;
+            }
+        }
+    }
+
+    u32 index = compiler->home_count;
+    while (index < BYTECODE_MAX_REGISTERS && !is_register_free(compiler, index))
+        index++;
+
+    if (index >= BYTECODE_MAX_REGISTERS)
+    {
+        compile_error(compiler, instruction->t, DIAGNOSTIC_TOO_MANY_REGISTERS, diagnostic_integer(BYTECODE_MAX_REGISTERS));
+        return compiler->scratch;
+    }
+
+    mark_register(compiler, index);
+    return index;
+}
+
+b8 is_register_free(function_compiler* compiler, u32 index)
+{
+    return index >= compiler->home_count && index != compiler->scratch && compiler->busy[index] != compiler->generation;
+}
+
+void mark_register(function_compiler* compiler, u32 index)
+{
+    compiler->busy[index] = compiler->generation;
+    if (index + 1 > compiler->register_count)
+        compiler->register_count = index + 1;
+}
+
+u32 call_base(function_compiler* compiler, u32 instruction)
+{
+    const ssa_function* function = compiler->function;
+    const ssa_instruction* call = &function->instructions[instruction];
+
+    // The callee's frame starts at its first argument and overwrites the registers after it, the callee
+    // itself is read before the arguments are moved, so it stays below them as well
+    u32 base = compiler->scratch + 1;
+    u32 callee = compiler->registers[ssa_operands(function, instruction)[0]];
+    if (callee != NO_REGISTER && callee + 1 > base)
+        base = callee + 1;
+
+    for (u32 i = compiler->register_count; i > base; --i)
+    {
+        if (compiler->busy[i - 1] == compiler->generation)
+        {
+            base = i;
+            break;
+        }
+    }
+
+    u32 argument_count = call->operand_count - 1;
+    if (base + argument_count > BYTECODE_MAX_REGISTERS)
+    {
+        compile_error(compiler, call->t, DIAGNOSTIC_TOO_MANY_REGISTERS, diagnostic_integer(BYTECODE_MAX_REGISTERS));
+        return 0;
+    }
+
+    if (base + argument_count > compiler->register_count)
+        compiler->register_count = base + argument_count;
+
+    return base;
+}
+
+void emit_function(function_compiler* compiler)
+{
+    const ssa_function* function = compiler->function;
+
+    // The blocks keep the order of the layout, which puts the body of a loop right before the test branching back to it
+    u32 block_index = 0;
+    while (block_index < function->block_count && !compiler->has_error)
+    {
+        u32 next_block = block_index + 1;
+        while (next_block < function->block_count && compiler->order_index[next_block] == SSA_NONE)
+            next_block++;
+
+        const ssa_block* block = &function->blocks[block_index];
+        compiler->block_starts[block_index] = compiler->program->functions[compiler->function_index].code_length;
+
+        // A block entered from a branch is its only successor to have, so its phis are given their value here
+        if (block->phi_count > 0 && block->predecessor_count == 1 && function->blocks[block->predecessors[0]].terminator != SSA_TERMINATOR_JUMP)
+            emit_phi_moves(compiler, block->predecessors[0], block_index);
+
+        for (u32 i = 0; i < block->instruction_count; ++i)
+            emit_instruction(compiler, block->instructions[i]);
+
+        emit_terminator(compiler, block_index, next_block);
+        block_index = next_block;
+    }
+
+    if (compiler->has_error)
+        return;
+
+    bytecode_function* compiled = &compiler->program->functions[compiler->function_index];
+    for (u64 i = 0; i < compiler->jump_count; ++i)
+    {
+        pending_jump* jump = &compiler->jumps[i];
+        compiled->code[jump->instruction].offset = (i32)((i64)compiler->block_starts[jump->block] - (i64)(jump->instruction + 1));
+    }
+}
+
+void emit_instruction(function_compiler* compiler, u32 instruction)
+{
+    const ssa_function* function = compiler->function;
+    const ssa_instruction* operation = &function->instructions[instruction];
+    const u32* operands = ssa_operands(function, instruction);
+    u32 destination = compiler->registers[instruction];
+    token t = operation->t;
+
+    switch (operation->opcode)
+    {
+        case SSA_OPCODE_CONSTANT:
+        {
+            if (destination == NO_REGISTER || use_count(compiler, instruction) == 0)
+                break;
+
+            // The native backend points a string constant into its read only data, the empty string has none
+            type_info type = operation->type;
+            if (type == TYPE_INFO_STRING && operation->constant.bits == 0)
+                type = TYPE_INFO_UNKNOWN;
+
+            emit_constant(compiler, (bytecode_value){ .bits = operation->constant.bits }, type, destination, t);
+            break;
+        }
+        case SSA_OPCODE_ADD:
+        case SSA_OPCODE_SUBTRACT:
+        case SSA_OPCODE_MULTIPLY:
+        case SSA_OPCODE_DIVIDE:
+        case SSA_OPCODE_MODULUS:
+        case SSA_OPCODE_GREATER_THAN:
+        case SSA_OPCODE_LESS_THAN:
+        {
+            if (destination == NO_REGISTER)
+                break;
+
+            bytecode_opcode opcode = arithmetic_opcode(operation->opcode, operation->type);
+            u8 immediate = compiler->immediate_operands[instruction];
+            if (immediate == NO_IMMEDIATE)
+            {
+                emit(compiler, (bytecode_instruction){ .opcode = opcode, .a = destination, .b = compiler->registers[operands[0]], .c = compiler->registers[operands[1]] }, t);
+                break;
+            }
+
+            // The immediate is loaded right before the operation, the peephole pass folds the two into one instruction.
+            // It needs a register other than the other operand's
+            u32 other = compiler->registers[operands[1 - immediate]];
+            u32 loaded = (destination == other) ? compiler->scratch : destination;
+            const ssa_instruction* constant = &function->instructions[operands[immediate]];
+            emit_constant(compiler, (bytecode_value){ .bits = constant->constant.bits }, TYPE_INFO_INTEGER, loaded, constant->t);
+
+            u32 b = (immediate == 0) ? loaded : other;
+            u32 c = (immediate == 0) ? other : loaded;
+            emit(compiler, (bytecode_instruction){ .opcode = opcode, .a = destination, .b = b, .c = c }, t);
+            break;
+        }
+        case SSA_OPCODE_LOAD_GLOBAL:
+        {
+            // A load of the top level code left in its global's register emits nothing
+            if (destination == NO_REGISTER || destination < compiler->home_count)
+                break;
+
+            if (compiler->home_count > 0)
+                emit(compiler, (bytecode_instruction){ .opcode = OPCODE_MOVE, .a = destination, .b = (u16)operation->index }, t);
+            else
+                emit(compiler, (bytecode_instruction){ .opcode = OPCODE_GET_GLOBAL, .a = destination, .index = (u32)operation->index }, t);
+
+            break;
+        }
+        case SSA_OPCODE_STORE_GLOBAL:
+        {
+            u32 source = compiler->registers[operands[0]];
+            if (compiler->home_count == 0)
+                emit(compiler, (bytecode_instruction){ .opcode = OPCODE_SET_GLOBAL, .a = source, .index = (u32)operation->index }, t);
+            else if (source != operation->index)
+                emit(compiler, (bytecode_instruction){ .opcode = OPCODE_MOVE, .a = (u16)operation->index, .b = source }, t);
+
+            break;
+        }
+        case SSA_OPCODE_CALL:
+        {
+            u32 base = compiler->call_bases[instruction];
+            for (u32 i = 1; i < operation->operand_count; ++i)
+                add_move(compiler, base + i - 1, compiler->registers[operands[i]], t);
+
+            emit_moves(compiler, t);
+            emit(compiler, (bytecode_instruction){ .opcode = OPCODE_CALL, .a = destination, .b = compiler->registers[operands[0]], .c = base }, t);
+            break;
+        }
+        default:
+        {
+            // A parameter arrives in its register, and a phi is given its value where its block is entered
+            break;
+        }
+    };
+}
+
+void emit_terminator(function_compiler* compiler, u32 block_index, u32 next_block)
+{
+    const ssa_function* function = compiler->function;
+    const ssa_block* block = &function->blocks[block_index];
+    token t = block->t;
+
+    switch (block->terminator)
+    {
+        case SSA_TERMINATOR_JUMP:
+        {
+            u32 successor = block->successors[0];
+            if (function->blocks[successor].phi_count > 0)
+                emit_phi_moves(compiler, block_index, successor);
+
+            if (successor != next_block)
+                emit_jump(compiler, OPCODE_JUMP, 0, successor, t);
+
+            break;
+        }
+        case SSA_TERMINATOR_BRANCH:
+        {
+            // Only the successor which does not follow the block is jumped to
+            u32 condition = compiler->registers[block->condition];
+            type_info type = function->instructions[block->condition].type;
+            if (block->successors[1] == next_block)
+            {
+                emit_jump(compiler, conditional_jump_opcode(type, true), condition, block->successors[0], t);
+            }
+            else if (block->successors[0] == next_block)
+            {
+                emit_jump(compiler, conditional_jump_opcode(type, false), condition, block->successors[1], t);
+            }
+            else
+            {
+                emit_jump(compiler, conditional_jump_opcode(type, true), condition, block->successors[0], t);
+                emit_jump(compiler, OPCODE_JUMP, 0, block->successors[1], t);
+            }
+
+            break;
+        }
+        case SSA_TERMINATOR_RETURN:
+        {
+            // The language has no return statement yet, so a call gives the zero value of its return type
+            emit_constant(compiler, (bytecode_value){}, TYPE_INFO_UNKNOWN, compiler->scratch, t);
+            emit(compiler, (bytecode_instruction){ .opcode = OPCODE_RETURN, .a = compiler->scratch }, t);
+            break;
+        }
+        default:
+        {
+            break;
+        }
+    };
+}
+
+void emit_phi_moves(function_compiler* compiler, u32 predecessor, u32 block_index)
+{
+    const ssa_function* function = compiler->function;
+    const ssa_block* block = &function->blocks[block_index];
+
+    u32 operand = 0;
+    while (operand < block->predecessor_count && block->predecessors[operand] != predecessor)
+        operand++;
+
+    token t = function->blocks[predecessor].t;
+    for (u32 i = 0; i < block->phi_count && operand < block->predecessor_count; ++i)
+    {
+        u32 destination = compiler->registers[block->phis[i]];
+        if (destination != NO_REGISTER)
+            add_move(compiler, destination, compiler->registers[ssa_operands(function, block->phis[i])[operand]], t);
+    }
+
+    emit_moves(compiler, t);
+}
+
+void add_move(function_compiler* compiler, u32 destination, u32 source, token t)
+{
+    if (destination == source)
+        return;
+
+    if (compiler->move_count >= compiler->move_capacity)
+    {
+        u32 new_capacity = compiler->move_capacity ? compiler->move_capacity * DEFAULT_BYTECODE_RESIZE_FACTOR : DEFAULT_BYTECODE_POOL_CAPACITY;
+        register_move* new_moves = realloc(compiler->moves, new_capacity * sizeof(register_move));
+        if (new_moves == NULL)
+        {
+            compile_error(compiler, t, DIAGNOSTIC_BYTECODE_ALLOCATION);
+            return;
+        }
+
+        compiler->moves = new_moves;
+        compiler->move_capacity = new_capacity;
+    }
+
+    compiler->moves[compiler->move_count++] = (register_move){ destination, source };
+}
+
+void emit_moves(function_compiler* compiler, token t)
+{
+    register_move* moves = compiler->moves;
+    while (compiler->move_count > 0 && !compiler->has_error)
+    {
+        // A move is emitted once no other move still has to read the register it writes
+        b8 is_blocked = true;
+        for (u32 i = 0; i < compiler->move_count; ++i)
+        {
+            b8 is_read = false;
+            for (u32 j = 0; j < compiler->move_count && !is_read; ++j)
+                is_read = j != i && moves[j].source == moves[i].destination;
+
+            if (is_read)
+                continue;
+
+            emit(compiler, (bytecode_instruction){ .opcode = OPCODE_MOVE, .a = moves[i].destination, .b = moves[i].source }, t);
+            moves[i] = moves[--compiler->move_count];
+            is_blocked = false;
+            break;
+        }
+
+        if (!is_blocked)
+            continue;
+
+        // Only cycles are left, one of their registers is saved in the scratch register, which frees it to be written
+        u32 saved = moves[0].destination;
+        emit(compiler, (bytecode_instruction){ .opcode = OPCODE_MOVE, .a = compiler->scratch, .b = saved }, t);
+        for (u32 i = 0; i < compiler->move_count; ++i)
+        {
+            if (moves[i].source == saved)
+                moves[i].source = compiler->scratch;
+        }
+    }
+
+    compiler->move_count = 0;
+}
+
+void emit_jump(function_compiler* compiler, bytecode_opcode opcode, u32 condition, u32 block_index, token t)
+{
+    if (compiler->jump_count >= compiler->jump_capacity)
+    {
+        u64 new_capacity = compiler->jump_capacity ? compiler->jump_capacity * DEFAULT_BYTECODE_RESIZE_FACTOR : DEFAULT_BYTECODE_POOL_CAPACITY;
+        pending_jump* new_jumps = realloc(compiler->jumps, new_capacity * sizeof(pending_jump));
+        if (new_jumps == NULL)
+        {
+            compile_error(compiler, t, DIAGNOSTIC_BYTECODE_ALLOCATION);
+            return;
+        }
+
+        compiler->jumps = new_jumps;
+        compiler->jump_capacity = new_capacity;
+    }
+
+    u64 index = emit(compiler, (bytecode_instruction){ .opcode = opcode, .a = condition }, t);
+    compiler->jumps[compiler->jump_count++] = (pending_jump){ index, block_index };
+}
+
+void emit_constant(function_compiler* compiler, bytecode_value value, type_info type, u32 destination, token t)
+{
+    u32 index = add_constant(compiler, value, type, t);
+    emit(compiler, (bytecode_instruction){ .opcode = OPCODE_LOAD_CONSTANT, .a = destination, .index = index }, t);
+}
+
+b8 is_emitted(function_compiler* compiler, u32 instruction)
+{
+    const ssa_instruction* operation = &compiler->function->instructions[instruction];
+    switch (operation->opcode)
+    {
+        case SSA_OPCODE_STORE_GLOBAL:
+        case SSA_OPCODE_CALL:
+        {
+            return true;
+        }
+        case SSA_OPCODE_DIVIDE:
+        case SSA_OPCODE_MODULUS:
+        {
+            // An integer division by zero has to fail even when its result is never read
+            return operation->type == TYPE_INFO_INTEGER || use_count(compiler, instruction) > 0;
+        }
+        default:
+        {
+            return use_count(compiler, instruction) > 0;
+        }
+    };
+}
+
+u32 use_count(function_compiler* compiler, u32 value)
+{
+    return compiler->use_offsets[value + 1] - compiler->use_offsets[value];
+}
+
+bytecode_opcode arithmetic_opcode(ssa_opcode opcode, type_info operand_type)
+{
+    b8 is_integer = operand_type == TYPE_INFO_INTEGER;
+    switch (opcode)
+    {
+        case SSA_OPCODE_ADD:
+        {
+            return is_integer ? OPCODE_ADD_I64 : OPCODE_ADD_F64;
+        }
+        case SSA_OPCODE_SUBTRACT:
+        {
+            return is_integer ? OPCODE_SUBTRACT_I64 : OPCODE_SUBTRACT_F64;
+        }
+        case SSA_OPCODE_MULTIPLY:
+        {
+            return is_integer ? OPCODE_MULTIPLY_I64 : OPCODE_MULTIPLY_F64;
+        }
+        case SSA_OPCODE_DIVIDE:
+        {
+            return is_integer ? OPCODE_DIVIDE_I64 : OPCODE_DIVIDE_F64;
+        }
+        case SSA_OPCODE_MODULUS:
+        {
+            return is_integer ? OPCODE_MODULUS_I64 : OPCODE_MODULUS_F64;
+        }
+        case SSA_OPCODE_GREATER_THAN:
+        {
+            return is_integer ? OPCODE_GREATER_THAN_I64 : OPCODE_GREATER_THAN_F64;
+        }
+        case SSA_OPCODE_LESS_THAN:
+        {
+            return is_integer ? OPCODE_LESS_THAN_I64 : OPCODE_LESS_THAN_F64;
+        }
+        default:
+        {
+            return OPCODE_INVALID;
+        }
+    };
+}
+
+bytecode_opcode conditional_jump_opcode(type_info condition_type, b8 jump_if_true)
+{
+    switch (condition_type)
+    {
+        case TYPE_INFO_FLOAT:
+        {
+            return jump_if_true ? OPCODE_JUMP_IF_TRUE_F64 : OPCODE_JUMP_IF_FALSE_F64;
+        }
+        case TYPE_INFO_STRING:
+        {
+            return jump_if_true ? OPCODE_JUMP_IF_TRUE_STRING : OPCODE_JUMP_IF_FALSE_STRING;
+        }
+        default:
+        {
+            // Integers, and functions which are tested the same way
+            return jump_if_true ? OPCODE_JUMP_IF_TRUE_I64 : OPCODE_JUMP_IF_FALSE_I64;
+        }
+    };
+}
+
+u64 emit(function_compiler* compiler, bytecode_instruction instruction, token t)
+{
+    if (compiler->has_error)
+        return 0;
+
+    bytecode_function* function = &compiler->program->functions[compiler->function_index];
+    if (function->code_length >= function->code_capacity)
+    {
+        u64 new_capacity = function->code_capacity ? function->code_capacity * DEFAULT_BYTECODE_RESIZE_FACTOR : DEFAULT_BYTECODE_CODE_CAPACITY;
+        bytecode_instruction* new_code = malloc(new_capacity * sizeof(bytecode_instruction));
+        token* new_tokens = malloc(new_capacity * sizeof(token));
+        if (new_code == NULL || new_tokens == NULL)
+        {
+            free(new_code);
+            free(new_tokens);
+            compile_error(compiler, t, DIAGNOSTIC_BYTECODE_ALLOCATION);
+            return 0;
+        }
+
+        if (function->code)
+        {
+            memcpy_s(new_code, new_capacity * sizeof(bytecode_instruction), function->code, function->code_length * sizeof(bytecode_instruction));
+            memcpy_s(new_tokens, new_capacity * sizeof(token), function->instruction_tokens, function->code_length * sizeof(token));
+        }
+
+        free(function->code);
+        free(function->instruction_tokens);
+        function->code = new_code;
+        function->instruction_tokens = new_tokens;
+        function->code_capacity = new_capacity;
+    }
+
+    function->code[function->code_length] = instruction;
+    function->instruction_tokens[function->code_length] = t;
+
+    return function->code_length++;
+}
+
+u32 add_constant(function_compiler* compiler, bytecode_value value, type_info type, token t)
+{
+    bytecode_program* program = compiler->program;
+    if (program->constant_count >= program->constant_capacity)
+    {
+        u64 new_capacity = program->constant_capacity ? program->constant_capacity * DEFAULT_BYTECODE_RESIZE_FACTOR : DEFAULT_BYTECODE_POOL_CAPACITY;
+        bytecode_value* new_constants = malloc(new_capacity * sizeof(bytecode_value));
+        type_info* new_types = malloc(new_capacity * sizeof(type_info));
+        if (new_constants == NULL || new_types == NULL)
+        {
+            free(new_constants);
+            free(new_types);
+            compile_error(compiler, t, DIAGNOSTIC_BYTECODE_ALLOCATION);
+            return 0;
+        }
+
+        if (program->constants)
+        {
+            memcpy_s(new_constants, new_capacity * sizeof(bytecode_value), program->constants, program->constant_count * sizeof(bytecode_value));
+            memcpy_s(new_types, new_capacity * sizeof(type_info), program->constant_types, program->constant_count * sizeof(type_info));
+        }
+
+        free(program->constants);
+        free(program->constant_types);
+        program->constants = new_constants;
+        program->constant_types = new_types;
+        program->constant_capacity = new_capacity;
+    }
+
+    program->constant_types[program->constant_count] = type;
+    program->constants[program->constant_count] = value;
+    return (u32)program->constant_count++;
+}
+
+void compile_error(function_compiler* compiler, token t, diagnostic_id id, ...)
+{
+    if (compiler->has_error)
+        return;
+
+    va_list params;
+    va_start(params, id);
+    error_report report = error_report_create(t, id, params);
+    va_end(params);
+
+    context_report_error(compiler->context, report);
+    compiler->has_error = true;
+}
@@ -0,0 +1,384 @@
+#include "bytecode/bytecode_optimizer.h"
+
+#include <malloc.h>
+#include <stdint.h>
+#include <string.h>
+
+// The compare and jump superinstruction a comparison followed by a conditional jump testing it is fused into
+static const struct {
+    bytecode_opcode comparison;
+    bytecode_opcode jump;
+    bytecode_opcode fused;
+} fused_jumps[] = {
+    { OPCODE_LESS_THAN_I64,     OPCODE_JUMP_IF_TRUE_I64,    OPCODE_JUMP_IF_LESS_I64 },
+    { OPCODE_LESS_THAN_F64,     OPCODE_JUMP_IF_TRUE_F64,    OPCODE_JUMP_IF_LESS_F64 },
+    { OPCODE_LESS_THAN_I64,     OPCODE_JUMP_IF_FALSE_I64,   OPCODE_JUMP_IF_NOT_LESS_I64 },
+    { OPCODE_LESS_THAN_F64,     OPCODE_JUMP_IF_FALSE_F64,   OPCODE_JUMP_IF_NOT_LESS_F64 },
+    { OPCODE_GREATER_THAN_I64,  OPCODE_JUMP_IF_TRUE_I64,    OPCODE_JUMP_IF_GREATER_I64 },
+    { OPCODE_GREATER_THAN_F64,  OPCODE_JUMP_IF_TRUE_F64,    OPCODE_JUMP_IF_GREATER_F64 },
+    { OPCODE_GREATER_THAN_I64,  OPCODE_JUMP_IF_FALSE_I64,   OPCODE_JUMP_IF_NOT_GREATER_I64 },
+    { OPCODE_GREATER_THAN_F64,  OPCODE_JUMP_IF_FALSE_F64,   OPCODE_JUMP_IF_NOT_GREATER_F64 },
+};
+
+/**
+ * @brief The state of optimizing a single function, the arrays are shared by every function of the program
+ */
+typedef struct peephole_optimizer {
+    /* The program being optimized */
+    const bytecode_program* program;
+    /* The function being optimized */
+    bytecode_function* function;
+    /* The registers below it hold globals, which are read once the program ran and by the functions it calls. It is 0
+       for every function but the top level code */
+    u64 global_register_count;
+
+    /* Set for every instruction a jump can continue at */
+    b8* is_jump_target;
+    /* Set for every instruction the pass removed, they are only taken out of the code once the pass is done */
+    b8* is_removed;
+    /* The index each instruction has once the removed ones are taken out */
+    u64* new_indices;
+
+    /* The search each instruction was last visited by, so nothing is cleared between searches */
+    u64* visited;
+    /* The search being run by is_register_dead() */
+    u64 search;
+    /* The instructions the search still has to visit */
+    u64* stack;
+    /* The amount of instructions on the stack */
+    u64 stack_size;
+} peephole_optimizer;
+
+// Optimizes the function at index in the program
+static void optimize_function(peephole_optimizer* optimizer, u64 function_index);
+
+// Fuses the instruction at index with the next instruction which is still there, true if they were
+static b8 fuse_instructions(peephole_optimizer* optimizer, u64 index);
+
+// Fuses a comparison and the conditional jump testing it into a compare and jump superinstruction
+static b8 fuse_comparison(peephole_optimizer* optimizer, u64 index, u64 next);
+
+// Fuses a constant load and the integer addition, subtraction or multiplication using it into an _IMMEDIATE superinstruction
+static b8 fuse_immediate(peephole_optimizer* optimizer, u64 index, u64 next);
+
+// Removes a move out of the register the instruction before it wrote, by writing the move's register instead
+static b8 fuse_move(peephole_optimizer* optimizer, u64 index, u64 next);
+
+// Takes the removed instructions out of the code, and points every jump at where its target went
+static void remove_instructions(peephole_optimizer* optimizer);
+
+// True if no path from the instruction at index reads the register before writing it
+static b8 is_register_dead(peephole_optimizer* optimizer, u64 index, u16 reg);
+
+// Pushes an instruction onto the stack of the search, unless the search already visited it
+static void visit_instruction(peephole_optimizer* optimizer, u64 index);
+
+// True if the instruction reads the register
+static b8 reads_register(bytecode_instruction instruction, u16 reg);
+
+// Gives the index of the instruction a jump at index continues at
+static u64 jump_target(const bytecode_instruction* code, u64 index);
+
+
+b8 bytecode_optimize(bytecode_program* program)
+{
+    u64 longest_function = 0;
+    for (u64 i = 0; i < program->function_count; ++i)
+    {
+        if (program->functions[i].code_length > longest_function)
+            longest_function = program->functions[i].code_length;
+    }
+
+    // Every array gets one more element, the index past the last instruction is the end of the function
+    u64 length = longest_function + 1;
+    peephole_optimizer optimizer = {};
+    optimizer.program = program;
+    optimizer.is_jump_target = malloc(length * sizeof(b8));
+    optimizer.is_removed = malloc(length * sizeof(b8));
+    optimizer.new_indices = malloc(length * sizeof(u64));
+    optimizer.visited = calloc(length, sizeof(u64));
+    optimizer.stack = malloc(length * sizeof(u64));
+
+    b8 allocated = optimizer.is_jump_target != NULL && optimizer.is_removed != NULL && optimizer.new_indices != NULL &&
+                   optimizer.visited != NULL && optimizer.stack != NULL;
+
+    for (u64 i = 0; i < program->function_count && allocated; ++i)
+        optimize_function(&optimizer, i);
+
+    free(optimizer.is_jump_target);
+    free(optimizer.is_removed);
+    free(optimizer.new_indices);
+    free(optimizer.visited);
+    free(optimizer.stack);
+
+    return allocated;
+}
+
+
+
+void optimize_function(peephole_optimizer* optimizer, u64 function_index)
+{
+    bytecode_function* function = &optimizer->program->functions[function_index];
+    optimizer->function = function;
+    optimizer->global_register_count = (function_index == 0) ? optimizer->program->global_count : 0;
+
+    memset(optimizer->is_jump_target, 0, (function->code_length + 1) * sizeof(b8));
+    memset(optimizer->is_removed, 0, (function->code_length + 1) * sizeof(b8));
+
+    for (u64 i = 0; i < function->code_length; ++i)
+    {
+        bytecode_instruction instruction = function->code[i];
+        if (bytecode_opcode_operands(instruction.opcode) & (BYTECODE_OPERAND_JUMPS | BYTECODE_OPERAND_JUMPS_SHORT))
+            optimizer->is_jump_target[jump_target(function->code, i)] = true;
+
+        // A move into the register it reads, and a jump to the next instruction, do nothing
+        if ((instruction.opcode == OPCODE_MOVE && instruction.a == instruction.b) ||
+            (instruction.opcode == OPCODE_JUMP && instruction.offset == 0))
+        {
+            optimizer->is_removed[i] = true;
+        }
+    }
+
+    for (u64 i = 0; i < function->code_length; ++i)
+    {
+        // An instruction fused with the next one can often be fused with the one after it as well
+        while (!optimizer->is_removed[i] && fuse_instructions(optimizer, i))
+            continue;
+    }
+
+    remove_instructions(optimizer);
+}
+
+b8 fuse_instructions(peephole_optimizer* optimizer, u64 index)
+{
+    u64 next = index + 1;
+    while (next < optimizer->function->code_length && optimizer->is_removed[next])
+        next++;
+
+    if (next >= optimizer->function->code_length)
+        return false;
+
+    // A jump to the next instruction, or to one removed before it, would skip the instruction fused into it
+    for (u64 i = index + 1; i <= next; ++i)
+    {
+        if (optimizer->is_jump_target[i])
+            return false;
+    }
+
+    return fuse_comparison(optimizer, index, next) || fuse_immediate(optimizer, index, next) || fuse_move(optimizer, index, next);
+}
+
+b8 fuse_comparison(peephole_optimizer* optimizer, u64 index, u64 next)
+{
+    bytecode_instruction* comparison = &optimizer->function->code[index];
+    bytecode_instruction jump = optimizer->function->code[next];
+    if (jump.a != comparison->a)
+        return false;
+
+    bytecode_opcode fused = OPCODE_INVALID;
+    for (u64 i = 0; i < sizeof(fused_jumps) / sizeof(fused_jumps[0]); ++i)
+    {
+        if (fused_jumps[i].comparison == comparison->opcode && fused_jumps[i].jump == jump.opcode)
+            fused = fused_jumps[i].fused;
+    }
+
+    // The offset of the fused jump has to fit in 16 bits, it is counted from the instruction after the comparison
+    i64 target = (i64)jump_target(optimizer->function->code, next);
+    i64 short_offset = target - (i64)(index + 1);
+    if (fused == OPCODE_INVALID || short_offset < INT16_MIN || short_offset > INT16_MAX)
+        return false;
+
+    // Nothing is left to write the result of the comparison, it must not be read again
+    if (!is_register_dead(optimizer, next + 1, comparison->a) || !is_register_dead(optimizer, (u64)target, comparison->a))
+        return false;
+
+    *comparison = (bytecode_instruction){ .opcode = fused, .a = comparison->b, .b = comparison->c, .short_offset = (i16)short_offset };
+    optimizer->is_removed[next] = true;
+    return true;
+}
+
+b8 fuse_immediate(peephole_optimizer* optimizer, u64 index, u64 next)
+{
+    bytecode_instruction load = optimizer->function->code[index];
+    bytecode_instruction* operation = &optimizer->function->code[next];
+    if (load.opcode != OPCODE_LOAD_CONSTANT || operation->b == operation->c)
+        return false;
+
+    // The operation being an integer one is what makes the constant an integer
+    i64 constant = optimizer->program->constants[load.index].integer;
+    u16 other_operand = 0;
+    bytecode_opcode fused = OPCODE_INVALID;
+    switch (operation->opcode)
+    {
+        case OPCODE_ADD_I64:
+        case OPCODE_MULTIPLY_I64:
+        {
+            // Both are commutative, the constant can be either operand
+            if (operation->b != load.a && operation->c != load.a)
+                return false;
+
+            other_operand = (operation->b == load.a) ? operation->c : operation->b;
+            fused = (operation->opcode == OPCODE_ADD_I64) ? OPCODE_ADD_I64_IMMEDIATE : OPCODE_MULTIPLY_I64_IMMEDIATE;
+            break;
+        }
+        case OPCODE_SUBTRACT_I64:
+        {
+            // Subtracting the constant is adding its negation, the smallest integer has none
+            if (operation->c != load.a || constant == INT64_MIN)
+                return false;
+
+            other_operand = operation->b;
+            constant = -constant;
+            fused = OPCODE_ADD_I64_IMMEDIATE;
+            break;
+        }
+        default:
+        {
+            return false;
+        }
+    };
+
+    if (constant < INT16_MIN || constant > INT16_MAX)
+        return false;
+
+    // The constant is no longer loaded into its register, which is fine if the operation overwrites it or nothing reads it
+    if (operation->a != load.a && !is_register_dead(optimizer, next + 1, load.a))
+        return false;
+
+    optimizer->function->code[index] = (bytecode_instruction){ .opcode = fused, .a = operation->a, .b = other_operand, .immediate = (i16)constant };
+    optimizer->function->instruction_tokens[index] = optimizer->function->instruction_tokens[next];
+    optimizer->is_removed[next] = true;
+    return true;
+}
+
+b8 fuse_move(peephole_optimizer* optimizer, u64 index, u64 next)
+{
+    bytecode_instruction* instruction = &optimizer->function->code[index];
+    bytecode_instruction move = optimizer->function->code[next];
+
+    // A call writes its result when the callee returns, so only the instructions writing right away are moved
+    u8 operands = bytecode_opcode_operands(instruction->opcode);
+    if (move.opcode != OPCODE_MOVE || move.b != instruction->a || !(operands & BYTECODE_OPERAND_WRITES_A) || instruction->opcode == OPCODE_CALL)
+        return false;
+
+    if (!is_register_dead(optimizer, next + 1, move.b))
+        return false;
+
+    instruction->a = move.a;
+    optimizer->is_removed[next] = true;
+    return true;
+}
+
+void remove_instructions(peephole_optimizer* optimizer)
+{
+    bytecode_function* function = optimizer->function;
+
+    // A jump to a removed instruction continues at the next instruction which is still there
+    u64 kept = 0;
+    for (u64 i = 0; i < function->code_length; ++i)
+    {
+        optimizer->new_indices[i] = kept;
+        if (!optimizer->is_removed[i])
+            kept++;
+    }
+
+    optimizer->new_indices[function->code_length] = kept;
+
+    for (u64 i = 0; i < function->code_length; ++i)
+    {
+        if (optimizer->is_removed[i])
+            continue;
+
+        // Removing instructions only brings a jump closer to its target, so every offset still fits
+        bytecode_instruction instruction = function->code[i];
+        u8 operands = bytecode_opcode_operands(instruction.opcode);
+        if (operands & (BYTECODE_OPERAND_JUMPS | BYTECODE_OPERAND_JUMPS_SHORT))
+        {
+            i64 offset = (i64)optimizer->new_indices[jump_target(function->code, i)] - (i64)(optimizer->new_indices[i] + 1);
+            if (operands & BYTECODE_OPERAND_JUMPS)
+                instruction.offset = (i32)offset;
+            else
+                instruction.short_offset = (i16)offset;
+        }
+
+        // The instructions only move towards the start of the code, past the ones already read
+        function->code[optimizer->new_indices[i]] = instruction;
+        function->instruction_tokens[optimizer->new_indices[i]] = function->instruction_tokens[i];
+    }
+
+    function->code_length = kept;
+}
+
+b8 is_register_dead(peephole_optimizer* optimizer, u64 index, u16 reg)
+{
+    if (reg < optimizer->global_register_count)
+        return false;
+
+    optimizer->search++;
+    optimizer->stack_size = 0;
+    visit_instruction(optimizer, index);
+
+    while (optimizer->stack_size > 0)
+    {
+        u64 i = optimizer->stack[--optimizer->stack_size];
+
+        // A removed instruction does nothing
+        if (optimizer->is_removed[i])
+        {
+            visit_instruction(optimizer, i + 1);
+            continue;
+        }
+
+        bytecode_instruction instruction = optimizer->function->code[i];
+        u8 operands = bytecode_opcode_operands(instruction.opcode);
+        if (reads_register(instruction, reg))
+            return false;
+
+        // Once the register is written, whatever it held before is never read on this path
+        if ((operands & BYTECODE_OPERAND_WRITES_A) && instruction.a == reg)
+            continue;
+
+        if (operands & (BYTECODE_OPERAND_JUMPS | BYTECODE_OPERAND_JUMPS_SHORT))
+            visit_instruction(optimizer, jump_target(optimizer->function->code, i));
+
+        if (!(operands & BYTECODE_OPERAND_NO_FALL_THROUGH))
+            visit_instruction(optimizer, i + 1);
+    }
+
+    return true;
+}
+
+void visit_instruction(peephole_optimizer* optimizer, u64 index)
+{
+    // Every function ends with a return, the end of the code is never reached
+    if (index >= optimizer->function->code_length || optimizer->visited[index] == optimizer->search)
+        return;
+
+    optimizer->visited[index] = optimizer->search;
+    optimizer->stack[optimizer->stack_size++] = index;
+}
+
+b8 reads_register(bytecode_instruction instruction, u16 reg)
+{
+    u8 operands = bytecode_opcode_operands(instruction.opcode);
+    if ((operands & BYTECODE_OPERAND_READS_A) && instruction.a == reg)
+        return true;
+
+    if ((operands & BYTECODE_OPERAND_READS_B) && instruction.b == reg)
+        return true;
+
+    if ((operands & BYTECODE_OPERAND_READS_C) && instruction.c == reg)
+        return true;
+
+    // A call reads its arguments, and the callee's registers start at them. Which of those registers the
+    // callee reads is not known here, so they all count as read
+    return instruction.opcode == OPCODE_CALL && reg >= instruction.c;
+}
+
+u64 jump_target(const bytecode_instruction* code, u64 index)
+{
+    if (bytecode_opcode_operands(code[index].opcode) & BYTECODE_OPERAND_JUMPS_SHORT)
+        return (u64)((i64)index + 1 + code[index].short_offset);
+
+    return (u64)((i64)index + 1 + code[index].offset);
+}
@@ -0,0 +1,471 @@
+#include "bytecode/jit.h"
+#include "bytecode/x86_encoder.h"
+#include "utilities/executable_memory.h"
+
+#include <malloc.h>
+#include <string.h>
+
+#ifdef ROULX_JIT_X86_64
+
+// The bytes of the entry code at the start of every function's native code
+#define JIT_ENTRY_BYTES 16
+// The most bytes the native code of a single instruction takes
+#define JIT_MAX_INSTRUCTION_BYTES 64
+
+// The native code keeps the registers of the call in r10 and the globals in r11, and only uses rax, rcx, rdx, xmm0 and
+// xmm1 besides them. All of those are volatile in both calling conventions
+
+/**
+ * @brief The state of writing the native code of a single function
+ */
+typedef struct jit_emitter {
+    /* The native code, written in place in the executable memory */
+    u8* code;
+    /* The amount of bytes written */
+    u64 length;
+
+    /* The jumps to patch, a single instruction needs at most two */
+    x86_patch* patches;
+    /* The amount of patches */
+    u64 patch_count;
+} jit_emitter;
+
+// The entry code of every function's native code, called by jit_run() with the registers, the globals and the address to
+// start at. It moves the registers into r10 and the globals into r11, the only state the native code keeps, and jumps
+typedef u64 (*jit_entry_fptr)(bytecode_value* registers, bytecode_value* globals, const u8* start);
+
+// Compiles a function to native code, true if it was compiled
+static b8 compile_function(rouleaux_jit* jit, u64 function_index);
+
+// Emits the native code of the instruction at index
+static void emit_instruction(jit_emitter* emitter, const bytecode_program* program, bytecode_instruction instruction, u64 index);
+
+// Emits the entry code, for the calling convention of the platform
+static void emit_entry(jit_emitter* emitter);
+
+// Emits a return to the interpreter, which continues at the instruction at index
+static void emit_exit(jit_emitter* emitter, u64 index);
+
+// Emits a jump (or a jcc for a condition code) to the instruction at target
+static void emit_jump(jit_emitter* emitter, u8 condition, u64 target);
+
+// Emits an instruction with a register of the vm as its memory operand, addressed from base
+static void emit_vm_operand(jit_emitter* emitter, u8 prefix, u8 rex, u16 opcode, u8 x86_register, u8 base, u64 vm_register);
+
+// Emits a comparison's 0 or 1 from the flags, into the vm register as an integer or a float
+static void emit_comparison_result(jit_emitter* emitter, u8 condition, b8 is_float, u64 vm_register);
+
+// Emits raw bytes
+static void emit_bytes(jit_emitter* emitter, const u8* bytes, u64 count);
+
+// Emits a little endian 32 bit value
+static void emit_u32(jit_emitter* emitter, u32 value);
+
+
+b8 jit_create(rouleaux_jit* out_jit, const bytecode_program* program)
+{
+    memset(out_jit, 0, sizeof(rouleaux_jit));
+
+    out_jit->functions = calloc(program->function_count ? program->function_count : 1, sizeof(jit_function));
+    if (out_jit->functions == NULL)
+        return false;
+
+    out_jit->program = program;
+    out_jit->call_threshold = DEFAULT_JIT_CALL_THRESHOLD;
+    out_jit->back_edge_threshold = DEFAULT_JIT_BACK_EDGE_THRESHOLD;
+    return true;
+}
+
+void jit_destroy(rouleaux_jit* jit)
+{
+    for (u64 i = 0; jit->functions != NULL && i < jit->program->function_count; ++i)
+    {
+        executable_memory_free(jit->functions[i].code, jit->functions[i].code_size);
+        free(jit->functions[i].instruction_offsets);
+    }
+
+    free(jit->functions);
+    memset(jit, 0, sizeof(rouleaux_jit));
+}
+
+b8 jit_count(rouleaux_jit* jit, u64 function_index, b8 is_call)
+{
+    jit_function* compiled = &jit->functions[function_index];
+    if (compiled->code != NULL)
+        return true;
+
+    if (compiled->failed)
+        return false;
+
+    u32 count = is_call ? ++compiled->call_count : ++compiled->back_edge_count;
+    u32 threshold = is_call ? jit->call_threshold : jit->back_edge_threshold;
+    if (count < threshold)
+        return false;
+
+    return compile_function(jit, function_index);
+}
+
+u64 jit_run(rouleaux_jit* jit, u64 function_index, u64 instruction_index, bytecode_value* registers, bytecode_value* globals)
+{
+    jit_function* compiled = &jit->functions[function_index];
+
+    // Casting the code to a function pointer is not standard C, but it is what every platform with a jit does
+    jit_entry_fptr entry = (jit_entry_fptr)(void*)compiled->code;
+    return entry(registers, globals, compiled->code + compiled->instruction_offsets[instruction_index]);
+}
+
+
+
+b8 compile_function(rouleaux_jit* jit, u64 function_index)
+{
+    const bytecode_function* function = &jit->program->functions[function_index];
+    jit_function* compiled = &jit->functions[function_index];
+
+    u64 code_size = JIT_ENTRY_BYTES + function->code_length * JIT_MAX_INSTRUCTION_BYTES;
+    jit_emitter emitter = {};
+    emitter.code = executable_memory_allocate(code_size);
+    emitter.patches = malloc((function->code_length * 2 + 1) * sizeof(x86_patch));
+    compiled->instruction_offsets = malloc((function->code_length + 1) * sizeof(u32));
+
+    if (emitter.code == NULL || emitter.patches == NULL || compiled->instruction_offsets == NULL)
+    {
+        // The function stays interpreted
+        executable_memory_free(emitter.code, code_size);
+        free(emitter.patches);
+        free(compiled->instruction_offsets);
+        compiled->instruction_offsets = NULL;
+        compiled->failed = true;
+        return false;
+    }
+
+    emit_entry(&emitter);
+    for (u64 i = 0; i < function->code_length; ++i)
+    {
+        compiled->instruction_offsets[i] = (u32)emitter.length;
+        emit_instruction(&emitter, jit->program, function->code[i], i);
+    }
+
+    for (u64 i = 0; i < emitter.patch_count; ++i)
+    {
+        x86_patch patch = emitter.patches[i];
+        x86_write_u32(emitter.code + patch.position, (u32)x86_relative_offset(patch.position, compiled->instruction_offsets[patch.target]));
+    }
+
+    free(emitter.patches);
+
+    if (!executable_memory_seal(emitter.code, code_size))
+    {
+        executable_memory_free(emitter.code, code_size);
+        free(compiled->instruction_offsets);
+        compiled->instruction_offsets = NULL;
+        compiled->failed = true;
+        return false;
+    }
+
+    compiled->code = emitter.code;
+    compiled->code_size = code_size;
+    return true;
+}
+
+void emit_instruction(jit_emitter* emitter, const bytecode_program* program, bytecode_instruction instruction, u64 index)
+{
+    u64 target = index + 1 + instruction.offset;
+    u64 short_target = index + 1 + instruction.short_offset;
+
+    switch (instruction.opcode)
+    {
+        case OPCODE_LOAD_CONSTANT:
+        {
+            // mov rax, imm64
+            const u8 mov_rax[] = { 0x48, 0xB8 };
+            emit_bytes(emitter, mov_rax, sizeof(mov_rax));
+            emit_u32(emitter, (u32)program->constants[instruction.index].bits);
+            emit_u32(emitter, (u32)(program->constants[instruction.index].bits >> 32));
+            emit_vm_operand(emitter, 0, X86_REX_W, X86_MOV_STORE, X86_RAX, X86_R10, instruction.a);
+            break;
+        }
+        case OPCODE_MOVE:
+        {
+            emit_vm_operand(emitter, 0, X86_REX_W, X86_MOV_LOAD, X86_RAX, X86_R10, instruction.b);
+            emit_vm_operand(emitter, 0, X86_REX_W, X86_MOV_STORE, X86_RAX, X86_R10, instruction.a);
+            break;
+        }
+        case OPCODE_GET_GLOBAL:
+        {
+            emit_vm_operand(emitter, 0, X86_REX_W, X86_MOV_LOAD, X86_RAX, X86_R11, instruction.index);
+            emit_vm_operand(emitter, 0, X86_REX_W, X86_MOV_STORE, X86_RAX, X86_R10, instruction.a);
+            break;
+        }
+        case OPCODE_SET_GLOBAL:
+        {
+            emit_vm_operand(emitter, 0, X86_REX_W, X86_MOV_LOAD, X86_RAX, X86_R10, instruction.a);
+            emit_vm_operand(emitter, 0, X86_REX_W, X86_MOV_STORE, X86_RAX, X86_R11, instruction.index);
+            break;
+        }
+        case OPCODE_ADD_I64:
+        case OPCODE_SUBTRACT_I64:
+        case OPCODE_MULTIPLY_I64:
+        {
+            // The two's complement results are the wrapping ones the interpreter gives
+            u16 opcode = (instruction.opcode == OPCODE_ADD_I64) ? X86_ADD_LOAD : (instruction.opcode == OPCODE_SUBTRACT_I64) ? X86_SUB_LOAD : X86_IMUL_LOAD;
+            emit_vm_operand(emitter, 0, X86_REX_W, X86_MOV_LOAD, X86_RAX, X86_R10, instruction.b);
+            emit_vm_operand(emitter, 0, X86_REX_W, opcode, X86_RAX, X86_R10, instruction.c);
+            emit_vm_operand(emitter, 0, X86_REX_W, X86_MOV_STORE, X86_RAX, X86_R10, instruction.a);
+            break;
+        }
+        case OPCODE_ADD_F64:
+        case OPCODE_SUBTRACT_F64:
+        case OPCODE_MULTIPLY_F64:
+        case OPCODE_DIVIDE_F64:
+        {
+            u16 opcode = X86_DIVSD_LOAD;
+            if (instruction.opcode == OPCODE_ADD_F64)
+                opcode = X86_ADDSD_LOAD;
+            else if (instruction.opcode == OPCODE_SUBTRACT_F64)
+                opcode = X86_SUBSD_LOAD;
+            else if (instruction.opcode == OPCODE_MULTIPLY_F64)
+                opcode = X86_MULSD_LOAD;
+
+            emit_vm_operand(emitter, 0xF2, 0, X86_MOVSD_LOAD, X86_XMM0, X86_R10, instruction.b);
+            emit_vm_operand(emitter, 0xF2, 0, opcode, X86_XMM0, X86_R10, instruction.c);
+            emit_vm_operand(emitter, 0xF2, 0, X86_MOVSD_STORE, X86_XMM0, X86_R10, instruction.a);
+            break;
+        }
+        case OPCODE_DIVIDE_I64:
+        case OPCODE_MODULUS_I64:
+        {
+            // Dividing by 0 is reported and dividing by -1 can overflow, the interpreter runs both
+            emit_vm_operand(emitter, 0, X86_REX_W, X86_MOV_LOAD, X86_RCX, X86_R10, instruction.c);
+
+            // lea rax, [rcx + 1]; cmp rax, 1; ja over the exit
+            const u8 check_divisor[] = { 0x48, 0x8D, 0x41, 0x01, 0x48, 0x83, 0xF8, 0x01, 0x77, 0x06 };
+            emit_bytes(emitter, check_divisor, sizeof(check_divisor));
+            emit_exit(emitter, index);
+
+            // cqo; idiv rcx, the quotient is left in rax and the remainder in rdx
+            const u8 divide[] = { 0x48, 0x99, 0x48, 0xF7, 0xF9 };
+            emit_vm_operand(emitter, 0, X86_REX_W, X86_MOV_LOAD, X86_RAX, X86_R10, instruction.b);
+            emit_bytes(emitter, divide, sizeof(divide));
+
+            u8 result = (instruction.opcode == OPCODE_DIVIDE_I64) ? X86_RAX : X86_RDX;
+            emit_vm_operand(emitter, 0, X86_REX_W, X86_MOV_STORE, result, X86_R10, instruction.a);
+            break;
+        }
+        case OPCODE_GREATER_THAN_I64:
+        case OPCODE_LESS_THAN_I64:
+        {
+            emit_vm_operand(emitter, 0, X86_REX_W, X86_MOV_LOAD, X86_RAX, X86_R10, instruction.b);
+            emit_vm_operand(emitter, 0, X86_REX_W, X86_CMP_LOAD, X86_RAX, X86_R10, instruction.c);
+
+            u8 condition = (instruction.opcode == OPCODE_GREATER_THAN_I64) ? X86_CONDITION_GREATER : X86_CONDITION_LESS;
+            emit_comparison_result(emitter, condition, false, instruction.a);
+            break;
+        }
+        case OPCODE_GREATER_THAN_F64:
+        case OPCODE_LESS_THAN_F64:
+        {
+            // ucomisd sets the flags of 'above' for neither operand being a NaN and the first being larger, so
+            // b < c is tested as c > b. A comparison with a NaN never holds, like in the interpreter
+            b8 is_greater = instruction.opcode == OPCODE_GREATER_THAN_F64;
+            emit_vm_operand(emitter, 0xF2, 0, X86_MOVSD_LOAD, X86_XMM0, X86_R10, is_greater ? instruction.b : instruction.c);
+            emit_vm_operand(emitter, 0x66, 0, X86_UCOMISD_LOAD, X86_XMM0, X86_R10, is_greater ? instruction.c : instruction.b);
+            emit_comparison_result(emitter, X86_CONDITION_ABOVE, true, instruction.a);
+            break;
+        }
+        case OPCODE_JUMP:
+        {
+            emit_jump(emitter, X86_ALWAYS, target);
+            break;
+        }
+        case OPCODE_JUMP_IF_FALSE_I64:
+        case OPCODE_JUMP_IF_TRUE_I64:
+        {
+            // cmp qword [r10 + a * 8], 0
+            emit_vm_operand(emitter, 0, X86_REX_W, 0x83, 7, X86_R10, instruction.a);
+            const u8 zero = 0;
+            emit_bytes(emitter, &zero, 1);
+
+            emit_jump(emitter, (instruction.opcode == OPCODE_JUMP_IF_FALSE_I64) ? X86_CONDITION_EQUAL : X86_CONDITION_NOT_EQUAL, target);
+            break;
+        }
+        case OPCODE_JUMP_IF_FALSE_F64:
+        case OPCODE_JUMP_IF_TRUE_F64:
+        {
+            // xorpd xmm1, xmm1; ucomisd xmm0, xmm1, a NaN is unordered and sets the parity flag, it is not 0.0 so it is true
+            const u8 compare_zero[] = { 0x66, 0x0F, 0x57, 0xC9, 0x66, 0x0F, 0x2E, 0xC1 };
+            emit_vm_operand(emitter, 0xF2, 0, X86_MOVSD_LOAD, X86_XMM0, X86_R10, instruction.a);
+            emit_bytes(emitter, compare_zero, sizeof(compare_zero));
+
+            if (instruction.opcode == OPCODE_JUMP_IF_FALSE_F64)
+            {
+                // jp over the je
+                const u8 skip_unordered[] = { 0x7A, 0x06 };
+                emit_bytes(emitter, skip_unordered, sizeof(skip_unordered));
+                emit_jump(emitter, X86_CONDITION_EQUAL, target);
+            }
+            else
+            {
+                emit_jump(emitter, X86_CONDITION_PARITY, target);
+                emit_jump(emitter, X86_CONDITION_NOT_EQUAL, target);
+            }
+
+            break;
+        }
+        case OPCODE_ADD_I64_IMMEDIATE:
+        case OPCODE_MULTIPLY_I64_IMMEDIATE:
+        {
+            // add rax, imm32 or imul rax, rax, imm32, the immediate is sign extended
+            const u8 add_rax[] = { 0x48, 0x05 };
+            const u8 imul_rax[] = { 0x48, 0x69, 0xC0 };
+            emit_vm_operand(emitter, 0, X86_REX_W, X86_MOV_LOAD, X86_RAX, X86_R10, instruction.b);
+
+            if (instruction.opcode == OPCODE_ADD_I64_IMMEDIATE)
+                emit_bytes(emitter, add_rax, sizeof(add_rax));
+            else
+                emit_bytes(emitter, imul_rax, sizeof(imul_rax));
+
+            emit_u32(emitter, (u32)(i32)instruction.immediate);
+            emit_vm_operand(emitter, 0, X86_REX_W, X86_MOV_STORE, X86_RAX, X86_R10, instruction.a);
+            break;
+        }
+        case OPCODE_JUMP_IF_LESS_I64:
+        case OPCODE_JUMP_IF_NOT_LESS_I64:
+        case OPCODE_JUMP_IF_GREATER_I64:
+        case OPCODE_JUMP_IF_NOT_GREATER_I64:
+        {
+            emit_vm_operand(emitter, 0, X86_REX_W, X86_MOV_LOAD, X86_RAX, X86_R10, instruction.a);
+            emit_vm_operand(emitter, 0, X86_REX_W, X86_CMP_LOAD, X86_RAX, X86_R10, instruction.b);
+
+            u8 condition = X86_CONDITION_LESS_OR_EQUAL;
+            if (instruction.opcode == OPCODE_JUMP_IF_LESS_I64)
+                condition = X86_CONDITION_LESS;
+            else if (instruction.opcode == OPCODE_JUMP_IF_NOT_LESS_I64)
+                condition = X86_CONDITION_GREATER_OR_EQUAL;
+            else if (instruction.opcode == OPCODE_JUMP_IF_GREATER_I64)
+                condition = X86_CONDITION_GREATER;
+
+            emit_jump(emitter, condition, short_target);
+            break;
+        }
+        case OPCODE_JUMP_IF_LESS_F64:
+        case OPCODE_JUMP_IF_NOT_LESS_F64:
+        case OPCODE_JUMP_IF_GREATER_F64:
+        case OPCODE_JUMP_IF_NOT_GREATER_F64:
+        {
+            // a < b is tested as b > a, and 'not above' holds for a NaN like the interpreter's !(a < b) does
+            b8 is_less = instruction.opcode == OPCODE_JUMP_IF_LESS_F64 || instruction.opcode == OPCODE_JUMP_IF_NOT_LESS_F64;
+            b8 is_negated = instruction.opcode == OPCODE_JUMP_IF_NOT_LESS_F64 || instruction.opcode == OPCODE_JUMP_IF_NOT_GREATER_F64;
+            emit_vm_operand(emitter, 0xF2, 0, X86_MOVSD_LOAD, X86_XMM0, X86_R10, is_less ? instruction.b : instruction.a);
+            emit_vm_operand(emitter, 0x66, 0, X86_UCOMISD_LOAD, X86_XMM0, X86_R10, is_less ? instruction.a : instruction.b);
+            emit_jump(emitter, is_negated ? X86_CONDITION_BELOW_OR_EQUAL : X86_CONDITION_ABOVE, short_target);
+            break;
+        }
+        default:
+        {
+            // Calls, returns, string conditions and the float modulus are left to the interpreter
+            emit_exit(emitter, index);
+            break;
+        }
+    };
+}
+
+void emit_entry(jit_emitter* emitter)
+{
+#ifdef _WIN32
+    // mov r10, rcx; mov r11, rdx; jmp r8
+    const u8 entry[] = { 0x49, 0x89, 0xCA, 0x49, 0x89, 0xD3, 0x41, 0xFF, 0xE0 };
+#else
+    // mov r10, rdi; mov r11, rsi; jmp rdx
+    const u8 entry[] = { 0x49, 0x89, 0xFA, 0x49, 0x89, 0xF3, 0xFF, 0xE2 };
+#endif
+
+    emit_bytes(emitter, entry, sizeof(entry));
+
+    // int3 padding, the entry code is never run past its jump
+    while (emitter->length < JIT_ENTRY_BYTES)
+    {
+        const u8 breakpoint = 0xCC;
+        emit_bytes(emitter, &breakpoint, 1);
+    }
+}
+
+void emit_exit(jit_emitter* emitter, u64 index)
+{
+    // mov eax, index; ret
+    const u8 mov_eax = 0xB8;
+    const u8 ret = 0xC3;
+    emit_bytes(emitter, &mov_eax, 1);
+    emit_u32(emitter, (u32)index);
+    emit_bytes(emitter, &ret, 1);
+}
+
+void emit_jump(jit_emitter* emitter, u8 condition, u64 target)
+{
+    u8 bytes[X86_MAX_INSTRUCTION_BYTES];
+    emit_bytes(emitter, bytes, x86_encode_jump(bytes, condition));
+
+    // The rel32 is the end of the jump
+    emitter->patches[emitter->patch_count++] = (x86_patch){ emitter->length - 4, target };
+}
+
+void emit_vm_operand(jit_emitter* emitter, u8 prefix, u8 rex, u16 opcode, u8 x86_register, u8 base, u64 vm_register)
+{
+    // Every register of the vm is 8 bytes
+    u8 bytes[X86_MAX_INSTRUCTION_BYTES];
+    emit_bytes(emitter, bytes, x86_encode_memory_operand(bytes, prefix, rex, opcode, x86_register, base, (i32)(vm_register * sizeof(bytecode_value))));
+}
+
+void emit_comparison_result(jit_emitter* emitter, u8 condition, b8 is_float, u64 vm_register)
+{
+    u8 set_result[X86_MAX_INSTRUCTION_BYTES];
+    emit_bytes(emitter, set_result, x86_encode_set_condition(set_result, condition));
+
+    if (!is_float)
+    {
+        emit_vm_operand(emitter, 0, X86_REX_W, X86_MOV_STORE, X86_RAX, X86_R10, vm_register);
+        return;
+    }
+
+    // cvtsi2sd xmm0, eax, a float comparison gives 1.0 or 0.0
+    const u8 convert[] = { 0xF2, 0x0F, 0x2A, 0xC0 };
+    emit_bytes(emitter, convert, sizeof(convert));
+    emit_vm_operand(emitter, 0xF2, 0, X86_MOVSD_STORE, X86_XMM0, X86_R10, vm_register);
+}
+
+void emit_bytes(jit_emitter* emitter, const u8* bytes, u64 count)
+{
+    memcpy(emitter->code + emitter->length, bytes, count);
+    emitter->length += count;
+}
+
+void emit_u32(jit_emitter* emitter, u32 value)
+{
+    u8 bytes[4];
+    emit_bytes(emitter, bytes, x86_write_u32(bytes, value));
+}
+
+#else
+
+b8 jit_create(rouleaux_jit* out_jit, const bytecode_program* program)
+{
+    // There is no jit for this platform, everything is interpreted
+    memset(out_jit, 0, sizeof(rouleaux_jit));
+    return false;
+}
+
+void jit_destroy(rouleaux_jit* jit)
+{
+    memset(jit, 0, sizeof(rouleaux_jit));
+}
+
+b8 jit_count(rouleaux_jit* jit, u64 function_index, b8 is_call)
+{
+    return false;
+}
+
+u64 jit_run(rouleaux_jit* jit, u64 function_index, u64 instruction_index, bytecode_value* registers, bytecode_value* globals)
+{
+    return instruction_index;
+}
+
+#endif
@@ -0,0 +1,520 @@
+#include "bytecode/virtual_machine.h"
+#include "bytecode/jit.h"
+
+#include <malloc.h>
+#include <math.h>
+#include <stdarg.h>
+#include <string.h>
+
+// Threaded dispatch needs computed gotos, a GCC and Clang extension. Every other compiler, and any build with
+// ROULX_VM_SWITCH_DISPATCH defined (premake5 --vm-switch-dispatch), dispatches through a switch instead
+#if (defined(__clang__) || defined(__GNUC__)) && !defined(ROULX_VM_SWITCH_DISPATCH)
+#define VM_THREADED_DISPATCH
+#endif
+
+// GCC's cross jumping merges the dispatch at the end of every handler back into a few shared jumps, undoing
+// the threading, so it is turned off for interpret()
+#if defined(VM_THREADED_DISPATCH) && !defined(__clang__)
+#define VM_RUN_ATTRIBUTES __attribute__((optimize("no-crossjumping")))
+#else
+#define VM_RUN_ATTRIBUTES
+#endif
+
+#ifdef ROULX_VM_STATISTICS
+#define VM_COUNT()                                                                              \
+    do {                                                                                        \
+        vm->statistics->opcode_counts[instruction.opcode]++;                                    \
+        vm->statistics->opcode_pair_counts[previous_opcode][instruction.opcode]++;              \
+        previous_opcode = instruction.opcode;                                                   \
+    } while (0)
+#else
+#define VM_COUNT()
+#endif
+
+#ifdef VM_THREADED_DISPATCH
+// Every instruction jumps straight to the label of the next one, so each has a branch of its own to predict and no bounds check
+#define VM_DISPATCH_BEGIN VM_NEXT();
+#define VM_DISPATCH_END
+#define VM_CASE(opcode) label_##opcode:
+#define VM_DEFAULT label_OPCODE_INVALID:
+#define VM_NEXT() do { instruction = *pc++; VM_COUNT(); goto *dispatch_table[instruction.opcode]; } while (0)
+#else
+// Every instruction goes back through the one switch
+#define VM_DISPATCH_BEGIN for (;;) { instruction = *pc++; VM_COUNT(); switch (instruction.opcode)
+#define VM_DISPATCH_END }
+#define VM_CASE(opcode) case opcode:
+#define VM_DEFAULT default:
+#define VM_NEXT() break
+#endif
+
+#ifdef ROULX_JIT_X86_64
+// Switches to the native code of the function of the frame when it has any, the interpreter continues at the instruction
+// the native code stopped at. is_hot is evaluated with function_index set, it decides whether the function gets to run natively
+#define VM_ENTER_NATIVE_CODE(is_hot)                                                                                            \
+    do {                                                                                                                        \
+        u64 function_index = (u64)(frame->function - functions);                                                               \
+        if (jit != NULL && (is_hot))                                                                                            \
+            pc = frame->function->code + jit_run(jit, function_index, (u64)(pc - frame->function->code), registers, globals);  \
+    } while (0)
+
+// Takes a jump, a jump backwards is a loop iteration the jit counts
+#define VM_JUMP(offset)                                                                         \
+    do {                                                                                        \
+        pc += (offset);                                                                         \
+        if ((offset) < 0)                                                                       \
+            VM_ENTER_NATIVE_CODE(jit_count(jit, function_index, false));                        \
+    } while (0)
+#else
+#define VM_ENTER_NATIVE_CODE(is_hot)
+#define VM_JUMP(offset) pc += (offset)
+#endif
+
+// Runs a program from its top level code, switching to the native code of the functions the jit (if not NULL) compiles
+static b8 interpret(rouleaux_vm* vm, const bytecode_program* program, rouleaux_jit* jit);
+
+// True if a string condition lets an if or while statement run its statement, only the empty string is false
+static b8 is_true_string(const char* string);
+
+// Reports a runtime error of the instruction before pc to the context
+static void runtime_error(rouleaux_vm* vm, const vm_frame* frame, const bytecode_instruction* pc, diagnostic_id id, ...);
+
+
+rouleaux_vm vm_create(rouleaux_context* context)
+{
+    rouleaux_vm vm = {};
+    vm.context = context;
+
+    vm.registers = malloc(DEFAULT_VM_REGISTER_COUNT * sizeof(bytecode_value));
+    vm.frames = malloc(DEFAULT_VM_CALL_DEPTH * sizeof(vm_frame));
+    b8 allocated = vm.registers != NULL && vm.frames != NULL;
+
+#ifdef ROULX_VM_STATISTICS
+    vm.statistics = calloc(1, sizeof(vm_statistics));
+    allocated = allocated && vm.statistics != NULL;
+#endif
+
+    if (!allocated)
+    {
+        // Without its registers the vm cannot run anything, vm_run() reports it
+        vm_destroy(&vm);
+        vm.context = context;
+        vm.has_error = true;
+        return vm;
+    }
+
+    vm.register_count = DEFAULT_VM_REGISTER_COUNT;
+    vm.frame_capacity = DEFAULT_VM_CALL_DEPTH;
+    vm.use_jit = true;
+
+    return vm;
+}
+
+void vm_destroy(rouleaux_vm* vm)
+{
+    free(vm->registers);
+    free(vm->frames);
+    free(vm->statistics);
+
+    memset(vm, 0, sizeof(rouleaux_vm));
+}
+
+b8 vm_run(rouleaux_vm* vm, const bytecode_program* program)
+{
+    if (program->function_count == 0)
+        return true;
+
+    const bytecode_function* top_level = &program->functions[0];
+    if (vm->registers == NULL || top_level->register_count > vm->register_count)
+    {
+        // The error points at the first instruction of the file
+        vm_frame top_level_frame = {};
+        top_level_frame.function = top_level;
+        runtime_error(vm, &top_level_frame, top_level->code + 1, DIAGNOSTIC_VM_ALLOCATION);
+        return false;
+    }
+
+    vm->has_error = false;
+
+    // The globals are the first registers of the top level code, they are zero until their declaration runs
+    memset(vm->registers, 0, top_level->register_count * sizeof(bytecode_value));
+
+    // Without a jit, on a platform it does not support or when its memory cannot be allocated, everything is interpreted
+    rouleaux_jit jit = {};
+    b8 has_jit = vm->use_jit && jit_create(&jit, program);
+
+    b8 ran = interpret(vm, program, has_jit ? &jit : NULL);
+
+    if (has_jit)
+        jit_destroy(&jit);
+
+    return ran;
+}
+
+
+
+VM_RUN_ATTRIBUTES b8 interpret(rouleaux_vm* vm, const bytecode_program* program, rouleaux_jit* jit)
+{
+    const bytecode_function* top_level = &program->functions[0];
+    const bytecode_value* constants = program->constants;
+    const bytecode_function* functions = program->functions;
+    bytecode_value* globals = vm->registers;
+    bytecode_value* registers_end = vm->registers + vm->register_count;
+    vm_frame* frames_end = vm->frames + vm->frame_capacity;
+
+    vm_frame* frame = vm->frames;
+    frame->function = top_level;
+    frame->registers = vm->registers;
+    frame->return_register = NULL;
+
+    // The registers and the next instruction are kept in locals, the frame is only written when a call is made
+    const bytecode_instruction* pc = top_level->code;
+    bytecode_value* registers = frame->registers;
+
+#ifdef VM_THREADED_DISPATCH
+    // Indexed by bytecode_opcode, every opcode needs its label in here
+    static void* dispatch_table[OPCODE_MAX_OPCODES] = {
+        [OPCODE_INVALID]                 = &&label_OPCODE_INVALID,
+        [OPCODE_LOAD_CONSTANT]           = &&label_OPCODE_LOAD_CONSTANT,
+        [OPCODE_MOVE]                    = &&label_OPCODE_MOVE,
+        [OPCODE_GET_GLOBAL]              = &&label_OPCODE_GET_GLOBAL,
+        [OPCODE_SET_GLOBAL]              = &&label_OPCODE_SET_GLOBAL,
+        [OPCODE_ADD_I64]                 = &&label_OPCODE_ADD_I64,
+        [OPCODE_ADD_F64]                 = &&label_OPCODE_ADD_F64,
+        [OPCODE_SUBTRACT_I64]            = &&label_OPCODE_SUBTRACT_I64,
+        [OPCODE_SUBTRACT_F64]            = &&label_OPCODE_SUBTRACT_F64,
+        [OPCODE_MULTIPLY_I64]            = &&label_OPCODE_MULTIPLY_I64,
+        [OPCODE_MULTIPLY_F64]            = &&label_OPCODE_MULTIPLY_F64,
+        [OPCODE_DIVIDE_I64]              = &&label_OPCODE_DIVIDE_I64,
+        [OPCODE_DIVIDE_F64]              = &&label_OPCODE_DIVIDE_F64,
+        [OPCODE_MODULUS_I64]             = &&label_OPCODE_MODULUS_I64,
+        [OPCODE_MODULUS_F64]             = &&label_OPCODE_MODULUS_F64,
+        [OPCODE_GREATER_THAN_I64]        = &&label_OPCODE_GREATER_THAN_I64,
+        [OPCODE_GREATER_THAN_F64]        = &&label_OPCODE_GREATER_THAN_F64,
+        [OPCODE_LESS_THAN_I64]           = &&label_OPCODE_LESS_THAN_I64,
+        [OPCODE_LESS_THAN_F64]           = &&label_OPCODE_LESS_THAN_F64,
+        [OPCODE_JUMP]                    = &&label_OPCODE_JUMP,
+        [OPCODE_JUMP_IF_FALSE_I64]       = &&label_OPCODE_JUMP_IF_FALSE_I64,
+        [OPCODE_JUMP_IF_FALSE_F64]       = &&label_OPCODE_JUMP_IF_FALSE_F64,
+        [OPCODE_JUMP_IF_FALSE_STRING]    = &&label_OPCODE_JUMP_IF_FALSE_STRING,
+        [OPCODE_JUMP_IF_TRUE_I64]        = &&label_OPCODE_JUMP_IF_TRUE_I64,
+        [OPCODE_JUMP_IF_TRUE_F64]        = &&label_OPCODE_JUMP_IF_TRUE_F64,
+        [OPCODE_JUMP_IF_TRUE_STRING]     = &&label_OPCODE_JUMP_IF_TRUE_STRING,
+        [OPCODE_CALL]                    = &&label_OPCODE_CALL,
+        [OPCODE_RETURN]                  = &&label_OPCODE_RETURN,
+        [OPCODE_ADD_I64_IMMEDIATE]       = &&label_OPCODE_ADD_I64_IMMEDIATE,
+        [OPCODE_MULTIPLY_I64_IMMEDIATE]  = &&label_OPCODE_MULTIPLY_I64_IMMEDIATE,
+        [OPCODE_JUMP_IF_LESS_I64]        = &&label_OPCODE_JUMP_IF_LESS_I64,
+        [OPCODE_JUMP_IF_LESS_F64]        = &&label_OPCODE_JUMP_IF_LESS_F64,
+        [OPCODE_JUMP_IF_NOT_LESS_I64]    = &&label_OPCODE_JUMP_IF_NOT_LESS_I64,
+        [OPCODE_JUMP_IF_NOT_LESS_F64]    = &&label_OPCODE_JUMP_IF_NOT_LESS_F64,
+        [OPCODE_JUMP_IF_GREATER_I64]     = &&label_OPCODE_JUMP_IF_GREATER_I64,
+        [OPCODE_JUMP_IF_GREATER_F64]     = &&label_OPCODE_JUMP_IF_GREATER_F64,
+        [OPCODE_JUMP_IF_NOT_GREATER_I64] = &&label_OPCODE_JUMP_IF_NOT_GREATER_I64,
+        [OPCODE_JUMP_IF_NOT_GREATER_F64] = &&label_OPCODE_JUMP_IF_NOT_GREATER_F64,
+};
+#endif
+
+#ifdef ROULX_VM_STATISTICS
+    // The first instruction is counted as following OPCODE_INVALID
+    u16 previous_opcode = OPCODE_INVALID;
+#endif
+
+    bytecode_instruction instruction;
+    VM_DISPATCH_BEGIN
+    {
+        VM_CASE(OPCODE_LOAD_CONSTANT)
+        {
+            registers[instruction.a] = constants[instruction.index];
+            VM_NEXT();
+        }
+        VM_CASE(OPCODE_MOVE)
+        {
+            registers[instruction.a] = registers[instruction.b];
+            VM_NEXT();
+        }
+        VM_CASE(OPCODE_GET_GLOBAL)
+        {
+            registers[instruction.a] = globals[instruction.index];
+            VM_NEXT();
+        }
+        VM_CASE(OPCODE_SET_GLOBAL)
+        {
+            globals[instruction.index] = registers[instruction.a];
+            VM_NEXT();
+        }
+        VM_CASE(OPCODE_ADD_I64)
+        {
+            // The integer arithmetic is done on unsigned integers so an overflow wraps around instead of being undefined
+            registers[instruction.a].bits = registers[instruction.b].bits + registers[instruction.c].bits;
+            VM_NEXT();
+        }
+        VM_CASE(OPCODE_ADD_F64)
+        {
+            registers[instruction.a].float64 = registers[instruction.b].float64 + registers[instruction.c].float64;
+            VM_NEXT();
+        }
+        VM_CASE(OPCODE_SUBTRACT_I64)
+        {
+            registers[instruction.a].bits = registers[instruction.b].bits - registers[instruction.c].bits;
+            VM_NEXT();
+        }
+        VM_CASE(OPCODE_SUBTRACT_F64)
+        {
+            registers[instruction.a].float64 = registers[instruction.b].float64 - registers[instruction.c].float64;
+            VM_NEXT();
+        }
+        VM_CASE(OPCODE_MULTIPLY_I64)
+        {
+            registers[instruction.a].bits = registers[instruction.b].bits * registers[instruction.c].bits;
+            VM_NEXT();
+        }
+        VM_CASE(OPCODE_MULTIPLY_F64)
+        {
+            registers[instruction.a].float64 = registers[instruction.b].float64 * registers[instruction.c].float64;
+            VM_NEXT();
+        }
+        VM_CASE(OPCODE_DIVIDE_I64)
+        {
+            i64 right = registers[instruction.c].integer;
+            if (right == 0)
+            {
+                runtime_error(vm, frame, pc, DIAGNOSTIC_DIVISION_BY_ZERO);
+                return false;
+            }
+
+            // Dividing the smallest integer by -1 does not fit, it wraps around like the other operators do
+            if (right == -1)
+                registers[instruction.a].bits = 0 - registers[instruction.b].bits;
+            else
+                registers[instruction.a].integer = registers[instruction.b].integer / right;
+
+            VM_NEXT();
+        }
+        VM_CASE(OPCODE_DIVIDE_F64)
+        {
+            registers[instruction.a].float64 = registers[instruction.b].float64 / registers[instruction.c].float64;
+            VM_NEXT();
+        }
+        VM_CASE(OPCODE_MODULUS_I64)
+        {
+            i64 right = registers[instruction.c].integer;
+            if (right == 0)
+            {
+                runtime_error(vm, frame, pc, DIAGNOSTIC_DIVISION_BY_ZERO);
+                return false;
+            }
+
+            // The smallest integer modulus -1 overflows like dividing it does, anything modulus -1 is 0
+            if (right == -1)
+                registers[instruction.a].bits = 0;
+            else
+                registers[instruction.a].integer = registers[instruction.b].integer % right;
+
+            VM_NEXT();
+        }
+        VM_CASE(OPCODE_MODULUS_F64)
+        {
+            registers[instruction.a].float64 = fmod(registers[instruction.b].float64, registers[instruction.c].float64);
+            VM_NEXT();
+        }
+        VM_CASE(OPCODE_GREATER_THAN_I64)
+        {
+            // A comparison has the type of its operands, so it gives 1 or 1.0 when it holds
+            registers[instruction.a].integer = registers[instruction.b].integer > registers[instruction.c].integer;
+            VM_NEXT();
+        }
+        VM_CASE(OPCODE_GREATER_THAN_F64)
+        {
+            registers[instruction.a].float64 = (registers[instruction.b].float64 > registers[instruction.c].float64) ? 1.0 : 0.0;
+            VM_NEXT();
+        }
+        VM_CASE(OPCODE_LESS_THAN_I64)
+        {
+            registers[instruction.a].integer = registers[instruction.b].integer < registers[instruction.c].integer;
+            VM_NEXT();
+        }
+        VM_CASE(OPCODE_LESS_THAN_F64)
+        {
+            registers[instruction.a].float64 = (registers[instruction.b].float64 < registers[instruction.c].float64) ? 1.0 : 0.0;
+            VM_NEXT();
+        }
+        VM_CASE(OPCODE_JUMP)
+        {
+            VM_JUMP(instruction.offset);
+            VM_NEXT();
+        }
+        VM_CASE(OPCODE_JUMP_IF_FALSE_I64)
+        {
+            if (registers[instruction.a].bits == 0)
+                VM_JUMP(instruction.offset);
+
+            VM_NEXT();
+        }
+        VM_CASE(OPCODE_JUMP_IF_FALSE_F64)
+        {
+            if (registers[instruction.a].float64 == 0.0)
+                VM_JUMP(instruction.offset);
+
+            VM_NEXT();
+        }
+        VM_CASE(OPCODE_JUMP_IF_FALSE_STRING)
+        {
+            if (!is_true_string(registers[instruction.a].string))
+                VM_JUMP(instruction.offset);
+
+            VM_NEXT();
+        }
+        VM_CASE(OPCODE_JUMP_IF_TRUE_I64)
+        {
+            if (registers[instruction.a].bits != 0)
+                VM_JUMP(instruction.offset);
+
+            VM_NEXT();
+        }
+        VM_CASE(OPCODE_JUMP_IF_TRUE_F64)
+        {
+            if (registers[instruction.a].float64 != 0.0)
+                VM_JUMP(instruction.offset);
+
+            VM_NEXT();
+        }
+        VM_CASE(OPCODE_JUMP_IF_TRUE_STRING)
+        {
+            if (is_true_string(registers[instruction.a].string))
+                VM_JUMP(instruction.offset);
+
+            VM_NEXT();
+        }
+        VM_CASE(OPCODE_CALL)
+        {
+            const bytecode_function* callee = &functions[registers[instruction.b].function];
+            bytecode_value* callee_registers = registers + instruction.c;
+            if (frame + 1 >= frames_end || callee_registers + callee->register_count > registers_end)
+            {
+                runtime_error(vm, frame, pc, DIAGNOSTIC_STACK_OVERFLOW, diagnostic_token_text(callee->name));
+                return false;
+            }
+
+            // The arguments are already in place, the rest of the callee's registers start out zero
+            memset(callee_registers + callee->parameter_count, 0, (callee->register_count - callee->parameter_count) * sizeof(bytecode_value));
+
+            frame->pc = pc;
+            frame++;
+            frame->function = callee;
+            frame->registers = callee_registers;
+            frame->return_register = registers + instruction.a;
+
+            pc = callee->code;
+            registers = callee_registers;
+            VM_ENTER_NATIVE_CODE(jit_count(jit, function_index, true));
+            VM_NEXT();
+        }
+        VM_CASE(OPCODE_RETURN)
+        {
+            if (frame == vm->frames)
+                return true;
+
+            *frame->return_register = registers[instruction.a];
+            frame--;
+
+            pc = frame->pc;
+            registers = frame->registers;
+            VM_ENTER_NATIVE_CODE(jit->functions[function_index].code != NULL);
+            VM_NEXT();
+        }
+        VM_CASE(OPCODE_ADD_I64_IMMEDIATE)
+        {
+            registers[instruction.a].bits = registers[instruction.b].bits + (u64)(i64)instruction.immediate;
+            VM_NEXT();
+        }
+        VM_CASE(OPCODE_MULTIPLY_I64_IMMEDIATE)
+        {
+            registers[instruction.a].bits = registers[instruction.b].bits * (u64)(i64)instruction.immediate;
+            VM_NEXT();
+        }
+        VM_CASE(OPCODE_JUMP_IF_LESS_I64)
+        {
+            if (registers[instruction.a].integer < registers[instruction.b].integer)
+                VM_JUMP(instruction.short_offset);
+
+            VM_NEXT();
+        }
+        VM_CASE(OPCODE_JUMP_IF_LESS_F64)
+        {
+            if (registers[instruction.a].float64 < registers[instruction.b].float64)
+                VM_JUMP(instruction.short_offset);
+
+            VM_NEXT();
+        }
+        VM_CASE(OPCODE_JUMP_IF_NOT_LESS_I64)
+        {
+            if (!(registers[instruction.a].integer < registers[instruction.b].integer))
+                VM_JUMP(instruction.short_offset);
+
+            VM_NEXT();
+        }
+        VM_CASE(OPCODE_JUMP_IF_NOT_LESS_F64)
+        {
+            // Not the same as a >= b, a comparison with a NaN never holds
+            if (!(registers[instruction.a].float64 < registers[instruction.b].float64))
+                VM_JUMP(instruction.short_offset);
+
+            VM_NEXT();
+        }
+        VM_CASE(OPCODE_JUMP_IF_GREATER_I64)
+        {
+            if (registers[instruction.a].integer > registers[instruction.b].integer)
+                VM_JUMP(instruction.short_offset);
+
+            VM_NEXT();
+        }
+        VM_CASE(OPCODE_JUMP_IF_GREATER_F64)
+        {
+            if (registers[instruction.a].float64 > registers[instruction.b].float64)
+                VM_JUMP(instruction.short_offset);
+
+            VM_NEXT();
+        }
+        VM_CASE(OPCODE_JUMP_IF_NOT_GREATER_I64)
+        {
+            if (!(registers[instruction.a].integer > registers[instruction.b].integer))
+                VM_JUMP(instruction.short_offset);
+
+            VM_NEXT();
+        }
+        VM_CASE(OPCODE_JUMP_IF_NOT_GREATER_F64)
+        {
+            if (!(registers[instruction.a].float64 > registers[instruction.b].float64))
+                VM_JUMP(instruction.short_offset);
+
+            VM_NEXT();
+        }
+        VM_DEFAULT
+        {
+            // The compiler never emits anything else, this is a compiler bug
+            return false;
+        }
+    }
+    VM_DISPATCH_END
+}
+
+
+
+b8 is_true_string(const char* string)
+{
+    return string != NULL && string[0] != '\0';
+}
+
+void runtime_error(rouleaux_vm* vm, const vm_frame* frame, const bytecode_instruction* pc, diagnostic_id id, ...)
+{
+    const bytecode_function* function = frame->function;
+    u64 instruction_index = (u64)(pc - function->code) - 1;
+
+    va_list params;
+    va_start(params, id);
+    error_report report = error_report_create(function->instruction_tokens[instruction_index], id, params);
+    va_end(params);
+
+    context_report_error(vm->context, report);
+    vm->has_error = true;
+}
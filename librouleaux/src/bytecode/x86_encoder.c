@@ -0,0 +1,109 @@
+#include "bytecode/x86_encoder.h"
+
+// Writes the prefix, the REX prefix and the opcode an instruction starts with, giving the amount of bytes written
+static u64 encode_opcode(u8* out, u8 prefix, u8 rex, u16 opcode);
+
+
+u64 x86_encode_memory_operand(u8* out, u8 prefix, u8 rex, u16 opcode, u8 x86_register, u8 base, i32 displacement)
+{
+    if (x86_register >= 8)
+        rex |= X86_REX_R;
+
+    if (base >= 8)
+        rex |= X86_REX_B;
+
+    u64 length = encode_opcode(out, prefix, rex, opcode);
+
+    // ModRM of [base + disp8] when the displacement fits in a byte, [base + disp32] otherwise
+    if (displacement >= -0x80 && displacement < 0x80)
+    {
+        out[length++] = (u8)(0x40 | ((x86_register & 7) << 3) | (base & 7));
+        out[length++] = (u8)displacement;
+        return length;
+    }
+
+    out[length++] = (u8)(0x80 | ((x86_register & 7) << 3) | (base & 7));
+    return length + x86_write_u32(out + length, (u32)displacement);
+}
+
+u64 x86_encode_register_operand(u8* out, u8 prefix, u8 rex, u16 opcode, u8 x86_register, u8 rm_register)
+{
+    if (x86_register >= 8)
+        rex |= X86_REX_R;
+
+    if (rm_register >= 8)
+        rex |= X86_REX_B;
+
+    // ModRM of two registers
+    u64 length = encode_opcode(out, prefix, rex, opcode);
+    out[length++] = (u8)(0xC0 | ((x86_register & 7) << 3) | (rm_register & 7));
+    return length;
+}
+
+u64 x86_encode_rip_operand(u8* out, u8 prefix, u8 rex, u16 opcode, u8 x86_register)
+{
+    if (x86_register >= 8)
+        rex |= X86_REX_R;
+
+    // ModRM of [rip + disp32]
+    u64 length = encode_opcode(out, prefix, rex, opcode);
+    out[length++] = (u8)(((x86_register & 7) << 3) | 5);
+    return length + x86_write_u32(out + length, 0);
+}
+
+u64 x86_encode_jump(u8* out, u8 condition)
+{
+    u64 length = 0;
+    if (condition == X86_ALWAYS)
+    {
+        out[length++] = 0xE9;
+    }
+    else
+    {
+        out[length++] = 0x0F;
+        out[length++] = (u8)(0x80 | condition);
+    }
+
+    return length + x86_write_u32(out + length, 0);
+}
+
+u64 x86_encode_set_condition(u8* out, u8 condition)
+{
+    const u8 set_result[] = { 0x0F, (u8)(0x90 | condition), 0xC0, 0x0F, 0xB6, 0xC0 };
+    for (u64 i = 0; i < sizeof(set_result); ++i)
+        out[i] = set_result[i];
+
+    return sizeof(set_result);
+}
+
+i32 x86_relative_offset(u64 position, u64 target)
+{
+    return (i32)((i64)target - (i64)(position + 4));
+}
+
+u64 x86_write_u32(u8* out, u32 value)
+{
+    out[0] = (u8)value;
+    out[1] = (u8)(value >> 8);
+    out[2] = (u8)(value >> 16);
+    out[3] = (u8)(value >> 24);
+    return 4;
+}
+
+
+
+u64 encode_opcode(u8* out, u8 prefix, u8 rex, u16 opcode)
+{
+    u64 length = 0;
+    if (prefix)
+        out[length++] = prefix;
+
+    if (rex)
+        out[length++] = rex;
+
+    if (opcode > 0xFF)
+        out[length++] = (u8)(opcode >> 8);
+
+    out[length++] = (u8)opcode;
+    return length;
+}
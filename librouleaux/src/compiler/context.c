@@ -0,0 +1,396 @@
+#include "compiler/context.h"
+#include "parser/parallel_parser.h"
+#include "parser/parser_allocators.h"
+#include "typing/parallel_typing.h"
+#include "typing/reachable_typing.h"
+#include "utilities/file_utilities.h"
+
+#include <malloc.h>
+#include <string.h>
+
+#define DEFAULT_CONTEXT_SOURCE_CAPACITY 4
+#define DEFAULT_CONTEXT_DIAGNOSTIC_CAPACITY 8
+
+// Records the content of a file in the context, the context takes ownership of the content unless it is borrowed
+static b8 add_source(rouleaux_context* context, const char* filename, char* content, u64 length, b8 borrows_content);
+
+// Reports an error found in a stream, the faulted token's text is interned since the stream's windows are released
+static void report_stream_error(rouleaux_context* context, error_report report);
+
+// Finds the newest source with the given filename, see context_find_source()
+static context_source* find_source(rouleaux_context* context, const char* filename);
+
+// Finds the faulted line of a diagnostic in the context's sources, indexing the lines of its source the first time. A file
+// the context does not hold (i.e. one that was streamed) has the line read back from it into *out_read_line, for the caller to free
+static b8 diagnostic_line(rouleaux_context* context, error_report report, const char** out_line, u64* out_line_length, char** out_read_line);
+
+
+b8 context_create(rouleaux_context* context, rouleaux_context_options options)
+{
+    memset(context, 0, sizeof(rouleaux_context));
+    context->options = options;
+    context->node_arena = node_arena_create(options.node_arena_block_size);
+    context->interner = string_interner_create();
+
+    return true;
+}
+
+void context_destroy(rouleaux_context* context)
+{
+    for (u64 i = 0; i < context->source_count; ++i)
+    {
+        if (!context->sources[i].borrows_content)
+            free(context->sources[i].content);
+        line_index_destroy(&context->sources[i].lines);
+    }
+    free(context->sources);
+
+    free(context->diagnostics);
+
+    string_interner_destroy(&context->interner);
+    node_arena_destroy(&context->node_arena);
+
+    memset(context, 0, sizeof(rouleaux_context));
+}
+
+const char* context_intern(rouleaux_context* context, const char* text, u64 length)
+{
+    return string_interner_intern(&context->interner, text, length);
+}
+
+rouleaux_parser context_create_parser(rouleaux_context* context, const char* filename)
+{
+    // The tokens keep a pointer to the filename, so it has to live as long as the context
+    const char* interned_filename = context_intern(context, filename, strlen(filename));
+    if (interned_filename)
+        filename = interned_filename;
+
+    rouleaux_parser parser = parser_create(filename, default_node_allocator, default_node_deallocator);
+    if (parser.has_error)
+    {
+        context_report_error(context, parse_result_error(token_file_start(filename), DIAGNOSTIC_FILE_UNREADABLE, diagnostic_string(filename, strlen(filename))).error);
+        return parser;
+    }
+
+    parser.node_arena = &context->node_arena;
+    parser_set_comment_mode(&parser, context->options.comment_mode);
+
+    // The context keeps the file content around for its diagnostics, the lexer only borrows it from now on
+    if (add_source(context, filename, parser.lexer.file_content, parser.lexer.file_content_length, false))
+        parser.lexer.borrows_file_content = true;
+
+    return parser;
+}
+
+rouleaux_parser context_create_parser_from_buffer(rouleaux_context* context, const char* name, const char* buffer, u64 length)
+{
+    // The tokens keep a pointer to the name, so it has to live as long as the context
+    const char* interned_name = context_intern(context, name, strlen(name));
+    if (interned_name)
+        name = interned_name;
+
+    rouleaux_parser parser = parser_create_from_buffer(buffer, length, name, default_node_allocator, default_node_deallocator);
+    if (parser.has_error)
+    {
+        context_report_error(context, parse_result_error(token_file_start(name), DIAGNOSTIC_BUFFER_UNPARSABLE, diagnostic_string(name, strlen(name))).error);
+        return parser;
+    }
+
+    parser.node_arena = &context->node_arena;
+    parser_set_comment_mode(&parser, context->options.comment_mode);
+
+    // The diagnostics render from the caller's buffer, the same one the lexer reads
+    add_source(context, name, (char*)buffer, length, true);
+
+    return parser;
+}
+
+struct ast_node* context_parse_file(rouleaux_context* context, rouleaux_parser* parser)
+{
+    parse_result result = parser_parse_file_parallel(parser, context->options.jobs);
+    if (!result.success)
+    {
+        context_report_error(context, result.error);
+        return NULL;
+    }
+
+    return result.resulting_tree;
+}
+
+b8 context_resolve_types(rouleaux_context* context, struct ast_node* ast, symbol_table* sym_table)
+{
+    typing_result result = resolve_types_parallel(ast, sym_table, context->options.jobs);
+    if (!result.success)
+    {
+        context_report_error(context, result.error);
+        return false;
+    }
+
+    return true;
+}
+
+b8 context_resolve_reachable_types(rouleaux_context* context, struct ast_node* ast, symbol_table* sym_table, const char* entry_point)
+{
+    typing_result result = resolve_types_reachable(ast, sym_table, entry_point);
+    if (!result.success)
+    {
+        context_report_error(context, result.error);
+        return false;
+    }
+
+    return true;
+}
+
+b8 context_compile_stream(rouleaux_context* context, const char* name, lexer_read_fptr read, void* user_data, symbol_table* sym_table)
+{
+    // The tokens (and the symbols made from them) keep a pointer to the name, so it has to live as long as the context
+    const char* interned_name = context_intern(context, name, strlen(name));
+    if (interned_name)
+        name = interned_name;
+
+    rouleaux_parser parser = {};
+    parser.lexer = lexer_create_from_stream(name, read, user_data, context->options.stream_chunk_size);
+    parser.node_allocator = default_node_allocator;
+    parser.node_deallocator = default_node_deallocator;
+    if (parser.lexer.has_error)
+    {
+        context_report_error(context, parse_result_error(token_file_start(name), DIAGNOSTIC_STREAM_UNREADABLE, diagnostic_string(name, strlen(name))).error);
+        return false;
+    }
+
+    parser_set_comment_mode(&parser, context->options.comment_mode);
+
+    // Only one statement is alive at a time, so it gets an arena of its own which is reset after every statement
+    node_arena statement_arena = node_arena_create(context->options.node_arena_block_size);
+    parser.node_arena = &statement_arena;
+
+    b8 success = true;
+    while (success && !parser.done)
+    {
+        u64 first_symbol = sym_table->size;
+
+        parse_result result = parser_parse_statement(&parser);
+        if (!result.success)
+        {
+            report_stream_error(context, result.error);
+            success = false;
+            break;
+        }
+
+        // Typed like context_resolve_types() would, so the locals of a function stay out of sym_table
+        typing_result typing = resolve_types_parallel(result.resulting_tree, sym_table, context->options.jobs);
+        if (!typing.success)
+        {
+            report_stream_error(context, typing.error);
+            success = false;
+        }
+
+        // The statement's symbols outlive it, everything else about it can go
+        if (!symbol_table_detach(sym_table, first_symbol, &context->interner))
+        {
+            if (success)
+                context_report_error(context, parse_result_error(token_file_start(name), DIAGNOSTIC_SYMBOL_TABLE_ALLOCATION).error);
+            success = false;
+        }
+
+        parser_destroy_ast_node(&parser, result.resulting_tree);
+        node_arena_reset(&statement_arena);
+        lexer_release_stream(&parser.lexer);
+    }
+
+    node_arena_destroy(&statement_arena);
+    lexer_destroy(&parser.lexer);
+
+    return success;
+}
+
+b8 context_compile_file_streamed(rouleaux_context* context, const char* filename, symbol_table* sym_table)
+{
+    void* file = file_stream_open(filename);
+    if (!file)
+    {
+        const char* interned_filename = context_intern(context, filename, strlen(filename));
+        if (interned_filename)
+            filename = interned_filename;
+
+        context_report_error(context, parse_result_error(token_file_start(filename), DIAGNOSTIC_FILE_UNREADABLE, diagnostic_string(filename, strlen(filename))).error);
+        return false;
+    }
+
+    b8 success = context_compile_stream(context, filename, file_stream_read, file, sym_table);
+    file_stream_close(file);
+
+    return success;
+}
+
+void context_report_error(rouleaux_context* context, error_report report)
+{
+    if (context->diagnostic_count >= context->diagnostic_capacity)
+    {
+        u64 new_capacity = context->diagnostic_capacity ? context->diagnostic_capacity * 2 : DEFAULT_CONTEXT_DIAGNOSTIC_CAPACITY;
+        error_report* new_diagnostics = malloc(new_capacity * sizeof(error_report));
+        if (!new_diagnostics)
+            return; // Nowhere to keep the report, drop it
+
+        if (context->diagnostics)
+            memcpy_s(new_diagnostics, new_capacity * sizeof(error_report), context->diagnostics, context->diagnostic_count * sizeof(error_report));
+
+        free(context->diagnostics);
+        context->diagnostics = new_diagnostics;
+        context->diagnostic_capacity = new_capacity;
+    }
+
+    // The string arguments are borrowed from whoever made the report, keep our own copy so they outlive it
+    u64 argument_count = diagnostic_argument_count(report.id);
+    for (u64 i = 0; i < argument_count; ++i)
+    {
+        diagnostic_argument* argument = &report.arguments[i];
+        if (argument->type != DIAGNOSTIC_ARGUMENT_STRING)
+            continue;
+
+        const char* text = context_intern(context, argument->value.string.text ? argument->value.string.text : "", argument->value.string.length);
+        argument->value.string.text = text ? text : "";
+        if (!text)
+            argument->value.string.length = 0;
+    }
+
+    context->diagnostics[context->diagnostic_count++] = report;
+}
+
+const context_source* context_find_source(rouleaux_context* context, const char* filename)
+{
+    return find_source(context, filename);
+}
+
+char* context_diagnostic_text(rouleaux_context* context, u64 index, void*(allocator)(u64 count, u64 stride))
+{
+    error_report report = context->diagnostics[index];
+
+    const char* line;
+    u64 line_length;
+    char* read_line;
+    diagnostic_line(context, report, &line, &line_length, &read_line);
+
+    u64 text_length = error_report_write_printable_text(report, line, line_length, NULL, 0);
+    char* text_buffer = allocator(text_length + 1, sizeof(char)); // +1 for the null terminator
+    error_report_write_printable_text(report, line, line_length, text_buffer, text_length + 1);
+    free(read_line);
+
+    return text_buffer;
+}
+
+char* context_diagnostics_text(rouleaux_context* context, void*(allocator)(u64 count, u64 stride))
+{
+    // Measure every diagnostic first, so they can all be written into one buffer
+    u64 total_length = 0;
+    for (u64 i = 0; i < context->diagnostic_count; ++i)
+    {
+        const char* line;
+        u64 line_length;
+        char* read_line;
+        diagnostic_line(context, context->diagnostics[i], &line, &line_length, &read_line);
+
+        total_length += error_report_write_printable_text(context->diagnostics[i], line, line_length, NULL, 0);
+        free(read_line);
+    }
+
+    char* text_buffer = allocator(total_length + 1, sizeof(char)); // +1 for the null terminator
+    if (!text_buffer)
+        return NULL;
+
+    u64 written = 0;
+    for (u64 i = 0; i < context->diagnostic_count; ++i)
+    {
+        const char* line;
+        u64 line_length;
+        char* read_line;
+        diagnostic_line(context, context->diagnostics[i], &line, &line_length, &read_line);
+
+        written += error_report_write_printable_text(context->diagnostics[i], line, line_length, text_buffer + written, total_length + 1 - written);
+        free(read_line);
+    }
+
+    return text_buffer;
+}
+
+
+b8 add_source(rouleaux_context* context, const char* filename, char* content, u64 length, b8 borrows_content)
+{
+    if (context->source_count >= context->source_capacity)
+    {
+        u64 new_capacity = context->source_capacity ? context->source_capacity * 2 : DEFAULT_CONTEXT_SOURCE_CAPACITY;
+        context_source* new_sources = malloc(new_capacity * sizeof(context_source));
+        if (!new_sources)
+            return false;
+
+        if (context->sources)
+            memcpy_s(new_sources, new_capacity * sizeof(context_source), context->sources, context->source_count * sizeof(context_source));
+
+        free(context->sources);
+        context->sources = new_sources;
+        context->source_capacity = new_capacity;
+    }
+
+    context_source* source = &context->sources[context->source_count++];
+    *source = (context_source){}; // The lines are only indexed once a diagnostic needs them
+    source->filename = filename;
+    source->content = content;
+    source->length = length;
+    source->borrows_content = borrows_content;
+
+    return true;
+}
+
+void report_stream_error(rouleaux_context* context, error_report report)
+{
+    const char* text = context_intern(context, report.faulted_token.text ? report.faulted_token.text : "", report.faulted_token.length);
+    report.faulted_token.text = text;
+    if (!text)
+        report.faulted_token.length = 0;
+
+    context_report_error(context, report);
+}
+
+context_source* find_source(rouleaux_context* context, const char* filename)
+{
+    if (!filename)
+        return NULL;
+
+    // Search from the newest source, so a file that was read again is found with its latest content
+    for (u64 i = context->source_count; i > 0; --i)
+    {
+        context_source* source = &context->sources[i - 1];
+        if (source->filename == filename || strcmp(source->filename, filename) == 0)
+            return source;
+    }
+
+    return NULL;
+}
+
+b8 diagnostic_line(rouleaux_context* context, error_report report, const char** out_line, u64* out_line_length, char** out_read_line)
+{
+    *out_read_line = NULL;
+
+    const char* filename = report.faulted_token.location.filename;
+    context_source* source = find_source(context, filename);
+    if (source && !source->lines.line_count)
+        source->lines = line_index_create(source->content, source->length);
+
+    // Only the faulted line is read back from a streamed file, so its diagnostics cost no more memory than the line
+    if (!source && filename)
+    {
+        *out_read_line = file_read_line(filename, report.faulted_token.location.row, out_line_length);
+        *out_line = *out_read_line;
+        if (*out_read_line)
+            return true;
+    }
+
+    if (!source || !line_index_get_line(&source->lines, report.faulted_token.location.row, out_line, out_line_length))
+    {
+        *out_line = "<File content is not available to generate error message>";
+        *out_line_length = strlen(*out_line);
+        return false;
+    }
+
+    return true;
+}
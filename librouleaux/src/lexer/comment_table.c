@@ -0,0 +1,116 @@
+#include "lexer/comment_table.h"
+
+#include <malloc.h>
+#include <string.h>
+
+#define DEFAULT_COMMENT_TABLE_CAPACITY 16
+#define DEFAULT_COMMENT_TABLE_RESIZE_FACTOR 2
+
+static b8 reallocate_buffer(comment_table* table, u32 resize_factor);
+
+comment_table comment_table_create(u64 capacity)
+{
+    comment_table table = {};
+    table.capacity = capacity ? capacity : DEFAULT_COMMENT_TABLE_CAPACITY;
+    table.size = 0;
+    table.entries = malloc(table.capacity * sizeof(comment_entry));
+
+    return table;
+}
+
+void comment_table_destroy(comment_table* table)
+{
+    if (table->entries)
+    {
+        free(table->entries);
+        table->entries = NULL;
+    }
+    table->size = 0;
+    table->capacity = 0;
+}
+
+void comment_table_empty(comment_table* table)
+{
+    table->size = 0;
+}
+
+b8 comment_table_push(comment_table* table, u64 offset, u64 length, u64 row)
+{
+    if (!table->entries)
+        *table = comment_table_create(DEFAULT_COMMENT_TABLE_CAPACITY);
+
+    // If we are about to overflow, realloc
+    if (table->size + 1 >= table->capacity)
+    {
+        if (!reallocate_buffer(table, DEFAULT_COMMENT_TABLE_RESIZE_FACTOR))
+            return false; // We failed to add the comment
+    }
+
+    comment_entry* entry = &table->entries[table->size];
+    entry->offset = offset;
+    entry->length = (u32)length;
+    entry->row = (u32)row;
+    table->size++;
+
+    return true;
+}
+
+u64 comment_table_lower_bound(comment_table* table, u64 offset)
+{
+    // The entries are pushed in the order the lexer finds them, so they are sorted by offset
+    u64 low = 0;
+    u64 high = table->size;
+    while (low < high)
+    {
+        u64 middle = low + (high - low) / 2;
+        if (table->entries[middle].offset < offset)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+
+    return low;
+}
+
+
+b8 comment_table_replace(comment_table* table, u64 first, u64 count, const comment_entry* entries, u64 entry_count)
+{
+    if (first + count > table->size)
+        return false;
+
+    if (!table->entries)
+        *table = comment_table_create(DEFAULT_COMMENT_TABLE_CAPACITY);
+
+    u64 new_size = table->size - count + entry_count;
+    while (new_size + 1 >= table->capacity)
+    {
+        if (!reallocate_buffer(table, DEFAULT_COMMENT_TABLE_RESIZE_FACTOR))
+            return false;
+    }
+
+    // Slide the entries after the range over to where they end up, then fill the gap
+    u64 tail_count = table->size - (first + count);
+    if (entry_count != count)
+        memmove(table->entries + first + entry_count, table->entries + first + count, tail_count * sizeof(comment_entry));
+    if (entry_count > 0)
+        memcpy(table->entries + first, entries, entry_count * sizeof(comment_entry));
+
+    table->size = new_size;
+    return true;
+}
+
+b8 reallocate_buffer(comment_table* table, u32 resize_factor)
+{
+    u64 new_capacity = table->capacity * resize_factor;
+    comment_entry* new_buffer = malloc(new_capacity * sizeof(comment_entry));
+
+    int error_code = memcpy_s(new_buffer, new_capacity * sizeof(comment_entry), table->entries, table->capacity * sizeof(comment_entry));
+    if (error_code)
+        return false; // we failed to copy the memory
+
+    free(table->entries);
+    table->entries = new_buffer;
+    table->capacity = new_capacity;
+
+    return true; // We successfully reallocated the table buffer
+}
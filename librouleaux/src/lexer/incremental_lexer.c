@@ -0,0 +1,319 @@
+#include "lexer/incremental_lexer.h"
+
+#include <malloc.h>
+#include <string.h>
+
+// The amount of tokens the re-lexed run is expected to hold, most edits touch a couple of tokens
+#define DEFAULT_RELEX_TOKEN_CAPACITY 16
+
+// Gives the index of the last token which starts at or before the offset
+static u64 token_at_offset(token_array* tokens, const char* base, u64 offset);
+
+// Gives the index of the first token which starts at or after the offset
+static u64 first_token_from_offset(token_array* tokens, const char* base, u64 offset);
+
+// Gives the location just past the end of a token's text
+static location location_after_token(token* t);
+
+// Makes the lexer own a buffer which can hold the given amount of bytes (and a trailing null), copies the old content over if it moves
+static char* reserve_file_content(rouleaux_lexer* lexer, u64 length, b8* out_moved);
+
+
+b8 lexer_apply_edit(rouleaux_lexer* lexer, token_array* tokens, text_edit edit, token_edit* out_change)
+{
+    // Only a lexer working off of its own buffer has text to edit
+    if (!lexer->file_content || lexer->replay_tokens || lexer->token_ring || tokens->size == 0)
+        return false;
+
+    if (edit.offset > lexer->file_content_length || edit.removed_length > lexer->file_content_length - edit.offset)
+        return false;
+
+    const char* old_base = lexer->file_content;
+    u64 old_length = lexer->file_content_length;
+    i64 byte_delta = (i64)edit.inserted_length - (i64)edit.removed_length;
+    u64 new_length = old_length + byte_delta;
+    u64 old_edit_end = edit.offset + edit.removed_length;
+    u64 new_edit_end = edit.offset + edit.inserted_length;
+
+    // Restart from before the token the edit lands in. A token can also change if the edit is within the characters the
+    // lexer looked at past its end (text inserted right after a token joins it, '1.' followed by a digit is a float...)
+    u64 first_token = token_at_offset(tokens, old_base, edit.offset);
+    while (first_token > 0)
+    {
+        token* previous = &tokens->tokens[first_token - 1];
+        if ((u64)(previous->text - old_base) + previous->length + LEXER_MAX_LOOKAHEAD <= edit.offset)
+            break;
+
+        first_token--;
+    }
+
+    // Lexing restarts right after the token before that, so the whitespace and comments in between are lexed again too
+    // (a comment running up to the end of the buffer is continued by text appended to the buffer)
+    u64 restart_offset = 0;
+    location restart_location = {};
+    restart_location.row = 1;
+    restart_location.column = 1;
+    if (first_token > 0)
+    {
+        token* previous = &tokens->tokens[first_token - 1];
+        restart_offset = (previous->text - old_base) + previous->length;
+        restart_location = location_after_token(previous);
+    }
+
+    // The first old token the re-lexed stream can line back up with
+    u64 sync_candidate = first_token_from_offset(tokens, old_base, old_edit_end);
+
+    // Edit the buffer, the old one is kept around until the old tokens are done being read if it has to move
+    b8 moved = false;
+    char* old_content = lexer->file_content;
+    b8 frees_old_content = !lexer->borrows_file_content;
+    char* new_base = reserve_file_content(lexer, new_length, &moved);
+    if (!new_base)
+        return false;
+
+    if (moved)
+    {
+        memcpy(new_base, old_content, edit.offset);
+        memcpy(new_base + new_edit_end, old_content + old_edit_end, old_length - old_edit_end);
+    }
+    else
+    {
+        memmove(new_base + new_edit_end, new_base + old_edit_end, old_length - old_edit_end);
+    }
+    memcpy(new_base + edit.offset, edit.inserted_text, edit.inserted_length);
+    new_base[new_length] = '\0';
+
+    lexer->file_content_length = new_length;
+    lexer->file_end = new_base + new_length;
+
+    // Put the lexer back where it was when it finished lexing the token before the restart
+    lexer->head = new_base + restart_offset;
+    lexer->current_row = restart_location.row;
+    lexer->current_column = restart_location.column;
+    lexer->has_error = false;
+    peek_queue_empty(&lexer->peek_buffer);
+
+    // The comments found while re-lexing are gathered on their own, and spliced into the table once the run is known
+    comment_table old_comments = lexer->comments;
+    lexer->comments = (comment_table){};
+
+    token_array relexed = token_array_create(DEFAULT_RELEX_TOKEN_CAPACITY);
+    b8 success = relexed.tokens != NULL;
+    b8 synced = false;
+    token sync_token = {};
+    while (success)
+    {
+        token t = lexer_next_token(lexer);
+        u64 new_offset = t.text - new_base;
+
+        // Lexing a token only depends on the text from where it starts, so once a token starts where an old token
+        // has moved to, every token from there on is the same as the old one
+        if (new_offset >= new_edit_end)
+        {
+            while (sync_candidate < tokens->size && (u64)((tokens->tokens[sync_candidate].text - old_base) + byte_delta) < new_offset)
+                sync_candidate++;
+
+            if (sync_candidate < tokens->size && (u64)((tokens->tokens[sync_candidate].text - old_base) + byte_delta) == new_offset)
+            {
+                synced = true;
+                sync_token = t;
+                break;
+            }
+        }
+
+        if (!token_array_push(&relexed, t))
+            success = false;
+
+        if (t.type == TOKEN_EOF || t.type == TOKEN_INVALID)
+            break;
+    }
+
+    // Without a sync point the re-lexed run replaces the whole rest of the stream
+    u64 sync_index = synced ? sync_candidate : tokens->size;
+    u64 sync_offset = synced ? (u64)(tokens->tokens[sync_index].text - old_base) : old_length;
+    i64 row_delta = 0;
+    u64 kept_row = 0;
+    i64 column_delta = 0;
+    if (synced)
+    {
+        // Only the tokens on the same row as the sync token move sideways (they all come right after it), the rows below only move up or down
+        token* old_sync_token = &tokens->tokens[sync_index];
+        kept_row = old_sync_token->location.row;
+        column_delta = (i64)sync_token.location.column - (i64)old_sync_token->location.column;
+        row_delta = (i64)sync_token.location.row - (i64)kept_row;
+
+        for (u64 i = sync_index; i < tokens->size && tokens->tokens[i].location.row == kept_row; ++i)
+            tokens->tokens[i].location.column += column_delta;
+
+        // tokens point straight into the buffer, so the tail is one pass of pointer and row fix ups, without any lexing
+        if (byte_delta != 0 || row_delta != 0 || moved)
+        {
+            for (u64 i = sync_index; i < tokens->size; ++i)
+            {
+                token* t = &tokens->tokens[i];
+                t->text = new_base + (t->text - old_base) + byte_delta;
+                t->location.row += row_delta;
+            }
+        }
+    }
+
+    // The tokens before the edit only need their text moved if the whole buffer moved
+    if (moved)
+    {
+        for (u64 i = 0; i < first_token; ++i)
+            tokens->tokens[i].text = new_base + (tokens->tokens[i].text - old_base);
+    }
+
+    // Splice the comments found while re-lexing in place of the ones the re-lexed run covered
+    comment_table relexed_comments = lexer->comments;
+    lexer->comments = old_comments;
+    if (success && (lexer->comments.size > 0 || relexed_comments.size > 0))
+    {
+        u64 first_comment = comment_table_lower_bound(&lexer->comments, restart_offset);
+        u64 end_comment = synced ? comment_table_lower_bound(&lexer->comments, sync_offset) : lexer->comments.size;
+        for (u64 i = end_comment; i < lexer->comments.size; ++i)
+        {
+            lexer->comments.entries[i].offset += byte_delta;
+            lexer->comments.entries[i].row += (i32)row_delta;
+        }
+
+        success = comment_table_replace(&lexer->comments, first_comment, end_comment - first_comment, relexed_comments.entries, relexed_comments.size);
+    }
+    comment_table_destroy(&relexed_comments);
+
+    if (success)
+        success = token_array_replace(tokens, first_token, sync_index - first_token, relexed.tokens, relexed.size);
+
+    // Leave the lexer at the end of the stream, like it was before the edit. The stream ends at its TOKEN_INVALID
+    // if the buffer has an error, which may be in the tail that was kept rather than in the re-lexed run
+    token last = tokens->tokens[tokens->size - 1];
+    lexer->has_error = last.type == TOKEN_INVALID;
+    if (success && last.type == TOKEN_EOF)
+    {
+        lexer->head = lexer->file_end;
+        lexer->current_row = last.location.row;
+        lexer->current_column = last.location.column;
+    }
+
+    if (out_change)
+    {
+        out_change->first_token = first_token;
+        out_change->removed_token_count = sync_index - first_token;
+        out_change->inserted_token_count = relexed.size;
+        out_change->byte_delta = byte_delta;
+        out_change->row_delta = row_delta;
+        out_change->old_content = old_base;
+        out_change->old_length = old_length;
+        out_change->new_content = new_base;
+        out_change->relexed_offset = restart_offset;
+        out_change->kept_offset = synced ? sync_offset : old_length + 1; // Nothing was kept without a sync point
+        out_change->kept_row = synced ? kept_row : 0;
+        out_change->column_delta = synced ? column_delta : 0;
+    }
+
+    token_array_destroy(&relexed);
+    if (moved && frees_old_content)
+        free(old_content);
+
+    return success;
+}
+
+
+b8 token_edit_move_token(const token_edit* change, token* t)
+{
+    // the old buffer may be gone, so addresses are only compared as numbers
+    u64 old_start = (u64)change->old_content;
+    u64 text = (u64)t->text;
+    if (text < old_start || text > old_start + change->old_length)
+        return true; // Not a token of the edited buffer
+
+    u64 offset = text - old_start;
+    if (offset < change->relexed_offset)
+    {
+        // Tokens before the re-lexed run stay where they are, but the whole buffer may have moved
+        t->text = change->new_content + offset;
+        return true;
+    }
+
+    if (offset >= change->kept_offset)
+    {
+        if (t->location.row == change->kept_row)
+            t->location.column += change->column_delta;
+        t->location.row += change->row_delta;
+        t->text = change->new_content + offset + change->byte_delta;
+        return true;
+    }
+
+    return false;
+}
+
+
+u64 token_at_offset(token_array* tokens, const char* base, u64 offset)
+{
+    // Tokens are lexed front to back, so they are sorted by where their text starts
+    u64 low = 0;
+    u64 high = tokens->size;
+    while (low < high)
+    {
+        u64 middle = low + (high - low) / 2;
+        if ((u64)(tokens->tokens[middle].text - base) <= offset)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+
+    return low > 0 ? low - 1 : 0;
+}
+
+u64 first_token_from_offset(token_array* tokens, const char* base, u64 offset)
+{
+    u64 low = 0;
+    u64 high = tokens->size;
+    while (low < high)
+    {
+        u64 middle = low + (high - low) / 2;
+        if ((u64)(tokens->tokens[middle].text - base) < offset)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+
+    return low;
+}
+
+location location_after_token(token* t)
+{
+    // Walks the text the same way the lexer's skip_char() does
+    location loc = t->location;
+    for (u64 i = 0; i < t->length; ++i)
+    {
+        loc.column++;
+        if (t->text[i] == '\n')
+        {
+            loc.row++;
+            loc.column = 1;
+        }
+    }
+
+    return loc;
+}
+
+char* reserve_file_content(rouleaux_lexer* lexer, u64 length, b8* out_moved)
+{
+    *out_moved = false;
+    if (!lexer->borrows_file_content && length + 1 <= lexer->file_content_capacity)
+        return lexer->file_content;
+
+    // Leave room to grow, so typing into the buffer doesn't reallocate it on every keystroke
+    u64 new_capacity = (length + 1) + (length + 1) / 2;
+    char* new_content = malloc(new_capacity);
+    if (!new_content)
+        return NULL;
+
+    lexer->file_content = new_content;
+    lexer->file_content_capacity = new_capacity;
+    lexer->borrows_file_content = false;
+    *out_moved = true;
+
+    return new_content;
+}
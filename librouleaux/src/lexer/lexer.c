@@ -1,418 +1,778 @@
-#include "lexer/lexer.h"
-#include "utilities/file_utilities.h"
-
-#include <assert.h>
-#include <malloc.h>
-#include <stdio.h>
-#include <string.h>
-#include <stdlib.h>
-
-/**
- * @brief This is an internal function that performs the lexing of the next token without checking the peek_queue
- * 
- * @param lexer the lexer to be operated on
- * @return token the nex token this lexer found
- */
-token lexer_next_token_internal(rouleaux_lexer* lexer);
-
-location current_location(rouleaux_lexer* lexer);
-b8 head_is_at_eof(rouleaux_lexer* lexer);
-void skip_char(rouleaux_lexer* lexer, u64 n);
-void trim_left(rouleaux_lexer* lexer);
-
-b8 is_whitespace(char c);
-b8 is_single_char_token(char c);
-b8 is_identifier_character(char c, b8 include_numerics);
-b8 is_numeric_character(char c);
-
-b8 check_for_keyword(token* t);
-
-
-
-rouleaux_lexer lexer_create(const char* filename)
-{
-    rouleaux_lexer lexer = {};
-    lexer.filename = filename;
-    lexer.current_row = 1;
-    lexer.current_column = 1;
-
-    u64 bytes_read = file_read(filename, &lexer.file_content_length, lexer.file_content);
-    lexer.file_content = malloc(lexer.file_content_length);
-    bytes_read = file_read(lexer.filename, &lexer.file_content_length, lexer.file_content);
-    if (!bytes_read)
-    {
-        printf("lexer error: unable to read file '%s'", filename);
-        free(lexer.file_content);
-        lexer.file_content = NULL;
-        lexer.has_error = true;
-        return lexer;
-    }
-
-    // NOTE(Steven): Because it's a text file, the bytes_read could be smaller
-    //               then the filesize because of CRLF translation
-    lexer.file_content_length = bytes_read;
-    lexer.file_end = lexer.file_content + lexer.file_content_length;
-
-    lexer.head = lexer.file_content;
-
-    // Initialize the peek_queue
-    lexer.peek_buffer = peek_queue_create(32); //TODO(Steven): Reconsider the defaults... maybe we should expose this to the user?
-
-    return lexer;
-}
-
-void lexer_destroy(rouleaux_lexer* lexer)
-{
-    if (lexer->file_content)
-    {
-        free(lexer->file_content);
-        lexer->file_content = NULL;
-    }
-
-    peek_queue_destroy(&lexer->peek_buffer);
-
-    memset(lexer, 0, sizeof(rouleaux_lexer));
-}
-
-b8 lexer_reset(rouleaux_lexer* lexer)
-{
-    lexer->head = lexer->file_content;
-    lexer->current_column = 1;
-    lexer->current_row = 1;
-    lexer->has_error = false;
-
-    peek_queue_empty(&lexer->peek_buffer);
-
-    return true;
-}
-
-token lexer_next_token(rouleaux_lexer* lexer)
-{
-    // If the peek_buffer has tokens in it already we need to grab those first
-    if (lexer->peek_buffer.size > 0)
-    {
-        token t;
-        peek_queue_pop(&lexer->peek_buffer, &t);
-        return t;
-    }
-
-    return lexer_next_token_internal(lexer);
-}
-
-token lexer_peek_token(rouleaux_lexer* lexer)
-{
-    token t;
-
-    // If the peek_buffer has tokens in it already we need to grab those first
-    if (lexer->peek_buffer.size > 0)
-    {
-        peek_queue_front(&lexer->peek_buffer, &t);
-        return t;
-    }
-
-    // There were no cached tokens, so we need to go lex one
-    t = lexer_next_token(lexer);
-
-    // Push the token into the peek_queue
-    peek_queue_push(&lexer->peek_buffer, t);
-
-    return t;
-}
-
-b8 lexer_put_back_token(rouleaux_lexer* lexer, token t)
-{
-    return peek_queue_push_front(&lexer->peek_buffer, t);
-}
-
-token lexer_next_token_internal(rouleaux_lexer* lexer)
-{
-    // Get rid of the whitespace
-    trim_left(lexer);
-
-    token t = {};
-    t.location = current_location(lexer);
-    t.text = lexer->head;
-    t.length = 0;
-    
-    if (head_is_at_eof(lexer))
-    {
-        t.type = TOKEN_EOF;
-        return t;
-    }
-
-    // Identifiers & keywords
-    if (is_identifier_character(*lexer->head, false))
-    {
-        do {
-            skip_char(lexer, 1);
-            t.length++;
-        } while (is_identifier_character(*lexer->head, true));
-
-        t.type = TOKEN_IDENTIFIER;
-        check_for_keyword(&t); // If its a keyword token, change it to that token type
-        return t; // return the identifier/keyword token
-    }
-
-    // Numbers that start with a numeric
-    if (is_numeric_character(*lexer->head))
-    {
-        skip_char(lexer, 1);
-        t.length++;
-        t.type = TOKEN_INTEGER_LITERAL;
-        while (is_numeric_character(*lexer->head))
-        {
-            skip_char(lexer, 1);
-            t.length++;
-        }
-
-        // @BumpAllocator
-        char* token_text = token_printable_text(t, calloc);
-        char* ignored = NULL;
-        t.value.unsigned64 = strtoull(token_text, &ignored, 10);
-        free(token_text);
-
-        if (*lexer->head == '.' && is_numeric_character(*(lexer->head + 1)))
-        {
-            // We found a decimal point followed by more numerics, this must be a float literal
-            t.type = TOKEN_FLOAT_LITERAL;
-            skip_char(lexer, 1);
-            t.length++;
-            while (is_numeric_character(*lexer->head))
-            {
-                skip_char(lexer, 1);
-                t.length++;
-            }
-
-            // @BumpAllocator
-            char* token_text = token_printable_text(t, calloc);
-            char* ignored = NULL;
-            t.value.float64 = strtold(token_text, &ignored);
-            free(token_text);
-        }
-        return t; // return the 'number literal' token
-    }
-
-    // String Literals //
-    if (*lexer->head == '"')
-    {
-        t.type = TOKEN_STRING_LITERAL;
-        skip_char(lexer, 1);
-        t.length++;
-        
-        while (!head_is_at_eof(lexer) && *lexer->head != '"')
-        {
-            skip_char(lexer, 1);
-            t.length++;
-        }
-
-        if (head_is_at_eof(lexer))
-        {
-            // We could not finish parsing this token, so we flag the error and exit
-            lexer->has_error = true;
-            t.type = TOKEN_INVALID;
-            return t;
-        }
-
-        skip_char(lexer, 1);
-        t.length++;
-
-        return t;
-    }
-
-    // Line Comments '//'
-    if (*lexer->head == '/' && *(lexer->head + 1) == '/')
-    {
-        // This is a line comment and we can keep eating till the end of the line
-        t.type = TOKEN_LINE_COMMENT;
-        skip_char(lexer, 2);
-        t.length += 2; // Skip the two slashes
-
-        while (!head_is_at_eof(lexer) && *lexer->head != '\n')
-        {
-            skip_char(lexer, 1);
-            t.length++;
-        }
-
-        return t;
-    }
-
-    // Block Comments '/**/'
-    if (*lexer->head == '/' && *(lexer->head + 1) == '*')
-    {
-        // This is a block comment, keep eating characters until you see a
-        // new opening block comment, or the close to this one
-        t.type = TOKEN_BLOCK_COMMENT;
-        skip_char(lexer, 2);
-        t.length += 2;
-
-        while (!head_is_at_eof(lexer) && !(*lexer->head == '*' && *(lexer->head + 1) == '/'))
-        {
-            skip_char(lexer, 1);
-            t.length++;
-        }
-
-        if (head_is_at_eof(lexer))
-        {
-            // We could not finish parsing this token, so we flag the error and exit
-            lexer->has_error = true;
-            t.type = TOKEN_INVALID;
-            return t;
-        }
-        // If we are not at the EOF we hit the closing symbol and can wrap up
-        // This is the closing of the current block comment
-        skip_char(lexer, 2);
-        t.length += 2;
-
-        return t;
-    }
-
-
-    // Punctuation & Single character operators
-    if (is_single_char_token(*lexer->head))
-    {
-        t.type = *lexer->head; // The token_type will map directly from ASCII for single character tokens
-
-        skip_char(lexer, 1);
-        t.length++;
-
-        // Don't return yet, we might want to augment the
-        // token type based on the next character still
-    }
-
-    // TODO(Steven): Multi-Character operators?
-    if (t.type == TOKEN_MINUS && *lexer->head == '>')
-    {
-        skip_char(lexer, 1);
-        t.length++;
-        t.type = TOKEN_ARROW;
-    }
-    
-    return t;
-}
-
-location current_location(rouleaux_lexer* lexer)
-{
-    location loc = {};
-    loc.row      = lexer->current_row;
-    loc.column   = lexer->current_column;
-    loc.filename = lexer->filename;
-
-    return loc;
-}
-
-b8 head_is_at_eof(rouleaux_lexer* lexer)
-{
-    return lexer->head >= lexer->file_end;
-}
-
-void skip_char(rouleaux_lexer* lexer, u64 n)
-{
-    assert(!head_is_at_eof(lexer));
-    for (u64 i = 0; i < n; ++i)
-    {
-        lexer->current_column++;
-        if (*lexer->head == '\n')
-        {
-            lexer->current_row++;
-            lexer->current_column = 1;
-        }
-        
-        lexer->head++;
-    }
-}
-
-void trim_left(rouleaux_lexer* lexer)
-{
-    while (!head_is_at_eof(lexer) && is_whitespace(*lexer->head))
-    {
-        skip_char(lexer, 1);
-    }
-}
-
-b8 is_whitespace(char c)
-{
-    b8 is_space_or_tab = c == ' ' || c == '\t';
-    b8 is_newline_or_carriage_return = c == '\n' || c == '\r';
-    b8 is_vertical_tab_or_formfeed = c == '\v' || c == '\f';
-
-    return is_space_or_tab || is_newline_or_carriage_return || is_vertical_tab_or_formfeed;
-}
-
-b8 is_single_char_token(char c)
-{
-    switch (c)
-    {
-        case TOKEN_EXCLAMATION:
-        case TOKEN_DOUBLE_QUOTE:
-        case TOKEN_POUND:
-        case TOKEN_DOLLAR_SIGN:
-        case TOKEN_PERCENT:
-        case TOKEN_AMPERSAND:
-        case TOKEN_SINGLE_QUOTE:
-        case TOKEN_LEFT_PAREN:
-        case TOKEN_RIGHT_PAREN:
-        case TOKEN_ASTERISK:
-        case TOKEN_PLUS:
-        case TOKEN_COMMA:
-        case TOKEN_MINUS:
-        case TOKEN_PERIOD:
-        case TOKEN_FORWARD_SLASH:
-        case TOKEN_COLON:
-        case TOKEN_SEMICOLON:
-        case TOKEN_LESS_THAN:
-        case TOKEN_EQUALS:
-        case TOKEN_GREATER_THAN:
-        case TOKEN_QUESTION_MARK:
-        case TOKEN_AT_SIGN:
-        case TOKEN_LEFT_BRACKET:
-        case TOKEN_BACK_SLASH:
-        case TOKEN_RIGHT_BRACKET:
-        case TOKEN_CARET:
-        case TOKEN_UNDERSCORE:
-        case TOKEN_GRAVE:
-        case TOKEN_LEFT_CURLY:
-        case TOKEN_VERTICAL_BAR:
-        case TOKEN_RIGHT_CURLY:
-        case TOKEN_TILDE:
-            return true;
-    };
-
-    return false;
-}
-
-b8 is_identifier_character(char c, b8 include_numerics)
-{
-    b8 is_uppercase = c >= 'A' && c <= 'Z';
-    b8 is_lowercase = c >= 'a' && c <= 'z';
-    b8 is_underscore = c == '_';
-    b8 is_numeric = false;
-
-    if (include_numerics)
-        is_numeric = c >= '0' && c <= '9';
-
-    return is_uppercase || is_lowercase || is_underscore || is_numeric;
-}
-
-b8 is_numeric_character(char c)
-{
-    b8 is_numeric = c >= '0' && c <= '9';
-
-    return is_numeric;
-}
-
-
-b8 check_for_keyword(token* t)
-{
-    b8 matched = false;
-    // NOTE: Starts at 1 to offset from the TOKEN_INVALID token_type, and goes till the end of the keywords array
-    for (u64 i = 1; i < keywords_array_length(); ++i)
-    {
-        if (memcmp(t->text, keywords[i], t->length) == 0)
-        {
-            t->type = (token_type)i; // make the token the specific keyword type we matched with
-            matched = true;
-            break;
-        }
-    }
-    return matched;
+#include "lexer/lexer.h"
+#include "utilities/file_utilities.h"
+
+#include <assert.h>
+#include <malloc.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+/**
+ * @brief This is an internal function that performs the lexing of the next token without checking the peek_queue
+ * 
+ * @param lexer the lexer to be operated on
+ * @return token the nex token this lexer found
+ */
+token lexer_next_token_internal(rouleaux_lexer* lexer);
+
+// Lexes the next token, skipping over (and possibly recording) comments if the lexer's comment_mode asks for it
+token lexer_next_significant_token(rouleaux_lexer* lexer);
+
+// Lexes the next token of a streaming lexer, reading more of the stream first if the token could run past the window
+token lexer_next_streamed_token(rouleaux_lexer* lexer);
+
+// Reads more of the stream into a new window, carrying over everything from keep_from on. Returns false at the end of the stream
+b8 refill_window(rouleaux_lexer* lexer, char* keep_from);
+
+// Gives the position in the stream of a pointer into the current window, or into one of the retired ones
+u64 stream_position(rouleaux_lexer* lexer, const char* text);
+
+location current_location(rouleaux_lexer* lexer);
+b8 head_is_at_eof(rouleaux_lexer* lexer);
+// Gives the character offset characters past the head, or '\0' if that is past the end of the file_content
+char peek_char(rouleaux_lexer* lexer, u64 offset);
+void skip_char(rouleaux_lexer* lexer, u64 n);
+void trim_left(rouleaux_lexer* lexer);
+
+b8 is_whitespace(char c);
+b8 is_single_char_token(char c);
+b8 is_identifier_character(char c, b8 include_numerics);
+b8 is_numeric_character(char c);
+
+b8 check_for_keyword(token* t);
+
+
+
+rouleaux_lexer lexer_create(const char* filename)
+{
+    rouleaux_lexer lexer = {};
+    lexer.filename = filename;
+    lexer.current_row = 1;
+    lexer.current_column = 1;
+
+    u64 bytes_read = file_read(filename, &lexer.file_content_length, lexer.file_content);
+    lexer.file_content = malloc(lexer.file_content_length);
+    lexer.file_content_capacity = lexer.file_content_length;
+    bytes_read = file_read(lexer.filename, &lexer.file_content_length, lexer.file_content);
+    if (!bytes_read)
+    {
+        // The library never prints, the caller finds out through has_error
+        free(lexer.file_content);
+        lexer.file_content = NULL;
+        lexer.has_error = true;
+        return lexer;
+    }
+
+    // NOTE(Steven): Because it's a text file, the bytes_read could be smaller
+    //               then the filesize because of CRLF translation
+    lexer.file_content_length = bytes_read;
+    lexer.file_end = lexer.file_content + lexer.file_content_length;
+
+    lexer.head = lexer.file_content;
+
+    // Initialize the peek_queue
+    lexer.peek_buffer = peek_queue_create(32); //TODO(Steven): Reconsider the defaults... maybe we should expose this to the user?
+
+    return lexer;
+}
+
+rouleaux_lexer lexer_create_from_tokens(const token* tokens, u64 token_count, const char* filename)
+{
+    rouleaux_lexer lexer = {};
+    lexer.filename = filename;
+    lexer.current_row = 1;
+    lexer.current_column = 1;
+
+    lexer.replay_tokens = tokens;
+    lexer.replay_token_count = token_count;
+    lexer.replay_position = 0;
+
+    lexer.peek_buffer = peek_queue_create(32);
+
+    return lexer;
+}
+
+rouleaux_lexer lexer_create_from_buffer(const char* buffer, u64 length, const char* name)
+{
+    rouleaux_lexer lexer = {};
+    lexer.filename = name;
+    lexer.current_row = 1;
+    lexer.current_column = 1;
+
+    // The lexer only ever reads from a borrowed buffer, edits copy it before changing anything
+    lexer.file_content = (char*)buffer;
+    lexer.file_content_length = length;
+    lexer.file_content_capacity = length;
+    lexer.file_end = lexer.file_content + lexer.file_content_length;
+    lexer.borrows_file_content = true;
+
+    lexer.head = lexer.file_content;
+
+    lexer.peek_buffer = peek_queue_create(32);
+
+    return lexer;
+}
+
+rouleaux_lexer lexer_create_from_stream(const char* filename, lexer_read_fptr read, void* user_data, u64 chunk_size)
+{
+    rouleaux_lexer lexer = {};
+    lexer.filename = filename;
+    lexer.current_row = 1;
+    lexer.current_column = 1;
+
+    lexer.stream = calloc(1, sizeof(lexer_stream));
+    // The window starts out empty, the first token reads the first chunk
+    lexer.file_content = calloc(1, sizeof(char));
+    if (!lexer.stream || !lexer.file_content)
+    {
+        free(lexer.stream);
+        free(lexer.file_content);
+        lexer.stream = NULL;
+        lexer.file_content = NULL;
+        lexer.has_error = true;
+        return lexer;
+    }
+
+    lexer.stream->read = read;
+    lexer.stream->user_data = user_data;
+    lexer.stream->chunk_size = chunk_size ? chunk_size : DEFAULT_LEXER_STREAM_CHUNK_SIZE;
+    lexer.stream->keep = lexer.file_content;
+
+    lexer.file_end = lexer.file_content;
+    lexer.head = lexer.file_content;
+
+    lexer.peek_buffer = peek_queue_create(32);
+
+    return lexer;
+}
+
+void lexer_release_stream(rouleaux_lexer* lexer)
+{
+    lexer_stream* stream = lexer->stream;
+    if (!stream)
+        return;
+
+    // A token that was put back can still point into an old window, the peeked tokens are the only ones that move
+    // over to the current window. Everything they need was carried over, as they were handed out after the last release
+    stream->keep = lexer->head;
+    for (u64 i = 0; i < lexer->peek_buffer.size; ++i)
+    {
+        token* t = &lexer->peek_buffer.buffer[i];
+        t->text = lexer->file_content + (stream_position(lexer, t->text) - stream->window_offset);
+
+        if (t->text < stream->keep)
+            stream->keep = (char*)t->text;
+    }
+
+    for (u64 i = 0; i < stream->retired_window_count; ++i)
+        free(stream->retired_windows[i].content);
+    stream->retired_window_count = 0;
+}
+
+void lexer_destroy(rouleaux_lexer* lexer)
+{
+    if (lexer->file_content && !lexer->borrows_file_content)
+    {
+        free(lexer->file_content);
+        lexer->file_content = NULL;
+    }
+
+    if (lexer->stream)
+    {
+        for (u64 i = 0; i < lexer->stream->retired_window_count; ++i)
+            free(lexer->stream->retired_windows[i].content);
+
+        free(lexer->stream->retired_windows);
+        free(lexer->stream);
+        lexer->stream = NULL;
+    }
+
+    peek_queue_destroy(&lexer->peek_buffer);
+    comment_table_destroy(&lexer->comments);
+
+    memset(lexer, 0, sizeof(rouleaux_lexer));
+}
+
+b8 lexer_reset(rouleaux_lexer* lexer)
+{
+    lexer->head = lexer->file_content;
+    lexer->current_column = 1;
+    lexer->current_row = 1;
+    lexer->has_error = false;
+    lexer->replay_position = 0;
+
+    peek_queue_empty(&lexer->peek_buffer);
+    comment_table_empty(&lexer->comments);
+
+    return true;
+}
+
+token lexer_next_token(rouleaux_lexer* lexer)
+{
+    // If the peek_buffer has tokens in it already we need to grab those first
+    if (lexer->peek_buffer.size > 0)
+    {
+        token t;
+        peek_queue_pop(&lexer->peek_buffer, &t);
+        return t;
+    }
+
+    return lexer_next_significant_token(lexer);
+}
+
+token lexer_peek_token(rouleaux_lexer* lexer)
+{
+    token t;
+
+    // If the peek_buffer has tokens in it already we need to grab those first
+    if (lexer->peek_buffer.size > 0)
+    {
+        peek_queue_front(&lexer->peek_buffer, &t);
+        return t;
+    }
+
+    // The token_ring can be peeked into directly, so the token doesn't need to go through the peek_queue
+    if (lexer->token_ring)
+    {
+        token_ring_peek(lexer->token_ring, &t);
+        return t;
+    }
+
+    // There were no cached tokens, so we need to go lex one
+    t = lexer_next_token(lexer);
+
+    // Push the token into the peek_queue
+    peek_queue_push(&lexer->peek_buffer, t);
+
+    return t;
+}
+
+b8 lexer_put_back_token(rouleaux_lexer* lexer, token t)
+{
+    // Tokens are put back in the reverse order they were taken, so most of the time the ring can just step back
+    if (lexer->token_ring && lexer->peek_buffer.size == 0 && token_ring_put_back(lexer->token_ring, t))
+        return true;
+
+    return peek_queue_push_front(&lexer->peek_buffer, t);
+}
+
+b8 lexer_checkpoint(rouleaux_lexer* lexer, u64* out_checkpoint)
+{
+    // Tokens in the peek_queue are not a part of the ring's position
+    if (!lexer->token_ring || lexer->peek_buffer.size > 0)
+        return false;
+
+    *out_checkpoint = token_ring_checkpoint(lexer->token_ring);
+    return true;
+}
+
+b8 lexer_rewind(rouleaux_lexer* lexer, u64 checkpoint)
+{
+    if (!lexer->token_ring)
+        return false;
+
+    peek_queue_empty(&lexer->peek_buffer);
+    return token_ring_rewind(lexer->token_ring, checkpoint);
+}
+
+void lexer_set_comment_mode(rouleaux_lexer* lexer, comment_mode mode)
+{
+    lexer->comment_mode = mode;
+}
+
+token lexer_comment_token(rouleaux_lexer* lexer, u64 index)
+{
+    assert(index < lexer->comments.size);
+    comment_entry entry = lexer->comments.entries[index];
+
+    token t = {};
+    t.text = lexer->file_content + entry.offset;
+    t.length = entry.length;
+    t.type = (t.text[1] == '*') ? TOKEN_BLOCK_COMMENT : TOKEN_LINE_COMMENT;
+    t.location.filename = lexer->filename;
+    t.location.row = entry.row;
+
+    // Only the row is recorded, the column is the distance back to the start of the line
+    const char* line_start = t.text;
+    while (line_start > lexer->file_content && *(line_start - 1) != '\n')
+        line_start--;
+    t.location.column = (t.text - line_start) + 1;
+
+    return t;
+}
+
+b8 lexer_tokenize(rouleaux_lexer* lexer, token_array* out_tokens)
+{
+    token t;
+    do {
+        t = lexer_next_token(lexer);
+        if (!token_array_push(out_tokens, t))
+            return false;
+
+    } while (t.type != TOKEN_EOF && t.type != TOKEN_INVALID);
+
+    return true;
+}
+
+token lexer_next_significant_token(rouleaux_lexer* lexer)
+{
+    if (lexer->token_ring)
+    {
+        // The lexing thread already applied the comment_mode. Once it is done, the last token (TOKEN_EOF) is repeated
+        token t;
+        token_ring_pop(lexer->token_ring, &t);
+        return t;
+    }
+
+    if (lexer->replay_tokens)
+    {
+        if (lexer->replay_position < lexer->replay_token_count)
+            return lexer->replay_tokens[lexer->replay_position++];
+
+        // We ran out of tokens to replay, so this is the end of the stream
+        token eof = {};
+        eof.type = TOKEN_EOF;
+        eof.location.filename = lexer->filename;
+        if (lexer->replay_token_count > 0)
+        {
+            token last = lexer->replay_tokens[lexer->replay_token_count - 1];
+            eof.location = last.location;
+            eof.text = last.text + last.length;
+        }
+        return eof;
+    }
+
+    token t = lexer->stream ? lexer_next_streamed_token(lexer) : lexer_next_token_internal(lexer);
+    if (lexer->comment_mode == COMMENT_MODE_TOKENS)
+        return t;
+
+    while (t.type == TOKEN_LINE_COMMENT || t.type == TOKEN_BLOCK_COMMENT)
+    {
+        // The offsets of a stream's comments would point into windows that are long gone
+        if (lexer->comment_mode == COMMENT_MODE_SIDE_TABLE && !lexer->stream)
+            comment_table_push(&lexer->comments, t.text - lexer->file_content, t.length, t.location.row);
+
+        t = lexer->stream ? lexer_next_streamed_token(lexer) : lexer_next_token_internal(lexer);
+    }
+
+    return t;
+}
+
+token lexer_next_streamed_token(rouleaux_lexer* lexer)
+{
+    while (true)
+    {
+        char* start = lexer->head;
+        u64 row = lexer->current_row;
+        u64 column = lexer->current_column;
+        b8 had_error = lexer->has_error;
+
+        token t = lexer_next_token_internal(lexer);
+
+        // A token this close to the end of the window might go on in the part of the stream that was not read yet
+        if (lexer->stream->done || (u64)(lexer->file_end - lexer->head) >= LEXER_MAX_LOOKAHEAD)
+            return t;
+
+        // Lex the token again once there is more of the stream in the window
+        lexer->head = start;
+        lexer->current_row = row;
+        lexer->current_column = column;
+        lexer->has_error = had_error;
+
+        refill_window(lexer, start);
+    }
+}
+
+b8 refill_window(rouleaux_lexer* lexer, char* keep_from)
+{
+    lexer_stream* stream = lexer->stream;
+    if (stream->keep < keep_from)
+        keep_from = stream->keep;
+
+    if (stream->retired_window_count >= stream->retired_window_capacity)
+    {
+        u64 new_capacity = stream->retired_window_capacity ? stream->retired_window_capacity * 2 : 4;
+        lexer_stream_window* new_windows = malloc(new_capacity * sizeof(lexer_stream_window));
+        if (!new_windows)
+        {
+            // Without a new window, the lexer has to make do with what it has
+            lexer->has_error = true;
+            stream->done = true;
+            return false;
+        }
+
+        if (stream->retired_windows)
+            memcpy_s(new_windows, new_capacity * sizeof(lexer_stream_window), stream->retired_windows, stream->retired_window_count * sizeof(lexer_stream_window));
+
+        free(stream->retired_windows);
+        stream->retired_windows = new_windows;
+        stream->retired_window_capacity = new_capacity;
+    }
+
+    // The window at least doubles with what it carries over, so a statement that keeps growing the
+    // window only ever costs twice its size in copies
+    u64 kept_length = lexer->file_end - keep_from;
+    u64 read_length = kept_length > stream->chunk_size ? kept_length : stream->chunk_size;
+    char* window = malloc(kept_length + read_length + 1);
+    if (!window)
+    {
+        lexer->has_error = true;
+        stream->done = true;
+        return false;
+    }
+
+    memcpy_s(window, kept_length + read_length + 1, keep_from, kept_length);
+    u64 bytes_read = stream->read(stream->user_data, window + kept_length, read_length);
+    if (bytes_read == 0)
+    {
+        free(window);
+        stream->done = true;
+        return false;
+    }
+
+    // The lexer peeks a character past the end of some tokens, it finds the null terminator instead of garbage
+    window[kept_length + bytes_read] = '\0';
+
+    // The tokens already handed out keep pointing into the old windows, but the peeked ones move over to the new one
+    u64 new_window_offset = stream->window_offset + (keep_from - lexer->file_content);
+    for (u64 i = 0; i < lexer->peek_buffer.size; ++i)
+    {
+        token* t = &lexer->peek_buffer.buffer[i];
+        t->text = window + (stream_position(lexer, t->text) - new_window_offset);
+    }
+
+    lexer->head = window + (lexer->head - keep_from);
+    stream->keep = window + (stream->keep - keep_from);
+
+    lexer_stream_window* retired = &stream->retired_windows[stream->retired_window_count++];
+    retired->content = lexer->file_content;
+    retired->offset = stream->window_offset;
+    retired->length = lexer->file_content_length;
+    stream->window_offset = new_window_offset;
+
+    lexer->file_content = window;
+    lexer->file_content_length = kept_length + bytes_read;
+    lexer->file_content_capacity = kept_length + read_length + 1;
+    lexer->file_end = window + lexer->file_content_length;
+
+    return true;
+}
+
+u64 stream_position(rouleaux_lexer* lexer, const char* text)
+{
+    lexer_stream* stream = lexer->stream;
+    if (text >= lexer->file_content && text <= lexer->file_end)
+        return stream->window_offset + (text - lexer->file_content);
+
+    for (u64 i = stream->retired_window_count; i > 0; --i)
+    {
+        lexer_stream_window* window = &stream->retired_windows[i - 1];
+        if (text >= window->content && text <= window->content + window->length)
+            return window->offset + (text - window->content);
+    }
+
+    // Not a part of the stream, which no token the lexer handed out can be
+    return stream->window_offset;
+}
+
+token lexer_next_token_internal(rouleaux_lexer* lexer)
+{
+    // Get rid of the whitespace
+    trim_left(lexer);
+
+    token t = {};
+    t.location = current_location(lexer);
+    t.text = lexer->head;
+    t.length = 0;
+    
+    if (head_is_at_eof(lexer))
+    {
+        t.type = TOKEN_EOF;
+        return t;
+    }
+
+    // Identifiers & keywords
+    if (is_identifier_character(*lexer->head, false))
+    {
+        do {
+            skip_char(lexer, 1);
+            t.length++;
+        } while (is_identifier_character(peek_char(lexer, 0), true));
+
+        t.type = TOKEN_IDENTIFIER;
+        check_for_keyword(&t); // If its a keyword token, change it to that token type
+        return t; // return the identifier/keyword token
+    }
+
+    // Numbers that start with a numeric
+    if (is_numeric_character(*lexer->head))
+    {
+        skip_char(lexer, 1);
+        t.length++;
+        t.type = TOKEN_INTEGER_LITERAL;
+        while (is_numeric_character(peek_char(lexer, 0)))
+        {
+            skip_char(lexer, 1);
+            t.length++;
+        }
+
+        // @BumpAllocator
+        char* token_text = token_printable_text(t, calloc);
+        char* ignored = NULL;
+        t.value.unsigned64 = strtoull(token_text, &ignored, 10);
+        free(token_text);
+
+        if (peek_char(lexer, 0) == '.' && is_numeric_character(peek_char(lexer, 1)))
+        {
+            // We found a decimal point followed by more numerics, this must be a float literal
+            t.type = TOKEN_FLOAT_LITERAL;
+            skip_char(lexer, 1);
+            t.length++;
+            while (is_numeric_character(peek_char(lexer, 0)))
+            {
+                skip_char(lexer, 1);
+                t.length++;
+            }
+
+            // @BumpAllocator
+            char* token_text = token_printable_text(t, calloc);
+            char* ignored = NULL;
+            t.value.float64 = strtold(token_text, &ignored);
+            free(token_text);
+        }
+        return t; // return the 'number literal' token
+    }
+
+    // String Literals //
+    if (*lexer->head == '"')
+    {
+        t.type = TOKEN_STRING_LITERAL;
+        skip_char(lexer, 1);
+        t.length++;
+        
+        while (!head_is_at_eof(lexer) && *lexer->head != '"')
+        {
+            skip_char(lexer, 1);
+            t.length++;
+        }
+
+        if (head_is_at_eof(lexer))
+        {
+            // We could not finish parsing this token, so we flag the error and exit
+            lexer->has_error = true;
+            t.type = TOKEN_INVALID;
+            return t;
+        }
+
+        skip_char(lexer, 1);
+        t.length++;
+
+        return t;
+    }
+
+    // Line Comments '//'
+    if (*lexer->head == '/' && peek_char(lexer, 1) == '/')
+    {
+        // This is a line comment and we can keep eating till the end of the line
+        t.type = TOKEN_LINE_COMMENT;
+        skip_char(lexer, 2);
+        t.length += 2; // Skip the two slashes
+
+        while (!head_is_at_eof(lexer) && *lexer->head != '\n')
+        {
+            skip_char(lexer, 1);
+            t.length++;
+        }
+
+        return t;
+    }
+
+    // Block Comments '/**/'
+    if (*lexer->head == '/' && peek_char(lexer, 1) == '*')
+    {
+        // This is a block comment, keep eating characters until you see a
+        // new opening block comment, or the close to this one
+        t.type = TOKEN_BLOCK_COMMENT;
+        skip_char(lexer, 2);
+        t.length += 2;
+
+        while (!head_is_at_eof(lexer) && !(*lexer->head == '*' && peek_char(lexer, 1) == '/'))
+        {
+            skip_char(lexer, 1);
+            t.length++;
+        }
+
+        if (head_is_at_eof(lexer))
+        {
+            // We could not finish parsing this token, so we flag the error and exit
+            lexer->has_error = true;
+            t.type = TOKEN_INVALID;
+            return t;
+        }
+        // If we are not at the EOF we hit the closing symbol and can wrap up
+        // This is the closing of the current block comment
+        skip_char(lexer, 2);
+        t.length += 2;
+
+        return t;
+    }
+
+
+    // Punctuation & Single character operators
+    if (is_single_char_token(*lexer->head))
+    {
+        t.type = *lexer->head; // The token_type will map directly from ASCII for single character tokens
+
+        skip_char(lexer, 1);
+        t.length++;
+
+        // Don't return yet, we might want to augment the
+        // token type based on the next character still
+    }
+
+    // TODO(Steven): Multi-Character operators?
+    if (t.type == TOKEN_MINUS && peek_char(lexer, 0) == '>')
+    {
+        skip_char(lexer, 1);
+        t.length++;
+        t.type = TOKEN_ARROW;
+    }
+    
+    return t;
+}
+
+location current_location(rouleaux_lexer* lexer)
+{
+    location loc = {};
+    loc.row      = lexer->current_row;
+    loc.column   = lexer->current_column;
+    loc.filename = lexer->filename;
+
+    return loc;
+}
+
+b8 head_is_at_eof(rouleaux_lexer* lexer)
+{
+    return lexer->head >= lexer->file_end;
+}
+
+char peek_char(rouleaux_lexer* lexer, u64 offset)
+{
+    if ((u64)(lexer->file_end - lexer->head) <= offset)
+        return '\0';
+
+    return lexer->head[offset];
+}
+
+void skip_char(rouleaux_lexer* lexer, u64 n)
+{
+    assert(!head_is_at_eof(lexer));
+    for (u64 i = 0; i < n; ++i)
+    {
+        lexer->current_column++;
+        if (*lexer->head == '\n')
+        {
+            lexer->current_row++;
+            lexer->current_column = 1;
+        }
+        
+        lexer->head++;
+    }
+}
+
+void trim_left(rouleaux_lexer* lexer)
+{
+    while (!head_is_at_eof(lexer) && is_whitespace(*lexer->head))
+    {
+        skip_char(lexer, 1);
+    }
+}
+
+b8 is_whitespace(char c)
+{
+    b8 is_space_or_tab = c == ' ' || c == '\t';
+    b8 is_newline_or_carriage_return = c == '\n' || c == '\r';
+    b8 is_vertical_tab_or_formfeed = c == '\v' || c == '\f';
+
+    return is_space_or_tab || is_newline_or_carriage_return || is_vertical_tab_or_formfeed;
+}
+
+b8 is_single_char_token(char c)
+{
+    switch (c)
+    {
+        case TOKEN_EXCLAMATION:
+        case TOKEN_DOUBLE_QUOTE:
+        case TOKEN_POUND:
+        case TOKEN_DOLLAR_SIGN:
+        case TOKEN_PERCENT:
+        case TOKEN_AMPERSAND:
+        case TOKEN_SINGLE_QUOTE:
+        case TOKEN_LEFT_PAREN:
+        case TOKEN_RIGHT_PAREN:
+        case TOKEN_ASTERISK:
+        case TOKEN_PLUS:
+        case TOKEN_COMMA:
+        case TOKEN_MINUS:
+        case TOKEN_PERIOD:
+        case TOKEN_FORWARD_SLASH:
+        case TOKEN_COLON:
+        case TOKEN_SEMICOLON:
+        case TOKEN_LESS_THAN:
+        case TOKEN_EQUALS:
+        case TOKEN_GREATER_THAN:
+        case TOKEN_QUESTION_MARK:
+        case TOKEN_AT_SIGN:
+        case TOKEN_LEFT_BRACKET:
+        case TOKEN_BACK_SLASH:
+        case TOKEN_RIGHT_BRACKET:
+        case TOKEN_CARET:
+        case TOKEN_UNDERSCORE:
+        case TOKEN_GRAVE:
+        case TOKEN_LEFT_CURLY:
+        case TOKEN_VERTICAL_BAR:
+        case TOKEN_RIGHT_CURLY:
+        case TOKEN_TILDE:
+            return true;
+    };
+
+    return false;
+}
+
+b8 is_identifier_character(char c, b8 include_numerics)
+{
+    b8 is_uppercase = c >= 'A' && c <= 'Z';
+    b8 is_lowercase = c >= 'a' && c <= 'z';
+    b8 is_underscore = c == '_';
+    b8 is_numeric = false;
+
+    if (include_numerics)
+        is_numeric = c >= '0' && c <= '9';
+
+    return is_uppercase || is_lowercase || is_underscore || is_numeric;
+}
+
+b8 is_numeric_character(char c)
+{
+    b8 is_numeric = c >= '0' && c <= '9';
+
+    return is_numeric;
+}
+
+
+b8 check_for_keyword(token* t)
+{
+    b8 matched = false;
+    // NOTE: Starts at 1 to offset from the TOKEN_INVALID token_type, and goes till the end of the keywords array
+    for (u64 i = 1; i < keywords_array_length(); ++i)
+    {
+        // The lengths have to match too, or every prefix of a keyword (like 'f' or 'whi') would match it
+        if (strlen(keywords[i]) == t->length && memcmp(t->text, keywords[i], t->length) == 0)
+        {
+            t->type = (token_type)i; // make the token the specific keyword type we matched with
+            matched = true;
+            break;
+        }
+    }
+    return matched;
 }
\ No newline at end of file
@@ -0,0 +1,317 @@
+#include "lexer/parallel_lexer.h"
+#include "utilities/jobs.h"
+
+#include <malloc.h>
+#include <string.h>
+
+// Chunks smaller than this are not worth a job of their own
+#define PARALLEL_LEX_MINIMUM_CHUNK_BYTES (256 * 1024)
+
+// Defined in lexer.c, lexes the next token straight out of the lexer's file_content
+token lexer_next_token_internal(rouleaux_lexer* lexer);
+
+/**
+ * @brief A line aligned slice of the file, lexed speculatively by a single thread
+ */
+typedef struct lex_chunk {
+    /* The lexer of the whole file */
+    rouleaux_lexer* lexer;
+
+    /* The first character of the chunk, this is always the start of a line */
+    const char* start;
+    /* One past the last character of the chunk */
+    const char* end;
+
+    /* The tokens which start inside the chunk, lexed as if the chunk did not start inside of a token.
+       NOTE: the rows of these tokens are relative to the start of the chunk */
+    token_array tokens;
+    /* The first token which starts at or after the end of the chunk (the row is relative to the start of the chunk) */
+    token next_token;
+
+    /* The amount of newlines inside the chunk */
+    u64 newline_count;
+    /* The row the chunk starts on */
+    u64 first_row;
+
+    /* Set if the worker failed to allocate memory for its tokens */
+    b8 failed;
+} lex_chunk;
+
+/**
+ * @brief The in order output of the stitching pass
+ */
+typedef struct token_sink {
+    rouleaux_lexer* lexer;
+    token_array* tokens;
+
+    /* Set once the TOKEN_EOF or a TOKEN_INVALID token was emitted, nothing comes after those */
+    b8 finished;
+    /* Set if the output array failed to grow */
+    b8 failed;
+} token_sink;
+
+// Splits the file into at most chunk_count line aligned chunks, returns the amount of chunks made
+static u64 split_into_chunks(rouleaux_lexer* lexer, u64 chunk_count, lex_chunk* out_chunks);
+
+// The job function which speculatively lexes a chunk
+static void lex_chunk_run(void* user_data);
+
+// Walks the chunks in order, re-lexing the parts of chunks that were speculated wrong, and emits the final token stream
+static void stitch_chunks(rouleaux_lexer* lexer, lex_chunk* chunks, u64 chunk_count, token_sink* sink);
+
+// Finds the speculative token of a chunk that starts at text, searching from (and updating) the cursor
+static b8 find_chunk_token(lex_chunk* chunk, const char* text, u64* cursor);
+
+// Adds a token to the final stream, applying the lexer's comment_mode
+static void emit_token(token_sink* sink, token t);
+
+// Creates a lexer which lexes the same buffer as the given one, from the given token's start
+static rouleaux_lexer make_chunk_lexer(rouleaux_lexer* lexer, const char* head, u64 row, u64 column);
+
+
+b8 lexer_tokenize_parallel(rouleaux_lexer* lexer, rouleaux_jobs* jobs, token_array* out_tokens)
+{
+    // The workers and the calling thread each get a chunk
+    u32 thread_count = jobs_thread_count(jobs) + 1;
+
+    // Speculation only works from the very start of a file's buffer, anything else is lexed like normal
+    b8 is_fresh = lexer->file_content && !lexer->replay_tokens && lexer->head == lexer->file_content && lexer->peek_buffer.size == 0;
+
+    u64 chunk_count = lexer->file_content_length / PARALLEL_LEX_MINIMUM_CHUNK_BYTES;
+    if (chunk_count > thread_count)
+        chunk_count = thread_count;
+
+    if (!is_fresh || chunk_count <= 1)
+        return lexer_tokenize(lexer, out_tokens);
+
+    lex_chunk* chunks = calloc(chunk_count, sizeof(lex_chunk));
+    chunk_count = split_into_chunks(lexer, chunk_count, chunks);
+
+    // The calling thread lexes the first chunk itself
+    job_counter counter = {};
+    for (u64 i = 1; i < chunk_count; ++i)
+        jobs_submit(jobs, lex_chunk_run, &chunks[i], &counter);
+
+    lex_chunk_run(&chunks[0]);
+    jobs_wait(jobs, &counter);
+
+    token_sink sink = {};
+    sink.lexer = lexer;
+    sink.tokens = out_tokens;
+
+    b8 chunks_failed = false;
+    for (u64 i = 0; i < chunk_count; ++i)
+        chunks_failed |= chunks[i].failed;
+
+    if (!chunks_failed)
+    {
+        // A rough guess of the final size, so the output does not need to regrow while stitching
+        u64 speculative_token_count = 0;
+        for (u64 i = 0; i < chunk_count; ++i)
+            speculative_token_count += chunks[i].tokens.size;
+
+        token_array_reserve(out_tokens, out_tokens->size + speculative_token_count + 1);
+        stitch_chunks(lexer, chunks, chunk_count, &sink);
+    }
+
+    for (u64 i = 0; i < chunk_count; ++i)
+        token_array_destroy(&chunks[i].tokens);
+
+    free(chunks);
+
+    // Leave the lexer drained, as if it had lexed the file itself
+    lexer->head = lexer->file_end;
+    if (out_tokens->size > 0)
+    {
+        token last = out_tokens->tokens[out_tokens->size - 1];
+        lexer->current_row = last.location.row;
+        lexer->current_column = last.location.column;
+        lexer->has_error = last.type == TOKEN_INVALID;
+    }
+
+    return !chunks_failed && !sink.failed;
+}
+
+
+u64 split_into_chunks(rouleaux_lexer* lexer, u64 chunk_count, lex_chunk* out_chunks)
+{
+    const char* content = lexer->file_content;
+    u64 length = lexer->file_content_length;
+
+    u64 made = 0;
+    const char* start = content;
+    for (u64 i = 1; i <= chunk_count && start < lexer->file_end; ++i)
+    {
+        const char* end = lexer->file_end;
+        if (i < chunk_count)
+        {
+            // Move the split point forward to the start of the next line
+            const char* split = content + (length / chunk_count) * i;
+            if (split < start)
+                split = start;
+
+            const char* newline = memchr(split, '\n', lexer->file_end - split);
+            end = newline ? newline + 1 : lexer->file_end;
+        }
+
+        out_chunks[made].lexer = lexer;
+        out_chunks[made].start = start;
+        out_chunks[made].end = end;
+        out_chunks[made].tokens = token_array_create((end - start) / 4 + 1); // A guess, about 1 token for every 4 characters
+        made++;
+
+        start = end;
+    }
+
+    return made;
+}
+
+void lex_chunk_run(void* user_data)
+{
+    lex_chunk* chunk = user_data;
+    rouleaux_lexer chunk_lexer = make_chunk_lexer(chunk->lexer, chunk->start, 1, 1);
+
+    for (;;)
+    {
+        token t = lexer_next_token_internal(&chunk_lexer);
+        if (t.type == TOKEN_EOF || t.text >= chunk->end)
+        {
+            chunk->next_token = t;
+            break;
+        }
+
+        if (!token_array_push(&chunk->tokens, t))
+        {
+            chunk->failed = true;
+            break;
+        }
+
+        // Nothing can be lexed after an invalid token, the stitching pass decides if this one is real
+        if (t.type == TOKEN_INVALID)
+        {
+            chunk->next_token = t;
+            break;
+        }
+    }
+
+    // Count the lines of the chunk so the stitching pass can turn the relative rows into real rows
+    u64 newline_count = 0;
+    const char* head = chunk->start;
+    while ((head = memchr(head, '\n', chunk->end - head)) != NULL)
+    {
+        newline_count++;
+        head++;
+    }
+    chunk->newline_count = newline_count;
+}
+
+void stitch_chunks(rouleaux_lexer* lexer, lex_chunk* chunks, u64 chunk_count, token_sink* sink)
+{
+    u64 row = 1;
+    for (u64 i = 0; i < chunk_count; ++i)
+    {
+        chunks[i].first_row = row;
+        row += chunks[i].newline_count;
+    }
+
+    // The real next token of the stream, with its real row
+    token next = {};
+    for (u64 i = 0; i < chunk_count && !sink->finished && !sink->failed; ++i)
+    {
+        lex_chunk* chunk = &chunks[i];
+        u64 first_accepted = 0;
+
+        // The first chunk starts at the start of the file, so it is never speculated wrong
+        if (i > 0 && !find_chunk_token(chunk, next.text, &first_accepted))
+        {
+            // The previous chunk's last token ran into this chunk (a block comment or a string literal spanning lines),
+            // so the start of this chunk was lexed wrong. Re-lex from the real next token until we find a token
+            // that the speculative lexing also found, from there on out the speculative tokens are correct.
+            rouleaux_lexer relexer = make_chunk_lexer(lexer, next.text, next.location.row, next.location.column);
+            u64 cursor = 0;
+            b8 resynchronized = false;
+            for (;;)
+            {
+                token t = lexer_next_token_internal(&relexer);
+                if (t.type == TOKEN_EOF || t.text >= chunk->end)
+                {
+                    // We re-lexed all the way through this chunk, the next chunk picks up from here
+                    next = t;
+                    break;
+                }
+
+                if (find_chunk_token(chunk, t.text, &cursor))
+                {
+                    first_accepted = cursor;
+                    resynchronized = true;
+                    break;
+                }
+
+                emit_token(sink, t);
+                if (sink->finished || sink->failed)
+                    return;
+            }
+
+            if (!resynchronized)
+                continue;
+        }
+
+        for (u64 j = first_accepted; j < chunk->tokens.size; ++j)
+        {
+            token t = chunk->tokens.tokens[j];
+            t.location.row += chunk->first_row - 1;
+
+            emit_token(sink, t);
+            if (sink->finished || sink->failed)
+                return;
+        }
+
+        next = chunk->next_token;
+        next.location.row += chunk->first_row - 1;
+    }
+
+    // The token after the last chunk is the end of the file
+    if (!sink->finished && !sink->failed)
+        emit_token(sink, next);
+}
+
+b8 find_chunk_token(lex_chunk* chunk, const char* text, u64* cursor)
+{
+    // The tokens are in buffer order, so the cursor only ever needs to move forward
+    while (*cursor < chunk->tokens.size && chunk->tokens.tokens[*cursor].text < text)
+        (*cursor)++;
+
+    // The lexer has no state besides its position, so a speculative token starting at
+    // the same place as the real one is the same token, as are all the tokens after it
+    return *cursor < chunk->tokens.size && chunk->tokens.tokens[*cursor].text == text;
+}
+
+void emit_token(token_sink* sink, token t)
+{
+    if (t.type == TOKEN_EOF || t.type == TOKEN_INVALID)
+        sink->finished = true;
+
+    if ((t.type == TOKEN_LINE_COMMENT || t.type == TOKEN_BLOCK_COMMENT) && sink->lexer->comment_mode != COMMENT_MODE_TOKENS)
+    {
+        if (sink->lexer->comment_mode == COMMENT_MODE_SIDE_TABLE)
+            comment_table_push(&sink->lexer->comments, t.text - sink->lexer->file_content, t.length, t.location.row);
+        return;
+    }
+
+    if (!token_array_push(sink->tokens, t))
+        sink->failed = true;
+}
+
+rouleaux_lexer make_chunk_lexer(rouleaux_lexer* lexer, const char* head, u64 row, u64 column)
+{
+    rouleaux_lexer chunk_lexer = {};
+    chunk_lexer.filename = lexer->filename;
+    chunk_lexer.file_content = lexer->file_content;
+    chunk_lexer.file_content_length = lexer->file_content_length;
+    chunk_lexer.file_end = lexer->file_end;
+    chunk_lexer.head = (char*)head;
+    chunk_lexer.current_row = row;
+    chunk_lexer.current_column = column;
+
+    return chunk_lexer;
+}
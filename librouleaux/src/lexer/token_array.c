@@ -0,0 +1,88 @@
+#include "lexer/token_array.h"
+
+#include <malloc.h>
+#include <string.h>
+
+#define DEFAULT_TOKEN_ARRAY_CAPACITY 64
+#define DEFAULT_TOKEN_ARRAY_RESIZE_FACTOR 2
+
+token_array token_array_create(u64 capacity)
+{
+    token_array array = {};
+    array.capacity = capacity ? capacity : DEFAULT_TOKEN_ARRAY_CAPACITY;
+    array.size = 0;
+    array.tokens = malloc(array.capacity * sizeof(token));
+
+    return array;
+}
+
+void token_array_destroy(token_array* array)
+{
+    if (array->tokens)
+    {
+        free(array->tokens);
+        array->tokens = NULL;
+    }
+    array->size = 0;
+    array->capacity = 0;
+}
+
+b8 token_array_push(token_array* array, token t)
+{
+    // If we are about to overflow, realloc
+    if (array->size + 1 >= array->capacity)
+    {
+        if (!token_array_reserve(array, array->capacity * DEFAULT_TOKEN_ARRAY_RESIZE_FACTOR))
+            return false; // We failed to add the token
+    }
+
+    array->tokens[array->size] = t;
+    array->size++;
+
+    return true;
+}
+
+b8 token_array_reserve(token_array* array, u64 capacity)
+{
+    if (capacity <= array->capacity)
+        return true;
+
+    token* new_buffer = malloc(capacity * sizeof(token));
+
+    int error_code = memcpy_s(new_buffer, capacity * sizeof(token), array->tokens, array->size * sizeof(token));
+    if (error_code)
+        return false; // we failed to copy the memory
+
+    free(array->tokens);
+    array->tokens = new_buffer;
+    array->capacity = capacity;
+
+    return true; // We successfully reallocated the array buffer
+}
+
+b8 token_array_replace(token_array* array, u64 first, u64 count, const token* tokens, u64 token_count)
+{
+    if (first + count > array->size)
+        return false;
+
+    u64 new_size = array->size - count + token_count;
+    if (new_size + 1 >= array->capacity)
+    {
+        u64 new_capacity = array->capacity * DEFAULT_TOKEN_ARRAY_RESIZE_FACTOR;
+        while (new_size + 1 >= new_capacity)
+            new_capacity *= DEFAULT_TOKEN_ARRAY_RESIZE_FACTOR;
+
+        if (!token_array_reserve(array, new_capacity))
+            return false;
+    }
+
+    // Slide the tokens after the range over to where they end up, then fill the gap
+    u64 tail_count = array->size - (first + count);
+    if (token_count != count)
+        memmove(array->tokens + first + token_count, array->tokens + first + count, tail_count * sizeof(token));
+    if (token_count > 0)
+        memcpy(array->tokens + first, tokens, token_count * sizeof(token));
+
+    array->size = new_size;
+    return true;
+}
@@ -0,0 +1,179 @@
+#include "lexer/token_ring.h"
+#include "utilities/thread.h"
+
+#include <malloc.h>
+
+// How many times a waiting thread checks the ring again before it gives up its time slice
+#define TOKEN_RING_SPIN_COUNT 64
+
+// Waits until the consumer has a token to read, returns false if the ring is closed and drained
+static b8 wait_for_token(token_ring* ring);
+
+// Moves the producer's limit up to the consumer's read position (minus the look back)
+static void release_read_tokens(token_ring* ring);
+
+
+b8 token_ring_create(token_ring* ring, u64 capacity, u64 look_back)
+{
+    if (capacity == 0)
+        capacity = DEFAULT_TOKEN_RING_CAPACITY;
+    if (look_back == 0)
+        look_back = DEFAULT_TOKEN_RING_LOOK_BACK;
+
+    // The producer needs at least one free slot beyond the look back to make progress
+    u64 rounded_capacity = 1;
+    while (rounded_capacity < capacity || rounded_capacity <= look_back)
+        rounded_capacity <<= 1;
+
+    ring->tokens = malloc(sizeof(token) * rounded_capacity);
+    if (!ring->tokens)
+        return false;
+
+    ring->capacity = rounded_capacity;
+    ring->look_back = look_back;
+    ring->cached_released_index = 0;
+    ring->read_index = 0;
+    ring->cached_write_index = 0;
+
+    atomic_init(&ring->write_index, 0);
+    atomic_init(&ring->released_index, 0);
+    atomic_init(&ring->closed, false);
+    atomic_init(&ring->cancelled, false);
+
+    return true;
+}
+
+void token_ring_destroy(token_ring* ring)
+{
+    free(ring->tokens);
+    ring->tokens = NULL;
+    ring->capacity = 0;
+}
+
+b8 token_ring_push(token_ring* ring, token t)
+{
+    // Only the producer writes write_index, so it can read it relaxed
+    u64 write_index = atomic_load_explicit(&ring->write_index, memory_order_relaxed);
+
+    u32 spins = 0;
+    while (write_index - ring->cached_released_index >= ring->capacity)
+    {
+        ring->cached_released_index = atomic_load_explicit(&ring->released_index, memory_order_acquire);
+        if (write_index - ring->cached_released_index < ring->capacity)
+            break;
+
+        if (atomic_load_explicit(&ring->cancelled, memory_order_acquire))
+            return false;
+
+        if (++spins >= TOKEN_RING_SPIN_COUNT)
+        {
+            thread_yield();
+            spins = 0;
+        }
+    }
+
+    ring->tokens[write_index & (ring->capacity - 1)] = t;
+    atomic_store_explicit(&ring->write_index, write_index + 1, memory_order_release);
+
+    return true;
+}
+
+void token_ring_close(token_ring* ring)
+{
+    atomic_store_explicit(&ring->closed, true, memory_order_release);
+}
+
+b8 token_ring_pop(token_ring* ring, token* out_token)
+{
+    if (!token_ring_peek(ring, out_token))
+        return false;
+
+    ring->read_index++;
+    release_read_tokens(ring);
+
+    return true;
+}
+
+b8 token_ring_peek(token_ring* ring, token* out_token)
+{
+    if (!wait_for_token(ring))
+    {
+        // The producer is done, so the last slot it wrote is never going to be overwritten
+        u64 write_index = ring->cached_write_index;
+        *out_token = write_index ? ring->tokens[(write_index - 1) & (ring->capacity - 1)] : (token){ .type = TOKEN_EOF };
+        return false;
+    }
+
+    *out_token = ring->tokens[ring->read_index & (ring->capacity - 1)];
+    return true;
+}
+
+b8 token_ring_put_back(token_ring* ring, token t)
+{
+    if (ring->read_index == 0)
+        return false;
+
+    // Only the token which was just popped can be put back without copying it
+    token previous = ring->tokens[(ring->read_index - 1) & (ring->capacity - 1)];
+    if (previous.text != t.text || previous.type != t.type || previous.length != t.length)
+        return false;
+
+    return token_ring_rewind(ring, ring->read_index - 1);
+}
+
+u64 token_ring_checkpoint(token_ring* ring)
+{
+    return ring->read_index;
+}
+
+b8 token_ring_rewind(token_ring* ring, u64 checkpoint)
+{
+    // Anything below the released index may already be overwritten by the producer
+    if (checkpoint > ring->read_index || checkpoint < atomic_load_explicit(&ring->released_index, memory_order_relaxed))
+        return false;
+
+    ring->read_index = checkpoint;
+    return true;
+}
+
+void token_ring_cancel(token_ring* ring)
+{
+    atomic_store_explicit(&ring->cancelled, true, memory_order_release);
+}
+
+
+b8 wait_for_token(token_ring* ring)
+{
+    u32 spins = 0;
+    while (ring->read_index >= ring->cached_write_index)
+    {
+        // Read closed before write_index, so a token published just before closing is never missed
+        b8 closed = atomic_load_explicit(&ring->closed, memory_order_acquire);
+
+        ring->cached_write_index = atomic_load_explicit(&ring->write_index, memory_order_acquire);
+        if (ring->read_index < ring->cached_write_index)
+            break;
+
+        if (closed)
+            return false;
+
+        if (++spins >= TOKEN_RING_SPIN_COUNT)
+        {
+            thread_yield();
+            spins = 0;
+        }
+    }
+
+    return true;
+}
+
+void release_read_tokens(token_ring* ring)
+{
+    if (ring->read_index <= ring->look_back)
+        return;
+
+    // The released index only ever moves forward, once the producer is given a slot a rewind cannot take it back
+    u64 released_index = ring->read_index - ring->look_back;
+    if (released_index > atomic_load_explicit(&ring->released_index, memory_order_relaxed))
+        atomic_store_explicit(&ring->released_index, released_index, memory_order_release);
+}
@@ -0,0 +1,147 @@
+#include "parser/incremental_parser.h"
+#include "parser/abstract_syntax_tree.h"
+#include "parser/node_list.h"
+
+#include <malloc.h>
+#include <string.h>
+#include <stdatomic.h>
+
+// Once the nodes left behind by edits take more room than this many full parses, the arena is rebuilt from scratch
+#define INCREMENTAL_PARSE_COMPACT_FACTOR 2
+
+// The arena_id of the last arena made by any incremental_parse, so no two arenas ever share an id
+static _Atomic u64 last_arena_id = 0;
+
+// Parses the whole token stream, reusing every statement the table says can be reused
+static parse_result parse_tokens(incremental_parse* parse, rouleaux_parser* parser);
+
+// Parses the whole token stream into a new arena, with a new table, and releases the old ones
+static parse_result rebuild(incremental_parse* parse, rouleaux_parser* parser);
+
+// node_arena_for_each() callback, moves the token of a node along with the edit described by the token_edit
+static void move_node_token(void* allocation, void* user_data);
+
+// node_arena_for_each() callback, frees the child list of a node which has one
+static void release_node_children(void* allocation, void* user_data);
+
+
+parse_result incremental_parse_create(incremental_parse* parse, rouleaux_parser* parser)
+{
+    memset(parse, 0, sizeof(incremental_parse));
+    parse->tokens = token_array_create(0);
+
+    if (!lexer_tokenize(&parser->lexer, &parse->tokens))
+    {
+        return parse_result_error(token_file_start(parser->lexer.filename), DIAGNOSTIC_TOKEN_ARRAY_ALLOCATION);
+    }
+
+    return rebuild(parse, parser);
+}
+
+void incremental_parse_destroy(incremental_parse* parse)
+{
+    node_arena_for_each(&parse->arena, sizeof(ast_node), release_node_children, NULL);
+    node_arena_destroy(&parse->arena);
+
+    statement_table_destroy(&parse->statements);
+    token_array_destroy(&parse->tokens);
+
+    parse->ast = NULL;
+    parse->full_parse_bytes = 0;
+}
+
+parse_result incremental_parse_apply_edit(incremental_parse* parse, rouleaux_parser* parser, text_edit edit)
+{
+    token_edit change;
+    if (!lexer_apply_edit(&parser->lexer, &parse->tokens, edit, &change))
+    {
+        return parse_result_error(token_file_start(parser->lexer.filename), DIAGNOSTIC_EDIT_FAILED, diagnostic_integer(edit.offset));
+    }
+
+    // ast_nodes hold copies of their tokens, which point into the buffer and know their row and column,
+    // so every node that survived the edit has to be moved along with it. This is a linear pass over
+    // the arena, it is still a lot cheaper than parsing the file again.
+    node_arena_for_each(&parse->arena, sizeof(ast_node), move_node_token, &change);
+
+    if (!statement_table_replace(&parse->statements, change.first_token, change.removed_token_count, change.inserted_token_count))
+        return rebuild(parse, parser);
+
+    ast_node* old_ast = parse->ast;
+    parse_result result = parse_tokens(parse, parser);
+    if (!result.success)
+        return result;
+
+    // Only the file's scope is sure to be rebuilt by every parse, its old list of statements is not needed anymore
+    if (old_ast)
+        release_node_children(old_ast, NULL);
+
+    // Too many nodes of replaced statements are sitting in the arena, start over from a fresh one
+    if (parse->arena.bytes_allocated > INCREMENTAL_PARSE_COMPACT_FACTOR * parse->full_parse_bytes + parse->arena.block_size)
+        return rebuild(parse, parser);
+
+    return result;
+}
+
+
+parse_result parse_tokens(incremental_parse* parse, rouleaux_parser* parser)
+{
+    rouleaux_parser replay_parser = {};
+    replay_parser.lexer = lexer_create_from_tokens(parse->tokens.tokens, parse->tokens.size, parser->lexer.filename);
+    replay_parser.node_allocator = parser->node_allocator;
+    replay_parser.node_deallocator = parser->node_deallocator;
+    replay_parser.node_arena = &parse->arena;
+    replay_parser.statement_table = &parse->statements;
+
+    statement_table_begin_parse(&parse->statements);
+    parse_result result = parser_parse_file(&replay_parser);
+    statement_table_end_parse(&parse->statements, result.success);
+
+    lexer_destroy(&replay_parser.lexer);
+
+    if (result.success)
+        parse->ast = result.resulting_tree;
+
+    return result;
+}
+
+parse_result rebuild(incremental_parse* parse, rouleaux_parser* parser)
+{
+    node_arena_for_each(&parse->arena, sizeof(ast_node), release_node_children, NULL);
+    node_arena_destroy(&parse->arena);
+    statement_table_destroy(&parse->statements);
+    parse->ast = NULL;
+
+    parse->arena = node_arena_create(0);
+    parse->arena_id = atomic_fetch_add(&last_arena_id, 1) + 1;
+    parse->statements = statement_table_create(parse->tokens.size);
+    if (!parse->statements.entries)
+    {
+        return parse_result_error(token_file_start(parser->lexer.filename), DIAGNOSTIC_STATEMENT_TABLE_ALLOCATION);
+    }
+
+    parse_result result = parse_tokens(parse, parser);
+    parse->full_parse_bytes = parse->arena.bytes_allocated;
+
+    return result;
+}
+
+void move_node_token(void* allocation, void* user_data)
+{
+    ast_node* node = allocation;
+    const token_edit* change = user_data;
+
+    // Every kind of node starts with its token, so the leaf's token is the token of any node
+    token_edit_move_token(change, &node->node.leaf.t);
+}
+
+void release_node_children(void* allocation, void* user_data)
+{
+    (void)user_data;
+
+    ast_node* node = allocation;
+    if (ast_node_child_strategy_from_node_type(node->type) == CHILD_STRATEGY_MANY)
+    {
+        free(node->node.many.children.nodes);
+        node->node.many.children.nodes = NULL;
+    }
+}
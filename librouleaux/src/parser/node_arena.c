@@ -0,0 +1,117 @@
+#include "parser/node_arena.h"
+
+#include <malloc.h>
+
+#define NODE_ARENA_ALIGNMENT 16
+
+typedef struct node_arena_block {
+    /* The previously filled block */
+    struct node_arena_block* previous;
+    /* The amount of bytes used in this block */
+    u64 used;
+    /* The amount of bytes this block can hand out */
+    u64 capacity;
+    /* The memory of the block */
+    _Alignas(NODE_ARENA_ALIGNMENT) u8 memory[];
+} node_arena_block;
+
+static node_arena_block* allocate_block(u64 capacity, node_arena_block* previous);
+
+
+node_arena node_arena_create(u64 block_size)
+{
+    node_arena arena = {};
+    arena.block_size = block_size ? block_size : DEFAULT_NODE_ARENA_BLOCK_SIZE;
+
+    return arena;
+}
+
+void node_arena_destroy(node_arena* arena)
+{
+    node_arena_block* block = arena->current_block;
+    while (block)
+    {
+        node_arena_block* previous = block->previous;
+        free(block);
+        block = previous;
+    }
+
+    arena->current_block = NULL;
+    arena->bytes_allocated = 0;
+}
+
+void node_arena_reset(node_arena* arena)
+{
+    node_arena_block* block = arena->current_block;
+    if (!block)
+        return;
+
+    // An oversized block would only hold on to memory the next statement likely does not need
+    node_arena_block* kept_block = block->capacity <= arena->block_size ? block : NULL;
+    if (kept_block)
+        block = block->previous;
+
+    while (block)
+    {
+        node_arena_block* previous = block->previous;
+        free(block);
+        block = previous;
+    }
+
+    if (kept_block)
+    {
+        kept_block->previous = NULL;
+        kept_block->used = 0;
+    }
+
+    arena->current_block = kept_block;
+    arena->bytes_allocated = 0;
+}
+
+void* node_arena_allocate(node_arena* arena, u64 size_in_bytes)
+{
+    u64 aligned_size = (size_in_bytes + (NODE_ARENA_ALIGNMENT - 1)) & ~(u64)(NODE_ARENA_ALIGNMENT - 1);
+
+    node_arena_block* block = arena->current_block;
+    if (!block || block->used + aligned_size > block->capacity)
+    {
+        // Oversized allocations get a block to themselves
+        u64 capacity = aligned_size > arena->block_size ? aligned_size : arena->block_size;
+        block = allocate_block(capacity, arena->current_block);
+        if (!block)
+            return NULL;
+
+        arena->current_block = block;
+    }
+
+    void* memory = block->memory + block->used;
+    block->used += aligned_size;
+    arena->bytes_allocated += aligned_size;
+
+    return memory;
+}
+
+
+void node_arena_for_each(node_arena* arena, u64 size_in_bytes, void (*function)(void* allocation, void* user_data), void* user_data)
+{
+    u64 aligned_size = (size_in_bytes + (NODE_ARENA_ALIGNMENT - 1)) & ~(u64)(NODE_ARENA_ALIGNMENT - 1);
+
+    for (node_arena_block* block = arena->current_block; block; block = block->previous)
+    {
+        for (u64 used = 0; used + aligned_size <= block->used; used += aligned_size)
+            function(block->memory + used, user_data);
+    }
+}
+
+node_arena_block* allocate_block(u64 capacity, node_arena_block* previous)
+{
+    node_arena_block* block = malloc(sizeof(node_arena_block) + capacity);
+    if (!block)
+        return NULL;
+
+    block->previous = previous;
+    block->used = 0;
+    block->capacity = capacity;
+
+    return block;
+}
@@ -0,0 +1,309 @@
+#include "parser/parallel_parser.h"
+#include "parser/abstract_syntax_tree.h"
+#include "parser/node_list.h"
+#include "lexer/token_array.h"
+#include "lexer/parallel_lexer.h"
+#include "utilities/jobs.h"
+
+#include <malloc.h>
+#include <stdatomic.h>
+
+// Files with fewer tokens than this are parsed on the calling thread, the threads would cost more then they save
+#define PARALLEL_PARSE_MINIMUM_TOKENS 4096
+// The amount of jobs each thread gets on average, more (smaller) jobs balance the load between threads better
+#define PARALLEL_PARSE_JOBS_PER_THREAD 8
+
+/**
+ * @brief A contiguous run of top level statements, parsed by a single worker
+ */
+typedef struct parse_job {
+    /* The index of the first token of the job in the file's token_array */
+    u64 first_token;
+    /* The amount of tokens in the job */
+    u64 token_count;
+
+    /* The top level statements the job parsed, in file order */
+    node_list statements;
+} parse_job;
+
+/**
+ * @brief The state shared between all the workers of a parallel parse
+ */
+typedef struct parallel_parse {
+    /* The parser parser_parse_file_parallel() was called with */
+    rouleaux_parser* parser;
+    /* Every token in the file */
+    token_array* tokens;
+
+    /* The jobs, in file order */
+    parse_job* jobs;
+    /* The amount of jobs */
+    u64 job_count;
+
+    /* The index of the next job to be picked up by a worker */
+    _Atomic u64 next_job;
+    /* Set when any job failed to parse, it stops the workers from picking up more jobs */
+    _Atomic b8 failed;
+} parallel_parse;
+
+typedef struct parse_worker {
+    parallel_parse* state;
+    /* The arena this worker allocates all of its nodes from */
+    node_arena* arena;
+} parse_worker;
+
+// Splits the token stream into jobs of about tokens_per_job tokens, always ending a job at the end of a top level statement
+static u64 split_into_jobs(token_array* tokens, u64 tokens_per_job, parse_job** out_jobs);
+
+// Returns true if the token at index (which is at a nesting depth of 0) is the last token of a top level statement
+static b8 ends_top_level_statement(token_array* tokens, u64 index);
+
+// The job function of a worker, picks up parse jobs until there are none left
+static void parse_worker_run(void* user_data);
+
+// Parses all the statements in a job
+static b8 parse_job_run(parallel_parse* state, parse_job* job, node_arena* arena);
+
+// Parses a whole token stream on the calling thread
+static parse_result parse_tokens_sequentially(rouleaux_parser* parser, token_array* tokens);
+
+
+parse_result parser_parse_file_parallel(rouleaux_parser* parser, rouleaux_jobs* jobs)
+{
+    // The scheduler's workers and the calling thread
+    u32 thread_count = jobs_thread_count(jobs) + 1;
+
+    // Lex the whole file up front, the workers replay their part of the token stream
+    token_array tokens = token_array_create(0);
+    if (!lexer_tokenize_parallel(&parser->lexer, jobs, &tokens))
+    {
+        token last_token = tokens.size ? tokens.tokens[tokens.size - 1] : (token){};
+        token_array_destroy(&tokens);
+        return parse_result_error(last_token, DIAGNOSTIC_TOKEN_STREAM_ALLOCATION);
+    }
+
+    // The lexer has been drained, so the parser is done with the file no matter how we parse the tokens
+    parser->done = true;
+
+    if (thread_count <= 1 || tokens.size < PARALLEL_PARSE_MINIMUM_TOKENS)
+    {
+        parse_result result = parse_tokens_sequentially(parser, &tokens);
+        token_array_destroy(&tokens);
+        return result;
+    }
+
+    parallel_parse state = {};
+    state.parser = parser;
+    state.tokens = &tokens;
+    state.job_count = split_into_jobs(&tokens, tokens.size / ((u64)thread_count * PARALLEL_PARSE_JOBS_PER_THREAD) + 1, &state.jobs);
+    atomic_init(&state.next_job, 0);
+    atomic_init(&state.failed, false);
+
+    if (state.job_count < thread_count)
+        thread_count = (u32)state.job_count;
+
+    // Every worker gets its own arena, so the workers never share an allocator
+    parser->worker_arenas = calloc(thread_count, sizeof(node_arena));
+    parser->worker_arena_count = thread_count;
+
+    parse_worker* workers = calloc(thread_count, sizeof(parse_worker));
+    for (u32 i = 0; i < thread_count; ++i)
+    {
+        parser->worker_arenas[i] = node_arena_create(0);
+        workers[i].state = &state;
+        workers[i].arena = &parser->worker_arenas[i];
+    }
+
+    // The calling thread is a worker too, so only thread_count - 1 workers are submitted.
+    // A worker that starts late finds no parse jobs left, they were picked up by the other workers
+    job_counter counter = {};
+    for (u32 i = 1; i < thread_count; ++i)
+        jobs_submit(jobs, parse_worker_run, &workers[i], &counter);
+
+    parse_worker_run(&workers[0]);
+    jobs_wait(jobs, &counter);
+
+    parse_result result;
+    if (atomic_load(&state.failed))
+    {
+        // Throw away everything that was parsed, and re-parse on this thread to get the exact error
+        for (u64 i = 0; i < state.job_count; ++i)
+            if (state.jobs[i].statements.nodes)
+                node_list_destroy(&state.jobs[i].statements, parser->node_deallocator);
+
+        result = parse_tokens_sequentially(parser, &tokens);
+    }
+    else
+    {
+        // Merge the statements of every job, in file order, into the file's scope
+        ast_node* file_node = parser_create_ast_node(parser, AST_SCOPE);
+        file_node->node.many.children = node_list_create();
+
+        for (u64 i = 0; i < state.job_count; ++i)
+        {
+            node_list* statements = &state.jobs[i].statements;
+            for (u64 j = 0; j < statements->number_of_nodes; ++j)
+                node_list_push_back(&(file_node->node.many.children), statements->nodes[j]);
+
+            // The file's scope owns the nodes now, only the job's list buffer needs to go
+            free(statements->nodes);
+            statements->nodes = NULL;
+        }
+
+        // parser_parse_file() always ends the file's scope with the AST_EOF node
+        node_list_push_back(&(file_node->node.many.children), parser_create_ast_node(parser, AST_EOF));
+
+        result = parse_result_success(file_node);
+    }
+
+    free(workers);
+    free(state.jobs);
+    token_array_destroy(&tokens);
+
+    return result;
+}
+
+
+u64 split_into_jobs(token_array* tokens, u64 tokens_per_job, parse_job** out_jobs)
+{
+    // Every job but the last has at least tokens_per_job tokens
+    u64 capacity = tokens->size / tokens_per_job + 1;
+    parse_job* jobs = calloc(capacity, sizeof(parse_job));
+    u64 job_count = 0;
+
+    u64 job_start = 0;
+    i64 depth = 0;
+    for (u64 i = 0; i < tokens->size; ++i)
+    {
+        switch (tokens->tokens[i].type)
+        {
+            case TOKEN_LEFT_PAREN:
+            case TOKEN_LEFT_CURLY:
+            case TOKEN_LEFT_BRACKET:
+            {
+                depth++;
+                break;
+            }
+            case TOKEN_RIGHT_PAREN:
+            case TOKEN_RIGHT_CURLY:
+            case TOKEN_RIGHT_BRACKET:
+            {
+                depth--;
+                break;
+            }
+            default:
+                break;
+        };
+
+        if (depth != 0 || (i + 1 - job_start) < tokens_per_job || !ends_top_level_statement(tokens, i))
+            continue;
+
+        jobs[job_count].first_token = job_start;
+        jobs[job_count].token_count = i + 1 - job_start;
+        job_count++;
+
+        job_start = i + 1;
+    }
+
+    // Whatever is left (at least the EOF token) is the last job
+    if (job_start < tokens->size)
+    {
+        jobs[job_count].first_token = job_start;
+        jobs[job_count].token_count = tokens->size - job_start;
+        job_count++;
+    }
+
+    *out_jobs = jobs;
+    return job_count;
+}
+
+b8 ends_top_level_statement(token_array* tokens, u64 index)
+{
+    token_type next_type = (index + 1 < tokens->size) ? tokens->tokens[index + 1].type : TOKEN_EOF;
+    switch (tokens->tokens[index].type)
+    {
+        case TOKEN_SEMICOLON:
+        {
+            // 'if (x) y = 1; else ...' is still the same statement
+            return next_type != TOKEN_KEYWORD_ELSE;
+        }
+        case TOKEN_RIGHT_CURLY:
+        {
+            // An if block followed by an else, or a function body followed by its ';'
+            return next_type != TOKEN_KEYWORD_ELSE && next_type != TOKEN_SEMICOLON;
+        }
+        case TOKEN_LINE_COMMENT:
+        case TOKEN_BLOCK_COMMENT:
+        {
+            // A comment at the top level is a statement of its own
+            return true;
+        }
+        default:
+        {
+            return false;
+        }
+    };
+}
+
+void parse_worker_run(void* user_data)
+{
+    parse_worker* worker = user_data;
+    parallel_parse* state = worker->state;
+
+    while (!atomic_load(&state->failed))
+    {
+        u64 job_index = atomic_fetch_add(&state->next_job, 1);
+        if (job_index >= state->job_count)
+            break;
+
+        if (!parse_job_run(state, &state->jobs[job_index], worker->arena))
+            atomic_store(&state->failed, true);
+    }
+}
+
+b8 parse_job_run(parallel_parse* state, parse_job* job, node_arena* arena)
+{
+    rouleaux_parser job_parser = {};
+    job_parser.lexer = lexer_create_from_tokens(state->tokens->tokens + job->first_token, job->token_count, state->parser->lexer.filename);
+    job_parser.node_allocator = state->parser->node_allocator;
+    job_parser.node_deallocator = state->parser->node_deallocator;
+    job_parser.node_arena = arena;
+
+    job->statements = node_list_create();
+
+    b8 success = true;
+    while (!job_parser.done)
+    {
+        parse_result result = parser_parse_statement(&job_parser);
+        if (!result.success)
+        {
+            // The error will be reported by the sequential re-parse, so this one can be thrown away
+            parse_result_destroy(&result);
+            success = false;
+            break;
+        }
+
+        // The end of the job's tokens is not the end of the file, the merge adds the file's AST_EOF node
+        if (job_parser.done)
+            break;
+
+        node_list_push_back(&job->statements, result.resulting_tree);
+    }
+
+    lexer_destroy(&job_parser.lexer);
+    return success;
+}
+
+parse_result parse_tokens_sequentially(rouleaux_parser* parser, token_array* tokens)
+{
+    rouleaux_parser replay_parser = {};
+    replay_parser.lexer = lexer_create_from_tokens(tokens->tokens, tokens->size, parser->lexer.filename);
+    replay_parser.node_allocator = parser->node_allocator;
+    replay_parser.node_deallocator = parser->node_deallocator;
+    replay_parser.node_arena = parser->node_arena;
+
+    parse_result result = parser_parse_file(&replay_parser);
+
+    lexer_destroy(&replay_parser.lexer);
+    return result;
+}
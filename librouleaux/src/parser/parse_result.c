@@ -1,38 +1,35 @@
-#include "parser/parse_result.h"
-#include "utilities/error_report.h"
-
-#include <stdarg.h>
-#include <malloc.h>
-
-parse_result parse_result_success(ast_node* resulting_tree)
-{
-    parse_result result = {};
-    result.success = true;
-    result.resulting_tree = resulting_tree;
-
-    return result;
-}
-
-
-parse_result parse_result_error(token t, char* message, ...)
-{
-    parse_result result = {};
-    result.success = false;
-    result.error.faulted_token = t;
-
-    va_list params;
-    va_start(params, message);
-    result.error.message = format_error_message(message, params);
-    va_end(params);
-
-    return result;
-}
-
-void parse_result_destroy(parse_result* result)
-{
-    if (!result->success)
-    {
-        free(result->error.message);
-        result->error.message = NULL;
-    }
-}
+#include "parser/parse_result.h"
+#include "utilities/error_report.h"
+
+#include <stdarg.h>
+#include <malloc.h>
+
+parse_result parse_result_success(ast_node* resulting_tree)
+{
+    parse_result result = {};
+    result.success = true;
+    result.resulting_tree = resulting_tree;
+
+    return result;
+}
+
+
+parse_result parse_result_error(token t, diagnostic_id id, ...)
+{
+    parse_result result = {};
+    result.success = false;
+
+    va_list params;
+    va_start(params, id);
+    result.error = error_report_create(t, id, params);
+    va_end(params);
+
+    return result;
+}
+
+void parse_result_destroy(parse_result* result)
+{
+    // Errors no longer own a formatted message, so there is nothing left to free
+    if (!result->success)
+        result->error = (error_report){};
+}
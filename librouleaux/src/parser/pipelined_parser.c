@@ -0,0 +1,85 @@
+#include "parser/pipelined_parser.h"
+#include "lexer/token_ring.h"
+#include "utilities/thread.h"
+
+/**
+ * @brief The state of the lexing thread of a pipelined parse
+ */
+typedef struct lexer_producer {
+    /* The lexer thread's own copy of the file's lexer */
+    rouleaux_lexer lexer;
+    /* The ring the tokens are pushed into */
+    token_ring* ring;
+} lexer_producer;
+
+// The thread function of the lexing thread, lexes the whole file into the ring
+static void lexer_producer_run(void* user_data);
+
+
+parse_result parser_parse_file_pipelined(rouleaux_parser* parser, u64 ring_capacity)
+{
+    rouleaux_lexer* lexer = &parser->lexer;
+
+    // Only a lexer which is sitting at the start of its file can be handed to another thread
+    b8 is_fresh = lexer->file_content && !lexer->replay_tokens && !lexer->token_ring && lexer->head == lexer->file_content && lexer->peek_buffer.size == 0;
+    if (!is_fresh)
+        return parser_parse_file(parser);
+
+    token_ring ring;
+    if (!token_ring_create(&ring, ring_capacity, 0))
+        return parser_parse_file(parser);
+
+    // The lexer thread owns the lexing state (including the comments) until it is joined,
+    // the parser's lexer only ever reads the ring
+    lexer_producer producer = {};
+    producer.lexer = *lexer;
+    producer.lexer.peek_buffer = (peek_queue){};
+    producer.ring = &ring;
+
+    lexer->comments = (comment_table){};
+    lexer->token_ring = &ring;
+
+    rouleaux_thread thread;
+    if (!thread_create(&thread, lexer_producer_run, &producer))
+    {
+        lexer->token_ring = NULL;
+        lexer->comments = producer.lexer.comments;
+        token_ring_destroy(&ring);
+
+        return parser_parse_file(parser);
+    }
+
+    parse_result result = parser_parse_file(parser);
+
+    // The parser stops at the first error, so the lexer thread may still be waiting on room in the ring
+    token_ring_cancel(&ring);
+    thread_join(&thread);
+
+    // Hand the lexing state back, as if the parser's lexer did all the lexing itself
+    lexer->token_ring = NULL;
+    lexer->head = producer.lexer.head;
+    lexer->current_row = producer.lexer.current_row;
+    lexer->current_column = producer.lexer.current_column;
+    lexer->comments = producer.lexer.comments;
+    lexer->has_error = producer.lexer.has_error;
+
+    token_ring_destroy(&ring);
+
+    return result;
+}
+
+
+void lexer_producer_run(void* user_data)
+{
+    lexer_producer* producer = user_data;
+
+    token t;
+    do {
+        t = lexer_next_token(&producer->lexer);
+        if (!token_ring_push(producer->ring, t))
+            break; // The parser stopped early
+
+    } while (t.type != TOKEN_EOF && t.type != TOKEN_INVALID);
+
+    token_ring_close(producer->ring);
+}
@@ -0,0 +1,158 @@
+#include "parser/statement_table.h"
+
+#include <malloc.h>
+#include <string.h>
+
+#define DEFAULT_STATEMENT_TABLE_RESIZE_FACTOR 2
+
+// Gives where a token index of the stream before a replace ends up after it, indices inside the replaced tokens end up after the new ones
+static u64 map_index(u64 index, u64 first, u64 count, u64 new_count);
+
+
+statement_table statement_table_create(u64 token_count)
+{
+    statement_table table = {};
+    table.capacity = token_count + 1;
+    table.size = token_count;
+    table.entries = calloc(table.capacity, sizeof(statement_entry));
+
+    return table;
+}
+
+void statement_table_destroy(statement_table* table)
+{
+    free(table->entries);
+    memset(table, 0, sizeof(statement_table));
+}
+
+b8 statement_table_replace(statement_table* table, u64 first, u64 count, u64 new_count)
+{
+    if (first + count > table->size)
+        return false;
+
+    u64 new_size = table->size - count + new_count;
+    if (new_size + 1 > table->capacity)
+    {
+        u64 new_capacity = table->capacity * DEFAULT_STATEMENT_TABLE_RESIZE_FACTOR;
+        while (new_size + 1 > new_capacity)
+            new_capacity *= DEFAULT_STATEMENT_TABLE_RESIZE_FACTOR;
+
+        statement_entry* new_entries = malloc(new_capacity * sizeof(statement_entry));
+        if (!new_entries)
+            return false;
+
+        int error_code = memcpy_s(new_entries, new_capacity * sizeof(statement_entry), table->entries, table->size * sizeof(statement_entry));
+        if (error_code)
+        {
+            free(new_entries);
+            return false;
+        }
+
+        free(table->entries);
+        table->entries = new_entries;
+        table->capacity = new_capacity;
+    }
+
+    // The entries after the replaced tokens slide over with their tokens, the new tokens start out without statements
+    u64 tail_count = table->size - (first + count);
+    if (new_count != count)
+        memmove(table->entries + first + new_count, table->entries + first + count, tail_count * sizeof(statement_entry));
+    memset(table->entries + first, 0, new_count * sizeof(statement_entry));
+    table->size = new_size;
+
+    // Damage left by an earlier failed parse still needs a successful parse, so it grows to cover this replace too
+    u64 damaged_first = first;
+    u64 damaged_end = first + new_count;
+    if (table->is_damaged)
+    {
+        u64 old_first = map_index(table->damaged_first, first, count, new_count);
+        u64 old_end = map_index(table->damaged_end, first, count, new_count);
+        damaged_first = old_first < damaged_first ? old_first : damaged_first;
+        damaged_end = old_end > damaged_end ? old_end : damaged_end;
+    }
+
+    table->is_damaged = true;
+    table->damaged_first = damaged_first;
+    table->damaged_end = damaged_end;
+
+    return true;
+}
+
+void statement_table_begin_parse(statement_table* table)
+{
+    table->generation++;
+    table->reused_count = 0;
+    table->parsed_count = 0;
+}
+
+void statement_table_end_parse(statement_table* table, b8 success)
+{
+    if (success)
+        table->is_damaged = false;
+}
+
+struct ast_node* statement_table_reuse(statement_table* table, u64 first_token, u64* out_token_count)
+{
+    if (first_token >= table->size)
+        return NULL;
+
+    statement_entry* entry = &table->entries[first_token];
+    if (!entry->node)
+        return NULL;
+
+    // A statement can only be reused if none of the tokens it was parsed from, or peeked at, changed
+    if (table->is_damaged)
+    {
+        u64 scanned_end = first_token + entry->token_count + entry->lookahead_count;
+        if (scanned_end > table->damaged_first && first_token < table->damaged_end)
+            return NULL;
+    }
+
+    entry->generation = table->generation;
+    table->reused_count++;
+
+    *out_token_count = entry->token_count;
+    return entry->node;
+}
+
+void statement_table_record(statement_table* table, u64 first_token, u64 token_count, u64 lookahead_count, struct ast_node* node)
+{
+    if (first_token >= table->size)
+        return;
+
+    // The statements inside of this one were recorded (or reused) before it finished, anything older is left
+    // over from a previous parse of these tokens and must never be reused
+    u64 end = first_token + token_count;
+    for (u64 i = first_token + 1; i < end && i < table->size;)
+    {
+        statement_entry* inner = &table->entries[i];
+        if (inner->node && inner->generation == table->generation)
+        {
+            // Everything inside of a statement of this parse is already up to date
+            i += inner->token_count ? inner->token_count : 1;
+            continue;
+        }
+
+        inner->node = NULL;
+        i++;
+    }
+
+    statement_entry* entry = &table->entries[first_token];
+    entry->node = node;
+    entry->token_count = token_count;
+    entry->lookahead_count = (u32)lookahead_count;
+    entry->generation = table->generation;
+    table->parsed_count++;
+}
+
+
+u64 map_index(u64 index, u64 first, u64 count, u64 new_count)
+{
+    if (index <= first)
+        return index;
+
+    if (index < first + count)
+        return first + new_count;
+
+    return index - count + new_count;
+}
@@ -0,0 +1,88 @@
+#include "ssa/ssa.h"
+
+#include <malloc.h>
+#include <string.h>
+
+void ssa_program_destroy(ssa_program* program)
+{
+    for (u64 i = 0; i < program->function_count; ++i)
+    {
+        ssa_function* function = &program->functions[i];
+        for (u32 j = 0; j < function->block_count; ++j)
+        {
+            free(function->blocks[j].phis);
+            free(function->blocks[j].instructions);
+            free(function->blocks[j].predecessors);
+        }
+
+        free(function->blocks);
+        free(function->instructions);
+        free(function->operands);
+    }
+
+    free(program->functions);
+    free(program->globals);
+
+    memset(program, 0, sizeof(ssa_program));
+}
+
+u32* ssa_operands(const ssa_function* function, u32 instruction)
+{
+    return function->operands + function->instructions[instruction].first_operand;
+}
+
+u32 ssa_successor_count(const ssa_block* block)
+{
+    if (block->terminator == SSA_TERMINATOR_BRANCH)
+        return 2;
+
+    return (block->terminator == SSA_TERMINATOR_JUMP) ? 1 : 0;
+}
+
+u32 ssa_reverse_postorder(const ssa_function* function, u32* out_order)
+{
+    // The search keeps the next successor of each block on its stack beside it, instead of recursing
+    u32* stack = malloc((function->block_count + 1) * sizeof(u32));
+    u8* next_successor = calloc(function->block_count + 1, sizeof(u8));
+    b8* is_visited = calloc(function->block_count + 1, sizeof(b8));
+    if (stack == NULL || next_successor == NULL || is_visited == NULL)
+    {
+        free(stack);
+        free(next_successor);
+        free(is_visited);
+        return SSA_NONE;
+    }
+
+    u32 stack_count = 0;
+    u32 postorder_count = 0;
+    stack[stack_count++] = 0;
+    is_visited[0] = true;
+    while (stack_count > 0)
+    {
+        u32 index = stack[stack_count - 1];
+        const ssa_block* block = &function->blocks[index];
+        if (next_successor[index] < ssa_successor_count(block))
+        {
+            u32 successor = block->successors[next_successor[index]++];
+            if (!is_visited[successor])
+            {
+                is_visited[successor] = true;
+                stack[stack_count++] = successor;
+            }
+
+            continue;
+        }
+
+        // The postorder is written from the end, which leaves the reverse postorder
+        stack_count--;
+        out_order[function->block_count - 1 - postorder_count++] = index;
+    }
+
+    // The blocks never reached left a gap at the start
+    memmove(out_order, out_order + (function->block_count - postorder_count), postorder_count * sizeof(u32));
+
+    free(stack);
+    free(next_successor);
+    free(is_visited);
+    return postorder_count;
+}
@@ -0,0 +1,1647 @@
+#include "ssa/ssa_builder.h"
+#include "parser/abstract_syntax_tree.h"
+#include "typing/symbol_table.h"
+
+#include <malloc.h>
+#include <stdarg.h>
+#include <string.h>
+
+#define DEFAULT_SSA_POOL_CAPACITY 16
+#define DEFAULT_SSA_DEFINITION_CAPACITY 64
+#define DEFAULT_SSA_RESIZE_FACTOR 2
+
+// The most literals of a loop given their own value before the loop, the literals after them are built where they are used
+#define MAX_LOOP_CONSTANTS 64
+
+// The key of a definition slot nothing was stored in
+#define EMPTY_DEFINITION 0xFFFFFFFFFFFFFFFFull
+
+// Stands in for the block of a definition giving the variable a global is a value of in the loops it was promoted in
+#define PROMOTED_GLOBAL_BLOCK SSA_NONE
+
+/**
+ * @brief A variable of a function: a local, a parameter or a global promoted to a value in a loop
+ */
+typedef struct ssa_variable {
+    /* The type of the variable */
+    type_info type;
+    /* The global a promoted global is, SSA_NONE for the locals */
+    u32 global;
+    /* The while statement the global was promoted in, an index into the loops of the builder */
+    u32 loop;
+    /* Set once a promoted global was written in its loop, it is only stored after the loop if it was */
+    b8 is_written;
+} ssa_variable;
+
+/**
+ * @brief The value a variable has at the end of a block, or the variable a global was promoted to
+ */
+typedef struct ssa_definition {
+    /* The variable in the high 32 bits and the block in the low ones, EMPTY_DEFINITION for an empty slot */
+    u64 key;
+    /* The value, SSA_NONE once a promoted global is not a variable anymore */
+    u32 value;
+} ssa_definition;
+
+/**
+ * @brief A phi made in a block whose predecessors were not all known yet, it is given its operands once they are
+ */
+typedef struct incomplete_phi {
+    /* The block the phi is in */
+    u32 block;
+    /* The variable the phi is the value of */
+    u32 variable;
+    /* The phi */
+    u32 phi;
+} incomplete_phi;
+
+/**
+ * @brief A while statement being built
+ */
+typedef struct ssa_loop {
+    /* The block the loop is entered from, where the globals promoted in it are loaded */
+    u32 preheader;
+    /* Set if a function is called in the loop, then the globals a function could see stay in memory */
+    b8 has_calls;
+} ssa_loop;
+
+/**
+ * @brief The state of building a single function
+ */
+typedef struct ssa_builder {
+    /* The program the function is built into */
+    ssa_program* program;
+    /* The context errors are reported to and string literals are interned in */
+    rouleaux_context* context;
+    /* The index of the function in program->functions, the array can move while a nested function is built */
+    u64 function_index;
+
+    /* The variables of the function, the index of the ssa_variable of each is kept in the value of its symbol's token */
+    symbol_table locals;
+    /* The globals of the program, the index of each is kept in the value of its symbol's token */
+    symbol_table* globals;
+    /* Set for every global a function names, those are the globals a call could read or write */
+    const b8* is_global_seen_by_functions;
+    /* True for the top level code, its variables are the globals themselves */
+    b8 is_top_level;
+
+    /* The block instructions are added to */
+    u32 current_block;
+
+    /* Every variable of the function */
+    ssa_variable* variables;
+    /* The amount of variables */
+    u32 variable_count;
+    /* The amount of variables the array can hold */
+    u32 variable_capacity;
+
+    /* The value of each variable at the end of the blocks it was read or written in, an open addressing hash table */
+    ssa_definition* definitions;
+    /* The amount of slots in use */
+    u64 definition_count;
+    /* The amount of slots, a power of 2 */
+    u64 definition_capacity;
+
+    /* Set for each block once all of its predecessors are known */
+    b8* is_sealed;
+    /* The amount of blocks is_sealed can hold */
+    u32 sealed_capacity;
+
+    /* The phis still waiting for the predecessors of their block */
+    incomplete_phi* incomplete_phis;
+    /* The amount of incomplete_phis */
+    u32 incomplete_phi_count;
+    /* The amount of incomplete_phis the array can hold */
+    u32 incomplete_phi_capacity;
+
+    /* For each instruction the value a trivial phi was replaced with, SSA_NONE for every other instruction */
+    u32* forwards;
+    /* The amount of instructions forwards can hold */
+    u32 forward_capacity;
+
+    /* The blocks in the order their code is laid out in, the function's blocks are put in this order once it is built */
+    u32* layout;
+    /* The amount of blocks in the layout */
+    u32 layout_count;
+    /* The amount of blocks the layout can hold */
+    u32 layout_capacity;
+
+    /* The while statements the block being built is in, the innermost one last */
+    ssa_loop* loops;
+    /* The amount of loops */
+    u32 loop_count;
+    /* The amount of loops the array can hold */
+    u32 loop_capacity;
+
+    /* The variables the globals were promoted to in the loops being built, the innermost loop's last */
+    u32* promoted;
+    /* The amount of promoted variables */
+    u32 promoted_count;
+    /* The amount of promoted variables the array can hold */
+    u32 promoted_capacity;
+
+    /* The operands of the phis being given their operands, nested reads of variables push theirs above them */
+    u32* scratch;
+    /* The amount of scratch operands */
+    u32 scratch_count;
+    /* The amount of scratch operands the array can hold */
+    u32 scratch_capacity;
+
+    /* The literals used in the outermost loop being built, each is a constant of the block before that loop. So a loop does
+       not build its literals again on every iteration */
+    u32 loop_constants[MAX_LOOP_CONSTANTS];
+    /* The amount of loop_constants */
+    u32 loop_constant_count;
+
+    /* The name of the variable being declared, a function declared by it is given this name */
+    token declaration_name;
+
+    /* Set once an error was reported, nothing else is built after it */
+    b8 has_error;
+} ssa_builder;
+
+// Gives every top level declaration of a file its global, the top level code of an if or while statement included
+static void collect_globals(ssa_builder* builder, ast_node* statement);
+
+// Adds a global to the program, unless one with the same name was already added
+static b8 declare_global(ssa_builder* builder, token name, type_info type, ast_node* value);
+
+// Sets is_global_seen for every global named in a function declared under a node, in_function is set inside of one
+static void collect_globals_seen_by_functions(ssa_builder* builder, ast_node* node, b8 in_function, b8* is_global_seen);
+
+// True if a function is called anywhere in the statement or expression, the functions declared in it are not called by it
+static b8 contains_call(ast_node* node);
+
+// Starts a new function in the program: its first block holds its parameters, then the second block starts
+static b8 start_function(ssa_builder* builder, token name, token t);
+
+// Ends the function being built with a return, removes the phis which turned out trivial and lays its blocks out
+static void finish_function(ssa_builder* builder, token t);
+
+// Builds the typed top level declarations of a file, then a call to its entry point
+static void build_entry_point(ssa_builder* builder, ast_node* file, const char* entry_point);
+
+// Builds a statement
+static void build_statement(ssa_builder* builder, ast_node* statement);
+
+// Builds a value or const assignment, declaring the variable if the assignment is a declaration
+static void build_assignment(ssa_builder* builder, ast_node* assignment);
+
+// Builds an if statement, both paths join in a new block. A missing else is an empty block, so no branch leads to a join
+static void build_if_statement(ssa_builder* builder, ast_node* if_statement);
+
+// Builds a while statement, its condition is built after its body and tested before it, in a block of its own
+static void build_while_statement(ssa_builder* builder, ast_node* while_statement);
+
+// Builds an expression, giving the value it evaluates to
+static u32 build_expression(ssa_builder* builder, ast_node* expression);
+
+// Builds a binary operator, on operands of the operator's type
+static u32 build_binary_operator(ssa_builder* builder, ast_node* binary_operator);
+
+// Builds a function call, the callee is evaluated before its arguments
+static u32 build_call(ssa_builder* builder, ast_node* function_call);
+
+// Builds the body of a function declaration into a new ssa_function, giving its index in the program's functions
+static u64 build_function(ssa_builder* builder, ast_node* function_declaration);
+
+// Builds a literal, a literal in a loop is a constant of the block before the outermost loop
+static u32 build_literal(ssa_builder* builder, ast_node* literal);
+
+// Gives the value of a global, or of the variable it was promoted to in the loops
+static u32 read_global(ssa_builder* builder, u32 global, token t);
+
+// Sets a global, or the variable it was promoted to in the loops
+static void write_global(ssa_builder* builder, u32 global, u32 value, token t);
+
+// Gives the variable a global was promoted to in the loops being built, promoting it if no call in them could see it.
+// SSA_NONE if it stays in memory
+static u32 promoted_global(ssa_builder* builder, u32 global, token t);
+
+// Stores the globals promoted in the innermost loop back after it, in the block the loop leaves to
+static void store_promoted_globals(ssa_builder* builder, token t);
+
+// Gives the value of a variable at the end of a block
+static u32 read_variable(ssa_builder* builder, u32 variable, u32 block, token t);
+
+// Gives the value of a variable at the end of a block that did not set it, from the predecessors of the block
+static u32 read_variable_from_predecessors(ssa_builder* builder, u32 variable, u32 block, token t);
+
+// Gives the phi the value of the variable at the end of every predecessor of its block, then removes it if it is trivial
+static u32 add_phi_operands(ssa_builder* builder, u32 variable, u32 phi, token t);
+
+// Gives the value a phi can be replaced with when its operands are all the same value (or the phi itself), otherwise the phi
+static u32 trivial_phi_value(ssa_builder* builder, u32 phi);
+
+// Gives the value a trivial phi was replaced with, the value itself if it was not replaced
+static u32 resolve_value(ssa_builder* builder, u32 value);
+
+// Sets the value of a variable at the end of a block
+static void write_variable(ssa_builder* builder, u32 variable, u32 block, u32 value);
+
+// Finds the definition slot of a key, the empty slot it would go in if it has none
+static ssa_definition* find_definition(ssa_builder* builder, u64 key);
+
+// Gives the value of a key, SSA_NONE if it has none
+static u32 lookup_definition(ssa_builder* builder, u32 variable, u32 block);
+
+// Gives a key its value
+static void set_definition(ssa_builder* builder, u32 variable, u32 block, u32 value);
+
+// Adds a variable to the function, giving its index
+static u32 add_variable(ssa_builder* builder, type_info type, u32 global, token t);
+
+// Finds a local of the function, or the index of a global when out_is_global is set
+static b8 find_variable(ssa_builder* builder, token name, u32* out_index, b8* out_is_global);
+
+// Adds a block to the function, giving its index. It is sealed if all of its predecessors are already known
+static u32 add_block(ssa_builder* builder, b8 is_sealed, token t);
+
+// Puts a block at the end of the layout
+static void place_block(ssa_builder* builder, u32 block);
+
+// Adds a predecessor to a block
+static void add_predecessor(ssa_builder* builder, u32 block, u32 predecessor, token t);
+
+// Marks a block as having all of its predecessors, its incomplete phis are given their operands
+static void seal_block(ssa_builder* builder, u32 block, token t);
+
+// Ends a block with a jump to another, which becomes a predecessor of it
+static void jump_to(ssa_builder* builder, u32 block, u32 target, token t);
+
+// Adds an instruction to the end of a block (or to its phis for SSA_OPCODE_PHI), giving its index
+static u32 add_instruction(ssa_builder* builder, u32 block, ssa_opcode opcode, type_info type, const u32* operands, u32 operand_count, token t);
+
+// Adds a constant to the end of a block, giving its index
+static u32 add_constant(ssa_builder* builder, u32 block, ssa_constant constant, type_info type, token t);
+
+// Gives an instruction its operands, at the end of the function's operands
+static void set_operands(ssa_builder* builder, u32 instruction, const u32* operands, u32 operand_count, token t);
+
+// Pushes a value onto the scratch operands
+static void push_scratch(ssa_builder* builder, u32 value, token t);
+
+// Adds a function to the program, giving its index
+static u64 add_function(ssa_builder* builder, token name);
+
+// Frees the state of a builder, the function it built stays in the program
+static void destroy_builder(ssa_builder* builder);
+
+// Makes room for one more element at the end of an array, which holds capacity elements of element_size bytes
+static b8 reserve_element(ssa_builder* builder, void** array, u32 count, u32* capacity, u64 element_size, token t);
+
+// Reports an error to the context, only the first one is reported
+static void build_error(ssa_builder* builder, token t, diagnostic_id id, ...);
+
+
+b8 ssa_build(rouleaux_context* context, ast_node* file, const char* entry_point, ssa_program* out_program)
+{
+    memset(out_program, 0, sizeof(ssa_program));
+
+    symbol_table globals = symbol_table_create_scope(NULL, 0);
+
+    ssa_builder builder = {};
+    builder.program = out_program;
+    builder.context = context;
+    builder.globals = &globals;
+    builder.is_top_level = true;
+
+    token file_token = {};
+    if (file->node.many.children.number_of_nodes > 0)
+        file_token = file->node.many.children.nodes[0]->node.leaf.t;
+
+    // Every global is declared before anything is built, so a function can use the globals declared after it
+    if (entry_point == NULL)
+    {
+        collect_globals(&builder, file);
+    }
+    else
+    {
+        // Only the declarations the entry point needs were typed, those are the ones declared
+        for (u64 i = 0; i < file->node.many.children.number_of_nodes; ++i)
+        {
+            ast_node* statement = file->node.many.children.nodes[i];
+            if (statement->type != AST_VALUE_ASSIGNMENT && statement->type != AST_CONST_ASSIGNMENT)
+                continue;
+
+            if (statement->node.binary.t.typing_information != TYPE_INFO_UNKNOWN)
+                collect_globals(&builder, statement);
+        }
+    }
+
+    b8* is_global_seen = calloc(out_program->global_count + 1, sizeof(b8));
+    if (is_global_seen == NULL)
+        build_error(&builder, file_token, DIAGNOSTIC_SSA_ALLOCATION);
+    else
+        collect_globals_seen_by_functions(&builder, file, false, is_global_seen);
+
+    builder.is_global_seen_by_functions = is_global_seen;
+
+    if (start_function(&builder, (token){}, file_token))
+    {
+        if (entry_point == NULL)
+            build_statement(&builder, file);
+        else
+            build_entry_point(&builder, file, entry_point);
+
+        finish_function(&builder, file_token);
+    }
+
+    free(is_global_seen);
+    destroy_builder(&builder);
+    symbol_table_destroy(&globals);
+
+    return !builder.has_error;
+}
+
+
+
+void collect_globals(ssa_builder* builder, ast_node* statement)
+{
+    switch (statement->type)
+    {
+        case AST_SCOPE:
+        {
+            for (u64 i = 0; i < statement->node.many.children.number_of_nodes; ++i)
+                collect_globals(builder, statement->node.many.children.nodes[i]);
+
+            break;
+        }
+        case AST_VALUE_ASSIGNMENT:
+        case AST_CONST_ASSIGNMENT:
+        {
+            // Only declarations have a type assignment on their left, its left child is the name being declared
+            ast_node* target = statement->node.binary.left_child;
+            if (target->type == AST_TYPE_ASSIGNMENT)
+                declare_global(builder, target->node.binary.left_child->node.leaf.t, statement->node.binary.t.typing_information, statement->node.binary.right_child);
+
+            break;
+        }
+        case AST_IF_STATEMENT:
+        {
+            collect_globals(builder, statement->node.ternary.center_child);
+            if (statement->node.ternary.right_child != NULL)
+                collect_globals(builder, statement->node.ternary.right_child);
+
+            break;
+        }
+        case AST_WHILE_STATEMENT:
+        {
+            collect_globals(builder, statement->node.binary.right_child);
+            break;
+        }
+        default:
+        {
+            // Nothing else declares a variable
+            break;
+        }
+    };
+}
+
+b8 declare_global(ssa_builder* builder, token name, type_info type, ast_node* value)
+{
+    if (symbol_table_find(builder->globals, name) != NULL)
+        return true;
+
+    ssa_program* program = builder->program;
+    if (program->global_count >= program->global_capacity)
+    {
+        u64 new_capacity = program->global_capacity ? program->global_capacity * DEFAULT_SSA_RESIZE_FACTOR : DEFAULT_SSA_POOL_CAPACITY;
+        ssa_global* new_globals = realloc(program->globals, new_capacity * sizeof(ssa_global));
+        if (new_globals == NULL)
+        {
+            build_error(builder, name, DIAGNOSTIC_SSA_ALLOCATION);
+            return false;
+        }
+
+        program->globals = new_globals;
+        program->global_capacity = new_capacity;
+    }
+
+    if (!symbol_table_add(builder->globals, name, type, false))
+    {
+        build_error(builder, name, DIAGNOSTIC_SYMBOL_TABLE_ALLOCATION);
+        return false;
+    }
+
+    symbol* sym = &builder->globals->buffer[builder->globals->size - 1];
+    sym->t.value.unsigned64 = program->global_count;
+    if (value->type == AST_FUNCTION_DECLARATION)
+        sym->function_decl_node = value;
+
+    program->globals[program->global_count] = (ssa_global){ .name = name, .type = type };
+    program->global_count++;
+
+    return true;
+}
+
+void collect_globals_seen_by_functions(ssa_builder* builder, ast_node* node, b8 in_function, b8* is_global_seen)
+{
+    if (node == NULL)
+        return;
+
+    // A local of a function can have the name of a global, the global then counts as seen all the same
+    if (node->type == AST_IDENTIFIER && in_function)
+    {
+        symbol* sym = symbol_table_find(builder->globals, node->node.leaf.t);
+        if (sym != NULL)
+            is_global_seen[sym->t.value.unsigned64] = true;
+
+        return;
+    }
+
+    in_function = in_function || node->type == AST_FUNCTION_DECLARATION;
+    switch (ast_node_child_strategy_from_node_type(node->type))
+    {
+        case CHILD_STRATEGY_UNARY:
+        {
+            collect_globals_seen_by_functions(builder, node->node.unary.child, in_function, is_global_seen);
+            break;
+        }
+        case CHILD_STRATEGY_BINARY:
+        {
+            collect_globals_seen_by_functions(builder, node->node.binary.left_child, in_function, is_global_seen);
+            collect_globals_seen_by_functions(builder, node->node.binary.right_child, in_function, is_global_seen);
+            break;
+        }
+        case CHILD_STRATEGY_TERNARY:
+        {
+            collect_globals_seen_by_functions(builder, node->node.ternary.left_child, in_function, is_global_seen);
+            collect_globals_seen_by_functions(builder, node->node.ternary.center_child, in_function, is_global_seen);
+            collect_globals_seen_by_functions(builder, node->node.ternary.right_child, in_function, is_global_seen);
+            break;
+        }
+        case CHILD_STRATEGY_MANY:
+        {
+            for (u64 i = 0; i < node->node.many.children.number_of_nodes; ++i)
+                collect_globals_seen_by_functions(builder, node->node.many.children.nodes[i], in_function, is_global_seen);
+
+            break;
+        }
+        default:
+        {
+            break;
+        }
+    };
+}
+
+b8 contains_call(ast_node* node)
+{
+    if (node == NULL)
+        return false;
+
+    if (node->type == AST_FUNCTION_CALL)
+        return true;
+
+    // Declaring a function does not run it
+    if (node->type == AST_FUNCTION_DECLARATION)
+        return false;
+
+    switch (ast_node_child_strategy_from_node_type(node->type))
+    {
+        case CHILD_STRATEGY_UNARY:
+        {
+            return contains_call(node->node.unary.child);
+        }
+        case CHILD_STRATEGY_BINARY:
+        {
+            return contains_call(node->node.binary.left_child) || contains_call(node->node.binary.right_child);
+        }
+        case CHILD_STRATEGY_TERNARY:
+        {
+            return contains_call(node->node.ternary.left_child) || contains_call(node->node.ternary.center_child) || contains_call(node->node.ternary.right_child);
+        }
+        case CHILD_STRATEGY_MANY:
+        {
+            for (u64 i = 0; i < node->node.many.children.number_of_nodes; ++i)
+            {
+                if (contains_call(node->node.many.children.nodes[i]))
+                    return true;
+            }
+
+            return false;
+        }
+        default:
+        {
+            return false;
+        }
+    };
+}
+
+b8 start_function(ssa_builder* builder, token name, token t)
+{
+    builder->function_index = add_function(builder, name);
+
+    // The first block is never continued at, it only holds what every other block can use
+    u32 entry = add_block(builder, true, t);
+    place_block(builder, entry);
+
+    builder->current_block = add_block(builder, true, t);
+    place_block(builder, builder->current_block);
+    jump_to(builder, entry, builder->current_block, t);
+
+    return !builder->has_error;
+}
+
+void finish_function(ssa_builder* builder, token t)
+{
+    if (builder->has_error)
+        return;
+
+    ssa_function* function = &builder->program->functions[builder->function_index];
+    ssa_block* last = &function->blocks[builder->current_block];
+    last->terminator = SSA_TERMINATOR_RETURN;
+    last->t = t;
+
+    // A phi is only known to be trivial once the phis it uses are, so the phis are checked again until none is left
+    b8 removed = true;
+    while (removed)
+    {
+        removed = false;
+        for (u32 i = 0; i < function->instruction_count; ++i)
+        {
+            if (function->instructions[i].opcode != SSA_OPCODE_PHI || builder->forwards[i] != SSA_NONE)
+                continue;
+
+            u32 value = trivial_phi_value(builder, i);
+            if (value != i)
+            {
+                builder->forwards[i] = value;
+                removed = true;
+            }
+        }
+    }
+
+    // Every operand is pointed at what its phi was replaced with, and the replaced phis are taken out of their blocks
+    for (u32 i = 0; i < function->operand_count; ++i)
+        function->operands[i] = resolve_value(builder, function->operands[i]);
+
+    for (u32 i = 0; i < function->block_count; ++i)
+    {
+        ssa_block* block = &function->blocks[i];
+        if (block->condition != SSA_NONE)
+            block->condition = resolve_value(builder, block->condition);
+
+        u32 kept = 0;
+        for (u32 j = 0; j < block->phi_count; ++j)
+        {
+            if (builder->forwards[block->phis[j]] == SSA_NONE)
+                block->phis[kept++] = block->phis[j];
+        }
+
+        block->phi_count = kept;
+    }
+
+    // The removed phis are left in the instructions, with no block listing them they are never run
+    for (u32 i = 0; i < function->instruction_count; ++i)
+    {
+        if (builder->forwards[i] != SSA_NONE)
+            function->instructions[i].opcode = SSA_OPCODE_INVALID;
+    }
+
+    // The blocks are put in the order of the layout, a while statement's condition comes after its body
+    ssa_block* laid_out = malloc(function->block_count * sizeof(ssa_block));
+    u32* new_indices = malloc(function->block_count * sizeof(u32));
+    if (laid_out == NULL || new_indices == NULL)
+    {
+        free(laid_out);
+        free(new_indices);
+        build_error(builder, t, DIAGNOSTIC_SSA_ALLOCATION);
+        return;
+    }
+
+    for (u32 i = 0; i < builder->layout_count; ++i)
+    {
+        new_indices[builder->layout[i]] = i;
+        laid_out[i] = function->blocks[builder->layout[i]];
+    }
+
+    for (u32 i = 0; i < function->block_count; ++i)
+    {
+        ssa_block* block = &laid_out[i];
+        for (u32 j = 0; j < block->predecessor_count; ++j)
+            block->predecessors[j] = new_indices[block->predecessors[j]];
+
+        for (u32 j = 0; j < 2; ++j)
+        {
+            if (block->successors[j] != SSA_NONE)
+                block->successors[j] = new_indices[block->successors[j]];
+        }
+    }
+
+    for (u32 i = 0; i < function->instruction_count; ++i)
+        function->instructions[i].block = new_indices[function->instructions[i].block];
+
+    free(function->blocks);
+    free(new_indices);
+    function->blocks = laid_out;
+    function->block_capacity = function->block_count;
+}
+
+void build_entry_point(ssa_builder* builder, ast_node* file, const char* entry_point)
+{
+    for (u64 i = 0; i < file->node.many.children.number_of_nodes && !builder->has_error; ++i)
+    {
+        ast_node* statement = file->node.many.children.nodes[i];
+        if (statement->type != AST_VALUE_ASSIGNMENT && statement->type != AST_CONST_ASSIGNMENT)
+            continue;
+
+        if (statement->node.binary.t.typing_information != TYPE_INFO_UNKNOWN)
+            build_statement(builder, statement);
+    }
+
+    if (builder->has_error)
+        return;
+
+    token name = {};
+    name.text = entry_point;
+    name.length = strlen(entry_point);
+
+    symbol* entry_symbol = symbol_table_find(builder->globals, name);
+    if (entry_symbol == NULL)
+    {
+        // The file's scope has no token of its own, so the error points at the start of the file instead
+        build_error(builder, ast_file_start_token(file), DIAGNOSTIC_UNKNOWN_ENTRY_POINT, diagnostic_string(name.text, name.length));
+        return;
+    }
+
+    if (entry_symbol->type != TYPE_INFO_FUNCTION)
+    {
+        build_error(builder, entry_symbol->t, DIAGNOSTIC_CALL_OF_NON_FUNCTION);
+        return;
+    }
+
+    ast_node* declaration = entry_symbol->function_decl_node;
+    if (declaration != NULL && declaration->node.ternary.left_child->node.many.children.number_of_nodes != 0)
+    {
+        build_error(builder, entry_symbol->t, DIAGNOSTIC_ENTRY_POINT_PARAMETERS, diagnostic_token_text(entry_symbol->t));
+        return;
+    }
+
+    u32 callee = read_global(builder, (u32)entry_symbol->t.value.unsigned64, entry_symbol->t);
+    add_instruction(builder, builder->current_block, SSA_OPCODE_CALL, TYPE_INFO_UNKNOWN, &callee, 1, entry_symbol->t);
+}
+
+void build_statement(ssa_builder* builder, ast_node* statement)
+{
+    if (builder->has_error)
+        return;
+
+    switch (statement->type)
+    {
+        case AST_SCOPE:
+        {
+            for (u64 i = 0; i < statement->node.many.children.number_of_nodes && !builder->has_error; ++i)
+                build_statement(builder, statement->node.many.children.nodes[i]);
+
+            break;
+        }
+        case AST_VALUE_ASSIGNMENT:
+        case AST_CONST_ASSIGNMENT:
+        {
+            build_assignment(builder, statement);
+            break;
+        }
+        case AST_CALL_OPERATOR:
+        {
+            // The value of the call is not used
+            build_expression(builder, statement->node.unary.child);
+            break;
+        }
+        case AST_IF_STATEMENT:
+        {
+            build_if_statement(builder, statement);
+            break;
+        }
+        case AST_WHILE_STATEMENT:
+        {
+            build_while_statement(builder, statement);
+            break;
+        }
+        default:
+        {
+            // Comments, the end of the file and the like have nothing to run
+            break;
+        }
+    };
+}
+
+void build_assignment(ssa_builder* builder, ast_node* assignment)
+{
+    ast_node* target = assignment->node.binary.left_child;
+    ast_node* value = assignment->node.binary.right_child;
+
+    if (target->type == AST_IDENTIFIER)
+    {
+        // Assigning to a variable that was already declared
+        token name = target->node.leaf.t;
+        u32 index = 0;
+        b8 is_global = false;
+        if (!find_variable(builder, name, &index, &is_global))
+        {
+            build_error(builder, name, DIAGNOSTIC_UNDECLARED_VARIABLE, diagnostic_token_text(name));
+            return;
+        }
+
+        u32 result = build_expression(builder, value);
+        if (is_global)
+            write_global(builder, index, result, name);
+        else
+            write_variable(builder, index, builder->current_block, result);
+
+        return;
+    }
+
+    // Otherwise the target is the type assignment of a declaration, its left child is the name being declared
+    token name = target->node.binary.left_child->node.leaf.t;
+    type_info type = assignment->node.binary.t.typing_information;
+    builder->declaration_name = name;
+
+    if (builder->is_top_level)
+    {
+        // The top level variables are the globals, which were all declared already
+        if (!declare_global(builder, name, type, value))
+            return;
+
+        u32 global = (u32)symbol_table_find(builder->globals, name)->t.value.unsigned64;
+        u32 result = build_expression(builder, value);
+        if (builder->has_error)
+            return;
+
+        // A constant can only ever be set to the function it was declared with
+        if (assignment->type == AST_CONST_ASSIGNMENT && value->type == AST_FUNCTION_DECLARATION)
+            builder->program->globals[global].constant_function = builder->program->functions[builder->function_index].instructions[result].constant.function;
+
+        write_global(builder, global, result, name);
+        return;
+    }
+
+    // The value is built before the variable is declared, so it still sees a global of the same name
+    u32 result = build_expression(builder, value);
+    if (builder->has_error)
+        return;
+
+    // Running the same declaration again (i.e. in the body of a loop) just sets the variable again
+    symbol* sym = symbol_table_find(&builder->locals, name);
+    if (sym == NULL)
+    {
+        u32 variable = add_variable(builder, type, SSA_NONE, name);
+        if (!symbol_table_add(&builder->locals, name, type, assignment->type == AST_CONST_ASSIGNMENT))
+        {
+            build_error(builder, name, DIAGNOSTIC_SYMBOL_TABLE_ALLOCATION);
+            return;
+        }
+
+        sym = &builder->locals.buffer[builder->locals.size - 1];
+        sym->t.value.unsigned64 = variable;
+    }
+
+    write_variable(builder, (u32)sym->t.value.unsigned64, builder->current_block, result);
+}
+
+void build_if_statement(ssa_builder* builder, ast_node* if_statement)
+{
+    ast_node* condition = if_statement->node.ternary.left_child;
+    token if_token = if_statement->node.ternary.t;
+
+    u32 condition_value = build_expression(builder, condition);
+    if (builder->has_error)
+        return;
+
+    u32 branch = builder->current_block;
+    u32 then_block = add_block(builder, false, if_token);
+    u32 else_block = add_block(builder, false, if_token);
+    if (builder->has_error)
+        return;
+
+    ssa_block* branch_block = &builder->program->functions[builder->function_index].blocks[branch];
+    branch_block->terminator = SSA_TERMINATOR_BRANCH;
+    branch_block->condition = condition_value;
+    branch_block->successors[0] = then_block;
+    branch_block->successors[1] = else_block;
+    branch_block->t = if_token;
+    add_predecessor(builder, then_block, branch, if_token);
+    add_predecessor(builder, else_block, branch, if_token);
+    seal_block(builder, then_block, if_token);
+    seal_block(builder, else_block, if_token);
+
+    place_block(builder, then_block);
+    builder->current_block = then_block;
+    build_statement(builder, if_statement->node.ternary.center_child);
+    u32 then_end = builder->current_block;
+
+    place_block(builder, else_block);
+    builder->current_block = else_block;
+    if (if_statement->node.ternary.right_child != NULL)
+        build_statement(builder, if_statement->node.ternary.right_child);
+
+    u32 else_end = builder->current_block;
+
+    u32 join = add_block(builder, false, if_token);
+    jump_to(builder, then_end, join, if_token);
+    jump_to(builder, else_end, join, if_token);
+    seal_block(builder, join, if_token);
+
+    place_block(builder, join);
+    builder->current_block = join;
+}
+
+void build_while_statement(ssa_builder* builder, ast_node* while_statement)
+{
+    ast_node* condition = while_statement->node.binary.left_child;
+    token while_token = while_statement->node.binary.t;
+
+    if (!reserve_element(builder, (void**)&builder->loops, builder->loop_count, &builder->loop_capacity, sizeof(ssa_loop), while_token))
+        return;
+
+    // The literals of an outermost loop are only built before it, they are not kept across the code between loops
+    if (builder->loop_count == 0)
+        builder->loop_constant_count = 0;
+
+    u32 preheader = builder->current_block;
+    builder->loops[builder->loop_count++] = (ssa_loop){ .preheader = preheader, .has_calls = contains_call(while_statement) };
+
+    // The condition is laid out after the body, so every iteration only runs a single jump back to the start
+    u32 header = add_block(builder, false, while_token);
+    u32 body = add_block(builder, false, while_token);
+    if (builder->has_error)
+        return;
+
+    jump_to(builder, preheader, header, while_token);
+    add_predecessor(builder, body, header, while_token);
+    seal_block(builder, body, while_token);
+
+    place_block(builder, body);
+    builder->current_block = body;
+    build_statement(builder, while_statement->node.binary.right_child);
+
+    // Every path into the header is known once the body is built
+    jump_to(builder, builder->current_block, header, while_token);
+    seal_block(builder, header, while_token);
+
+    place_block(builder, header);
+    builder->current_block = header;
+    u32 condition_value = build_expression(builder, condition);
+
+    u32 exit = add_block(builder, false, while_token);
+    if (builder->has_error)
+        return;
+
+    // The exit is after the loop, even though it was added while the loop was built
+    builder->program->functions[builder->function_index].blocks[exit].loop_depth = builder->loop_count - 1;
+
+    ssa_block* header_block = &builder->program->functions[builder->function_index].blocks[builder->current_block];
+    header_block->terminator = SSA_TERMINATOR_BRANCH;
+    header_block->condition = condition_value;
+    header_block->successors[0] = body;
+    header_block->successors[1] = exit;
+    header_block->t = while_token;
+    add_predecessor(builder, body, builder->current_block, while_token);
+    add_predecessor(builder, exit, builder->current_block, while_token);
+    seal_block(builder, exit, while_token);
+
+    place_block(builder, exit);
+    builder->current_block = exit;
+    store_promoted_globals(builder, while_token);
+    builder->loop_count--;
+}
+
+u32 build_expression(ssa_builder* builder, ast_node* expression)
+{
+    if (builder->has_error)
+        return 0;
+
+    token t = expression->node.leaf.t;
+    switch (expression->type)
+    {
+        case AST_INTEGER_LITERAL:
+        case AST_FLOAT_LITERAL:
+        case AST_STRING_LITERAL:
+        {
+            return build_literal(builder, expression);
+        }
+        case AST_IDENTIFIER:
+        {
+            u32 index = 0;
+            b8 is_global = false;
+            if (!find_variable(builder, t, &index, &is_global))
+            {
+                build_error(builder, t, DIAGNOSTIC_UNDECLARED_SYMBOL, diagnostic_token_text(t));
+                return 0;
+            }
+
+            if (is_global)
+                return read_global(builder, index, t);
+
+            return read_variable(builder, index, builder->current_block, t);
+        }
+        case AST_BINARY_OPERATOR_PLUS:
+        case AST_BINARY_OPERATOR_MINUS:
+        case AST_BINARY_OPERATOR_MULTIPLY:
+        case AST_BINARY_OPERATOR_DIVIDE:
+        case AST_BINARY_OPERATOR_MODULUS:
+        case AST_BINARY_OPERATOR_GREATER_THAN:
+        case AST_BINARY_OPERATOR_LESS_THAN:
+        {
+            return build_binary_operator(builder, expression);
+        }
+        case AST_FUNCTION_DECLARATION:
+        {
+            ssa_constant constant = { .function = build_function(builder, expression) };
+            return add_constant(builder, builder->current_block, constant, TYPE_INFO_FUNCTION, t);
+        }
+        case AST_FUNCTION_CALL:
+        {
+            return build_call(builder, expression);
+        }
+        default:
+        {
+            // Nothing else is an expression
+            return add_constant(builder, builder->current_block, (ssa_constant){}, t.typing_information, t);
+        }
+    };
+}
+
+u32 build_binary_operator(ssa_builder* builder, ast_node* binary_operator)
+{
+    // Both operands have the operator's type, the typing made sure of that
+    token operator_token = binary_operator->node.binary.t;
+    type_info type = operator_token.typing_information;
+    if (type != TYPE_INFO_INTEGER && type != TYPE_INFO_FLOAT)
+    {
+        const char* type_name = (type == TYPE_INFO_STRING) ? "strings" : "functions";
+        build_error(builder, operator_token, DIAGNOSTIC_UNSUPPORTED_OPERATOR, diagnostic_token_text(operator_token), diagnostic_string(type_name, strlen(type_name)));
+        return 0;
+    }
+
+    // The left operand is read before the right one runs, a call on the right could change a global on the left
+    u32 operands[2] = {};
+    operands[0] = build_expression(builder, binary_operator->node.binary.left_child);
+    operands[1] = build_expression(builder, binary_operator->node.binary.right_child);
+
+    ssa_opcode opcode = SSA_OPCODE_INVALID;
+    switch (binary_operator->type)
+    {
+        case AST_BINARY_OPERATOR_PLUS:          opcode = SSA_OPCODE_ADD; break;
+        case AST_BINARY_OPERATOR_MINUS:         opcode = SSA_OPCODE_SUBTRACT; break;
+        case AST_BINARY_OPERATOR_MULTIPLY:      opcode = SSA_OPCODE_MULTIPLY; break;
+        case AST_BINARY_OPERATOR_DIVIDE:        opcode = SSA_OPCODE_DIVIDE; break;
+        case AST_BINARY_OPERATOR_MODULUS:       opcode = SSA_OPCODE_MODULUS; break;
+        case AST_BINARY_OPERATOR_GREATER_THAN:  opcode = SSA_OPCODE_GREATER_THAN; break;
+        default:                                opcode = SSA_OPCODE_LESS_THAN; break;
+    };
+
+    return add_instruction(builder, builder->current_block, opcode, type, operands, 2, operator_token);
+}
+
+u32 build_call(ssa_builder* builder, ast_node* function_call)
+{
+    ast_node* callee = function_call->node.binary.left_child;
+    node_list* arguments = &function_call->node.binary.right_child->node.many.children;
+    token name = callee->node.leaf.t;
+
+    // The callee and the arguments are kept on the scratch operands, building an argument can push its own above them
+    u32 first = builder->scratch_count;
+    push_scratch(builder, build_expression(builder, callee), name);
+    for (u64 i = 0; i < arguments->number_of_nodes && !builder->has_error; ++i)
+        push_scratch(builder, build_expression(builder, arguments->nodes[i]), name);
+
+    if (builder->has_error)
+        return 0;
+
+    u32 result = add_instruction(builder, builder->current_block, SSA_OPCODE_CALL, function_call->node.binary.t.typing_information, builder->scratch + first, builder->scratch_count - first, name);
+    builder->scratch_count = first;
+
+    return result;
+}
+
+u64 build_function(ssa_builder* builder, ast_node* function_declaration)
+{
+    token t = function_declaration->node.ternary.t;
+
+    ssa_builder function = {};
+    function.program = builder->program;
+    function.context = builder->context;
+    function.globals = builder->globals;
+    function.is_global_seen_by_functions = builder->is_global_seen_by_functions;
+
+    // A function only sees its own variables and the globals, never the variables of its caller
+    function.locals = symbol_table_create_scope(NULL, 0);
+
+    if (builder->has_error || !start_function(&function, builder->declaration_name, t))
+    {
+        builder->has_error = true;
+        destroy_builder(&function);
+        return 0;
+    }
+
+    // Every parameter is a type assignment ('name: type'), its value is the parameter the function was called with
+    node_list* parameters = &function_declaration->node.ternary.left_child->node.many.children;
+    for (u64 i = 0; i < parameters->number_of_nodes && !function.has_error; ++i)
+    {
+        token parameter = parameters->nodes[i]->node.binary.left_child->node.leaf.t;
+        u32 variable = add_variable(&function, parameter.typing_information, SSA_NONE, parameter);
+        u32 value = add_instruction(&function, 0, SSA_OPCODE_PARAMETER, parameter.typing_information, NULL, 0, parameter);
+        if (function.has_error)
+            break;
+
+        function.program->functions[function.function_index].instructions[value].index = i;
+        set_definition(&function, variable, 0, value);
+
+        if (!symbol_table_add(&function.locals, parameter, parameter.typing_information, false))
+        {
+            build_error(&function, parameter, DIAGNOSTIC_SYMBOL_TABLE_ALLOCATION);
+            break;
+        }
+
+        function.locals.buffer[function.locals.size - 1].t.value.unsigned64 = variable;
+    }
+
+    ssa_function* built = &builder->program->functions[function.function_index];
+    built->parameter_count = (u16)parameters->number_of_nodes;
+    built->return_type = function_declaration->node.ternary.center_child->node.leaf.t.typing_information;
+
+    build_statement(&function, function_declaration->node.ternary.right_child);
+    finish_function(&function, t);
+
+    destroy_builder(&function);
+
+    // The error was already reported by the function's builder
+    if (function.has_error)
+        builder->has_error = true;
+
+    return function.function_index;
+}
+
+u32 build_literal(ssa_builder* builder, ast_node* literal)
+{
+    token t = literal->node.leaf.t;
+    ssa_constant constant = {};
+    type_info type = TYPE_INFO_STRING;
+    if (literal->type != AST_STRING_LITERAL)
+    {
+        type = (literal->type == AST_INTEGER_LITERAL) ? TYPE_INFO_INTEGER : TYPE_INFO_FLOAT;
+        constant.bits = t.value.unsigned64;
+    }
+    else
+    {
+        // The token's text still has its quotes
+        constant.string = context_intern(builder->context, t.text + 1, t.length - 2);
+        if (constant.string == NULL)
+        {
+            build_error(builder, t, DIAGNOSTIC_SSA_ALLOCATION);
+            return 0;
+        }
+    }
+
+    if (builder->loop_count == 0)
+        return add_constant(builder, builder->current_block, constant, type, t);
+
+    // A literal of a loop is built once, before the outermost loop, and used by every iteration
+    ssa_function* function = &builder->program->functions[builder->function_index];
+    for (u32 i = 0; i < builder->loop_constant_count; ++i)
+    {
+        ssa_instruction* loop_constant = &function->instructions[builder->loop_constants[i]];
+        if (loop_constant->constant.bits == constant.bits && loop_constant->type == type)
+            return builder->loop_constants[i];
+    }
+
+    if (builder->loop_constant_count >= MAX_LOOP_CONSTANTS)
+        return add_constant(builder, builder->current_block, constant, type, t);
+
+    u32 result = add_constant(builder, builder->loops[0].preheader, constant, type, t);
+    builder->loop_constants[builder->loop_constant_count++] = result;
+    return result;
+}
+
+u32 read_global(ssa_builder* builder, u32 global, token t)
+{
+    u32 variable = promoted_global(builder, global, t);
+    if (variable != SSA_NONE)
+        return read_variable(builder, variable, builder->current_block, t);
+
+    u32 load = add_instruction(builder, builder->current_block, SSA_OPCODE_LOAD_GLOBAL, builder->program->globals[global].type, NULL, 0, t);
+    if (!builder->has_error)
+        builder->program->functions[builder->function_index].instructions[load].index = global;
+
+    return load;
+}
+
+void write_global(ssa_builder* builder, u32 global, u32 value, token t)
+{
+    u32 variable = promoted_global(builder, global, t);
+    if (variable != SSA_NONE)
+    {
+        builder->variables[variable].is_written = true;
+        write_variable(builder, variable, builder->current_block, value);
+        return;
+    }
+
+    u32 store = add_instruction(builder, builder->current_block, SSA_OPCODE_STORE_GLOBAL, builder->program->globals[global].type, &value, 1, t);
+    if (!builder->has_error)
+        builder->program->functions[builder->function_index].instructions[store].index = global;
+}
+
+u32 promoted_global(ssa_builder* builder, u32 global, token t)
+{
+    if (builder->has_error || builder->loop_count == 0)
+        return SSA_NONE;
+
+    u32 variable = lookup_definition(builder, global, PROMOTED_GLOBAL_BLOCK);
+    if (variable != SSA_NONE)
+        return variable;
+
+    // A call of a loop can see the global if a function names it. Calling in a loop means calling in every loop around it,
+    // so the global is promoted in the outermost loop calling nothing, the innermost one if that calls nothing either
+    u32 loop = 0;
+    if (builder->is_global_seen_by_functions[global])
+    {
+        loop = builder->loop_count;
+        while (loop > 0 && !builder->loops[loop - 1].has_calls)
+            loop--;
+
+        if (loop == builder->loop_count)
+            return SSA_NONE;
+    }
+
+    // The global is loaded right before the loop, its value on every path into the loop
+    u32 preheader = builder->loops[loop].preheader;
+    variable = add_variable(builder, builder->program->globals[global].type, global, t);
+    u32 load = add_instruction(builder, preheader, SSA_OPCODE_LOAD_GLOBAL, builder->program->globals[global].type, NULL, 0, t);
+    if (builder->has_error)
+        return SSA_NONE;
+
+    builder->program->functions[builder->function_index].instructions[load].index = global;
+    builder->variables[variable].loop = loop;
+    if (reserve_element(builder, (void**)&builder->promoted, builder->promoted_count, &builder->promoted_capacity, sizeof(u32), t))
+        builder->promoted[builder->promoted_count++] = variable;
+
+    set_definition(builder, variable, preheader, load);
+    set_definition(builder, global, PROMOTED_GLOBAL_BLOCK, variable);
+
+    return builder->has_error ? SSA_NONE : variable;
+}
+
+void store_promoted_globals(ssa_builder* builder, token t)
+{
+    // A global first used in an inner loop can be promoted in an outer one, so the loops are not in order
+    u32 loop = builder->loop_count - 1;
+    u32 kept = 0;
+    for (u32 i = 0; i < builder->promoted_count && !builder->has_error; ++i)
+    {
+        u32 variable = builder->promoted[i];
+        if (builder->variables[variable].loop != loop)
+        {
+            builder->promoted[kept++] = variable;
+            continue;
+        }
+
+        // After the loop the global is in memory again
+        u32 global = builder->variables[variable].global;
+        set_definition(builder, global, PROMOTED_GLOBAL_BLOCK, SSA_NONE);
+        if (!builder->variables[variable].is_written)
+            continue;
+
+        u32 value = read_variable(builder, variable, builder->current_block, t);
+        u32 store = add_instruction(builder, builder->current_block, SSA_OPCODE_STORE_GLOBAL, builder->variables[variable].type, &value, 1, t);
+        if (!builder->has_error)
+            builder->program->functions[builder->function_index].instructions[store].index = global;
+    }
+
+    builder->promoted_count = kept;
+}
+
+u32 read_variable(ssa_builder* builder, u32 variable, u32 block, token t)
+{
+    if (builder->has_error)
+        return 0;
+
+    u32 value = lookup_definition(builder, variable, block);
+    if (value != SSA_NONE)
+        return resolve_value(builder, value);
+
+    return read_variable_from_predecessors(builder, variable, block, t);
+}
+
+u32 read_variable_from_predecessors(ssa_builder* builder, u32 variable, u32 block, token t)
+{
+    ssa_block* current = &builder->program->functions[builder->function_index].blocks[block];
+    type_info type = builder->variables[variable].type;
+    u32 value = 0;
+
+    if (!builder->is_sealed[block])
+    {
+        // The phi is given its operands once the block is sealed
+        value = add_instruction(builder, block, SSA_OPCODE_PHI, type, NULL, 0, t);
+        if (builder->has_error || !reserve_element(builder, (void**)&builder->incomplete_phis, builder->incomplete_phi_count, &builder->incomplete_phi_capacity, sizeof(incomplete_phi), t))
+            return 0;
+
+        builder->incomplete_phis[builder->incomplete_phi_count++] = (incomplete_phi){ block, variable, value };
+    }
+    else if (current->predecessor_count == 0)
+    {
+        // A variable read before it was ever set is zero, like the registers of the vm
+        value = add_constant(builder, 0, (ssa_constant){}, type, t);
+    }
+    else if (current->predecessor_count == 1)
+    {
+        value = read_variable(builder, variable, current->predecessors[0], t);
+    }
+    else
+    {
+        // The phi is the variable's value while its operands are read, which ends the search around a loop
+        value = add_instruction(builder, block, SSA_OPCODE_PHI, type, NULL, 0, t);
+        set_definition(builder, variable, block, value);
+        value = add_phi_operands(builder, variable, value, t);
+    }
+
+    set_definition(builder, variable, block, value);
+    return value;
+}
+
+u32 add_phi_operands(ssa_builder* builder, u32 variable, u32 phi, token t)
+{
+    if (builder->has_error)
+        return 0;
+
+    u32 block = builder->program->functions[builder->function_index].instructions[phi].block;
+    u32 first = builder->scratch_count;
+    for (u32 i = 0; !builder->has_error; ++i)
+    {
+        // Reading a predecessor can add blocks, so the block is looked up again every time
+        ssa_block* current = &builder->program->functions[builder->function_index].blocks[block];
+        if (i >= current->predecessor_count)
+            break;
+
+        push_scratch(builder, read_variable(builder, variable, current->predecessors[i], t), t);
+    }
+
+    if (builder->has_error)
+        return 0;
+
+    set_operands(builder, phi, builder->scratch + first, builder->scratch_count - first, t);
+    builder->scratch_count = first;
+
+    u32 value = trivial_phi_value(builder, phi);
+    if (value != phi)
+        builder->forwards[phi] = value;
+
+    return value;
+}
+
+u32 trivial_phi_value(ssa_builder* builder, u32 phi)
+{
+    ssa_function* function = &builder->program->functions[builder->function_index];
+    ssa_instruction* instruction = &function->instructions[phi];
+
+    u32 same = SSA_NONE;
+    for (u32 i = 0; i < instruction->operand_count; ++i)
+    {
+        u32 operand = resolve_value(builder, function->operands[instruction->first_operand + i]);
+        if (operand == same || operand == phi)
+            continue;
+
+        // Two different values join here
+        if (same != SSA_NONE)
+            return phi;
+
+        same = operand;
+    }
+
+    // Every block can be reached from the first one, so a phi always has an operand besides itself
+    return (same == SSA_NONE) ? phi : same;
+}
+
+u32 resolve_value(ssa_builder* builder, u32 value)
+{
+    u32 resolved = value;
+    while (builder->forwards[resolved] != SSA_NONE)
+        resolved = builder->forwards[resolved];
+
+    // The chain is shortened, so it is only ever walked once
+    while (builder->forwards[value] != SSA_NONE && builder->forwards[value] != resolved)
+    {
+        u32 next = builder->forwards[value];
+        builder->forwards[value] = resolved;
+        value = next;
+    }
+
+    return resolved;
+}
+
+void write_variable(ssa_builder* builder, u32 variable, u32 block, u32 value)
+{
+    if (!builder->has_error)
+        set_definition(builder, variable, block, value);
+}
+
+ssa_definition* find_definition(ssa_builder* builder, u64 key)
+{
+    // Fibonacci hashing spreads the keys of neighbouring blocks over the whole table
+    u64 mask = builder->definition_capacity - 1;
+    u64 slot = (key * 0x9E3779B97F4A7C15ull) >> 32 & mask;
+    while (builder->definitions[slot].key != EMPTY_DEFINITION && builder->definitions[slot].key != key)
+        slot = (slot + 1) & mask;
+
+    return &builder->definitions[slot];
+}
+
+u32 lookup_definition(ssa_builder* builder, u32 variable, u32 block)
+{
+    if (builder->definition_count == 0)
+        return SSA_NONE;
+
+    ssa_definition* definition = find_definition(builder, (u64)variable << 32 | block);
+    return (definition->key == EMPTY_DEFINITION) ? SSA_NONE : definition->value;
+}
+
+void set_definition(ssa_builder* builder, u32 variable, u32 block, u32 value)
+{
+    if (builder->has_error)
+        return;
+
+    // The table is grown while it is at most half full, so a search always ends at an empty slot soon
+    if ((builder->definition_count + 1) * 2 > builder->definition_capacity)
+    {
+        u64 new_capacity = builder->definition_capacity ? builder->definition_capacity * DEFAULT_SSA_RESIZE_FACTOR : DEFAULT_SSA_DEFINITION_CAPACITY;
+        ssa_definition* new_definitions = malloc(new_capacity * sizeof(ssa_definition));
+        if (new_definitions == NULL)
+        {
+            build_error(builder, (token){}, DIAGNOSTIC_SSA_ALLOCATION);
+            return;
+        }
+
+        ssa_definition* old_definitions = builder->definitions;
+        u64 old_capacity = builder->definition_capacity;
+        memset(new_definitions, 0xFF, new_capacity * sizeof(ssa_definition));
+        builder->definitions = new_definitions;
+        builder->definition_capacity = new_capacity;
+
+        for (u64 i = 0; i < old_capacity; ++i)
+        {
+            if (old_definitions[i].key != EMPTY_DEFINITION)
+                *find_definition(builder, old_definitions[i].key) = old_definitions[i];
+        }
+
+        free(old_definitions);
+    }
+
+    u64 key = (u64)variable << 32 | block;
+    ssa_definition* definition = find_definition(builder, key);
+    if (definition->key == EMPTY_DEFINITION)
+        builder->definition_count++;
+
+    definition->key = key;
+    definition->value = value;
+}
+
+u32 add_variable(ssa_builder* builder, type_info type, u32 global, token t)
+{
+    if (builder->has_error || !reserve_element(builder, (void**)&builder->variables, builder->variable_count, &builder->variable_capacity, sizeof(ssa_variable), t))
+        return 0;
+
+    builder->variables[builder->variable_count] = (ssa_variable){ .type = type, .global = global, .loop = SSA_NONE };
+    return builder->variable_count++;
+}
+
+b8 find_variable(ssa_builder* builder, token name, u32* out_index, b8* out_is_global)
+{
+    symbol* sym = builder->is_top_level ? NULL : symbol_table_find(&builder->locals, name);
+    if (sym != NULL)
+    {
+        *out_index = (u32)sym->t.value.unsigned64;
+        *out_is_global = false;
+        return true;
+    }
+
+    sym = symbol_table_find(builder->globals, name);
+    if (sym == NULL)
+        return false;
+
+    *out_index = (u32)sym->t.value.unsigned64;
+    *out_is_global = true;
+    return true;
+}
+
+u32 add_block(ssa_builder* builder, b8 is_sealed, token t)
+{
+    if (builder->has_error)
+        return 0;
+
+    ssa_function* function = &builder->program->functions[builder->function_index];
+    if (!reserve_element(builder, (void**)&function->blocks, function->block_count, &function->block_capacity, sizeof(ssa_block), t) ||
+        !reserve_element(builder, (void**)&builder->is_sealed, function->block_count, &builder->sealed_capacity, sizeof(b8), t))
+    {
+        return 0;
+    }
+
+    ssa_block* block = &function->blocks[function->block_count];
+    memset(block, 0, sizeof(ssa_block));
+    block->terminator = SSA_TERMINATOR_JUMP;
+    block->condition = SSA_NONE;
+    block->successors[0] = SSA_NONE;
+    block->successors[1] = SSA_NONE;
+    block->t = t;
+    block->loop_depth = builder->loop_count;
+
+    builder->is_sealed[function->block_count] = is_sealed;
+    return function->block_count++;
+}
+
+void place_block(ssa_builder* builder, u32 block)
+{
+    if (!builder->has_error && reserve_element(builder, (void**)&builder->layout, builder->layout_count, &builder->layout_capacity, sizeof(u32), (token){}))
+        builder->layout[builder->layout_count++] = block;
+}
+
+void add_predecessor(ssa_builder* builder, u32 block, u32 predecessor, token t)
+{
+    if (builder->has_error)
+        return;
+
+    ssa_block* target = &builder->program->functions[builder->function_index].blocks[block];
+    if (reserve_element(builder, (void**)&target->predecessors, target->predecessor_count, &target->predecessor_capacity, sizeof(u32), t))
+        target->predecessors[target->predecessor_count++] = predecessor;
+}
+
+void seal_block(ssa_builder* builder, u32 block, token t)
+{
+    if (builder->has_error)
+        return;
+
+    builder->is_sealed[block] = true;
+
+    // Completing a phi can make incomplete phis of other blocks, which are added after the ones of this block
+    u32 kept = 0;
+    for (u32 i = 0; i < builder->incomplete_phi_count && !builder->has_error; ++i)
+    {
+        incomplete_phi waiting = builder->incomplete_phis[i];
+        if (waiting.block != block)
+        {
+            builder->incomplete_phis[kept++] = waiting;
+            continue;
+        }
+
+        add_phi_operands(builder, waiting.variable, waiting.phi, t);
+    }
+
+    builder->incomplete_phi_count = kept;
+}
+
+void jump_to(ssa_builder* builder, u32 block, u32 target, token t)
+{
+    if (builder->has_error)
+        return;
+
+    ssa_block* source = &builder->program->functions[builder->function_index].blocks[block];
+    source->terminator = SSA_TERMINATOR_JUMP;
+    source->successors[0] = target;
+    source->t = t;
+    add_predecessor(builder, target, block, t);
+}
+
+u32 add_instruction(ssa_builder* builder, u32 block, ssa_opcode opcode, type_info type, const u32* operands, u32 operand_count, token t)
+{
+    if (builder->has_error)
+        return 0;
+
+    ssa_function* function = &builder->program->functions[builder->function_index];
+    if (!reserve_element(builder, (void**)&function->instructions, function->instruction_count, &function->instruction_capacity, sizeof(ssa_instruction), t) ||
+        !reserve_element(builder, (void**)&builder->forwards, function->instruction_count, &builder->forward_capacity, sizeof(u32), t))
+    {
+        return 0;
+    }
+
+    u32 index = function->instruction_count++;
+    function->instructions[index] = (ssa_instruction){ .opcode = (u8)opcode, .type = type, .block = block, .t = t };
+    builder->forwards[index] = SSA_NONE;
+    set_operands(builder, index, operands, operand_count, t);
+
+    ssa_block* target = &function->blocks[block];
+    if (opcode == SSA_OPCODE_PHI)
+    {
+        if (reserve_element(builder, (void**)&target->phis, target->phi_count, &target->phi_capacity, sizeof(u32), t))
+            target->phis[target->phi_count++] = index;
+    }
+    else
+    {
+        if (reserve_element(builder, (void**)&target->instructions, target->instruction_count, &target->instruction_capacity, sizeof(u32), t))
+            target->instructions[target->instruction_count++] = index;
+    }
+
+    return index;
+}
+
+u32 add_constant(ssa_builder* builder, u32 block, ssa_constant constant, type_info type, token t)
+{
+    u32 index = add_instruction(builder, block, SSA_OPCODE_CONSTANT, type, NULL, 0, t);
+    if (!builder->has_error)
+        builder->program->functions[builder->function_index].instructions[index].constant = constant;
+
+    return index;
+}
+
+void set_operands(ssa_builder* builder, u32 instruction, const u32* operands, u32 operand_count, token t)
+{
+    ssa_function* function = &builder->program->functions[builder->function_index];
+    if (function->operand_count + operand_count > function->operand_capacity)
+    {
+        u32 new_capacity = function->operand_capacity ? function->operand_capacity : DEFAULT_SSA_POOL_CAPACITY;
+        while (function->operand_count + operand_count > new_capacity)
+            new_capacity *= DEFAULT_SSA_RESIZE_FACTOR;
+
+        u32* new_operands = realloc(function->operands, new_capacity * sizeof(u32));
+        if (new_operands == NULL)
+        {
+            build_error(builder, t, DIAGNOSTIC_SSA_ALLOCATION);
+            return;
+        }
+
+        function->operands = new_operands;
+        function->operand_capacity = new_capacity;
+    }
+
+    // The operands can be the scratch operands, which are never the function's own
+    if (operand_count > 0)
+        memcpy(function->operands + function->operand_count, operands, operand_count * sizeof(u32));
+
+    function->instructions[instruction].first_operand = function->operand_count;
+    function->instructions[instruction].operand_count = operand_count;
+    function->operand_count += operand_count;
+}
+
+void push_scratch(ssa_builder* builder, u32 value, token t)
+{
+    if (!builder->has_error && reserve_element(builder, (void**)&builder->scratch, builder->scratch_count, &builder->scratch_capacity, sizeof(u32), t))
+        builder->scratch[builder->scratch_count++] = value;
+}
+
+u64 add_function(ssa_builder* builder, token name)
+{
+    ssa_program* program = builder->program;
+    if (program->function_count >= program->function_capacity)
+    {
+        u64 new_capacity = program->function_capacity ? program->function_capacity * DEFAULT_SSA_RESIZE_FACTOR : DEFAULT_SSA_POOL_CAPACITY;
+        ssa_function* new_functions = realloc(program->functions, new_capacity * sizeof(ssa_function));
+        if (new_functions == NULL)
+        {
+            build_error(builder, name, DIAGNOSTIC_SSA_ALLOCATION);
+            return 0;
+        }
+
+        program->functions = new_functions;
+        program->function_capacity = new_capacity;
+    }
+
+    memset(&program->functions[program->function_count], 0, sizeof(ssa_function));
+    program->functions[program->function_count].name = name;
+
+    return program->function_count++;
+}
+
+void destroy_builder(ssa_builder* builder)
+{
+    // The top level builder has no locals, destroying its empty table is fine all the same
+    symbol_table_destroy(&builder->locals);
+    free(builder->variables);
+    free(builder->definitions);
+    free(builder->is_sealed);
+    free(builder->incomplete_phis);
+    free(builder->forwards);
+    free(builder->layout);
+    free(builder->loops);
+    free(builder->promoted);
+    free(builder->scratch);
+}
+
+b8 reserve_element(ssa_builder* builder, void** array, u32 count, u32* capacity, u64 element_size, token t)
+{
+    if (count < *capacity)
+        return true;
+
+    u32 new_capacity = *capacity ? *capacity * DEFAULT_SSA_RESIZE_FACTOR : DEFAULT_SSA_POOL_CAPACITY;
+    void* new_array = realloc(*array, new_capacity * element_size);
+    if (new_array == NULL)
+    {
+        build_error(builder, t, DIAGNOSTIC_SSA_ALLOCATION);
+        return false;
+    }
+
+    *array = new_array;
+    *capacity = new_capacity;
+    return true;
+}
+
+void build_error(ssa_builder* builder, token t, diagnostic_id id, ...)
+{
+    if (builder->has_error)
+        return;
+
+    va_list params;
+    va_start(params, id);
+    error_report report = error_report_create(t, id, params);
+    va_end(params);
+
+    context_report_error(builder->context, report);
+    builder->has_error = true;
+}
@@ -0,0 +1,1249 @@
+#include "ssa/ssa_optimizer.h"
+
+#include <malloc.h>
+#include <math.h>
+#include <string.h>
+
+// Set on an entry of the users of a value when the user is the condition of a block, the rest of the entry is the block
+#define USER_IS_BLOCK 0x80000000
+
+/**
+ * @brief The state of a value in sparse conditional constant propagation, a value only ever moves to a later state
+ */
+typedef enum lattice_state {
+    LATTICE_TOP = 0,    // nothing is known yet, no executable path defined the value
+    LATTICE_CONSTANT,   // the same constant on every executable path
+    LATTICE_BOTTOM,     // can differ from run to run
+} lattice_state;
+
+/**
+ * @brief The dominator tree of the blocks of a function reachable from its first block
+ */
+typedef struct dominator_tree {
+    /* The reachable blocks in reverse postorder, a block comes after every block dominating it */
+    u32* order;
+    /* The amount of reachable blocks */
+    u32 order_count;
+    /* The position of each block in the order, SSA_NONE for an unreachable block */
+    u32* order_index;
+    /* The immediate dominator of each block, the first block is its own */
+    u32* idom;
+    /* The first block each block immediately dominates, SSA_NONE if it dominates none */
+    u32* first_child;
+    /* The next block immediately dominated by the same block, SSA_NONE for the last one */
+    u32* next_sibling;
+} dominator_tree;
+
+/**
+ * @brief A value in the value numbering table, the values of a bucket are chained from the last one added
+ */
+typedef struct value_entry {
+    /* The instruction defining the value */
+    u32 instruction;
+    /* The bucket of the instruction */
+    u32 bucket;
+    /* The value added to the bucket before this one, SSA_NONE for the first */
+    u32 next;
+} value_entry;
+
+/**
+ * @brief The value a global had before a load or store changed what is known of it, to restore it when leaving the block
+ */
+typedef struct memory_change {
+    /* The global */
+    u32 global;
+    /* The value known before the change */
+    u32 value;
+    /* The scope the known value belonged to */
+    u32 scope;
+} memory_change;
+
+/**
+ * @brief A block of the dominator tree being numbered, with what to undo once the blocks it dominates are numbered
+ */
+typedef struct numbering_frame {
+    /* The block */
+    u32 block;
+    /* The next block it dominates to number, SSA_NONE once they all were */
+    u32 child;
+    /* The amount of values in the table before the block was numbered */
+    u32 value_mark;
+    /* The amount of memory changes before the block was numbered */
+    u32 memory_mark;
+    /* The memory scope at the end of the block, a block with no other predecessor continues it */
+    u32 scope;
+} numbering_frame;
+
+/**
+ * @brief The state the passes share across the functions of a program, what is sized by its globals is allocated once
+ */
+typedef struct ssa_optimizer {
+    /* The program being optimized */
+    ssa_program* program;
+
+    /* The value each global is known to hold, while its memory scope is the current one */
+    u32* memory_values;
+    /* The memory scope each of the memory_values was found in. Scopes are never reused, so one of an earlier function
+       is never current */
+    u32* memory_scopes;
+    /* The amount of memory scopes started so far */
+    u32 scope_count;
+
+    /* The stamp of each global while dead stores are looked for, stamps are never reused either */
+    u32* store_stamps;
+    /* The amount of stamps used so far */
+    u32 stamp_count;
+} ssa_optimizer;
+
+// Optimizes a single function of a program
+static b8 optimize_function(ssa_optimizer* optimizer, ssa_function* function);
+
+// Gives equal instructions of a function a single value, walking the dominator tree so a value is only reused where its
+// definition dominates. A load is given the value last stored to or loaded from its global when nothing could change it
+static b8 number_values(ssa_optimizer* optimizer, ssa_function* function);
+
+// Replaces the values which are the same constant on every executable path with that constant, turns the branches on them
+// into jumps and removes the blocks no executable path reaches
+static b8 propagate_constants(ssa_function* function);
+
+// Removes stores overwritten before anything can see them, then every instruction nothing needs
+static b8 eliminate_dead_code(ssa_optimizer* optimizer, ssa_function* function);
+
+// Builds the dominator tree of a function
+static b8 build_dominator_tree(const ssa_function* function, dominator_tree* out_tree);
+
+// Frees a dominator tree
+static void destroy_dominator_tree(dominator_tree* tree);
+
+// Gives the closest block dominating both blocks
+static u32 common_dominator(const dominator_tree* tree, u32 first, u32 second);
+
+// Hashes the operation of an instruction, the same for every instruction computing the same value
+static u64 hash_instruction(const ssa_function* function, u32 instruction);
+
+// True if the instructions compute the same value
+static b8 is_same_value(const ssa_function* function, u32 first, u32 second);
+
+// Gives the operands of a commutative operation in a fixed order, so a + b and b + a are the same value
+static void canonical_operands(const ssa_function* function, u32 instruction, u32* out_first, u32* out_second);
+
+// Gives the value replacing a value, the value itself if it is not replaced
+static u32 resolve(const u32* replacements, u32 value);
+
+// Points every operand and condition at the values replacing them, then removes the replaced instructions from their blocks
+static void apply_replacements(ssa_function* function, const u32* replacements);
+
+// Removes the instructions marked invalid from the lists of their blocks
+static void compact_blocks(ssa_function* function);
+
+// Removes a predecessor of a block, with the operand the block's phis had for it
+static void remove_predecessor(ssa_function* function, u32 block, u32 predecessor);
+
+// Gives the index of a predecessor of a block
+static u32 predecessor_index(const ssa_block* block, u32 predecessor);
+
+// Marks the edge from a block to its successor executable, the successor is evaluated if this made it executable
+static void mark_edge(ssa_function* function, u32 block, u32 successor, const u32* edge_offsets, b8* is_edge_executable, b8* is_executable, u32* block_worklist, u32* block_worklist_count, u8* states, u64* constants, u32* value_worklist, u32* value_worklist_count);
+
+// Evaluates an instruction on the lattice, pushing it on the worklist if its state changed
+static void evaluate_instruction(ssa_function* function, u32 instruction, const u32* edge_offsets, const b8* is_edge_executable, u8* states, u64* constants, u32* value_worklist, u32* value_worklist_count);
+
+// Folds an arithmetic operation or comparison of constants like the vm runs it, false if it cannot be folded
+static b8 fold(ssa_opcode opcode, type_info type, u64 left, u64 right, u64* out_result);
+
+// True if a constant of a type is true, like the conditional jumps of the vm test it
+static b8 is_true_constant(type_info type, u64 bits);
+
+// True if the instruction is an integer division or modulus which can divide by zero
+static b8 can_trap(const ssa_function* function, u32 instruction);
+
+
+b8 ssa_optimize(ssa_program* program)
+{
+    ssa_optimizer optimizer = {};
+    optimizer.program = program;
+    optimizer.memory_values = malloc((program->global_count + 1) * sizeof(u32));
+    optimizer.memory_scopes = calloc(program->global_count + 1, sizeof(u32));
+    optimizer.store_stamps = calloc(program->global_count + 1, sizeof(u32));
+
+    // The scope 0 is never current
+    optimizer.scope_count = 1;
+
+    b8 optimized = optimizer.memory_values != NULL && optimizer.memory_scopes != NULL && optimizer.store_stamps != NULL;
+    for (u64 i = 0; i < program->function_count && optimized; ++i)
+        optimized = optimize_function(&optimizer, &program->functions[i]);
+
+    free(optimizer.memory_values);
+    free(optimizer.memory_scopes);
+    free(optimizer.store_stamps);
+
+    return optimized;
+}
+
+
+
+b8 optimize_function(ssa_optimizer* optimizer, ssa_function* function)
+{
+    // The constants make more values equal, which the second numbering finds
+    return number_values(optimizer, function) &&
+           propagate_constants(function) &&
+           number_values(optimizer, function) &&
+           eliminate_dead_code(optimizer, function);
+}
+
+b8 number_values(ssa_optimizer* optimizer, ssa_function* function)
+{
+    dominator_tree tree = {};
+    if (!build_dominator_tree(function, &tree))
+        return false;
+
+    u32 bucket_count = 16;
+    while (bucket_count < function->instruction_count * 2)
+        bucket_count *= 2;
+
+    u32* replacements = malloc((function->instruction_count + 1) * sizeof(u32));
+    u32* buckets = malloc(bucket_count * sizeof(u32));
+    value_entry* values = malloc((function->instruction_count + 1) * sizeof(value_entry));
+    memory_change* changes = malloc((function->instruction_count + 1) * sizeof(memory_change));
+    numbering_frame* frames = malloc(function->block_count * sizeof(numbering_frame));
+    if (replacements == NULL || buckets == NULL || values == NULL || changes == NULL || frames == NULL)
+    {
+        free(replacements);
+        free(buckets);
+        free(values);
+        free(changes);
+        free(frames);
+        destroy_dominator_tree(&tree);
+        return false;
+    }
+
+    memset(replacements, 0xFF, function->instruction_count * sizeof(u32));
+    memset(buckets, 0xFF, bucket_count * sizeof(u32));
+
+    u32 value_count = 0;
+    u32 change_count = 0;
+    u32 frame_count = 0;
+
+    // A scope is what is known of the globals along a path with no joins and no calls
+    u32* memory_values = optimizer->memory_values;
+    u32* memory_scopes = optimizer->memory_scopes;
+    u32 scope_count = ++optimizer->scope_count;
+    u32 scope = scope_count;
+    u32 block_index = 0;
+
+    for (;;)
+    {
+        ssa_block* block = &function->blocks[block_index];
+        frames[frame_count++] = (numbering_frame){ .block = block_index, .child = tree.first_child[block_index], .value_mark = value_count, .memory_mark = change_count };
+
+        for (u32 i = 0; i < block->phi_count + block->instruction_count; ++i)
+        {
+            u32 index = (i < block->phi_count) ? block->phis[i] : block->instructions[i - block->phi_count];
+            ssa_instruction* instruction = &function->instructions[index];
+            u32* operands = ssa_operands(function, index);
+            for (u32 j = 0; j < instruction->operand_count; ++j)
+                operands[j] = resolve(replacements, operands[j]);
+
+            switch (instruction->opcode)
+            {
+                case SSA_OPCODE_PHI:
+                {
+                    // A phi of a single value (or itself) is that value
+                    u32 same = SSA_NONE;
+                    b8 is_trivial = true;
+                    for (u32 j = 0; j < instruction->operand_count && is_trivial; ++j)
+                    {
+                        if (operands[j] == index || operands[j] == same)
+                            continue;
+
+                        is_trivial = same == SSA_NONE;
+                        same = operands[j];
+                    }
+
+                    if (is_trivial && same != SSA_NONE)
+                    {
+                        replacements[index] = same;
+                        break;
+                    }
+
+                    // Otherwise it is the same as a phi of the block with the same operands
+                    FALLTHROUGH;
+                }
+                case SSA_OPCODE_CONSTANT:
+                case SSA_OPCODE_ADD:
+                case SSA_OPCODE_SUBTRACT:
+                case SSA_OPCODE_MULTIPLY:
+                case SSA_OPCODE_DIVIDE:
+                case SSA_OPCODE_MODULUS:
+                case SSA_OPCODE_GREATER_THAN:
+                case SSA_OPCODE_LESS_THAN:
+                {
+                    // A division which could trap already trapped where the equal one dominating it ran
+                    u32 bucket = (u32)(hash_instruction(function, index) & (bucket_count - 1));
+                    u32 found = buckets[bucket];
+                    while (found != SSA_NONE && !is_same_value(function, values[found].instruction, index))
+                        found = values[found].next;
+
+                    if (found != SSA_NONE)
+                    {
+                        replacements[index] = values[found].instruction;
+                        break;
+                    }
+
+                    values[value_count] = (value_entry){ .instruction = index, .bucket = bucket, .next = buckets[bucket] };
+                    buckets[bucket] = value_count++;
+                    break;
+                }
+                case SSA_OPCODE_LOAD_GLOBAL:
+                {
+                    u32 global = (u32)instruction->index;
+                    if (memory_scopes[global] == scope)
+                    {
+                        replacements[index] = memory_values[global];
+                        break;
+                    }
+
+                    changes[change_count++] = (memory_change){ global, memory_values[global], memory_scopes[global] };
+                    memory_values[global] = index;
+                    memory_scopes[global] = scope;
+                    break;
+                }
+                case SSA_OPCODE_STORE_GLOBAL:
+                {
+                    u32 global = (u32)instruction->index;
+                    changes[change_count++] = (memory_change){ global, memory_values[global], memory_scopes[global] };
+                    memory_values[global] = operands[0];
+                    memory_scopes[global] = scope;
+                    break;
+                }
+                case SSA_OPCODE_CALL:
+                {
+                    // The callee can change any global
+                    scope = ++scope_count;
+                    break;
+                }
+                default:
+                {
+                    // A parameter is never the same as anything else
+                    break;
+                }
+            };
+        }
+
+        if (block->condition != SSA_NONE)
+            block->condition = resolve(replacements, block->condition);
+
+        frames[frame_count - 1].scope = scope;
+
+        // Continue with the next block dominated by a block on the stack, leaving the blocks whose children were all numbered
+        block_index = SSA_NONE;
+        while (frame_count > 0 && block_index == SSA_NONE)
+        {
+            numbering_frame* frame = &frames[frame_count - 1];
+            if (frame->child != SSA_NONE)
+            {
+                block_index = frame->child;
+                frame->child = tree.next_sibling[block_index];
+
+                // What is known at the end of the block only holds in a block entered from nowhere else
+                scope = (function->blocks[block_index].predecessor_count == 1) ? frame->scope : ++scope_count;
+                break;
+            }
+
+            while (value_count > frame->value_mark)
+            {
+                value_entry* value = &values[--value_count];
+                buckets[value->bucket] = value->next;
+            }
+
+            while (change_count > frame->memory_mark)
+            {
+                memory_change* change = &changes[--change_count];
+                memory_values[change->global] = change->value;
+                memory_scopes[change->global] = change->scope;
+            }
+
+            frame_count--;
+        }
+
+        if (block_index == SSA_NONE)
+            break;
+    }
+
+    // A phi only sees the values of its loop's back edge once the whole loop was numbered
+    apply_replacements(function, replacements);
+    optimizer->scope_count = scope_count;
+
+    free(replacements);
+    free(buckets);
+    free(values);
+    free(changes);
+    free(frames);
+    destroy_dominator_tree(&tree);
+
+    return true;
+}
+
+b8 propagate_constants(ssa_function* function)
+{
+    u32 instruction_count = function->instruction_count;
+    u32 block_count = function->block_count;
+
+    // Every edge of the function is the predecessor entry of its successor, so the edges of a block follow its offset
+    u32* edge_offsets = malloc((block_count + 1) * sizeof(u32));
+    u32* user_offsets = calloc(instruction_count + 1, sizeof(u32));
+    u8* states = calloc(instruction_count + 1, sizeof(u8));
+    u64* constants = calloc(instruction_count + 1, sizeof(u64));
+    b8* is_executable = calloc(block_count, sizeof(b8));
+    u32* block_worklist = malloc(block_count * sizeof(u32));
+    u32* new_indices = malloc(block_count * sizeof(u32));
+    if (edge_offsets == NULL || user_offsets == NULL || states == NULL || constants == NULL || is_executable == NULL || block_worklist == NULL || new_indices == NULL)
+    {
+        free(edge_offsets);
+        free(user_offsets);
+        free(states);
+        free(constants);
+        free(is_executable);
+        free(block_worklist);
+        free(new_indices);
+        return false;
+    }
+
+    edge_offsets[0] = 0;
+    for (u32 i = 0; i < block_count; ++i)
+        edge_offsets[i + 1] = edge_offsets[i] + function->blocks[i].predecessor_count;
+
+    // The users of each value, counted first so they fit in a single array
+    u32 user_count = 0;
+    for (u32 i = 0; i < block_count; ++i)
+    {
+        ssa_block* block = &function->blocks[i];
+        for (u32 j = 0; j < block->phi_count + block->instruction_count; ++j)
+        {
+            u32 index = (j < block->phi_count) ? block->phis[j] : block->instructions[j - block->phi_count];
+            u32* operands = ssa_operands(function, index);
+            for (u32 k = 0; k < function->instructions[index].operand_count; ++k)
+                user_offsets[operands[k] + 1]++;
+
+            user_count += function->instructions[index].operand_count;
+        }
+
+        if (block->condition != SSA_NONE)
+        {
+            user_offsets[block->condition + 1]++;
+            user_count++;
+        }
+    }
+
+    for (u32 i = 0; i < instruction_count; ++i)
+        user_offsets[i + 1] += user_offsets[i];
+
+    b8* is_edge_executable = calloc(edge_offsets[block_count] + 1, sizeof(b8));
+    u32* users = malloc((user_count + 1) * sizeof(u32));
+    u32* user_fill = malloc((instruction_count + 1) * sizeof(u32));
+
+    // Every value can be pushed twice, once when it becomes constant and once when it stops being one
+    u32* value_worklist = malloc((instruction_count * 2 + 1) * sizeof(u32));
+    if (is_edge_executable == NULL || users == NULL || user_fill == NULL || value_worklist == NULL)
+    {
+        free(edge_offsets);
+        free(user_offsets);
+        free(states);
+        free(constants);
+        free(is_executable);
+        free(block_worklist);
+        free(new_indices);
+        free(is_edge_executable);
+        free(users);
+        free(user_fill);
+        free(value_worklist);
+        return false;
+    }
+
+    memcpy_s(user_fill, (instruction_count + 1) * sizeof(u32), user_offsets, (instruction_count + 1) * sizeof(u32));
+    for (u32 i = 0; i < block_count; ++i)
+    {
+        ssa_block* block = &function->blocks[i];
+        for (u32 j = 0; j < block->phi_count + block->instruction_count; ++j)
+        {
+            u32 index = (j < block->phi_count) ? block->phis[j] : block->instructions[j - block->phi_count];
+            u32* operands = ssa_operands(function, index);
+            for (u32 k = 0; k < function->instructions[index].operand_count; ++k)
+                users[user_fill[operands[k]]++] = index;
+        }
+
+        if (block->condition != SSA_NONE)
+            users[user_fill[block->condition]++] = i | USER_IS_BLOCK;
+    }
+
+    u32 block_worklist_count = 0;
+    u32 value_worklist_count = 0;
+    is_executable[0] = true;
+    block_worklist[block_worklist_count++] = 0;
+
+    while (block_worklist_count > 0 || value_worklist_count > 0)
+    {
+        if (block_worklist_count > 0)
+        {
+            // A block is evaluated whole when it first becomes executable, afterwards only what changed is
+            u32 index = block_worklist[--block_worklist_count];
+            ssa_block* block = &function->blocks[index];
+            for (u32 j = 0; j < block->phi_count + block->instruction_count; ++j)
+            {
+                u32 instruction = (j < block->phi_count) ? block->phis[j] : block->instructions[j - block->phi_count];
+                evaluate_instruction(function, instruction, edge_offsets, is_edge_executable, states, constants, value_worklist, &value_worklist_count);
+            }
+
+            if (block->terminator == SSA_TERMINATOR_JUMP)
+            {
+                mark_edge(function, index, block->successors[0], edge_offsets, is_edge_executable, is_executable, block_worklist, &block_worklist_count, states, constants, value_worklist, &value_worklist_count);
+            }
+            else if (block->terminator == SSA_TERMINATOR_BRANCH && states[block->condition] != LATTICE_TOP)
+            {
+                // A branch on a value not known yet waits for it, it is evaluated again when the value changes
+                b8 is_constant = states[block->condition] == LATTICE_CONSTANT;
+                b8 is_true = is_true_constant(function->instructions[block->condition].type, constants[block->condition]);
+                if (!is_constant || is_true)
+                    mark_edge(function, index, block->successors[0], edge_offsets, is_edge_executable, is_executable, block_worklist, &block_worklist_count, states, constants, value_worklist, &value_worklist_count);
+
+                if (!is_constant || !is_true)
+                    mark_edge(function, index, block->successors[1], edge_offsets, is_edge_executable, is_executable, block_worklist, &block_worklist_count, states, constants, value_worklist, &value_worklist_count);
+            }
+
+            continue;
+        }
+
+        u32 value = value_worklist[--value_worklist_count];
+        for (u32 i = user_offsets[value]; i < user_offsets[value + 1]; ++i)
+        {
+            u32 user = users[i];
+            if ((user & USER_IS_BLOCK) == 0)
+            {
+                if (is_executable[function->instructions[user].block])
+                    evaluate_instruction(function, user, edge_offsets, is_edge_executable, states, constants, value_worklist, &value_worklist_count);
+
+                continue;
+            }
+
+            // The condition of a branch changed
+            u32 index = user & ~USER_IS_BLOCK;
+            ssa_block* block = &function->blocks[index];
+            if (!is_executable[index])
+                continue;
+
+            b8 is_constant = states[value] == LATTICE_CONSTANT;
+            b8 is_true = is_true_constant(function->instructions[value].type, constants[value]);
+            if (!is_constant || is_true)
+                mark_edge(function, index, block->successors[0], edge_offsets, is_edge_executable, is_executable, block_worklist, &block_worklist_count, states, constants, value_worklist, &value_worklist_count);
+
+            if (!is_constant || !is_true)
+                mark_edge(function, index, block->successors[1], edge_offsets, is_edge_executable, is_executable, block_worklist, &block_worklist_count, states, constants, value_worklist, &value_worklist_count);
+        }
+    }
+
+    // A constant phi is replaced with a constant at the start of its block, which dominates every use of the phi
+    u32 constant_phi_count = 0;
+    for (u32 i = 0; i < block_count; ++i)
+    {
+        ssa_block* block = &function->blocks[i];
+        for (u32 j = 0; j < block->phi_count && is_executable[i]; ++j)
+            constant_phi_count += states[block->phis[j]] == LATTICE_CONSTANT;
+    }
+
+    // Everything the changes need is allocated before the function is changed, so failing leaves it as it was. The constants
+    // added for the phis are never replaced themselves
+    u32 replacement_count = instruction_count + constant_phi_count;
+    u32* replacements = malloc((replacement_count + 1) * sizeof(u32));
+    b8 has_room = replacements != NULL;
+    if (has_room && function->instruction_count + constant_phi_count > function->instruction_capacity)
+    {
+        u32 new_capacity = function->instruction_count + constant_phi_count;
+        ssa_instruction* new_instructions = realloc(function->instructions, new_capacity * sizeof(ssa_instruction));
+        has_room = new_instructions != NULL;
+        if (has_room)
+        {
+            function->instructions = new_instructions;
+            function->instruction_capacity = new_capacity;
+        }
+    }
+
+    for (u32 i = 0; i < block_count && has_room && constant_phi_count > 0; ++i)
+    {
+        ssa_block* block = &function->blocks[i];
+        u32 block_constant_count = 0;
+        for (u32 j = 0; j < block->phi_count && is_executable[i]; ++j)
+            block_constant_count += states[block->phis[j]] == LATTICE_CONSTANT;
+
+        if (block->instruction_count + block_constant_count <= block->instruction_capacity)
+            continue;
+
+        u32 new_capacity = block->instruction_count + block_constant_count;
+        u32* new_list = realloc(block->instructions, new_capacity * sizeof(u32));
+        has_room = new_list != NULL;
+        if (has_room)
+        {
+            block->instructions = new_list;
+            block->instruction_capacity = new_capacity;
+        }
+    }
+
+    if (has_room)
+    {
+        memset(replacements, 0xFF, replacement_count * sizeof(u32));
+
+        for (u32 i = 0; i < block_count; ++i)
+        {
+            ssa_block* block = &function->blocks[i];
+            if (!is_executable[i])
+                continue;
+
+            u32 block_constant_count = 0;
+            for (u32 j = 0; j < block->phi_count; ++j)
+                block_constant_count += states[block->phis[j]] == LATTICE_CONSTANT;
+
+            if (block_constant_count > 0)
+                memmove(block->instructions + block_constant_count, block->instructions, block->instruction_count * sizeof(u32));
+
+            block->instruction_count += block_constant_count;
+            block_constant_count = 0;
+            for (u32 j = 0; j < block->phi_count; ++j)
+            {
+                u32 phi = block->phis[j];
+                if (states[phi] != LATTICE_CONSTANT)
+                    continue;
+
+                u32 constant = function->instruction_count++;
+                function->instructions[constant] = (ssa_instruction){ .opcode = SSA_OPCODE_CONSTANT, .type = function->instructions[phi].type, .block = i, .t = function->instructions[phi].t };
+                function->instructions[constant].constant.bits = constants[phi];
+                block->instructions[block_constant_count++] = constant;
+                replacements[phi] = constant;
+            }
+
+            for (u32 j = 0; j < block->instruction_count; ++j)
+            {
+                u32 index = block->instructions[j];
+                ssa_instruction* instruction = &function->instructions[index];
+                if (states[index] != LATTICE_CONSTANT || instruction->opcode == SSA_OPCODE_CONSTANT)
+                    continue;
+
+                instruction->opcode = SSA_OPCODE_CONSTANT;
+                instruction->operand_count = 0;
+                instruction->constant.bits = constants[index];
+            }
+
+            // A branch on a constant always continues at the same successor
+            if (block->terminator == SSA_TERMINATOR_BRANCH && states[block->condition] == LATTICE_CONSTANT)
+            {
+                u32 taken = is_true_constant(function->instructions[block->condition].type, constants[block->condition]) ? 0 : 1;
+                remove_predecessor(function, block->successors[1 - taken], i);
+
+                block->terminator = SSA_TERMINATOR_JUMP;
+                block->successors[0] = block->successors[taken];
+                block->successors[1] = SSA_NONE;
+                block->condition = SSA_NONE;
+            }
+        }
+
+        apply_replacements(function, replacements);
+
+        // The blocks no executable path reaches are removed, with the edges they had to the executable ones
+        u32 kept = 0;
+        for (u32 i = 0; i < block_count; ++i)
+        {
+            ssa_block* block = &function->blocks[i];
+            if (is_executable[i])
+            {
+                new_indices[i] = kept++;
+                continue;
+            }
+
+            new_indices[i] = SSA_NONE;
+            for (u32 j = 0; j < 2; ++j)
+            {
+                if (block->successors[j] != SSA_NONE && is_executable[block->successors[j]])
+                    remove_predecessor(function, block->successors[j], i);
+            }
+
+            for (u32 j = 0; j < block->phi_count; ++j)
+                function->instructions[block->phis[j]].opcode = SSA_OPCODE_INVALID;
+
+            for (u32 j = 0; j < block->instruction_count; ++j)
+                function->instructions[block->instructions[j]].opcode = SSA_OPCODE_INVALID;
+
+            free(block->phis);
+            free(block->instructions);
+            free(block->predecessors);
+        }
+
+        for (u32 i = 0; i < block_count; ++i)
+        {
+            if (new_indices[i] == SSA_NONE)
+                continue;
+
+            ssa_block* block = &function->blocks[new_indices[i]];
+            *block = function->blocks[i];
+            for (u32 j = 0; j < block->predecessor_count; ++j)
+                block->predecessors[j] = new_indices[block->predecessors[j]];
+
+            for (u32 j = 0; j < 2; ++j)
+            {
+                if (block->successors[j] != SSA_NONE)
+                    block->successors[j] = new_indices[block->successors[j]];
+            }
+
+            for (u32 j = 0; j < block->phi_count; ++j)
+                function->instructions[block->phis[j]].block = new_indices[i];
+
+            for (u32 j = 0; j < block->instruction_count; ++j)
+                function->instructions[block->instructions[j]].block = new_indices[i];
+        }
+
+        function->block_count = kept;
+    }
+
+    free(edge_offsets);
+    free(user_offsets);
+    free(states);
+    free(constants);
+    free(is_executable);
+    free(block_worklist);
+    free(new_indices);
+    free(is_edge_executable);
+    free(users);
+    free(user_fill);
+    free(value_worklist);
+    free(replacements);
+
+    return has_room;
+}
+
+b8 eliminate_dead_code(ssa_optimizer* optimizer, ssa_function* function)
+{
+    b8* is_live = calloc(function->instruction_count + 1, sizeof(b8));
+    u32* worklist = malloc((function->instruction_count + 1) * sizeof(u32));
+    if (is_live == NULL || worklist == NULL)
+    {
+        free(is_live);
+        free(worklist);
+        return false;
+    }
+
+    // A store is dead when the same block stores to its global again before anything could read it. Going backwards, a
+    // global's stamp is the current one while a later store to it was seen and nothing read it since
+    u32* store_stamps = optimizer->store_stamps;
+    u32 stamp = optimizer->stamp_count;
+    for (u32 i = 0; i < function->block_count; ++i)
+    {
+        ssa_block* block = &function->blocks[i];
+        stamp++;
+        for (u32 j = block->instruction_count; j > 0; --j)
+        {
+            ssa_instruction* instruction = &function->instructions[block->instructions[j - 1]];
+            if (instruction->opcode == SSA_OPCODE_STORE_GLOBAL)
+            {
+                if (store_stamps[instruction->index] == stamp)
+                    instruction->opcode = SSA_OPCODE_INVALID;
+                else
+                    store_stamps[instruction->index] = stamp;
+            }
+            else if (instruction->opcode == SSA_OPCODE_LOAD_GLOBAL)
+            {
+                store_stamps[instruction->index] = 0;
+            }
+            else if (instruction->opcode == SSA_OPCODE_CALL)
+            {
+                // The callee can read any global
+                stamp++;
+            }
+        }
+    }
+
+    // The instructions with an effect are live, and so is everything they use
+    u32 worklist_count = 0;
+    for (u32 i = 0; i < function->block_count; ++i)
+    {
+        ssa_block* block = &function->blocks[i];
+        for (u32 j = 0; j < block->instruction_count; ++j)
+        {
+            u32 index = block->instructions[j];
+            u8 opcode = function->instructions[index].opcode;
+            if (opcode == SSA_OPCODE_STORE_GLOBAL || opcode == SSA_OPCODE_CALL || can_trap(function, index))
+            {
+                is_live[index] = true;
+                worklist[worklist_count++] = index;
+            }
+        }
+
+        if (block->condition != SSA_NONE && !is_live[block->condition])
+        {
+            is_live[block->condition] = true;
+            worklist[worklist_count++] = block->condition;
+        }
+    }
+
+    while (worklist_count > 0)
+    {
+        u32 index = worklist[--worklist_count];
+        u32* operands = ssa_operands(function, index);
+        for (u32 i = 0; i < function->instructions[index].operand_count; ++i)
+        {
+            if (!is_live[operands[i]])
+            {
+                is_live[operands[i]] = true;
+                worklist[worklist_count++] = operands[i];
+            }
+        }
+    }
+
+    for (u32 i = 0; i < function->instruction_count; ++i)
+    {
+        if (!is_live[i])
+            function->instructions[i].opcode = SSA_OPCODE_INVALID;
+    }
+
+    compact_blocks(function);
+    optimizer->stamp_count = stamp;
+
+    free(is_live);
+    free(worklist);
+
+    return true;
+}
+
+b8 build_dominator_tree(const ssa_function* function, dominator_tree* out_tree)
+{
+    u32 block_count = function->block_count;
+    out_tree->order = malloc(block_count * sizeof(u32));
+    out_tree->order_index = malloc(block_count * sizeof(u32));
+    out_tree->idom = malloc(block_count * sizeof(u32));
+    out_tree->first_child = malloc(block_count * sizeof(u32));
+    out_tree->next_sibling = malloc(block_count * sizeof(u32));
+    if (out_tree->order == NULL || out_tree->order_index == NULL || out_tree->idom == NULL || out_tree->first_child == NULL || out_tree->next_sibling == NULL)
+    {
+        destroy_dominator_tree(out_tree);
+        return false;
+    }
+
+    out_tree->order_count = ssa_reverse_postorder(function, out_tree->order);
+    if (out_tree->order_count == SSA_NONE)
+    {
+        destroy_dominator_tree(out_tree);
+        return false;
+    }
+
+    memset(out_tree->order_index, 0xFF, block_count * sizeof(u32));
+    memset(out_tree->idom, 0xFF, block_count * sizeof(u32));
+    memset(out_tree->first_child, 0xFF, block_count * sizeof(u32));
+    memset(out_tree->next_sibling, 0xFF, block_count * sizeof(u32));
+    for (u32 i = 0; i < out_tree->order_count; ++i)
+        out_tree->order_index[out_tree->order[i]] = i;
+
+    // Cooper, Harvey and Kennedy's iterative algorithm, a loop's blocks settle after a few passes
+    out_tree->idom[0] = 0;
+    b8 changed = true;
+    while (changed)
+    {
+        changed = false;
+        for (u32 i = 1; i < out_tree->order_count; ++i)
+        {
+            u32 index = out_tree->order[i];
+            const ssa_block* block = &function->blocks[index];
+            u32 new_idom = SSA_NONE;
+            for (u32 j = 0; j < block->predecessor_count; ++j)
+            {
+                u32 predecessor = block->predecessors[j];
+                if (out_tree->idom[predecessor] == SSA_NONE)
+                    continue;
+
+                new_idom = (new_idom == SSA_NONE) ? predecessor : common_dominator(out_tree, predecessor, new_idom);
+            }
+
+            if (new_idom != out_tree->idom[index])
+            {
+                out_tree->idom[index] = new_idom;
+                changed = true;
+            }
+        }
+    }
+
+    // The children are linked in reverse so each block's list is in the order of the layout
+    for (u32 i = out_tree->order_count; i > 1; --i)
+    {
+        u32 index = out_tree->order[i - 1];
+        u32 parent = out_tree->idom[index];
+        out_tree->next_sibling[index] = out_tree->first_child[parent];
+        out_tree->first_child[parent] = index;
+    }
+
+    return true;
+}
+
+void destroy_dominator_tree(dominator_tree* tree)
+{
+    free(tree->order);
+    free(tree->order_index);
+    free(tree->idom);
+    free(tree->first_child);
+    free(tree->next_sibling);
+    memset(tree, 0, sizeof(dominator_tree));
+}
+
+u32 common_dominator(const dominator_tree* tree, u32 first, u32 second)
+{
+    while (first != second)
+    {
+        while (tree->order_index[first] > tree->order_index[second])
+            first = tree->idom[first];
+
+        while (tree->order_index[second] > tree->order_index[first])
+            second = tree->idom[second];
+    }
+
+    return first;
+}
+
+u64 hash_instruction(const ssa_function* function, u32 instruction)
+{
+    const ssa_instruction* value = &function->instructions[instruction];
+    u64 hash = (u64)value->opcode * 31 + value->type;
+    if (value->opcode == SSA_OPCODE_CONSTANT)
+        return ((hash ^ value->constant.bits) * 31 + value->block) * 0x9E3779B97F4A7C15ull >> 16;
+
+    // A phi is only the same as a phi of its own block
+    if (value->opcode == SSA_OPCODE_PHI)
+        hash = hash * 31 + value->block;
+
+    u32 first = 0;
+    u32 second = 0;
+    canonical_operands(function, instruction, &first, &second);
+    const u32* operands = ssa_operands(function, instruction);
+    for (u32 i = 0; i < value->operand_count; ++i)
+    {
+        u32 operand = (i == 0) ? first : (i == 1) ? second : operands[i];
+        hash = (hash * 31 + operand) * 0x9E3779B97F4A7C15ull;
+    }
+
+    return hash >> 16;
+}
+
+b8 is_same_value(const ssa_function* function, u32 first, u32 second)
+{
+    const ssa_instruction* a = &function->instructions[first];
+    const ssa_instruction* b = &function->instructions[second];
+    if (a->opcode != b->opcode || a->type != b->type || a->operand_count != b->operand_count)
+        return false;
+
+    // A constant is only the same as a constant of its own block. Loading it again is cheaper than keeping
+    // it in a register across every block in between
+    if (a->opcode == SSA_OPCODE_CONSTANT)
+        return a->constant.bits == b->constant.bits && a->block == b->block;
+
+    if (a->opcode == SSA_OPCODE_PHI && a->block != b->block)
+        return false;
+
+    u32 a_operands[2] = {};
+    u32 b_operands[2] = {};
+    canonical_operands(function, first, &a_operands[0], &a_operands[1]);
+    canonical_operands(function, second, &b_operands[0], &b_operands[1]);
+
+    const u32* a_all = ssa_operands(function, first);
+    const u32* b_all = ssa_operands(function, second);
+    for (u32 i = 0; i < a->operand_count; ++i)
+    {
+        u32 a_operand = (i < 2) ? a_operands[i] : a_all[i];
+        u32 b_operand = (i < 2) ? b_operands[i] : b_all[i];
+        if (a_operand != b_operand)
+            return false;
+    }
+
+    return true;
+}
+
+void canonical_operands(const ssa_function* function, u32 instruction, u32* out_first, u32* out_second)
+{
+    const ssa_instruction* value = &function->instructions[instruction];
+    const u32* operands = ssa_operands(function, instruction);
+    *out_first = (value->operand_count > 0) ? operands[0] : SSA_NONE;
+    *out_second = (value->operand_count > 1) ? operands[1] : SSA_NONE;
+
+    b8 is_commutative = value->opcode == SSA_OPCODE_ADD || value->opcode == SSA_OPCODE_MULTIPLY;
+    if (is_commutative && *out_first > *out_second)
+    {
+        u32 swap = *out_first;
+        *out_first = *out_second;
+        *out_second = swap;
+    }
+}
+
+u32 resolve(const u32* replacements, u32 value)
+{
+    while (replacements[value] != SSA_NONE)
+        value = replacements[value];
+
+    return value;
+}
+
+void apply_replacements(ssa_function* function, const u32* replacements)
+{
+    for (u32 i = 0; i < function->block_count; ++i)
+    {
+        ssa_block* block = &function->blocks[i];
+        for (u32 j = 0; j < block->phi_count + block->instruction_count; ++j)
+        {
+            u32 index = (j < block->phi_count) ? block->phis[j] : block->instructions[j - block->phi_count];
+            u32* operands = ssa_operands(function, index);
+            for (u32 k = 0; k < function->instructions[index].operand_count; ++k)
+                operands[k] = resolve(replacements, operands[k]);
+        }
+
+        if (block->condition != SSA_NONE)
+            block->condition = resolve(replacements, block->condition);
+    }
+
+    for (u32 i = 0; i < function->instruction_count; ++i)
+    {
+        if (replacements[i] != SSA_NONE)
+            function->instructions[i].opcode = SSA_OPCODE_INVALID;
+    }
+
+    compact_blocks(function);
+}
+
+void compact_blocks(ssa_function* function)
+{
+    for (u32 i = 0; i < function->block_count; ++i)
+    {
+        ssa_block* block = &function->blocks[i];
+        u32 kept = 0;
+        for (u32 j = 0; j < block->phi_count; ++j)
+        {
+            if (function->instructions[block->phis[j]].opcode != SSA_OPCODE_INVALID)
+                block->phis[kept++] = block->phis[j];
+        }
+
+        block->phi_count = kept;
+
+        kept = 0;
+        for (u32 j = 0; j < block->instruction_count; ++j)
+        {
+            if (function->instructions[block->instructions[j]].opcode != SSA_OPCODE_INVALID)
+                block->instructions[kept++] = block->instructions[j];
+        }
+
+        block->instruction_count = kept;
+    }
+}
+
+void remove_predecessor(ssa_function* function, u32 block, u32 predecessor)
+{
+    ssa_block* successor = &function->blocks[block];
+    u32 index = predecessor_index(successor, predecessor);
+    if (index == SSA_NONE)
+        return;
+
+    for (u32 i = 0; i < successor->phi_count; ++i)
+    {
+        ssa_instruction* phi = &function->instructions[successor->phis[i]];
+        u32* operands = ssa_operands(function, successor->phis[i]);
+        memmove(operands + index, operands + index + 1, (phi->operand_count - index - 1) * sizeof(u32));
+        phi->operand_count--;
+    }
+
+    memmove(successor->predecessors + index, successor->predecessors + index + 1, (successor->predecessor_count - index - 1) * sizeof(u32));
+    successor->predecessor_count--;
+}
+
+u32 predecessor_index(const ssa_block* block, u32 predecessor)
+{
+    for (u32 i = 0; i < block->predecessor_count; ++i)
+    {
+        if (block->predecessors[i] == predecessor)
+            return i;
+    }
+
+    return SSA_NONE;
+}
+
+void mark_edge(ssa_function* function, u32 block, u32 successor, const u32* edge_offsets, b8* is_edge_executable, b8* is_executable, u32* block_worklist, u32* block_worklist_count, u8* states, u64* constants, u32* value_worklist, u32* value_worklist_count)
+{
+    ssa_block* target = &function->blocks[successor];
+    u32 edge = edge_offsets[successor] + predecessor_index(target, block);
+    if (is_edge_executable[edge])
+        return;
+
+    is_edge_executable[edge] = true;
+    if (!is_executable[successor])
+    {
+        is_executable[successor] = true;
+        block_worklist[(*block_worklist_count)++] = successor;
+        return;
+    }
+
+    // Only the phis see which edge the block was entered from
+    for (u32 i = 0; i < target->phi_count; ++i)
+        evaluate_instruction(function, target->phis[i], edge_offsets, is_edge_executable, states, constants, value_worklist, value_worklist_count);
+}
+
+void evaluate_instruction(ssa_function* function, u32 instruction, const u32* edge_offsets, const b8* is_edge_executable, u8* states, u64* constants, u32* value_worklist, u32* value_worklist_count)
+{
+    if (states[instruction] == LATTICE_BOTTOM)
+        return;
+
+    ssa_instruction* value = &function->instructions[instruction];
+    const u32* operands = ssa_operands(function, instruction);
+    u8 state = LATTICE_BOTTOM;
+    u64 constant = 0;
+
+    switch (value->opcode)
+    {
+        case SSA_OPCODE_CONSTANT:
+        {
+            state = LATTICE_CONSTANT;
+            constant = value->constant.bits;
+            break;
+        }
+        case SSA_OPCODE_PHI:
+        {
+            // The meet of the values of the executable edges
+            state = LATTICE_TOP;
+            for (u32 i = 0; i < value->operand_count && state != LATTICE_BOTTOM; ++i)
+            {
+                if (!is_edge_executable[edge_offsets[value->block] + i] || states[operands[i]] == LATTICE_TOP)
+                    continue;
+
+                if (states[operands[i]] == LATTICE_BOTTOM || (state == LATTICE_CONSTANT && constants[operands[i]] != constant))
+                {
+                    state = LATTICE_BOTTOM;
+                    break;
+                }
+
+                state = LATTICE_CONSTANT;
+                constant = constants[operands[i]];
+            }
+
+            break;
+        }
+        case SSA_OPCODE_ADD:
+        case SSA_OPCODE_SUBTRACT:
+        case SSA_OPCODE_MULTIPLY:
+        case SSA_OPCODE_DIVIDE:
+        case SSA_OPCODE_MODULUS:
+        case SSA_OPCODE_GREATER_THAN:
+        case SSA_OPCODE_LESS_THAN:
+        {
+            u8 left = states[operands[0]];
+            u8 right = states[operands[1]];
+            if (left == LATTICE_BOTTOM || right == LATTICE_BOTTOM)
+                state = LATTICE_BOTTOM;
+            else if (left == LATTICE_TOP || right == LATTICE_TOP)
+                state = LATTICE_TOP;
+            else
+                state = fold(value->opcode, value->type, constants[operands[0]], constants[operands[1]], &constant) ? LATTICE_CONSTANT : LATTICE_BOTTOM;
+
+            break;
+        }
+        default:
+        {
+            // Parameters, loads and calls can be anything
+            break;
+        }
+    };
+
+    if (state == states[instruction] && (state != LATTICE_CONSTANT || constant == constants[instruction]))
+        return;
+
+    // A value changing to another constant has no single constant
+    if (states[instruction] == LATTICE_CONSTANT && state == LATTICE_CONSTANT)
+        state = LATTICE_BOTTOM;
+
+    if (state == LATTICE_TOP)
+        return;
+
+    states[instruction] = state;
+    constants[instruction] = constant;
+    value_worklist[(*value_worklist_count)++] = instruction;
+}
+
+b8 fold(ssa_opcode opcode, type_info type, u64 left, u64 right, u64* out_result)
+{
+    if (type == TYPE_INFO_INTEGER)
+    {
+        // Like the vm the arithmetic is done on unsigned integers, so an overflow wraps around
+        i64 signed_left = (i64)left;
+        i64 signed_right = (i64)right;
+        switch (opcode)
+        {
+            case SSA_OPCODE_ADD:            *out_result = left + right; return true;
+            case SSA_OPCODE_SUBTRACT:       *out_result = left - right; return true;
+            case SSA_OPCODE_MULTIPLY:       *out_result = left * right; return true;
+            case SSA_OPCODE_GREATER_THAN:   *out_result = signed_left > signed_right; return true;
+            case SSA_OPCODE_LESS_THAN:      *out_result = signed_left < signed_right; return true;
+            case SSA_OPCODE_DIVIDE:
+            {
+                // A division by zero is left to report its error when it runs
+                if (signed_right == 0)
+                    return false;
+
+                *out_result = (signed_right == -1) ? 0 - left : (u64)(signed_left / signed_right);
+                return true;
+            }
+            case SSA_OPCODE_MODULUS:
+            {
+                if (signed_right == 0)
+                    return false;
+
+                *out_result = (signed_right == -1) ? 0 : (u64)(signed_left % signed_right);
+                return true;
+            }
+            default:
+            {
+                return false;
+            }
+        };
+    }
+
+    if (type != TYPE_INFO_FLOAT)
+        return false;
+
+    ssa_constant a = { .bits = left };
+    ssa_constant b = { .bits = right };
+    ssa_constant result = {};
+    switch (opcode)
+    {
+        case SSA_OPCODE_ADD:            result.float64 = a.float64 + b.float64; break;
+        case SSA_OPCODE_SUBTRACT:       result.float64 = a.float64 - b.float64; break;
+        case SSA_OPCODE_MULTIPLY:       result.float64 = a.float64 * b.float64; break;
+        case SSA_OPCODE_DIVIDE:         result.float64 = a.float64 / b.float64; break;
+        case SSA_OPCODE_MODULUS:        result.float64 = fmod(a.float64, b.float64); break;
+        case SSA_OPCODE_GREATER_THAN:   result.float64 = (a.float64 > b.float64) ? 1.0 : 0.0; break;
+        case SSA_OPCODE_LESS_THAN:      result.float64 = (a.float64 < b.float64) ? 1.0 : 0.0; break;
+        default:                        return false;
+    };
+
+    *out_result = result.bits;
+    return true;
+}
+
+b8 is_true_constant(type_info type, u64 bits)
+{
+    ssa_constant value = { .bits = bits };
+    if (type == TYPE_INFO_FLOAT)
+        return value.float64 != 0.0;
+
+    // A string is true when it is not empty, a function when it is not the zero value
+    if (type == TYPE_INFO_STRING)
+        return value.string != NULL && value.string[0] != '\0';
+
+    return bits != 0;
+}
+
+b8 can_trap(const ssa_function* function, u32 instruction)
+{
+    const ssa_instruction* value = &function->instructions[instruction];
+    if ((value->opcode != SSA_OPCODE_DIVIDE && value->opcode != SSA_OPCODE_MODULUS) || value->type != TYPE_INFO_INTEGER)
+        return false;
+
+    // Only dividing by a constant other than zero is known not to trap
+    const ssa_instruction* divisor = &function->instructions[ssa_operands(function, instruction)[1]];
+    return divisor->opcode != SSA_OPCODE_CONSTANT || divisor->constant.integer == 0;
+}
@@ -0,0 +1,816 @@
+#include "typing/incremental_typing.h"
+#include "parser/abstract_syntax_tree.h"
+#include "parser/incremental_parser.h"
+#include "typing/parallel_typing.h"
+
+#include <malloc.h>
+#include <string.h>
+#include <stdint.h>
+
+#define DEFAULT_MEMO_LIST_CAPACITY 64
+#define DEFAULT_MEMO_LIST_RESIZE_FACTOR 2
+#define DEFAULT_STATEMENT_WALK_CAPACITY 64
+#define MINIMUM_BUCKET_CAPACITY 16
+
+/**
+ * @brief A symbol a statement looked up, and what it was when the statement was typed
+ */
+typedef struct memo_dependency {
+    /* The interned name of the symbol */
+    const char* name;
+    /* The length of the name */
+    u64 length;
+    /* False if the symbol did not exist (a declaration depends on its name being free) */
+    b8 found;
+    /* The signature of the symbol, see symbol_signature() */
+    u64 signature;
+} memo_dependency;
+
+/**
+ * @brief A symbol a statement added to the table
+ */
+typedef struct memo_symbol {
+    /* The interned name of the symbol */
+    const char* name;
+    /* The index (in walk order) of the node whose token is the symbol's token */
+    u64 node_index;
+    /* The type of the symbol */
+    type_info type;
+    /* True if the symbol was declared as a constant */
+    b8 is_constant;
+    /* The typing_information of the symbol's copy of the token */
+    i32 typing_information;
+    /* The index (in walk order) of the symbol's function_decl_node, -1 if it has none */
+    i64 function_decl_node_index;
+
+    /* The node at node_index and the function_decl_node (NULL if it has none) in the statement the memo was last applied to */
+    ast_node* node;
+    ast_node* function_decl_node;
+} memo_symbol;
+
+/**
+ * @brief Everything needed to re-apply the typing of a top level statement without typing it again
+ */
+typedef struct typing_memo {
+    /* The hash of the statement's tokens and shape */
+    u64 hash;
+    /* The statement the memo was last applied to, which holds its typing. NULL once that statement may be typed differently */
+    ast_node* statement;
+    /* The amount of nodes in the statement */
+    u64 node_count;
+
+    /* The typing_information of every node of the statement, in walk order */
+    i32* typing_information;
+
+    /* The symbols the statement looked up */
+    memo_dependency* dependencies;
+    /* The amount of dependencies */
+    u64 dependency_count;
+
+    /* The symbols the statement added to the table, in the order they were added */
+    memo_symbol* symbols;
+    /* The amount of symbols */
+    u64 symbol_count;
+} typing_memo;
+
+/**
+ * @brief The nodes of a statement in walk order (pre-order, children left to right) and the hash of the statement
+ */
+typedef struct statement_walk {
+    ast_node** nodes;
+    u64 count;
+    u64 capacity;
+
+    u64 hash;
+    /* Set when the nodes buffer failed to grow */
+    b8 has_error;
+} statement_walk;
+
+/**
+ * @brief A growable list of memos, the memos of the typing in progress
+ */
+typedef struct memo_list {
+    typing_memo* memos;
+    u64 count;
+    u64 capacity;
+} memo_list;
+
+/**
+ * @brief A set of interned names, compared by address
+ */
+typedef struct name_set {
+    const char** slots;
+    u64 capacity;
+    u64 size;
+} name_set;
+
+/**
+ * @brief The state of a call to resolve_types_incremental()
+ */
+typedef struct incremental_typing {
+    typing_cache* cache;
+    symbol_table* sym_table;
+
+    /* One flag per memo of the cache, set once the memo has been taken by a statement */
+    b8* consumed;
+    /* The memos of this typing, in source order */
+    memo_list fresh;
+    /* The walk of the statement being typed */
+    statement_walk walk;
+
+    /* True while the memos are taken in the order they were made, the symbols are then known to be what they were last time,
+       except for the changed_names. Once a memo is taken out of order, every dependency has to be re-validated */
+    b8 in_order;
+    /* The index of the memo after the last one taken */
+    u64 next_memo;
+    /* The names of the symbols that may differ from the last typing */
+    name_set changed_names;
+
+    /* Cleared when a statement could not be memoized */
+    b8 memoized_every_statement;
+} incremental_typing;
+
+// Types a file with the memos of the cache. A statement is only looked up by its address when arena_id is not 0, see incremental_parse
+static typing_result resolve_types_memoized(typing_cache* cache, ast_node* ast, symbol_table* sym_table, u64 arena_id);
+
+// Fills the walk with the nodes of the statement, and hashes the statement
+static void walk_statement(statement_walk* walk, ast_node* node);
+
+// Hashes the address of a statement, for the statement_buckets of the cache
+static u64 hash_statement_address(const ast_node* statement);
+
+// Hashes what a statement looking a symbol up can see of it: its type, constness and function signature
+static u64 symbol_signature(symbol* sym);
+
+// Finds the memo last applied to the statement itself if its dependencies are still what they were, NULL if there is none
+static typing_memo* find_statement_memo(incremental_typing* state, ast_node* statement, u64* out_index);
+
+// Finds a memo of the walked statement whose dependencies are still what they were, NULL if there is none
+static typing_memo* find_valid_memo(incremental_typing* state, u64* out_index);
+
+// Checks that the dependencies of a memo are what they were when the memo was made, only the changed ones when changed_names is given
+static b8 dependencies_hold(typing_memo* memo, symbol_table* sym_table, name_set* changed_names);
+
+// Marks that the memos between the last one taken and this one were skipped, and that their symbols changed
+static void take_memo(incremental_typing* state, u64 memo_index);
+
+// Gives the walked statement the typing of a memo (a NULL walk means the statement already has it), and adds the memo's symbols to the table
+static typing_result apply_memo(typing_memo* memo, statement_walk* walk, ast_node* statement, symbol_table* sym_table);
+
+// Records the symbols a statement is about to look up (before it is typed, so its own declarations are recorded as missing)
+static b8 collect_dependencies(typing_cache* cache, statement_walk* walk, symbol_table* sym_table, typing_memo* memo);
+
+// Records the typing of a statement that was just typed, returns false if the statement cannot be memoized
+static b8 record_typing(typing_cache* cache, statement_walk* walk, symbol_table* sym_table, u64 first_new_symbol, typing_memo* memo);
+
+// Marks the names of the symbols a statement that was typed again added to the table as changed
+static b8 mark_new_symbols_changed(incremental_typing* state, u64 first_new_symbol);
+
+static b8 name_set_add(name_set* set, const char* name);
+static b8 name_set_contains(name_set* set, const char* name);
+
+static void typing_memo_destroy(typing_memo* memo);
+static b8 memo_list_push(memo_list* list, typing_memo memo);
+
+// Makes the memos of this typing the cache's memos, the unconsumed memos of the last typing are kept if keep_unconsumed is set
+static void replace_memos(typing_cache* cache, memo_list* fresh, b8* consumed, b8 keep_unconsumed);
+
+
+typing_cache typing_cache_create()
+{
+    typing_cache cache = {};
+    cache.names = string_interner_create();
+
+    return cache;
+}
+
+void typing_cache_destroy(typing_cache* cache)
+{
+    for (u64 i = 0; i < cache->memo_count; ++i)
+        typing_memo_destroy(&cache->memos[i]);
+
+    free(cache->memos);
+    free(cache->buckets);
+    free(cache->statement_buckets);
+    string_interner_destroy(&cache->names);
+
+    memset(cache, 0, sizeof(typing_cache));
+}
+
+typing_result resolve_types_incremental(typing_cache* cache, ast_node* ast, symbol_table* sym_table)
+{
+    return resolve_types_memoized(cache, ast, sym_table, 0);
+}
+
+typing_result resolve_types_incremental_parse(typing_cache* cache, incremental_parse* parse, symbol_table* sym_table)
+{
+    // Nothing was parsed yet, so there is nothing to type
+    if (!parse->ast)
+        return typing_result_success(TYPE_INFO_UNKNOWN);
+
+    return resolve_types_memoized(cache, parse->ast, sym_table, parse->arena_id);
+}
+
+
+typing_result resolve_types_memoized(typing_cache* cache, ast_node* ast, symbol_table* sym_table, u64 arena_id)
+{
+    // Only whole files are memoized
+    if (ast->type != AST_SCOPE)
+        return resolve_types_parallel(ast, sym_table, NULL);
+
+    // The statements the memos were applied to are only known to be alive, and unchanged, in the arena they were made in
+    if (arena_id == 0 || arena_id != cache->arena_id)
+    {
+        for (u64 i = 0; i < cache->memo_count; ++i)
+            cache->memos[i].statement = NULL;
+    }
+    cache->arena_id = arena_id;
+
+    cache->checked_count = 0;
+    cache->reused_count = 0;
+
+    incremental_typing state = {};
+    state.cache = cache;
+    state.sym_table = sym_table;
+    state.consumed = calloc(cache->memo_count + 1, sizeof(b8)); // +1 so an empty cache still gets a buffer
+    state.in_order = cache->memos_in_order;
+    state.memoized_every_statement = true;
+
+    typing_result result = typing_result_success(TYPE_INFO_UNKNOWN);
+    for (u64 i = 0; i < ast->node.many.children.number_of_nodes; ++i)
+    {
+        ast_node* statement = ast->node.many.children.nodes[i];
+
+        // A statement the incremental_parse reused still holds its typing, so it is not walked at all
+        u64 memo_index;
+        typing_memo* memo = state.consumed ? find_statement_memo(&state, statement, &memo_index) : NULL;
+        statement_walk* walk = NULL;
+        if (!memo)
+        {
+            walk = &state.walk;
+            walk->count = 0;
+            walk->hash = STRING_HASH_SEED;
+            walk_statement(walk, statement);
+
+            memo = (walk->has_error || !state.consumed) ? NULL : find_valid_memo(&state, &memo_index);
+        }
+
+        if (memo)
+        {
+            result = apply_memo(memo, walk, statement, sym_table);
+            if (!result.success)
+                break;
+
+            // The memo moves over to the new list (if it cannot, it is released with the other unused memos)
+            take_memo(&state, memo_index);
+            if (memo_list_push(&state.fresh, *memo))
+                state.consumed[memo_index] = true;
+            else
+                state.memoized_every_statement = false;
+
+            cache->reused_count++;
+            continue;
+        }
+
+        typing_memo new_memo = {};
+        new_memo.statement = statement;
+        b8 memoizable = !state.walk.has_error && collect_dependencies(cache, &state.walk, sym_table, &new_memo);
+
+        // Typed like resolve_types_parallel() types a file, so the parameters and locals of a function stay out of sym_table
+        u64 first_new_symbol = sym_table->size;
+        result = resolve_types_parallel(statement, sym_table, NULL);
+        cache->checked_count++;
+        if (!result.success)
+        {
+            typing_memo_destroy(&new_memo);
+            break;
+        }
+
+        // Whatever the statement declared may not be what was declared last time
+        if (!mark_new_symbols_changed(&state, first_new_symbol))
+            state.in_order = false;
+
+        if (memoizable && record_typing(cache, &state.walk, sym_table, first_new_symbol, &new_memo) && memo_list_push(&state.fresh, new_memo))
+            continue;
+
+        // The statement will just be typed again next time
+        typing_memo_destroy(&new_memo);
+        state.memoized_every_statement = false;
+    }
+
+    // When the typing fails, the statements after the error were not looked at, so their old memos are kept for the next typing
+    replace_memos(cache, &state.fresh, state.consumed, !result.success);
+    cache->memos_in_order = result.success && state.memoized_every_statement && state.consumed;
+
+    free(state.consumed);
+    free(state.walk.nodes);
+    free(state.changed_names.slots);
+
+    if (result.success)
+        return typing_result_success(TYPE_INFO_UNKNOWN);
+
+    return result;
+}
+
+
+void walk_statement(statement_walk* walk, ast_node* node)
+{
+    if (node == NULL)
+    {
+        // Mark the missing child, so the shape of the statement is part of its hash
+        u8 missing = 0xFF;
+        walk->hash = string_hash_bytes(walk->hash, &missing, sizeof(missing));
+        return;
+    }
+
+    if (walk->count >= walk->capacity)
+    {
+        u64 new_capacity = walk->capacity ? walk->capacity * 2 : DEFAULT_STATEMENT_WALK_CAPACITY;
+        ast_node** new_nodes = malloc(new_capacity * sizeof(ast_node*));
+        if (!new_nodes)
+        {
+            walk->has_error = true;
+            return;
+        }
+
+        if (walk->nodes)
+            memcpy_s(new_nodes, new_capacity * sizeof(ast_node*), walk->nodes, walk->count * sizeof(ast_node*));
+
+        free(walk->nodes);
+        walk->nodes = new_nodes;
+        walk->capacity = new_capacity;
+    }
+    walk->nodes[walk->count++] = node;
+
+    // Every node kind keeps its token first, so the leaf view of the token works for all of them
+    token* t = &(node->node.leaf.t);
+    u64 shape = (u64)node->type | ((u64)node->enclosed_in_parens << 16) | ((u64)t->type << 24) | (t->length << 32);
+    walk->hash = string_hash_bytes(walk->hash, &shape, sizeof(shape));
+    if (t->text)
+        walk->hash = string_hash_bytes(walk->hash, t->text, t->length);
+
+    switch (ast_node_child_strategy_from_node_type(node->type))
+    {
+        case CHILD_STRATEGY_NONE:
+            break;
+        case CHILD_STRATEGY_UNARY:
+            walk_statement(walk, node->node.unary.child);
+            break;
+        case CHILD_STRATEGY_BINARY:
+            walk_statement(walk, node->node.binary.left_child);
+            walk_statement(walk, node->node.binary.right_child);
+            break;
+        case CHILD_STRATEGY_TERNARY:
+            walk_statement(walk, node->node.ternary.left_child);
+            walk_statement(walk, node->node.ternary.center_child);
+            walk_statement(walk, node->node.ternary.right_child);
+            break;
+        case CHILD_STRATEGY_MANY:
+        {
+            node_list* children = &(node->node.many.children);
+            walk->hash = string_hash_bytes(walk->hash, &children->number_of_nodes, sizeof(children->number_of_nodes));
+            for (u64 i = 0; i < children->number_of_nodes; ++i)
+                walk_statement(walk, children->nodes[i]);
+            break;
+        }
+    }
+}
+
+u64 hash_statement_address(const ast_node* statement)
+{
+    return string_hash_bytes(STRING_HASH_SEED, &statement, sizeof(statement));
+}
+
+u64 symbol_signature(symbol* sym)
+{
+    u64 hash = STRING_HASH_SEED;
+    hash = string_hash_bytes(hash, &sym->type, sizeof(sym->type));
+    hash = string_hash_bytes(hash, &sym->is_constant, sizeof(sym->is_constant));
+
+    // A call to a function checks its arguments against the parameter types, and takes on its return type
+    ast_node* declaration = sym->function_decl_node;
+    if (declaration)
+    {
+        node_list* parameters = &(declaration->node.ternary.left_child->node.many.children);
+        hash = string_hash_bytes(hash, &parameters->number_of_nodes, sizeof(parameters->number_of_nodes));
+        for (u64 i = 0; i < parameters->number_of_nodes; ++i)
+            hash = string_hash_bytes(hash, &parameters->nodes[i]->node.binary.t.typing_information, sizeof(i32));
+
+        hash = string_hash_bytes(hash, &declaration->node.ternary.center_child->node.leaf.t.typing_information, sizeof(i32));
+    }
+
+    return hash;
+}
+
+typing_memo* find_statement_memo(incremental_typing* state, ast_node* statement, u64* out_index)
+{
+    typing_cache* cache = state->cache;
+    if (cache->arena_id == 0 || cache->statement_bucket_capacity == 0)
+        return NULL;
+
+    u64 mask = cache->statement_bucket_capacity - 1;
+    for (u64 slot = hash_statement_address(statement) & mask; cache->statement_buckets[slot] != 0; slot = (slot + 1) & mask)
+    {
+        u64 index = cache->statement_buckets[slot] - 1;
+        typing_memo* memo = &cache->memos[index];
+        if (memo->statement != statement || state->consumed[index])
+            continue;
+
+        // Validated like a memo found by content, see find_valid_memo()
+        b8 in_order = state->in_order && index == state->next_memo;
+        if (!dependencies_hold(memo, state->sym_table, in_order ? &state->changed_names : NULL))
+        {
+            // The statement is typed again, so it stops holding the typing of the memo
+            memo->statement = NULL;
+            return NULL;
+        }
+
+        *out_index = index;
+        return memo;
+    }
+
+    return NULL;
+}
+
+typing_memo* find_valid_memo(incremental_typing* state, u64* out_index)
+{
+    typing_cache* cache = state->cache;
+    statement_walk* walk = &state->walk;
+    if (cache->bucket_capacity == 0)
+        return NULL;
+
+    // Identical statements share a hash, so keep probing past memos that are used up or no longer valid
+    u64 mask = cache->bucket_capacity - 1;
+    for (u64 slot = walk->hash & mask; cache->buckets[slot] != 0; slot = (slot + 1) & mask)
+    {
+        u64 index = cache->buckets[slot] - 1;
+        typing_memo* memo = &cache->memos[index];
+        if (state->consumed[index] || memo->hash != walk->hash || memo->node_count != walk->count)
+            continue;
+
+        // A memo right after the last one taken only needs the symbols that changed re-validated. One further along
+        // skips memos whose symbols are not marked as changed yet, so it is validated completely
+        b8 in_order = state->in_order && index == state->next_memo;
+        if (!dependencies_hold(memo, state->sym_table, in_order ? &state->changed_names : NULL))
+            continue;
+
+        *out_index = index;
+        return memo;
+    }
+
+    return NULL;
+}
+
+b8 dependencies_hold(typing_memo* memo, symbol_table* sym_table, name_set* changed_names)
+{
+    for (u64 i = 0; i < memo->dependency_count; ++i)
+    {
+        memo_dependency* dependency = &memo->dependencies[i];
+        if (changed_names && !name_set_contains(changed_names, dependency->name))
+            continue;
+
+        token name = {};
+        name.text = dependency->name;
+        name.length = dependency->length;
+        symbol* sym = symbol_table_find(sym_table, name);
+
+        if ((sym != NULL) != dependency->found)
+            return false;
+
+        if (sym && symbol_signature(sym) != dependency->signature)
+            return false;
+    }
+
+    return true;
+}
+
+void take_memo(incremental_typing* state, u64 memo_index)
+{
+    if (!state->in_order || memo_index < state->next_memo)
+    {
+        state->in_order = false;
+        return;
+    }
+
+    // The statements of the skipped memos were edited or removed, the symbols they declared may be gone
+    for (u64 i = state->next_memo; i < memo_index && state->in_order; ++i)
+    {
+        typing_memo* skipped = &state->cache->memos[i];
+        for (u64 s = 0; s < skipped->symbol_count; ++s)
+        {
+            if (!name_set_add(&state->changed_names, skipped->symbols[s].name))
+                state->in_order = false;
+        }
+    }
+
+    state->next_memo = memo_index + 1;
+}
+
+typing_result apply_memo(typing_memo* memo, statement_walk* walk, ast_node* statement, symbol_table* sym_table)
+{
+    // A memo found by content moves over to the walked statement
+    if (walk)
+    {
+        for (u64 i = 0; i < walk->count; ++i)
+            walk->nodes[i]->node.leaf.t.typing_information = memo->typing_information[i];
+
+        memo->statement = statement;
+        for (u64 i = 0; i < memo->symbol_count; ++i)
+        {
+            memo_symbol* memo_sym = &memo->symbols[i];
+            memo_sym->node = walk->nodes[memo_sym->node_index];
+            memo_sym->function_decl_node = (memo_sym->function_decl_node_index >= 0) ? walk->nodes[memo_sym->function_decl_node_index] : NULL;
+        }
+    }
+
+    for (u64 i = 0; i < memo->symbol_count; ++i)
+    {
+        memo_symbol* memo_sym = &memo->symbols[i];
+
+        token t = memo_sym->node->node.leaf.t;
+        t.typing_information = memo_sym->typing_information;
+        if (!symbol_table_add(sym_table, t, memo_sym->type, memo_sym->is_constant))
+            return typing_result_error(t, DIAGNOSTIC_SYMBOL_TABLE_ALLOCATION);
+
+        if (memo_sym->function_decl_node)
+            sym_table->buffer[sym_table->size - 1].function_decl_node = memo_sym->function_decl_node;
+    }
+
+    return typing_result_success(TYPE_INFO_UNKNOWN);
+}
+
+b8 collect_dependencies(typing_cache* cache, statement_walk* walk, symbol_table* sym_table, typing_memo* memo)
+{
+    u64 identifier_count = 0;
+    for (u64 i = 0; i < walk->count; ++i)
+    {
+        if (walk->nodes[i]->node.leaf.t.type == TOKEN_IDENTIFIER)
+            identifier_count++;
+    }
+
+    if (identifier_count == 0)
+        return true;
+
+    memo->dependencies = malloc(identifier_count * sizeof(memo_dependency));
+    if (!memo->dependencies)
+        return false;
+
+    // A name is only recorded the first time it is seen in the statement
+    name_set seen = {};
+    b8 success = true;
+    for (u64 i = 0; i < walk->count; ++i)
+    {
+        token t = walk->nodes[i]->node.leaf.t;
+        if (t.type != TOKEN_IDENTIFIER)
+            continue;
+
+        const char* name = string_interner_intern(&cache->names, t.text, t.length);
+        u64 seen_size = seen.size;
+        if (!name || !name_set_add(&seen, name))
+        {
+            success = false;
+            break;
+        }
+
+        if (seen.size == seen_size)
+            continue;
+
+        symbol* sym = symbol_table_find(sym_table, t);
+
+        memo_dependency* dependency = &memo->dependencies[memo->dependency_count++];
+        dependency->name = name;
+        dependency->length = t.length;
+        dependency->found = sym != NULL;
+        dependency->signature = sym ? symbol_signature(sym) : 0;
+    }
+
+    free(seen.slots);
+    return success;
+}
+
+b8 record_typing(typing_cache* cache, statement_walk* walk, symbol_table* sym_table, u64 first_new_symbol, typing_memo* memo)
+{
+    memo->hash = walk->hash;
+    memo->node_count = walk->count;
+
+    memo->typing_information = malloc(walk->count * sizeof(i32));
+    if (!memo->typing_information)
+        return false;
+
+    for (u64 i = 0; i < walk->count; ++i)
+        memo->typing_information[i] = walk->nodes[i]->node.leaf.t.typing_information;
+
+    u64 symbol_count = sym_table->size - first_new_symbol;
+    if (symbol_count == 0)
+        return true;
+
+    memo->symbols = malloc(symbol_count * sizeof(memo_symbol));
+    if (!memo->symbols)
+        return false;
+
+    for (u64 i = first_new_symbol; i < sym_table->size; ++i)
+    {
+        symbol* sym = &sym_table->buffer[i];
+
+        memo_symbol* memo_sym = &memo->symbols[memo->symbol_count++];
+        memo_sym->name = string_interner_intern(&cache->names, sym->t.text, sym->t.length);
+        memo_sym->type = sym->type;
+        memo_sym->is_constant = sym->is_constant;
+        memo_sym->typing_information = sym->t.typing_information;
+        memo_sym->function_decl_node_index = -1;
+        memo_sym->node = NULL;
+        memo_sym->function_decl_node = NULL;
+
+        // The symbol's token is a copy of one of the statement's tokens, find which one
+        b8 found_token = false;
+        for (u64 n = 0; n < walk->count && !found_token; ++n)
+        {
+            token* t = &(walk->nodes[n]->node.leaf.t);
+            if (t->text == sym->t.text && t->length == sym->t.length && t->type == sym->t.type)
+            {
+                memo_sym->node_index = n;
+                memo_sym->node = walk->nodes[n];
+                found_token = true;
+            }
+        }
+
+        if (sym->function_decl_node)
+        {
+            for (u64 n = 0; n < walk->count; ++n)
+            {
+                if (walk->nodes[n] == sym->function_decl_node)
+                {
+                    memo_sym->function_decl_node_index = n;
+                    memo_sym->function_decl_node = walk->nodes[n];
+                    break;
+                }
+            }
+        }
+
+        // A symbol that does not come from the statement itself cannot be replayed
+        if (!memo_sym->name || !found_token || (sym->function_decl_node && memo_sym->function_decl_node_index < 0))
+            return false;
+    }
+
+    return true;
+}
+
+b8 mark_new_symbols_changed(incremental_typing* state, u64 first_new_symbol)
+{
+    symbol_table* sym_table = state->sym_table;
+    for (u64 i = first_new_symbol; i < sym_table->size; ++i)
+    {
+        const char* name = string_interner_intern(&state->cache->names, sym_table->buffer[i].t.text, sym_table->buffer[i].t.length);
+        if (!name || !name_set_add(&state->changed_names, name))
+            return false;
+    }
+
+    return true;
+}
+
+b8 name_set_add(name_set* set, const char* name)
+{
+    if ((set->size + 1) * 2 > set->capacity)
+    {
+        u64 new_capacity = set->capacity ? set->capacity * 2 : MINIMUM_BUCKET_CAPACITY;
+        const char** new_slots = calloc(new_capacity, sizeof(const char*));
+        if (!new_slots)
+            return false;
+
+        for (u64 i = 0; i < set->capacity; ++i)
+        {
+            if (!set->slots[i])
+                continue;
+
+            u64 slot = ((uintptr_t)set->slots[i] >> 3) & (new_capacity - 1);
+            while (new_slots[slot])
+                slot = (slot + 1) & (new_capacity - 1);
+            new_slots[slot] = set->slots[i];
+        }
+
+        free(set->slots);
+        set->slots = new_slots;
+        set->capacity = new_capacity;
+    }
+
+    u64 mask = set->capacity - 1;
+    u64 slot = ((uintptr_t)name >> 3) & mask;
+    while (set->slots[slot] && set->slots[slot] != name)
+        slot = (slot + 1) & mask;
+
+    if (!set->slots[slot])
+    {
+        set->slots[slot] = name;
+        set->size++;
+    }
+
+    return true;
+}
+
+b8 name_set_contains(name_set* set, const char* name)
+{
+    if (set->size == 0)
+        return false;
+
+    u64 mask = set->capacity - 1;
+    for (u64 slot = ((uintptr_t)name >> 3) & mask; set->slots[slot]; slot = (slot + 1) & mask)
+    {
+        if (set->slots[slot] == name)
+            return true;
+    }
+
+    return false;
+}
+
+void typing_memo_destroy(typing_memo* memo)
+{
+    free(memo->typing_information);
+    free(memo->dependencies);
+    free(memo->symbols);
+
+    memset(memo, 0, sizeof(typing_memo));
+}
+
+b8 memo_list_push(memo_list* list, typing_memo memo)
+{
+    if (list->count >= list->capacity)
+    {
+        u64 new_capacity = list->capacity ? list->capacity * DEFAULT_MEMO_LIST_RESIZE_FACTOR : DEFAULT_MEMO_LIST_CAPACITY;
+        typing_memo* new_memos = malloc(new_capacity * sizeof(typing_memo));
+        if (!new_memos)
+            return false;
+
+        if (list->memos)
+            memcpy_s(new_memos, new_capacity * sizeof(typing_memo), list->memos, list->count * sizeof(typing_memo));
+
+        free(list->memos);
+        list->memos = new_memos;
+        list->capacity = new_capacity;
+    }
+
+    list->memos[list->count++] = memo;
+    return true;
+}
+
+void replace_memos(typing_cache* cache, memo_list* fresh, b8* consumed, b8 keep_unconsumed)
+{
+    for (u64 i = 0; i < cache->memo_count; ++i)
+    {
+        if (consumed[i])
+            continue;
+
+        if (!keep_unconsumed || !memo_list_push(fresh, cache->memos[i]))
+            typing_memo_destroy(&cache->memos[i]);
+    }
+
+    free(cache->memos);
+    cache->memos = fresh->memos;
+    cache->memo_count = fresh->count;
+
+    // Rebuild the buckets for the new memos
+    free(cache->buckets);
+    free(cache->statement_buckets);
+    cache->buckets = NULL;
+    cache->statement_buckets = NULL;
+    cache->bucket_capacity = 0;
+    cache->statement_bucket_capacity = 0;
+    if (cache->memo_count == 0)
+        return;
+
+    u64 bucket_capacity = MINIMUM_BUCKET_CAPACITY;
+    while (bucket_capacity < cache->memo_count * 2)
+        bucket_capacity *= 2;
+
+    cache->buckets = calloc(bucket_capacity, sizeof(u64));
+    cache->statement_buckets = calloc(bucket_capacity, sizeof(u64));
+    if (!cache->buckets || !cache->statement_buckets)
+    {
+        // Without buckets no memo will be found, everything is just typed again
+        free(cache->buckets);
+        free(cache->statement_buckets);
+        cache->buckets = NULL;
+        cache->statement_buckets = NULL;
+        return;
+    }
+
+    cache->bucket_capacity = bucket_capacity;
+    cache->statement_bucket_capacity = bucket_capacity;
+    u64 mask = bucket_capacity - 1;
+    for (u64 i = 0; i < cache->memo_count; ++i)
+    {
+        u64 slot = cache->memos[i].hash & mask;
+        while (cache->buckets[slot] != 0)
+            slot = (slot + 1) & mask;
+
+        cache->buckets[slot] = i + 1;
+
+        if (!cache->memos[i].statement)
+            continue;
+
+        slot = hash_statement_address(cache->memos[i].statement) & mask;
+        while (cache->statement_buckets[slot] != 0)
+            slot = (slot + 1) & mask;
+
+        cache->statement_buckets[slot] = i + 1;
+    }
+}
@@ -0,0 +1,175 @@
+#include "typing/parallel_typing.h"
+#include "parser/abstract_syntax_tree.h"
+#include "utilities/jobs.h"
+
+#include <malloc.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <stdint.h>
+
+// Files with fewer function bodies than this are typed on the calling thread
+#define PARALLEL_TYPING_MINIMUM_BODIES 64
+
+#define DEFAULT_FUNCTION_BODY_LIST_CAPACITY 64
+#define DEFAULT_FUNCTION_BODY_LIST_RESIZE_FACTOR 2
+
+/**
+ * @brief A function body found by the first phase, to be typed by the second
+ */
+typedef struct function_body {
+    /* The AST_FUNCTION_DECLARATION node, its signature is already typed */
+    ast_node* function_declaration;
+    /* The amount of symbols that were in the global table when the function was declared */
+    u64 visible_symbol_count;
+
+    /* The result of typing the body */
+    typing_result result;
+} function_body;
+
+/**
+ * @brief The state shared between all the workers of a parallel typing
+ */
+typedef struct parallel_typing {
+    /* The frozen table of the top level symbols */
+    symbol_table* global_table;
+
+    /* The function bodies, in source order */
+    function_body* bodies;
+    /* The amount of function bodies */
+    u64 body_count;
+    /* The amount of function bodies the bodies buffer can hold */
+    u64 body_capacity;
+
+    /* The index of the next body to be picked up by a worker */
+    _Atomic u64 next_body;
+    /* The index of the first body known to have failed, the bodies after it do not need typing */
+    _Atomic u64 first_failed_body;
+} parallel_typing;
+
+// The defer_function_body callback of the first phase, records the body for the second phase
+static b8 defer_function_body(ast_node* function_declaration, symbol_table* sym_table, void* user_data);
+
+// Grows the bodies buffer by the given factor
+static b8 reallocate_bodies(parallel_typing* state, u64 resize_factor);
+
+// The job function of a worker, types bodies until there are none left
+static void typing_worker_run(void* user_data);
+
+
+typing_result resolve_types_parallel(ast_node* ast, symbol_table* sym_table, rouleaux_jobs* jobs)
+{
+    // The scheduler's workers and the calling thread
+    u32 thread_count = jobs_thread_count(jobs) + 1;
+
+    parallel_typing state = {};
+    state.global_table = sym_table;
+    atomic_init(&state.next_body, 0);
+    atomic_init(&state.first_failed_body, UINT64_MAX);
+
+    // Phase one, type everything but the function bodies
+    typing_context context = {};
+    context.defer_function_body = defer_function_body;
+    context.user_data = &state;
+
+    typing_result global_result = resolve_types_with_context(ast, sym_table, &context);
+
+    // Phase two, type the bodies. Even if phase one failed the bodies found before the error still need typing,
+    // an error in one of them comes first in source order
+    if (state.body_count < thread_count)
+        thread_count = (u32)state.body_count;
+    if (state.body_count < PARALLEL_TYPING_MINIMUM_BODIES)
+        thread_count = 1;
+
+    jobs_run_and_wait(jobs, thread_count, typing_worker_run, &state);
+
+    // Merge the results in source order. Phase one stops at its error, so every body it found comes before that error
+    typing_result result = global_result;
+    b8 body_failed = false;
+    for (u64 i = 0; i < state.body_count; ++i)
+    {
+        typing_result* body_result = &state.bodies[i].result;
+        if (body_result->success)
+            continue;
+
+        if (body_failed)
+            continue; // Only the first error is reported
+
+        result = *body_result;
+        body_failed = true;
+    }
+
+    free(state.bodies);
+    return result;
+}
+
+
+b8 defer_function_body(ast_node* function_declaration, symbol_table* sym_table, void* user_data)
+{
+    parallel_typing* state = user_data;
+    if (state->body_count + 1 >= state->body_capacity)
+    {
+        // If we fail to grow, the body is typed right away like resolve_types() would
+        if (!reallocate_bodies(state, DEFAULT_FUNCTION_BODY_LIST_RESIZE_FACTOR))
+            return false;
+    }
+
+    function_body* body = &state->bodies[state->body_count++];
+    body->function_declaration = function_declaration;
+    body->visible_symbol_count = sym_table->size;
+    body->result = typing_result_success(TYPE_INFO_UNKNOWN);
+
+    return true;
+}
+
+b8 reallocate_bodies(parallel_typing* state, u64 resize_factor)
+{
+    u64 new_capacity = state->body_capacity ? state->body_capacity * resize_factor : DEFAULT_FUNCTION_BODY_LIST_CAPACITY;
+    function_body* new_bodies = malloc(new_capacity * sizeof(function_body));
+    if (!new_bodies)
+        return false;
+
+    if (state->bodies)
+    {
+        int error_code = memcpy_s(new_bodies, new_capacity * sizeof(function_body), state->bodies, state->body_count * sizeof(function_body));
+        if (error_code)
+        {
+            free(new_bodies);
+            return false;
+        }
+    }
+
+    free(state->bodies);
+    state->bodies = new_bodies;
+    state->body_capacity = new_capacity;
+
+    return true;
+}
+
+void typing_worker_run(void* user_data)
+{
+    parallel_typing* state = user_data;
+
+    for (;;)
+    {
+        u64 body_index = atomic_fetch_add(&state->next_body, 1);
+        if (body_index >= state->body_count)
+            break;
+
+        // Only the first error is reported, so there is no need to type anything after it
+        if (body_index > atomic_load(&state->first_failed_body))
+            continue;
+
+        // The body gets its own scope, which only sees the globals declared before the function
+        function_body* body = &state->bodies[body_index];
+        symbol_table local_table = symbol_table_create_scope(state->global_table, body->visible_symbol_count);
+        body->result = resolve_function_body_types(body->function_declaration, &local_table, NULL);
+        symbol_table_destroy(&local_table);
+
+        if (!body->result.success)
+        {
+            u64 first_failed = atomic_load(&state->first_failed_body);
+            while (body_index < first_failed && !atomic_compare_exchange_weak(&state->first_failed_body, &first_failed, body_index))
+                ;
+        }
+    }
+}
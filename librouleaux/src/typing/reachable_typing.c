@@ -0,0 +1,482 @@
+#include "typing/reachable_typing.h"
+#include "parser/abstract_syntax_tree.h"
+#include "typing/parallel_typing.h"
+#include "utilities/string_interner.h"
+
+#include <malloc.h>
+#include <string.h>
+
+#define MINIMUM_DECLARATION_MAP_CAPACITY 16
+#define DEFAULT_NAME_LIST_CAPACITY 32
+
+/**
+ * @brief A name declared by a top level statement
+ */
+typedef struct declaration_entry {
+    /* The name, borrowed from the token that declared it. NULL for an empty slot */
+    const char* text;
+    /* The length of the name */
+    u64 length;
+    /* The index of the top level statement the name is declared in */
+    u64 statement;
+} declaration_entry;
+
+/**
+ * @brief An open addressed hash table from names to the first top level statement declaring them
+ */
+typedef struct declaration_map {
+    declaration_entry* slots;
+    u64 capacity;
+    u64 size;
+} declaration_map;
+
+/**
+ * @brief A growable list of tokens
+ */
+typedef struct name_list {
+    token* names;
+    u64 count;
+    u64 capacity;
+} name_list;
+
+/**
+ * @brief The state of a call to resolve_types_reachable()
+ */
+typedef struct reachability {
+    /* The top level statements of the file */
+    node_list* statements;
+    /* The table the builtin names are found in */
+    symbol_table* sym_table;
+
+    /* The names declared directly by the top level statements */
+    declaration_map declarations;
+    /* Set once the names declared anywhere inside the top level statements have been added to declarations */
+    b8 indexed_nested_declarations;
+
+    /* One flag per top level statement, set once the statement is reached */
+    b8* reached;
+    /* The reached statements which still have to be searched for references */
+    u64* worklist;
+    u64 worklist_count;
+
+    /* The identifiers referenced by the statement being searched */
+    name_list references;
+    /* The names declared inside the statement being searched, references to them stay inside the statement */
+    declaration_map local_declarations;
+
+    /* Set when an allocation failed */
+    b8 has_error;
+} reachability;
+
+// Adds a name to the map, a name that is already in the map keeps its first statement
+static b8 declaration_map_add(declaration_map* map, const char* text, u64 length, u64 statement);
+
+// Finds the statement declaring a name, returns false if the name is not in the map
+static b8 declaration_map_find(declaration_map* map, const char* text, u64 length, u64* out_statement);
+
+static b8 name_list_push(name_list* list, token t);
+
+// Gives the name a top level statement declares by its shape alone ('name := ...', 'name :: ...' or 'name: type'), NULL if it declares none
+static token* declared_name(ast_node* statement);
+
+// True if a top level statement does something when it runs, other than declaring a name
+static b8 has_side_effect(ast_node* statement);
+
+// True if the subtree calls a function
+static b8 contains_call(ast_node* node);
+
+// Adds the names declared anywhere in the subtree to the map
+static void index_declarations(reachability* state, ast_node* node, declaration_map* map, u64 statement);
+
+// Collects the identifiers of the subtree into state->references, and the names it declares into state->local_declarations
+static void collect_references(reachability* state, ast_node* node, u64 statement);
+
+// Marks a statement as reached, and queues it to be searched
+static void reach(reachability* state, u64 statement);
+
+// Follows the references of a reached statement to the statements declaring them
+static void follow_references(reachability* state, u64 statement);
+
+// Finds the statement declaring a name, indexing the nested declarations of the file the first time a name is not found
+static b8 find_declaration(reachability* state, const char* text, u64 length, u64* out_statement);
+
+
+typing_result resolve_types_reachable(ast_node* ast, symbol_table* sym_table, const char* entry_point)
+{
+    // Only whole files have top level statements to choose from
+    if (ast->type != AST_SCOPE)
+        return resolve_types_parallel(ast, sym_table, NULL);
+
+    reachability state = {};
+    state.statements = &(ast->node.many.children);
+    state.sym_table = sym_table;
+
+    u64 statement_count = state.statements->number_of_nodes;
+    state.reached = calloc(statement_count + 1, sizeof(b8)); // +1 so an empty file still gets a buffer
+    state.worklist = malloc((statement_count + 1) * sizeof(u64));
+    if (!state.reached || !state.worklist)
+        state.has_error = true;
+
+    // Index the names the top level statements declare, nested declarations are only indexed if they turn out to be needed
+    for (u64 i = 0; i < statement_count && !state.has_error; ++i)
+    {
+        token* name = declared_name(state.statements->nodes[i]);
+        if (name && !declaration_map_add(&state.declarations, name->text, name->length, i))
+            state.has_error = true;
+    }
+
+    typing_result result = typing_result_success(TYPE_INFO_UNKNOWN);
+    if (!state.has_error && entry_point)
+    {
+        u64 entry_statement;
+        if (find_declaration(&state, entry_point, strlen(entry_point), &entry_statement))
+        {
+            reach(&state, entry_statement);
+        }
+        else
+        {
+            // The file's scope has no token of its own, so the error points at the start of the file instead
+            result = typing_result_error(ast_file_start_token(ast), DIAGNOSTIC_UNKNOWN_ENTRY_POINT, diagnostic_string(entry_point, strlen(entry_point)));
+        }
+    }
+    else
+    {
+        for (u64 i = 0; i < statement_count && !state.has_error; ++i)
+        {
+            if (has_side_effect(state.statements->nodes[i]))
+                reach(&state, i);
+        }
+    }
+
+    while (result.success && state.worklist_count > 0 && !state.has_error)
+        follow_references(&state, state.worklist[--state.worklist_count]);
+
+    if (result.success && state.has_error)
+    {
+        result = typing_result_error(ast_file_start_token(ast), DIAGNOSTIC_REACHABILITY_ALLOCATION);
+    }
+
+    // Type the reached statements in source order, so every symbol is declared before it is used. Like the whole file
+    // typing, a function body gets its own scope, which only sees the globals declared before the function
+    for (u64 i = 0; i < statement_count && result.success; ++i)
+    {
+        if (state.reached[i])
+            result = resolve_types_parallel(state.statements->nodes[i], sym_table, NULL);
+    }
+
+    free(state.reached);
+    free(state.worklist);
+    free(state.references.names);
+    free(state.declarations.slots);
+    free(state.local_declarations.slots);
+
+    return result;
+}
+
+
+b8 declaration_map_add(declaration_map* map, const char* text, u64 length, u64 statement)
+{
+    if ((map->size + 1) * 2 > map->capacity)
+    {
+        u64 new_capacity = map->capacity ? map->capacity * 2 : MINIMUM_DECLARATION_MAP_CAPACITY;
+        declaration_entry* new_slots = calloc(new_capacity, sizeof(declaration_entry));
+        if (!new_slots)
+            return false;
+
+        for (u64 i = 0; i < map->capacity; ++i)
+        {
+            declaration_entry entry = map->slots[i];
+            if (!entry.text)
+                continue;
+
+            u64 slot = string_hash(entry.text, entry.length) & (new_capacity - 1);
+            while (new_slots[slot].text)
+                slot = (slot + 1) & (new_capacity - 1);
+            new_slots[slot] = entry;
+        }
+
+        free(map->slots);
+        map->slots = new_slots;
+        map->capacity = new_capacity;
+    }
+
+    u64 mask = map->capacity - 1;
+    u64 slot = string_hash(text, length) & mask;
+    while (map->slots[slot].text)
+    {
+        declaration_entry* entry = &map->slots[slot];
+        if (entry->length == length && memcmp(entry->text, text, length) == 0)
+            return true; // The first declaration is the one every later reference binds to
+
+        slot = (slot + 1) & mask;
+    }
+
+    map->slots[slot].text = text;
+    map->slots[slot].length = length;
+    map->slots[slot].statement = statement;
+    map->size++;
+
+    return true;
+}
+
+b8 declaration_map_find(declaration_map* map, const char* text, u64 length, u64* out_statement)
+{
+    if (map->size == 0)
+        return false;
+
+    u64 mask = map->capacity - 1;
+    for (u64 slot = string_hash(text, length) & mask; map->slots[slot].text; slot = (slot + 1) & mask)
+    {
+        declaration_entry* entry = &map->slots[slot];
+        if (entry->length == length && memcmp(entry->text, text, length) == 0)
+        {
+            *out_statement = entry->statement;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+b8 name_list_push(name_list* list, token t)
+{
+    if (list->count >= list->capacity)
+    {
+        u64 new_capacity = list->capacity ? list->capacity * 2 : DEFAULT_NAME_LIST_CAPACITY;
+        token* new_names = malloc(new_capacity * sizeof(token));
+        if (!new_names)
+            return false;
+
+        if (list->names)
+            memcpy_s(new_names, new_capacity * sizeof(token), list->names, list->count * sizeof(token));
+
+        free(list->names);
+        list->names = new_names;
+        list->capacity = new_capacity;
+    }
+
+    list->names[list->count++] = t;
+    return true;
+}
+
+token* declared_name(ast_node* statement)
+{
+    switch (statement->type)
+    {
+        case AST_VALUE_ASSIGNMENT:
+        case AST_CONST_ASSIGNMENT:
+        {
+            ast_node* left = statement->node.binary.left_child;
+            if (left && left->type == AST_TYPE_ASSIGNMENT)
+                return &(left->node.binary.left_child->node.leaf.t);
+
+            return NULL;
+        }
+        case AST_TYPE_ASSIGNMENT:
+            return &(statement->node.binary.left_child->node.leaf.t);
+        default:
+            return NULL;
+    }
+}
+
+b8 has_side_effect(ast_node* statement)
+{
+    switch (statement->type)
+    {
+        case AST_VALUE_ASSIGNMENT:
+        case AST_CONST_ASSIGNMENT:
+        {
+            // Assigning to an existing variable changes it
+            if (declared_name(statement) == NULL)
+                return true;
+
+            // A function's body only runs when it is called, any other value runs when it is declared
+            ast_node* value = statement->node.binary.right_child;
+            if (value->type == AST_FUNCTION_DECLARATION)
+                return false;
+
+            return contains_call(value);
+        }
+        case AST_TYPE_ASSIGNMENT:
+        case AST_COMMENT:
+        case AST_STATEMENT_END:
+        case AST_EOF:
+        case AST_INVALID:
+            return false;
+        default:
+            return true;
+    }
+}
+
+b8 contains_call(ast_node* node)
+{
+    if (node == NULL)
+        return false;
+
+    if (node->type == AST_FUNCTION_CALL || node->type == AST_CALL_OPERATOR)
+        return true;
+
+    switch (ast_node_child_strategy_from_node_type(node->type))
+    {
+        case CHILD_STRATEGY_UNARY:
+            return contains_call(node->node.unary.child);
+        case CHILD_STRATEGY_BINARY:
+            return contains_call(node->node.binary.left_child) || contains_call(node->node.binary.right_child);
+        case CHILD_STRATEGY_TERNARY:
+            return contains_call(node->node.ternary.left_child) || contains_call(node->node.ternary.center_child) || contains_call(node->node.ternary.right_child);
+        case CHILD_STRATEGY_MANY:
+        {
+            for (u64 i = 0; i < node->node.many.children.number_of_nodes; ++i)
+            {
+                if (contains_call(node->node.many.children.nodes[i]))
+                    return true;
+            }
+            return false;
+        }
+        default:
+            return false;
+    }
+}
+
+void index_declarations(reachability* state, ast_node* node, declaration_map* map, u64 statement)
+{
+    if (node == NULL || state->has_error)
+        return;
+
+    // Every declaration (including the parameters of a function) goes through a type assignment 'name: type'
+    if (node->type == AST_TYPE_ASSIGNMENT)
+    {
+        token* name = &(node->node.binary.left_child->node.leaf.t);
+        if (!declaration_map_add(map, name->text, name->length, statement))
+            state->has_error = true;
+    }
+
+    switch (ast_node_child_strategy_from_node_type(node->type))
+    {
+        case CHILD_STRATEGY_UNARY:
+            index_declarations(state, node->node.unary.child, map, statement);
+            break;
+        case CHILD_STRATEGY_BINARY:
+            index_declarations(state, node->node.binary.left_child, map, statement);
+            index_declarations(state, node->node.binary.right_child, map, statement);
+            break;
+        case CHILD_STRATEGY_TERNARY:
+            index_declarations(state, node->node.ternary.left_child, map, statement);
+            index_declarations(state, node->node.ternary.center_child, map, statement);
+            index_declarations(state, node->node.ternary.right_child, map, statement);
+            break;
+        case CHILD_STRATEGY_MANY:
+            for (u64 i = 0; i < node->node.many.children.number_of_nodes; ++i)
+                index_declarations(state, node->node.many.children.nodes[i], map, statement);
+            break;
+        default:
+            break;
+    }
+}
+
+void collect_references(reachability* state, ast_node* node, u64 statement)
+{
+    if (node == NULL || state->has_error)
+        return;
+
+    // Every node kind keeps its token first, so the leaf view of the token works for all of them
+    if (node->node.leaf.t.type == TOKEN_IDENTIFIER && !name_list_push(&state->references, node->node.leaf.t))
+    {
+        state->has_error = true;
+        return;
+    }
+
+    if (node->type == AST_TYPE_ASSIGNMENT)
+    {
+        token* name = &(node->node.binary.left_child->node.leaf.t);
+        if (!declaration_map_add(&state->local_declarations, name->text, name->length, statement))
+        {
+            state->has_error = true;
+            return;
+        }
+    }
+
+    switch (ast_node_child_strategy_from_node_type(node->type))
+    {
+        case CHILD_STRATEGY_UNARY:
+            collect_references(state, node->node.unary.child, statement);
+            break;
+        case CHILD_STRATEGY_BINARY:
+            collect_references(state, node->node.binary.left_child, statement);
+            collect_references(state, node->node.binary.right_child, statement);
+            break;
+        case CHILD_STRATEGY_TERNARY:
+            collect_references(state, node->node.ternary.left_child, statement);
+            collect_references(state, node->node.ternary.center_child, statement);
+            collect_references(state, node->node.ternary.right_child, statement);
+            break;
+        case CHILD_STRATEGY_MANY:
+            for (u64 i = 0; i < node->node.many.children.number_of_nodes; ++i)
+                collect_references(state, node->node.many.children.nodes[i], statement);
+            break;
+        default:
+            break;
+    }
+}
+
+void reach(reachability* state, u64 statement)
+{
+    if (state->reached[statement])
+        return;
+
+    state->reached[statement] = true;
+    state->worklist[state->worklist_count++] = statement;
+}
+
+void follow_references(reachability* state, u64 statement)
+{
+    ast_node* node = state->statements->nodes[statement];
+
+    // The parameters and locals of the statement are only referenced from inside of it, so they are gathered in the same walk
+    state->references.count = 0;
+    if (state->local_declarations.size > 0)
+        memset(state->local_declarations.slots, 0, state->local_declarations.capacity * sizeof(declaration_entry));
+    state->local_declarations.size = 0;
+    collect_references(state, node, statement);
+
+    for (u64 i = 0; i < state->references.count && !state->has_error; ++i)
+    {
+        token* name = &state->references.names[i];
+
+        u64 declaring_statement;
+        if (declaration_map_find(&state->local_declarations, name->text, name->length, &declaring_statement))
+            continue;
+
+        if (declaration_map_find(&state->declarations, name->text, name->length, &declaring_statement))
+        {
+            reach(state, declaring_statement);
+            continue;
+        }
+
+        // Builtin names are already in the table
+        if (symbol_table_find(state->sym_table, *name) != NULL)
+            continue;
+
+        // A name no statement declares is left for the typing to report
+        if (find_declaration(state, name->text, name->length, &declaring_statement))
+            reach(state, declaring_statement);
+    }
+}
+
+b8 find_declaration(reachability* state, const char* text, u64 length, u64* out_statement)
+{
+    if (declaration_map_find(&state->declarations, text, length, out_statement))
+        return true;
+
+    // The name may be declared inside of a top level block, which still declares it for the rest of the file
+    if (!state->indexed_nested_declarations)
+    {
+        state->indexed_nested_declarations = true;
+        for (u64 i = 0; i < state->statements->number_of_nodes; ++i)
+            index_declarations(state, state->statements->nodes[i], &state->declarations, i);
+
+        return declaration_map_find(&state->declarations, text, length, out_statement);
+    }
+
+    return false;
+}
@@ -1,102 +1,231 @@
-#include "typing/symbol_table.h"
-
-#include <malloc.h>
-#include <string.h>
-
-#define DEFAULT_SYMBOL_TABLE_CAPACITY 1
-#define DEFAULT_SYMBOL_TABLE_RESIZE_FACTOR 2
-
-static b8 reallocate_buffer(symbol_table* table, u64 resize_factor);
-static void populate_builtin_types(symbol_table* table);
-static token create_base_type_token(const char* text, token_type ttype, type_info tinfo);
-
-symbol_table symbol_table_create()
-{
-    symbol_table table = {};
-    table.buffer = malloc(DEFAULT_SYMBOL_TABLE_CAPACITY * sizeof(symbol));
-    table.capacity = DEFAULT_SYMBOL_TABLE_CAPACITY;
-
-    populate_builtin_types(&table);
-    
-    return table;
-}
-
-void symbol_table_destroy(symbol_table* table)
-{
-    free(table->buffer);
-    table->capacity = 0;
-    table->size = 0;
-}
-
-b8 symbol_table_add(symbol_table* table, token t, type_info type, b8 is_constant)
-{
-    if (table->size + 1 >= table->capacity)
-    {
-        if (!reallocate_buffer(table, DEFAULT_SYMBOL_TABLE_RESIZE_FACTOR))
-            return false; // Failed to allocate table
-    }
-
-    // If the symbol is already in the table, we should not add it
-    if (symbol_table_find(table, t) != NULL)
-        return false;
-
-    // Set the element
-    table->buffer[table->size].t = t;
-    table->buffer[table->size].type = type;
-    table->buffer[table->size].is_constant = is_constant;
-    table->size++;
-
-    return true;
-}
-
-symbol* symbol_table_find(symbol_table* table, token t)
-{
-    for (u64 i = 0; i < table->size; ++i)
-    {
-        if (table->buffer[i].t.length != t.length)
-            continue; // If the lengths are not he same, they are clearly not equal
-
-        if (strncmp(table->buffer[i].t.text, t.text, t.length) == 0)
-            return &(table->buffer[i]);
-    }
-
-    return NULL;
-}
-
-
-static b8 reallocate_buffer(symbol_table* table, u64 resize_factor)
-{
-    u64 new_capacity = table->capacity * resize_factor;
-    symbol* new_buffer = malloc(new_capacity * sizeof(symbol));
-
-    int error_code = memcpy_s(new_buffer, new_capacity * sizeof(symbol), table->buffer, table->capacity * sizeof(symbol));
-    if (error_code)
-        return false; // we failed to copy the memory
-
-    free(table->buffer);
-    table->buffer = new_buffer;
-    table->capacity = new_capacity;
-
-    return true; // We successfully reallocated the list buffer
-}
-
-static void populate_builtin_types(symbol_table* table)
-{
-    // TODO(Steven): This is all wrong! update me!
-    token float_type = create_base_type_token("float", TOKEN_FLOAT_LITERAL, TYPE_INFO_FLOAT);
-    symbol_table_add(table, float_type, TYPE_INFO_FLOAT, true);
-
-    token int_type = create_base_type_token("int", TOKEN_INTEGER_LITERAL, TYPE_INFO_INTEGER);
-    symbol_table_add(table, int_type, TYPE_INFO_INTEGER, true);
-}
-
-static token create_base_type_token(const char* text, token_type ttype, type_info tinfo)
-{
-    token type_token = {};
-    type_token.text = text;
-    type_token.length = strlen(text);
-    type_token.type = ttype;
-    type_token.typing_information = tinfo;
-    
-    return type_token;
+#include "typing/symbol_table.h"
+#include "parser/abstract_syntax_tree.h"
+
+#include <malloc.h>
+#include <string.h>
+
+#define DEFAULT_SYMBOL_TABLE_CAPACITY 1
+#define DEFAULT_SYMBOL_TABLE_RESIZE_FACTOR 2
+#define DEFAULT_SYMBOL_TABLE_INDEX_CAPACITY 16
+
+static b8 reallocate_buffer(symbol_table* table, u64 resize_factor);
+static symbol* find_in_table(symbol_table* table, u64 count, token t);
+static void populate_builtin_types(symbol_table* table);
+static b8 index_symbol(symbol_table* table, u64 buffer_index);
+static b8 grow_index(symbol_table* table);
+static token create_base_type_token(const char* text, token_type ttype, type_info tinfo);
+
+symbol_table symbol_table_create()
+{
+    symbol_table table = {};
+    table.buffer = malloc(DEFAULT_SYMBOL_TABLE_CAPACITY * sizeof(symbol));
+    table.capacity = DEFAULT_SYMBOL_TABLE_CAPACITY;
+
+    populate_builtin_types(&table);
+    
+    return table;
+}
+
+symbol_table symbol_table_create_scope(symbol_table* parent, u64 parent_visible_count)
+{
+    symbol_table table = {};
+    table.buffer = malloc(DEFAULT_SYMBOL_TABLE_CAPACITY * sizeof(symbol));
+    table.capacity = DEFAULT_SYMBOL_TABLE_CAPACITY;
+
+    // The builtin types are found through the parent
+    table.parent = parent;
+    table.parent_visible_count = parent_visible_count;
+
+    return table;
+}
+
+void symbol_table_destroy(symbol_table* table)
+{
+    for (u64 i = 0; i < table->size; ++i)
+        free(table->buffer[i].signature);
+
+    free(table->buffer);
+    free(table->index);
+    table->index = NULL;
+    table->index_capacity = 0;
+    table->capacity = 0;
+    table->size = 0;
+}
+
+b8 symbol_table_add(symbol_table* table, token t, type_info type, b8 is_constant)
+{
+    if (table->size + 1 >= table->capacity)
+    {
+        if (!reallocate_buffer(table, DEFAULT_SYMBOL_TABLE_RESIZE_FACTOR))
+            return false; // Failed to allocate table
+    }
+
+    // If the symbol is already in the table, we should not add it
+    if (symbol_table_find(table, t) != NULL)
+        return false;
+
+    // Set the element
+    table->buffer[table->size].t = t;
+    table->buffer[table->size].type = type;
+    table->buffer[table->size].is_constant = is_constant;
+    table->buffer[table->size].function_decl_node = NULL;
+    table->buffer[table->size].signature = NULL;
+    if (!index_symbol(table, table->size))
+        return false; // Failed to allocate the index
+
+    table->size++;
+
+    return true;
+}
+
+symbol* symbol_table_find(symbol_table* table, token t)
+{
+    symbol* sym = find_in_table(table, table->size, t);
+
+    // Walk out through the enclosing scopes, each one only sees part of its parent
+    u64 visible_count = table->parent_visible_count;
+    for (symbol_table* parent = table->parent; sym == NULL && parent != NULL; parent = parent->parent)
+    {
+        sym = find_in_table(parent, visible_count, t);
+        visible_count = parent->parent_visible_count;
+    }
+
+    return sym;
+}
+
+b8 symbol_table_detach(symbol_table* table, u64 first, string_interner* interner)
+{
+    for (u64 i = first; i < table->size; ++i)
+    {
+        symbol* sym = &(table->buffer[i]);
+
+        // The name is the only part of the token that points into the buffer, the filename outlives it
+        const char* name = string_interner_intern(interner, sym->t.text, sym->t.length);
+        if (!name)
+            return false;
+        sym->t.text = name;
+
+        ast_node* declaration = sym->function_decl_node;
+        if (!declaration)
+            continue;
+
+        // The signature and its parameter types share a single allocation
+        node_list* parameters = &(declaration->node.ternary.left_child->node.many.children);
+        function_signature* signature = malloc(sizeof(function_signature) + parameters->number_of_nodes * sizeof(type_info));
+        if (!signature)
+            return false;
+
+        signature->parameter_types = (type_info*)(signature + 1);
+        signature->parameter_count = parameters->number_of_nodes;
+        for (u64 p = 0; p < parameters->number_of_nodes; ++p)
+            signature->parameter_types[p] = parameters->nodes[p]->node.binary.t.typing_information;
+        signature->return_type = declaration->node.ternary.center_child->node.leaf.t.typing_information;
+
+        free(sym->signature);
+        sym->signature = signature;
+        sym->function_decl_node = NULL;
+    }
+
+    return true;
+}
+
+
+static symbol* find_in_table(symbol_table* table, u64 count, token t)
+{
+    if (table->index_capacity == 0)
+        return NULL;
+
+    u64 mask = table->index_capacity - 1;
+    for (u64 slot = string_hash(t.text, t.length) & mask; table->index[slot] != 0; slot = (slot + 1) & mask)
+    {
+        u64 i = table->index[slot] - 1;
+        if (table->buffer[i].t.length != t.length)
+            continue; // If the lengths are not he same, they are clearly not equal
+
+        if (strncmp(table->buffer[i].t.text, t.text, t.length) == 0)
+        {
+            // Symbols past count are not visible from where the table is being searched
+            return (i < count && i < table->size) ? &(table->buffer[i]) : NULL;
+        }
+    }
+
+    return NULL;
+}
+
+
+static b8 reallocate_buffer(symbol_table* table, u64 resize_factor)
+{
+    u64 new_capacity = table->capacity * resize_factor;
+    symbol* new_buffer = malloc(new_capacity * sizeof(symbol));
+
+    int error_code = memcpy_s(new_buffer, new_capacity * sizeof(symbol), table->buffer, table->capacity * sizeof(symbol));
+    if (error_code)
+        return false; // we failed to copy the memory
+
+    free(table->buffer);
+    table->buffer = new_buffer;
+    table->capacity = new_capacity;
+
+    return true; // We successfully reallocated the list buffer
+}
+
+static b8 index_symbol(symbol_table* table, u64 buffer_index)
+{
+    if ((buffer_index + 1) * 2 > table->index_capacity && !grow_index(table))
+        return false;
+
+    symbol* sym = &(table->buffer[buffer_index]);
+    u64 mask = table->index_capacity - 1;
+    u64 slot = string_hash(sym->t.text, sym->t.length) & mask;
+    while (table->index[slot] != 0)
+        slot = (slot + 1) & mask;
+
+    table->index[slot] = buffer_index + 1;
+    return true;
+}
+
+static b8 grow_index(symbol_table* table)
+{
+    u64 new_capacity = table->index_capacity ? table->index_capacity * 2 : DEFAULT_SYMBOL_TABLE_INDEX_CAPACITY;
+    u64* new_index = calloc(new_capacity, sizeof(u64));
+    if (!new_index)
+        return false;
+
+    free(table->index);
+    table->index = new_index;
+    table->index_capacity = new_capacity;
+
+    // Re-insert every symbol already in the table
+    u64 mask = new_capacity - 1;
+    for (u64 i = 0; i < table->size; ++i)
+    {
+        u64 slot = string_hash(table->buffer[i].t.text, table->buffer[i].t.length) & mask;
+        while (new_index[slot] != 0)
+            slot = (slot + 1) & mask;
+
+        new_index[slot] = i + 1;
+    }
+
+    return true;
+}
+
+static void populate_builtin_types(symbol_table* table)
+{
+    // TODO(Steven): This is all wrong! update me!
+    token float_type = create_base_type_token("float", TOKEN_FLOAT_LITERAL, TYPE_INFO_FLOAT);
+    symbol_table_add(table, float_type, TYPE_INFO_FLOAT, true);
+
+    token int_type = create_base_type_token("int", TOKEN_INTEGER_LITERAL, TYPE_INFO_INTEGER);
+    symbol_table_add(table, int_type, TYPE_INFO_INTEGER, true);
+}
+
+static token create_base_type_token(const char* text, token_type ttype, type_info tinfo)
+{
+    token type_token = {};
+    type_token.text = text;
+    type_token.length = strlen(text);
+    type_token.type = ttype;
+    type_token.typing_information = tinfo;
+    
+    return type_token;
 }
\ No newline at end of file
@@ -1,123 +1,410 @@
-#include "utilities/error_report.h"
-#include "utilities/file_utilities.h"
-
-#include <malloc.h>
-#include <stdarg.h>
-#include <stdio.h>
-#include <string.h>
-
-//
-// TODO(Steven): Fix the allocator situation here, the help methods 
-//               to not use the supplied allocator from 
-//               error_report_printable_text()
-//
-
-// Gets the text on the whole line of a given file
-char* get_file_line_content(const char* filename, u64 line_number);
-
-// Produces the '^^^^' which will go under the contextual faulted line in the error message
-char* make_error_identification_line(token t);
-
-
-char* format_error_message(char* message, va_list params)
-{
-    // Make the first pass to know how much we need to allocate
-    i32 characters_written = vsnprintf(NULL, 0, message, params) + 1; // NOTE: +1 is for the null byte
-    
-    // Now allocate that buffer and print the formatted message into it
-    char* message_buffer = calloc(characters_written, sizeof(char));
-    //va_copy(params, message);
-    characters_written = vsnprintf(message_buffer, characters_written, message, params);
-    //va_end(params);
-
-    return message_buffer;
-}
-
-
-char* error_report_printable_text(error_report report, void*(allocator)(u64 count, u64 stride))
-{
-    const char* report_format = 
-    "Error @ [%s]: %s\n" // The line for the location in the file and the error message
-    "|\n"
-    "|     %s\n" // The line for the line of text in the file
-    "|_    %s\n" // For the '^^^^' where the invalid token is
-    ;
-
-    char* location = location_printable_text(report.faulted_token.location, allocator);
-    char* context_line = get_file_line_content(report.faulted_token.location.filename, report.faulted_token.location.row);
-    char* ident_line = make_error_identification_line(report.faulted_token);
-
-    u64 total_message_length = snprintf(NULL, 0, report_format, location, report.message, context_line, ident_line);
-
-    char* text_buffer = allocator(total_message_length + 1, sizeof(char)); // +1 for null terminator
-    snprintf(text_buffer, total_message_length, report_format, location, report.message, context_line, ident_line);
-
-    free(context_line);
-    free(ident_line);
-
-    return text_buffer;
-}
-
-
-
-char* get_file_line_content(const char* filename, u64 line_number)
-{
-    u64 file_size = 0;
-    u64 characters_read = file_read(filename, &file_size, NULL);
-    char* file_content = malloc(file_size);
-    characters_read = file_read(filename, &file_size, file_content);
-
-    if (characters_read == 0)
-    {
-        free(file_content);
-        // If we could not read the file, just return the error as part of the error message
-        return "<Unable to read file content, to generate error message>";
-    }
-
-    u64 current_row = 1;
-    char* head = file_content;
-    while ((head < (file_content + characters_read)) && (current_row < line_number))
-    {
-        if (*head == '\n') // when we see a newline advance our row
-            current_row++;
-
-        head++; // move forward in the file content
-    }
-
-    // head should now be at the start of the line
-    char* tail = head;
-    while((tail < (file_content + characters_read)) && (*tail != '\n'))
-    {
-        tail++;
-    }
-
-    u64 line_length = tail - head;
-    char* text_buffer = calloc(line_length + 1, sizeof(char));
-    i32 error_code = strncpy_s(text_buffer, line_length + 1, head, line_length);
-    if (error_code)
-    {
-        free(file_content);
-        free(text_buffer);
-        return "<Unable to copy file content to the output string>";
-    }
-
-    free(file_content);
-    return text_buffer;
-}
-
-char* make_error_identification_line(token t)
-{
-    u64 num_spaces = t.location.column - 1;
-    u64 total_length = num_spaces + t.length;
-
-    char* text_buffer = calloc(total_length + 1, sizeof(char)); // +1 for the null terminator
-    memset(text_buffer, ' ', total_length); // Fill the string with spaces
-    char* start_bad_token_string = text_buffer + num_spaces;
-
-    // Draw the '^~~~~' under the faulted token
-    text_buffer[num_spaces] = '^';
-    for (u64 i = num_spaces + 1; i < total_length; ++i)
-        text_buffer[i] = '~';
-    
-    return text_buffer;
+#include "utilities/error_report.h"
+#include "utilities/file_utilities.h"
+
+#include <malloc.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+//
+// TODO(Steven): Fix the allocator situation here, the help methods 
+//               to not use the supplied allocator from 
+//               error_report_printable_text()
+//
+
+// Gets the text on the whole line of a given file
+char* get_file_line_content(const char* filename, u64 line_number);
+
+// Gets the text on the whole line of a buffer holding the content of a file
+char* get_source_line_content(const char* source, u64 source_length, u64 line_number);
+
+// Lays out the full error message around the already extracted faulted line
+char* render_error_report(error_report report, const char* context_line, void*(allocator)(u64 count, u64 stride));
+
+// Gives a heap allocated copy of a string, so placeholder lines can be free'd like extracted ones
+char* copy_string(const char* text);
+
+/**
+ * @brief Writes text into a caller provided buffer like snprintf() does: what does not fit is cut off, the buffer
+ *        always stays null terminated, and the length of the whole text is still counted
+ */
+typedef struct text_writer {
+    /* Where the text is written, can be NULL if capacity is 0 */
+    char* buffer;
+    /* The amount of bytes the buffer can hold, including the null terminator */
+    u64 capacity;
+    /* The length of all the text given to the writer so far, even the part that did not fit */
+    u64 length;
+} text_writer;
+
+// Appends a string to the writer
+void writer_append(text_writer* writer, const char* text, u64 length);
+
+// Appends a character to the writer count times
+void writer_repeat(text_writer* writer, char c, u64 count);
+
+// Appends a formatted string to the writer
+void writer_printf(text_writer* writer, const char* format, ...);
+
+// Appends the message of a report to the writer, filling in its arguments
+void writer_message(text_writer* writer, error_report report);
+
+// Writes the '^~~~' which will go under the contextual faulted line in the error message
+void writer_identification_line(text_writer* writer, token t);
+
+/**
+ * @brief The text of a diagnostic, every '{}' in it is replaced by the next argument
+ */
+typedef struct diagnostic_format {
+    /* The text of the message */
+    const char* text;
+    /* The amount of '{}' in the text */
+    u64 argument_count;
+} diagnostic_format;
+
+static const diagnostic_format diagnostic_formats[DIAGNOSTIC_MAX_IDS] = {
+    [DIAGNOSTIC_NONE]                               = { "Unknown error", 0 },
+
+    [DIAGNOSTIC_EXPECTED_STATEMENT_END]             = { "Expected end of statement ';'", 0 },
+    [DIAGNOSTIC_EXPECTED_STATEMENT_END_GOT]         = { "Expected end of statement, but got ('{}')", 1 },
+    [DIAGNOSTIC_EXPECTED_STATEMENT_START]           = { "Expected the start of a statement, but instead got '{}'", 1 },
+    [DIAGNOSTIC_INVALID_TOKEN]                      = { "Invalid token found", 0 },
+    [DIAGNOSTIC_IMPOSSIBLE_SCOPE_START]             = { "*Compiler Bug* Impossible wrong token at start of scope!", 0 },
+    [DIAGNOSTIC_EXPECTED_SCOPE_END]                 = { "Expected end of scope '}'", 0 },
+    [DIAGNOSTIC_EXPECTED_CLOSING_CURLY]             = { "Expected a  closing curly bracket '}'", 0 },
+    [DIAGNOSTIC_INVALID_IDENTIFIER_STATEMENT]       = { "Invalid Statement, a identifier must be followed by either a value assignment ('=') or type assignment (':')", 0 },
+    [DIAGNOSTIC_INVALID_VARIABLE_DECLARATION]       = { "Invalid variable declaration, expected a const assignment (':') or a value assignment ('=')", 0 },
+    [DIAGNOSTIC_EXPECTED_PARAMETER_LIST_START]      = { "Expected start of function parameter list ('(')", 0 },
+    [DIAGNOSTIC_EXPECTED_PARAMETER_SEPARATOR]       = { "Expected comma separated parameters in function or parameter list end", 0 },
+    [DIAGNOSTIC_UNTERMINATED_PARAMETER_LIST]        = { "Reached end of file before finishing function parameter list. Did you forget a closing parenthesis around [{}]?", 1 },
+    [DIAGNOSTIC_EXPECTED_PARAMETER_LIST_END]        = { "Expected closing of function parameter list", 0 },
+    [DIAGNOSTIC_EXPECTED_CALL_LIST_START]           = { "Expected start of function call list", 0 },
+    [DIAGNOSTIC_UNTERMINATED_CALL_LIST]             = { "Reached end of file before completing the function call list", 0 },
+    [DIAGNOSTIC_UNEXPECTED_CALL_LIST_TOKEN]         = { "Unexpected token in function call list", 0 },
+    [DIAGNOSTIC_EXPECTED_RETURN_ARROW]              = { "Expected start of function return type ('->'), but got '{}'", 1 },
+    [DIAGNOSTIC_EXPECTED_RETURN_TYPE]               = { "Expected a function return type, but got '{}'", 1 },
+    [DIAGNOSTIC_EXPECTED_CLOSING_PARENTHESIS]       = { "Expected a closing parenthesis, but got '{}'. Expecting a closing parenthesis for opening found here [{}]", 2 },
+    [DIAGNOSTIC_EXPECTED_EXPRESSION_START]          = { "Expected the start of an expression, but instead got '{}'", 1 },
+    [DIAGNOSTIC_UNEXPECTED_EXPRESSION_TOKEN]        = { "Unexpected token '{}', in expression", 1 },
+    [DIAGNOSTIC_EXPECTED_TOKEN]                     = { "Expected a {}, but got '{}'", 2 },
+
+    [DIAGNOSTIC_OPERAND_TYPE_MISMATCH]              = { "Left and right operand types do not match!", 0 },
+    [DIAGNOSTIC_UNKNOWN_TYPE]                       = { "Unknown type '{}' being used in variable declaration", 1 },
+    [DIAGNOSTIC_VARIABLE_REDECLARED]                = { "A variable with the name '{}' already exists! It was declared here [{}]", 2 },
+    [DIAGNOSTIC_SYMBOL_REDECLARED]                  = { "A variable named '{}' already exists! The original was declared here [{}]", 2 },
+    [DIAGNOSTIC_UNDECLARED_VARIABLE]                = { "Undeclared variable '{}'", 1 },
+    [DIAGNOSTIC_UNDECLARED_SYMBOL]                  = { "Undeclared symbol '{}'", 1 },
+    [DIAGNOSTIC_ASSIGNMENT_TO_CONSTANT]             = { "Cannot assign to variable '{}' because it was defined as a constant. Original declaration was made here [{}]", 2 },
+    [DIAGNOSTIC_ASSIGNMENT_TYPE_MISMATCH]           = { "Type mismatch: the type of '{}' does not match that of the assigned expression.", 1 },
+    [DIAGNOSTIC_ASSIGNMENT_SIGNATURE_MISMATCH]      = { "Signature mismatch: the function assigned to '{}' does not take the same parameters, or return the same type, as the one it holds.", 1 },
+    [DIAGNOSTIC_INCORRECT_ASSIGNMENT_TYPE]          = { "Attempting to assign incorrect type to variable '{}'", 1 },
+    [DIAGNOSTIC_UNIMPLEMENTED_ASSIGNMENT]           = { "Unimplemented typing event for assignment operator! *aka. Compiler Bug*", 0 },
+    [DIAGNOSTIC_UNEXPECTED_CONST_ASSIGNMENT_TARGET] = { "Unexpected token to the left of const-assignment operator!", 0 },
+    [DIAGNOSTIC_CALL_OF_NON_FUNCTION]               = { "Cannot call something that is not a function", 0 },
+    [DIAGNOSTIC_MISSING_PARAMETER_LIST]             = { "No parameter list found for this symbol! *Compiler Bug*", 0 },
+    [DIAGNOSTIC_CALL_PARAMETER_COUNT]               = { "{} parameters for function call, got {}, but expected {}", 3 },
+    [DIAGNOSTIC_CALL_PARAMETER_TYPE]                = { "Parameter's type does not match that of function declaration", 0 },
+    [DIAGNOSTIC_UNKNOWN_ENTRY_POINT]                = { "Unknown entry point '{}', nothing with that name is declared in this file", 1 },
+    [DIAGNOSTIC_SYMBOL_NOT_ADDED]                   = { "Unable to find added token in symbol table! *Compiler Bug*", 0 },
+
+    [DIAGNOSTIC_DIVISION_BY_ZERO]                   = { "Integer division by zero", 0 },
+    [DIAGNOSTIC_UNSUPPORTED_OPERATOR]               = { "The operator '{}' cannot be used on {}", 2 },
+    [DIAGNOSTIC_ENTRY_POINT_PARAMETERS]             = { "The entry point '{}' cannot be called, it takes parameters", 1 },
+    [DIAGNOSTIC_STACK_OVERFLOW]                     = { "Stack overflow calling '{}', the calls nest too deeply", 1 },
+
+    [DIAGNOSTIC_SYMBOL_TABLE_ALLOCATION]            = { "Unable to allocate memory for the symbol table! *This is a compiler bug*", 0 },
+    [DIAGNOSTIC_REACHABILITY_ALLOCATION]            = { "Unable to allocate memory for the reachability search! *This is a compiler bug*", 0 },
+    [DIAGNOSTIC_TOKEN_STREAM_ALLOCATION]            = { "Unable to allocate memory for the token stream! *This is a compiler bug*", 0 },
+    [DIAGNOSTIC_TOKEN_ARRAY_ALLOCATION]             = { "Unable to allocate the tokens of the file", 0 },
+    [DIAGNOSTIC_STATEMENT_TABLE_ALLOCATION]         = { "Unable to allocate the statement table of the file", 0 },
+    [DIAGNOSTIC_EDIT_FAILED]                        = { "Unable to apply the edit at offset {}", 1 },
+    [DIAGNOSTIC_FILE_UNREADABLE]                    = { "Unable to read file '{}'", 1 },
+    [DIAGNOSTIC_BUFFER_UNPARSABLE]                  = { "Unable to create a parser for '{}'", 1 },
+    [DIAGNOSTIC_STREAM_UNREADABLE]                  = { "Unable to start reading '{}'", 1 },
+    [DIAGNOSTIC_TOO_MANY_REGISTERS]                 = { "The function needs more than the {} registers a function can have", 1 },
+    [DIAGNOSTIC_SSA_ALLOCATION]                     = { "Unable to allocate memory for the SSA form! *This is a compiler bug*", 0 },
+    [DIAGNOSTIC_BYTECODE_ALLOCATION]                = { "Unable to allocate memory for the bytecode! *This is a compiler bug*", 0 },
+    [DIAGNOSTIC_VM_ALLOCATION]                      = { "Unable to allocate the registers of the virtual machine", 0 },
+    [DIAGNOSTIC_CODE_GENERATION_ALLOCATION]         = { "Unable to allocate memory for the generated code", 0 },
+};
+
+
+char* format_error_message(char* message, va_list params)
+{
+    // Make the first pass to know how much we need to allocate
+    // vsnprintf consumes the va_list, so the first pass needs its own copy
+    va_list size_params;
+    va_copy(size_params, params);
+    i32 characters_written = vsnprintf(NULL, 0, message, size_params) + 1; // NOTE: +1 is for the null byte
+    va_end(size_params);
+    
+    // Now allocate that buffer and print the formatted message into it
+    char* message_buffer = calloc(characters_written, sizeof(char));
+    characters_written = vsnprintf(message_buffer, characters_written, message, params);
+
+    return message_buffer;
+}
+
+
+diagnostic_argument diagnostic_integer(u64 value)
+{
+    diagnostic_argument argument = {};
+    argument.type = DIAGNOSTIC_ARGUMENT_INTEGER;
+    argument.value.integer = value;
+
+    return argument;
+}
+
+diagnostic_argument diagnostic_string(const char* text, u64 length)
+{
+    diagnostic_argument argument = {};
+    argument.type = DIAGNOSTIC_ARGUMENT_STRING;
+    argument.value.string.text = text;
+    argument.value.string.length = length;
+
+    return argument;
+}
+
+diagnostic_argument diagnostic_token_text(token t)
+{
+    return diagnostic_string(t.text, t.length);
+}
+
+diagnostic_argument diagnostic_location(location loc)
+{
+    diagnostic_argument argument = {};
+    argument.type = DIAGNOSTIC_ARGUMENT_LOCATION;
+    argument.value.location = loc;
+
+    return argument;
+}
+
+error_report error_report_create(token t, diagnostic_id id, va_list params)
+{
+    error_report report;
+    report.id = id;
+    report.faulted_token = t;
+
+    // Only the arguments are copied, nothing is formatted until the report is printed
+    u64 argument_count = diagnostic_argument_count(id);
+    for (u64 i = 0; i < argument_count; ++i)
+        report.arguments[i] = va_arg(params, diagnostic_argument);
+
+    return report;
+}
+
+u64 diagnostic_argument_count(diagnostic_id id)
+{
+    if (id >= DIAGNOSTIC_MAX_IDS)
+        return 0;
+
+    return diagnostic_formats[id].argument_count;
+}
+
+u64 error_report_write_message(error_report report, char* buffer, u64 capacity)
+{
+    text_writer writer = { buffer, capacity, 0 };
+    if (capacity)
+        buffer[0] = '\0';
+
+    writer_message(&writer, report);
+
+    return writer.length;
+}
+
+
+char* error_report_printable_text(error_report report, void*(allocator)(u64 count, u64 stride))
+{
+    char* context_line = get_file_line_content(report.faulted_token.location.filename, report.faulted_token.location.row);
+    char* text_buffer = render_error_report(report, context_line, allocator);
+    free(context_line);
+
+    return text_buffer;
+}
+
+char* error_report_printable_text_from_source(error_report report, const char* source, u64 source_length, void*(allocator)(u64 count, u64 stride))
+{
+    char* context_line = source ?
+        get_source_line_content(source, source_length, report.faulted_token.location.row) :
+        copy_string("<File content is not available to generate error message>");
+    char* text_buffer = render_error_report(report, context_line, allocator);
+    free(context_line);
+
+    return text_buffer;
+}
+
+
+
+char* render_error_report(error_report report, const char* context_line, void*(allocator)(u64 count, u64 stride))
+{
+    u64 line_length = strlen(context_line);
+    u64 total_message_length = error_report_write_printable_text(report, context_line, line_length, NULL, 0);
+
+    char* text_buffer = allocator(total_message_length + 1, sizeof(char)); // +1 for null terminator
+    error_report_write_printable_text(report, context_line, line_length, text_buffer, total_message_length + 1);
+
+    return text_buffer;
+}
+
+u64 error_report_write_printable_text(error_report report, const char* line, u64 line_length, char* buffer, u64 capacity)
+{
+    text_writer writer = { buffer, capacity, 0 };
+    if (capacity)
+        buffer[0] = '\0';
+
+    // The line for the location in the file and the error message
+    location loc = report.faulted_token.location;
+    writer_printf(&writer, "Error @ [%s:%llu:%llu]: ", loc.filename, loc.row, loc.column);
+    writer_message(&writer, report);
+
+    // The line for the line of text in the file
+    writer_printf(&writer, "\n|\n|     %.*s\n", (int)line_length, line);
+
+    // For the '^^^^' where the invalid token is
+    writer_append(&writer, "|_    ", 6);
+    writer_identification_line(&writer, report.faulted_token);
+    writer_append(&writer, "\n", 1);
+
+    return writer.length;
+}
+
+char* get_file_line_content(const char* filename, u64 line_number)
+{
+    u64 line_length = 0;
+    char* line = file_read_line(filename, line_number, &line_length);
+    if (!line)
+    {
+        // If we could not read the file, just return the error as part of the error message
+        return copy_string("<Unable to read file content, to generate error message>");
+    }
+
+    return line;
+}
+
+char* get_source_line_content(const char* source, u64 source_length, u64 line_number)
+{
+    u64 current_row = 1;
+    const char* head = source;
+    while ((head < (source + source_length)) && (current_row < line_number))
+    {
+        if (*head == '\n') // when we see a newline advance our row
+            current_row++;
+
+        head++; // move forward in the file content
+    }
+
+    // head should now be at the start of the line
+    const char* tail = head;
+    while((tail < (source + source_length)) && (*tail != '\n'))
+    {
+        tail++;
+    }
+
+    u64 line_length = tail - head;
+    char* text_buffer = calloc(line_length + 1, sizeof(char));
+    i32 error_code = strncpy_s(text_buffer, line_length + 1, head, line_length);
+    if (error_code)
+    {
+        free(text_buffer);
+        return copy_string("<Unable to copy file content to the output string>");
+    }
+
+    return text_buffer;
+}
+
+char* copy_string(const char* text)
+{
+    u64 length = strlen(text);
+    char* copy = calloc(length + 1, sizeof(char));
+    memcpy(copy, text, length);
+
+    return copy;
+}
+
+void writer_append(text_writer* writer, const char* text, u64 length)
+{
+    if (writer->length + 1 < writer->capacity)
+    {
+        u64 space = writer->capacity - writer->length - 1;
+        u64 copied = (length < space) ? length : space;
+        memcpy_s(writer->buffer + writer->length, space, text, copied);
+        writer->buffer[writer->length + copied] = '\0';
+    }
+
+    writer->length += length;
+}
+
+void writer_repeat(text_writer* writer, char c, u64 count)
+{
+    if (writer->length + 1 < writer->capacity)
+    {
+        u64 space = writer->capacity - writer->length - 1;
+        u64 copied = (count < space) ? count : space;
+        memset(writer->buffer + writer->length, c, copied);
+        writer->buffer[writer->length + copied] = '\0';
+    }
+
+    writer->length += count;
+}
+
+void writer_printf(text_writer* writer, const char* format, ...)
+{
+    u64 space = (writer->length < writer->capacity) ? writer->capacity - writer->length : 0;
+
+    va_list params;
+    va_start(params, format);
+    i32 characters_written = vsnprintf(space ? writer->buffer + writer->length : NULL, space, format, params);
+    va_end(params);
+
+    if (characters_written > 0)
+        writer->length += characters_written;
+}
+
+void writer_message(text_writer* writer, error_report report)
+{
+    const char* text = diagnostic_formats[(report.id < DIAGNOSTIC_MAX_IDS) ? report.id : DIAGNOSTIC_NONE].text;
+    u64 argument_index = 0;
+
+    while (*text)
+    {
+        const char* placeholder = strstr(text, "{}");
+        if (!placeholder)
+        {
+            writer_append(writer, text, strlen(text));
+            break;
+        }
+
+        writer_append(writer, text, placeholder - text);
+        text = placeholder + 2;
+
+        diagnostic_argument* argument = &report.arguments[argument_index++];
+        switch (argument->type)
+        {
+            case DIAGNOSTIC_ARGUMENT_INTEGER:
+            {
+                writer_printf(writer, "%llu", argument->value.integer);
+                break;
+            }
+            case DIAGNOSTIC_ARGUMENT_STRING:
+            {
+                writer_append(writer, argument->value.string.text, argument->value.string.length);
+                break;
+            }
+            case DIAGNOSTIC_ARGUMENT_LOCATION:
+            {
+                location loc = argument->value.location;
+                writer_printf(writer, "%s:%llu:%llu", loc.filename, loc.row, loc.column);
+                break;
+            }
+        }
+    }
+}
+
+void writer_identification_line(text_writer* writer, token t)
+{
+    // Draw the '^~~~~' under the faulted token, even an empty token gets its '^'
+    writer_repeat(writer, ' ', t.location.column - 1);
+    writer_append(writer, "^", 1);
+    if (t.length > 1)
+        writer_repeat(writer, '~', t.length - 1);
 }
\ No newline at end of file
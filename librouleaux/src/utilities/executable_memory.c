@@ -0,0 +1,57 @@
+#ifndef _WIN32
+    #define _DEFAULT_SOURCE // For MAP_ANONYMOUS
+#endif
+
+#include "utilities/executable_memory.h"
+
+#ifdef _WIN32
+    #define WIN32_LEAN_AND_MEAN
+    #include <windows.h>
+#else
+    #include <sys/mman.h>
+#endif
+
+
+#ifdef _WIN32
+
+void* executable_memory_allocate(u64 size_bytes)
+{
+    return VirtualAlloc(NULL, size_bytes, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+}
+
+b8 executable_memory_seal(void* memory, u64 size_bytes)
+{
+    DWORD old_protection;
+    if (!VirtualProtect(memory, size_bytes, PAGE_EXECUTE_READ, &old_protection))
+        return false;
+
+    // The processor could still hold what was in the memory before the code was written
+    return FlushInstructionCache(GetCurrentProcess(), memory, size_bytes) != 0;
+}
+
+void executable_memory_free(void* memory, u64 size_bytes)
+{
+    if (memory)
+        VirtualFree(memory, 0, MEM_RELEASE);
+}
+
+#else
+
+void* executable_memory_allocate(u64 size_bytes)
+{
+    void* memory = mmap(NULL, size_bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    return (memory == MAP_FAILED) ? NULL : memory;
+}
+
+b8 executable_memory_seal(void* memory, u64 size_bytes)
+{
+    return mprotect(memory, size_bytes, PROT_READ | PROT_EXEC) == 0;
+}
+
+void executable_memory_free(void* memory, u64 size_bytes)
+{
+    if (memory)
+        munmap(memory, size_bytes);
+}
+
+#endif
@@ -1,54 +1,118 @@
-#include "utilities/file_utilities.h"
-#include <stdio.h>
-
-u64 get_file_size_bytes(const char* filepath, const char* mode);
-u64 read_file_internal(const char* filepath, u64* out_size, void* out_content, const char* mode);
-
-
-u64 file_read(const char* filepath, u64* out_file_size_bytes, void* out_file_content)
-{
-    return read_file_internal(filepath, out_file_size_bytes, out_file_content, "r");
-}
-
-u64 file_read_binary(const char* filepath, u64* out_file_size_bytes, void* out_file_content)
-{
-    return read_file_internal(filepath, out_file_size_bytes, out_file_content, "rb");
-}
-
-
-u64 get_file_size_bytes(const char* filepath, const char* mode)
-{
-    FILE* file;
-    int error = fopen_s(&file, filepath, mode);
-    if (error)
-    {
-        printf("file open error code: %d", error);
-        return 0;
-    }
-
-    fseek(file, 0L, SEEK_END);
-    u64 size = ftell(file);
-    fclose(file);
-
-    return size;
-}
-
-u64 read_file_internal(const char* filepath, u64* out_file_size_bytes, void* out_file_content, const char* mode)
-{
-    *out_file_size_bytes = get_file_size_bytes(filepath, mode);
-    if (!out_file_content)
-        return 0;
-
-    FILE* file;
-    int error = fopen_s(&file, filepath, mode);
-    if (error)
-    {
-        printf("file open error code: %d", error);
-        return 0;
-    }
-
-    u64 bytes_read = fread_s(out_file_content, *out_file_size_bytes, 1, *out_file_size_bytes, file);
-    fclose(file);
-
-    return bytes_read;
+#include "utilities/file_utilities.h"
+#include <malloc.h>
+#include <stdio.h>
+
+u64 get_file_size_bytes(const char* filepath, const char* mode);
+u64 read_file_internal(const char* filepath, u64* out_size, void* out_content, const char* mode);
+
+
+u64 file_read(const char* filepath, u64* out_file_size_bytes, void* out_file_content)
+{
+    return read_file_internal(filepath, out_file_size_bytes, out_file_content, "r");
+}
+
+u64 file_read_binary(const char* filepath, u64* out_file_size_bytes, void* out_file_content)
+{
+    return read_file_internal(filepath, out_file_size_bytes, out_file_content, "rb");
+}
+
+char* file_read_line(const char* filepath, u64 line_number, u64* out_line_length)
+{
+    FILE* file;
+    int error = fopen_s(&file, filepath, "r");
+    if (error)
+        return NULL;
+
+    // Skip over the lines before the one being read
+    int character = 0;
+    for (u64 row = 1; row < line_number && character != EOF; )
+    {
+        character = fgetc(file);
+        if (character == '\n')
+            row++;
+    }
+
+    u64 length = 0;
+    u64 capacity = 128;
+    char* line = malloc(capacity);
+    while (line && character != EOF)
+    {
+        character = fgetc(file);
+        if (character == EOF || character == '\n')
+            break;
+
+        // Grow the line while keeping room for the null terminator
+        if (length + 1 >= capacity)
+        {
+            char* new_line = realloc(line, capacity * 2);
+            if (!new_line)
+                free(line);
+
+            line = new_line;
+            capacity *= 2;
+        }
+
+        if (line)
+            line[length++] = (char)character;
+    }
+
+    fclose(file);
+    if (!line)
+        return NULL;
+
+    line[length] = '\0';
+    *out_line_length = length;
+    return line;
+}
+
+void* file_stream_open(const char* filepath)
+{
+    FILE* file;
+    int error = fopen_s(&file, filepath, "r");
+    if (error)
+        return NULL;
+
+    return file;
+}
+
+u64 file_stream_read(void* file, char* buffer, u64 capacity)
+{
+    return fread_s(buffer, capacity, 1, capacity, file);
+}
+
+void file_stream_close(void* file)
+{
+    fclose(file);
+}
+
+
+u64 get_file_size_bytes(const char* filepath, const char* mode)
+{
+    FILE* file;
+    int error = fopen_s(&file, filepath, mode);
+    if (error)
+        return 0;
+
+    fseek(file, 0L, SEEK_END);
+    u64 size = ftell(file);
+    fclose(file);
+
+    return size;
+}
+
+u64 read_file_internal(const char* filepath, u64* out_file_size_bytes, void* out_file_content, const char* mode)
+{
+    *out_file_size_bytes = get_file_size_bytes(filepath, mode);
+    if (!out_file_content)
+        return 0;
+
+    FILE* file;
+    int error = fopen_s(&file, filepath, mode);
+    if (error)
+        return 0;
+
+    u64 bytes_read = fread_s(out_file_content, *out_file_size_bytes, 1, *out_file_size_bytes, file);
+    fclose(file);
+
+    return bytes_read;
 }
\ No newline at end of file
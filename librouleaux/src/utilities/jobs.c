@@ -0,0 +1,560 @@
+#include "utilities/jobs.h"
+#include "utilities/thread.h"
+
+#include <malloc.h>
+#include <string.h>
+
+#define DEFAULT_JOB_DEQUE_CAPACITY 256
+#define DEFAULT_JOB_QUEUE_CAPACITY 64
+#define DEFAULT_JOB_QUEUE_RESIZE_FACTOR 2
+
+/**
+ * @brief A job, as stored in a worker's deque
+ * @note the fields are atomic because a thief can read a slot while the owner is writing another part of the buffer
+ */
+typedef struct job_slot {
+    _Atomic(job_function_fptr) function;
+    _Atomic(void*) user_data;
+    _Atomic(job_counter*) counter;
+} job_slot;
+
+/**
+ * @brief A job, as stored anywhere else
+ */
+typedef struct job {
+    job_function_fptr function;
+    void* user_data;
+    job_counter* counter;
+} job;
+
+/**
+ * @brief The circular buffer of a job_deque
+ */
+typedef struct job_deque_buffer {
+    /* The buffer this one replaced, a thief might still be reading it so it is kept until the deque is destroyed */
+    struct job_deque_buffer* previous;
+    /* The amount of slots in the buffer, always a power of two */
+    i64 capacity;
+    /* The slots of the buffer */
+    job_slot slots[];
+} job_deque_buffer;
+
+/**
+ * @brief A Chase-Lev deque, the owning worker pushes and takes at the bottom while any other thread steals from the top
+ */
+typedef struct job_deque {
+    /* The index of the next job to be stolen */
+    _Alignas(64) _Atomic i64 top;
+    /* The index one past the last job pushed */
+    _Alignas(64) _Atomic i64 bottom;
+    /* The current buffer */
+    _Atomic(job_deque_buffer*) buffer;
+} job_deque;
+
+/**
+ * @brief A mutex protected FIFO queue of the jobs submitted from threads that are not workers
+ */
+typedef struct job_queue {
+    job* jobs;
+    u64 head;
+    u64 size;
+    u64 capacity;
+} job_queue;
+
+typedef struct job_worker {
+    /* The scheduler this worker belongs to */
+    struct rouleaux_jobs* scheduler;
+    /* The index of the worker in the scheduler */
+    u32 index;
+    /* The thread running the worker */
+    rouleaux_thread thread;
+    /* The jobs submitted by this worker */
+    job_deque deque;
+    /* The state of the worker's random number generator, used to pick who to steal from */
+    u64 random_state;
+} job_worker;
+
+struct rouleaux_jobs {
+    /* The workers of the scheduler */
+    job_worker* workers;
+    /* The amount of workers */
+    u32 worker_count;
+    /* The amount of times an idle worker looks for a job before it goes to sleep */
+    u32 spin_count;
+
+    /* The jobs submitted from threads that are not workers, protected by lock */
+    job_queue injected_jobs;
+    /* The amount of jobs in injected_jobs, so the workers can check it without taking the lock */
+    _Atomic u64 injected_job_count;
+
+    /* Protects injected_jobs and the sleeping of workers */
+    rouleaux_mutex lock;
+    /* The condition the sleeping workers wait on */
+    rouleaux_condition wake_condition;
+    /* The amount of workers sleeping (or about to sleep) on wake_condition */
+    _Atomic u32 sleeping_count;
+
+    /* Set when the scheduler is being destroyed */
+    _Atomic b8 shutting_down;
+};
+
+// The worker the calling thread is, NULL on threads which are not workers
+static _Thread_local job_worker* current_worker = NULL;
+
+// The thread function of a worker
+static void job_worker_run(void* user_data);
+
+// Finds a job for the calling thread, in order: its own deque, the injected jobs, then the other workers' deques
+static b8 find_job(rouleaux_jobs* jobs, job_worker* worker, job* out_job);
+
+// Runs a job and marks it as done on its counter
+static void run_job(job* j);
+
+// Returns true if any job is waiting to be run
+static b8 has_pending_jobs(rouleaux_jobs* jobs);
+
+// Wakes a sleeping worker, if there is one
+static void wake_sleeping_worker(rouleaux_jobs* jobs);
+
+// Puts the calling worker to sleep until a job is submitted (or the scheduler is shutting down)
+static void park_worker(rouleaux_jobs* jobs);
+
+static b8 job_deque_create(job_deque* deque, i64 capacity);
+static void job_deque_destroy(job_deque* deque);
+static void job_deque_push(job_deque* deque, job j);
+static b8 job_deque_take(job_deque* deque, job* out_job);
+static b8 job_deque_steal(job_deque* deque, job* out_job);
+static job_deque_buffer* allocate_deque_buffer(i64 capacity, job_deque_buffer* previous);
+
+static b8 job_queue_push(job_queue* queue, job j);
+static b8 job_queue_pop(job_queue* queue, job* out_job);
+
+
+rouleaux_jobs* jobs_create(jobs_options options)
+{
+    rouleaux_jobs* jobs = calloc(1, sizeof(rouleaux_jobs));
+    if (!jobs)
+        return NULL;
+
+    jobs->worker_count = options.thread_count ? options.thread_count : thread_hardware_concurrency();
+    jobs->spin_count = options.spin_count ? options.spin_count : DEFAULT_JOBS_SPIN_COUNT;
+    atomic_init(&jobs->injected_job_count, 0);
+    atomic_init(&jobs->sleeping_count, 0);
+    atomic_init(&jobs->shutting_down, false);
+
+    jobs->workers = calloc(jobs->worker_count, sizeof(job_worker));
+    if (!jobs->workers || !mutex_create(&jobs->lock) || !condition_create(&jobs->wake_condition))
+    {
+        mutex_destroy(&jobs->lock);
+        free(jobs->workers);
+        free(jobs);
+        return NULL;
+    }
+
+    // Every deque has to exist before any worker starts stealing
+    for (u32 i = 0; i < jobs->worker_count; ++i)
+    {
+        job_worker* worker = &jobs->workers[i];
+        worker->scheduler = jobs;
+        worker->index = i;
+        worker->random_state = 0x9E3779B97F4A7C15ull * (i + 1);
+        job_deque_create(&worker->deque, DEFAULT_JOB_DEQUE_CAPACITY);
+    }
+
+    for (u32 i = 0; i < jobs->worker_count; ++i)
+    {
+        job_worker* worker = &jobs->workers[i];
+
+        // A worker whose thread fails to start just never steals, its deque stays empty
+        if (thread_create(&worker->thread, job_worker_run, worker) && options.pin_threads)
+            thread_set_affinity(&worker->thread, i);
+    }
+
+    return jobs;
+}
+
+void jobs_destroy(rouleaux_jobs* jobs)
+{
+    if (!jobs)
+        return;
+
+    mutex_lock(&jobs->lock);
+    atomic_store(&jobs->shutting_down, true);
+    condition_wake_all(&jobs->wake_condition);
+    mutex_unlock(&jobs->lock);
+
+    for (u32 i = 0; i < jobs->worker_count; ++i)
+        thread_join(&jobs->workers[i].thread);
+
+    for (u32 i = 0; i < jobs->worker_count; ++i)
+        job_deque_destroy(&jobs->workers[i].deque);
+
+    condition_destroy(&jobs->wake_condition);
+    mutex_destroy(&jobs->lock);
+    free(jobs->injected_jobs.jobs);
+    free(jobs->workers);
+    free(jobs);
+}
+
+u32 jobs_thread_count(rouleaux_jobs* jobs)
+{
+    return jobs ? jobs->worker_count : 0;
+}
+
+void jobs_submit(rouleaux_jobs* jobs, job_function_fptr function, void* user_data, job_counter* counter)
+{
+    job j = {};
+    j.function = function;
+    j.user_data = user_data;
+    j.counter = counter;
+
+    if (counter)
+        atomic_fetch_add(&counter->pending, 1);
+
+    if (current_worker && current_worker->scheduler == jobs)
+    {
+        job_deque_push(&current_worker->deque, j);
+    }
+    else
+    {
+        mutex_lock(&jobs->lock);
+        b8 pushed = job_queue_push(&jobs->injected_jobs, j);
+        if (pushed)
+            atomic_fetch_add(&jobs->injected_job_count, 1);
+        mutex_unlock(&jobs->lock);
+
+        // If the queue could not grow, the job is run right here instead
+        if (!pushed)
+        {
+            run_job(&j);
+            return;
+        }
+    }
+
+    wake_sleeping_worker(jobs);
+}
+
+void jobs_wait(rouleaux_jobs* jobs, job_counter* counter)
+{
+    job_worker* worker = (current_worker && current_worker->scheduler == jobs) ? current_worker : NULL;
+
+    // Instead of blocking, help run the jobs (the ones being waited on are most likely among them)
+    while (atomic_load_explicit(&counter->pending, memory_order_acquire) > 0)
+    {
+        job j;
+        if (find_job(jobs, worker, &j))
+            run_job(&j);
+        else
+            thread_yield();
+    }
+}
+
+void jobs_run_and_wait(rouleaux_jobs* jobs, u32 count, job_function_fptr function, void* user_data)
+{
+    if (count == 0)
+        return;
+
+    if (!jobs)
+    {
+        for (u32 i = 0; i < count; ++i)
+            function(user_data);
+        return;
+    }
+
+    job_counter counter = {};
+    for (u32 i = 1; i < count; ++i)
+        jobs_submit(jobs, function, user_data, &counter);
+
+    // The calling thread does its share too
+    function(user_data);
+
+    jobs_wait(jobs, &counter);
+}
+
+
+void job_worker_run(void* user_data)
+{
+    job_worker* worker = user_data;
+    rouleaux_jobs* jobs = worker->scheduler;
+    current_worker = worker;
+
+    u32 idle_count = 0;
+    while (!atomic_load_explicit(&jobs->shutting_down, memory_order_acquire))
+    {
+        job j;
+        if (find_job(jobs, worker, &j))
+        {
+            run_job(&j);
+            idle_count = 0;
+            continue;
+        }
+
+        if (++idle_count < jobs->spin_count)
+        {
+            thread_yield();
+            continue;
+        }
+
+        park_worker(jobs);
+        idle_count = 0;
+    }
+
+    current_worker = NULL;
+}
+
+b8 find_job(rouleaux_jobs* jobs, job_worker* worker, job* out_job)
+{
+    if (worker && job_deque_take(&worker->deque, out_job))
+        return true;
+
+    if (atomic_load_explicit(&jobs->injected_job_count, memory_order_acquire) > 0)
+    {
+        mutex_lock(&jobs->lock);
+        b8 popped = job_queue_pop(&jobs->injected_jobs, out_job);
+        if (popped)
+            atomic_fetch_sub(&jobs->injected_job_count, 1);
+        mutex_unlock(&jobs->lock);
+
+        if (popped)
+            return true;
+    }
+
+    // Try every other worker once, starting from a random one so the thieves spread out
+    u64 start = 0;
+    if (worker)
+    {
+        // xorshift64
+        worker->random_state ^= worker->random_state << 13;
+        worker->random_state ^= worker->random_state >> 7;
+        worker->random_state ^= worker->random_state << 17;
+        start = worker->random_state;
+    }
+
+    for (u32 i = 0; i < jobs->worker_count; ++i)
+    {
+        job_worker* victim = &jobs->workers[(start + i) % jobs->worker_count];
+        if (victim == worker)
+            continue;
+
+        if (job_deque_steal(&victim->deque, out_job))
+            return true;
+    }
+
+    return false;
+}
+
+void run_job(job* j)
+{
+    j->function(j->user_data);
+
+    if (j->counter)
+        atomic_fetch_sub_explicit(&j->counter->pending, 1, memory_order_release);
+}
+
+b8 has_pending_jobs(rouleaux_jobs* jobs)
+{
+    if (atomic_load(&jobs->injected_job_count) > 0)
+        return true;
+
+    for (u32 i = 0; i < jobs->worker_count; ++i)
+    {
+        job_deque* deque = &jobs->workers[i].deque;
+        if (atomic_load(&deque->bottom) > atomic_load(&deque->top))
+            return true;
+    }
+
+    return false;
+}
+
+void wake_sleeping_worker(rouleaux_jobs* jobs)
+{
+    // Pairs with the fence in park_worker(), either the sleeper sees the new job or we see the sleeper
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load(&jobs->sleeping_count) == 0)
+        return;
+
+    mutex_lock(&jobs->lock);
+    condition_wake_one(&jobs->wake_condition);
+    mutex_unlock(&jobs->lock);
+}
+
+void park_worker(rouleaux_jobs* jobs)
+{
+    mutex_lock(&jobs->lock);
+    atomic_fetch_add(&jobs->sleeping_count, 1);
+    atomic_thread_fence(memory_order_seq_cst);
+
+    // A job might have been submitted between the last look and announcing that we are going to sleep
+    if (!has_pending_jobs(jobs) && !atomic_load(&jobs->shutting_down))
+        condition_wait(&jobs->wake_condition, &jobs->lock);
+
+    atomic_fetch_sub(&jobs->sleeping_count, 1);
+    mutex_unlock(&jobs->lock);
+}
+
+
+b8 job_deque_create(job_deque* deque, i64 capacity)
+{
+    atomic_init(&deque->top, 0);
+    atomic_init(&deque->bottom, 0);
+
+    job_deque_buffer* buffer = allocate_deque_buffer(capacity, NULL);
+    atomic_init(&deque->buffer, buffer);
+
+    return buffer != NULL;
+}
+
+void job_deque_destroy(job_deque* deque)
+{
+    job_deque_buffer* buffer = atomic_load(&deque->buffer);
+    while (buffer)
+    {
+        job_deque_buffer* previous = buffer->previous;
+        free(buffer);
+        buffer = previous;
+    }
+
+    atomic_store(&deque->buffer, NULL);
+}
+
+void job_deque_push(job_deque* deque, job j)
+{
+    i64 bottom = atomic_load_explicit(&deque->bottom, memory_order_relaxed);
+    i64 top = atomic_load_explicit(&deque->top, memory_order_acquire);
+    job_deque_buffer* buffer = atomic_load_explicit(&deque->buffer, memory_order_relaxed);
+
+    if (!buffer || bottom - top > buffer->capacity - 1)
+    {
+        // The deque is full, move the jobs into a buffer twice the size
+        job_deque_buffer* bigger = allocate_deque_buffer(buffer ? buffer->capacity * 2 : DEFAULT_JOB_DEQUE_CAPACITY, buffer);
+        if (!bigger)
+        {
+            // Out of memory, run the job right away rather than losing it
+            run_job(&j);
+            return;
+        }
+
+        for (i64 i = top; i < bottom; ++i)
+        {
+            job_slot* from = &buffer->slots[i & (buffer->capacity - 1)];
+            job_slot* to = &bigger->slots[i & (bigger->capacity - 1)];
+            atomic_store_explicit(&to->function, atomic_load_explicit(&from->function, memory_order_relaxed), memory_order_relaxed);
+            atomic_store_explicit(&to->user_data, atomic_load_explicit(&from->user_data, memory_order_relaxed), memory_order_relaxed);
+            atomic_store_explicit(&to->counter, atomic_load_explicit(&from->counter, memory_order_relaxed), memory_order_relaxed);
+        }
+
+        atomic_store_explicit(&deque->buffer, bigger, memory_order_release);
+        buffer = bigger;
+    }
+
+    job_slot* slot = &buffer->slots[bottom & (buffer->capacity - 1)];
+    atomic_store_explicit(&slot->function, j.function, memory_order_relaxed);
+    atomic_store_explicit(&slot->user_data, j.user_data, memory_order_relaxed);
+    atomic_store_explicit(&slot->counter, j.counter, memory_order_relaxed);
+
+    atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_release);
+}
+
+b8 job_deque_take(job_deque* deque, job* out_job)
+{
+    i64 bottom = atomic_load_explicit(&deque->bottom, memory_order_relaxed) - 1;
+    job_deque_buffer* buffer = atomic_load_explicit(&deque->buffer, memory_order_relaxed);
+    atomic_store_explicit(&deque->bottom, bottom, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    i64 top = atomic_load_explicit(&deque->top, memory_order_relaxed);
+
+    if (top > bottom)
+    {
+        // The deque was empty
+        atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+        return false;
+    }
+
+    job_slot* slot = &buffer->slots[bottom & (buffer->capacity - 1)];
+    out_job->function = atomic_load_explicit(&slot->function, memory_order_relaxed);
+    out_job->user_data = atomic_load_explicit(&slot->user_data, memory_order_relaxed);
+    out_job->counter = atomic_load_explicit(&slot->counter, memory_order_relaxed);
+
+    if (top != bottom)
+        return true; // There was more than one job, no thief can be racing us for this one
+
+    // This was the last job, so we race any thieves for it
+    b8 won = atomic_compare_exchange_strong_explicit(&deque->top, &top, top + 1, memory_order_seq_cst, memory_order_relaxed);
+    atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+
+    return won;
+}
+
+b8 job_deque_steal(job_deque* deque, job* out_job)
+{
+    i64 top = atomic_load_explicit(&deque->top, memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    i64 bottom = atomic_load_explicit(&deque->bottom, memory_order_acquire);
+
+    if (top >= bottom)
+        return false;
+
+    job_deque_buffer* buffer = atomic_load_explicit(&deque->buffer, memory_order_acquire);
+    job_slot* slot = &buffer->slots[top & (buffer->capacity - 1)];
+    job j;
+    j.function = atomic_load_explicit(&slot->function, memory_order_relaxed);
+    j.user_data = atomic_load_explicit(&slot->user_data, memory_order_relaxed);
+    j.counter = atomic_load_explicit(&slot->counter, memory_order_relaxed);
+
+    // Another thief (or the owner) got to it first
+    if (!atomic_compare_exchange_strong_explicit(&deque->top, &top, top + 1, memory_order_seq_cst, memory_order_relaxed))
+        return false;
+
+    *out_job = j;
+    return true;
+}
+
+job_deque_buffer* allocate_deque_buffer(i64 capacity, job_deque_buffer* previous)
+{
+    job_deque_buffer* buffer = calloc(1, sizeof(job_deque_buffer) + capacity * sizeof(job_slot));
+    if (!buffer)
+        return NULL;
+
+    buffer->previous = previous;
+    buffer->capacity = capacity;
+
+    return buffer;
+}
+
+
+b8 job_queue_push(job_queue* queue, job j)
+{
+    if (queue->size + 1 >= queue->capacity)
+    {
+        u64 new_capacity = queue->capacity ? queue->capacity * DEFAULT_JOB_QUEUE_RESIZE_FACTOR : DEFAULT_JOB_QUEUE_CAPACITY;
+        job* new_jobs = malloc(new_capacity * sizeof(job));
+        if (!new_jobs)
+            return false;
+
+        // Unwrap the ring into the start of the new buffer
+        for (u64 i = 0; i < queue->size; ++i)
+            new_jobs[i] = queue->jobs[(queue->head + i) % queue->capacity];
+
+        free(queue->jobs);
+        queue->jobs = new_jobs;
+        queue->head = 0;
+        queue->capacity = new_capacity;
+    }
+
+    queue->jobs[(queue->head + queue->size) % queue->capacity] = j;
+    queue->size++;
+
+    return true;
+}
+
+b8 job_queue_pop(job_queue* queue, job* out_job)
+{
+    if (queue->size == 0)
+        return false;
+
+    *out_job = queue->jobs[queue->head];
+    queue->head = (queue->head + 1) % queue->capacity;
+    queue->size--;
+
+    return true;
+}
@@ -0,0 +1,53 @@
+#include "utilities/line_index.h"
+
+#include <malloc.h>
+#include <string.h>
+
+
+line_index line_index_create(const char* source, u64 length)
+{
+    line_index index = {};
+    index.source = source;
+    index.source_length = length;
+
+    // Count the lines first, so the starts fit in a single allocation
+    u64 line_count = 1;
+    const char* end = source + length;
+    for (const char* newline = memchr(source, '\n', length); newline; newline = memchr(newline + 1, '\n', end - (newline + 1)))
+        line_count++;
+
+    index.line_starts = malloc(line_count * sizeof(u64));
+    if (!index.line_starts)
+        return index;
+
+    index.line_starts[0] = 0;
+    u64 line = 1;
+    for (const char* newline = memchr(source, '\n', length); newline; newline = memchr(newline + 1, '\n', end - (newline + 1)))
+        index.line_starts[line++] = (newline + 1) - source;
+
+    index.line_count = line_count;
+    return index;
+}
+
+void line_index_destroy(line_index* index)
+{
+    free(index->line_starts);
+    memset(index, 0, sizeof(line_index));
+}
+
+b8 line_index_get_line(const line_index* index, u64 row, const char** out_line, u64* out_line_length)
+{
+    if (row == 0 || row > index->line_count)
+        return false;
+
+    u64 start = index->line_starts[row - 1];
+    // Every line but the last ends just before the next one starts, with a '\n'
+    u64 end = (row < index->line_count) ? index->line_starts[row] - 1 : index->source_length;
+    if (end > start && index->source[end - 1] == '\r')
+        end--;
+
+    *out_line = index->source + start;
+    *out_line_length = end - start;
+
+    return true;
+}
@@ -0,0 +1,106 @@
+#include "utilities/string_interner.h"
+
+#include <malloc.h>
+#include <string.h>
+
+#define DEFAULT_STRING_INTERNER_CAPACITY 64
+#define STRING_INTERNER_BLOCK_SIZE (16 * 1024)
+
+// Doubles the amount of slots in the table and re-inserts every string
+static b8 grow_table(string_interner* interner);
+
+
+string_interner string_interner_create()
+{
+    string_interner interner = {};
+    interner.storage = node_arena_create(STRING_INTERNER_BLOCK_SIZE);
+
+    return interner;
+}
+
+void string_interner_destroy(string_interner* interner)
+{
+    free(interner->slots);
+    node_arena_destroy(&interner->storage);
+
+    memset(interner, 0, sizeof(string_interner));
+}
+
+const char* string_interner_intern(string_interner* interner, const char* text, u64 length)
+{
+    // Keep the table at most half full, so probe sequences stay short
+    if ((interner->size + 1) * 2 > interner->capacity && !grow_table(interner))
+        return NULL;
+
+    u64 hash = string_hash(text, length);
+    u64 mask = interner->capacity - 1;
+    u64 index = hash & mask;
+    while (interner->slots[index].text)
+    {
+        interned_string* slot = &interner->slots[index];
+        if (slot->hash == hash && slot->length == length && memcmp(slot->text, text, length) == 0)
+            return slot->text;
+
+        index = (index + 1) & mask;
+    }
+
+    char* copy = node_arena_allocate(&interner->storage, length + 1); // +1 for the null terminator
+    if (!copy)
+        return NULL;
+
+    memcpy(copy, text, length);
+    copy[length] = '\0';
+
+    interner->slots[index].text = copy;
+    interner->slots[index].length = length;
+    interner->slots[index].hash = hash;
+    interner->size++;
+
+    return copy;
+}
+
+u64 string_hash(const char* text, u64 length)
+{
+    return string_hash_bytes(STRING_HASH_SEED, text, length);
+}
+
+u64 string_hash_bytes(u64 hash, const void* bytes, u64 length)
+{
+    const u8* data = bytes;
+    for (u64 i = 0; i < length; ++i)
+    {
+        hash ^= data[i];
+        hash *= 1099511628211ull;
+    }
+
+    return hash;
+}
+
+
+b8 grow_table(string_interner* interner)
+{
+    u64 new_capacity = interner->capacity ? interner->capacity * 2 : DEFAULT_STRING_INTERNER_CAPACITY;
+    interned_string* new_slots = calloc(new_capacity, sizeof(interned_string));
+    if (!new_slots)
+        return false;
+
+    u64 mask = new_capacity - 1;
+    for (u64 i = 0; i < interner->capacity; ++i)
+    {
+        interned_string slot = interner->slots[i];
+        if (!slot.text)
+            continue;
+
+        u64 index = slot.hash & mask;
+        while (new_slots[index].text)
+            index = (index + 1) & mask;
+
+        new_slots[index] = slot;
+    }
+
+    free(interner->slots);
+    interner->slots = new_slots;
+    interner->capacity = new_capacity;
+
+    return true;
+}
@@ -0,0 +1,285 @@
+#ifndef _WIN32
+    #define _GNU_SOURCE // For pthread_setaffinity_np()
+#endif
+
+#include "utilities/thread.h"
+
+#include <malloc.h>
+
+#ifdef _WIN32
+    #define WIN32_LEAN_AND_MEAN
+    #include <windows.h>
+#else
+    #include <pthread.h>
+    #include <sched.h>
+    #include <unistd.h>
+#endif
+
+// The function and its parameter, handed to the platform thread entry point
+typedef struct thread_start_info {
+    thread_function_fptr function;
+    void* user_data;
+} thread_start_info;
+
+
+#ifdef _WIN32
+
+static DWORD WINAPI thread_entry(LPVOID parameter)
+{
+    thread_start_info info = *(thread_start_info*)parameter;
+    free(parameter);
+
+    info.function(info.user_data);
+    return 0;
+}
+
+b8 thread_create(rouleaux_thread* out_thread, thread_function_fptr function, void* user_data)
+{
+    thread_start_info* info = malloc(sizeof(thread_start_info));
+    info->function = function;
+    info->user_data = user_data;
+
+    HANDLE handle = CreateThread(NULL, 0, thread_entry, info, 0, NULL);
+    if (!handle)
+    {
+        free(info);
+        out_thread->handle = NULL;
+        return false;
+    }
+
+    out_thread->handle = handle;
+    return true;
+}
+
+void thread_join(rouleaux_thread* thread)
+{
+    if (!thread->handle)
+        return;
+
+    WaitForSingleObject((HANDLE)thread->handle, INFINITE);
+    CloseHandle((HANDLE)thread->handle);
+    thread->handle = NULL;
+}
+
+u32 thread_hardware_concurrency()
+{
+    SYSTEM_INFO system_info;
+    GetSystemInfo(&system_info);
+
+    return system_info.dwNumberOfProcessors > 0 ? system_info.dwNumberOfProcessors : 1;
+}
+
+void thread_yield()
+{
+    SwitchToThread();
+}
+
+b8 thread_set_affinity(rouleaux_thread* thread, u32 processor_index)
+{
+    if (!thread->handle)
+        return false;
+
+    DWORD_PTR mask = (DWORD_PTR)1 << (processor_index % thread_hardware_concurrency() % (sizeof(DWORD_PTR) * 8));
+    return SetThreadAffinityMask((HANDLE)thread->handle, mask) != 0;
+}
+
+b8 mutex_create(rouleaux_mutex* out_mutex)
+{
+    CRITICAL_SECTION* section = malloc(sizeof(CRITICAL_SECTION));
+    if (!section)
+        return false;
+
+    InitializeCriticalSection(section);
+    out_mutex->handle = section;
+    return true;
+}
+
+void mutex_destroy(rouleaux_mutex* mutex)
+{
+    if (!mutex->handle)
+        return;
+
+    DeleteCriticalSection((CRITICAL_SECTION*)mutex->handle);
+    free(mutex->handle);
+    mutex->handle = NULL;
+}
+
+void mutex_lock(rouleaux_mutex* mutex)
+{
+    EnterCriticalSection((CRITICAL_SECTION*)mutex->handle);
+}
+
+void mutex_unlock(rouleaux_mutex* mutex)
+{
+    LeaveCriticalSection((CRITICAL_SECTION*)mutex->handle);
+}
+
+b8 condition_create(rouleaux_condition* out_condition)
+{
+    CONDITION_VARIABLE* condition = malloc(sizeof(CONDITION_VARIABLE));
+    if (!condition)
+        return false;
+
+    InitializeConditionVariable(condition);
+    out_condition->handle = condition;
+    return true;
+}
+
+void condition_destroy(rouleaux_condition* condition)
+{
+    free(condition->handle);
+    condition->handle = NULL;
+}
+
+void condition_wait(rouleaux_condition* condition, rouleaux_mutex* mutex)
+{
+    SleepConditionVariableCS((CONDITION_VARIABLE*)condition->handle, (CRITICAL_SECTION*)mutex->handle, INFINITE);
+}
+
+void condition_wake_one(rouleaux_condition* condition)
+{
+    WakeConditionVariable((CONDITION_VARIABLE*)condition->handle);
+}
+
+void condition_wake_all(rouleaux_condition* condition)
+{
+    WakeAllConditionVariable((CONDITION_VARIABLE*)condition->handle);
+}
+
+#else
+
+static void* thread_entry(void* parameter)
+{
+    thread_start_info info = *(thread_start_info*)parameter;
+    free(parameter);
+
+    info.function(info.user_data);
+    return NULL;
+}
+
+b8 thread_create(rouleaux_thread* out_thread, thread_function_fptr function, void* user_data)
+{
+    thread_start_info* info = malloc(sizeof(thread_start_info));
+    info->function = function;
+    info->user_data = user_data;
+
+    pthread_t* handle = malloc(sizeof(pthread_t));
+    if (pthread_create(handle, NULL, thread_entry, info) != 0)
+    {
+        free(handle);
+        free(info);
+        out_thread->handle = NULL;
+        return false;
+    }
+
+    out_thread->handle = handle;
+    return true;
+}
+
+void thread_join(rouleaux_thread* thread)
+{
+    if (!thread->handle)
+        return;
+
+    pthread_join(*(pthread_t*)thread->handle, NULL);
+    free(thread->handle);
+    thread->handle = NULL;
+}
+
+u32 thread_hardware_concurrency()
+{
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (u32)count : 1;
+}
+
+void thread_yield()
+{
+    sched_yield();
+}
+
+b8 thread_set_affinity(rouleaux_thread* thread, u32 processor_index)
+{
+    if (!thread->handle)
+        return false;
+
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    CPU_SET(processor_index % thread_hardware_concurrency(), &cpu_set);
+
+    return pthread_setaffinity_np(*(pthread_t*)thread->handle, sizeof(cpu_set_t), &cpu_set) == 0;
+}
+
+b8 mutex_create(rouleaux_mutex* out_mutex)
+{
+    pthread_mutex_t* handle = malloc(sizeof(pthread_mutex_t));
+    if (!handle || pthread_mutex_init(handle, NULL) != 0)
+    {
+        free(handle);
+        out_mutex->handle = NULL;
+        return false;
+    }
+
+    out_mutex->handle = handle;
+    return true;
+}
+
+void mutex_destroy(rouleaux_mutex* mutex)
+{
+    if (!mutex->handle)
+        return;
+
+    pthread_mutex_destroy((pthread_mutex_t*)mutex->handle);
+    free(mutex->handle);
+    mutex->handle = NULL;
+}
+
+void mutex_lock(rouleaux_mutex* mutex)
+{
+    pthread_mutex_lock((pthread_mutex_t*)mutex->handle);
+}
+
+void mutex_unlock(rouleaux_mutex* mutex)
+{
+    pthread_mutex_unlock((pthread_mutex_t*)mutex->handle);
+}
+
+b8 condition_create(rouleaux_condition* out_condition)
+{
+    pthread_cond_t* handle = malloc(sizeof(pthread_cond_t));
+    if (!handle || pthread_cond_init(handle, NULL) != 0)
+    {
+        free(handle);
+        out_condition->handle = NULL;
+        return false;
+    }
+
+    out_condition->handle = handle;
+    return true;
+}
+
+void condition_destroy(rouleaux_condition* condition)
+{
+    if (!condition->handle)
+        return;
+
+    pthread_cond_destroy((pthread_cond_t*)condition->handle);
+    free(condition->handle);
+    condition->handle = NULL;
+}
+
+void condition_wait(rouleaux_condition* condition, rouleaux_mutex* mutex)
+{
+    pthread_cond_wait((pthread_cond_t*)condition->handle, (pthread_mutex_t*)mutex->handle);
+}
+
+void condition_wake_one(rouleaux_condition* condition)
+{
+    pthread_cond_signal((pthread_cond_t*)condition->handle);
+}
+
+void condition_wake_all(rouleaux_condition* condition)
+{
+    pthread_cond_broadcast((pthread_cond_t*)condition->handle);
+}
+
+#endif
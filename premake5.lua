@@ -1,26 +1,45 @@
--- Solution Level premake
-
-workspace "rouleauxc"
-    architecture "x86_64"
-    configurations
-    {
-        -- Build configurations for building librouleaux as a static library
-        "Debug-StaticLib",
-        "Release-StaticLib",
-        "Distribution-StaticLib",
-
-        -- Build configurations for building librouleaux as a shared library
-        "Debug-SharedLib",
-        "Release-SharedLib",
-        "Distribution-SharedLib"
-    }
-    toolset "clang"
-
-output_folder_name = "%{cfg.buildcfg}-%{cfg.system}-%{cfg.architecture}"
-
-startproject "roulx"
-
-group ""
-    include "librouleaux" -- the base language library project
-    include "roulx" -- the interpeter project
-    --include "roulxc" -- the compiler project
+-- Solution Level premake
+
+-- Build options of the bytecode vm
+newoption
+{
+    trigger = "vm-switch-dispatch",
+    description = "Dispatch the bytecode vm through a switch, instead of the threaded dispatch used with GCC and Clang"
+}
+
+newoption
+{
+    trigger = "vm-statistics",
+    description = "Count every opcode the bytecode vm runs, for roulx --benchmark (this slows the vm down)"
+}
+
+newoption
+{
+    trigger = "vm-no-jit",
+    description = "Build the bytecode vm without its x86-64 jit, so it interprets everything"
+}
+
+workspace "rouleauxc"
+    architecture "x86_64"
+    configurations
+    {
+        -- Build configurations for building librouleaux as a static library
+        "Debug-StaticLib",
+        "Release-StaticLib",
+        "Distribution-StaticLib",
+
+        -- Build configurations for building librouleaux as a shared library
+        "Debug-SharedLib",
+        "Release-SharedLib",
+        "Distribution-SharedLib"
+    }
+    toolset "clang"
+
+output_folder_name = "%{cfg.buildcfg}-%{cfg.system}-%{cfg.architecture}"
+
+startproject "roulx"
+
+group ""
+    include "librouleaux" -- the base language library project
+    include "roulx" -- the interpeter project
+    include "roulxc" -- the compiler project
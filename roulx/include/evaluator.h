@@ -0,0 +1,72 @@
+#pragma once
+
+#include <rouleaux/rouleaux.h>
+
+/**
+ * @brief A value at run time. Which member holds it is never stored with the value, it is always known from the
+ *        typing_information of the node that produced it
+ */
+typedef union roulx_value {
+    /* The raw bits of the value, as they are kept in the value of a symbol's token */
+    u64 bits;
+    /* The value of a TYPE_INFO_INTEGER */
+    i64 integer;
+    /* The value of a TYPE_INFO_FLOAT */
+    f64 float64;
+    /* The value of a TYPE_INFO_STRING, a null terminated string interned by the context */
+    const char* string;
+    /* The value of a TYPE_INFO_FUNCTION, its AST_FUNCTION_DECLARATION node */
+    ast_node* function;
+} roulx_value;
+
+/**
+ * @brief Runs a typed AST by walking it one node at a time
+ */
+typedef struct roulx_evaluator {
+    /* The context runtime errors are reported to, and string literals are interned in */
+    rouleaux_context* context;
+
+    /* The top level variables, the value of each is kept in the value of its symbol's token */
+    symbol_table globals;
+    /* The variables of the function being run, this is globals outside of any function */
+    symbol_table* frame;
+
+    /* Set once a runtime error was reported, nothing else is run after it */
+    b8 has_error;
+} roulx_evaluator;
+
+/**
+ * @brief Creates an evaluator without any variables
+ *
+ * @param context the context runtime errors are reported to, it must outlive the evaluator
+ * @return roulx_evaluator the created evaluator
+ */
+roulx_evaluator evaluator_create(rouleaux_context* context);
+
+/**
+ * @brief releases the variables of an evaluator
+ *
+ * @param evaluator the evaluator to destroy
+ */
+void evaluator_destroy(roulx_evaluator* evaluator);
+
+/**
+ * @brief runs every top level statement of a file, in order
+ * @note the file must have been typed by resolve_types() (or any of its variants) without errors
+ *
+ * @param evaluator the evaluator to run the file with
+ * @param file the AST_SCOPE of the file
+ * @return b8 true if the file ran to the end, false if a runtime error was reported to the context
+ */
+b8 evaluator_run(roulx_evaluator* evaluator, ast_node* file);
+
+/**
+ * @brief runs the top level declarations typed by resolve_types_reachable(), then calls the entry point
+ * @note the statements resolve_types_reachable() did not reach are skipped, they were never typed
+ *
+ * @param evaluator the evaluator to run the file with
+ * @param file the AST_SCOPE of the file
+ * @param entry_point the name of the function to call, it cannot take any parameters
+ * @return b8 true if the entry point returned, false if a runtime error was reported to the context
+ */
+b8 evaluator_run_entry_point(roulx_evaluator* evaluator, ast_node* file, const char* entry_point);
@@ -0,0 +1,509 @@
+#include "evaluator.h"
+
+#include <math.h>
+#include <stdarg.h>
+#include <string.h>
+
+// Runs a statement
+static void evaluate_statement(roulx_evaluator* evaluator, ast_node* statement);
+
+// Runs a value or const assignment, declaring the variable if the assignment is a declaration
+static void evaluate_assignment(roulx_evaluator* evaluator, ast_node* assignment);
+
+// Gives the value of an expression
+static roulx_value evaluate_expression(roulx_evaluator* evaluator, ast_node* expression);
+
+// Gives the value of a binary operator, the operation is picked from the operands' static type
+static roulx_value evaluate_binary_operator(roulx_evaluator* evaluator, ast_node* binary_operator);
+
+// Applies a binary operator to two integers
+static roulx_value integer_operator(roulx_evaluator* evaluator, ast_node* binary_operator, i64 left, i64 right);
+
+// Applies a binary operator to two floats
+static roulx_value float_operator(ast_node* binary_operator, f64 left, f64 right);
+
+// Runs the body of a function in a new frame, the arguments are evaluated in the caller's frame (NULL for no arguments)
+static roulx_value call_function(roulx_evaluator* evaluator, ast_node* function_declaration, node_list* arguments);
+
+// True if the value of the condition of an if or while statement lets it run its statement
+static b8 is_true(type_info type, roulx_value value);
+
+// Finds a variable in the current frame, then in the globals
+static symbol* find_variable(roulx_evaluator* evaluator, token name);
+
+// Sets a variable of the given table, adding it the first time its declaration is run
+static b8 declare_variable(roulx_evaluator* evaluator, symbol_table* table, token name, b8 is_constant, roulx_value value);
+
+// Reports a runtime error to the context, only the first one is reported
+static void runtime_error(roulx_evaluator* evaluator, token t, diagnostic_id id, ...);
+
+
+roulx_evaluator evaluator_create(rouleaux_context* context)
+{
+    roulx_evaluator evaluator = {};
+    evaluator.context = context;
+
+    // The type names are only needed while typing, so the globals start out empty
+    evaluator.globals = symbol_table_create_scope(NULL, 0);
+
+    return evaluator;
+}
+
+void evaluator_destroy(roulx_evaluator* evaluator)
+{
+    symbol_table_destroy(&evaluator->globals);
+    evaluator->frame = NULL;
+}
+
+b8 evaluator_run(roulx_evaluator* evaluator, ast_node* file)
+{
+    evaluator->frame = &evaluator->globals;
+    evaluate_statement(evaluator, file);
+
+    return !evaluator->has_error;
+}
+
+b8 evaluator_run_entry_point(roulx_evaluator* evaluator, ast_node* file, const char* entry_point)
+{
+    evaluator->frame = &evaluator->globals;
+
+    // Only the declarations the entry point needs were typed, those are the ones given a type
+    for (u64 i = 0; i < file->node.many.children.number_of_nodes && !evaluator->has_error; ++i)
+    {
+        ast_node* statement = file->node.many.children.nodes[i];
+        if (statement->type != AST_VALUE_ASSIGNMENT && statement->type != AST_CONST_ASSIGNMENT)
+            continue;
+
+        if (statement->node.binary.t.typing_information != TYPE_INFO_UNKNOWN)
+            evaluate_statement(evaluator, statement);
+    }
+
+    if (evaluator->has_error)
+        return false;
+
+    token name = {};
+    name.text = entry_point;
+    name.length = strlen(entry_point);
+
+    symbol* entry_symbol = symbol_table_find(&evaluator->globals, name);
+    if (entry_symbol == NULL)
+    {
+        // The file's scope has no token of its own, so the error points at the start of the file instead
+        runtime_error(evaluator, ast_file_start_token(file), DIAGNOSTIC_UNKNOWN_ENTRY_POINT, diagnostic_string(name.text, name.length));
+        return false;
+    }
+
+    if (entry_symbol->type != TYPE_INFO_FUNCTION)
+    {
+        runtime_error(evaluator, entry_symbol->t, DIAGNOSTIC_CALL_OF_NON_FUNCTION);
+        return false;
+    }
+
+    roulx_value function = { .bits = entry_symbol->t.value.unsigned64 };
+    if (function.function->node.ternary.left_child->node.many.children.number_of_nodes != 0)
+    {
+        runtime_error(evaluator, entry_symbol->t, DIAGNOSTIC_ENTRY_POINT_PARAMETERS, diagnostic_token_text(entry_symbol->t));
+        return false;
+    }
+
+    call_function(evaluator, function.function, NULL);
+
+    return !evaluator->has_error;
+}
+
+
+
+void evaluate_statement(roulx_evaluator* evaluator, ast_node* statement)
+{
+    switch (statement->type)
+    {
+        case AST_SCOPE:
+        {
+            for (u64 i = 0; i < statement->node.many.children.number_of_nodes && !evaluator->has_error; ++i)
+                evaluate_statement(evaluator, statement->node.many.children.nodes[i]);
+
+            break;
+        }
+        case AST_VALUE_ASSIGNMENT:
+        case AST_CONST_ASSIGNMENT:
+        {
+            evaluate_assignment(evaluator, statement);
+            break;
+        }
+        case AST_CALL_OPERATOR:
+        {
+            evaluate_expression(evaluator, statement->node.unary.child);
+            break;
+        }
+        case AST_IF_STATEMENT:
+        {
+            ast_node* condition = statement->node.ternary.left_child;
+            roulx_value condition_value = evaluate_expression(evaluator, condition);
+            if (evaluator->has_error)
+                break;
+
+            if (is_true(condition->node.leaf.t.typing_information, condition_value))
+                evaluate_statement(evaluator, statement->node.ternary.center_child);
+            else if (statement->node.ternary.right_child != NULL)
+                evaluate_statement(evaluator, statement->node.ternary.right_child);
+
+            break;
+        }
+        case AST_WHILE_STATEMENT:
+        {
+            ast_node* condition = statement->node.binary.left_child;
+            while (!evaluator->has_error)
+            {
+                roulx_value condition_value = evaluate_expression(evaluator, condition);
+                if (evaluator->has_error || !is_true(condition->node.leaf.t.typing_information, condition_value))
+                    break;
+
+                evaluate_statement(evaluator, statement->node.binary.right_child);
+            }
+
+            break;
+        }
+        default:
+        {
+            // Comments, the end of the file and the like have nothing to run
+            break;
+        }
+    };
+}
+
+void evaluate_assignment(roulx_evaluator* evaluator, ast_node* assignment)
+{
+    roulx_value value = evaluate_expression(evaluator, assignment->node.binary.right_child);
+    if (evaluator->has_error)
+        return;
+
+    ast_node* target = assignment->node.binary.left_child;
+    if (target->type == AST_IDENTIFIER)
+    {
+        // Assigning to a variable that was already declared
+        symbol* sym = find_variable(evaluator, target->node.leaf.t);
+        if (sym == NULL)
+        {
+            runtime_error(evaluator, target->node.leaf.t, DIAGNOSTIC_UNDECLARED_VARIABLE, diagnostic_token_text(target->node.leaf.t));
+            return;
+        }
+
+        sym->t.value.unsigned64 = value.bits;
+        return;
+    }
+
+    // Otherwise the target is the type assignment of a declaration, its left child is the name being declared
+    token name = target->node.binary.left_child->node.leaf.t;
+    declare_variable(evaluator, evaluator->frame, name, assignment->type == AST_CONST_ASSIGNMENT, value);
+}
+
+roulx_value evaluate_expression(roulx_evaluator* evaluator, ast_node* expression)
+{
+    roulx_value value = {};
+    switch (expression->type)
+    {
+        case AST_INTEGER_LITERAL:
+        {
+            value.bits = expression->node.leaf.t.value.unsigned64;
+            return value;
+        }
+        case AST_FLOAT_LITERAL:
+        {
+            value.float64 = expression->node.leaf.t.value.float64;
+            return value;
+        }
+        case AST_STRING_LITERAL:
+        {
+            // The token's text still has its quotes
+            token t = expression->node.leaf.t;
+            value.string = context_intern(evaluator->context, t.text + 1, t.length - 2);
+            if (value.string == NULL)
+                runtime_error(evaluator, t, DIAGNOSTIC_SYMBOL_TABLE_ALLOCATION);
+
+            return value;
+        }
+        case AST_IDENTIFIER:
+        {
+            symbol* sym = find_variable(evaluator, expression->node.leaf.t);
+            if (sym == NULL)
+            {
+                runtime_error(evaluator, expression->node.leaf.t, DIAGNOSTIC_UNDECLARED_SYMBOL, diagnostic_token_text(expression->node.leaf.t));
+                return value;
+            }
+
+            value.bits = sym->t.value.unsigned64;
+            return value;
+        }
+        case AST_BINARY_OPERATOR_PLUS:
+        case AST_BINARY_OPERATOR_MINUS:
+        case AST_BINARY_OPERATOR_MULTIPLY:
+        case AST_BINARY_OPERATOR_DIVIDE:
+        case AST_BINARY_OPERATOR_MODULUS:
+        case AST_BINARY_OPERATOR_GREATER_THAN:
+        case AST_BINARY_OPERATOR_LESS_THAN:
+        {
+            return evaluate_binary_operator(evaluator, expression);
+        }
+        case AST_FUNCTION_DECLARATION:
+        {
+            value.function = expression;
+            return value;
+        }
+        case AST_FUNCTION_CALL:
+        {
+            roulx_value function = evaluate_expression(evaluator, expression->node.binary.left_child);
+            if (evaluator->has_error)
+                return value;
+
+            return call_function(evaluator, function.function, &expression->node.binary.right_child->node.many.children);
+        }
+        default:
+        {
+            // Nothing else is an expression
+            return value;
+        }
+    };
+}
+
+roulx_value evaluate_binary_operator(roulx_evaluator* evaluator, ast_node* binary_operator)
+{
+    roulx_value left = evaluate_expression(evaluator, binary_operator->node.binary.left_child);
+    if (evaluator->has_error)
+        return left;
+
+    roulx_value right = evaluate_expression(evaluator, binary_operator->node.binary.right_child);
+    if (evaluator->has_error)
+        return right;
+
+    // Both operands have the operator's type, the typing made sure of that
+    token operator_token = binary_operator->node.binary.t;
+    switch (operator_token.typing_information)
+    {
+        case TYPE_INFO_INTEGER:
+        {
+            return integer_operator(evaluator, binary_operator, left.integer, right.integer);
+        }
+        case TYPE_INFO_FLOAT:
+        {
+            return float_operator(binary_operator, left.float64, right.float64);
+        }
+        case TYPE_INFO_STRING:
+        {
+            runtime_error(evaluator, operator_token, DIAGNOSTIC_UNSUPPORTED_OPERATOR, diagnostic_token_text(operator_token), diagnostic_string("strings", 7));
+            return (roulx_value){};
+        }
+        default:
+        {
+            runtime_error(evaluator, operator_token, DIAGNOSTIC_UNSUPPORTED_OPERATOR, diagnostic_token_text(operator_token), diagnostic_string("functions", 9));
+            return (roulx_value){};
+        }
+    };
+}
+
+roulx_value integer_operator(roulx_evaluator* evaluator, ast_node* binary_operator, i64 left, i64 right)
+{
+    // The arithmetic is done on unsigned integers so an overflow wraps around instead of being undefined
+    roulx_value value = {};
+    switch (binary_operator->type)
+    {
+        case AST_BINARY_OPERATOR_PLUS:
+        {
+            value.bits = (u64)left + (u64)right;
+            break;
+        }
+        case AST_BINARY_OPERATOR_MINUS:
+        {
+            value.bits = (u64)left - (u64)right;
+            break;
+        }
+        case AST_BINARY_OPERATOR_MULTIPLY:
+        {
+            value.bits = (u64)left * (u64)right;
+            break;
+        }
+        case AST_BINARY_OPERATOR_DIVIDE:
+        case AST_BINARY_OPERATOR_MODULUS:
+        {
+            if (right == 0)
+            {
+                runtime_error(evaluator, binary_operator->node.binary.t, DIAGNOSTIC_DIVISION_BY_ZERO);
+                break;
+            }
+
+            // Dividing the smallest integer by -1 does not fit, it wraps around like the other operators do
+            if (right == -1)
+                value.bits = (binary_operator->type == AST_BINARY_OPERATOR_DIVIDE) ? 0 - (u64)left : 0;
+            else
+                value.integer = (binary_operator->type == AST_BINARY_OPERATOR_DIVIDE) ? left / right : left % right;
+
+            break;
+        }
+        case AST_BINARY_OPERATOR_GREATER_THAN:
+        {
+            value.integer = left > right;
+            break;
+        }
+        case AST_BINARY_OPERATOR_LESS_THAN:
+        {
+            value.integer = left < right;
+            break;
+        }
+        default:
+        {
+            break;
+        }
+    };
+
+    return value;
+}
+
+roulx_value float_operator(ast_node* binary_operator, f64 left, f64 right)
+{
+    roulx_value value = {};
+    switch (binary_operator->type)
+    {
+        case AST_BINARY_OPERATOR_PLUS:
+        {
+            value.float64 = left + right;
+            break;
+        }
+        case AST_BINARY_OPERATOR_MINUS:
+        {
+            value.float64 = left - right;
+            break;
+        }
+        case AST_BINARY_OPERATOR_MULTIPLY:
+        {
+            value.float64 = left * right;
+            break;
+        }
+        case AST_BINARY_OPERATOR_DIVIDE:
+        {
+            value.float64 = left / right;
+            break;
+        }
+        case AST_BINARY_OPERATOR_MODULUS:
+        {
+            value.float64 = fmod(left, right);
+            break;
+        }
+        case AST_BINARY_OPERATOR_GREATER_THAN:
+        {
+            // A comparison has the type of its operands, so it gives 1.0 or 0.0
+            value.float64 = (left > right) ? 1.0 : 0.0;
+            break;
+        }
+        case AST_BINARY_OPERATOR_LESS_THAN:
+        {
+            value.float64 = (left < right) ? 1.0 : 0.0;
+            break;
+        }
+        default:
+        {
+            break;
+        }
+    };
+
+    return value;
+}
+
+roulx_value call_function(roulx_evaluator* evaluator, ast_node* function_declaration, node_list* arguments)
+{
+    roulx_value result = {};
+
+    // A function only sees its own variables and the globals, never the variables of its caller
+    symbol_table frame = symbol_table_create_scope(NULL, 0);
+
+    ast_node* parameters = function_declaration->node.ternary.left_child;
+    u64 argument_count = arguments ? arguments->number_of_nodes : 0;
+    for (u64 i = 0; i < argument_count && !evaluator->has_error; ++i)
+    {
+        roulx_value argument = evaluate_expression(evaluator, arguments->nodes[i]);
+        if (evaluator->has_error)
+            break;
+
+        // Every parameter is a type assignment ('name: type')
+        token name = parameters->node.many.children.nodes[i]->node.binary.left_child->node.leaf.t;
+        declare_variable(evaluator, &frame, name, false, argument);
+    }
+
+    if (!evaluator->has_error)
+    {
+        symbol_table* caller_frame = evaluator->frame;
+        evaluator->frame = &frame;
+        evaluate_statement(evaluator, function_declaration->node.ternary.right_child);
+        evaluator->frame = caller_frame;
+    }
+
+    symbol_table_destroy(&frame);
+
+    // The language has no return statement yet, so a call gives the zero value of its return type
+    return result;
+}
+
+b8 is_true(type_info type, roulx_value value)
+{
+    switch (type)
+    {
+        case TYPE_INFO_INTEGER:
+        {
+            return value.integer != 0;
+        }
+        case TYPE_INFO_FLOAT:
+        {
+            return value.float64 != 0.0;
+        }
+        case TYPE_INFO_STRING:
+        {
+            return value.string != NULL && value.string[0] != '\0';
+        }
+        default:
+        {
+            return value.function != NULL;
+        }
+    };
+}
+
+symbol* find_variable(roulx_evaluator* evaluator, token name)
+{
+    symbol* sym = symbol_table_find(evaluator->frame, name);
+    if (sym == NULL && evaluator->frame != &evaluator->globals)
+        sym = symbol_table_find(&evaluator->globals, name);
+
+    return sym;
+}
+
+b8 declare_variable(roulx_evaluator* evaluator, symbol_table* table, token name, b8 is_constant, roulx_value value)
+{
+    // Running the same declaration again (i.e. in the body of a loop) just sets the variable again
+    symbol* sym = symbol_table_find(table, name);
+    if (sym == NULL)
+    {
+        if (!symbol_table_add(table, name, name.typing_information, is_constant))
+        {
+            runtime_error(evaluator, name, DIAGNOSTIC_SYMBOL_TABLE_ALLOCATION);
+            return false;
+        }
+
+        sym = &table->buffer[table->size - 1];
+        if (name.typing_information == TYPE_INFO_FUNCTION)
+            sym->function_decl_node = value.function;
+    }
+
+    sym->t.value.unsigned64 = value.bits;
+    return true;
+}
+
+void runtime_error(roulx_evaluator* evaluator, token t, diagnostic_id id, ...)
+{
+    if (evaluator->has_error)
+        return;
+
+    va_list params;
+    va_start(params, id);
+    error_report report = error_report_create(t, id, params);
+    va_end(params);
+
+    context_report_error(evaluator->context, report);
+    evaluator->has_error = true;
+}
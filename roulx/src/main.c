@@ -1,68 +1,341 @@
-#include <rouleaux/rouleaux.h>
-#include <stdio.h>
-#include <malloc.h>
-
-int print_usage(const char* program_name);
-
-int main(int argc, char** argv)
-{
-    if (argc < 2)
-        return print_usage(argv[0]);
-
-    int return_code = 0;
-
-    rouleaux_parser parser = parser_create(argv[1], default_node_allocator, default_node_deallocator);
-    parse_result ast = parser_parse_file(&parser);
-    if (!ast.success)
-    {
-        char* error_text = error_report_printable_text(ast.error, calloc);
-        printf("%s", error_text);
-        free(error_text);
-
-        return_code = 1;
-        goto cleanup_parser;
-    }
-
-    // Make the type table
-    symbol_table sym_table = symbol_table_create();
-    typing_result result = resolve_types(ast.resulting_tree, &sym_table);
-    if (!result.success)
-    {
-        char* error_text = error_report_printable_text(result.error, calloc);
-        printf("%s", error_text);
-        free(error_text);
-
-        return_code = 1;
-        goto cleanup_symbol_table;
-    }
-
-    printf("Symbol Table:\n");
-    for (u64 i = 0; i < sym_table.size; ++i)
-    {
-        printf("\t%.*s = ", (int)sym_table.buffer[i].t.length, sym_table.buffer[i].t.text);
-        if (sym_table.buffer[i].type == TYPE_INFO_INTEGER)
-        {
-            printf("%lld\n", sym_table.buffer[i].t.value.unsigned64);
-        }
-        else
-        {
-            printf("%lf\n", sym_table.buffer[i].t.value.float64);
-        }
-    }
-
-    printf("Success!\n");
-
-cleanup_symbol_table:
-    parser_destroy_ast_node(&parser, ast.resulting_tree);
-    symbol_table_destroy(&sym_table);
-cleanup_parser:
-    parser_destroy(&parser);
-
-    return return_code;
-}
-
-int print_usage(const char* program_name)
-{
-    printf("%s rouleaux_file", program_name);
-    return 1;
-}
+#include <rouleaux/rouleaux.h>
+#include "evaluator.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <malloc.h>
+
+/**
+ * @brief How long the runs of a benchmark took
+ */
+typedef struct benchmark_times {
+    /* The amount of runs */
+    u64 runs;
+    /* The time of the fastest run, in seconds */
+    f64 best;
+    /* The time of every run added up, in seconds */
+    f64 total;
+} benchmark_times;
+
+// The amount of the most frequent opcode pairs a benchmark prints
+#define BENCHMARK_PRINTED_PAIRS 12
+
+/**
+ * @brief How many times an opcode ran right after another, for sorting the pairs a vm counted
+ */
+typedef struct opcode_pair {
+    /* The opcode run first */
+    bytecode_opcode first;
+    /* The opcode run right after it */
+    bytecode_opcode second;
+    /* The amount of times the pair ran */
+    u64 count;
+} opcode_pair;
+
+int print_usage(const char* program_name);
+
+// Prints every diagnostic reported to the context
+void print_diagnostics(rouleaux_context* context);
+
+// Prints the name and value of a global once the file ran
+void print_global(token name, type_info type, u64 bits);
+
+// Runs a typed file by walking its AST, then prints its globals. A benchmark runs it benchmark_runs times and times every run
+b8 run_with_evaluator(rouleaux_context* context, ast_node* ast, const char* entry_point, u64 benchmark_runs);
+
+// Compiles a typed file to bytecode through its SSA form, the SSA passes run unless optimize_ssa is false and the peephole pass
+// unless optimize is false, and runs it on the vm, with its jit unless use_jit is false, then prints its globals. A benchmark
+// runs it benchmark_runs times and times every run
+b8 run_with_vm(rouleaux_context* context, ast_node* ast, const char* entry_point, b8 optimize_ssa, b8 optimize, b8 use_jit, u64 benchmark_runs);
+
+// Gives the current time in seconds, for timing the runs of a benchmark
+f64 benchmark_clock(void);
+
+// Adds the time of a run to the times of a benchmark
+void record_benchmark_run(benchmark_times* times, f64 time);
+
+// Prints how long the runs of a benchmark took, and what the vm counted while running them if it counted anything
+void print_benchmark(benchmark_times times, const vm_statistics* statistics);
+
+// Orders opcode pairs from the most to the least frequent, for qsort()
+int compare_opcode_pairs(const void* left, const void* right);
+
+int main(int argc, char** argv)
+{
+    // The options come before the file
+    b8 use_evaluator = false;
+    b8 optimize_ssa = true;
+    b8 optimize_bytecode = true;
+    b8 use_jit = true;
+    u64 benchmark_runs = 0;
+    int first_argument = 1;
+    while (first_argument < argc && strncmp(argv[first_argument], "--", 2) == 0)
+    {
+        // The AST can still be walked instead of compiled, to compare against the vm
+        if (strcmp(argv[first_argument], "--evaluator") == 0)
+            use_evaluator = true;
+        else if (strcmp(argv[first_argument], "--no-ssa-passes") == 0)
+            optimize_ssa = false;
+        else if (strcmp(argv[first_argument], "--no-peephole") == 0)
+            optimize_bytecode = false;
+        else if (strcmp(argv[first_argument], "--no-jit") == 0)
+            use_jit = false;
+        else if (strcmp(argv[first_argument], "--benchmark") == 0 && first_argument + 1 < argc)
+            benchmark_runs = strtoull(argv[++first_argument], NULL, 10);
+        else
+            return print_usage(argv[0]);
+
+        first_argument++;
+    }
+
+    if (argc <= first_argument)
+        return print_usage(argv[0]);
+
+    const char* filename = argv[first_argument];
+    const char* entry_point = (argc > first_argument + 1) ? argv[first_argument + 1] : NULL;
+    int return_code = 0;
+
+    // Every parallel phase runs on the same scheduler, the default options use every logical processor
+    rouleaux_jobs* jobs = jobs_create((jobs_options){});
+
+    rouleaux_context context;
+    context_create(&context, (rouleaux_context_options){
+        .comment_mode = COMMENT_MODE_DISCARD, // The interpreter has no use for comments
+        .jobs = jobs,
+    });
+
+    symbol_table sym_table = symbol_table_create();
+
+    rouleaux_parser parser = context_create_parser(&context, filename);
+    ast_node* ast = parser.has_error ? NULL : context_parse_file(&context, &parser);
+
+    // With an entry point only the declarations it can reach are type checked
+    b8 typed = false;
+    if (ast)
+        typed = entry_point ? context_resolve_reachable_types(&context, ast, &sym_table, entry_point) : context_resolve_types(&context, ast, &sym_table);
+
+    if (!typed)
+    {
+        print_diagnostics(&context);
+
+        return_code = 1;
+        goto cleanup;
+    }
+
+    // With an entry point only the reached declarations are run before it is called
+    b8 ran = use_evaluator ? run_with_evaluator(&context, ast, entry_point, benchmark_runs) : run_with_vm(&context, ast, entry_point, optimize_ssa, optimize_bytecode, use_jit, benchmark_runs);
+    if (!ran)
+    {
+        print_diagnostics(&context);
+
+        return_code = 1;
+        goto cleanup;
+    }
+
+    printf("Success!\n");
+
+cleanup:
+    parser_destroy_ast_node(&parser, ast);
+    symbol_table_destroy(&sym_table);
+    parser_destroy(&parser);
+    context_destroy(&context);
+    jobs_destroy(jobs);
+
+    return return_code;
+}
+
+int print_usage(const char* program_name)
+{
+    printf("%s [--evaluator] [--no-ssa-passes] [--no-peephole] [--no-jit] [--benchmark runs] rouleaux_file [entry_point]", program_name);
+    return 1;
+}
+
+void print_diagnostics(rouleaux_context* context)
+{
+    char* error_text = context_diagnostics_text(context, calloc);
+    if (error_text)
+        printf("%s", error_text);
+    free(error_text);
+}
+
+void print_global(token name, type_info type, u64 bits)
+{
+    printf("\t%.*s = ", (int)name.length, name.text);
+
+    bytecode_value value = { .bits = bits };
+    switch (type)
+    {
+        case TYPE_INFO_INTEGER:
+        {
+            printf("%lld\n", value.integer);
+            break;
+        }
+        case TYPE_INFO_FLOAT:
+        {
+            printf("%lf\n", value.float64);
+            break;
+        }
+        case TYPE_INFO_STRING:
+        {
+            printf("\"%s\"\n", value.string);
+            break;
+        }
+        default:
+        {
+            printf("<function>\n");
+            break;
+        }
+    };
+}
+
+b8 run_with_evaluator(rouleaux_context* context, ast_node* ast, const char* entry_point, u64 benchmark_runs)
+{
+    roulx_evaluator evaluator = {};
+    benchmark_times times = {};
+    b8 ran = true;
+
+    // Every run starts from a new evaluator, only the globals of the last one are printed
+    u64 run_count = benchmark_runs ? benchmark_runs : 1;
+    for (u64 i = 0; i < run_count && ran; ++i)
+    {
+        evaluator_destroy(&evaluator);
+        evaluator = evaluator_create(context);
+
+        f64 start = benchmark_clock();
+        ran = entry_point ? evaluator_run_entry_point(&evaluator, ast, entry_point) : evaluator_run(&evaluator, ast);
+        record_benchmark_run(&times, benchmark_clock() - start);
+    }
+
+    if (ran)
+    {
+        printf("Symbol Table:\n");
+        for (u64 i = 0; i < evaluator.globals.size; ++i)
+        {
+            symbol* sym = &evaluator.globals.buffer[i];
+            print_global(sym->t, sym->type, sym->t.value.unsigned64);
+        }
+
+        if (benchmark_runs)
+            print_benchmark(times, NULL);
+    }
+
+    evaluator_destroy(&evaluator);
+    return ran;
+}
+
+b8 run_with_vm(rouleaux_context* context, ast_node* ast, const char* entry_point, b8 optimize_ssa, b8 optimize, b8 use_jit, u64 benchmark_runs)
+{
+    ssa_program ssa = {};
+    bytecode_program program = {};
+    b8 ran = ssa_build(context, ast, entry_point, &ssa);
+
+    // The SSA passes leave a program they had no memory for correct, so it is still compiled
+    if (ran && optimize_ssa)
+        ssa_optimize(&ssa);
+
+    if (ran)
+        ran = bytecode_compile(context, &ssa, &program);
+
+    ssa_program_destroy(&ssa);
+
+    // A program the peephole pass had no memory for runs the same, only slower
+    if (ran && optimize)
+        bytecode_optimize(&program);
+
+    // The opcodes counted with ROULX_VM_STATISTICS leave out the ones run as native code, --no-jit counts all of them
+    rouleaux_vm vm = vm_create(context);
+    vm.use_jit = use_jit;
+    benchmark_times times = {};
+
+    // vm_run() starts the program over every time, so a benchmark runs the same vm again and again
+    u64 run_count = benchmark_runs ? benchmark_runs : 1;
+    for (u64 i = 0; i < run_count && ran; ++i)
+    {
+        f64 start = benchmark_clock();
+        ran = vm_run(&vm, &program);
+        record_benchmark_run(&times, benchmark_clock() - start);
+    }
+
+    if (ran)
+    {
+        // The globals are left in the first registers of the vm
+        printf("Symbol Table:\n");
+        for (u64 i = 0; i < program.global_count; ++i)
+            print_global(program.globals[i].name, program.globals[i].type, vm.registers[i].bits);
+
+        if (benchmark_runs)
+            print_benchmark(times, vm.statistics);
+    }
+
+    vm_destroy(&vm);
+    bytecode_program_destroy(&program);
+    return ran;
+}
+
+f64 benchmark_clock(void)
+{
+    struct timespec now = {};
+    timespec_get(&now, TIME_UTC);
+
+    return (f64)now.tv_sec + (f64)now.tv_nsec * 1e-9;
+}
+
+void record_benchmark_run(benchmark_times* times, f64 time)
+{
+    if (times->runs == 0 || time < times->best)
+        times->best = time;
+
+    times->total += time;
+    times->runs++;
+}
+
+void print_benchmark(benchmark_times times, const vm_statistics* statistics)
+{
+    printf("Benchmark:\n");
+    printf("\t%llu runs, best %.3lf ms, mean %.3lf ms\n", times.runs, times.best * 1e3, times.total * 1e3 / times.runs);
+
+    // Only a vm built with ROULX_VM_STATISTICS counts, counting slows it down so its times are not the ones to compare
+    if (statistics == NULL)
+        return;
+
+    u64 instructions = 0;
+    for (u64 i = 0; i < OPCODE_MAX_OPCODES; ++i)
+        instructions += statistics->opcode_counts[i];
+
+    instructions /= times.runs;
+    printf("\t%llu instructions per run, %.3lf ns per instruction\n", instructions, instructions ? times.best * 1e9 / instructions : 0.0);
+
+    for (u64 i = 0; i < OPCODE_MAX_OPCODES; ++i)
+    {
+        if (statistics->opcode_counts[i] != 0)
+            printf("\t\t%-28s %llu\n", bytecode_opcode_name((bytecode_opcode)i), statistics->opcode_counts[i] / times.runs);
+    }
+
+    opcode_pair pairs[OPCODE_MAX_OPCODES * OPCODE_MAX_OPCODES];
+    u64 pair_count = 0;
+    for (u64 first = 0; first < OPCODE_MAX_OPCODES; ++first)
+    {
+        for (u64 second = 0; second < OPCODE_MAX_OPCODES; ++second)
+        {
+            // Everything follows OPCODE_INVALID once, when a run starts
+            if (first != OPCODE_INVALID && statistics->opcode_pair_counts[first][second] != 0)
+                pairs[pair_count++] = (opcode_pair){ (bytecode_opcode)first, (bytecode_opcode)second, statistics->opcode_pair_counts[first][second] };
+        }
+    }
+
+    qsort(pairs, pair_count, sizeof(opcode_pair), compare_opcode_pairs);
+
+    printf("\tMost frequent pairs per run:\n");
+    for (u64 i = 0; i < pair_count && i < BENCHMARK_PRINTED_PAIRS; ++i)
+        printf("\t\t%-28s %-28s %llu\n", bytecode_opcode_name(pairs[i].first), bytecode_opcode_name(pairs[i].second), pairs[i].count / times.runs);
+}
+
+int compare_opcode_pairs(const void* left, const void* right)
+{
+    u64 left_count = ((const opcode_pair*)left)->count;
+    u64 right_count = ((const opcode_pair*)right)->count;
+
+    return (left_count < right_count) - (left_count > right_count);
+}
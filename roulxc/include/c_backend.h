@@ -0,0 +1,39 @@
+#pragma once
+
+#include <rouleaux/rouleaux.h>
+
+/**
+ * @brief C source text, grown as it is written
+ */
+typedef struct c_source {
+    /* The text, null terminated once anything was written */
+    char* text;
+    /* The length of the text in bytes, not counting the null terminator */
+    u64 length;
+    /* The amount of bytes text can hold */
+    u64 capacity;
+
+    /* Set when the text could not grow, it is cut short */
+    b8 has_error;
+} c_source;
+
+/**
+ * @brief lowers the SSA form of a file into a single C translation unit, which compiles into a program running the file the
+ *        way roulx does: it runs the top level code (or the entry point) and prints the globals, or prints the runtime error
+ *        that stopped it and exits with 1
+ * @note each value is a variable of its C function and each block a label, so the C compiler sees the same control flow
+ *       the vm runs. The C only needs a C99 compiler and libm
+ *
+ * @param context the context errors are reported to, runtime errors are rendered from the sources it holds
+ * @param program a program made by ssa_build(), optimized by ssa_optimize() or not
+ * @param out_source where the C is written, it is released with c_source_destroy() even if lowering fails
+ * @return b8 true if the file was lowered, false if an error was reported to the context (or the C ran out of memory)
+ */
+b8 c_backend_generate(rouleaux_context* context, const ssa_program* program, c_source* out_source);
+
+/**
+ * @brief frees the text of C source and zeros the struct
+ *
+ * @param source the source to destroy
+ */
+void c_source_destroy(c_source* source);
@@ -0,0 +1,157 @@
+#pragma once
+
+#include <rouleaux/rouleaux.h>
+
+// The relocations of x86-64 the native backend uses
+#define ELF_R_X86_64_64 1       // the absolute 64 bit address of the symbol plus the addend
+#define ELF_R_X86_64_PC32 2     // the 32 bit distance from the relocated bytes to the symbol plus the addend
+#define ELF_R_X86_64_PLT32 4    // like ELF_R_X86_64_PC32, to a function which may be in a shared library
+
+/**
+ * @brief The sections of an object the native backend writes into, a symbol or a relocation names one of them
+ */
+typedef enum elf_section {
+    ELF_SECTION_TEXT = 0,
+    ELF_SECTION_RODATA,
+    ELF_SECTION_DATA,
+    ELF_SECTION_BSS,
+
+    MAX_ELF_SECTIONS,
+
+    // The section of a symbol defined in another object or library
+    ELF_SECTION_UNDEFINED = MAX_ELF_SECTIONS
+} elf_section;
+
+/**
+ * @brief The bytes of a section, grown as they are written
+ */
+typedef struct elf_buffer {
+    /* The bytes, NULL for .bss which only has a size */
+    u8* bytes;
+    /* The amount of bytes in the section */
+    u64 length;
+    /* The amount of bytes the bytes array can hold */
+    u64 capacity;
+} elf_buffer;
+
+/**
+ * @brief A named location in a section, or a name another object defines
+ */
+typedef struct elf_symbol {
+    /* The null terminated name, NULL for the symbol of a section itself. Owned by the object once the symbol is added */
+    const char* name;
+    /* The section the symbol is in */
+    elf_section section;
+    /* The offset of the symbol into its section */
+    u64 offset;
+    /* The size of what the symbol names in bytes, 0 if it is unknown */
+    u64 size;
+
+    /* Set for a function, the symbol names data otherwise */
+    b8 is_function;
+    /* Set for a symbol other objects can see (or one they define), the symbol is local to the object otherwise */
+    b8 is_global;
+} elf_symbol;
+
+/**
+ * @brief Bytes of a section the linker fills in with the address of a symbol
+ */
+typedef struct elf_relocation {
+    /* The section holding the bytes */
+    elf_section section;
+    /* The offset of the bytes into their section */
+    u64 offset;
+    /* The ELF_R_X86_64_ type of the relocation */
+    u32 type;
+    /* The index of the symbol in the object's symbols */
+    u32 symbol;
+    /* The value added to the address of the symbol */
+    i64 addend;
+} elf_relocation;
+
+/**
+ * @brief A relocatable ELF64 object for x86-64, built in memory and then written out for the system linker
+ */
+typedef struct elf_object {
+    /* The sections, indexed by elf_section */
+    elf_buffer sections[MAX_ELF_SECTIONS];
+
+    /* The symbols, the first MAX_ELF_SECTIONS of them are the sections themselves */
+    elf_symbol* symbols;
+    /* The amount of symbols */
+    u64 symbol_count;
+    /* The amount of symbols the symbols array can hold */
+    u64 symbol_capacity;
+
+    /* The relocations of every section */
+    elf_relocation* relocations;
+    /* The amount of relocations */
+    u64 relocation_count;
+    /* The amount of relocations the relocations array can hold */
+    u64 relocation_capacity;
+
+    /* Set once something could not be allocated, the object is incomplete and must not be written */
+    b8 has_error;
+} elf_object;
+
+/**
+ * @brief creates an empty object, which already has a symbol for each of its sections
+ *
+ * @return elf_object the object, has_error is set if its symbols could not be allocated
+ */
+elf_object elf_object_create(void);
+
+/**
+ * @brief frees the sections, symbols and relocations of an object and zeros the struct
+ *
+ * @param object the object to destroy
+ */
+void elf_object_destroy(elf_object* object);
+
+/**
+ * @brief appends bytes to a section, ELF_SECTION_BSS only grows by their amount
+ *
+ * @param object the object to write to
+ * @param section the section to append to
+ * @param bytes the bytes to append, NULL appends zeros
+ * @param count the amount of bytes
+ * @return u64 the offset of the first appended byte into the section
+ */
+u64 elf_object_append(elf_object* object, elf_section section, const void* bytes, u64 count);
+
+/**
+ * @brief pads a section with zeros (int3 for ELF_SECTION_TEXT) until its length is a multiple of alignment
+ *
+ * @param object the object to write to
+ * @param section the section to pad
+ * @param alignment the alignment, a power of 2
+ * @return u64 the aligned length of the section
+ */
+u64 elf_object_align(elf_object* object, elf_section section, u64 alignment);
+
+/**
+ * @brief adds a symbol to an object
+ * @note the object keeps its own copy of the name
+ *
+ * @param object the object to add to
+ * @param symbol the symbol
+ * @return u32 the index of the symbol, for elf_object_add_relocation()
+ */
+u32 elf_object_add_symbol(elf_object* object, elf_symbol symbol);
+
+/**
+ * @brief adds a relocation to an object
+ *
+ * @param object the object to add to
+ * @param relocation the relocation
+ */
+void elf_object_add_relocation(elf_object* object, elf_relocation relocation);
+
+/**
+ * @brief writes an object as a relocatable ELF64 file, which the system linker links like one made by a C compiler
+ *
+ * @param object the object to write
+ * @param filename the name of the file to write
+ * @return b8 true if the file was written, false if it could not be (or the object has_error)
+ */
+b8 elf_object_write(const elf_object* object, const char* filename);
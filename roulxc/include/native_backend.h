@@ -0,0 +1,18 @@
+#pragma once
+
+#include <rouleaux/rouleaux.h>
+#include "elf_writer.h"
+
+/**
+ * @brief lowers a bytecode program into x86-64 machine code, in a relocatable ELF64 object defining main(). Linked with
+ *        the C library it runs the program the way roulx does: it runs the top level code (or the entry point) and prints
+ *        the globals, or prints the runtime error that stopped it and exits with 1
+ * @note every function follows the System V calling convention, it is called with the address of its registers in rdi and
+ *       returns its value in rax. The registers of the calls are laid out like the vm lays them out, and nest as deeply
+ *
+ * @param context the context errors are reported to, runtime errors are rendered from the sources it holds
+ * @param program the program to lower, compiled by bytecode_compile() (and optionally optimized by bytecode_optimize())
+ * @param out_object where the object is written, it is released with elf_object_destroy() even if lowering fails
+ * @return b8 true if the program was lowered, false if an error was reported to the context
+ */
+b8 native_backend_generate(rouleaux_context* context, const bytecode_program* program, elf_object* out_object);
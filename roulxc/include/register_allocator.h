@@ -0,0 +1,55 @@
+#pragma once
+
+#include <rouleaux/rouleaux.h>
+
+// A location below 16 is a general purpose register of x86-64 (X86_RAX to X86_R15). These are the locations of a
+// register of the vm which are not one, NATIVE_LOCATION_XMM | n is xmm<n>
+#define NATIVE_LOCATION_XMM 0x10
+#define NATIVE_LOCATION_MEMORY 0xFF
+
+/**
+ * @brief Where the registers of a function live in its native code. A register in memory is its 8 bytes of the
+ *        registers of the call like in the vm, the others are held in an x86-64 register for their whole live interval
+ */
+typedef struct register_allocation {
+    /* The location of each register of the function, a general purpose register, NATIVE_LOCATION_XMM | n or NATIVE_LOCATION_MEMORY */
+    u8* locations;
+    /* The first and the last position each register is live at. An instruction i reads its operands at 2 * i and writes
+       at 2 * i + 1, a register live when the function starts has a start of 0 */
+    u32* starts;
+    u32* ends;
+    /* The amount of registers in the arrays */
+    u64 register_count;
+
+    /* The callee saved general purpose registers the function uses and has to restore, bit n for the register n */
+    u16 saved_registers;
+    /* The registers held in a caller saved register across a call, they are stored before each call they are live
+       across and loaded after it */
+    u64* spanning_registers;
+    u64 spanning_count;
+} register_allocation;
+
+/**
+ * @brief allocates x86-64 registers to the registers of a function with a linear scan over their live intervals. The
+ *        registers used like integers, strings or functions get general purpose registers and the ones used like floats
+ *        xmm registers. When there are too few the registers with the lowest spill cost, their accesses weighted by the
+ *        depth of the loops they are in, are left in memory
+ * @note a register live across a call is held in a callee saved general purpose register, or in one of its class
+ *       which is saved around the calls when it is accessed more often than that costs. A global of the top
+ *       level code any function reaches with OPCODE_GET_GLOBAL or OPCODE_SET_GLOBAL is always in memory, the others are
+ *       live until it returns and are stored for main() then. The arguments of a call are the registers from its c on
+ *       written in the block of the call, which is where bytecode_compile() moves them, they are stored before calling
+ *
+ * @param program the program the function is in
+ * @param function_index the index of the function to allocate the registers of
+ * @param out_allocation where the allocation is written, it is released with register_allocation_destroy() even if allocating fails
+ * @return b8 true if the registers were allocated, false if memory ran out
+ */
+b8 register_allocate(const bytecode_program* program, u64 function_index, register_allocation* out_allocation);
+
+/**
+ * @brief frees the arrays of an allocation and zeros the struct
+ *
+ * @param allocation the allocation to destroy
+ */
+void register_allocation_destroy(register_allocation* allocation);
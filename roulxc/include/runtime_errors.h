@@ -0,0 +1,37 @@
+#pragma once
+
+#include <rouleaux/rouleaux.h>
+
+#include <stdarg.h>
+
+/**
+ * @brief Renders the runtime errors a compiled program can report while it is compiled, with the line each one points at,
+ *        so the program prints exactly what roulx prints for the same error
+ */
+typedef struct runtime_error_renderer {
+    /* The context holding the sources the errors point into */
+    rouleaux_context* context;
+    /* The lines of the file the last error was in, so each file is only scanned for its lines once */
+    line_index lines;
+    /* The interned name of the file lines indexes */
+    const char* lines_filename;
+} runtime_error_renderer;
+
+/**
+ * @brief renders the printable text of an error, like context_diagnostics_text() would once it was reported
+ *
+ * @param renderer the renderer, its context must be set
+ * @param t the token the error points at
+ * @param id the diagnostic of the error
+ * @param params the arguments of the diagnostic
+ * @param out_length where the length of the text is written, not counting the null terminator
+ * @return char* the null terminated text, NULL if it could not be allocated. The caller frees it
+ */
+char* runtime_error_render(runtime_error_renderer* renderer, token t, diagnostic_id id, va_list params, u64* out_length);
+
+/**
+ * @brief frees the lines a renderer indexed and zeros the struct
+ *
+ * @param renderer the renderer to destroy
+ */
+void runtime_error_renderer_destroy(runtime_error_renderer* renderer);
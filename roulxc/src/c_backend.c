@@ -0,0 +1,944 @@
+#include "c_backend.h"
+#include "runtime_errors.h"
+
+#include <malloc.h>
+#include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#define DEFAULT_C_SOURCE_CAPACITY 4096
+#define DEFAULT_C_BACKEND_RESIZE_FACTOR 2
+
+/**
+ * @brief The state of lowering a whole file
+ */
+typedef struct c_backend {
+    /* The context errors are reported to */
+    rouleaux_context* context;
+    /* The program being lowered. Function i is rlx_function_<i> in the C, 0 is the top level code, rlx_top_level() */
+    const ssa_program* program;
+
+    /* The prototype of every function, so they can call each other in any order */
+    c_source prototypes;
+    /* The text of every runtime error the program can report, rendered while lowering */
+    c_source errors;
+    /* The amount of error texts */
+    u64 error_count;
+    /* Renders the error texts */
+    runtime_error_renderer renderer;
+    /* The definition of every function */
+    c_source definitions;
+    /* Set once a function is called through a value, only then the translation unit needs rlx_functions */
+    b8 has_indirect_calls;
+
+    /* Set once an error was reported, nothing else is lowered after it */
+    b8 has_error;
+} c_backend;
+
+/**
+ * @brief The state of lowering a single function. Each value is a variable of the C function, v<index> after the
+ *        instruction defining it, and each block starts at the label b<index>
+ */
+typedef struct c_function {
+    /* The file being lowered */
+    c_backend* backend;
+    /* The function being lowered */
+    const ssa_function* function;
+    /* True for the top level code, which returns nothing */
+    b8 is_top_level;
+    /* Where the body of the function is written */
+    c_source body;
+
+    /* The amount of times each value is used, a value never used is not written */
+    u32* use_counts;
+    /* Whether each block can run, the others are not written */
+    b8* is_reachable;
+
+    /* How deep the line being written is nested */
+    u32 indent;
+} c_function;
+
+// The C type of a value of each type_info
+static const char* c_types[MAX_TYPE_INFOS] = {
+    [TYPE_INFO_UNKNOWN]  = "int64_t",
+    [TYPE_INFO_INTEGER]  = "int64_t",
+    [TYPE_INFO_FLOAT]    = "double",
+    [TYPE_INFO_STRING]   = "const char*",
+    [TYPE_INFO_FUNCTION] = "uint64_t",
+};
+
+// The member of an rlx_value holding each type_info
+static const char* value_members[MAX_TYPE_INFOS] = {
+    [TYPE_INFO_UNKNOWN]  = "integer",
+    [TYPE_INFO_INTEGER]  = "integer",
+    [TYPE_INFO_FLOAT]    = "float64",
+    [TYPE_INFO_STRING]   = "string",
+    [TYPE_INFO_FUNCTION] = "function",
+};
+
+// Everything the lowered functions use. The integer arithmetic wraps around and dividing by -1 is special cased, and the
+// calls nest as deeply as the vm lets them, so a program behaves the same whether roulx or its roulxc executable runs it
+static const char c_prelude[] =
+    "#include <math.h>\n"
+    "#include <stdint.h>\n"
+    "#include <stdio.h>\n"
+    "#include <stdlib.h>\n"
+    "\n"
+    "typedef union rlx_value {\n"
+    "    uint64_t bits;\n"
+    "    int64_t integer;\n"
+    "    double float64;\n"
+    "    const char* string;\n"
+    "    uint64_t function;\n"
+    "} rlx_value;\n"
+    "\n"
+    "typedef void (*rlx_function)(void);\n"
+    "\n"
+    "#define RLX_MAX_CALL_DEPTH 4096\n"
+    "static uint32_t rlx_call_depth;\n"
+    "\n"
+    "static void rlx_runtime_error(const char* text)\n"
+    "{\n"
+    "    printf(\"%s\", text);\n"
+    "    exit(1);\n"
+    "}\n"
+    "\n"
+    "static inline void rlx_enter_call(const char* stack_overflow)\n"
+    "{\n"
+    "    if (++rlx_call_depth >= RLX_MAX_CALL_DEPTH)\n"
+    "        rlx_runtime_error(stack_overflow);\n"
+    "}\n"
+    "\n"
+    "static inline int64_t rlx_add(int64_t left, int64_t right) { return (int64_t)((uint64_t)left + (uint64_t)right); }\n"
+    "static inline int64_t rlx_subtract(int64_t left, int64_t right) { return (int64_t)((uint64_t)left - (uint64_t)right); }\n"
+    "static inline int64_t rlx_multiply(int64_t left, int64_t right) { return (int64_t)((uint64_t)left * (uint64_t)right); }\n"
+    "\n"
+    "static inline int64_t rlx_divide(int64_t left, int64_t right, const char* division_by_zero)\n"
+    "{\n"
+    "    if (right == 0)\n"
+    "        rlx_runtime_error(division_by_zero);\n"
+    "    return (right == -1) ? (int64_t)(0 - (uint64_t)left) : left / right;\n"
+    "}\n"
+    "\n"
+    "static inline int64_t rlx_modulus(int64_t left, int64_t right, const char* division_by_zero)\n"
+    "{\n"
+    "    if (right == 0)\n"
+    "        rlx_runtime_error(division_by_zero);\n"
+    "    return (right == -1) ? 0 : left % right;\n"
+    "}\n"
+    "\n"
+    "static inline double rlx_float(uint64_t bits)\n"
+    "{\n"
+    "    rlx_value value = { .bits = bits };\n"
+    "    return value.float64;\n"
+    "}\n"
+    "\n"
+    "static inline int rlx_is_true_string(const char* string)\n"
+    "{\n"
+    "    return string != NULL && string[0] != '\\0';\n"
+    "}\n"
+    "\n";
+
+// Lowers the function at an index of the program into a C function
+static void lower_function(c_backend* backend, u64 function_index);
+
+// Marks the blocks that can run and counts the uses of the values in them
+static b8 count_uses(c_function* function);
+
+// Writes the declarations of the variables of a function's values, at its start
+static void declare_values(c_function* function, c_source* definitions);
+
+// Lowers a block, its phis, its instructions and then its terminator
+static void lower_block(c_function* function, u32 block_index);
+
+// Lowers the terminator of a block, after giving the phis of the block it jumps to their values
+static void lower_terminator(c_function* function, u32 block_index);
+
+// Lowers an instruction, one whose value is never used is only lowered if it can call or report an error
+static void lower_instruction(c_function* function, u32 instruction);
+
+// Writes the arithmetic or comparison of an instruction
+static void write_operation(c_function* function, u32 instruction);
+
+// Writes a call, with the checks of the call depth around it. uses_result is false for a call whose value is never used
+static void write_call(c_function* function, u32 instruction, b8 uses_result);
+
+// Writes the value of a constant
+static void write_constant(c_function* function, const ssa_instruction* constant);
+
+// Writes whether the condition of a branch continues at its first successor
+static void write_condition(c_function* function, u32 condition);
+
+// Writes the name of the variable of a value
+static void write_value(c_function* function, u32 value);
+
+// Gives the function a callee always is, 0 when it is only known once the program runs
+static u64 known_callee(c_function* function, u32 callee);
+
+// Writes the finished translation unit, in the order C needs
+static void write_translation_unit(c_backend* backend, c_source* out_source);
+
+// Renders the text of a runtime error into the translation unit, giving the number of its rlx_error_<number>
+static u64 add_error_text(c_backend* backend, token t, diagnostic_id id, ...);
+
+// True for an integer division or modulus which can report a division by zero, one by a constant never does
+static b8 can_divide_by_zero(c_function* function, u32 instruction);
+
+// Writes the start of a line of a function's body
+static void write_indent(c_function* function);
+
+// Writes a C identifier for a rouleaux name, with a prefix keeping it apart from the names of the C
+static void write_name(c_source* source, const char* prefix, token name);
+
+// Writes a C string literal holding text
+static void write_string_literal(c_source* source, const char* text, u64 length);
+
+// Appends formatted text to a source
+static void source_write(c_source* source, const char* format, ...);
+
+// Appends text to a source
+static void source_append(c_source* source, const char* text, u64 length);
+
+// Reports an error to the context, only the first one is reported
+static void backend_error(c_backend* backend, token t, diagnostic_id id, ...);
+
+
+b8 c_backend_generate(rouleaux_context* context, const ssa_program* program, c_source* out_source)
+{
+    memset(out_source, 0, sizeof(c_source));
+
+    c_backend backend = {};
+    backend.context = context;
+    backend.program = program;
+    backend.renderer.context = context;
+
+    // The functions come first, so the top level code is the last definition before main()
+    for (u64 i = 1; i < program->function_count && !backend.has_error; ++i)
+        lower_function(&backend, i);
+
+    if (!backend.has_error)
+        lower_function(&backend, 0);
+
+    if (!backend.has_error)
+        write_translation_unit(&backend, out_source);
+
+    b8 lowered = !backend.has_error && !out_source->has_error;
+
+    runtime_error_renderer_destroy(&backend.renderer);
+    c_source_destroy(&backend.prototypes);
+    c_source_destroy(&backend.errors);
+    c_source_destroy(&backend.definitions);
+
+    return lowered;
+}
+
+void c_source_destroy(c_source* source)
+{
+    free(source->text);
+    memset(source, 0, sizeof(c_source));
+}
+
+
+
+void lower_function(c_backend* backend, u64 function_index)
+{
+    c_function function = {};
+    function.backend = backend;
+    function.function = &backend->program->functions[function_index];
+    function.is_top_level = function_index == 0;
+    function.indent = 1;
+
+    if (!count_uses(&function))
+    {
+        backend_error(backend, function.function->name, DIAGNOSTIC_CODE_GENERATION_ALLOCATION);
+        return;
+    }
+
+    // The first block is never jumped to, it needs no label
+    for (u32 i = 0; i < function.function->block_count && !backend->has_error; ++i)
+    {
+        if (function.is_reachable[i])
+            lower_block(&function, i);
+    }
+
+    // Every parameter and the result are passed as an rlx_value, so a function called through a variable only
+    // needs the amount of its arguments to be called
+    c_source* definitions = &backend->definitions;
+    if (function.is_top_level)
+    {
+        source_write(definitions, "static void rlx_top_level(void)\n{\n");
+    }
+    else
+    {
+        u16 parameter_count = function.function->parameter_count;
+        source_write(&backend->prototypes, "static rlx_value rlx_function_%llu(", function_index);
+        source_write(definitions, "static rlx_value rlx_function_%llu(", function_index);
+        for (u16 i = 0; i < parameter_count; ++i)
+        {
+            source_write(&backend->prototypes, "%srlx_value parameter_%u", i ? ", " : "", i);
+            source_write(definitions, "%srlx_value parameter_%u", i ? ", " : "", i);
+        }
+
+        source_write(&backend->prototypes, "%s);\n", parameter_count ? "" : "void");
+        source_write(definitions, "%s)\n{\n", parameter_count ? "" : "void");
+    }
+
+    // The variables are only all known once the body is lowered, they are declared at its start
+    declare_values(&function, definitions);
+    source_append(definitions, function.body.text, function.body.length);
+    source_write(definitions, "}\n\n");
+
+    free(function.use_counts);
+    free(function.is_reachable);
+    c_source_destroy(&function.body);
+}
+
+b8 count_uses(c_function* function)
+{
+    const ssa_function* ssa = function->function;
+    u32* order = malloc((ssa->block_count + 1) * sizeof(u32));
+    function->use_counts = calloc(ssa->instruction_count + 1, sizeof(u32));
+    function->is_reachable = calloc(ssa->block_count + 1, sizeof(b8));
+    if (order == NULL || function->use_counts == NULL || function->is_reachable == NULL)
+    {
+        free(order);
+        return false;
+    }
+
+    u32 order_count = ssa_reverse_postorder(ssa, order);
+    if (order_count == SSA_NONE)
+    {
+        free(order);
+        return false;
+    }
+
+    for (u32 i = 0; i < order_count; ++i)
+        function->is_reachable[order[i]] = true;
+
+    for (u32 i = 0; i < order_count; ++i)
+    {
+        const ssa_block* block = &ssa->blocks[order[i]];
+        if (block->condition != SSA_NONE)
+            function->use_counts[block->condition]++;
+
+        // A phi operand of a predecessor which cannot run is never read either
+        for (u32 j = 0; j < block->phi_count; ++j)
+        {
+            const u32* operands = ssa_operands(ssa, block->phis[j]);
+            for (u32 k = 0; k < block->predecessor_count; ++k)
+            {
+                if (function->is_reachable[block->predecessors[k]])
+                    function->use_counts[operands[k]]++;
+            }
+        }
+
+        for (u32 j = 0; j < block->instruction_count; ++j)
+        {
+            const ssa_instruction* instruction = &ssa->instructions[block->instructions[j]];
+            const u32* operands = ssa_operands(ssa, block->instructions[j]);
+            for (u32 k = 0; k < instruction->operand_count; ++k)
+                function->use_counts[operands[k]]++;
+        }
+    }
+
+    free(order);
+    return true;
+}
+
+void declare_values(c_function* function, c_source* definitions)
+{
+    const ssa_function* ssa = function->function;
+    for (u32 i = 0; i < ssa->block_count; ++i)
+    {
+        const ssa_block* block = &ssa->blocks[i];
+        if (!function->is_reachable[i])
+            continue;
+
+        // The phi of a block with several predecessors is given its value in p<index> by each of them, and takes it once the
+        // block is entered. Those that are assigned at once before it could swap their values
+        for (u32 j = 0; j < block->phi_count; ++j)
+        {
+            u32 phi = block->phis[j];
+            if (function->use_counts[phi] == 0)
+                continue;
+
+            source_write(definitions, "    %s v%u;\n", c_types[ssa->instructions[phi].type], phi);
+            if (block->predecessor_count > 1)
+                source_write(definitions, "    %s p%u;\n", c_types[ssa->instructions[phi].type], phi);
+        }
+
+        for (u32 j = 0; j < block->instruction_count; ++j)
+        {
+            u32 instruction = block->instructions[j];
+            if (function->use_counts[instruction] > 0)
+                source_write(definitions, "    %s v%u;\n", c_types[ssa->instructions[instruction].type], instruction);
+        }
+    }
+}
+
+void lower_block(c_function* function, u32 block_index)
+{
+    const ssa_function* ssa = function->function;
+    const ssa_block* block = &ssa->blocks[block_index];
+    if (block_index != 0)
+        source_write(&function->body, "b%u:\n", block_index);
+
+    // A block with a single predecessor is never jumped to by any other block, its phis take their values right here
+    for (u32 i = 0; i < block->phi_count; ++i)
+    {
+        u32 phi = block->phis[i];
+        if (function->use_counts[phi] == 0)
+            continue;
+
+        write_indent(function);
+        if (block->predecessor_count > 1)
+            source_write(&function->body, "v%u = p%u;\n", phi, phi);
+        else
+            source_write(&function->body, "v%u = v%u;\n", phi, ssa_operands(ssa, phi)[0]);
+    }
+
+    for (u32 i = 0; i < block->instruction_count && !function->backend->has_error; ++i)
+        lower_instruction(function, block->instructions[i]);
+
+    lower_terminator(function, block_index);
+}
+
+void lower_terminator(c_function* function, u32 block_index)
+{
+    const ssa_function* ssa = function->function;
+    const ssa_block* block = &ssa->blocks[block_index];
+    c_source* body = &function->body;
+
+    switch (block->terminator)
+    {
+        case SSA_TERMINATOR_JUMP:
+        {
+            // Only a jump continues at a block with several predecessors, which are the phis given their
+            // values in p<index>
+            u32 successor = block->successors[0];
+            const ssa_block* target = &ssa->blocks[successor];
+            for (u32 i = 0; i < target->phi_count && target->predecessor_count > 1; ++i)
+            {
+                u32 phi = target->phis[i];
+                if (function->use_counts[phi] == 0)
+                    continue;
+
+                u32 predecessor = 0;
+                while (target->predecessors[predecessor] != block_index)
+                    predecessor++;
+
+                write_indent(function);
+                source_write(body, "p%u = v%u;\n", phi, ssa_operands(ssa, phi)[predecessor]);
+            }
+
+            // The next block is continued at without a goto
+            if (successor != block_index + 1)
+            {
+                write_indent(function);
+                source_write(body, "goto b%u;\n", successor);
+            }
+
+            break;
+        }
+        case SSA_TERMINATOR_BRANCH:
+        {
+            write_indent(function);
+            source_write(body, "if (");
+            write_condition(function, block->condition);
+            source_write(body, ")\n");
+            write_indent(function);
+            source_write(body, "    goto b%u;\n", block->successors[0]);
+
+            if (block->successors[1] != block_index + 1)
+            {
+                write_indent(function);
+                source_write(body, "goto b%u;\n", block->successors[1]);
+            }
+
+            break;
+        }
+        default:
+        {
+            // The language has no return statement yet, so a call gives the zero value of its return type
+            write_indent(function);
+            source_write(body, function->is_top_level ? "return;\n" : "return (rlx_value){ 0 };\n");
+            break;
+        }
+    };
+}
+
+void lower_instruction(c_function* function, u32 instruction)
+{
+    const ssa_instruction* current = &function->function->instructions[instruction];
+    c_source* body = &function->body;
+    b8 is_used = function->use_counts[instruction] > 0;
+
+    switch (current->opcode)
+    {
+        case SSA_OPCODE_STORE_GLOBAL:
+        {
+            write_indent(function);
+            write_name(body, "g_", function->backend->program->globals[current->index].name);
+            source_write(body, " = ");
+            write_value(function, ssa_operands(function->function, instruction)[0]);
+            source_write(body, ";\n");
+            return;
+        }
+        case SSA_OPCODE_CALL:
+        {
+            write_call(function, instruction, is_used);
+            return;
+        }
+        default:
+        {
+            break;
+        }
+    };
+
+    // An unused integer division still has to report a division by zero, the other unused values need nothing
+    b8 is_checked = can_divide_by_zero(function, instruction);
+    if (!is_used && !is_checked)
+        return;
+
+    write_indent(function);
+    if (is_used)
+        source_write(body, "v%u = ", instruction);
+    else
+        source_write(body, "(void)");
+
+    switch (current->opcode)
+    {
+        case SSA_OPCODE_CONSTANT:
+        {
+            write_constant(function, current);
+            break;
+        }
+        case SSA_OPCODE_PARAMETER:
+        {
+            source_write(body, "parameter_%llu.%s", current->index, value_members[current->type]);
+            break;
+        }
+        case SSA_OPCODE_LOAD_GLOBAL:
+        {
+            write_name(body, "g_", function->backend->program->globals[current->index].name);
+            break;
+        }
+        default:
+        {
+            write_operation(function, instruction);
+            break;
+        }
+    };
+
+    source_write(body, ";\n");
+}
+
+void write_operation(c_function* function, u32 instruction)
+{
+    const ssa_instruction* operation = &function->function->instructions[instruction];
+    const u32* operands = ssa_operands(function->function, instruction);
+    c_source* body = &function->body;
+
+    // Both operands have the operation's type, only integers and floats have operations
+    type_info type = operation->type;
+    ssa_opcode opcode = (ssa_opcode)operation->opcode;
+    b8 is_comparison = opcode == SSA_OPCODE_GREATER_THAN || opcode == SSA_OPCODE_LESS_THAN;
+
+    // The integer operations are functions of the prelude, the float ones are the C operators
+    const char* integer_functions[] = { "rlx_add", "rlx_subtract", "rlx_multiply", "rlx_divide", "rlx_modulus" };
+    const char* float_operators[] = { "+", "-", "*", "/" };
+    u64 index = (u64)(opcode - SSA_OPCODE_ADD);
+
+    // A division by a constant is the C operator, nothing has to be checked
+    b8 is_checked = can_divide_by_zero(function, instruction);
+    b8 is_unchecked_division = type == TYPE_INFO_INTEGER && !is_checked && (opcode == SSA_OPCODE_DIVIDE || opcode == SSA_OPCODE_MODULUS);
+
+    if (is_comparison)
+        source_write(body, (type == TYPE_INFO_FLOAT) ? "((" : "(int64_t)(");
+    else if (is_unchecked_division)
+        source_write(body, "(");
+    else if (type == TYPE_INFO_INTEGER)
+        source_write(body, "%s(", integer_functions[index]);
+    else if (opcode == SSA_OPCODE_MODULUS)
+        source_write(body, "fmod(");
+    else
+        source_write(body, "(");
+
+    write_value(function, operands[0]);
+
+    if (is_comparison)
+        source_write(body, (opcode == SSA_OPCODE_GREATER_THAN) ? " > " : " < ");
+    else if (is_unchecked_division)
+        source_write(body, " %s ", (opcode == SSA_OPCODE_DIVIDE) ? "/" : "%");
+    else if (type == TYPE_INFO_INTEGER || opcode == SSA_OPCODE_MODULUS)
+        source_write(body, ", ");
+    else
+        source_write(body, " %s ", float_operators[index]);
+
+    write_value(function, operands[1]);
+
+    if (is_checked)
+        source_write(body, ", rlx_error_%llu", add_error_text(function->backend, operation->t, DIAGNOSTIC_DIVISION_BY_ZERO));
+
+    // A float comparison gives 1.0 or 0.0
+    source_write(body, (is_comparison && type == TYPE_INFO_FLOAT) ? ") ? 1.0 : 0.0)" : ")");
+}
+
+void write_call(c_function* function, u32 instruction, b8 uses_result)
+{
+    c_backend* backend = function->backend;
+    const ssa_instruction* call = &function->function->instructions[instruction];
+    const u32* operands = ssa_operands(function->function, instruction);
+    u32 argument_count = call->operand_count - 1;
+    c_source* body = &function->body;
+
+    // The vm names the function after the declaration it was in. A function only known once the program runs is
+    // named after what it is called by instead, the one thing of it known here
+    u64 known_function = known_callee(function, operands[0]);
+    token callee_name = (known_function != 0) ? backend->program->functions[known_function].name : call->t;
+    u64 stack_overflow = add_error_text(backend, call->t, DIAGNOSTIC_STACK_OVERFLOW, diagnostic_token_text(callee_name));
+    write_indent(function);
+    source_write(body, "rlx_enter_call(rlx_error_%llu);\n", stack_overflow);
+
+    write_indent(function);
+    if (uses_result)
+        source_write(body, "v%u = ", instruction);
+    else
+        source_write(body, "(void)");
+
+    if (known_function != 0)
+    {
+        source_write(body, "rlx_function_%llu(", known_function);
+    }
+    else
+    {
+        // Cast back to the type the function was defined with, which only depends on its amount of parameters
+        backend->has_indirect_calls = true;
+        source_write(body, "((rlx_value (*)(");
+        for (u32 i = 0; i < argument_count; ++i)
+            source_write(body, "%srlx_value", i ? ", " : "");
+
+        source_write(body, "%s))rlx_functions[", argument_count ? "" : "void");
+        write_value(function, operands[0]);
+        source_write(body, "])(");
+    }
+
+    for (u32 i = 0; i < argument_count; ++i)
+    {
+        type_info argument_type = function->function->instructions[operands[i + 1]].type;
+        source_write(body, "%s(rlx_value){ .%s = ", i ? ", " : "", value_members[argument_type]);
+        write_value(function, operands[i + 1]);
+        source_write(body, " }");
+    }
+
+    source_write(body, uses_result ? ").%s;\n" : ");\n", value_members[call->type]);
+
+    write_indent(function);
+    source_write(body, "rlx_call_depth--;\n");
+}
+
+void write_constant(c_function* function, const ssa_instruction* constant)
+{
+    c_source* body = &function->body;
+    ssa_constant value = constant->constant;
+
+    switch (constant->type)
+    {
+        case TYPE_INFO_FLOAT:
+        {
+            // A hexadecimal float is exact, the bits are only needed for what has no literal
+            if (isfinite(value.float64))
+                source_write(body, "%a", value.float64);
+            else
+                source_write(body, "rlx_float(UINT64_C(0x%llx))", value.bits);
+
+            break;
+        }
+        case TYPE_INFO_STRING:
+        {
+            // The zero value of a string is no string at all
+            if (value.string != NULL)
+                write_string_literal(body, value.string, strlen(value.string));
+            else
+                source_write(body, "NULL");
+
+            break;
+        }
+        case TYPE_INFO_FUNCTION:
+        {
+            source_write(body, "UINT64_C(%llu)", value.function);
+            break;
+        }
+        default:
+        {
+            if (value.integer >= 0)
+                source_write(body, "INT64_C(%llu)", value.bits);
+            else
+                source_write(body, "(int64_t)UINT64_C(%llu)", value.bits);
+
+            break;
+        }
+    };
+}
+
+void write_condition(c_function* function, u32 condition)
+{
+    switch (function->function->instructions[condition].type)
+    {
+        case TYPE_INFO_FLOAT:
+        {
+            source_write(&function->body, "v%u != 0.0", condition);
+            break;
+        }
+        case TYPE_INFO_STRING:
+        {
+            source_write(&function->body, "rlx_is_true_string(v%u)", condition);
+            break;
+        }
+        default:
+        {
+            // Integers, and functions which are tested the same way
+            source_write(&function->body, "v%u != 0", condition);
+            break;
+        }
+    };
+}
+
+void write_value(c_function* function, u32 value)
+{
+    source_write(&function->body, "v%u", value);
+}
+
+u64 known_callee(c_function* function, u32 callee)
+{
+    // Only a constant function, or a global declared as one, is always the same function
+    const ssa_instruction* instruction = &function->function->instructions[callee];
+    if (instruction->opcode == SSA_OPCODE_CONSTANT && instruction->type == TYPE_INFO_FUNCTION)
+        return instruction->constant.function;
+
+    if (instruction->opcode == SSA_OPCODE_LOAD_GLOBAL)
+        return function->backend->program->globals[instruction->index].constant_function;
+
+    return 0;
+}
+
+void write_translation_unit(c_backend* backend, c_source* out_source)
+{
+    source_append(out_source, c_prelude, sizeof(c_prelude) - 1);
+
+    const ssa_program* program = backend->program;
+    for (u64 i = 0; i < program->global_count; ++i)
+    {
+        const ssa_global* global = &program->globals[i];
+        source_write(out_source, "static %s ", c_types[global->type]);
+        write_name(out_source, "g_", global->name);
+        source_write(out_source, ";\n");
+    }
+
+    source_write(out_source, "\n");
+    source_append(out_source, backend->errors.text, backend->errors.length);
+    source_write(out_source, "\n");
+    source_append(out_source, backend->prototypes.text, backend->prototypes.length);
+
+    // A function value is the number of the function, a call through it looks the function up in here. The top level code
+    // is never a value
+    if (backend->has_indirect_calls)
+    {
+        source_write(out_source, "\nstatic const rlx_function rlx_functions[] = {\n    NULL,\n");
+        for (u64 i = 1; i < program->function_count; ++i)
+            source_write(out_source, "    (rlx_function)rlx_function_%llu,\n", i);
+
+        source_write(out_source, "};\n");
+    }
+
+    source_write(out_source, "\n");
+    source_append(out_source, backend->definitions.text, backend->definitions.length);
+
+    // The program prints its globals like roulx does
+    source_write(out_source, "int main(void)\n{\n    rlx_top_level();\n\n    printf(\"Symbol Table:\\n\");\n");
+    for (u64 i = 0; i < program->global_count; ++i)
+    {
+        const ssa_global* global = &program->globals[i];
+        source_write(out_source, "    printf(\"\\t%%s = \", ");
+        write_string_literal(out_source, global->name.text, global->name.length);
+        source_write(out_source, ");\n");
+
+        switch (global->type)
+        {
+            case TYPE_INFO_INTEGER:
+            {
+                source_write(out_source, "    printf(\"%%lld\\n\", (long long)");
+                break;
+            }
+            case TYPE_INFO_FLOAT:
+            {
+                source_write(out_source, "    printf(\"%%lf\\n\", ");
+                break;
+            }
+            case TYPE_INFO_STRING:
+            {
+                source_write(out_source, "    printf(\"\\\"%%s\\\"\\n\", ");
+                break;
+            }
+            default:
+            {
+                source_write(out_source, "    printf(\"<function>\\n\");\n");
+                continue;
+            }
+        };
+
+        write_name(out_source, "g_", global->name);
+        source_write(out_source, ");\n");
+    }
+
+    source_write(out_source, "\n    return 0;\n}\n");
+}
+
+u64 add_error_text(c_backend* backend, token t, diagnostic_id id, ...)
+{
+    // The text is rendered now, with the faulted line, so the program prints exactly what roulx would
+    u64 text_length = 0;
+    va_list params;
+    va_start(params, id);
+    char* text = runtime_error_render(&backend->renderer, t, id, params, &text_length);
+    va_end(params);
+
+    if (text == NULL)
+    {
+        backend_error(backend, t, DIAGNOSTIC_CODE_GENERATION_ALLOCATION);
+        return 0;
+    }
+
+    u64 number = backend->error_count++;
+    source_write(&backend->errors, "static const char rlx_error_%llu[] = ", number);
+    write_string_literal(&backend->errors, text, text_length);
+    source_write(&backend->errors, ";\n");
+
+    free(text);
+    return number;
+}
+
+b8 can_divide_by_zero(c_function* function, u32 instruction)
+{
+    const ssa_instruction* division = &function->function->instructions[instruction];
+    b8 is_division = division->opcode == SSA_OPCODE_DIVIDE || division->opcode == SSA_OPCODE_MODULUS;
+    if (!is_division || division->type != TYPE_INFO_INTEGER)
+        return false;
+
+    // Dividing by -1 is checked like dividing by zero, C gets it wrong for the smallest integer
+    const ssa_instruction* divisor = &function->function->instructions[ssa_operands(function->function, instruction)[1]];
+    return divisor->opcode != SSA_OPCODE_CONSTANT || divisor->constant.integer == 0 || divisor->constant.integer == -1;
+}
+
+void write_indent(c_function* function)
+{
+    for (u32 i = 0; i < function->indent; ++i)
+        source_append(&function->body, "    ", 4);
+}
+
+void write_name(c_source* source, const char* prefix, token name)
+{
+    source_write(source, "%s", prefix);
+
+    // Anything a C identifier cannot hold is written as its hexadecimal value
+    for (u64 i = 0; i < name.length; ++i)
+    {
+        char c = name.text[i];
+        b8 is_identifier = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+        if (is_identifier)
+            source_append(source, &c, 1);
+        else
+            source_write(source, "_%02X", (u8)c);
+    }
+}
+
+void write_string_literal(c_source* source, const char* text, u64 length)
+{
+    source_append(source, "\"", 1);
+    for (u64 i = 0; i < length; ++i)
+    {
+        u8 c = (u8)text[i];
+
+        // '?' is escaped too, so no trigraph can be formed
+        if (c == '\\' || c == '"' || c == '?')
+            source_write(source, "\\%c", c);
+        else if (c == '\n')
+            source_write(source, "\\n\"\n    \"");
+        else if (c >= 0x20 && c < 0x7F)
+            source_append(source, (const char*)&c, 1);
+        else
+            source_write(source, "\\%03o", c);
+    }
+    source_append(source, "\"", 1);
+}
+
+void source_write(c_source* source, const char* format, ...)
+{
+    va_list params;
+    va_start(params, format);
+    int length = vsnprintf(NULL, 0, format, params);
+    va_end(params);
+
+    if (length < 0)
+    {
+        source->has_error = true;
+        return;
+    }
+
+    // Room for the null terminator vsnprintf() writes
+    source_append(source, NULL, (u64)length + 1);
+    if (source->has_error)
+        return;
+
+    source->length -= (u64)length + 1;
+    va_start(params, format);
+    vsnprintf(source->text + source->length, (u64)length + 1, format, params);
+    va_end(params);
+
+    source->length += (u64)length;
+}
+
+void source_append(c_source* source, const char* text, u64 length)
+{
+    if (source->has_error)
+        return;
+
+    if (source->length + length + 1 > source->capacity)
+    {
+        u64 new_capacity = source->capacity ? source->capacity : DEFAULT_C_SOURCE_CAPACITY;
+        while (source->length + length + 1 > new_capacity)
+            new_capacity *= DEFAULT_C_BACKEND_RESIZE_FACTOR;
+
+        char* new_text = realloc(source->text, new_capacity);
+        if (new_text == NULL)
+        {
+            source->has_error = true;
+            return;
+        }
+
+        source->text = new_text;
+        source->capacity = new_capacity;
+    }
+
+    // A NULL text only makes room
+    if (text != NULL)
+        memcpy(source->text + source->length, text, length);
+
+    source->length += length;
+    source->text[source->length] = '\0';
+}
+
+void backend_error(c_backend* backend, token t, diagnostic_id id, ...)
+{
+    if (backend->has_error)
+        return;
+
+    va_list params;
+    va_start(params, id);
+    error_report report = error_report_create(t, id, params);
+    va_end(params);
+
+    context_report_error(backend->context, report);
+    backend->has_error = true;
+}
@@ -0,0 +1,464 @@
+#include "elf_writer.h"
+
+#include <malloc.h>
+#include <stdio.h>
+#include <string.h>
+
+#define DEFAULT_ELF_BUFFER_CAPACITY 4096
+#define DEFAULT_ELF_POOL_CAPACITY 64
+#define DEFAULT_ELF_RESIZE_FACTOR 2
+
+// The sizes of the structures of an ELF64 file
+#define ELF_HEADER_SIZE 64
+#define ELF_SECTION_HEADER_SIZE 64
+#define ELF_SYMBOL_SIZE 24
+#define ELF_RELOCATION_SIZE 24
+
+// The section header types and flags used
+#define ELF_SHT_PROGBITS 1
+#define ELF_SHT_SYMTAB 2
+#define ELF_SHT_STRTAB 3
+#define ELF_SHT_RELA 4
+#define ELF_SHT_NOBITS 8
+#define ELF_SHF_WRITE 0x1
+#define ELF_SHF_ALLOC 0x2
+#define ELF_SHF_EXECINSTR 0x4
+#define ELF_SHF_INFO_LINK 0x40
+
+// The symbol bindings and types used
+#define ELF_STB_LOCAL 0
+#define ELF_STB_GLOBAL 1
+#define ELF_STT_NOTYPE 0
+#define ELF_STT_OBJECT 1
+#define ELF_STT_FUNC 2
+#define ELF_STT_SECTION 3
+
+/**
+ * @brief The section headers of the file, in the order they are written. The first MAX_ELF_SECTIONS follow elf_section, one
+ *        past the null section
+ */
+typedef enum elf_header_index {
+    ELF_HEADER_NULL = 0,
+    ELF_HEADER_TEXT,
+    ELF_HEADER_RODATA,
+    ELF_HEADER_DATA,
+    ELF_HEADER_BSS,
+    ELF_HEADER_RELA_TEXT,
+    ELF_HEADER_RELA_RODATA,
+    ELF_HEADER_RELA_DATA,
+    ELF_HEADER_SYMTAB,
+    ELF_HEADER_STRTAB,
+    ELF_HEADER_SHSTRTAB,
+    ELF_HEADER_NOTE_GNU_STACK,
+
+    MAX_ELF_HEADERS
+} elf_header_index;
+
+/**
+ * @brief Where a section header points and what it says about its section
+ */
+typedef struct elf_section_header {
+    /* The name of the section */
+    const char* name;
+    /* The ELF_SHT_ type */
+    u32 type;
+    /* The ELF_SHF_ flags */
+    u64 flags;
+    /* The offset of the section's content into the file */
+    u64 offset;
+    /* The size of the section in bytes */
+    u64 size;
+    /* The section header the section refers to, depending on its type */
+    u32 link;
+    /* More information, depending on the section's type */
+    u32 info;
+    /* The alignment of the section */
+    u64 alignment;
+    /* The size of each entry, for sections made of entries */
+    u64 entry_size;
+} elf_section_header;
+
+// The name of every section header
+static const char* header_names[MAX_ELF_HEADERS] = {
+    [ELF_HEADER_NULL]           = "",
+    [ELF_HEADER_TEXT]           = ".text",
+    [ELF_HEADER_RODATA]         = ".rodata",
+    [ELF_HEADER_DATA]           = ".data",
+    [ELF_HEADER_BSS]            = ".bss",
+    [ELF_HEADER_RELA_TEXT]      = ".rela.text",
+    [ELF_HEADER_RELA_RODATA]    = ".rela.rodata",
+    [ELF_HEADER_RELA_DATA]      = ".rela.data",
+    [ELF_HEADER_SYMTAB]         = ".symtab",
+    [ELF_HEADER_STRTAB]         = ".strtab",
+    [ELF_HEADER_SHSTRTAB]       = ".shstrtab",
+    [ELF_HEADER_NOTE_GNU_STACK] = ".note.GNU-stack",
+};
+
+// Grows a buffer so count more bytes fit, false if it could not
+static b8 reserve(elf_buffer* buffer, u64 count);
+
+// Appends bytes to a buffer, zeros if bytes is NULL
+static b8 write_bytes(elf_buffer* buffer, const void* bytes, u64 count);
+
+// Appends little endian values to a buffer
+static b8 write_u16(elf_buffer* buffer, u16 value);
+static b8 write_u32(elf_buffer* buffer, u32 value);
+static b8 write_u64(elf_buffer* buffer, u64 value);
+
+// Pads a buffer with zeros until its length is a multiple of alignment
+static b8 pad(elf_buffer* buffer, u64 alignment);
+
+
+elf_object elf_object_create(void)
+{
+    elf_object object = {};
+
+    // The symbols of the sections come first, so a relocation can refer to a section by its elf_section
+    for (u32 i = 0; i < MAX_ELF_SECTIONS; ++i)
+        elf_object_add_symbol(&object, (elf_symbol){ .section = (elf_section)i });
+
+    return object;
+}
+
+void elf_object_destroy(elf_object* object)
+{
+    for (u64 i = 0; i < MAX_ELF_SECTIONS; ++i)
+        free(object->sections[i].bytes);
+
+    for (u64 i = 0; i < object->symbol_count; ++i)
+        free((char*)object->symbols[i].name);
+
+    free(object->symbols);
+    free(object->relocations);
+    memset(object, 0, sizeof(elf_object));
+}
+
+u64 elf_object_append(elf_object* object, elf_section section, const void* bytes, u64 count)
+{
+    elf_buffer* buffer = &object->sections[section];
+    u64 offset = buffer->length;
+
+    // .bss takes no room in the file, only its size is written
+    if (section == ELF_SECTION_BSS)
+    {
+        buffer->length += count;
+        return offset;
+    }
+
+    if (!write_bytes(buffer, bytes, count))
+        object->has_error = true;
+
+    return offset;
+}
+
+u64 elf_object_align(elf_object* object, elf_section section, u64 alignment)
+{
+    elf_buffer* buffer = &object->sections[section];
+    while (buffer->length % alignment != 0 && !object->has_error)
+    {
+        // int3 between functions, zeros between data
+        const u8 padding = (section == ELF_SECTION_TEXT) ? 0xCC : 0;
+        elf_object_append(object, section, &padding, 1);
+    }
+
+    return buffer->length;
+}
+
+u32 elf_object_add_symbol(elf_object* object, elf_symbol symbol)
+{
+    if (object->symbol_count >= object->symbol_capacity)
+    {
+        u64 new_capacity = object->symbol_capacity ? object->symbol_capacity * DEFAULT_ELF_RESIZE_FACTOR : DEFAULT_ELF_POOL_CAPACITY;
+        elf_symbol* new_symbols = realloc(object->symbols, new_capacity * sizeof(elf_symbol));
+        if (new_symbols == NULL)
+        {
+            object->has_error = true;
+            return 0;
+        }
+
+        object->symbols = new_symbols;
+        object->symbol_capacity = new_capacity;
+    }
+
+    if (symbol.name != NULL)
+    {
+        u64 length = strlen(symbol.name);
+        char* name = malloc(length + 1);
+        if (name == NULL)
+        {
+            object->has_error = true;
+            return 0;
+        }
+
+        memcpy(name, symbol.name, length + 1);
+        symbol.name = name;
+    }
+
+    object->symbols[object->symbol_count] = symbol;
+    return (u32)object->symbol_count++;
+}
+
+void elf_object_add_relocation(elf_object* object, elf_relocation relocation)
+{
+    if (object->relocation_count >= object->relocation_capacity)
+    {
+        u64 new_capacity = object->relocation_capacity ? object->relocation_capacity * DEFAULT_ELF_RESIZE_FACTOR : DEFAULT_ELF_POOL_CAPACITY;
+        elf_relocation* new_relocations = realloc(object->relocations, new_capacity * sizeof(elf_relocation));
+        if (new_relocations == NULL)
+        {
+            object->has_error = true;
+            return;
+        }
+
+        object->relocations = new_relocations;
+        object->relocation_capacity = new_capacity;
+    }
+
+    object->relocations[object->relocation_count++] = relocation;
+}
+
+b8 elf_object_write(const elf_object* object, const char* filename)
+{
+    if (object->has_error)
+        return false;
+
+    elf_buffer file = {};
+    elf_buffer names = {};
+    elf_buffer header_string_table = {};
+    elf_section_header headers[MAX_ELF_HEADERS] = {};
+    u32* symbol_indices = malloc((object->symbol_count + 1) * sizeof(u32));
+    b8 written = symbol_indices != NULL;
+
+    // The ELF header is written last, once the section headers' offset is known
+    written = written && write_bytes(&file, NULL, ELF_HEADER_SIZE);
+
+    // The contents of the sections
+    for (u32 i = 0; i < MAX_ELF_SECTIONS && written; ++i)
+    {
+        elf_section_header* header = &headers[ELF_HEADER_TEXT + i];
+        const elf_buffer* section = &object->sections[i];
+
+        written = pad(&file, 16);
+        header->offset = file.length;
+        header->size = section->length;
+        header->alignment = 16;
+        header->type = (i == ELF_SECTION_BSS) ? ELF_SHT_NOBITS : ELF_SHT_PROGBITS;
+        header->flags = ELF_SHF_ALLOC;
+        if (i == ELF_SECTION_TEXT)
+            header->flags |= ELF_SHF_EXECINSTR;
+        else if (i == ELF_SECTION_DATA || i == ELF_SECTION_BSS)
+            header->flags |= ELF_SHF_WRITE;
+
+        if (i != ELF_SECTION_BSS)
+            written = written && write_bytes(&file, section->bytes, section->length);
+    }
+
+    // The symbol table, the local symbols have to come before the global ones. The first entry of it and of its string table
+    // are empty
+    written = written && pad(&file, 8) && write_bytes(&names, NULL, 1);
+    headers[ELF_HEADER_SYMTAB].offset = file.length;
+    written = written && write_bytes(&file, NULL, ELF_SYMBOL_SIZE);
+
+    u32 symtab_count = 1;
+    for (u32 pass = 0; pass < 2 && written; ++pass)
+    {
+        b8 writes_globals = pass == 1;
+        if (writes_globals)
+            headers[ELF_HEADER_SYMTAB].info = symtab_count;
+
+        for (u64 i = 0; i < object->symbol_count && written; ++i)
+        {
+            const elf_symbol* symbol = &object->symbols[i];
+            if (symbol->is_global != writes_globals)
+                continue;
+
+            u32 name_offset = 0;
+            if (symbol->name != NULL)
+            {
+                name_offset = (u32)names.length;
+                written = write_bytes(&names, symbol->name, strlen(symbol->name) + 1);
+            }
+
+            u8 type = symbol->is_function ? ELF_STT_FUNC : ELF_STT_OBJECT;
+            if (symbol->name == NULL)
+                type = ELF_STT_SECTION;
+            else if (symbol->section == ELF_SECTION_UNDEFINED)
+                type = ELF_STT_NOTYPE;
+
+            // The section headers of the sections are one past their elf_section, 0 is undefined
+            u16 section_index = (symbol->section == ELF_SECTION_UNDEFINED) ? 0 : (u16)(ELF_HEADER_TEXT + symbol->section);
+            u8 bind = symbol->is_global ? ELF_STB_GLOBAL : ELF_STB_LOCAL;
+
+            written = written && write_u32(&file, name_offset);
+            written = written && write_bytes(&file, &(u8){ (u8)((bind << 4) | type) }, 1) && write_bytes(&file, NULL, 1);
+            written = written && write_u16(&file, section_index);
+            written = written && write_u64(&file, symbol->offset) && write_u64(&file, symbol->size);
+
+            symbol_indices[i] = symtab_count++;
+        }
+    }
+
+    headers[ELF_HEADER_SYMTAB].size = (u64)symtab_count * ELF_SYMBOL_SIZE;
+    headers[ELF_HEADER_SYMTAB].type = ELF_SHT_SYMTAB;
+    headers[ELF_HEADER_SYMTAB].link = ELF_HEADER_STRTAB;
+    headers[ELF_HEADER_SYMTAB].alignment = 8;
+    headers[ELF_HEADER_SYMTAB].entry_size = ELF_SYMBOL_SIZE;
+
+    // The relocations of each section, .bss has none
+    for (u32 i = 0; i < ELF_SECTION_BSS && written; ++i)
+    {
+        elf_section_header* header = &headers[ELF_HEADER_RELA_TEXT + i];
+        written = pad(&file, 8);
+        header->offset = file.length;
+        header->type = ELF_SHT_RELA;
+        header->flags = ELF_SHF_INFO_LINK;
+        header->link = ELF_HEADER_SYMTAB;
+        header->info = ELF_HEADER_TEXT + i;
+        header->alignment = 8;
+        header->entry_size = ELF_RELOCATION_SIZE;
+
+        for (u64 j = 0; j < object->relocation_count && written; ++j)
+        {
+            const elf_relocation* relocation = &object->relocations[j];
+            if (relocation->section != (elf_section)i)
+                continue;
+
+            written = write_u64(&file, relocation->offset);
+            written = written && write_u64(&file, ((u64)symbol_indices[relocation->symbol] << 32) | relocation->type);
+            written = written && write_u64(&file, (u64)relocation->addend);
+            header->size += ELF_RELOCATION_SIZE;
+        }
+    }
+
+    headers[ELF_HEADER_STRTAB].offset = file.length;
+    headers[ELF_HEADER_STRTAB].size = names.length;
+    headers[ELF_HEADER_STRTAB].type = ELF_SHT_STRTAB;
+    headers[ELF_HEADER_STRTAB].alignment = 1;
+    written = written && write_bytes(&file, names.bytes, names.length);
+
+    // An empty .note.GNU-stack tells the linker the code does not need an executable stack
+    headers[ELF_HEADER_NOTE_GNU_STACK].type = ELF_SHT_PROGBITS;
+    headers[ELF_HEADER_NOTE_GNU_STACK].offset = file.length;
+    headers[ELF_HEADER_NOTE_GNU_STACK].alignment = 1;
+
+    u32 name_offsets[MAX_ELF_HEADERS] = {};
+    for (u32 i = 0; i < MAX_ELF_HEADERS && written; ++i)
+    {
+        name_offsets[i] = (u32)header_string_table.length;
+        written = write_bytes(&header_string_table, header_names[i], strlen(header_names[i]) + 1);
+    }
+
+    headers[ELF_HEADER_SHSTRTAB].offset = file.length;
+    headers[ELF_HEADER_SHSTRTAB].size = header_string_table.length;
+    headers[ELF_HEADER_SHSTRTAB].type = ELF_SHT_STRTAB;
+    headers[ELF_HEADER_SHSTRTAB].alignment = 1;
+    written = written && write_bytes(&file, header_string_table.bytes, header_string_table.length);
+
+    // The section headers, the null one stays zeroed
+    written = written && pad(&file, 8);
+    u64 section_headers_offset = file.length;
+    for (u32 i = 0; i < MAX_ELF_HEADERS && written; ++i)
+    {
+        elf_section_header* header = &headers[i];
+        written = write_u32(&file, (i == ELF_HEADER_NULL) ? 0 : name_offsets[i]);
+        written = written && write_u32(&file, header->type) && write_u64(&file, header->flags);
+        written = written && write_u64(&file, 0) && write_u64(&file, header->offset) && write_u64(&file, header->size);
+        written = written && write_u32(&file, header->link) && write_u32(&file, header->info);
+        written = written && write_u64(&file, header->alignment) && write_u64(&file, header->entry_size);
+    }
+
+    if (written)
+    {
+        // A 64 bit little endian relocatable file for x86-64 (EM_X86_64), of the current version of ELF
+        elf_buffer header = {};
+        const u8 identification[16] = { 0x7F, 'E', 'L', 'F', 2, 1, 1 };
+        written = write_bytes(&header, identification, sizeof(identification));
+        written = written && write_u16(&header, 1) && write_u16(&header, 62) && write_u32(&header, 1);
+        written = written && write_u64(&header, 0) && write_u64(&header, 0) && write_u64(&header, section_headers_offset);
+        written = written && write_u32(&header, 0) && write_u16(&header, ELF_HEADER_SIZE) && write_u16(&header, 0);
+        written = written && write_u16(&header, 0) && write_u16(&header, ELF_SECTION_HEADER_SIZE);
+        written = written && write_u16(&header, MAX_ELF_HEADERS) && write_u16(&header, ELF_HEADER_SHSTRTAB);
+
+        if (written)
+            memcpy(file.bytes, header.bytes, ELF_HEADER_SIZE);
+
+        free(header.bytes);
+    }
+
+    FILE* output = written ? fopen(filename, "wb") : NULL;
+    if (output != NULL)
+    {
+        written = fwrite(file.bytes, 1, file.length, output) == file.length;
+        written = (fclose(output) == 0) && written;
+    }
+    else
+    {
+        written = false;
+    }
+
+    free(symbol_indices);
+    free(file.bytes);
+    free(names.bytes);
+    free(header_string_table.bytes);
+    return written;
+}
+
+
+
+b8 reserve(elf_buffer* buffer, u64 count)
+{
+    if (buffer->length + count <= buffer->capacity)
+        return true;
+
+    u64 new_capacity = buffer->capacity ? buffer->capacity : DEFAULT_ELF_BUFFER_CAPACITY;
+    while (buffer->length + count > new_capacity)
+        new_capacity *= DEFAULT_ELF_RESIZE_FACTOR;
+
+    u8* new_bytes = realloc(buffer->bytes, new_capacity);
+    if (new_bytes == NULL)
+        return false;
+
+    buffer->bytes = new_bytes;
+    buffer->capacity = new_capacity;
+    return true;
+}
+
+b8 write_bytes(elf_buffer* buffer, const void* bytes, u64 count)
+{
+    if (count == 0)
+        return true;
+
+    if (!reserve(buffer, count))
+        return false;
+
+    if (bytes != NULL)
+        memcpy(buffer->bytes + buffer->length, bytes, count);
+    else
+        memset(buffer->bytes + buffer->length, 0, count);
+
+    buffer->length += count;
+    return true;
+}
+
+b8 write_u16(elf_buffer* buffer, u16 value)
+{
+    const u8 bytes[] = { (u8)value, (u8)(value >> 8) };
+    return write_bytes(buffer, bytes, sizeof(bytes));
+}
+
+b8 write_u32(elf_buffer* buffer, u32 value)
+{
+    const u8 bytes[] = { (u8)value, (u8)(value >> 8), (u8)(value >> 16), (u8)(value >> 24) };
+    return write_bytes(buffer, bytes, sizeof(bytes));
+}
+
+b8 write_u64(elf_buffer* buffer, u64 value)
+{
+    return write_u32(buffer, (u32)value) && write_u32(buffer, (u32)(value >> 32));
+}
+
+b8 pad(elf_buffer* buffer, u64 alignment)
+{
+    u64 padding = (alignment - buffer->length % alignment) % alignment;
+    return write_bytes(buffer, NULL, padding);
+}
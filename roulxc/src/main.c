@@ -0,0 +1,323 @@
+#include <rouleaux/rouleaux.h>
+#include "c_backend.h"
+#include "native_backend.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <malloc.h>
+
+// The C compiler used when neither --cc nor the CC environment variable names one
+#ifdef _WIN32
+#define DEFAULT_C_COMPILER "clang"
+#else
+#define DEFAULT_C_COMPILER "cc"
+#endif
+
+int print_usage(const char* program_name);
+
+// Prints every diagnostic reported to the context
+void print_diagnostics(rouleaux_context* context);
+
+// Gives the path of the executable when -o does not, the file's path without its extension. The caller frees it
+char* default_output_path(const char* filename);
+
+// Writes the C of a file next to its executable, giving the path of the C. The caller frees it
+char* write_c_source(const char* output_path, const c_source* source);
+
+// Compiles the C into the executable with the system's C compiler
+b8 compile_c_source(const char* compiler, const char* c_path, const char* output_path);
+
+// Lowers the SSA form of a file to bytecode and then to native code, and writes its object next to its executable, giving
+// the path of the object. The caller frees it
+char* write_native_object(rouleaux_context* context, const ssa_program* ssa, const char* output_path);
+
+// Links the object into the executable with the system's C compiler, which links in the C library
+b8 link_native_object(const char* compiler, const char* object_path, const char* output_path);
+
+// Runs the system's C compiler with a command made from format, the compiler, the output path and the input path
+b8 run_compiler(const char* format, const char* compiler, const char* output_path, const char* input_path);
+
+int main(int argc, char** argv)
+{
+    // The options come before the file
+    b8 emit_c = false;
+    b8 native = false;
+    b8 emit_object = false;
+    const char* compiler = getenv("CC");
+    const char* output_path = NULL;
+    int first_argument = 1;
+    while (first_argument < argc && strncmp(argv[first_argument], "-", 1) == 0)
+    {
+        // The C can be kept instead of compiled, to build it elsewhere
+        if (strcmp(argv[first_argument], "--emit-c") == 0)
+            emit_c = true;
+        // The native backend writes the machine code itself, the C compiler only links it
+        else if (strcmp(argv[first_argument], "--native") == 0)
+            native = true;
+        else if (strcmp(argv[first_argument], "--emit-object") == 0)
+            native = emit_object = true;
+        else if (strcmp(argv[first_argument], "--cc") == 0 && first_argument + 1 < argc)
+            compiler = argv[++first_argument];
+        else if (strcmp(argv[first_argument], "-o") == 0 && first_argument + 1 < argc)
+            output_path = argv[++first_argument];
+        else
+            return print_usage(argv[0]);
+
+        first_argument++;
+    }
+
+    if (argc <= first_argument)
+        return print_usage(argv[0]);
+
+    const char* filename = argv[first_argument];
+    const char* entry_point = (argc > first_argument + 1) ? argv[first_argument + 1] : NULL;
+    if (compiler == NULL || compiler[0] == '\0')
+        compiler = DEFAULT_C_COMPILER;
+
+    char* default_output = output_path ? NULL : default_output_path(filename);
+    if (output_path == NULL)
+        output_path = default_output;
+
+    int return_code = 0;
+    ssa_program ssa = {};
+    c_source source = {};
+    char* c_path = NULL;
+    char* object_path = NULL;
+
+    rouleaux_jobs* jobs = jobs_create((jobs_options){});
+
+    rouleaux_context context;
+    context_create(&context, (rouleaux_context_options){
+        .comment_mode = COMMENT_MODE_DISCARD, // The generated code has no use for comments
+        .jobs = jobs,
+    });
+
+    symbol_table sym_table = symbol_table_create();
+
+    rouleaux_parser parser = context_create_parser(&context, filename);
+    ast_node* ast = parser.has_error ? NULL : context_parse_file(&context, &parser);
+
+    // With an entry point only the declarations it can reach are type checked, and only those are compiled
+    b8 typed = false;
+    if (ast)
+        typed = entry_point ? context_resolve_reachable_types(&context, ast, &sym_table, entry_point) : context_resolve_types(&context, ast, &sym_table);
+
+    // Both backends lower the same optimized SSA form
+    b8 built = typed && ssa_build(&context, ast, entry_point, &ssa);
+
+    // The SSA passes leave a program they had no memory for correct, so it is still lowered
+    if (built)
+        ssa_optimize(&ssa);
+
+    if (built && native)
+    {
+        object_path = write_native_object(&context, &ssa, output_path);
+        if (object_path == NULL)
+        {
+            // Without a diagnostic the program was lowered, but its object could not be written
+            if (context.diagnostic_count == 0)
+                printf("Unable to write the object for '%s'\n", filename);
+
+            print_diagnostics(&context);
+
+            return_code = 1;
+            goto cleanup;
+        }
+
+        if (emit_object)
+            goto cleanup;
+
+        if (!link_native_object(compiler, object_path, output_path))
+        {
+            printf("'%s' could not link the object, it was kept in '%s'\n", compiler, object_path);
+
+            return_code = 1;
+            goto cleanup;
+        }
+
+        remove(object_path);
+        goto cleanup;
+    }
+
+    if (!built || !c_backend_generate(&context, &ssa, &source))
+    {
+        print_diagnostics(&context);
+
+        return_code = 1;
+        goto cleanup;
+    }
+
+    if (output_path == NULL || (c_path = write_c_source(output_path, &source)) == NULL)
+    {
+        printf("Unable to write the generated C for '%s'\n", filename);
+
+        return_code = 1;
+        goto cleanup;
+    }
+
+    if (emit_c)
+        goto cleanup;
+
+    if (!compile_c_source(compiler, c_path, output_path))
+    {
+        printf("'%s' could not compile the generated C, it was kept in '%s'\n", compiler, c_path);
+
+        return_code = 1;
+        goto cleanup;
+    }
+
+    remove(c_path);
+
+cleanup:
+    free(c_path);
+    free(object_path);
+    free(default_output);
+    c_source_destroy(&source);
+    ssa_program_destroy(&ssa);
+    parser_destroy_ast_node(&parser, ast);
+    symbol_table_destroy(&sym_table);
+    parser_destroy(&parser);
+    context_destroy(&context);
+    jobs_destroy(jobs);
+
+    return return_code;
+}
+
+int print_usage(const char* program_name)
+{
+    printf("%s [--emit-c] [--native] [--emit-object] [--cc compiler] [-o output] rouleaux_file [entry_point]", program_name);
+    return 1;
+}
+
+void print_diagnostics(rouleaux_context* context)
+{
+    char* error_text = context_diagnostics_text(context, calloc);
+    if (error_text)
+        printf("%s", error_text);
+    free(error_text);
+}
+
+char* default_output_path(const char* filename)
+{
+    // Only an extension of the file's own name is removed, not a dot in one of its directories
+    u64 length = strlen(filename);
+    const char* extension = strrchr(filename, '.');
+    const char* separator = strrchr(filename, '/');
+    const char* windows_separator = strrchr(filename, '\\');
+    if (windows_separator > separator)
+        separator = windows_separator;
+
+    if (extension != NULL && extension > filename && (separator == NULL || extension > separator + 1))
+        length = (u64)(extension - filename);
+
+#ifdef _WIN32
+    const char* executable_extension = ".exe";
+#else
+    const char* executable_extension = "";
+#endif
+
+    u64 capacity = length + strlen(executable_extension) + 1;
+    char* output_path = malloc(capacity);
+    if (output_path == NULL)
+        return NULL;
+
+    snprintf(output_path, capacity, "%.*s%s", (int)length, filename, executable_extension);
+    return output_path;
+}
+
+char* write_c_source(const char* output_path, const c_source* source)
+{
+    u64 capacity = strlen(output_path) + sizeof(".c");
+    char* c_path = malloc(capacity);
+    if (c_path == NULL)
+        return NULL;
+
+    snprintf(c_path, capacity, "%s.c", output_path);
+
+    FILE* file = fopen(c_path, "wb");
+    if (file == NULL)
+    {
+        free(c_path);
+        return NULL;
+    }
+
+    b8 written = fwrite(source->text, 1, source->length, file) == source->length;
+    written = (fclose(file) == 0) && written;
+    if (!written)
+    {
+        remove(c_path);
+        free(c_path);
+        return NULL;
+    }
+
+    return c_path;
+}
+
+b8 compile_c_source(const char* compiler, const char* c_path, const char* output_path)
+{
+    // The paths are quoted for the shell, a path with a quote in it is not supported
+#ifdef _WIN32
+    const char* format = "%s -O2 -o \"%s\" \"%s\"";
+#else
+    const char* format = "%s -O2 -o \"%s\" \"%s\" -lm";
+#endif
+
+    return run_compiler(format, compiler, output_path, c_path);
+}
+
+char* write_native_object(rouleaux_context* context, const ssa_program* ssa, const char* output_path)
+{
+    if (output_path == NULL)
+        return NULL;
+
+    // The native backend lowers the bytecode the vm runs, after the same optimizations
+    bytecode_program program = {};
+    elf_object object = {};
+    char* object_path = NULL;
+
+    b8 generated = bytecode_compile(context, ssa, &program);
+    if (generated)
+    {
+        bytecode_optimize(&program);
+        generated = native_backend_generate(context, &program, &object);
+    }
+
+    u64 capacity = strlen(output_path) + sizeof(".o");
+    if (generated && (object_path = malloc(capacity)) != NULL)
+    {
+        snprintf(object_path, capacity, "%s.o", output_path);
+        if (!elf_object_write(&object, object_path))
+        {
+            free(object_path);
+            object_path = NULL;
+        }
+    }
+
+    elf_object_destroy(&object);
+    bytecode_program_destroy(&program);
+    return object_path;
+}
+
+b8 link_native_object(const char* compiler, const char* object_path, const char* output_path)
+{
+    // Only the addresses in rlx_functions are absolute, the linker relocates them when the executable loads
+    return run_compiler("%s -o \"%s\" \"%s\" -lm", compiler, output_path, object_path);
+}
+
+b8 run_compiler(const char* format, const char* compiler, const char* output_path, const char* input_path)
+{
+    int length = snprintf(NULL, 0, format, compiler, output_path, input_path);
+    if (length < 0)
+        return false;
+
+    char* command = malloc((u64)length + 1);
+    if (command == NULL)
+        return false;
+
+    snprintf(command, (u64)length + 1, format, compiler, output_path, input_path);
+    int status = system(command);
+    free(command);
+
+    return status == 0;
+}
@@ -0,0 +1,1585 @@
+#include "native_backend.h"
+#include "register_allocator.h"
+#include "runtime_errors.h"
+
+#include <malloc.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+// rbx holds the registers of the call, it is callee saved so it survives the calls of the C library. rax,
+// rcx, rdx, rdi, r8, xmm0 and xmm1 are the scratch registers of the code, register_allocate() hands out the
+// others to the registers of the vm
+
+// The bytes of an entry of rlx_functions: the address of the function, the address of its name, and the size of its registers
+#define NATIVE_FUNCTION_ENTRY_SIZE 32
+#define NATIVE_FUNCTION_ENTRY_SHIFT 5
+
+// The most registers zeroed with a mov each when a function starts, more are zeroed with rep stosq
+#define NATIVE_MAX_UNROLLED_ZEROING 8
+
+// Marks a constant whose string was not written to .rodata yet, a register not known to hold a single function, and a
+// register nothing has written yet
+#define NATIVE_NOT_WRITTEN ((u64)-1)
+#define NATIVE_UNKNOWN_FUNCTION ((u64)-1)
+#define NATIVE_UNWRITTEN_REGISTER ((u64)-2)
+// Passed for the operand read after the result of an instruction is written, when it reads none
+#define NATIVE_NO_OPERAND ((u64)-1)
+
+/**
+ * @brief The cold code of an instruction which can fail at runtime, written after the code of its function
+ */
+typedef struct native_stub {
+    /* The jumps to the stub, a call checks both the depth of the calls and the room for its registers */
+    u64 positions[2];
+    /* The amount of positions */
+    u64 position_count;
+
+    /* The text reported, for a stack overflow the part before the name of the called function */
+    u64 text;
+    /* Set for a stack overflow, the name of the function and the rest of the text follow the text */
+    b8 is_stack_overflow;
+    /* The rest of the text of a stack overflow, after the name of the called function */
+    u64 text_after_name;
+    /* The called function, NATIVE_UNKNOWN_FUNCTION if it is only known once the program runs */
+    u64 callee;
+} native_stub;
+
+/**
+ * @brief The state of lowering a whole program
+ */
+typedef struct native_backend {
+    /* The context errors are reported to */
+    rouleaux_context* context;
+    /* The program being lowered */
+    const bytecode_program* program;
+    /* The object the code and data are written into */
+    elf_object* object;
+    /* Renders the texts of the runtime errors */
+    runtime_error_renderer renderer;
+
+    /* The offset into .text of each of the program's functions */
+    u64* function_offsets;
+    /* The offset into .rodata of each string constant, NATIVE_NOT_WRITTEN until a function loads it */
+    u64* constant_offsets;
+    /* The offset into .rodata of the name of each function */
+    u64* function_names;
+    /* The function each global always holds, NATIVE_UNKNOWN_FUNCTION for most of them. Known once the top level code is lowered */
+    u64* global_functions;
+    /* The direct calls of every function, patched once every function was written */
+    x86_patch* calls;
+    /* The amount of calls */
+    u64 call_count;
+    /* The amount of calls the calls array can hold */
+    u64 call_capacity;
+
+    /* The offset into .text of the routine printing a runtime error, it is called with its text in rdi */
+    u64 runtime_error_offset;
+    /* The offset into .text of the routine printing a stack overflow, it is called with the parts of its text in rdi, rsi, rdx */
+    u64 stack_overflow_offset;
+    /* The offset into .data of rlx_functions, the table of every function a function value can be */
+    u64 functions_table_offset;
+    /* The offset into .bss of the registers, the globals are the first ones */
+    u64 registers_offset;
+    /* The offset into .bss of the amount of calls being run */
+    u64 call_depth_offset;
+
+    /* The symbols of the functions of the C library */
+    u32 printf_symbol;
+    u32 exit_symbol;
+    u32 fmod_symbol;
+
+    /* Set once an error was reported, nothing else is lowered after it */
+    b8 has_error;
+} native_backend;
+
+/**
+ * @brief The state of lowering a single function
+ */
+typedef struct native_emitter {
+    /* The program being lowered */
+    native_backend* backend;
+    /* The function being lowered */
+    const bytecode_function* function;
+    /* The index of the function in the program */
+    u64 function_index;
+
+    /* The offset into .text of the code of each instruction */
+    u64* instruction_offsets;
+    /* The jumps to patch, a single instruction needs at most two */
+    x86_patch* jumps;
+    /* The amount of jumps */
+    u64 jump_count;
+    /* The stubs of the instructions which can fail */
+    native_stub* stubs;
+    /* The amount of stubs */
+    u64 stub_count;
+
+    /* The function each register always holds when it is called, NATIVE_UNKNOWN_FUNCTION for most of them */
+    u64* known_functions;
+    /* Where each register of the function lives, and the interval it is live in */
+    register_allocation allocation;
+    /* The amount of callee saved registers pushed after rbx */
+    u64 saved_register_count;
+} native_emitter;
+
+// Writes the routines every function reports its runtime errors through
+static void emit_runtime(native_backend* backend);
+
+// Lowers a function of the program
+static void emit_function(native_backend* backend, u64 function_index);
+
+// Writes main(), which runs the top level code and prints the globals
+static void emit_main(native_backend* backend);
+
+// Writes rlx_functions, and points the direct calls at their functions
+static void finish_object(native_backend* backend);
+
+// Finds the globals a function other than the top level code writes, those are never known to hold a single function
+static void find_written_globals(native_backend* backend);
+
+// Finds the registers of a function which only ever hold one function, so calling them needs no lookup
+static void find_known_functions(native_emitter* emitter);
+
+// Emits the native code of the instruction at index
+static void emit_instruction(native_emitter* emitter, bytecode_instruction instruction, u64 index);
+
+// Emits a call of the function in register b, with its registers starting at register c
+static void emit_call(native_emitter* emitter, bytecode_instruction instruction, u64 index);
+
+// Emits the stores of the registers held in caller saved registers across the call at index, or their loads after it
+static void emit_spanning_registers(native_emitter* emitter, u64 index, b8 is_load);
+
+// Emits an integer division or modulus, which reports a division by zero and gives the vm's results for -1
+static void emit_division(native_emitter* emitter, bytecode_instruction instruction, u64 index);
+
+// Emits the code starting a function: it saves the registers it uses, loads its parameters and zeros its registers
+static void emit_prologue(native_emitter* emitter);
+
+// Emits the code restoring the saved registers and returning
+static void emit_epilogue(native_emitter* emitter);
+
+// Emits the code zeroing the registers of a call after its parameters which can be read before they are written, like the vm does
+static void emit_zero_registers(native_emitter* emitter);
+
+// Emits the stubs of the function after its code
+static void emit_stubs(native_emitter* emitter);
+
+// Adds a stub for a runtime error of the instruction at index, the jump to it is added by emit_jump_to_stub()
+static native_stub* add_stub(native_emitter* emitter, u64 index, diagnostic_id id, ...);
+
+// Emits a jcc to a stub
+static void emit_jump_to_stub(native_emitter* emitter, native_stub* stub, u8 condition);
+
+// Emits a jump (or a jcc for a condition code) to the instruction at target
+static void emit_jump(native_emitter* emitter, u8 condition, u64 target);
+
+// Emits an instruction with a register of the call as its memory operand: [prefix] [REX] opcode ModRM disp
+static void emit_vm_operand(native_emitter* emitter, u8 prefix, u8 rex, u16 opcode, u8 x86_register, u64 vm_register);
+
+// Emits an instruction with two registers as its operands: [prefix] [REX] opcode ModRM
+static void emit_register_operand(native_emitter* emitter, u8 prefix, u8 rex, u16 opcode, u8 x86_register, u8 rm_register);
+
+// Emits an instruction with a register of the vm as its source operand, in memory or in an x86-64 register of its class
+static void emit_integer_source(native_emitter* emitter, u16 opcode, u8 x86_register, u64 vm_register);
+static void emit_float_source(native_emitter* emitter, u8 prefix, u16 opcode, u8 xmm_register, u64 vm_register);
+
+// Emits a copy of a register of the vm into a general purpose or an xmm register, or back from one, wherever it lives
+static void emit_load_integer(native_emitter* emitter, u8 x86_register, u64 vm_register);
+static void emit_store_integer(native_emitter* emitter, u8 x86_register, u64 vm_register);
+static void emit_load_float(native_emitter* emitter, u8 xmm_register, u64 vm_register);
+static void emit_store_float(native_emitter* emitter, u8 xmm_register, u64 vm_register);
+
+// Emits a mov of a 64 bit value into a general purpose register
+static void emit_load_immediate(native_emitter* emitter, u8 x86_register, u64 value);
+
+// Gives the register an instruction computes its result in, the one holding the result unless the operand read after
+// it is written is in there too, rax (or xmm0) then
+static u8 integer_destination(native_emitter* emitter, u64 result, u64 operand);
+static u8 float_destination(native_emitter* emitter, u64 result, u64 operand);
+
+// Swaps b and c of an addition or a multiplication when c is where a is, so the result can be computed in there
+static void swap_operands(native_emitter* emitter, bytecode_instruction* instruction);
+
+// Emits an instruction with a RIP relative memory operand into a section, the linker fills in the distance to it
+static void emit_section_operand(native_backend* backend, u8 prefix, u8 rex, u16 opcode, u8 x86_register, elf_section section, u64 offset);
+
+// Emits a comparison's 0 or 1 from the flags, into the register as an integer or a float
+static void emit_comparison_result(native_emitter* emitter, u8 condition, b8 is_float, u64 vm_register);
+
+// Emits a call of a function of the C library
+static void emit_library_call(native_backend* backend, u32 symbol);
+
+// Emits a call of code already written to .text
+static void emit_local_call(native_backend* backend, u64 offset);
+
+// Emits a call of a function of the program, which may not be written to .text yet
+static void emit_function_call(native_backend* backend, u64 function_index, token t);
+
+// Writes a string to .rodata, giving its offset
+static u64 add_rodata_string(native_backend* backend, const char* text, u64 length);
+
+// Emits raw bytes
+static void emit_bytes(native_backend* backend, const u8* bytes, u64 count);
+
+// Emits a little endian 32 bit value
+static void emit_u32(native_backend* backend, u32 value);
+
+// Writes a 32 bit value over bytes already emitted
+static void patch_u32(native_backend* backend, u64 position, u32 value);
+
+// Reports an error to the context, only the first one is reported
+static void backend_error(native_backend* backend, token t, diagnostic_id id, ...);
+
+
+b8 native_backend_generate(rouleaux_context* context, const bytecode_program* program, elf_object* out_object)
+{
+    *out_object = elf_object_create();
+
+    native_backend backend = {};
+    backend.context = context;
+    backend.program = program;
+    backend.object = out_object;
+    backend.renderer.context = context;
+
+    u64 function_count = program->function_count;
+    backend.function_offsets = calloc(function_count + 1, sizeof(u64));
+    backend.function_names = calloc(function_count + 1, sizeof(u64));
+    backend.constant_offsets = malloc((program->constant_count + 1) * sizeof(u64));
+    backend.global_functions = malloc((program->global_count + 1) * sizeof(u64));
+    if (backend.function_offsets == NULL || backend.function_names == NULL || backend.constant_offsets == NULL || backend.global_functions == NULL)
+        backend_error(&backend, (token){}, DIAGNOSTIC_CODE_GENERATION_ALLOCATION);
+
+    for (u64 i = 0; i < program->constant_count && !backend.has_error; ++i)
+        backend.constant_offsets[i] = NATIVE_NOT_WRITTEN;
+
+    if (!backend.has_error)
+        find_written_globals(&backend);
+
+    if (!backend.has_error)
+    {
+        // The registers of every call and the amount of calls, like the vm has
+        backend.registers_offset = elf_object_append(out_object, ELF_SECTION_BSS, NULL, DEFAULT_VM_REGISTER_COUNT * sizeof(bytecode_value));
+        backend.call_depth_offset = elf_object_append(out_object, ELF_SECTION_BSS, NULL, sizeof(u64));
+        elf_object_add_symbol(out_object, (elf_symbol){ .name = "rlx_registers", .section = ELF_SECTION_BSS, .offset = backend.registers_offset, .size = DEFAULT_VM_REGISTER_COUNT * sizeof(bytecode_value) });
+
+        // The table is filled in once every function was written, the code only needs to know where it is
+        backend.functions_table_offset = elf_object_append(out_object, ELF_SECTION_DATA, NULL, function_count * NATIVE_FUNCTION_ENTRY_SIZE);
+        elf_object_add_symbol(out_object, (elf_symbol){ .name = "rlx_functions", .section = ELF_SECTION_DATA, .offset = backend.functions_table_offset, .size = function_count * NATIVE_FUNCTION_ENTRY_SIZE });
+
+        backend.printf_symbol = elf_object_add_symbol(out_object, (elf_symbol){ .name = "printf", .section = ELF_SECTION_UNDEFINED, .is_global = true });
+        backend.exit_symbol = elf_object_add_symbol(out_object, (elf_symbol){ .name = "exit", .section = ELF_SECTION_UNDEFINED, .is_global = true });
+        backend.fmod_symbol = elf_object_add_symbol(out_object, (elf_symbol){ .name = "fmod", .section = ELF_SECTION_UNDEFINED, .is_global = true });
+
+        emit_runtime(&backend);
+    }
+
+    for (u64 i = 0; i < function_count && !backend.has_error; ++i)
+        emit_function(&backend, i);
+
+    if (!backend.has_error)
+        emit_main(&backend);
+
+    if (!backend.has_error)
+        finish_object(&backend);
+
+    if (out_object->has_error && !backend.has_error)
+        backend_error(&backend, (token){}, DIAGNOSTIC_CODE_GENERATION_ALLOCATION);
+
+    free(backend.function_offsets);
+    free(backend.function_names);
+    free(backend.constant_offsets);
+    free(backend.global_functions);
+    free(backend.calls);
+    runtime_error_renderer_destroy(&backend.renderer);
+
+    return !backend.has_error;
+}
+
+
+
+void emit_runtime(native_backend* backend)
+{
+    elf_object* object = backend->object;
+    u64 format = add_rodata_string(backend, "%s", 2);
+    u64 stack_overflow_format = add_rodata_string(backend, "%s%s%s", 6);
+
+    // Both routines are entered with the stack 8 bytes off its 16 byte alignment, which the sub rsp fixes for printf()
+    const u8 align_stack[] = { 0x48, 0x83, 0xEC, 0x08 };
+    const u8 exit_code[] = { 0xBF, 0x01, 0x00, 0x00, 0x00 };
+    const u8 no_vector_arguments[] = { 0x31, 0xC0 };
+
+    // rlx_runtime_error: printf("%s", text); exit(1)
+    backend->runtime_error_offset = elf_object_align(object, ELF_SECTION_TEXT, 16);
+    const u8 move_text[] = { 0x48, 0x89, 0xFE };
+    emit_bytes(backend, align_stack, sizeof(align_stack));
+    emit_bytes(backend, move_text, sizeof(move_text));
+    emit_section_operand(backend, 0, X86_REX_W, X86_LEA, X86_RDI, ELF_SECTION_RODATA, format);
+    emit_bytes(backend, no_vector_arguments, sizeof(no_vector_arguments));
+    emit_library_call(backend, backend->printf_symbol);
+    emit_bytes(backend, exit_code, sizeof(exit_code));
+    emit_library_call(backend, backend->exit_symbol);
+    elf_object_add_symbol(object, (elf_symbol){ .name = "rlx_runtime_error", .section = ELF_SECTION_TEXT, .offset = backend->runtime_error_offset, .size = object->sections[ELF_SECTION_TEXT].length - backend->runtime_error_offset, .is_function = true });
+
+    // rlx_stack_overflow: printf("%s%s%s", before_name, name, after_name); exit(1)
+    backend->stack_overflow_offset = elf_object_align(object, ELF_SECTION_TEXT, 16);
+    const u8 move_texts[] = { 0x48, 0x89, 0xD1, 0x48, 0x89, 0xF2, 0x48, 0x89, 0xFE };
+    emit_bytes(backend, align_stack, sizeof(align_stack));
+    emit_bytes(backend, move_texts, sizeof(move_texts));
+    emit_section_operand(backend, 0, X86_REX_W, X86_LEA, X86_RDI, ELF_SECTION_RODATA, stack_overflow_format);
+    emit_bytes(backend, no_vector_arguments, sizeof(no_vector_arguments));
+    emit_library_call(backend, backend->printf_symbol);
+    emit_bytes(backend, exit_code, sizeof(exit_code));
+    emit_library_call(backend, backend->exit_symbol);
+    elf_object_add_symbol(object, (elf_symbol){ .name = "rlx_stack_overflow", .section = ELF_SECTION_TEXT, .offset = backend->stack_overflow_offset, .size = object->sections[ELF_SECTION_TEXT].length - backend->stack_overflow_offset, .is_function = true });
+}
+
+void emit_function(native_backend* backend, u64 function_index)
+{
+    elf_object* object = backend->object;
+    const bytecode_function* function = &backend->program->functions[function_index];
+
+    native_emitter emitter = {};
+    emitter.backend = backend;
+    emitter.function = function;
+    emitter.function_index = function_index;
+    emitter.instruction_offsets = malloc((function->code_length + 1) * sizeof(u64));
+    emitter.jumps = malloc((function->code_length * 2 + 1) * sizeof(x86_patch));
+    emitter.stubs = malloc((function->code_length + 1) * sizeof(native_stub));
+    emitter.known_functions = malloc(((u64)function->register_count + 1) * sizeof(u64));
+    if (emitter.instruction_offsets == NULL || emitter.jumps == NULL || emitter.stubs == NULL || emitter.known_functions == NULL)
+        backend_error(backend, function->name, DIAGNOSTIC_CODE_GENERATION_ALLOCATION);
+
+    backend->function_names[function_index] = add_rodata_string(backend, function->name.text, function->name.length);
+
+    if (!backend->has_error && !register_allocate(backend->program, function_index, &emitter.allocation))
+        backend_error(backend, function->name, DIAGNOSTIC_CODE_GENERATION_ALLOCATION);
+
+    if (!backend->has_error)
+    {
+        find_known_functions(&emitter);
+
+        u64 start = elf_object_align(object, ELF_SECTION_TEXT, 16);
+        backend->function_offsets[function_index] = start;
+        emit_prologue(&emitter);
+
+        for (u64 i = 0; i < function->code_length && !backend->has_error; ++i)
+        {
+            emitter.instruction_offsets[i] = object->sections[ELF_SECTION_TEXT].length;
+            emit_instruction(&emitter, function->code[i], i);
+        }
+
+        for (u64 i = 0; i < emitter.jump_count && !backend->has_error; ++i)
+        {
+            x86_patch jump = emitter.jumps[i];
+            patch_u32(backend, jump.position, (u32)x86_relative_offset(jump.position, emitter.instruction_offsets[jump.target]));
+        }
+
+        emit_stubs(&emitter);
+
+        char name[64];
+        snprintf(name, sizeof(name), "rlx_function_%llu", function_index);
+        elf_object_add_symbol(object, (elf_symbol){ .name = name, .section = ELF_SECTION_TEXT, .offset = start, .size = object->sections[ELF_SECTION_TEXT].length - start, .is_function = true });
+    }
+
+    free(emitter.instruction_offsets);
+    free(emitter.jumps);
+    free(emitter.stubs);
+    free(emitter.known_functions);
+    register_allocation_destroy(&emitter.allocation);
+}
+
+void emit_main(native_backend* backend)
+{
+    elf_object* object = backend->object;
+    const bytecode_program* program = backend->program;
+
+    // push rbx, to align the stack for the calls
+    u64 start = elf_object_align(object, ELF_SECTION_TEXT, 16);
+    const u8 push_rbx = 0x53;
+    emit_bytes(backend, &push_rbx, 1);
+
+    // The top level code runs in the first registers, where it leaves the globals
+    emit_section_operand(backend, 0, X86_REX_W, X86_LEA, X86_RDI, ELF_SECTION_BSS, backend->registers_offset);
+    emit_function_call(backend, 0, program->functions[0].name);
+
+    // The globals are printed the way roulx prints them
+    const char* formats[MAX_TYPE_INFOS] = {
+        [TYPE_INFO_UNKNOWN]  = "<function>\n",
+        [TYPE_INFO_INTEGER]  = "%lld\n",
+        [TYPE_INFO_FLOAT]    = "%lf\n",
+        [TYPE_INFO_STRING]   = "\"%s\"\n",
+        [TYPE_INFO_FUNCTION] = "<function>\n",
+    };
+
+    u64 format_offsets[MAX_TYPE_INFOS] = {};
+    for (u64 i = 0; i < MAX_TYPE_INFOS; ++i)
+        format_offsets[i] = add_rodata_string(backend, formats[i], strlen(formats[i]));
+
+    const u8 no_vector_arguments[] = { 0x31, 0xC0 };
+    const u8 one_vector_argument[] = { 0xB8, 0x01, 0x00, 0x00, 0x00 };
+    u64 header = add_rodata_string(backend, "Symbol Table:\n", 14);
+    u64 name_format = add_rodata_string(backend, "\t%s = ", 6);
+
+    emit_section_operand(backend, 0, X86_REX_W, X86_LEA, X86_RDI, ELF_SECTION_RODATA, header);
+    emit_bytes(backend, no_vector_arguments, sizeof(no_vector_arguments));
+    emit_library_call(backend, backend->printf_symbol);
+
+    for (u64 i = 0; i < program->global_count; ++i)
+    {
+        const bytecode_global* global = &program->globals[i];
+        u64 name = add_rodata_string(backend, global->name.text, global->name.length);
+        u64 value = backend->registers_offset + i * sizeof(bytecode_value);
+
+        emit_section_operand(backend, 0, X86_REX_W, X86_LEA, X86_RDI, ELF_SECTION_RODATA, name_format);
+        emit_section_operand(backend, 0, X86_REX_W, X86_LEA, X86_RSI, ELF_SECTION_RODATA, name);
+        emit_bytes(backend, no_vector_arguments, sizeof(no_vector_arguments));
+        emit_library_call(backend, backend->printf_symbol);
+
+        type_info type = (global->type < MAX_TYPE_INFOS) ? global->type : TYPE_INFO_UNKNOWN;
+        emit_section_operand(backend, 0, X86_REX_W, X86_LEA, X86_RDI, ELF_SECTION_RODATA, format_offsets[type]);
+        if (type == TYPE_INFO_FLOAT)
+        {
+            // A float is passed in xmm0, al holds the amount of vector registers a variadic function is given
+            emit_section_operand(backend, 0xF2, 0, X86_MOVSD_LOAD, X86_XMM0, ELF_SECTION_BSS, value);
+            emit_bytes(backend, one_vector_argument, sizeof(one_vector_argument));
+        }
+        else
+        {
+            if (type == TYPE_INFO_INTEGER || type == TYPE_INFO_STRING)
+                emit_section_operand(backend, 0, X86_REX_W, X86_MOV_LOAD, X86_RSI, ELF_SECTION_BSS, value);
+
+            emit_bytes(backend, no_vector_arguments, sizeof(no_vector_arguments));
+        }
+
+        emit_library_call(backend, backend->printf_symbol);
+    }
+
+    // return 0
+    const u8 epilogue[] = { 0x31, 0xC0, 0x5B, 0xC3 };
+    emit_bytes(backend, epilogue, sizeof(epilogue));
+
+    elf_object_add_symbol(object, (elf_symbol){ .name = "main", .section = ELF_SECTION_TEXT, .offset = start, .size = object->sections[ELF_SECTION_TEXT].length - start, .is_function = true, .is_global = true });
+}
+
+void finish_object(native_backend* backend)
+{
+    elf_object* object = backend->object;
+    const bytecode_program* program = backend->program;
+
+    // Each entry of rlx_functions: the address of the function, the address of its name and the size of its registers
+    for (u64 i = 0; i < program->function_count; ++i)
+    {
+        u64 entry = backend->functions_table_offset + i * NATIVE_FUNCTION_ENTRY_SIZE;
+        elf_object_add_relocation(object, (elf_relocation){ ELF_SECTION_DATA, entry, ELF_R_X86_64_64, ELF_SECTION_TEXT, (i64)backend->function_offsets[i] });
+        elf_object_add_relocation(object, (elf_relocation){ ELF_SECTION_DATA, entry + 8, ELF_R_X86_64_64, ELF_SECTION_RODATA, (i64)backend->function_names[i] });
+
+        u64 register_bytes = (u64)program->functions[i].register_count * sizeof(bytecode_value);
+        memcpy(object->sections[ELF_SECTION_DATA].bytes + entry + 16, &register_bytes, sizeof(u64));
+    }
+
+    // Every function is in .text now, so the direct calls can be pointed at them without the linker
+    for (u64 i = 0; i < backend->call_count; ++i)
+    {
+        x86_patch call = backend->calls[i];
+        patch_u32(backend, call.position, (u32)x86_relative_offset(call.position, backend->function_offsets[call.target]));
+    }
+}
+
+void find_written_globals(native_backend* backend)
+{
+    const bytecode_program* program = backend->program;
+    for (u64 i = 0; i < program->global_count; ++i)
+        backend->global_functions[i] = NATIVE_UNWRITTEN_REGISTER;
+
+    for (u64 i = 0; i < program->function_count; ++i)
+    {
+        const bytecode_function* function = &program->functions[i];
+        for (u64 j = 0; j < function->code_length; ++j)
+        {
+            if (function->code[j].opcode == OPCODE_SET_GLOBAL)
+                backend->global_functions[function->code[j].index] = NATIVE_UNKNOWN_FUNCTION;
+        }
+    }
+}
+
+void find_known_functions(native_emitter* emitter)
+{
+    native_backend* backend = emitter->backend;
+    const bytecode_function* function = emitter->function;
+    const bytecode_program* program = backend->program;
+    u64* known = emitter->known_functions;
+    b8 is_top_level = emitter->function_index == 0;
+
+    // A register is only known to hold a function if the one thing writing it is loading that function. Registers
+    // start out zero, but the compiler always loads the callee of a call right before it. The parameters are
+    // written by the caller. The globals are the first registers of the top level code, which only it writes
+    // unless find_written_globals() found another function writing them
+    for (u64 i = 0; i < function->register_count; ++i)
+    {
+        known[i] = (i < function->parameter_count) ? NATIVE_UNKNOWN_FUNCTION : NATIVE_UNWRITTEN_REGISTER;
+        if (is_top_level && i < program->global_count)
+            known[i] = backend->global_functions[i];
+    }
+
+    for (u64 i = 0; i < function->code_length; ++i)
+    {
+        bytecode_instruction instruction = function->code[i];
+        switch (instruction.opcode)
+        {
+            case OPCODE_LOAD_CONSTANT:
+            {
+                b8 is_function = program->constant_types[instruction.index] == TYPE_INFO_FUNCTION;
+                u64 value = is_function ? program->constants[instruction.index].function : NATIVE_UNKNOWN_FUNCTION;
+                known[instruction.a] = (known[instruction.a] == NATIVE_UNWRITTEN_REGISTER) ? value : NATIVE_UNKNOWN_FUNCTION;
+                break;
+            }
+            case OPCODE_GET_GLOBAL:
+            {
+                // The top level code is lowered first, so what the global holds is already known
+                u64 value = is_top_level ? NATIVE_UNKNOWN_FUNCTION : backend->global_functions[instruction.index];
+                known[instruction.a] = (known[instruction.a] == NATIVE_UNWRITTEN_REGISTER) ? value : NATIVE_UNKNOWN_FUNCTION;
+                break;
+            }
+            case OPCODE_SET_GLOBAL:
+            case OPCODE_JUMP:
+            case OPCODE_JUMP_IF_FALSE_I64:
+            case OPCODE_JUMP_IF_FALSE_F64:
+            case OPCODE_JUMP_IF_FALSE_STRING:
+            case OPCODE_JUMP_IF_TRUE_I64:
+            case OPCODE_JUMP_IF_TRUE_F64:
+            case OPCODE_JUMP_IF_TRUE_STRING:
+            case OPCODE_RETURN:
+            case OPCODE_JUMP_IF_LESS_I64:
+            case OPCODE_JUMP_IF_LESS_F64:
+            case OPCODE_JUMP_IF_NOT_LESS_I64:
+            case OPCODE_JUMP_IF_NOT_LESS_F64:
+            case OPCODE_JUMP_IF_GREATER_I64:
+            case OPCODE_JUMP_IF_GREATER_F64:
+            case OPCODE_JUMP_IF_NOT_GREATER_I64:
+            case OPCODE_JUMP_IF_NOT_GREATER_F64:
+            {
+                // Writes none of the registers
+                break;
+            }
+            case OPCODE_CALL:
+            {
+                // The registers of the called function start at c, it overwrites them
+                for (u64 j = instruction.c; j < function->register_count; ++j)
+                    known[j] = NATIVE_UNKNOWN_FUNCTION;
+
+                known[instruction.a] = NATIVE_UNKNOWN_FUNCTION;
+                break;
+            }
+            default:
+            {
+                // Everything else writes a
+                known[instruction.a] = NATIVE_UNKNOWN_FUNCTION;
+                break;
+            }
+        };
+    }
+
+    // A register nothing writes stays zero, calling it is left to rlx_functions like any other
+    for (u64 i = 0; i < function->register_count; ++i)
+    {
+        if (known[i] == NATIVE_UNWRITTEN_REGISTER)
+            known[i] = NATIVE_UNKNOWN_FUNCTION;
+    }
+
+    if (is_top_level)
+    {
+        for (u64 i = 0; i < program->global_count; ++i)
+            backend->global_functions[i] = (i < function->register_count) ? known[i] : NATIVE_UNKNOWN_FUNCTION;
+    }
+}
+
+void emit_instruction(native_emitter* emitter, bytecode_instruction instruction, u64 index)
+{
+    native_backend* backend = emitter->backend;
+    const bytecode_program* program = backend->program;
+    const u8* locations = emitter->allocation.locations;
+    u64 target = index + 1 + instruction.offset;
+    u64 short_target = index + 1 + instruction.short_offset;
+
+    switch (instruction.opcode)
+    {
+        case OPCODE_LOAD_CONSTANT:
+        {
+            bytecode_value value = program->constants[instruction.index];
+            u8 location = locations[instruction.a];
+            if (program->constant_types[instruction.index] == TYPE_INFO_STRING)
+            {
+                // A string is written to .rodata the first time it is loaded, the code loads its address
+                u64* offset = &backend->constant_offsets[instruction.index];
+                if (*offset == NATIVE_NOT_WRITTEN)
+                    *offset = add_rodata_string(backend, value.string, strlen(value.string));
+
+                u8 destination = integer_destination(emitter, instruction.a, NATIVE_NO_OPERAND);
+                emit_section_operand(backend, 0, X86_REX_W, X86_LEA, destination, ELF_SECTION_RODATA, *offset);
+                emit_store_integer(emitter, destination, instruction.a);
+                break;
+            }
+
+            if (location < NATIVE_LOCATION_XMM)
+            {
+                emit_load_immediate(emitter, location, value.bits);
+                break;
+            }
+
+            if (location != NATIVE_LOCATION_MEMORY)
+            {
+                // xorpd xmm, xmm for 0.0, the other values are moved in through rax
+                if (value.bits == 0)
+                {
+                    emit_register_operand(emitter, 0x66, 0, X86_XORPD, location & 0xF, location & 0xF);
+                    break;
+                }
+
+                emit_load_immediate(emitter, X86_RAX, value.bits);
+                emit_store_integer(emitter, X86_RAX, instruction.a);
+                break;
+            }
+
+            if (value.integer == (i64)(i32)value.integer)
+            {
+                // mov qword [rbx + a * 8], imm32, the immediate is sign extended
+                emit_vm_operand(emitter, 0, X86_REX_W, 0xC7, 0, instruction.a);
+                emit_u32(backend, (u32)value.integer);
+                break;
+            }
+
+            emit_load_immediate(emitter, X86_RAX, value.bits);
+            emit_store_integer(emitter, X86_RAX, instruction.a);
+            break;
+        }
+        case OPCODE_MOVE:
+        {
+            // The copy is made in the class of the register written, or of the one read when both are in memory
+            u8 location = locations[instruction.a];
+            u8 source = locations[instruction.b];
+            if (location == source && location != NATIVE_LOCATION_MEMORY)
+                break;
+
+            if (location < NATIVE_LOCATION_XMM)
+                emit_load_integer(emitter, location, instruction.b);
+            else if (location != NATIVE_LOCATION_MEMORY)
+                emit_load_float(emitter, location & 0xF, instruction.b);
+            else if (source != NATIVE_LOCATION_MEMORY && source >= NATIVE_LOCATION_XMM)
+                emit_store_float(emitter, source & 0xF, instruction.a);
+            else if (source != NATIVE_LOCATION_MEMORY)
+                emit_store_integer(emitter, source, instruction.a);
+            else
+            {
+                emit_load_integer(emitter, X86_RAX, instruction.b);
+                emit_store_integer(emitter, X86_RAX, instruction.a);
+            }
+
+            break;
+        }
+        case OPCODE_GET_GLOBAL:
+        {
+            u64 offset = backend->registers_offset + instruction.index * sizeof(bytecode_value);
+            u8 location = locations[instruction.a];
+            if (location != NATIVE_LOCATION_MEMORY && location >= NATIVE_LOCATION_XMM)
+            {
+                emit_section_operand(backend, 0xF2, 0, X86_MOVSD_LOAD, location & 0xF, ELF_SECTION_BSS, offset);
+                break;
+            }
+
+            u8 destination = integer_destination(emitter, instruction.a, NATIVE_NO_OPERAND);
+            emit_section_operand(backend, 0, X86_REX_W, X86_MOV_LOAD, destination, ELF_SECTION_BSS, offset);
+            emit_store_integer(emitter, destination, instruction.a);
+            break;
+        }
+        case OPCODE_SET_GLOBAL:
+        {
+            u64 offset = backend->registers_offset + instruction.index * sizeof(bytecode_value);
+            u8 location = locations[instruction.a];
+            if (location != NATIVE_LOCATION_MEMORY && location >= NATIVE_LOCATION_XMM)
+            {
+                emit_section_operand(backend, 0xF2, 0, X86_MOVSD_STORE, location & 0xF, ELF_SECTION_BSS, offset);
+                break;
+            }
+
+            u8 source = (location < NATIVE_LOCATION_XMM) ? location : X86_RAX;
+            emit_load_integer(emitter, source, instruction.a);
+            emit_section_operand(backend, 0, X86_REX_W, X86_MOV_STORE, source, ELF_SECTION_BSS, offset);
+            break;
+        }
+        case OPCODE_ADD_I64:
+        case OPCODE_SUBTRACT_I64:
+        case OPCODE_MULTIPLY_I64:
+        {
+            // The two's complement results are the wrapping ones the vm gives
+            u16 opcode = (instruction.opcode == OPCODE_ADD_I64) ? X86_ADD_LOAD : (instruction.opcode == OPCODE_SUBTRACT_I64) ? X86_SUB_LOAD : X86_IMUL_LOAD;
+            if (instruction.opcode != OPCODE_SUBTRACT_I64)
+                swap_operands(emitter, &instruction);
+
+            u8 destination = integer_destination(emitter, instruction.a, instruction.c);
+            emit_load_integer(emitter, destination, instruction.b);
+            emit_integer_source(emitter, opcode, destination, instruction.c);
+            emit_store_integer(emitter, destination, instruction.a);
+            break;
+        }
+        case OPCODE_ADD_F64:
+        case OPCODE_SUBTRACT_F64:
+        case OPCODE_MULTIPLY_F64:
+        case OPCODE_DIVIDE_F64:
+        {
+            u16 opcode = X86_DIVSD_LOAD;
+            if (instruction.opcode == OPCODE_ADD_F64)
+                opcode = X86_ADDSD_LOAD;
+            else if (instruction.opcode == OPCODE_SUBTRACT_F64)
+                opcode = X86_SUBSD_LOAD;
+            else if (instruction.opcode == OPCODE_MULTIPLY_F64)
+                opcode = X86_MULSD_LOAD;
+
+            if (instruction.opcode == OPCODE_ADD_F64 || instruction.opcode == OPCODE_MULTIPLY_F64)
+                swap_operands(emitter, &instruction);
+
+            u8 destination = float_destination(emitter, instruction.a, instruction.c);
+            emit_load_float(emitter, destination, instruction.b);
+            emit_float_source(emitter, 0xF2, opcode, destination, instruction.c);
+            emit_store_float(emitter, destination, instruction.a);
+            break;
+        }
+        case OPCODE_DIVIDE_I64:
+        case OPCODE_MODULUS_I64:
+        {
+            emit_division(emitter, instruction, index);
+            break;
+        }
+        case OPCODE_MODULUS_F64:
+        {
+            // fmod(b, c), like the vm
+            emit_load_float(emitter, X86_XMM0, instruction.b);
+            emit_load_float(emitter, X86_XMM1, instruction.c);
+            emit_spanning_registers(emitter, index, false);
+            emit_library_call(backend, backend->fmod_symbol);
+            emit_spanning_registers(emitter, index, true);
+            emit_store_float(emitter, X86_XMM0, instruction.a);
+            break;
+        }
+        case OPCODE_GREATER_THAN_I64:
+        case OPCODE_LESS_THAN_I64:
+        {
+            u8 left = (locations[instruction.b] < NATIVE_LOCATION_XMM) ? locations[instruction.b] : X86_RAX;
+            emit_load_integer(emitter, left, instruction.b);
+            emit_integer_source(emitter, X86_CMP_LOAD, left, instruction.c);
+
+            u8 condition = (instruction.opcode == OPCODE_GREATER_THAN_I64) ? X86_CONDITION_GREATER : X86_CONDITION_LESS;
+            emit_comparison_result(emitter, condition, false, instruction.a);
+            break;
+        }
+        case OPCODE_GREATER_THAN_F64:
+        case OPCODE_LESS_THAN_F64:
+        {
+            // ucomisd sets the flags of 'above' for neither operand being a NaN and the first being larger, so
+            // b < c is tested as c > b. A comparison with a NaN never holds, like in the vm
+            b8 is_greater = instruction.opcode == OPCODE_GREATER_THAN_F64;
+            u64 first = is_greater ? instruction.b : instruction.c;
+            u8 left = float_destination(emitter, first, NATIVE_NO_OPERAND);
+            emit_load_float(emitter, left, first);
+            emit_float_source(emitter, 0x66, X86_UCOMISD_LOAD, left, is_greater ? instruction.c : instruction.b);
+            emit_comparison_result(emitter, X86_CONDITION_ABOVE, true, instruction.a);
+            break;
+        }
+        case OPCODE_JUMP:
+        {
+            emit_jump(emitter, X86_ALWAYS, target);
+            break;
+        }
+        case OPCODE_JUMP_IF_FALSE_I64:
+        case OPCODE_JUMP_IF_TRUE_I64:
+        {
+            u8 location = locations[instruction.a];
+            if (location == NATIVE_LOCATION_MEMORY)
+            {
+                // cmp qword [rbx + a * 8], 0
+                emit_vm_operand(emitter, 0, X86_REX_W, 0x83, 7, instruction.a);
+                const u8 zero = 0;
+                emit_bytes(backend, &zero, 1);
+            }
+            else
+            {
+                // test reg, reg
+                u8 tested = (location < NATIVE_LOCATION_XMM) ? location : X86_RAX;
+                emit_load_integer(emitter, tested, instruction.a);
+                emit_register_operand(emitter, 0, X86_REX_W, X86_TEST, tested, tested);
+            }
+
+            emit_jump(emitter, (instruction.opcode == OPCODE_JUMP_IF_FALSE_I64) ? X86_CONDITION_EQUAL : X86_CONDITION_NOT_EQUAL, target);
+            break;
+        }
+        case OPCODE_JUMP_IF_FALSE_F64:
+        case OPCODE_JUMP_IF_TRUE_F64:
+        {
+            // xorpd xmm1, xmm1; ucomisd value, xmm1, a NaN is unordered and sets the parity flag, it is not 0.0 so it is true
+            u8 tested = float_destination(emitter, instruction.a, NATIVE_NO_OPERAND);
+            emit_load_float(emitter, tested, instruction.a);
+            emit_register_operand(emitter, 0x66, 0, X86_XORPD, X86_XMM1, X86_XMM1);
+            emit_register_operand(emitter, 0x66, 0, X86_UCOMISD_LOAD, tested, X86_XMM1);
+
+            if (instruction.opcode == OPCODE_JUMP_IF_FALSE_F64)
+            {
+                // jp over the je
+                const u8 skip_unordered[] = { 0x7A, 0x06 };
+                emit_bytes(backend, skip_unordered, sizeof(skip_unordered));
+                emit_jump(emitter, X86_CONDITION_EQUAL, target);
+            }
+            else
+            {
+                emit_jump(emitter, X86_CONDITION_PARITY, target);
+                emit_jump(emitter, X86_CONDITION_NOT_EQUAL, target);
+            }
+
+            break;
+        }
+        case OPCODE_JUMP_IF_FALSE_STRING:
+        case OPCODE_JUMP_IF_TRUE_STRING:
+        {
+            // A string is true when it is not NULL and not empty. test rax, rax
+            const u8 test_null[] = { 0x48, 0x85, 0xC0 };
+            const u8 compare_empty[] = { 0x80, 0x38, 0x00 };
+            emit_load_integer(emitter, X86_RAX, instruction.a);
+            emit_bytes(backend, test_null, sizeof(test_null));
+
+            if (instruction.opcode == OPCODE_JUMP_IF_FALSE_STRING)
+            {
+                // je for NULL; cmp byte [rax], 0; je for empty
+                emit_jump(emitter, X86_CONDITION_EQUAL, target);
+                emit_bytes(backend, compare_empty, sizeof(compare_empty));
+                emit_jump(emitter, X86_CONDITION_EQUAL, target);
+            }
+            else
+            {
+                // je over the test of the first character and its jne
+                const u8 skip_null[] = { 0x74, 0x09 };
+                emit_bytes(backend, skip_null, sizeof(skip_null));
+                emit_bytes(backend, compare_empty, sizeof(compare_empty));
+                emit_jump(emitter, X86_CONDITION_NOT_EQUAL, target);
+            }
+
+            break;
+        }
+        case OPCODE_CALL:
+        {
+            emit_call(emitter, instruction, index);
+            break;
+        }
+        case OPCODE_RETURN:
+        {
+            // The globals the top level code held in x86-64 registers are stored for main() to print them
+            const register_allocation* allocation = &emitter->allocation;
+            for (u64 i = 0; emitter->function_index == 0 && i < program->global_count && i < allocation->register_count; ++i)
+            {
+                u8 location = allocation->locations[i];
+                if (location < NATIVE_LOCATION_XMM)
+                    emit_vm_operand(emitter, 0, X86_REX_W, X86_MOV_STORE, location, i);
+                else if (location != NATIVE_LOCATION_MEMORY)
+                    emit_vm_operand(emitter, 0xF2, 0, X86_MOVSD_STORE, location & 0xF, i);
+            }
+
+            // The value is returned in rax
+            emit_load_integer(emitter, X86_RAX, instruction.a);
+            emit_epilogue(emitter);
+            break;
+        }
+        case OPCODE_ADD_I64_IMMEDIATE:
+        case OPCODE_MULTIPLY_I64_IMMEDIATE:
+        {
+            // add reg, imm32 or imul reg, reg, imm32, the immediate is sign extended
+            u8 destination = integer_destination(emitter, instruction.a, NATIVE_NO_OPERAND);
+            emit_load_integer(emitter, destination, instruction.b);
+
+            if (instruction.opcode == OPCODE_ADD_I64_IMMEDIATE)
+                emit_register_operand(emitter, 0, X86_REX_W, 0x81, 0, destination);
+            else
+                emit_register_operand(emitter, 0, X86_REX_W, 0x69, destination, destination);
+
+            emit_u32(backend, (u32)(i32)instruction.immediate);
+            emit_store_integer(emitter, destination, instruction.a);
+            break;
+        }
+        case OPCODE_JUMP_IF_LESS_I64:
+        case OPCODE_JUMP_IF_NOT_LESS_I64:
+        case OPCODE_JUMP_IF_GREATER_I64:
+        case OPCODE_JUMP_IF_NOT_GREATER_I64:
+        {
+            u8 left = (locations[instruction.a] < NATIVE_LOCATION_XMM) ? locations[instruction.a] : X86_RAX;
+            emit_load_integer(emitter, left, instruction.a);
+            emit_integer_source(emitter, X86_CMP_LOAD, left, instruction.b);
+
+            u8 condition = X86_CONDITION_LESS_OR_EQUAL;
+            if (instruction.opcode == OPCODE_JUMP_IF_LESS_I64)
+                condition = X86_CONDITION_LESS;
+            else if (instruction.opcode == OPCODE_JUMP_IF_NOT_LESS_I64)
+                condition = X86_CONDITION_GREATER_OR_EQUAL;
+            else if (instruction.opcode == OPCODE_JUMP_IF_GREATER_I64)
+                condition = X86_CONDITION_GREATER;
+
+            emit_jump(emitter, condition, short_target);
+            break;
+        }
+        case OPCODE_JUMP_IF_LESS_F64:
+        case OPCODE_JUMP_IF_NOT_LESS_F64:
+        case OPCODE_JUMP_IF_GREATER_F64:
+        case OPCODE_JUMP_IF_NOT_GREATER_F64:
+        {
+            // a < b is tested as b > a, and 'not above' holds for a NaN like the vm's !(a < b) does
+            b8 is_less = instruction.opcode == OPCODE_JUMP_IF_LESS_F64 || instruction.opcode == OPCODE_JUMP_IF_NOT_LESS_F64;
+            b8 is_negated = instruction.opcode == OPCODE_JUMP_IF_NOT_LESS_F64 || instruction.opcode == OPCODE_JUMP_IF_NOT_GREATER_F64;
+            u64 first = is_less ? instruction.b : instruction.a;
+            u8 left = float_destination(emitter, first, NATIVE_NO_OPERAND);
+            emit_load_float(emitter, left, first);
+            emit_float_source(emitter, 0x66, X86_UCOMISD_LOAD, left, is_less ? instruction.a : instruction.b);
+            emit_jump(emitter, is_negated ? X86_CONDITION_BELOW_OR_EQUAL : X86_CONDITION_ABOVE, short_target);
+            break;
+        }
+        default:
+        {
+            // bytecode_compile() never makes any other opcode, the code traps if it somehow runs one. ud2
+            const u8 trap[] = { 0x0F, 0x0B };
+            emit_bytes(backend, trap, sizeof(trap));
+            break;
+        }
+    };
+}
+
+void emit_call(native_emitter* emitter, bytecode_instruction instruction, u64 index)
+{
+    native_backend* backend = emitter->backend;
+    const bytecode_function* function = emitter->function;
+    const bytecode_program* program = backend->program;
+
+    u64 callee = emitter->known_functions[instruction.b];
+    token call_token = function->instruction_tokens[index];
+
+    // The error names the called function, which may only be known once the program runs. The text is rendered
+    // with a placeholder for the name, and printed around the name of the function that was called
+    const char placeholder[] = "\x01";
+    token placeholder_token = call_token;
+    placeholder_token.text = placeholder;
+    placeholder_token.length = 1;
+    native_stub* stub = add_stub(emitter, index, DIAGNOSTIC_STACK_OVERFLOW, diagnostic_token_text(placeholder_token));
+    if (stub == NULL)
+        return;
+
+    stub->callee = callee;
+
+    // The called function reads its arguments from its registers, so the ones held in x86-64 registers are
+    // stored to memory first. Those are the registers from c on live at the call
+    const register_allocation* allocation = &emitter->allocation;
+    for (u64 i = instruction.c; i < function->register_count; ++i)
+    {
+        u8 location = allocation->locations[i];
+        if (location == NATIVE_LOCATION_MEMORY || allocation->starts[i] > index * 2 || allocation->ends[i] < index * 2)
+            continue;
+
+        if (location < NATIVE_LOCATION_XMM)
+            emit_vm_operand(emitter, 0, X86_REX_W, X86_MOV_STORE, location, i);
+        else
+            emit_vm_operand(emitter, 0xF2, 0, X86_MOVSD_STORE, location & 0xF, i);
+    }
+
+    emit_spanning_registers(emitter, index, false);
+    if (callee == NATIVE_UNKNOWN_FUNCTION)
+    {
+        // mov rax, b; shl rax, 5; lea r8, [rlx_functions]; add r8, rax. r8 holds the function's entry
+        const u8 entry_index[] = { 0x48, 0xC1, 0xE0, NATIVE_FUNCTION_ENTRY_SHIFT };
+        const u8 entry_address[] = { 0x49, 0x01, 0xC0 };
+        emit_load_integer(emitter, X86_RAX, instruction.b);
+        emit_bytes(backend, entry_index, sizeof(entry_index));
+        emit_section_operand(backend, 0, X86_REX_W, X86_LEA, X86_R8, ELF_SECTION_DATA, backend->functions_table_offset);
+        emit_bytes(backend, entry_address, sizeof(entry_address));
+    }
+
+    // The calls nest as deeply as the vm lets them: mov rax, [depth]; add rax, 1; mov [depth], rax; cmp rax, max; jae stub
+    const u8 increment[] = { 0x48, 0x83, 0xC0, 0x01 };
+    const u8 compare_depth[] = { 0x48, 0x3D };
+    emit_section_operand(backend, 0, X86_REX_W, X86_MOV_LOAD, X86_RAX, ELF_SECTION_BSS, backend->call_depth_offset);
+    emit_bytes(backend, increment, sizeof(increment));
+    emit_section_operand(backend, 0, X86_REX_W, X86_MOV_STORE, X86_RAX, ELF_SECTION_BSS, backend->call_depth_offset);
+    emit_bytes(backend, compare_depth, sizeof(compare_depth));
+    emit_u32(backend, DEFAULT_VM_CALL_DEPTH);
+    emit_jump_to_stub(emitter, stub, X86_CONDITION_ABOVE_OR_EQUAL);
+
+    // The registers of the called function have to fit in the vm's: lea rax, [rbx + c * 8 + size]; cmp rax, [end]; ja stub
+    if (callee == NATIVE_UNKNOWN_FUNCTION)
+    {
+        // add rax, [r8 + 16]
+        const u8 add_register_bytes[] = { 0x49, 0x03, 0x40, 0x10 };
+        emit_vm_operand(emitter, 0, X86_REX_W, X86_LEA, X86_RAX, instruction.c);
+        emit_bytes(backend, add_register_bytes, sizeof(add_register_bytes));
+    }
+    else
+    {
+        emit_vm_operand(emitter, 0, X86_REX_W, X86_LEA, X86_RAX, (u64)instruction.c + program->functions[callee].register_count);
+    }
+
+    const u8 compare_end[] = { 0x48, 0x39, 0xC8 };
+    emit_section_operand(backend, 0, X86_REX_W, X86_LEA, X86_RCX, ELF_SECTION_BSS, backend->registers_offset + DEFAULT_VM_REGISTER_COUNT * sizeof(bytecode_value));
+    emit_bytes(backend, compare_end, sizeof(compare_end));
+    emit_jump_to_stub(emitter, stub, X86_CONDITION_ABOVE);
+
+    // The called function's registers start at c, where its arguments already are. lea rdi, [rbx + c * 8]
+    emit_vm_operand(emitter, 0, X86_REX_W, X86_LEA, X86_RDI, instruction.c);
+    if (callee == NATIVE_UNKNOWN_FUNCTION)
+    {
+        // call [r8]
+        const u8 call_entry[] = { 0x41, 0xFF, 0x10 };
+        emit_bytes(backend, call_entry, sizeof(call_entry));
+    }
+    else
+    {
+        emit_function_call(backend, callee, call_token);
+    }
+
+    // The call is over: mov rcx, [depth]; sub rcx, 1; mov [depth], rcx, then the returned value is stored
+    const u8 decrement[] = { 0x48, 0x83, 0xE9, 0x01 };
+    emit_section_operand(backend, 0, X86_REX_W, X86_MOV_LOAD, X86_RCX, ELF_SECTION_BSS, backend->call_depth_offset);
+    emit_bytes(backend, decrement, sizeof(decrement));
+    emit_section_operand(backend, 0, X86_REX_W, X86_MOV_STORE, X86_RCX, ELF_SECTION_BSS, backend->call_depth_offset);
+    emit_spanning_registers(emitter, index, true);
+    emit_store_integer(emitter, X86_RAX, instruction.a);
+}
+
+void emit_spanning_registers(native_emitter* emitter, u64 index, b8 is_load)
+{
+    // A register live across a call is below its c, which the callee never writes, and fmod() writes no
+    // register at all, so its memory holds it. The operands are read at index * 2, the result written at index * 2 + 1
+    const register_allocation* allocation = &emitter->allocation;
+    for (u64 i = 0; i < allocation->spanning_count; ++i)
+    {
+        u64 reg = allocation->spanning_registers[i];
+        u8 location = allocation->locations[reg];
+        if (allocation->starts[reg] >= index * 2 || allocation->ends[reg] <= index * 2 + 1)
+            continue;
+
+        if (location < NATIVE_LOCATION_XMM)
+            emit_vm_operand(emitter, 0, X86_REX_W, is_load ? X86_MOV_LOAD : X86_MOV_STORE, location, reg);
+        else
+            emit_vm_operand(emitter, 0xF2, 0, is_load ? X86_MOVSD_LOAD : X86_MOVSD_STORE, location & 0xF, reg);
+    }
+}
+
+void emit_division(native_emitter* emitter, bytecode_instruction instruction, u64 index)
+{
+    native_backend* backend = emitter->backend;
+    b8 is_division = instruction.opcode == OPCODE_DIVIDE_I64;
+
+    native_stub* stub = add_stub(emitter, index, DIAGNOSTIC_DIVISION_BY_ZERO);
+    if (stub == NULL)
+        return;
+
+    // test rcx, rcx; je stub
+    const u8 test_divisor[] = { 0x48, 0x85, 0xC9 };
+    emit_load_integer(emitter, X86_RCX, instruction.c);
+    emit_bytes(backend, test_divisor, sizeof(test_divisor));
+    emit_jump_to_stub(emitter, stub, X86_CONDITION_EQUAL);
+
+    // Dividing by -1 overflows for the smallest integer, the vm gives 0 - b for it (and 0 for the modulus). cmp rcx, -1; jne
+    // over the result for -1, which is neg rax or xor eax, eax and a jmp over the idiv
+    const u8 compare_minus_one[] = { 0x48, 0x83, 0xF9, 0xFF, 0x75, (u8)(is_division ? 5 : 4) };
+    const u8 negate[] = { 0x48, 0xF7, 0xD8, 0xEB, 0x05 };
+    const u8 zero[] = { 0x31, 0xC0, 0xEB, 0x08 };
+    emit_load_integer(emitter, X86_RAX, instruction.b);
+    emit_bytes(backend, compare_minus_one, sizeof(compare_minus_one));
+    if (is_division)
+        emit_bytes(backend, negate, sizeof(negate));
+    else
+        emit_bytes(backend, zero, sizeof(zero));
+
+    // cqo; idiv rcx, the quotient is left in rax and the remainder in rdx (mov rax, rdx)
+    const u8 divide[] = { 0x48, 0x99, 0x48, 0xF7, 0xF9 };
+    const u8 remainder[] = { 0x48, 0x89, 0xD0 };
+    emit_bytes(backend, divide, sizeof(divide));
+    if (!is_division)
+        emit_bytes(backend, remainder, sizeof(remainder));
+
+    emit_store_integer(emitter, X86_RAX, instruction.a);
+}
+
+void emit_prologue(native_emitter* emitter)
+{
+    native_backend* backend = emitter->backend;
+    const register_allocation* allocation = &emitter->allocation;
+
+    // push rbx; mov rbx, rdi, the registers of the call stay in rbx. The push also aligns the stack for the calls it makes
+    const u8 prologue[] = { 0x53, 0x48, 0x89, 0xFB };
+    emit_bytes(backend, prologue, sizeof(prologue));
+
+    // push the callee saved registers the function uses, and sub rsp, 8 to keep the stack aligned after an odd amount
+    for (u8 i = X86_R12; i <= X86_R15; ++i)
+    {
+        if (!(allocation->saved_registers & (1 << i)))
+            continue;
+
+        const u8 push[] = { 0x41, (u8)(0x50 | (i & 7)) };
+        emit_bytes(backend, push, sizeof(push));
+        emitter->saved_register_count += 1;
+    }
+
+    if (emitter->saved_register_count % 2)
+    {
+        const u8 align_stack[] = { 0x48, 0x83, 0xEC, 0x08 };
+        emit_bytes(backend, align_stack, sizeof(align_stack));
+    }
+
+    // The parameters held in x86-64 registers are loaded from the registers of the call
+    for (u64 i = 0; i < emitter->function->parameter_count && i < allocation->register_count; ++i)
+    {
+        u8 location = allocation->locations[i];
+        if (location == NATIVE_LOCATION_MEMORY || allocation->starts[i] != 0)
+            continue;
+
+        if (location < NATIVE_LOCATION_XMM)
+            emit_vm_operand(emitter, 0, X86_REX_W, X86_MOV_LOAD, location, i);
+        else
+            emit_vm_operand(emitter, 0xF2, 0, X86_MOVSD_LOAD, location & 0xF, i);
+    }
+
+    emit_zero_registers(emitter);
+}
+
+void emit_epilogue(native_emitter* emitter)
+{
+    native_backend* backend = emitter->backend;
+    const register_allocation* allocation = &emitter->allocation;
+
+    // add rsp, 8 and the pops in the reverse order of the pushes; pop rbx; ret
+    if (emitter->saved_register_count % 2)
+    {
+        const u8 restore_stack[] = { 0x48, 0x83, 0xC4, 0x08 };
+        emit_bytes(backend, restore_stack, sizeof(restore_stack));
+    }
+
+    for (u8 i = X86_R15; i >= X86_R12; --i)
+    {
+        if (!(allocation->saved_registers & (1 << i)))
+            continue;
+
+        const u8 pop[] = { 0x41, (u8)(0x58 | (i & 7)) };
+        emit_bytes(backend, pop, sizeof(pop));
+    }
+
+    const u8 epilogue[] = { 0x5B, 0xC3 };
+    emit_bytes(backend, epilogue, sizeof(epilogue));
+}
+
+void emit_zero_registers(native_emitter* emitter)
+{
+    native_backend* backend = emitter->backend;
+    const bytecode_function* function = emitter->function;
+    const register_allocation* allocation = &emitter->allocation;
+    u64 global_count = (emitter->function_index == 0) ? backend->program->global_count : 0;
+
+    // The vm zeros every register after the parameters, which only shows for the ones live when the function
+    // starts (read before they are written) and for the globals main() prints. The rest are left alone
+    u64 count = 0;
+    for (u64 i = function->parameter_count; i < function->register_count; ++i)
+    {
+        if (allocation->locations[i] == NATIVE_LOCATION_MEMORY && (allocation->starts[i] == 0 || i < global_count))
+            count += 1;
+    }
+
+    if (count > 0)
+    {
+        // xor eax, eax
+        const u8 zero_rax[] = { 0x31, 0xC0 };
+        emit_bytes(backend, zero_rax, sizeof(zero_rax));
+    }
+
+    if (count > 0 && count <= NATIVE_MAX_UNROLLED_ZEROING)
+    {
+        for (u64 i = function->parameter_count; i < function->register_count; ++i)
+        {
+            if (allocation->locations[i] == NATIVE_LOCATION_MEMORY && (allocation->starts[i] == 0 || i < global_count))
+                emit_vm_operand(emitter, 0, X86_REX_W, X86_MOV_STORE, X86_RAX, i);
+        }
+    }
+    else if (count > 0)
+    {
+        // lea rdi, [rbx + parameter_count * 8]; mov ecx, count; rep stosq
+        const u8 mov_ecx = 0xB9;
+        const u8 store_string[] = { 0xF3, 0x48, 0xAB };
+        emit_vm_operand(emitter, 0, X86_REX_W, X86_LEA, X86_RDI, function->parameter_count);
+        emit_bytes(backend, &mov_ecx, 1);
+        emit_u32(backend, (u32)(function->register_count - function->parameter_count));
+        emit_bytes(backend, store_string, sizeof(store_string));
+    }
+
+    // The live ones held in x86-64 registers start out zero the same way, xor reg, reg or xorpd xmm, xmm
+    for (u64 i = function->parameter_count; i < function->register_count; ++i)
+    {
+        u8 location = allocation->locations[i];
+        if (location == NATIVE_LOCATION_MEMORY || allocation->starts[i] != 0)
+            continue;
+
+        if (location < NATIVE_LOCATION_XMM)
+            emit_register_operand(emitter, 0, 0, X86_XOR, location, location);
+        else
+            emit_register_operand(emitter, 0x66, 0, X86_XORPD, location & 0xF, location & 0xF);
+    }
+}
+
+void emit_stubs(native_emitter* emitter)
+{
+    native_backend* backend = emitter->backend;
+    elf_object* object = backend->object;
+
+    for (u64 i = 0; i < emitter->stub_count && !backend->has_error; ++i)
+    {
+        native_stub* stub = &emitter->stubs[i];
+        u64 start = object->sections[ELF_SECTION_TEXT].length;
+        for (u64 j = 0; j < stub->position_count; ++j)
+            patch_u32(backend, stub->positions[j], (u32)x86_relative_offset(stub->positions[j], start));
+
+        emit_section_operand(backend, 0, X86_REX_W, X86_LEA, X86_RDI, ELF_SECTION_RODATA, stub->text);
+        if (!stub->is_stack_overflow)
+        {
+            emit_local_call(backend, backend->runtime_error_offset);
+            continue;
+        }
+
+        if (stub->callee == NATIVE_UNKNOWN_FUNCTION)
+        {
+            // mov rsi, [r8 + 8], the name in the entry of the function
+            const u8 load_name[] = { 0x49, 0x8B, 0x70, 0x08 };
+            emit_bytes(backend, load_name, sizeof(load_name));
+        }
+        else
+        {
+            emit_section_operand(backend, 0, X86_REX_W, X86_LEA, X86_RSI, ELF_SECTION_RODATA, backend->function_names[stub->callee]);
+        }
+
+        emit_section_operand(backend, 0, X86_REX_W, X86_LEA, X86_RDX, ELF_SECTION_RODATA, stub->text_after_name);
+        emit_local_call(backend, backend->stack_overflow_offset);
+    }
+}
+
+native_stub* add_stub(native_emitter* emitter, u64 index, diagnostic_id id, ...)
+{
+    native_backend* backend = emitter->backend;
+    token t = emitter->function->instruction_tokens[index];
+
+    u64 length = 0;
+    va_list params;
+    va_start(params, id);
+    char* text = runtime_error_render(&backend->renderer, t, id, params, &length);
+    va_end(params);
+
+    if (text == NULL)
+    {
+        backend_error(backend, t, DIAGNOSTIC_CODE_GENERATION_ALLOCATION);
+        return NULL;
+    }
+
+    native_stub* stub = &emitter->stubs[emitter->stub_count++];
+    memset(stub, 0, sizeof(native_stub));
+
+    // The placeholder of the name of the called function is the first \x01 of the text, the faulted line comes after the message
+    char* name = (id == DIAGNOSTIC_STACK_OVERFLOW) ? memchr(text, 0x01, length) : NULL;
+    if (name != NULL)
+    {
+        stub->is_stack_overflow = true;
+        stub->text = add_rodata_string(backend, text, (u64)(name - text));
+        stub->text_after_name = add_rodata_string(backend, name + 1, length - (u64)(name - text) - 1);
+    }
+    else
+    {
+        stub->text = add_rodata_string(backend, text, length);
+    }
+
+    free(text);
+    return stub;
+}
+
+void emit_jump_to_stub(native_emitter* emitter, native_stub* stub, u8 condition)
+{
+    native_backend* backend = emitter->backend;
+    u8 bytes[X86_MAX_INSTRUCTION_BYTES];
+    emit_bytes(backend, bytes, x86_encode_jump(bytes, condition));
+
+    // The rel32 is the end of the jump
+    stub->positions[stub->position_count++] = backend->object->sections[ELF_SECTION_TEXT].length - 4;
+}
+
+void emit_jump(native_emitter* emitter, u8 condition, u64 target)
+{
+    native_backend* backend = emitter->backend;
+    u8 bytes[X86_MAX_INSTRUCTION_BYTES];
+    emit_bytes(backend, bytes, x86_encode_jump(bytes, condition));
+
+    emitter->jumps[emitter->jump_count++] = (x86_patch){ backend->object->sections[ELF_SECTION_TEXT].length - 4, target };
+}
+
+void emit_vm_operand(native_emitter* emitter, u8 prefix, u8 rex, u16 opcode, u8 x86_register, u64 vm_register)
+{
+    // Every register is 8 bytes, the first 16 are reached with a disp8
+    u8 bytes[X86_MAX_INSTRUCTION_BYTES];
+    emit_bytes(emitter->backend, bytes, x86_encode_memory_operand(bytes, prefix, rex, opcode, x86_register, X86_RBX, (i32)(vm_register * sizeof(bytecode_value))));
+}
+
+void emit_register_operand(native_emitter* emitter, u8 prefix, u8 rex, u16 opcode, u8 x86_register, u8 rm_register)
+{
+    u8 bytes[X86_MAX_INSTRUCTION_BYTES];
+    emit_bytes(emitter->backend, bytes, x86_encode_register_operand(bytes, prefix, rex, opcode, x86_register, rm_register));
+}
+
+void emit_integer_source(native_emitter* emitter, u16 opcode, u8 x86_register, u64 vm_register)
+{
+    u8 location = emitter->allocation.locations[vm_register];
+    if (location == NATIVE_LOCATION_MEMORY)
+    {
+        emit_vm_operand(emitter, 0, X86_REX_W, opcode, x86_register, vm_register);
+        return;
+    }
+
+    // A register held in an xmm register is moved out through rcx
+    u8 source = location;
+    if (location >= NATIVE_LOCATION_XMM)
+    {
+        source = X86_RCX;
+        emit_load_integer(emitter, source, vm_register);
+    }
+
+    emit_register_operand(emitter, 0, X86_REX_W, opcode, x86_register, source);
+}
+
+void emit_float_source(native_emitter* emitter, u8 prefix, u16 opcode, u8 xmm_register, u64 vm_register)
+{
+    u8 location = emitter->allocation.locations[vm_register];
+    if (location == NATIVE_LOCATION_MEMORY)
+    {
+        emit_vm_operand(emitter, prefix, 0, opcode, xmm_register, vm_register);
+        return;
+    }
+
+    // A register held in a general purpose register is moved in through xmm1
+    u8 source = location & 0xF;
+    if (location < NATIVE_LOCATION_XMM)
+    {
+        source = X86_XMM1;
+        emit_load_float(emitter, source, vm_register);
+    }
+
+    emit_register_operand(emitter, prefix, 0, opcode, xmm_register, source);
+}
+
+void emit_load_integer(native_emitter* emitter, u8 x86_register, u64 vm_register)
+{
+    // mov reg, [rbx + r * 8], movq reg, xmm or mov reg, reg
+    u8 location = emitter->allocation.locations[vm_register];
+    if (location == NATIVE_LOCATION_MEMORY)
+        emit_vm_operand(emitter, 0, X86_REX_W, X86_MOV_LOAD, x86_register, vm_register);
+    else if (location >= NATIVE_LOCATION_XMM)
+        emit_register_operand(emitter, 0x66, X86_REX_W, X86_MOVQ_FROM_XMM, location & 0xF, x86_register);
+    else if (location != x86_register)
+        emit_register_operand(emitter, 0, X86_REX_W, X86_MOV_LOAD, x86_register, location);
+}
+
+void emit_store_integer(native_emitter* emitter, u8 x86_register, u64 vm_register)
+{
+    u8 location = emitter->allocation.locations[vm_register];
+    if (location == NATIVE_LOCATION_MEMORY)
+        emit_vm_operand(emitter, 0, X86_REX_W, X86_MOV_STORE, x86_register, vm_register);
+    else if (location >= NATIVE_LOCATION_XMM)
+        emit_register_operand(emitter, 0x66, X86_REX_W, X86_MOVQ_TO_XMM, location & 0xF, x86_register);
+    else if (location != x86_register)
+        emit_register_operand(emitter, 0, X86_REX_W, X86_MOV_LOAD, location, x86_register);
+}
+
+void emit_load_float(native_emitter* emitter, u8 xmm_register, u64 vm_register)
+{
+    // movsd xmm, [rbx + r * 8], movq xmm, reg or movapd xmm, xmm
+    u8 location = emitter->allocation.locations[vm_register];
+    if (location == NATIVE_LOCATION_MEMORY)
+        emit_vm_operand(emitter, 0xF2, 0, X86_MOVSD_LOAD, xmm_register, vm_register);
+    else if (location < NATIVE_LOCATION_XMM)
+        emit_register_operand(emitter, 0x66, X86_REX_W, X86_MOVQ_TO_XMM, xmm_register, location);
+    else if ((location & 0xF) != xmm_register)
+        emit_register_operand(emitter, 0x66, 0, X86_MOVAPD, xmm_register, location & 0xF);
+}
+
+void emit_store_float(native_emitter* emitter, u8 xmm_register, u64 vm_register)
+{
+    u8 location = emitter->allocation.locations[vm_register];
+    if (location == NATIVE_LOCATION_MEMORY)
+        emit_vm_operand(emitter, 0xF2, 0, X86_MOVSD_STORE, xmm_register, vm_register);
+    else if (location < NATIVE_LOCATION_XMM)
+        emit_register_operand(emitter, 0x66, X86_REX_W, X86_MOVQ_FROM_XMM, xmm_register, location);
+    else if ((location & 0xF) != xmm_register)
+        emit_register_operand(emitter, 0x66, 0, X86_MOVAPD, location & 0xF, xmm_register);
+}
+
+void emit_load_immediate(native_emitter* emitter, u8 x86_register, u64 value)
+{
+    native_backend* backend = emitter->backend;
+
+    // xor reg, reg for 0, mov reg, imm32 (sign extended) when it fits, mov reg, imm64 otherwise
+    if (value == 0)
+    {
+        emit_register_operand(emitter, 0, 0, X86_XOR, x86_register, x86_register);
+        return;
+    }
+
+    if ((i64)value == (i64)(i32)value)
+    {
+        emit_register_operand(emitter, 0, X86_REX_W, 0xC7, 0, x86_register);
+        emit_u32(backend, (u32)value);
+        return;
+    }
+
+    const u8 mov_imm64[] = { (u8)(X86_REX_W | ((x86_register >= 8) ? X86_REX_B : 0)), (u8)(0xB8 | (x86_register & 7)) };
+    emit_bytes(backend, mov_imm64, sizeof(mov_imm64));
+    emit_u32(backend, (u32)value);
+    emit_u32(backend, (u32)(value >> 32));
+}
+
+void swap_operands(native_emitter* emitter, bytecode_instruction* instruction)
+{
+    const u8* locations = emitter->allocation.locations;
+    u8 location = locations[instruction->a];
+    if (location == NATIVE_LOCATION_MEMORY || locations[instruction->c] != location || locations[instruction->b] == location)
+        return;
+
+    u16 b = instruction->b;
+    instruction->b = instruction->c;
+    instruction->c = b;
+}
+
+u8 integer_destination(native_emitter* emitter, u64 result, u64 operand)
+{
+    const u8* locations = emitter->allocation.locations;
+    u8 location = locations[result];
+    if (location >= NATIVE_LOCATION_XMM || (operand != NATIVE_NO_OPERAND && locations[operand] == location))
+        return X86_RAX;
+
+    return location;
+}
+
+u8 float_destination(native_emitter* emitter, u64 result, u64 operand)
+{
+    const u8* locations = emitter->allocation.locations;
+    u8 location = locations[result];
+    if (location == NATIVE_LOCATION_MEMORY || location < NATIVE_LOCATION_XMM || (operand != NATIVE_NO_OPERAND && locations[operand] == location))
+        return X86_XMM0;
+
+    return location & 0xF;
+}
+
+void emit_section_operand(native_backend* backend, u8 prefix, u8 rex, u16 opcode, u8 x86_register, elf_section section, u64 offset)
+{
+    u8 bytes[X86_MAX_INSTRUCTION_BYTES];
+    emit_bytes(backend, bytes, x86_encode_rip_operand(bytes, prefix, rex, opcode, x86_register));
+
+    // The disp32 ends the instruction, which is where the distance is counted from
+    u64 position = backend->object->sections[ELF_SECTION_TEXT].length - 4;
+    elf_object_add_relocation(backend->object, (elf_relocation){ ELF_SECTION_TEXT, position, ELF_R_X86_64_PC32, section, (i64)offset - 4 });
+}
+
+void emit_comparison_result(native_emitter* emitter, u8 condition, b8 is_float, u64 vm_register)
+{
+    native_backend* backend = emitter->backend;
+
+    u8 set_result[X86_MAX_INSTRUCTION_BYTES];
+    emit_bytes(backend, set_result, x86_encode_set_condition(set_result, condition));
+
+    if (!is_float)
+    {
+        emit_store_integer(emitter, X86_RAX, vm_register);
+        return;
+    }
+
+    // cvtsi2sd xmm0, eax, a float comparison gives 1.0 or 0.0
+    const u8 convert[] = { 0xF2, 0x0F, 0x2A, 0xC0 };
+    emit_bytes(backend, convert, sizeof(convert));
+    emit_store_float(emitter, X86_XMM0, vm_register);
+}
+
+void emit_library_call(native_backend* backend, u32 symbol)
+{
+    // call rel32, through the procedure linkage table when the C library is shared
+    const u8 call_opcode = 0xE8;
+    emit_bytes(backend, &call_opcode, 1);
+
+    u64 position = backend->object->sections[ELF_SECTION_TEXT].length;
+    elf_object_add_relocation(backend->object, (elf_relocation){ ELF_SECTION_TEXT, position, ELF_R_X86_64_PLT32, symbol, -4 });
+    emit_u32(backend, 0);
+}
+
+void emit_local_call(native_backend* backend, u64 offset)
+{
+    const u8 call_opcode = 0xE8;
+    emit_bytes(backend, &call_opcode, 1);
+
+    u64 position = backend->object->sections[ELF_SECTION_TEXT].length;
+    emit_u32(backend, (u32)x86_relative_offset(position, offset));
+}
+
+void emit_function_call(native_backend* backend, u64 function_index, token t)
+{
+    if (backend->call_count >= backend->call_capacity)
+    {
+        u64 new_capacity = backend->call_capacity ? backend->call_capacity * 2 : 64;
+        x86_patch* new_calls = realloc(backend->calls, new_capacity * sizeof(x86_patch));
+        if (new_calls == NULL)
+        {
+            backend_error(backend, t, DIAGNOSTIC_CODE_GENERATION_ALLOCATION);
+            return;
+        }
+
+        backend->calls = new_calls;
+        backend->call_capacity = new_capacity;
+    }
+
+    // The offset is written by finish_object(), once every function is in .text
+    const u8 call_opcode = 0xE8;
+    emit_bytes(backend, &call_opcode, 1);
+    backend->calls[backend->call_count++] = (x86_patch){ backend->object->sections[ELF_SECTION_TEXT].length, function_index };
+    emit_u32(backend, 0);
+}
+
+u64 add_rodata_string(native_backend* backend, const char* text, u64 length)
+{
+    const u8 terminator = 0;
+    u64 offset = elf_object_append(backend->object, ELF_SECTION_RODATA, text, length);
+    elf_object_append(backend->object, ELF_SECTION_RODATA, &terminator, 1);
+    return offset;
+}
+
+void emit_bytes(native_backend* backend, const u8* bytes, u64 count)
+{
+    elf_object_append(backend->object, ELF_SECTION_TEXT, bytes, count);
+}
+
+void emit_u32(native_backend* backend, u32 value)
+{
+    u8 bytes[4];
+    emit_bytes(backend, bytes, x86_write_u32(bytes, value));
+}
+
+void patch_u32(native_backend* backend, u64 position, u32 value)
+{
+    elf_buffer* text = &backend->object->sections[ELF_SECTION_TEXT];
+    if (backend->object->has_error || position + 4 > text->length)
+        return;
+
+    x86_write_u32(text->bytes + position, value);
+}
+
+void backend_error(native_backend* backend, token t, diagnostic_id id, ...)
+{
+    if (backend->has_error)
+        return;
+
+    va_list params;
+    va_start(params, id);
+    error_report report = error_report_create(t, id, params);
+    va_end(params);
+
+    context_report_error(backend->context, report);
+    backend->has_error = true;
+}
@@ -0,0 +1,710 @@
+#include "register_allocator.h"
+
+#include <malloc.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// The most 64 bit words the live sets of a function can take, the registers of a larger function are left in memory
+#define ALLOCATOR_MAX_LIVE_WORDS (1 << 22)
+// The deepest loop the spill costs tell apart, an access in a loop weighs 8 times one right outside of it
+#define ALLOCATOR_MAX_LOOP_DEPTH 10
+// The most intervals holding a register at once, one for each location below it
+#define ALLOCATOR_MAX_LOCATIONS 32
+
+// The registers an interval can be given, in the order they are tried. The caller saved general purpose registers the
+// native code leaves alone, the callee saved ones for the intervals live across a call, and the xmm registers
+static const u8 caller_saved_registers[] = { X86_RSI, X86_R9, X86_R10, X86_R11 };
+static const u8 callee_saved_registers[] = { X86_R12, X86_R13, X86_R14, X86_R15 };
+static const u8 float_registers[] = {
+    NATIVE_LOCATION_XMM | 2, NATIVE_LOCATION_XMM | 3, NATIVE_LOCATION_XMM | 4, NATIVE_LOCATION_XMM | 5,
+    NATIVE_LOCATION_XMM | 6, NATIVE_LOCATION_XMM | 7, NATIVE_LOCATION_XMM | 8, NATIVE_LOCATION_XMM | 9,
+    NATIVE_LOCATION_XMM | 10, NATIVE_LOCATION_XMM | 11, NATIVE_LOCATION_XMM | 12, NATIVE_LOCATION_XMM | 13,
+    NATIVE_LOCATION_XMM | 14, NATIVE_LOCATION_XMM | 15,
+};
+
+/**
+ * @brief The kind of value an instruction uses a register for, which picks the class of x86-64 register holding it
+ */
+typedef enum value_kind {
+    VALUE_KIND_ANY = 0,
+    VALUE_KIND_INTEGER,
+    VALUE_KIND_FLOAT,
+} value_kind;
+
+/**
+ * @brief The positions a register is live at, and what keeping it in memory would cost
+ */
+typedef struct live_interval {
+    /* The first and the last position the register is live at */
+    u32 start;
+    u32 end;
+    /* The register of the vm */
+    u64 reg;
+    /* The accesses of the register, each weighted by the depth of the loops it is in */
+    u64 spill_cost;
+    /* What storing and loading the register around the calls it is live across costs, 0 when there are none. A call
+       overwrites the caller saved registers */
+    u64 save_cost;
+    /* Set when the register is mostly used like a float */
+    b8 is_float;
+} live_interval;
+
+/**
+ * @brief The state of allocating the registers of a single function
+ */
+typedef struct register_allocator {
+    /* The program the function is in */
+    const bytecode_program* program;
+    /* The function whose registers are allocated */
+    const bytecode_function* function;
+    /* Where the allocation is written */
+    register_allocation* allocation;
+
+    /* The amount of 64 bit words a set of the registers takes */
+    u64 set_words;
+    /* The amount of globals the top level code leaves in its first registers for main() to print, 0 for the other
+       functions. Returning reads them */
+    u64 returned_globals;
+    /* Set for each register which has to stay in memory, the globals of the top level code other code reaches there */
+    b8* is_shared;
+
+    /* The block each instruction is in */
+    u32* block_of;
+    /* The first instruction of each block, followed by the length of the code */
+    u64* block_starts;
+    /* The amount of blocks */
+    u64 block_count;
+
+    /* For each block, the registers it reads before writing them and the ones it writes */
+    u64* uses;
+    u64* definitions;
+    /* For each block, the registers live when it starts and when it ends */
+    u64* live_in;
+    u64* live_out;
+
+    /* How deeply each instruction is nested in loops */
+    u32* loop_depths;
+    /* For each instruction, what storing and loading a register around the calls before it costs. A call is an
+       instruction calling a function, or fmod(), weighted by its loop depth like an access */
+    u64* call_costs;
+
+    /* For each register, its accesses weighted by their loop depth */
+    u64* spill_costs;
+    /* For each register, the weights of the accesses using it as a float and as anything else */
+    u64* float_weights;
+    u64* integer_weights;
+    /* For each register, the block which last wrote it plus 1, to find the arguments of a call */
+    u32* written_blocks;
+} register_allocator;
+
+// Finds the globals of the top level code which have to stay in memory, the ones any function reaches with
+// OPCODE_GET_GLOBAL or OPCODE_SET_GLOBAL
+static void find_shared_globals(register_allocator* allocator);
+
+// Splits the code of the function into basic blocks, and finds the loop depth and the cost of the calls before each instruction
+static void find_blocks(register_allocator* allocator);
+
+// Finds the registers live at the start and the end of each block
+static void find_live_sets(register_allocator* allocator);
+
+// Finds the live interval of every register, their spill costs and their classes
+static void find_intervals(register_allocator* allocator);
+
+// Gives each interval a location, left to right over the code
+static b8 scan_intervals(register_allocator* allocator);
+
+// Gives the kind of value an instruction uses its registers for, OPCODE_CALL and OPCODE_MOVE are handled on their own
+static value_kind instruction_value_kind(register_allocator* allocator, bytecode_instruction instruction);
+
+// Adds an access of a register at a position to its interval and weights
+static void add_access(register_allocator* allocator, u64 reg, u32 position, u64 weight, value_kind kind);
+
+// Extends the interval of a register to a position
+static void extend_interval(register_allocator* allocator, u64 reg, u32 position);
+
+// Gives the instruction a jump continues at
+static u64 jump_target(bytecode_instruction instruction, u64 index);
+
+// Checks whether an instruction calls a function, which overwrites the caller saved registers
+static b8 is_call_point(bytecode_instruction instruction);
+
+// Checks whether a location is a callee saved general purpose register, which a call leaves alone
+static b8 is_callee_saved(u8 location);
+
+// Gives what holding an interval in a location saves over leaving it in memory
+static u64 interval_benefit(const live_interval* interval, u8 location);
+
+// Orders intervals by their start, for qsort()
+static int compare_intervals(const void* left, const void* right);
+
+
+b8 register_allocate(const bytecode_program* program, u64 function_index, register_allocation* out_allocation)
+{
+    const bytecode_function* function = &program->functions[function_index];
+    u64 register_count = function->register_count;
+    u64 code_length = function->code_length;
+
+    register_allocation allocation = {};
+    allocation.register_count = register_count;
+    allocation.locations = malloc(register_count + 1);
+    allocation.starts = malloc((register_count + 1) * sizeof(u32));
+    allocation.ends = malloc((register_count + 1) * sizeof(u32));
+    *out_allocation = allocation;
+    if (allocation.locations == NULL || allocation.starts == NULL || allocation.ends == NULL)
+        return false;
+
+    // Every register starts out in memory and live nowhere
+    memset(allocation.locations, NATIVE_LOCATION_MEMORY, register_count);
+    for (u64 i = 0; i < register_count; ++i)
+    {
+        allocation.starts[i] = UINT32_MAX;
+        allocation.ends[i] = 0;
+    }
+
+    register_allocator allocator = {};
+    allocator.program = program;
+    allocator.function = function;
+    allocator.allocation = out_allocation;
+    allocator.set_words = (register_count + 63) / 64;
+    allocator.returned_globals = (function_index == 0) ? program->global_count : 0;
+    if (allocator.returned_globals > register_count)
+        allocator.returned_globals = register_count;
+
+    if (register_count == 0 || code_length == 0 || code_length >= UINT32_MAX / 2)
+        return true;
+
+    allocator.is_shared = calloc(register_count, sizeof(b8));
+    allocator.block_of = malloc((code_length + 1) * sizeof(u32));
+    allocator.block_starts = malloc((code_length + 2) * sizeof(u64));
+    allocator.loop_depths = calloc(code_length + 1, sizeof(u32));
+    allocator.call_costs = calloc(code_length + 1, sizeof(u64));
+    allocator.spill_costs = calloc(register_count, sizeof(u64));
+    allocator.float_weights = calloc(register_count, sizeof(u64));
+    allocator.integer_weights = calloc(register_count, sizeof(u64));
+    allocator.written_blocks = calloc(register_count, sizeof(u32));
+
+    b8 is_allocated = allocator.is_shared != NULL && allocator.block_of != NULL && allocator.block_starts != NULL && allocator.loop_depths != NULL &&
+                      allocator.call_costs != NULL && allocator.spill_costs != NULL && allocator.float_weights != NULL && allocator.integer_weights != NULL &&
+                      allocator.written_blocks != NULL;
+    if (is_allocated)
+    {
+        find_shared_globals(&allocator);
+        find_blocks(&allocator);
+
+        // The live sets take a bit for each register in each block. A function too large for them keeps its
+        // registers in memory, the way the code ran before they were allocated
+        u64 set_length = allocator.block_count * allocator.set_words;
+        if (set_length <= ALLOCATOR_MAX_LIVE_WORDS)
+        {
+            allocator.uses = calloc(set_length, sizeof(u64));
+            allocator.definitions = calloc(set_length, sizeof(u64));
+            allocator.live_in = calloc(set_length, sizeof(u64));
+            allocator.live_out = calloc(set_length, sizeof(u64));
+            is_allocated = allocator.uses != NULL && allocator.definitions != NULL && allocator.live_in != NULL && allocator.live_out != NULL;
+
+            if (is_allocated)
+            {
+                find_live_sets(&allocator);
+                find_intervals(&allocator);
+                is_allocated = scan_intervals(&allocator);
+            }
+        }
+    }
+
+    free(allocator.is_shared);
+    free(allocator.block_of);
+    free(allocator.block_starts);
+    free(allocator.loop_depths);
+    free(allocator.call_costs);
+    free(allocator.spill_costs);
+    free(allocator.float_weights);
+    free(allocator.integer_weights);
+    free(allocator.written_blocks);
+    free(allocator.uses);
+    free(allocator.definitions);
+    free(allocator.live_in);
+    free(allocator.live_out);
+
+    return is_allocated;
+}
+
+void register_allocation_destroy(register_allocation* allocation)
+{
+    free(allocation->locations);
+    free(allocation->starts);
+    free(allocation->ends);
+    free(allocation->spanning_registers);
+    memset(allocation, 0, sizeof(register_allocation));
+}
+
+
+
+void find_shared_globals(register_allocator* allocator)
+{
+    const bytecode_program* program = allocator->program;
+    if (allocator->returned_globals == 0)
+        return;
+
+    // The other functions reach the globals of the top level code in its registers, so a global they read or
+    // write is only ever in memory. The others are the top level code's own until it returns
+    for (u64 i = 0; i < program->function_count; ++i)
+    {
+        const bytecode_function* function = &program->functions[i];
+        for (u64 j = 0; j < function->code_length; ++j)
+        {
+            bytecode_instruction instruction = function->code[j];
+            b8 is_global_access = instruction.opcode == OPCODE_GET_GLOBAL || instruction.opcode == OPCODE_SET_GLOBAL;
+            if (is_global_access && instruction.index < allocator->returned_globals)
+                allocator->is_shared[instruction.index] = true;
+        }
+    }
+}
+
+void find_blocks(register_allocator* allocator)
+{
+    const bytecode_function* function = allocator->function;
+    u64 code_length = function->code_length;
+    u32* block_of = allocator->block_of;
+
+    // A block starts at the first instruction, at every instruction jumped to, and after every jump. block_of marks them first
+    memset(block_of, 0, (code_length + 1) * sizeof(u32));
+    block_of[0] = 1;
+    for (u64 i = 0; i < code_length; ++i)
+    {
+        bytecode_instruction instruction = function->code[i];
+        u8 operands = bytecode_opcode_operands(instruction.opcode);
+        if (!(operands & (BYTECODE_OPERAND_JUMPS | BYTECODE_OPERAND_JUMPS_SHORT | BYTECODE_OPERAND_NO_FALL_THROUGH)))
+            continue;
+
+        block_of[i + 1] = 1;
+        if (operands & (BYTECODE_OPERAND_JUMPS | BYTECODE_OPERAND_JUMPS_SHORT))
+        {
+            u64 target = jump_target(instruction, i);
+            if (target < code_length)
+                block_of[target] = 1;
+
+            // A jump back to an instruction closes a loop, every instruction from the target to the jump is
+            // one level deeper. The depths are counted as differences and summed below
+            if (target <= i)
+            {
+                allocator->loop_depths[target] += 1;
+                allocator->loop_depths[i + 1] -= 1;
+            }
+        }
+    }
+
+    u64 block_count = 0;
+    u32 depth = 0;
+    for (u64 i = 0; i < code_length; ++i)
+    {
+        if (block_of[i])
+            allocator->block_starts[block_count++] = i;
+
+        block_of[i] = (u32)(block_count - 1);
+        depth += allocator->loop_depths[i];
+        allocator->loop_depths[i] = depth;
+        // A register saved around a call is stored before it and loaded after it
+        u64 weight = 1ull << (3 * ((depth < ALLOCATOR_MAX_LOOP_DEPTH) ? depth : ALLOCATOR_MAX_LOOP_DEPTH));
+        allocator->call_costs[i + 1] = allocator->call_costs[i] + (is_call_point(function->code[i]) ? 2 * weight : 0);
+    }
+
+    allocator->block_starts[block_count] = code_length;
+    allocator->block_count = block_count;
+}
+
+void find_live_sets(register_allocator* allocator)
+{
+    const bytecode_function* function = allocator->function;
+    u64 words = allocator->set_words;
+
+    // The registers each block reads before writing, and writes, from its last instruction back to its first
+    for (u64 b = 0; b < allocator->block_count; ++b)
+    {
+        u64* uses = allocator->uses + b * words;
+        u64* definitions = allocator->definitions + b * words;
+        for (u64 i = allocator->block_starts[b + 1]; i-- > allocator->block_starts[b];)
+        {
+            bytecode_instruction instruction = function->code[i];
+            u8 operands = bytecode_opcode_operands(instruction.opcode);
+
+            // A call overwrites every register from c on, which leaves them dead before it
+            if (instruction.opcode == OPCODE_CALL)
+            {
+                for (u64 reg = instruction.c; reg < function->register_count; ++reg)
+                {
+                    definitions[reg / 64] |= 1ull << (reg % 64);
+                    uses[reg / 64] &= ~(1ull << (reg % 64));
+                }
+            }
+
+            if (operands & BYTECODE_OPERAND_WRITES_A)
+            {
+                definitions[instruction.a / 64] |= 1ull << (instruction.a % 64);
+                uses[instruction.a / 64] &= ~(1ull << (instruction.a % 64));
+            }
+
+            const u8 reads[] = { BYTECODE_OPERAND_READS_A, BYTECODE_OPERAND_READS_B, BYTECODE_OPERAND_READS_C };
+            const u64 registers[] = { instruction.a, instruction.b, instruction.c };
+            for (u64 j = 0; j < 3; ++j)
+            {
+                if (operands & reads[j])
+                    uses[registers[j] / 64] |= 1ull << (registers[j] % 64);
+            }
+
+            // Returning from the top level code reads every global, main() prints them
+            if (instruction.opcode == OPCODE_RETURN)
+            {
+                for (u64 reg = 0; reg < allocator->returned_globals; ++reg)
+                    uses[reg / 64] |= 1ull << (reg % 64);
+            }
+        }
+    }
+
+    // A register is live when a block ends if a block after it reads it, the sets grow until nothing changes. Going over
+    // the blocks from the last one needs few rounds, the reads flow backwards
+    b8 is_changed = true;
+    while (is_changed)
+    {
+        is_changed = false;
+        for (u64 b = allocator->block_count; b-- > 0;)
+        {
+            u64 last = allocator->block_starts[b + 1] - 1;
+            bytecode_instruction instruction = function->code[last];
+            u8 operands = bytecode_opcode_operands(instruction.opcode);
+
+            u64* live_out = allocator->live_out + b * words;
+            memset(live_out, 0, words * sizeof(u64));
+            if (operands & (BYTECODE_OPERAND_JUMPS | BYTECODE_OPERAND_JUMPS_SHORT))
+            {
+                u64 target = jump_target(instruction, last);
+                if (target < function->code_length)
+                {
+                    const u64* target_in = allocator->live_in + allocator->block_of[target] * words;
+                    for (u64 w = 0; w < words; ++w)
+                        live_out[w] |= target_in[w];
+                }
+            }
+
+            if (!(operands & BYTECODE_OPERAND_NO_FALL_THROUGH) && b + 1 < allocator->block_count)
+            {
+                const u64* next_in = allocator->live_in + (b + 1) * words;
+                for (u64 w = 0; w < words; ++w)
+                    live_out[w] |= next_in[w];
+            }
+
+            u64* live_in = allocator->live_in + b * words;
+            const u64* uses = allocator->uses + b * words;
+            const u64* definitions = allocator->definitions + b * words;
+            for (u64 w = 0; w < words; ++w)
+            {
+                u64 value = uses[w] | (live_out[w] & ~definitions[w]);
+                if (value != live_in[w])
+                {
+                    live_in[w] = value;
+                    is_changed = true;
+                }
+            }
+        }
+    }
+}
+
+void find_intervals(register_allocator* allocator)
+{
+    const bytecode_function* function = allocator->function;
+    u64 words = allocator->set_words;
+
+    for (u64 b = 0; b < allocator->block_count; ++b)
+    {
+        u64 start = allocator->block_starts[b];
+        u64 end = allocator->block_starts[b + 1];
+
+        // The registers live through the ends of the block cover them
+        const u64* live_in = allocator->live_in + b * words;
+        const u64* live_out = allocator->live_out + b * words;
+        for (u64 reg = 0; reg < function->register_count; ++reg)
+        {
+            if (live_in[reg / 64] & (1ull << (reg % 64)))
+                extend_interval(allocator, reg, (u32)(start * 2));
+
+            if (live_out[reg / 64] & (1ull << (reg % 64)))
+                extend_interval(allocator, reg, (u32)(end * 2 - 1));
+        }
+
+        for (u64 i = start; i < end; ++i)
+        {
+            bytecode_instruction instruction = function->code[i];
+            u8 operands = bytecode_opcode_operands(instruction.opcode);
+            u32 depth = allocator->loop_depths[i];
+            u64 weight = 1ull << (3 * ((depth < ALLOCATOR_MAX_LOOP_DEPTH) ? depth : ALLOCATOR_MAX_LOOP_DEPTH));
+            value_kind kind = instruction_value_kind(allocator, instruction);
+
+            if (operands & BYTECODE_OPERAND_READS_A)
+                add_access(allocator, instruction.a, (u32)(i * 2), weight, kind);
+
+            if (operands & BYTECODE_OPERAND_READS_B)
+                add_access(allocator, instruction.b, (u32)(i * 2), weight, (instruction.opcode == OPCODE_CALL) ? VALUE_KIND_INTEGER : kind);
+
+            if (operands & BYTECODE_OPERAND_READS_C)
+                add_access(allocator, instruction.c, (u32)(i * 2), weight, kind);
+
+            if (instruction.opcode == OPCODE_CALL)
+            {
+                // The arguments are the registers from c on which the block wrote before the call, they are
+                // read by the call. After it every register from c on holds whatever the callee left there
+                for (u64 reg = instruction.c; reg < function->register_count; ++reg)
+                {
+                    if (allocator->written_blocks[reg] == b + 1)
+                        add_access(allocator, reg, (u32)(i * 2), weight, VALUE_KIND_ANY);
+
+                    allocator->written_blocks[reg] = 0;
+                }
+            }
+
+            if (instruction.opcode == OPCODE_RETURN)
+            {
+                for (u64 reg = 0; reg < allocator->returned_globals; ++reg)
+                    add_access(allocator, reg, (u32)(i * 2), weight, VALUE_KIND_ANY);
+            }
+
+            if (operands & BYTECODE_OPERAND_WRITES_A)
+            {
+                add_access(allocator, instruction.a, (u32)(i * 2 + 1), weight, kind);
+                allocator->written_blocks[instruction.a] = (u32)(b + 1);
+            }
+        }
+    }
+}
+
+b8 scan_intervals(register_allocator* allocator)
+{
+    register_allocation* allocation = allocator->allocation;
+    live_interval* intervals = malloc((allocation->register_count + 1) * sizeof(live_interval));
+    if (intervals == NULL)
+        return false;
+
+    u64 interval_count = 0;
+    for (u64 reg = 0; reg < allocation->register_count; ++reg)
+    {
+        u32 start = allocation->starts[reg];
+        u32 end = allocation->ends[reg];
+        if (start > end || allocator->is_shared[reg])
+            continue;
+
+        // A call overwrites the caller saved registers, so an interval holding a position from before a call
+        // to after it needs a callee saved one, or is stored and loaded around the call. The operands of the
+        // call are read before it and its result written after
+        u64 first_call = start / 2 + 1;
+        u64 last_call = (end >= 2) ? (end - 2) / 2 : 0;
+        u64 save_cost = (end >= 2 && first_call <= last_call) ? allocator->call_costs[last_call + 1] - allocator->call_costs[first_call] : 0;
+
+        b8 is_float = allocator->float_weights[reg] > allocator->integer_weights[reg];
+        intervals[interval_count++] = (live_interval){ start, end, reg, allocator->spill_costs[reg], save_cost, is_float };
+    }
+
+    qsort(intervals, interval_count, sizeof(live_interval), compare_intervals);
+
+    // The interval holding each location, -1 for a free one. The active intervals are the ones holding a location
+    i64 holders[ALLOCATOR_MAX_LOCATIONS];
+    for (u64 i = 0; i < ALLOCATOR_MAX_LOCATIONS; ++i)
+        holders[i] = -1;
+
+    for (u64 i = 0; i < interval_count; ++i)
+    {
+        live_interval* interval = &intervals[i];
+
+        // The intervals ending before this one starts give their locations back
+        for (u64 location = 0; location < ALLOCATOR_MAX_LOCATIONS; ++location)
+        {
+            if (holders[location] >= 0 && intervals[holders[location]].end < interval->start)
+                holders[location] = -1;
+        }
+
+        // An interval across a call tries the callee saved registers first (a float is moved in and out of them), then
+        // its own class when it is accessed more than it would be saved around the calls. The others try their own
+        // class first
+        const u8* class_pool = interval->is_float ? float_registers : caller_saved_registers;
+        u64 class_length = interval->is_float ? sizeof(float_registers) : sizeof(caller_saved_registers);
+        const u8* pools[2] = { class_pool, interval->is_float ? NULL : callee_saved_registers };
+        u64 pool_lengths[2] = { class_length, interval->is_float ? 0 : sizeof(callee_saved_registers) };
+        if (interval->save_cost > 0)
+        {
+            pools[0] = callee_saved_registers;
+            pool_lengths[0] = sizeof(callee_saved_registers);
+            pools[1] = class_pool;
+            pool_lengths[1] = (interval->save_cost < interval->spill_cost) ? class_length : 0;
+        }
+
+        // A free location, or else the held one whose interval saves the least over memory. Between equal savings the
+        // interval ending last is spilled, it holds the location the longest
+        i64 free_location = -1;
+        i64 spilled_location = -1;
+        u64 spilled_benefit = 0;
+        for (u64 p = 0; p < 2 && free_location < 0; ++p)
+        {
+            for (u64 j = 0; j < pool_lengths[p]; ++j)
+            {
+                u8 location = pools[p][j];
+                if (holders[location] < 0)
+                {
+                    free_location = location;
+                    break;
+                }
+
+                const live_interval* held = &intervals[holders[location]];
+                const live_interval* spilled = (spilled_location >= 0) ? &intervals[holders[spilled_location]] : NULL;
+                u64 held_benefit = interval_benefit(held, location);
+                if (spilled == NULL || held_benefit < spilled_benefit || (held_benefit == spilled_benefit && held->end > spilled->end))
+                {
+                    spilled_location = location;
+                    spilled_benefit = held_benefit;
+                }
+            }
+        }
+
+        if (free_location < 0 && spilled_location >= 0)
+        {
+            live_interval* spilled = &intervals[holders[spilled_location]];
+            if (spilled_benefit < interval_benefit(interval, (u8)spilled_location))
+            {
+                allocation->locations[spilled->reg] = NATIVE_LOCATION_MEMORY;
+                free_location = spilled_location;
+            }
+        }
+
+        if (free_location < 0)
+            continue;
+
+        holders[free_location] = (i64)i;
+        allocation->locations[interval->reg] = (u8)free_location;
+    }
+
+    // The callee saved registers are restored when the function returns
+    for (u64 reg = 0; reg < allocation->register_count; ++reg)
+    {
+        u8 location = allocation->locations[reg];
+        if (is_callee_saved(location))
+            allocation->saved_registers |= (u16)(1 << location);
+    }
+
+    // The registers held in caller saved registers across a call are saved around it, they are gathered at the front of
+    // the intervals
+    u64 spanning_count = 0;
+    for (u64 i = 0; i < interval_count; ++i)
+    {
+        u8 location = allocation->locations[intervals[i].reg];
+        if (location != NATIVE_LOCATION_MEMORY && intervals[i].save_cost > 0 && !is_callee_saved(location))
+            intervals[spanning_count++].reg = intervals[i].reg;
+    }
+
+    b8 is_allocated = true;
+    if (spanning_count > 0)
+    {
+        allocation->spanning_registers = malloc(spanning_count * sizeof(u64));
+        is_allocated = allocation->spanning_registers != NULL;
+        for (u64 i = 0; i < spanning_count && is_allocated; ++i)
+            allocation->spanning_registers[i] = intervals[i].reg;
+
+        allocation->spanning_count = is_allocated ? spanning_count : 0;
+    }
+
+    free(intervals);
+    return is_allocated;
+}
+
+value_kind instruction_value_kind(register_allocator* allocator, bytecode_instruction instruction)
+{
+    const bytecode_program* program = allocator->program;
+    if (bytecode_opcode_is_float(instruction.opcode))
+        return VALUE_KIND_FLOAT;
+
+    switch (instruction.opcode)
+    {
+        case OPCODE_LOAD_CONSTANT:
+        {
+            return (program->constant_types[instruction.index] == TYPE_INFO_FLOAT) ? VALUE_KIND_FLOAT : VALUE_KIND_INTEGER;
+        }
+        case OPCODE_GET_GLOBAL:
+        case OPCODE_SET_GLOBAL:
+        {
+            return (program->globals[instruction.index].type == TYPE_INFO_FLOAT) ? VALUE_KIND_FLOAT : VALUE_KIND_INTEGER;
+        }
+        case OPCODE_RETURN:
+        {
+            return (allocator->function->return_type == TYPE_INFO_FLOAT) ? VALUE_KIND_FLOAT : VALUE_KIND_INTEGER;
+        }
+        case OPCODE_MOVE:
+        case OPCODE_CALL:
+        {
+            // Copies any kind of value, and returns any kind
+            return VALUE_KIND_ANY;
+        }
+        default:
+        {
+            return VALUE_KIND_INTEGER;
+        }
+    };
+}
+
+void add_access(register_allocator* allocator, u64 reg, u32 position, u64 weight, value_kind kind)
+{
+    if (reg >= allocator->allocation->register_count)
+        return;
+
+    extend_interval(allocator, reg, position);
+
+    // An access of any kind costs a load or a store when the register is in memory, its kind picks the class
+    allocator->spill_costs[reg] += weight;
+    if (kind == VALUE_KIND_FLOAT)
+        allocator->float_weights[reg] += weight;
+    else if (kind == VALUE_KIND_INTEGER)
+        allocator->integer_weights[reg] += weight;
+}
+
+void extend_interval(register_allocator* allocator, u64 reg, u32 position)
+{
+    register_allocation* allocation = allocator->allocation;
+    if (position < allocation->starts[reg])
+        allocation->starts[reg] = position;
+
+    if (position > allocation->ends[reg])
+        allocation->ends[reg] = position;
+}
+
+u64 jump_target(bytecode_instruction instruction, u64 index)
+{
+    if (bytecode_opcode_operands(instruction.opcode) & BYTECODE_OPERAND_JUMPS_SHORT)
+        return (u64)((i64)index + 1 + instruction.short_offset);
+
+    return (u64)((i64)index + 1 + instruction.offset);
+}
+
+b8 is_call_point(bytecode_instruction instruction)
+{
+    return instruction.opcode == OPCODE_CALL || instruction.opcode == OPCODE_MODULUS_F64;
+}
+
+b8 is_callee_saved(u8 location)
+{
+    return location >= X86_R12 && location <= X86_R15;
+}
+
+u64 interval_benefit(const live_interval* interval, u8 location)
+{
+    // An interval in a caller saved register across a call is stored before the call and loaded after it,
+    // it only ever gets one when that costs less than its accesses
+    if (interval->save_cost > 0 && !is_callee_saved(location))
+        return interval->spill_cost - interval->save_cost;
+
+    return interval->spill_cost;
+}
+
+int compare_intervals(const void* left, const void* right)
+{
+    const live_interval* left_interval = left;
+    const live_interval* right_interval = right;
+    if (left_interval->start != right_interval->start)
+        return (left_interval->start < right_interval->start) ? -1 : 1;
+
+    return (left_interval->reg < right_interval->reg) ? -1 : (left_interval->reg > right_interval->reg);
+}
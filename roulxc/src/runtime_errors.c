@@ -0,0 +1,42 @@
+#include "runtime_errors.h"
+
+#include <malloc.h>
+#include <string.h>
+
+char* runtime_error_render(runtime_error_renderer* renderer, token t, diagnostic_id id, va_list params, u64* out_length)
+{
+    error_report report = error_report_create(t, id, params);
+
+    if (renderer->lines_filename != t.location.filename)
+    {
+        line_index_destroy(&renderer->lines);
+        renderer->lines_filename = t.location.filename;
+
+        const context_source* source = context_find_source(renderer->context, t.location.filename);
+        if (source != NULL)
+            renderer->lines = line_index_create(source->content, source->length);
+    }
+
+    const char* line = NULL;
+    u64 line_length = 0;
+    if (!line_index_get_line(&renderer->lines, t.location.row, &line, &line_length))
+    {
+        line = "<File content is not available to generate error message>";
+        line_length = strlen(line);
+    }
+
+    u64 text_length = error_report_write_printable_text(report, line, line_length, NULL, 0);
+    char* text = malloc(text_length + 1);
+    if (text == NULL)
+        return NULL;
+
+    error_report_write_printable_text(report, line, line_length, text, text_length + 1);
+    *out_length = text_length;
+    return text;
+}
+
+void runtime_error_renderer_destroy(runtime_error_renderer* renderer)
+{
+    line_index_destroy(&renderer->lines);
+    memset(renderer, 0, sizeof(runtime_error_renderer));
+}